@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// Read-only view of a file's contents. The bytes stay valid for as long as any copy of the FileData
+// lives; depending on the provider they point into a memory-mapped archive or an owned buffer.
+class FileData {
+public:
+    FileData() = default;
+    FileData(const std::byte* data, std::size_t size, std::shared_ptr<const void> keepAlive)
+        : m_data(data)
+        , m_size(size)
+        , m_keepAlive(std::move(keepAlive))
+    {
+    }
+
+    static FileData fromBuffer(std::vector<std::byte> buffer);
+
+    [[nodiscard]] const std::byte* data() const { return m_data; }
+    [[nodiscard]] const unsigned char* bytes() const { return reinterpret_cast<const unsigned char*>(m_data); }
+    [[nodiscard]] std::size_t size() const { return m_size; }
+    [[nodiscard]] std::string_view text() const { return { reinterpret_cast<const char*>(m_data), m_size }; }
+
+private:
+    const std::byte* m_data { nullptr };
+    std::size_t m_size { 0 };
+    std::shared_ptr<const void> m_keepAlive;
+};
+
+// How urgently a prefetched file is needed: Visible for content on screen now, Prefetch for content
+// that may be needed soon.
+enum class ReadPriority {
+    Visible = 0,
+    Prefetch = 1
+};
+
+// Where the framework and the application read their assets from. The default provider reads loose
+// files from disk; an application may install its own (e.g. a virtual file system over packed
+// archives) with setFileProvider(). The provider must outlive every read made through it.
+class FileProvider {
+public:
+    virtual ~FileProvider() = default;
+
+    virtual std::optional<FileData> read(const std::filesystem::path& path) = 0;
+    virtual bool exists(const std::filesystem::path& path) = 0;
+    // Regular files directly inside `directory`, as paths that can be passed back to read().
+    virtual std::vector<std::filesystem::path> list(const std::filesystem::path& directory) = 0;
+    // Hint that `paths` will be read soon. Providers with asynchronous I/O start reading them in the
+    // background so the later read() does not block on the disk.
+    virtual void prefetch(const std::vector<std::filesystem::path>& paths, ReadPriority priority)
+    {
+        (void)paths;
+        (void)priority;
+    }
+};
+
+class LooseFileProvider : public FileProvider {
+public:
+    std::optional<FileData> read(const std::filesystem::path& path) override;
+    bool exists(const std::filesystem::path& path) override;
+    std::vector<std::filesystem::path> list(const std::filesystem::path& directory) override;
+};
+
+// Passing nullptr restores the loose-file provider.
+void setFileProvider(FileProvider* provider);
+FileProvider& fileProvider();
+
+inline std::optional<FileData> readFileData(const std::filesystem::path& path) { return fileProvider().read(path); }
+inline bool fileExists(const std::filesystem::path& path) { return fileProvider().exists(path); }
+inline std::vector<std::filesystem::path> listFiles(const std::filesystem::path& directory) { return fileProvider().list(directory); }
+inline void prefetchFiles(const std::vector<std::filesystem::path>& paths, ReadPriority priority = ReadPriority::Visible) { fileProvider().prefetch(paths, priority); }
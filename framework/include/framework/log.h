@@ -0,0 +1,295 @@
+#pragma once
+#include "disable_all_warnings.h"
+DISABLE_WARNINGS_PUSH()
+#include <fmt/format.h>
+DISABLE_WARNINGS_POP()
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+// Asynchronous logging.
+//
+// A LOG_* call site checks its level against a compile-time floor (LOG_COMPILE_LEVEL) and the
+// category's runtime level. If the record passes, the call copies a pointer to the site's static
+// metadata (which doubles as the format id) and its raw arguments into the calling thread's
+// lock-free single-producer ring. Strings are copied inline. A background sink thread drains every
+// ring, orders the records by timestamp, formats them with fmt and writes them to the console and
+// any file sinks. The caller never formats, locks or touches a stream. A full ring drops the record
+// and counts it. LOG_RATE_LIMITED additionally caps how often one key (e.g. a GL message id) gets
+// through per second.
+//
+//     LOG_INFO(logging::Category::Texture, "Loaded {} ({}x{})", path, width, height);
+
+// Records below this level are compiled out. 0 = Trace ... 4 = Error.
+#ifndef LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILE_LEVEL 1
+#else
+#define LOG_COMPILE_LEVEL 0
+#endif
+#endif
+
+namespace logging {
+
+enum class Level : std::uint8_t {
+    Trace = 0,
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Off
+};
+
+enum class Category : std::uint8_t {
+    General = 0,
+    OpenGL,
+    Texture,
+    Mesh,
+    Scene,
+    Benchmark, // benchmarkCallSite() records; counted but never written
+    Count
+};
+
+inline constexpr Level compileLevel = static_cast<Level>(LOG_COMPILE_LEVEL);
+
+[[nodiscard]] std::string_view levelName(Level level);
+[[nodiscard]] std::string_view categoryName(Category category);
+
+namespace detail {
+    extern std::array<std::atomic<std::uint8_t>, static_cast<std::size_t>(Category::Count)> categoryLevels;
+    extern std::atomic<bool> stopped;
+}
+
+[[nodiscard]] inline bool enabled(Level level, Category category)
+{
+    return static_cast<std::uint8_t>(level) >= detail::categoryLevels[static_cast<std::size_t>(category)].load(std::memory_order_relaxed);
+}
+
+void setLevel(Category category, Level level);
+[[nodiscard]] Level level(Category category);
+// Comma-separated "category=level" pairs, or a bare level for every category, e.g. "info,opengl=warning".
+bool configure(std::string_view spec);
+
+class Sink {
+public:
+    virtual ~Sink() = default;
+    // Called on the sink thread with one formatted line, including its trailing newline.
+    virtual void write(Level level, std::string_view line) = 0;
+    virtual void flush() { }
+};
+
+void addSink(std::unique_ptr<Sink> sink);
+bool addFileSink(const std::filesystem::path& path);
+void setConsoleEnabled(bool enabled);
+
+// Blocks until every record logged before the call has been written.
+void flush();
+// Drains, stops the sink thread and closes the sinks. Later records are written synchronously.
+void shutdown();
+
+struct Stats {
+    std::uint64_t written { 0 };
+    std::uint64_t dropped { 0 }; // ring full
+    std::uint64_t suppressed { 0 }; // rate limited
+    std::size_t threads { 0 }; // threads with a ring
+};
+[[nodiscard]] Stats stats();
+
+struct BenchmarkResult {
+    int iterations { 0 };
+    double loggedNs { 0.0 }; // enqueue of a record with an int, a float and a string
+    double filteredNs { 0.0 }; // call site whose category level rejects it
+    double formatNs { 0.0 }; // formatting the same record on the caller with fmt::format
+};
+// Times call sites in nanoseconds; the records go to Category::Benchmark.
+[[nodiscard]] BenchmarkResult benchmarkCallSite(int iterations);
+
+void drawImGuiPanel();
+
+// Lets up to `burst` messages per key through per window; the rest are counted as suppressed.
+class RateLimiter {
+public:
+    explicit RateLimiter(std::uint32_t burst = 5, std::chrono::milliseconds window = std::chrono::milliseconds(1000));
+
+    // `suppressed` receives how many messages with `key` were held back since the last one that
+    // got through, so the caller can report them once.
+    bool allow(std::uint64_t key, std::uint32_t& suppressed);
+
+private:
+    struct Entry {
+        std::uint64_t key { 0 };
+        std::int64_t windowStart { 0 };
+        std::uint32_t count { 0 };
+        std::uint32_t suppressed { 0 };
+        bool used { false };
+    };
+    static constexpr std::size_t kEntries = 64;
+
+    std::uint32_t m_burst;
+    std::int64_t m_windowNs;
+    std::mutex m_mutex;
+    std::array<Entry, kEntries> m_entries {};
+};
+
+// Static per call site; its address identifies the format string in a record.
+struct Site {
+    Level level;
+    Category category;
+    const char* format;
+    const char* file;
+    int line;
+};
+
+namespace detail {
+    using DecodeFn = void (*)(const std::byte* payload, fmt::memory_buffer& out, std::string_view format);
+
+    // Space for a record of `payloadBytes` in the calling thread's ring; null when it is full.
+    // `ticket` is passed back to commit().
+    std::byte* reserve(std::size_t payloadBytes, const Site& site, DecodeFn decode, std::size_t& ticket);
+    void commit(std::size_t ticket);
+    // Used after shutdown(): formats and writes on the calling thread.
+    void writeSynchronously(const Site& site, DecodeFn decode, const std::byte* payload);
+
+    // Arguments are first captured into one of: a string view (copied inline), an owned string (for
+    // paths and types only fmt knows how to format, formatted on the caller) or a trivially copyable
+    // value (copied as bytes).
+    template <typename T>
+    auto capture(const T& value)
+    {
+        if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>)
+            return std::string_view(value);
+        else if constexpr (std::is_array_v<T>)
+            return std::string_view(value);
+        else if constexpr (std::is_convertible_v<const T&, const char*>)
+            return static_cast<const char*>(value) ? std::string_view(value) : std::string_view("(null)");
+        else if constexpr (std::is_same_v<T, std::filesystem::path>)
+            return value.string();
+        else if constexpr (std::is_arithmetic_v<T>)
+            return value;
+        else if constexpr (std::is_enum_v<T>)
+            return static_cast<std::underlying_type_t<T>>(value);
+        else if constexpr (std::is_pointer_v<T>)
+            return static_cast<const void*>(value);
+        else
+            return fmt::format("{}", value);
+    }
+
+    template <typename C>
+    constexpr bool isStringLike = std::is_same_v<C, std::string_view> || std::is_same_v<C, std::string>;
+
+    template <typename C>
+    std::size_t encodedSize(const C& value)
+    {
+        if constexpr (isStringLike<C>)
+            return sizeof(std::uint32_t) + value.size();
+        else
+            return sizeof(C);
+    }
+
+    template <typename C>
+    std::byte* encode(std::byte* out, const C& value)
+    {
+        if constexpr (isStringLike<C>) {
+            const auto length = static_cast<std::uint32_t>(value.size());
+            std::memcpy(out, &length, sizeof(length));
+            std::memcpy(out + sizeof(length), value.data(), length);
+            return out + sizeof(length) + length;
+        } else {
+            std::memcpy(out, &value, sizeof(C));
+            return out + sizeof(C);
+        }
+    }
+
+    template <typename C>
+    auto decode(const std::byte*& in)
+    {
+        if constexpr (isStringLike<C>) {
+            std::uint32_t length = 0;
+            std::memcpy(&length, in, sizeof(length));
+            const std::string_view value(reinterpret_cast<const char*>(in + sizeof(length)), length);
+            in += sizeof(length) + length;
+            return value;
+        } else {
+            C value;
+            std::memcpy(&value, in, sizeof(C));
+            in += sizeof(C);
+            return value;
+        }
+    }
+
+    template <typename... Cs>
+    void decodeAndFormat(const std::byte* payload, fmt::memory_buffer& out, std::string_view format)
+    {
+        // Braced initialisation evaluates left to right, matching the encoding order.
+        const std::tuple<decltype(decode<Cs>(payload))...> values { decode<Cs>(payload)... };
+        std::apply([&](const auto&... args) { fmt::vformat_to(fmt::appender(out), format, fmt::make_format_args(args...)); }, values);
+    }
+
+    template <typename... Cs>
+    void enqueue(const Site& site, const Cs&... captured)
+    {
+        const std::size_t bytes = (std::size_t { 0 } + ... + encodedSize(captured));
+        constexpr DecodeFn decodeFn = &decodeAndFormat<Cs...>;
+        if (stopped.load(std::memory_order_relaxed)) {
+            const std::unique_ptr<std::byte[]> payload = std::make_unique<std::byte[]>(bytes + 1);
+            [[maybe_unused]] std::byte* out = payload.get();
+            ((out = encode(out, captured)), ...);
+            writeSynchronously(site, decodeFn, payload.get());
+            return;
+        }
+        std::size_t ticket = 0;
+        [[maybe_unused]] std::byte* out = reserve(bytes, site, decodeFn, ticket);
+        if (out == nullptr)
+            return;
+        ((out = encode(out, captured)), ...);
+        commit(ticket);
+    }
+
+    template <typename... Args>
+    void log(const Site& site, const Args&... args)
+    {
+        enqueue(site, capture(args)...);
+    }
+}
+
+}
+
+#define LOG_AT(lvl, category, format, ...)                                                              \
+    do {                                                                                                \
+        if constexpr ((lvl) >= ::logging::compileLevel) {                                               \
+            if (::logging::enabled(lvl, category)) {                                                    \
+                static constexpr ::logging::Site logSite_ { lvl, category, format, __FILE__, __LINE__ }; \
+                ::logging::detail::log(logSite_ __VA_OPT__(, ) __VA_ARGS__);                            \
+            }                                                                                           \
+        }                                                                                               \
+    } while (false)
+
+#define LOG_TRACE(category, format, ...) LOG_AT(::logging::Level::Trace, category, format __VA_OPT__(, ) __VA_ARGS__)
+#define LOG_DEBUG(category, format, ...) LOG_AT(::logging::Level::Debug, category, format __VA_OPT__(, ) __VA_ARGS__)
+#define LOG_INFO(category, format, ...) LOG_AT(::logging::Level::Info, category, format __VA_OPT__(, ) __VA_ARGS__)
+#define LOG_WARNING(category, format, ...) LOG_AT(::logging::Level::Warning, category, format __VA_OPT__(, ) __VA_ARGS__)
+#define LOG_ERROR(category, format, ...) LOG_AT(::logging::Level::Error, category, format __VA_OPT__(, ) __VA_ARGS__)
+
+// Like LOG_AT, but at most a burst of records per `key` and second get through this call site.
+#define LOG_RATE_LIMITED(lvl, category, key, format, ...)                                          \
+    do {                                                                                           \
+        if (::logging::enabled(lvl, category)) {                                                   \
+            static ::logging::RateLimiter logLimiter_;                                             \
+            std::uint32_t logSuppressed_ = 0;                                                      \
+            if (logLimiter_.allow(static_cast<std::uint64_t>(key), logSuppressed_)) {              \
+                if (logSuppressed_ > 0)                                                            \
+                    LOG_AT(lvl, category, "({} similar messages suppressed)", logSuppressed_);     \
+                LOG_AT(lvl, category, format __VA_OPT__(, ) __VA_ARGS__);                          \
+            }                                                                                      \
+        }                                                                                          \
+    } while (false)
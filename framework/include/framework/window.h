@@ -6,6 +6,8 @@ DISABLE_WARNINGS_PUSH()
 #include <GLFW/glfw3.h>
 #include <glm/vec2.hpp>
 DISABLE_WARNINGS_POP()
+#include <bitset>
+#include <cstdint>
 #include <functional>
 #include <optional>
 #include <string_view>
@@ -30,6 +32,11 @@ public:
 	void updateInput();
 	void swapBuffers(); // Swap the front/back buffer
 
+	// Number of vblanks to wait per swap (0 = off, 1 = vsync, -1 = adaptive vsync when supported).
+	void setSwapInterval(int interval);
+	[[nodiscard]] int swapInterval() const;
+	[[nodiscard]] bool supportsAdaptiveVsync() const;
+
 
 	void renderToImage(const std::filesystem::path& filePath, const bool flipY = false); // renders the output to an image
 
@@ -49,6 +56,44 @@ public:
 	bool isKeyPressed(int key) const;
 	bool isMouseButtonPressed(int button) const;
 
+	// Input recording / replay.
+	// An input event as delivered by GLFW, before ImGui capture filtering.
+	struct InputEvent {
+		enum class Type : std::uint8_t {
+			Key,
+			Char,
+			MouseButton,
+			MouseMove,
+			Scroll
+		};
+		Type type { Type::Key };
+		int code { 0 }; // key, unicode code point or mouse button
+		int scancode { 0 };
+		int action { 0 };
+		int mods { 0 };
+		glm::vec2 value { 0.0f }; // cursor position (GLFW convention, origin top left) or scroll offset
+	};
+	// Device state read by isKeyPressed(), isMouseButtonPressed() and getCursorPos().
+	struct PolledInput {
+		// glfwGetKey() only accepts this range, so it is exactly the set of keys that is recorded and replayed.
+		static constexpr int kFirstKey = GLFW_KEY_SPACE;
+		static constexpr int kLastKey = GLFW_KEY_LAST;
+		std::bitset<kLastKey + 1> keys;
+		std::bitset<GLFW_MOUSE_BUTTON_LAST + 1> mouseButtons;
+		glm::vec2 cursorPos { 0.0f }; // same convention as getCursorPos()
+	};
+	using InputEventObserver = std::function<void(const InputEvent&)>;
+	using InputHook = std::function<void()>;
+
+	[[nodiscard]] PolledInput pollDevices() const;
+	// While an override is set, polled state comes from it and events from GLFW are dropped; nullptr restores the devices.
+	void setInputOverride(const PolledInput* input);
+	void setInputEventObserver(InputEventObserver&& observer);
+	// Runs in updateInput() after events were dispatched and the ImGui backend filled ImGuiIO, right before ImGui::NewFrame().
+	void setInputHook(InputHook&& hook);
+	// Delivers an event to the registered callbacks like a GLFW event (same ImGui capture filtering, no ImGui backend update).
+	void dispatchInputEvent(const InputEvent& event);
+
 	// NOTE: coordinates are such that the origin is at the left bottom of the screen.
 	glm::vec2 getCursorPos() const; // DPI independent.
 	glm::vec2 getNormalizedCursorPos() const; // Ranges from 0 to 1.
@@ -70,6 +115,8 @@ private:
 	static void mouseMoveCallback(GLFWwindow* window, double xpos, double ypos);
 	static void scrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 	static void windowSizeCallback(GLFWwindow* window, int width, int height);
+	// Common path of the GLFW callbacks; returns false when the event must not reach ImGui or the app.
+	static bool acceptLiveEvent(GLFWwindow* window, const InputEvent& event);
 
 private:
 	GLFWwindow* m_pWindow;
@@ -77,6 +124,7 @@ private:
 	float m_dpiScalingFactor = 1.0f;
 	const OpenGLVersion m_glVersion;
         bool m_presentable;
+	int m_swapInterval { 1 };
 
 	std::vector<KeyCallback> m_keyCallbacks;
 	std::vector<CharCallback> m_charCallbacks;
@@ -84,4 +132,8 @@ private:
 	std::vector<ScrollCallback> m_scrollCallbacks;
 	std::vector<MouseMoveCallback> m_mouseMoveCallbacks;
 	std::vector<WindowResizeCallback> m_windowResizeCallbacks;
+
+	const PolledInput* m_inputOverride { nullptr };
+	InputEventObserver m_inputEventObserver;
+	InputHook m_inputHook;
 };
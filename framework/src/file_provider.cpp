@@ -0,0 +1,58 @@
+#include "file_provider.h"
+#include <atomic>
+#include <fstream>
+#include <system_error>
+
+FileData FileData::fromBuffer(std::vector<std::byte> buffer)
+{
+    auto owned = std::make_shared<const std::vector<std::byte>>(std::move(buffer));
+    return FileData(owned->data(), owned->size(), owned);
+}
+
+std::optional<FileData> LooseFileProvider::read(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return std::nullopt;
+    const std::streamoff size = file.tellg();
+    if (size < 0)
+        return std::nullopt;
+    std::vector<std::byte> buffer(static_cast<std::size_t>(size));
+    file.seekg(0);
+    if (!buffer.empty() && !file.read(reinterpret_cast<char*>(buffer.data()), size))
+        return std::nullopt;
+    return FileData::fromBuffer(std::move(buffer));
+}
+
+bool LooseFileProvider::exists(const std::filesystem::path& path)
+{
+    std::error_code error;
+    return std::filesystem::is_regular_file(path, error);
+}
+
+std::vector<std::filesystem::path> LooseFileProvider::list(const std::filesystem::path& directory)
+{
+    std::vector<std::filesystem::path> files;
+    std::error_code error;
+    for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+        if (it->is_regular_file(error))
+            files.push_back(it->path());
+    }
+    return files;
+}
+
+namespace {
+LooseFileProvider s_looseFileProvider;
+std::atomic<FileProvider*> s_fileProvider { nullptr };
+}
+
+void setFileProvider(FileProvider* provider)
+{
+    s_fileProvider.store(provider, std::memory_order_release);
+}
+
+FileProvider& fileProvider()
+{
+    FileProvider* provider = s_fileProvider.load(std::memory_order_acquire);
+    return provider ? *provider : s_looseFileProvider;
+}
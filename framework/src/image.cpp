@@ -1,4 +1,5 @@
 #include "image.h"
+#include "file_provider.h"
 // Suppress warnings in third-party code.
 #include <framework/disable_all_warnings.h>
 DISABLE_WARNINGS_PUSH()
@@ -22,14 +23,14 @@ void Image::writeBitmapToFile(const std::filesystem::path& filePath) {
 // Image constructor, create image from file
 Image::Image(const std::filesystem::path& filePath, int forceChannels)
 {
-	if (!std::filesystem::exists(filePath)) {
+	const std::optional<FileData> file = readFileData(filePath);
+	if (!file) {
 		std::cerr << "Texture file " << filePath << " does not exist!" << std::endl;
 		throw std::exception();
 	}
 
-	const auto filePathStr = filePath.string(); // Create l-value so c_str() is safe.
 	int actualChannels = 0;
-	stbi_uc* stbPixels = stbi_load(filePathStr.c_str(), &width, &height, &actualChannels, forceChannels);
+	stbi_uc* stbPixels = stbi_load_from_memory(file->bytes(), static_cast<int>(file->size()), &width, &height, &actualChannels, forceChannels);
 
 	if (!stbPixels) {
 		std::cerr << "Failed to read texture " << filePath << " using stb_image.h" << std::endl;
@@ -39,7 +40,7 @@ Image::Image(const std::filesystem::path& filePath, int forceChannels)
 	// If forceChannels is set, use that; otherwise use actual channels from file
 	channels = (forceChannels > 0) ? forceChannels : actualChannels;
 
-	for (size_t i = 0UL; i < width * height * channels; i++) { pixels.emplace_back(stbPixels[i]); }
+	pixels.assign(stbPixels, stbPixels + static_cast<size_t>(width) * static_cast<size_t>(height) * static_cast<size_t>(channels));
 
 	stbi_image_free(stbPixels);
 }
@@ -0,0 +1,596 @@
+#include "log.h"
+#include "disable_all_warnings.h"
+DISABLE_WARNINGS_PUSH()
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdio>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace logging {
+
+namespace detail {
+    std::array<std::atomic<std::uint8_t>, static_cast<std::size_t>(Category::Count)> categoryLevels { { 2, 2, 2, 2, 2, 2 } };
+    std::atomic<bool> stopped { false };
+}
+
+static_assert(static_cast<std::size_t>(Category::Count) == 6, "update detail::categoryLevels");
+
+namespace {
+
+    using detail::DecodeFn;
+    using Clock = std::chrono::steady_clock;
+
+    constexpr std::size_t kRingBytes = 256 * 1024; // per thread, power of two
+    constexpr std::size_t kRingMask = kRingBytes - 1;
+    constexpr std::uint32_t kPaddingFlag = 0x80000000u;
+    constexpr auto kSinkInterval = std::chrono::milliseconds(10);
+
+    const Clock::time_point g_start = Clock::now();
+    std::atomic<std::uint64_t> g_written { 0 };
+    std::atomic<std::uint64_t> g_dropped { 0 };
+    std::atomic<std::uint64_t> g_suppressed { 0 };
+
+    // Ring layout: 8-byte aligned records, each a RecordHeader and its encoded arguments. A record
+    // never wraps; the bytes left before the end are skipped with a padding marker (a bare size with
+    // kPaddingFlag set).
+    struct RecordHeader {
+        std::uint32_t size; // header + payload, rounded up to 8
+        std::uint32_t payloadSize;
+        const Site* site;
+        DecodeFn decode;
+        std::int64_t timestamp; // ns since start
+    };
+    static_assert(sizeof(RecordHeader) % 8 == 0);
+
+    // Single producer (the owning thread), single consumer (the sink thread).
+    struct Ring {
+        std::unique_ptr<std::byte[]> data { std::make_unique<std::byte[]>(kRingBytes) };
+        alignas(64) std::atomic<std::size_t> head { 0 }; // bytes ever committed
+        alignas(64) std::atomic<std::size_t> tail { 0 }; // bytes ever consumed
+        alignas(64) std::size_t cachedTail { 0 }; // producer's last look at tail
+        std::atomic<bool> abandoned { false }; // owning thread exited
+    };
+
+    struct ThreadRing {
+        std::shared_ptr<Ring> ring;
+        ~ThreadRing()
+        {
+            if (ring)
+                ring->abandoned.store(true, std::memory_order_release);
+        }
+    };
+    thread_local ThreadRing t_ring;
+
+    std::int64_t nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - g_start).count();
+    }
+
+    void formatLine(fmt::memory_buffer& out, const Site& site, DecodeFn decode, const std::byte* payload, std::int64_t timestamp)
+    {
+        fmt::format_to(fmt::appender(out), "[{:10.3f}] [{}] [{}] ", static_cast<double>(timestamp) * 1e-9, levelName(site.level), categoryName(site.category));
+        try {
+            decode(payload, out, site.format);
+        } catch (const fmt::format_error& e) {
+            fmt::format_to(fmt::appender(out), "<bad format \"{}\" at {}:{}: {}>", site.format, site.file, site.line, e.what());
+        }
+        out.push_back('\n');
+    }
+
+    class ConsoleSink final : public Sink {
+    public:
+        void write(Level level, std::string_view line) override
+        {
+            std::fwrite(line.data(), 1, line.size(), level >= Level::Warning ? stderr : stdout);
+        }
+        void flush() override
+        {
+            std::fflush(stdout);
+            std::fflush(stderr);
+        }
+    };
+
+    class FileSink final : public Sink {
+    public:
+        explicit FileSink(std::FILE* file)
+            : m_file(file)
+        {
+        }
+        ~FileSink() override { std::fclose(m_file); }
+        void write(Level, std::string_view line) override { std::fwrite(line.data(), 1, line.size(), m_file); }
+        void flush() override { std::fflush(m_file); }
+
+    private:
+        std::FILE* m_file;
+    };
+
+    class Backend {
+    public:
+        static Backend& instance()
+        {
+            static Backend backend;
+            return backend;
+        }
+
+        ~Backend() { stop(); }
+
+        std::shared_ptr<Ring> registerRing()
+        {
+            auto ring = std::make_shared<Ring>();
+            std::lock_guard lock(m_ringsMutex);
+            m_rings.push_back(ring);
+            std::call_once(m_startOnce, [this]() { m_thread = std::thread(&Backend::run, this); });
+            return ring;
+        }
+
+        void addSink(std::unique_ptr<Sink> sink)
+        {
+            std::lock_guard lock(m_sinkMutex);
+            m_sinks.push_back(std::move(sink));
+        }
+
+        void setConsoleEnabled(bool enabled)
+        {
+            std::lock_guard lock(m_sinkMutex);
+            m_consoleEnabled = enabled;
+        }
+
+        [[nodiscard]] std::size_t threadCount()
+        {
+            std::lock_guard lock(m_ringsMutex);
+            return m_rings.size();
+        }
+
+        // Called by a producer whose ring just passed half full, so a burst is drained before the
+        // next timed pass. Without the lock a wake-up can be missed; the timeout covers that.
+        void wake() { m_wake.notify_one(); }
+
+        void flush()
+        {
+            std::unique_lock lock(m_wakeMutex);
+            if (!m_thread.joinable() || m_stopRequested)
+                return;
+            const std::uint64_t target = ++m_flushRequested;
+            m_wake.notify_all();
+            m_flushed.wait(lock, [&]() { return m_flushCompleted >= target || m_stopRequested; });
+        }
+
+        void stop()
+        {
+            detail::stopped.store(true);
+            {
+                std::lock_guard lock(m_wakeMutex);
+                m_stopRequested = true;
+            }
+            m_wake.notify_all();
+            m_flushed.notify_all();
+            if (m_thread.joinable())
+                m_thread.join();
+            std::lock_guard lock(m_sinkMutex);
+            m_console.flush();
+            m_sinks.clear();
+        }
+
+    private:
+        struct Pending {
+            std::int64_t timestamp;
+            Level level;
+            std::string line;
+        };
+
+        void run()
+        {
+            std::unique_lock lock(m_wakeMutex);
+            while (true) {
+                const std::uint64_t flushTarget = m_flushRequested;
+                const bool stopping = m_stopRequested;
+                lock.unlock();
+                drainAll();
+                lock.lock();
+                m_flushCompleted = flushTarget;
+                m_flushed.notify_all();
+                if (stopping)
+                    return;
+                m_wake.wait_for(lock, kSinkInterval, [&]() { return m_stopRequested || m_flushRequested != m_flushCompleted; });
+            }
+        }
+
+        void drainAll()
+        {
+            std::vector<std::shared_ptr<Ring>> rings;
+            {
+                std::lock_guard lock(m_ringsMutex);
+                rings = m_rings;
+            }
+
+            m_batch.clear();
+            fmt::memory_buffer buffer;
+            for (const std::shared_ptr<Ring>& ring : rings) {
+                std::size_t tail = ring->tail.load(std::memory_order_relaxed);
+                const std::size_t head = ring->head.load(std::memory_order_acquire);
+                while (tail != head) {
+                    const std::byte* record = ring->data.get() + (tail & kRingMask);
+                    std::uint32_t size = 0;
+                    std::memcpy(&size, record, sizeof(size));
+                    if (size & kPaddingFlag) {
+                        tail += size & ~kPaddingFlag;
+                        continue;
+                    }
+                    RecordHeader header;
+                    std::memcpy(&header, record, sizeof(header));
+                    if (header.site->category != Category::Benchmark) {
+                        buffer.clear();
+                        formatLine(buffer, *header.site, header.decode, record + sizeof(RecordHeader), header.timestamp);
+                        m_batch.push_back({ header.timestamp, header.site->level, fmt::to_string(buffer) });
+                    }
+                    tail += header.size;
+                }
+                ring->tail.store(tail, std::memory_order_release);
+            }
+
+            {
+                std::lock_guard lock(m_ringsMutex);
+                std::erase_if(m_rings, [](const std::shared_ptr<Ring>& ring) {
+                    return ring->abandoned.load(std::memory_order_acquire)
+                        && ring->tail.load(std::memory_order_relaxed) == ring->head.load(std::memory_order_acquire);
+                });
+            }
+
+            if (m_batch.empty())
+                return;
+            std::stable_sort(m_batch.begin(), m_batch.end(), [](const Pending& a, const Pending& b) { return a.timestamp < b.timestamp; });
+            std::lock_guard lock(m_sinkMutex);
+            for (const Pending& pending : m_batch) {
+                if (m_consoleEnabled)
+                    m_console.write(pending.level, pending.line);
+                for (const std::unique_ptr<Sink>& sink : m_sinks)
+                    sink->write(pending.level, pending.line);
+            }
+            m_console.flush();
+            for (const std::unique_ptr<Sink>& sink : m_sinks)
+                sink->flush();
+            g_written.fetch_add(m_batch.size(), std::memory_order_relaxed);
+        }
+
+        std::mutex m_ringsMutex;
+        std::vector<std::shared_ptr<Ring>> m_rings;
+        std::once_flag m_startOnce;
+        std::thread m_thread;
+
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_flushed;
+        std::uint64_t m_flushRequested { 0 };
+        std::uint64_t m_flushCompleted { 0 };
+        bool m_stopRequested { false };
+
+        std::mutex m_sinkMutex;
+        ConsoleSink m_console;
+        bool m_consoleEnabled { true };
+        std::vector<std::unique_ptr<Sink>> m_sinks;
+
+        std::vector<Pending> m_batch; // sink thread only
+    };
+
+    std::optional<Level> parseLevel(std::string_view name)
+    {
+        for (int i = 0; i <= static_cast<int>(Level::Off); ++i) {
+            if (levelName(static_cast<Level>(i)) == name)
+                return static_cast<Level>(i);
+        }
+        return std::nullopt;
+    }
+
+    std::string_view trim(std::string_view text)
+    {
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front())))
+            text.remove_prefix(1);
+        while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back())))
+            text.remove_suffix(1);
+        return text;
+    }
+
+}
+
+std::string_view levelName(Level level)
+{
+    switch (level) {
+    case Level::Trace:
+        return "trace";
+    case Level::Debug:
+        return "debug";
+    case Level::Info:
+        return "info";
+    case Level::Warning:
+        return "warning";
+    case Level::Error:
+        return "error";
+    case Level::Off:
+        return "off";
+    }
+    return "?";
+}
+
+std::string_view categoryName(Category category)
+{
+    switch (category) {
+    case Category::General:
+        return "general";
+    case Category::OpenGL:
+        return "opengl";
+    case Category::Texture:
+        return "texture";
+    case Category::Mesh:
+        return "mesh";
+    case Category::Scene:
+        return "scene";
+    case Category::Benchmark:
+        return "benchmark";
+    case Category::Count:
+        break;
+    }
+    return "?";
+}
+
+void setLevel(Category category, Level level)
+{
+    detail::categoryLevels[static_cast<std::size_t>(category)].store(static_cast<std::uint8_t>(level), std::memory_order_relaxed);
+}
+
+Level level(Category category)
+{
+    return static_cast<Level>(detail::categoryLevels[static_cast<std::size_t>(category)].load(std::memory_order_relaxed));
+}
+
+bool configure(std::string_view spec)
+{
+    bool valid = true;
+    while (!spec.empty()) {
+        const std::size_t comma = spec.find(',');
+        const std::string_view entry = trim(spec.substr(0, comma));
+        spec = comma == std::string_view::npos ? std::string_view {} : spec.substr(comma + 1);
+        if (entry.empty())
+            continue;
+
+        const std::size_t equals = entry.find('=');
+        const std::optional<Level> parsed = parseLevel(trim(equals == std::string_view::npos ? entry : entry.substr(equals + 1)));
+        if (!parsed) {
+            valid = false;
+            continue;
+        }
+        if (equals == std::string_view::npos) {
+            for (std::size_t i = 0; i < static_cast<std::size_t>(Category::Count); ++i)
+                setLevel(static_cast<Category>(i), *parsed);
+            continue;
+        }
+        const std::string_view name = trim(entry.substr(0, equals));
+        bool found = false;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(Category::Count); ++i) {
+            if (categoryName(static_cast<Category>(i)) == name) {
+                setLevel(static_cast<Category>(i), *parsed);
+                found = true;
+            }
+        }
+        valid &= found;
+    }
+    return valid;
+}
+
+void addSink(std::unique_ptr<Sink> sink)
+{
+    Backend::instance().addSink(std::move(sink));
+}
+
+bool addFileSink(const std::filesystem::path& path)
+{
+    std::FILE* file = std::fopen(path.string().c_str(), "w");
+    if (file == nullptr) {
+        LOG_ERROR(Category::General, "Could not open log file {}", path);
+        return false;
+    }
+    addSink(std::make_unique<FileSink>(file));
+    return true;
+}
+
+void setConsoleEnabled(bool enabled)
+{
+    Backend::instance().setConsoleEnabled(enabled);
+}
+
+void flush()
+{
+    Backend::instance().flush();
+}
+
+void shutdown()
+{
+    Backend::instance().stop();
+}
+
+Stats stats()
+{
+    Stats result;
+    result.written = g_written.load(std::memory_order_relaxed);
+    result.dropped = g_dropped.load(std::memory_order_relaxed);
+    result.suppressed = g_suppressed.load(std::memory_order_relaxed);
+    result.threads = Backend::instance().threadCount();
+    return result;
+}
+
+namespace detail {
+
+    std::byte* reserve(std::size_t payloadBytes, const Site& site, DecodeFn decode, std::size_t& ticket)
+    {
+        if (!t_ring.ring)
+            t_ring.ring = Backend::instance().registerRing();
+        Ring& ring = *t_ring.ring;
+
+        const std::size_t size = (sizeof(RecordHeader) + payloadBytes + 7) & ~std::size_t { 7 };
+        if (size > kRingBytes / 4) {
+            g_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        std::size_t head = ring.head.load(std::memory_order_relaxed);
+        std::size_t offset = head & kRingMask;
+        const std::size_t contiguous = kRingBytes - offset;
+        const std::size_t needed = size <= contiguous ? size : contiguous + size;
+        if (head + needed - ring.cachedTail > kRingBytes) {
+            ring.cachedTail = ring.tail.load(std::memory_order_acquire);
+            if (head + needed - ring.cachedTail > kRingBytes) {
+                g_dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+        if (size > contiguous) {
+            const auto padding = static_cast<std::uint32_t>(contiguous) | kPaddingFlag;
+            std::memcpy(ring.data.get() + offset, &padding, sizeof(padding));
+            head += contiguous;
+            offset = 0;
+        }
+
+        const RecordHeader header { static_cast<std::uint32_t>(size), static_cast<std::uint32_t>(payloadBytes), &site, decode, nowNs() };
+        std::memcpy(ring.data.get() + offset, &header, sizeof(header));
+        ticket = head + size;
+        if (ticket - ring.cachedTail > kRingBytes / 2 && head - ring.cachedTail <= kRingBytes / 2)
+            Backend::instance().wake();
+        return ring.data.get() + offset + sizeof(RecordHeader);
+    }
+
+    void commit(std::size_t ticket)
+    {
+        t_ring.ring->head.store(ticket, std::memory_order_release);
+    }
+
+    void writeSynchronously(const Site& site, DecodeFn decode, const std::byte* payload)
+    {
+        if (site.category == Category::Benchmark)
+            return;
+        fmt::memory_buffer buffer;
+        formatLine(buffer, site, decode, payload, nowNs());
+        std::fwrite(buffer.data(), 1, buffer.size(), site.level >= Level::Warning ? stderr : stdout);
+        g_written.fetch_add(1, std::memory_order_relaxed);
+    }
+
+}
+
+RateLimiter::RateLimiter(std::uint32_t burst, std::chrono::milliseconds window)
+    : m_burst(std::max(burst, 1u))
+    , m_windowNs(std::chrono::duration_cast<std::chrono::nanoseconds>(window).count())
+{
+}
+
+bool RateLimiter::allow(std::uint64_t key, std::uint32_t& suppressed)
+{
+    suppressed = 0;
+    const std::int64_t now = nowNs();
+    std::lock_guard lock(m_mutex);
+
+    Entry* entry = nullptr;
+    Entry* oldest = &m_entries[0];
+    for (Entry& candidate : m_entries) {
+        if (candidate.used && candidate.key == key) {
+            entry = &candidate;
+            break;
+        }
+        if (!candidate.used || (oldest->used && candidate.windowStart < oldest->windowStart))
+            oldest = &candidate;
+    }
+    if (entry == nullptr) {
+        entry = oldest;
+        *entry = Entry { key, now, 0, 0, true };
+    }
+
+    if (now - entry->windowStart >= m_windowNs) {
+        entry->windowStart = now;
+        entry->count = 0;
+    }
+    if (entry->count < m_burst) {
+        ++entry->count;
+        suppressed = entry->suppressed;
+        entry->suppressed = 0;
+        return true;
+    }
+    ++entry->suppressed;
+    g_suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+BenchmarkResult benchmarkCallSite(int iterations)
+{
+    constexpr int kBatch = 2048; // records per timed run; flushed in between so the ring never fills
+    BenchmarkResult result;
+    result.iterations = std::max(iterations, 1);
+    const Level previous = level(Category::Benchmark);
+    const auto elapsedNs = [](Clock::time_point start) { return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count()); };
+
+    setLevel(Category::Benchmark, Level::Info);
+    double logged = 0.0;
+    for (int done = 0; done < result.iterations; done += kBatch) {
+        const int count = std::min(kBatch, result.iterations - done);
+        const Clock::time_point start = Clock::now();
+        for (int i = 0; i < count; ++i)
+            LOG_INFO(Category::Benchmark, "record {} value={} texture={}", i, 0.5f * static_cast<float>(i), "albedo.png");
+        logged += elapsedNs(start);
+        flush();
+    }
+    result.loggedNs = logged / result.iterations;
+
+    setLevel(Category::Benchmark, Level::Off);
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < result.iterations; ++i)
+        LOG_INFO(Category::Benchmark, "record {} value={} texture={}", i, 0.5f * static_cast<float>(i), "albedo.png");
+    result.filteredNs = elapsedNs(start) / result.iterations;
+    setLevel(Category::Benchmark, previous);
+
+    std::size_t characters = 0;
+    start = Clock::now();
+    for (int i = 0; i < result.iterations; ++i)
+        characters += fmt::format("record {} value={} texture={}", i, 0.5f * static_cast<float>(i), "albedo.png").size();
+    result.formatNs = elapsedNs(start) / result.iterations;
+    if (characters == 0)
+        result.formatNs = 0.0;
+    return result;
+}
+
+void drawImGuiPanel()
+{
+    static BenchmarkResult s_benchmark;
+    static bool s_console = true;
+
+    const Stats current = stats();
+    ImGui::Text("Written: %llu  Dropped: %llu  Rate limited: %llu", static_cast<unsigned long long>(current.written),
+        static_cast<unsigned long long>(current.dropped), static_cast<unsigned long long>(current.suppressed));
+    ImGui::Text("Threads with a ring: %zu (%zu KiB each)", current.threads, kRingBytes / 1024);
+    if (ImGui::Checkbox("Console Output", &s_console))
+        setConsoleEnabled(s_console);
+
+    for (std::size_t i = 0; i < static_cast<std::size_t>(Category::Count); ++i) {
+        const auto category = static_cast<Category>(i);
+        if (category == Category::Benchmark)
+            continue;
+        int selected = static_cast<int>(level(category));
+        const std::string label = fmt::format("{}##loglevel", categoryName(category));
+        if (ImGui::Combo(label.c_str(), &selected, "trace\0debug\0info\0warning\0error\0off\0"))
+            setLevel(category, static_cast<Level>(selected));
+    }
+    ImGui::TextDisabled("Compiled out below: %s", std::string(levelName(compileLevel)).c_str());
+
+    if (ImGui::Button("Benchmark Call Site")) {
+        s_benchmark = benchmarkCallSite(100000);
+        LOG_INFO(Category::General, "[Log] Call site: {:.1f} ns logged, {:.1f} ns filtered, {:.1f} ns to format on the caller",
+            s_benchmark.loggedNs, s_benchmark.filteredNs, s_benchmark.formatNs);
+    }
+    if (s_benchmark.iterations > 0) {
+        ImGui::Text("Logged: %.1f ns/call", s_benchmark.loggedNs);
+        ImGui::Text("Filtered: %.1f ns/call", s_benchmark.filteredNs);
+        ImGui::Text("fmt::format on caller: %.1f ns/call", s_benchmark.formatNs);
+    }
+}
+
+}
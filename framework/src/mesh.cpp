@@ -1,4 +1,5 @@
 #include "mesh.h"
+#include "file_provider.h"
 // Suppress warnings in third-party code.
 #include <framework/disable_all_warnings.h>
 DISABLE_WARNINGS_PUSH()
@@ -16,12 +17,56 @@ DISABLE_WARNINGS_POP()
 #include <span>
 #include <stack>
 #include <string>
+#include <string_view>
+#include <istream>
+#include <optional>
 #include <tuple>
 #include <map>
 #include <cmath>
 
 static void centerAndScaleToUnitMesh(std::span<Mesh> meshes);
 
+namespace {
+
+// Lets tinyobjloader parse straight out of a FileData without copying it into a string.
+class MemoryStreamBuffer : public std::streambuf {
+public:
+    explicit MemoryStreamBuffer(std::string_view bytes)
+    {
+        char* begin = const_cast<char*>(bytes.data());
+        setg(begin, begin, begin + bytes.size());
+    }
+};
+
+// Resolves mtllib references relative to the .obj through the active FileProvider.
+class ProviderMaterialReader : public tinyobj::MaterialReader {
+public:
+    explicit ProviderMaterialReader(std::filesystem::path baseDir)
+        : m_baseDir(std::move(baseDir))
+    {
+    }
+
+    bool operator()(const std::string& matId, std::vector<tinyobj::material_t>* materials,
+        std::map<std::string, int>* matMap, std::string* warn, std::string* err) override
+    {
+        const std::optional<FileData> file = readFileData(m_baseDir / matId);
+        if (!file) {
+            if (warn)
+                *warn += "Material file [ " + matId + " ] not found.\n";
+            return false;
+        }
+        MemoryStreamBuffer buffer(file->text());
+        std::istream stream(&buffer);
+        tinyobj::LoadMtl(matMap, materials, &stream, warn, err);
+        return true;
+    }
+
+private:
+    std::filesystem::path m_baseDir;
+};
+
+}
+
 static glm::vec3 construct_vec3(const float* pFloats)
 {
     return glm::vec3(pFloats[0], pFloats[1], pFloats[2]);
@@ -110,19 +155,22 @@ static void computeTangents(Mesh& mesh)
 
 std::vector<Mesh> loadMesh(const std::filesystem::path& file, const LoadMeshSettings& settings)
 {
-    if (!std::filesystem::exists(file)) {
+    const std::optional<FileData> fileData = readFileData(file);
+    if (!fileData) {
         std::cerr << "File " << file << " does not exist." << std::endl;
         throw std::exception();
     }
 
-    const auto baseDir = file.parent_path();
+    MemoryStreamBuffer objBuffer(fileData->text());
+    std::istream objStream(&objBuffer);
+    ProviderMaterialReader materialReader(file.parent_path());
 
     tinyobj::attrib_t inAttrib;
     std::vector<tinyobj::shape_t> inShapes;
     std::vector<tinyobj::material_t> inMaterials;
 
     std::string warn, error;
-    bool ret = tinyobj::LoadObj(&inAttrib, &inShapes, &inMaterials, &warn, &error, file.string().c_str(), baseDir.string().c_str());
+    bool ret = tinyobj::LoadObj(&inAttrib, &inShapes, &inMaterials, &warn, &error, &objStream, &materialReader);
     if (!ret) {
         std::cerr << "Failed to load mesh " << file << std::endl;
         throw std::exception();
@@ -191,7 +239,7 @@ std::vector<Mesh> loadMesh(const std::filesystem::path& file, const LoadMeshSett
                 const auto& objMaterial = inMaterials[materialID];
                 mesh.material.kd = construct_vec3(objMaterial.diffuse);
                 if (!objMaterial.diffuse_texname.empty()) {
-                    mesh.material.kdTexture = std::make_shared<Image>(baseDir / objMaterial.diffuse_texname);
+                    mesh.material.kdTexture = std::make_shared<Image>(file.parent_path() / objMaterial.diffuse_texname);
                 }
                 mesh.material.ks = construct_vec3(objMaterial.specular);
                 mesh.material.shininess = objMaterial.shininess;
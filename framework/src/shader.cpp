@@ -1,4 +1,5 @@
 #include "shader.h"
+#include "file_provider.h"
 #include <framework/disable_all_warnings.h>
 DISABLE_WARNINGS_PUSH()
 #include <fmt/format.h>
@@ -82,7 +83,7 @@ ShaderBuilder::~ShaderBuilder()
 
 ShaderBuilder& ShaderBuilder::addStage(GLuint shaderStage, std::filesystem::path shaderFile)
 {
-    if (!std::filesystem::exists(shaderFile)) {
+    if (!fileExists(shaderFile)) {
         throw ShaderLoadingException(fmt::format("File {} does not exist", shaderFile.string().c_str()));
     }
 
@@ -125,13 +126,10 @@ void ShaderBuilder::freeShaders()
 
 static std::string readFile(const std::filesystem::path& filePath)
 {
-    std::ifstream file(filePath, std::ios::binary);
+    const std::optional<FileData> file = readFileData(filePath);
     if (!file)
         throw ShaderLoadingException(fmt::format("Failed to open shader file {}", filePath.string()));
-
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    return std::string(file->text());
 }
 
 static void ensureNoIncludeDirective(const std::filesystem::path& filePath, const std::string& source)
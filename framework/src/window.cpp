@@ -1,17 +1,18 @@
 #include "window.h"
+#include "log.h"
 #include <imgui/imgui.h>
 #include <imgui/imgui_impl_glfw.h>
 #include <imgui/imgui_impl_opengl2.h>
 #undef IMGUI_IMPL_OPENGL_LOADER_GLEW
 #define IMGUI_IMPL_OPENGL_LOADER_GLAD 1
 #include <imgui/imgui_impl_opengl3.h>
+#include <cstring>
 #include <iostream>
 #include <stb/stb_image_write.h>
 
 static void glfwErrorCallback(int error, const char* description)
 {
-    std::cerr << "GLFW error code: " << error << std::endl;
-    std::cerr << description << std::endl;
+    LOG_ERROR(logging::Category::General, "GLFW error code: {}\n{}", error, description);
     exit(1);
 }
 
@@ -19,9 +20,17 @@ static void glfwErrorCallback(int error, const char* description)
 // OpenGL debug callback
 void APIENTRY glDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam)
 {
-    if (severity != GL_DEBUG_SEVERITY_NOTIFICATION && type != GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR) {
-        std::cerr << "OpenGL: " << message << std::endl;
-    }
+    // Drivers repeat the same message every frame; limit each (source, type, id) to a burst per second.
+    const std::uint64_t key = (static_cast<std::uint64_t>(source) << 48) ^ (static_cast<std::uint64_t>(type) << 32) ^ id;
+    const std::string_view text(message, length >= 0 ? static_cast<std::size_t>(length) : std::strlen(message));
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION || type == GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR)
+        LOG_RATE_LIMITED(logging::Level::Debug, logging::Category::OpenGL, key, "OpenGL: {}", text);
+    else if (severity == GL_DEBUG_SEVERITY_HIGH)
+        LOG_RATE_LIMITED(logging::Level::Error, logging::Category::OpenGL, key, "OpenGL: {}", text);
+    else if (severity == GL_DEBUG_SEVERITY_MEDIUM)
+        LOG_RATE_LIMITED(logging::Level::Warning, logging::Category::OpenGL, key, "OpenGL: {}", text);
+    else
+        LOG_RATE_LIMITED(logging::Level::Info, logging::Category::OpenGL, key, "OpenGL: {}", text);
 }
 #endif
 
@@ -30,7 +39,7 @@ Window::Window(std::string_view title, const glm::ivec2& windowSize, OpenGLVersi
 {
     glfwSetErrorCallback(glfwErrorCallback);
     if (!glfwInit()) {
-        std::cerr << "Could not initialize GLFW" << std::endl;
+        LOG_ERROR(logging::Category::General, "Could not initialize GLFW");
         exit(1);
     }
 
@@ -74,11 +83,11 @@ Window::Window(std::string_view title, const glm::ivec2& windowSize, OpenGLVersi
     m_pWindow = glfwCreateWindow(windowSize.x, windowSize.y, titleString.c_str(), nullptr, nullptr);
     if (m_pWindow == nullptr) {
         glfwTerminate();
-        std::cerr << "Could not create GLFW window" << std::endl;
+        LOG_ERROR(logging::Category::General, "Could not create GLFW window");
         exit(1);
     }
     glfwMakeContextCurrent(m_pWindow);
-    glfwSwapInterval(1); // Enable vsync. To disable vsync set this to 0.
+    glfwSwapInterval(m_swapInterval); // Enable vsync. Use setSwapInterval() to change it at runtime.
 
     float xScale, yScale;
     glfwGetWindowContentScale(m_pWindow, &xScale, &yScale);
@@ -89,13 +98,13 @@ Window::Window(std::string_view title, const glm::ivec2& windowSize, OpenGLVersi
     if (m_presentable) {
         if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
             glfwTerminate();
-            std::cerr << "Could not initialize GLEW" << std::endl;
+            LOG_ERROR(logging::Category::General, "Could not initialize GLEW");
             exit(1);
         }
         int glVersionMajor, glVersionMinor;
         glGetIntegerv(GL_MAJOR_VERSION, &glVersionMajor);
         glGetIntegerv(GL_MINOR_VERSION, &glVersionMinor);
-        std::cout << "Initialized OpenGL version " << glVersionMajor << "." << glVersionMinor << std::endl;
+        LOG_INFO(logging::Category::OpenGL, "Initialized OpenGL version {}.{}", glVersionMajor, glVersionMinor);
 
         // NOTE(Mathijs): this is not supported on macOS since Apple can't be bothered to update
         //  their OpenGL version past 4.1 which released in 2010!
@@ -125,7 +134,7 @@ Window::Window(std::string_view title, const glm::ivec2& windowSize, OpenGLVersi
         switch (glVersion) {
         case OpenGLVersion::GL2: {
             if (!ImGui_ImplOpenGL2_Init()) {
-                std::cerr << "Could not initialize imgui" << std::endl;
+                LOG_ERROR(logging::Category::General, "Could not initialize imgui");
                 exit(1);
             }
         } break;
@@ -133,13 +142,13 @@ Window::Window(std::string_view title, const glm::ivec2& windowSize, OpenGLVersi
         } break;
         case OpenGLVersion::GL41: {
             if (!ImGui_ImplOpenGL3_Init()) {
-                std::cerr << "Could not initialize imgui" << std::endl;
+                LOG_ERROR(logging::Category::General, "Could not initialize imgui");
                 exit(1);
             }
         } break;
         case OpenGLVersion::GL45: {
             if (!ImGui_ImplOpenGL3_Init()) {
-                std::cerr << "Could not initialize imgui" << std::endl;
+                LOG_ERROR(logging::Category::General, "Could not initialize imgui");
                 exit(1);
             }
         } break;
@@ -210,7 +219,11 @@ void Window::updateInput()
         } break;
         };
         ImGui_ImplGlfw_NewFrame();
+        if (m_inputHook)
+            m_inputHook();
         ImGui::NewFrame();
+    } else if (m_inputHook) {
+        m_inputHook();
     }
 }
 
@@ -238,6 +251,29 @@ void Window::swapBuffers()
     glfwSwapBuffers(m_pWindow);
 }
 
+void Window::setSwapInterval(int interval)
+{
+    if (interval < 0 && !supportsAdaptiveVsync())
+        interval = 1;
+    if (interval == m_swapInterval)
+        return;
+
+    glfwMakeContextCurrent(m_pWindow);
+    glfwSwapInterval(interval);
+    m_swapInterval = interval;
+}
+
+int Window::swapInterval() const
+{
+    return m_swapInterval;
+}
+
+bool Window::supportsAdaptiveVsync() const
+{
+    // Negative swap intervals ("swap tear") are only honoured when the platform exposes the extension.
+    return glfwExtensionSupported("WGL_EXT_swap_control_tear") == GLFW_TRUE
+        || glfwExtensionSupported("GLX_EXT_swap_control_tear") == GLFW_TRUE;
+}
 
 void Window::renderToImage (const std::filesystem::path& filePath, const bool flipY) {
         std::vector <GLubyte> pixels;
@@ -298,62 +334,92 @@ void Window::registerMouseMoveCallback(MouseMoveCallback&& callback)
 
 void Window::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-    ImGui_ImplGlfw_KeyCallback(window, key, scancode, action, mods);
-
-    // Ignore callbacks when the user is interacting with imgui.
-    if (ImGui::GetIO().WantCaptureKeyboard)
+    const InputEvent event { InputEvent::Type::Key, key, scancode, action, mods };
+    if (!acceptLiveEvent(window, event))
         return;
 
-    const Window* pThisWindow = static_cast<const Window*>(glfwGetWindowUserPointer(window));
-    for (auto& callback : pThisWindow->m_keyCallbacks)
-        callback(key, scancode, action, mods);
+    ImGui_ImplGlfw_KeyCallback(window, key, scancode, action, mods);
+    static_cast<Window*>(glfwGetWindowUserPointer(window))->dispatchInputEvent(event);
 }
 
 void Window::charCallback(GLFWwindow* window, unsigned unicodeCodePoint)
 {
-    ImGui_ImplGlfw_CharCallback(window, unicodeCodePoint);
-
-    // Ignore callbacks when the user is interacting with imgui.
-    if (ImGui::GetIO().WantCaptureKeyboard) {
+    const InputEvent event { InputEvent::Type::Char, static_cast<int>(unicodeCodePoint) };
+    if (!acceptLiveEvent(window, event))
         return;
-    }
 
-    const Window* pThisWindow = static_cast<const Window*>(glfwGetWindowUserPointer(window));
-    for (auto& callback : pThisWindow->m_charCallbacks)
-        callback(unicodeCodePoint);
+    ImGui_ImplGlfw_CharCallback(window, unicodeCodePoint);
+    static_cast<Window*>(glfwGetWindowUserPointer(window))->dispatchInputEvent(event);
 }
 
 void Window::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
-    // Ignore callbacks when the user is interacting with imgui.
-    if (ImGui::GetIO().WantCaptureMouse)
-        return;
-
-    const Window* pThisWindow = static_cast<const Window*>(glfwGetWindowUserPointer(window));
-    for (auto& callback : pThisWindow->m_mouseButtonCallbacks)
-        callback(button, action, mods);
+    const InputEvent event { InputEvent::Type::MouseButton, button, 0, action, mods };
+    if (acceptLiveEvent(window, event))
+        static_cast<Window*>(glfwGetWindowUserPointer(window))->dispatchInputEvent(event);
 }
 
 void Window::mouseMoveCallback(GLFWwindow* window, double xpos, double ypos)
 {
-    // Ignore callbacks when the user is interacting with imgui.
-    if (ImGui::GetIO().WantCaptureMouse)
-        return;
-
-    const Window* pThisWindow = static_cast<const Window*>(glfwGetWindowUserPointer(window));
-    for (auto& callback : pThisWindow->m_mouseMoveCallbacks)
-        callback(glm::vec2(xpos, pThisWindow->m_windowSize.y - 1 - ypos));
+    const InputEvent event { InputEvent::Type::MouseMove, 0, 0, 0, 0, glm::vec2(xpos, ypos) };
+    if (acceptLiveEvent(window, event))
+        static_cast<Window*>(glfwGetWindowUserPointer(window))->dispatchInputEvent(event);
 }
 
 void Window::scrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 {
-    // Ignore callbacks when the user is interacting with imgui.
-    if (ImGui::GetIO().WantCaptureMouse)
-        return;
+    const InputEvent event { InputEvent::Type::Scroll, 0, 0, 0, 0, glm::vec2(xoffset, yoffset) };
+    if (acceptLiveEvent(window, event))
+        static_cast<Window*>(glfwGetWindowUserPointer(window))->dispatchInputEvent(event);
+}
 
+bool Window::acceptLiveEvent(GLFWwindow* window, const InputEvent& event)
+{
     const Window* pThisWindow = static_cast<const Window*>(glfwGetWindowUserPointer(window));
-    for (auto& callback : pThisWindow->m_scrollCallbacks)
-        callback(glm::vec2(xoffset, yoffset));
+    // During a replay the recorded events stand in for the devices.
+    if (pThisWindow->m_inputOverride)
+        return false;
+    if (pThisWindow->m_inputEventObserver)
+        pThisWindow->m_inputEventObserver(event);
+    return true;
+}
+
+void Window::dispatchInputEvent(const InputEvent& event)
+{
+    // Ignore events when the user is interacting with imgui.
+    const ImGuiIO& io = ImGui::GetIO();
+    switch (event.type) {
+    case InputEvent::Type::Key:
+        if (!io.WantCaptureKeyboard) {
+            for (auto& callback : m_keyCallbacks)
+                callback(event.code, event.scancode, event.action, event.mods);
+        }
+        break;
+    case InputEvent::Type::Char:
+        if (!io.WantCaptureKeyboard) {
+            for (auto& callback : m_charCallbacks)
+                callback(static_cast<unsigned>(event.code));
+        }
+        break;
+    case InputEvent::Type::MouseButton:
+        if (!io.WantCaptureMouse) {
+            for (auto& callback : m_mouseButtonCallbacks)
+                callback(event.code, event.action, event.mods);
+        }
+        break;
+    case InputEvent::Type::MouseMove:
+        if (!io.WantCaptureMouse) {
+            for (auto& callback : m_mouseMoveCallbacks)
+                callback(glm::vec2(event.value.x, static_cast<float>(m_windowSize.y - 1) - event.value.y));
+        }
+        break;
+    case InputEvent::Type::Scroll:
+        if (!io.WantCaptureMouse) {
+            for (auto& callback : m_scrollCallbacks)
+                callback(event.value);
+        }
+        break;
+    }
 }
 
 void Window::windowSizeCallback(GLFWwindow* window, int width, int height)
@@ -367,16 +433,54 @@ void Window::windowSizeCallback(GLFWwindow* window, int width, int height)
 
 bool Window::isKeyPressed(int key) const
 {
+    // Keys outside the polled range read as released both live and during replay.
+    if (key < PolledInput::kFirstKey || key > PolledInput::kLastKey)
+        return false;
+    if (m_inputOverride)
+        return m_inputOverride->keys.test(static_cast<std::size_t>(key));
     return glfwGetKey(m_pWindow, key) == GLFW_PRESS;
 }
 
 bool Window::isMouseButtonPressed(int button) const
 {
+    if (m_inputOverride)
+        return button >= 0 && button <= GLFW_MOUSE_BUTTON_LAST && m_inputOverride->mouseButtons.test(static_cast<std::size_t>(button));
     return glfwGetMouseButton(m_pWindow, button) == GLFW_PRESS;
 }
 
+Window::PolledInput Window::pollDevices() const
+{
+    PolledInput input;
+    // glfwGetKey only accepts the printable..last range; the error callback would abort on anything else.
+    for (int key = PolledInput::kFirstKey; key <= PolledInput::kLastKey; ++key)
+        input.keys.set(static_cast<std::size_t>(key), glfwGetKey(m_pWindow, key) == GLFW_PRESS);
+    for (int button = 0; button <= GLFW_MOUSE_BUTTON_LAST; ++button)
+        input.mouseButtons.set(static_cast<std::size_t>(button), glfwGetMouseButton(m_pWindow, button) == GLFW_PRESS);
+    double x, y;
+    glfwGetCursorPos(m_pWindow, &x, &y);
+    input.cursorPos = glm::vec2(x, m_windowSize.y - 1 - y);
+    return input;
+}
+
+void Window::setInputOverride(const PolledInput* input)
+{
+    m_inputOverride = input;
+}
+
+void Window::setInputEventObserver(InputEventObserver&& observer)
+{
+    m_inputEventObserver = std::move(observer);
+}
+
+void Window::setInputHook(InputHook&& hook)
+{
+    m_inputHook = std::move(hook);
+}
+
 glm::vec2 Window::getCursorPos() const
 {
+    if (m_inputOverride)
+        return m_inputOverride->cursorPos;
     double x, y;
     glfwGetCursorPos(m_pWindow, &x, &y);
     return glm::vec2(x, m_windowSize.y - 1 - y);
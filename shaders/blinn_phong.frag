@@ -6,6 +6,7 @@ in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord0;
 in vec2 TexCoord1;
+in vec4 VertexOcclusion;
 in vec3 Tangent;
 in vec3 Bitangent;
 in vec3 TangentLightPos;
@@ -23,6 +24,9 @@ layout(std140, binding = 3) uniform PerFrameDataBlock {
     vec4 ambientColorStrength;
     ivec4 frameFlags;
     vec4 envParams;
+    vec4 probeGridOrigin;
+    vec4 probeGridInvSpacing;
+    ivec4 probeGridResolution;
 } uFrame;
 
 uniform bool uFogEnabled;
@@ -58,6 +62,8 @@ struct MaterialData {
     vec4 uvTransformEmissive;
     vec4 uvRotations;
     vec4 uvRotations2;
+    ivec4 arrayRefs0;      // packed (array << 16 | layer) per texture, -1 when bound standalone
+    ivec4 arrayRefs1;      // x: emissive
 };
 
 layout(std430, binding = 2) readonly buffer MaterialBuffer {
@@ -70,6 +76,15 @@ layout(binding = 3) uniform sampler2D uAOMap;
 layout(binding = 4) uniform sampler2D uEmissiveMap;
 // Optional: user-provided height map (not bound by default)
 layout(binding = 5) uniform sampler2D uHeightMap;
+// Shared material texture arrays; units are assigned at runtime (see TextureUnits::MaterialArray_Units).
+layout(binding = 20) uniform sampler2DArray uMaterialArrays[8];
+
+vec4 sampleMaterialTexture(sampler2D standalone, int packedRef, vec2 uv)
+{
+    if (packedRef >= 0)
+        return texture(uMaterialArrays[packedRef >> 16], vec3(uv, float(packedRef & 0xFFFF)));
+    return texture(standalone, uv);
+}
 
 struct GpuLight {
     vec4 positionType;
@@ -78,7 +93,7 @@ struct GpuLight {
     vec4 spotShadow;
     vec4 shadowParams;
     vec4 attenuation;
-    vec4 extra;
+    vec4 extra; // x: range, y: enabled
 };
 
 layout(std430, binding = 0) buffer LightBuffer { GpuLight uLights[]; };
@@ -95,6 +110,46 @@ layout(std140, binding = 1) uniform ShadowDataBlock {
 layout(binding = 7) uniform sampler2DArrayShadow uShadowMapArray;
 layout(binding = 13) uniform samplerCubeShadow uPointShadowMaps[8];
 
+// Irradiance probe grid (IrradianceProbeGrid): 7 slabs stacked along z hold the L2 SH coefficients
+// premultiplied by validity, with validity in the first slab's alpha.
+layout(binding = 6) uniform sampler3D uProbeAtlas;
+
+// `biasNormal` offsets the lookup position away from the surface; `n` is the direction evaluated.
+bool sampleProbeIrradiance(vec3 position, vec3 biasNormal, vec3 n, out vec3 irradiance)
+{
+    irradiance = vec3(0.0);
+    float intensity = uFrame.probeGridOrigin.w;
+    if (intensity <= 0.0)
+        return false;
+
+    vec3 res = vec3(uFrame.probeGridResolution.xyz);
+    vec3 g = clamp((position + biasNormal * uFrame.probeGridInvSpacing.w - uFrame.probeGridOrigin.xyz) * uFrame.probeGridInvSpacing.xyz,
+                   vec3(0.0), res - 1.0);
+    vec2 uv = (g.xy + 0.5) / res.xy;
+    float slabDepth = res.z * 7.0;
+    vec4 s0 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5) / slabDepth));
+    if (s0.a < 1e-3)
+        return false;
+    vec4 s1 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + res.z) / slabDepth));
+    vec4 s2 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + 2.0 * res.z) / slabDepth));
+    vec4 s3 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + 3.0 * res.z) / slabDepth));
+    vec4 s4 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + 4.0 * res.z) / slabDepth));
+    vec4 s5 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + 5.0 * res.z) / slabDepth));
+    vec4 s6 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + 6.0 * res.z) / slabDepth));
+
+    vec3 sh = s0.rgb * 0.282095
+            + s1.rgb * (0.488603 * n.y)
+            + vec3(s1.a, s2.rg) * (0.488603 * n.z)
+            + vec3(s2.ba, s3.r) * (0.488603 * n.x)
+            + s3.gba * (1.092548 * n.x * n.y)
+            + s4.rgb * (1.092548 * n.y * n.z)
+            + vec3(s4.a, s5.rg) * (0.315392 * (3.0 * n.z * n.z - 1.0))
+            + vec3(s5.ba, s6.r) * (1.092548 * n.x * n.z)
+            + s6.gba * (0.546274 * (n.x * n.x - n.y * n.y));
+    irradiance = max(sh / s0.a, vec3(0.0)) * intensity;
+    return true;
+}
+
 const int LIGHT_TYPE_POINT = 0;
 const int LIGHT_TYPE_SPOT = 1;
 const int MAX_SHADOW_SLOTS = 8;
@@ -165,7 +220,7 @@ mat3 orthonormalizeTBN(vec3 T, vec3 B, vec3 N)
 }
 
 // --- Basic parallax UV offset ---
-float sampleHeightValue(vec2 uv, bool canUseNormalAlpha)
+float sampleHeightValue(vec2 uv, bool canUseNormalAlpha, int normalRef)
 {
     // 1) Prefer a dedicated height map when provided
     if (uHasHeightMap)
@@ -173,7 +228,7 @@ float sampleHeightValue(vec2 uv, bool canUseNormalAlpha)
 
     // 2) Optional: derive height from normal map
     if (canUseNormalAlpha) {
-        vec4 n = texture(uNormalMap, uv);
+        vec4 n = sampleMaterialTexture(uNormalMap, normalRef, uv);
         float a = n.a;
 
         // Heuristics: if alpha is effectively constant (near 0 or 1)
@@ -192,15 +247,15 @@ float sampleHeightValue(vec2 uv, bool canUseNormalAlpha)
 }
 
 // LearnOpenGL tutorial parallax mapping
-vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir, bool canUseNormalAlpha)
+vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir, bool canUseNormalAlpha, int normalRef)
 {
-    float height = sampleHeightValue(texCoords, canUseNormalAlpha);
+    float height = sampleHeightValue(texCoords, canUseNormalAlpha, normalRef);
     float sign = uParallaxInvertOffset ? -1.0 : 1.0;
     vec2 p = viewDir.xy / viewDir.z * (height * uParallaxScale);
     return texCoords - (sign * p);
 }
 
-vec3 computeNormal(vec2 normalUV, bool useNormalMap, float strength, int hasTangents)
+vec3 computeNormal(vec2 normalUV, bool useNormalMap, float strength, int hasTangents, int normalRef)
 {
     vec3 N = normalize(Normal);
     if (!gl_FrontFacing)
@@ -208,7 +263,7 @@ vec3 computeNormal(vec2 normalUV, bool useNormalMap, float strength, int hasTang
     if (!useNormalMap || strength <= 0.0)
         return N;
 
-    vec3 tangentNormal = decodeNormal(texture(uNormalMap, normalUV).xyz);
+    vec3 tangentNormal = decodeNormal(sampleMaterialTexture(uNormalMap, normalRef, normalUV).xyz);
     tangentNormal.xy *= strength;
     tangentNormal = normalize(tangentNormal);
 
@@ -296,7 +351,7 @@ float sampleSpotShadow(GpuLight light, vec3 fragPos, vec3 N, vec3 L)
 
     vec2 texel = vec2(texelSize);
     float visibility = 0.0;
-    int kernelRadius = 1;
+    int kernelRadius = clamp(int(shadowUniform.params.w + 0.5), 0, 3);
     int taps = 0;
     for (int y = -kernelRadius; y <= kernelRadius; ++y) {
         for (int x = -kernelRadius; x <= kernelRadius; ++x) {
@@ -422,16 +477,16 @@ void main()
     if (uParallaxEnabled) {
         bool canUseNormalAlpha = uParallaxUseNormalAlpha && (useNormalMap);
         vec3 viewDir = normalize(TangentViewPos - TangentFragPos);
-        albedoUV = ParallaxMapping(albedoUV, viewDir, canUseNormalAlpha);
-        normalUV = ParallaxMapping(normalUV, viewDir, canUseNormalAlpha);
-        aoUV = ParallaxMapping(aoUV, viewDir, canUseNormalAlpha);
-        emissiveUV = ParallaxMapping(emissiveUV, viewDir, canUseNormalAlpha);
+        albedoUV = ParallaxMapping(albedoUV, viewDir, canUseNormalAlpha, material.arrayRefs0.z);
+        normalUV = ParallaxMapping(normalUV, viewDir, canUseNormalAlpha, material.arrayRefs0.z);
+        aoUV = ParallaxMapping(aoUV, viewDir, canUseNormalAlpha, material.arrayRefs0.z);
+        emissiveUV = ParallaxMapping(emissiveUV, viewDir, canUseNormalAlpha, material.arrayRefs0.z);
     }
 
     vec3 diffuseColor = clamp(material.diffuseColor.rgb, vec3(0.0), vec3(1.0));
     float alpha = clamp(material.baseColor.a, 0.0, 1.0);
     if (useAlbedoMap) {
-        vec4 tex = texture(uAlbedoMap, albedoUV);
+        vec4 tex = sampleMaterialTexture(uAlbedoMap, material.arrayRefs0.x, albedoUV);
         diffuseColor *= tex.rgb;
         alpha *= tex.a;
     }
@@ -451,7 +506,7 @@ void main()
     float emissiveIntensity = max(material.emissiveColorIntensity.a, 0.0);
     vec3 emissive = emissiveColor;
     if (useEmissiveMap)
-        emissive += texture(uEmissiveMap, emissiveUV).rgb;
+        emissive += sampleMaterialTexture(uEmissiveMap, material.arrayRefs1.x, emissiveUV).rgb;
     emissive *= emissiveIntensity;
 
     if (unlit) {
@@ -464,7 +519,7 @@ void main()
     float normalStrength = max(material.extraParams.y, 0.0);
     float normalCombinedStrength = normalScale * normalStrength;
 
-    vec3 N = computeNormal(normalUV, useNormalMap, normalCombinedStrength, hasTangents);
+    vec3 N = computeNormal(normalUV, useNormalMap, normalCombinedStrength, hasTangents, material.arrayRefs0.z);
     vec3 V = normalize(uFrame.cameraPos.xyz - FragPos);
 
     vec3 specularColor = clamp(material.specularColor.rgb, vec3(0.0), vec3(1.0));
@@ -474,6 +529,8 @@ void main()
     int lightCount = max(uFrame.frameFlags.x, 0);
     if (lightCount > 0) {
         for (int i = 0; i < lightCount; ++i) {
+            if (uLights[i].extra.y < 0.5) // disabled slot
+                continue;
             directLighting += evaluateBlinnLight(uLights[i], FragPos, N, V, diffuseColor, specularColor, shininess);
         }
     } else {
@@ -492,12 +549,17 @@ void main()
     float aoIntensity = max(material.pbrParams.w, 0.0);
     float aoSample = 1.0;
     if (useAOMap)
-        aoSample = clamp(texture(uAOMap, aoUV).r, 0.0, 1.0);
-    float ao = clamp(aoBase * aoSample * aoIntensity, 0.0, 1.0);
+        aoSample = clamp(sampleMaterialTexture(uAOMap, material.arrayRefs0.w, aoUV).r, 0.0, 1.0);
+    // Baked vertex AO only stands in for a missing occlusion texture; applying both darkens twice.
+    float vertexAO = useAOMap ? 1.0 : VertexOcclusion.w;
+    float ao = clamp(aoBase * aoSample * aoIntensity * vertexAO, 0.0, 1.0);
 
     vec3 ambientColor = uFrame.ambientColorStrength.rgb;
     float ambientStrength = uFrame.ambientColorStrength.a;
     vec3 ambient = ambientColor * ambientStrength * diffuseColor * ao;
+    vec3 probeIrradiance;
+    if (sampleProbeIrradiance(FragPos, N, N, probeIrradiance))
+        ambient = probeIrradiance * diffuseColor * ao;
 
     vec3 color = ambient + directLighting + emissive;
 
@@ -512,7 +574,7 @@ void main()
             // Visualize height (prefer dedicated height map). Use normal UV space for alignment.
             vec2 debugUV = transformedUV(uObject.uvSets0.z, material.uvTransformNormal, material.uvRotations.z);
             debugUV = clamp(debugUV, 0.0, 1.0);
-            float h = sampleHeightValue(debugUV, uParallaxUseNormalAlpha);
+            float h = sampleHeightValue(debugUV, uParallaxUseNormalAlpha, material.arrayRefs0.z);
             color = vec3(h);
         }
     }
@@ -9,6 +9,7 @@ uniform sampler2D uSceneDepth;
 uniform sampler2D uBloomTexture;
 uniform sampler2D uLensDirtTexture;
 uniform sampler2D uVelocityTexture;
+uniform sampler3D uGradingLut;
 
 layout(std140, binding = 5) uniform CameraEffectsSettings {
     vec4 togglesA;           // x: bloom, y: lens flare, z: chromatic aberration, w: vignette
@@ -28,6 +29,7 @@ layout(std140, binding = 5) uniform CameraEffectsSettings {
     vec4 grainParams;        // x: amount, y: response, z: time, w: seed
     vec4 depthParams;        // x: near plane, y: far plane, z: invNear (unused), w: invFar (unused)
     vec4 resolutionParams;   // x: width, y: height, z: inv width, w: inv height
+    vec4 lutParams;          // x: use grading LUT, y: log2 of the lowest encoded value, z: 1 / encoded stops, w: LUT size
 };
 
 const int kMaxGhosts = 6;
@@ -324,6 +326,15 @@ vec3 applyFilmGrain(vec3 baseColor, vec2 uv)
     return saturate(baseColor + grain);
 }
 
+// Colour grading and exposure in one fetch; the LUT is baked by CameraEffectsStage from the same
+// settings applyColorGrading() and applyExposure() read.
+vec3 applyGradingLut(vec3 baseColor)
+{
+    vec3 encoded = saturate((log2(max(baseColor, vec3(1e-7))) - lutParams.y) * lutParams.z);
+    float size = lutParams.w;
+    return texture(uGradingLut, encoded * ((size - 1.0) / size) + 0.5 / size).rgb;
+}
+
 vec3 applyExposure(vec3 baseColor)
 {
     float exposure = exposureParams.x;
@@ -346,10 +357,15 @@ void main()
     sceneColor = applyDepthOfField(sceneColor, uv);
     sceneColor = applyMotionBlur(sceneColor, uv);
     sceneColor = applyVignette(sceneColor, uv);
-    sceneColor = applyColorGrading(sceneColor);
-    sceneColor = applyFilmGrain(sceneColor, uv);
-
-    sceneColor = applyExposure(sceneColor);
+    if (lutParams.x > 0.5) {
+        // Grain cannot be baked, so it goes on top of the graded result.
+        sceneColor = applyGradingLut(sceneColor);
+        sceneColor = applyFilmGrain(sceneColor, uv);
+    } else {
+        sceneColor = applyColorGrading(sceneColor);
+        sceneColor = applyFilmGrain(sceneColor, uv);
+        sceneColor = applyExposure(sceneColor);
+    }
     sceneColor = saturate(sceneColor);
 
     FragColor = vec4(sceneColor, 1.0);
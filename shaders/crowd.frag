@@ -0,0 +1,26 @@
+#version 430 core
+
+in VS_OUT {
+    vec3 worldPos;
+    vec3 normal;
+    float tint;
+} fs_in;
+
+out vec4 FragColor;
+
+uniform vec3 lightPos;
+uniform vec3 lightColor;
+uniform vec3 ambientColor;
+uniform float ambientStrength;
+
+void main()
+{
+    vec3 N = normalize(fs_in.normal);
+    vec3 L = normalize(lightPos - fs_in.worldPos);
+    float diff = max(dot(N, L), 0.0);
+
+    // A spread of muted hues so individual agents stand apart in a dense crowd.
+    vec3 albedo = 0.35 + 0.3 * cos(6.2831853 * (fs_in.tint + vec3(0.0, 0.33, 0.67)));
+    vec3 color = albedo * (ambientStrength * ambientColor + diff * lightColor);
+    FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,34 @@
+#version 430 core
+
+layout(location = 0) in vec3 aPosition; // agent space, +z forward, feet at y = 0
+layout(location = 1) in vec3 aNormal;
+
+// Row-major 3x4 transform written by PathCrowd.
+struct Instance {
+    vec4 rows[3];
+};
+
+layout(std430, binding = 1) readonly buffer InstanceBuffer { Instance uInstances[]; };
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out VS_OUT {
+    vec3 worldPos;
+    vec3 normal;
+    float tint;
+} vs_out;
+
+void main()
+{
+    Instance instance = uInstances[gl_InstanceID];
+    vec4 local = vec4(aPosition, 1.0);
+    vec3 worldPos = vec3(dot(instance.rows[0], local), dot(instance.rows[1], local), dot(instance.rows[2], local));
+    // The basis is orthonormal, so the rotation part transforms normals as well.
+    vec3 normal = vec3(dot(instance.rows[0].xyz, aNormal), dot(instance.rows[1].xyz, aNormal), dot(instance.rows[2].xyz, aNormal));
+
+    vs_out.worldPos = worldPos;
+    vs_out.normal = normal;
+    vs_out.tint = fract(float(gl_InstanceID) * 0.61803399);
+    gl_Position = projection * view * vec4(worldPos, 1.0);
+}
@@ -0,0 +1,28 @@
+#version 430 core
+
+// Shared by DebugDraw's two instanced draws. Line instances carry both endpoints and pick one with
+// gl_VertexID; solid box instances carry centre and half extent and scale the unit cube.
+layout(location = 0) in vec3 aCubeVertex;
+layout(location = 1) in vec3 aA;
+layout(location = 2) in vec4 aColorA;
+layout(location = 3) in vec3 aB;
+layout(location = 4) in vec4 aColorB;
+
+uniform mat4 uViewProjection;
+uniform bool uSolid;
+
+out vec4 vColor;
+
+void main()
+{
+    vec3 position;
+    if (uSolid) {
+        position = aA + aCubeVertex * aB;
+        vColor = aColorA;
+    } else {
+        bool end = gl_VertexID == 1;
+        position = end ? aB : aA;
+        vColor = end ? aColorB : aColorA;
+    }
+    gl_Position = uViewProjection * vec4(position, 1.0);
+}
@@ -0,0 +1,28 @@
+#version 450 core
+
+// Maps the scene capture's stencil, incremented by every counted fragment, to a heat ramp.
+out vec4 FragColor;
+
+uniform usampler2D uStencil; // depth-stencil texture in GL_STENCIL_INDEX mode
+uniform vec2 uPixelToTexel;
+uniform float uScale; // layer count at the red end
+uniform float uOpacity;
+
+// Dark blue (no fragment) through blue, cyan, green, yellow to red.
+vec3 heat(float t)
+{
+    t = clamp(t, 0.0, 1.0);
+    return clamp(vec3(1.5 - abs(4.0 * t - 3.0), 1.5 - abs(4.0 * t - 2.0), 1.5 - abs(4.0 * t - 1.0)), 0.0, 1.0);
+}
+
+void main()
+{
+    ivec2 size = textureSize(uStencil, 0);
+    ivec2 texel = clamp(ivec2(gl_FragCoord.xy * uPixelToTexel), ivec2(0), size - 1);
+    float count = float(texelFetch(uStencil, texel, 0).r);
+
+    // Layer 1 sits at the blue end, uScale at red; beyond it fades to white.
+    vec3 color = count < 0.5 ? vec3(0.0, 0.0, 0.25) : heat(0.125 + 0.875 * (count - 1.0) / max(uScale - 1.0, 1.0));
+    color = mix(color, vec3(1.0), clamp((count - uScale) / uScale, 0.0, 1.0));
+    FragColor = vec4(color, uOpacity);
+}
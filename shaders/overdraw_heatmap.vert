@@ -0,0 +1,8 @@
+#version 450 core
+
+// Fullscreen triangle; the fragment shader fetches by gl_FragCoord.
+void main()
+{
+    vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2)) * 2.0 - 1.0;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
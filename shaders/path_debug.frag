@@ -1,10 +0,0 @@
-#version 410 core
-
-out vec4 FragColor;
-
-uniform vec3 uColor;
-
-void main()
-{
-    FragColor = vec4(uColor, 1.0);
-}
@@ -9,6 +9,7 @@ in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord0;
 in vec2 TexCoord1;
+in vec4 VertexOcclusion;
 in vec3 Tangent;
 in vec3 Bitangent;
 in vec3 TangentLightPos;
@@ -26,6 +27,9 @@ layout(std140, binding = 3) uniform PerFrameDataBlock {
     vec4 ambientColorStrength;
     ivec4 frameFlags; // x: light count, y: debug flag, z: debug target, w: use IBL
     vec4 envParams;   // x: env intensity, y: prefilter mip levels
+    vec4 probeGridOrigin;      // xyz: first probe, w: intensity (0: no probe grid)
+    vec4 probeGridInvSpacing;  // xyz: 1 / probe spacing, w: normal bias in metres
+    ivec4 probeGridResolution; // xyz: probes per axis
 } uFrame;
 
 uniform bool uFogEnabled;
@@ -61,6 +65,8 @@ struct MaterialData {
     vec4 uvTransformEmissive;
     vec4 uvRotations;
     vec4 uvRotations2;
+    ivec4 arrayRefs0;      // packed (array << 16 | layer) per texture, -1 when bound standalone
+    ivec4 arrayRefs1;      // x: emissive
 };
 
 layout(std430, binding = 2) readonly buffer MaterialBuffer {
@@ -74,12 +80,99 @@ layout(binding = 3) uniform sampler2D uAOMap;
 layout(binding = 4) uniform sampler2D uEmissiveMap;
 // Optional: user-provided height map (not bound by default). If uHasHeightMap=false, shader will not sample it.
 layout(binding = 5) uniform sampler2D uHeightMap;
+// Shared material texture arrays; units are assigned at runtime (see TextureUnits::MaterialArray_Units).
+layout(binding = 20) uniform sampler2DArray uMaterialArrays[8];
+
+vec4 sampleMaterialTexture(sampler2D standalone, int packedRef, vec2 uv)
+{
+    if (packedRef >= 0)
+        return texture(uMaterialArrays[packedRef >> 16], vec3(uv, float(packedRef & 0xFFFF)));
+    return texture(standalone, uv);
+}
 
 layout(binding = 16) uniform samplerCube uIrradianceMap;
 layout(binding = 17) uniform samplerCube uPreFilterMap;
 layout(binding = 18) uniform sampler2D  uBRDFLut;
 uniform float uPrefilterMipCount;
 
+// Irradiance probe grid (IrradianceProbeGrid): 7 slabs stacked along z hold the L2 SH coefficients
+// premultiplied by validity, with validity in the first slab's alpha.
+layout(binding = 6) uniform sampler3D uProbeAtlas;
+
+// `biasNormal` offsets the lookup position away from the surface; `n` is the direction evaluated.
+bool sampleProbeIrradiance(vec3 position, vec3 biasNormal, vec3 n, out vec3 irradiance)
+{
+    irradiance = vec3(0.0);
+    float intensity = uFrame.probeGridOrigin.w;
+    if (intensity <= 0.0)
+        return false;
+
+    vec3 res = vec3(uFrame.probeGridResolution.xyz);
+    vec3 g = clamp((position + biasNormal * uFrame.probeGridInvSpacing.w - uFrame.probeGridOrigin.xyz) * uFrame.probeGridInvSpacing.xyz,
+                   vec3(0.0), res - 1.0);
+    vec2 uv = (g.xy + 0.5) / res.xy;
+    float slabDepth = res.z * 7.0;
+    vec4 s0 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5) / slabDepth));
+    if (s0.a < 1e-3)
+        return false;
+    vec4 s1 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + res.z) / slabDepth));
+    vec4 s2 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + 2.0 * res.z) / slabDepth));
+    vec4 s3 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + 3.0 * res.z) / slabDepth));
+    vec4 s4 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + 4.0 * res.z) / slabDepth));
+    vec4 s5 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + 5.0 * res.z) / slabDepth));
+    vec4 s6 = texture(uProbeAtlas, vec3(uv, (g.z + 0.5 + 6.0 * res.z) / slabDepth));
+
+    vec3 sh = s0.rgb * 0.282095
+            + s1.rgb * (0.488603 * n.y)
+            + vec3(s1.a, s2.rg) * (0.488603 * n.z)
+            + vec3(s2.ba, s3.r) * (0.488603 * n.x)
+            + s3.gba * (1.092548 * n.x * n.y)
+            + s4.rgb * (1.092548 * n.y * n.z)
+            + vec3(s4.a, s5.rg) * (0.315392 * (3.0 * n.z * n.z - 1.0))
+            + vec3(s5.ba, s6.r) * (1.092548 * n.x * n.z)
+            + s6.gba * (0.546274 * (n.x * n.x - n.y * n.y));
+    irradiance = max(sh / s0.a, vec3(0.0)) * intensity;
+    return true;
+}
+
+// Local reflection probes (ReflectionProbes), smallest box first: box-projected cubemaps that
+// replace the environment's prefiltered map inside their boxes, fading out over the blend distance.
+layout(std140, binding = 6) uniform ReflectionProbeBlock {
+    ivec4 counts; // x: probes, y: mip levels
+    vec4 capturePosition[8]; // w: cube layer
+    vec4 boxMin[8]; // w: blend distance
+    vec4 boxMax[8]; // w: 1 for box projection
+} uReflectionProbes;
+layout(binding = 19) uniform samplerCubeArray uReflectionProbeMaps;
+
+// Returns the summed probe weight (at most 1); `radiance` is the weighted sum of the lookups.
+float sampleReflectionProbes(vec3 position, vec3 R, float roughness, out vec3 radiance)
+{
+    radiance = vec3(0.0);
+    float totalWeight = 0.0;
+    float lod = roughness * float(max(uReflectionProbes.counts.y - 1, 0));
+    for (int i = 0; i < uReflectionProbes.counts.x && totalWeight < 1.0; ++i) {
+        vec3 boxMin = uReflectionProbes.boxMin[i].xyz;
+        vec3 boxMax = uReflectionProbes.boxMax[i].xyz;
+        vec3 inside = min(position - boxMin, boxMax - position);
+        float edgeDistance = min(min(inside.x, inside.y), inside.z);
+        if (edgeDistance <= 0.0)
+            continue;
+        float weight = min(clamp(edgeDistance / uReflectionProbes.boxMin[i].w, 0.0, 1.0), 1.0 - totalWeight);
+
+        vec3 dir = R;
+        if (uReflectionProbes.boxMax[i].w > 0.5) {
+            // Intersect the reflection ray with the box and look up the hit as seen from the capture point.
+            vec3 farPlanes = max((boxMax - position) / R, (boxMin - position) / R);
+            float rayLength = min(min(farPlanes.x, farPlanes.y), farPlanes.z);
+            dir = position + R * rayLength - uReflectionProbes.capturePosition[i].xyz;
+        }
+        radiance += weight * textureLod(uReflectionProbeMaps, vec4(dir, uReflectionProbes.capturePosition[i].w), lod).rgb;
+        totalWeight += weight;
+    }
+    return totalWeight;
+}
+
 struct ShadowUniformData {
     mat4 lightMatrix;
     vec4 params;
@@ -99,7 +192,7 @@ struct GpuLight {
     vec4 spotShadow;
     vec4 shadowParams;
     vec4 attenuation;
-    vec4 extra;
+    vec4 extra; // x: range, y: enabled
 };
 
 layout(std430, binding = 0) buffer LightBuffer { GpuLight uLights[]; };
@@ -229,7 +322,7 @@ float sampleSpotShadow(GpuLight light, vec3 fragPos, vec3 N, vec3 L)
 
     vec2 texel = vec2(texelSize);
     float visibility = 0.0;
-    int kernelRadius = 1;
+    int kernelRadius = clamp(int(shadowUniform.params.w + 0.5), 0, 3);
     int taps = 0;
     for (int y = -kernelRadius; y <= kernelRadius; ++y) {
         for (int x = -kernelRadius; x <= kernelRadius; ++x) {
@@ -293,7 +386,7 @@ mat3 orthonormalizeTBN(vec3 T, vec3 B, vec3 N)
 }
 
 // --- Basic parallax UV offset ---
-float sampleHeightValue(vec2 uv, bool canUseNormalAlpha)
+float sampleHeightValue(vec2 uv, bool canUseNormalAlpha, int normalRef)
 {
     // 1) Prefer a dedicated height map when available
     if (uHasHeightMap)
@@ -301,7 +394,7 @@ float sampleHeightValue(vec2 uv, bool canUseNormalAlpha)
 
     // 2) Optionally derive height from the normal map when requested
     if (canUseNormalAlpha) {
-        vec4 n = texture(uNormalMap, uv);
+        vec4 n = sampleMaterialTexture(uNormalMap, normalRef, uv);
         float a = n.a;
 
         // Heuristic: treat alpha as invalid height if near-constant (close to 0 or 1)
@@ -319,15 +412,15 @@ float sampleHeightValue(vec2 uv, bool canUseNormalAlpha)
 }
 
 // LearnOpenGL tutorial parallax mapping
-vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir, bool canUseNormalAlpha)
+vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir, bool canUseNormalAlpha, int normalRef)
 {
-    float height = sampleHeightValue(texCoords, canUseNormalAlpha);
+    float height = sampleHeightValue(texCoords, canUseNormalAlpha, normalRef);
     float sign = uParallaxInvertOffset ? -1.0 : 1.0;
     vec2 p = viewDir.xy / viewDir.z * (height * uParallaxScale);
     return texCoords - (sign * p);
 }
 
-vec3 computeNormal(vec2 uv, bool useNormalMap, float strength, int hasTangents)
+vec3 computeNormal(vec2 uv, bool useNormalMap, float strength, int hasTangents, int normalRef)
 {
     vec3 N = normalize(Normal);
     if (!gl_FrontFacing)
@@ -336,7 +429,7 @@ vec3 computeNormal(vec2 uv, bool useNormalMap, float strength, int hasTangents)
     if (!useNormalMap || strength <= 0.0)
         return N;
 
-    vec3 tangentNormal = decodeNormal(texture(uNormalMap, uv).xyz);
+    vec3 tangentNormal = decodeNormal(sampleMaterialTexture(uNormalMap, normalRef, uv).xyz);
     tangentNormal.xy *= strength;
     tangentNormal = normalize(tangentNormal);
 
@@ -492,18 +585,18 @@ void main()
         // LearnOpenGL tutorial parallax approach
         bool canUseNormalAlpha = uParallaxUseNormalAlpha && (useNormalMap);
         vec3 viewDir = normalize(TangentViewPos - TangentFragPos);
-        albedoUV = ParallaxMapping(albedoUV, viewDir, canUseNormalAlpha);
-        normalUV = ParallaxMapping(normalUV, viewDir, canUseNormalAlpha);
-        metallicRoughnessUV = ParallaxMapping(metallicRoughnessUV, viewDir, canUseNormalAlpha);
-        aoUV = ParallaxMapping(aoUV, viewDir, canUseNormalAlpha);
-        emissiveUV = ParallaxMapping(emissiveUV, viewDir, canUseNormalAlpha);
+        albedoUV = ParallaxMapping(albedoUV, viewDir, canUseNormalAlpha, material.arrayRefs0.z);
+        normalUV = ParallaxMapping(normalUV, viewDir, canUseNormalAlpha, material.arrayRefs0.z);
+        metallicRoughnessUV = ParallaxMapping(metallicRoughnessUV, viewDir, canUseNormalAlpha, material.arrayRefs0.z);
+        aoUV = ParallaxMapping(aoUV, viewDir, canUseNormalAlpha, material.arrayRefs0.z);
+        emissiveUV = ParallaxMapping(emissiveUV, viewDir, canUseNormalAlpha, material.arrayRefs0.z);
     }
 
     vec3 albedo = clamp(material.baseColor.rgb, vec3(0.0), vec3(1.0));
     float alpha = clamp(material.baseColor.a, 0.0, 1.0);
 
     if (useAlbedoMap) {
-        vec4 tex = texture(uAlbedoMap, albedoUV);
+        vec4 tex = sampleMaterialTexture(uAlbedoMap, material.arrayRefs0.x, albedoUV);
         // Prevent pure black from zeroing out lighting
         albedo *= max(tex.rgb, vec3(0.001));
         alpha *= tex.a;
@@ -522,7 +615,7 @@ void main()
 
     vec3 emissiveColor = material.emissiveColorIntensity.rgb;
     float emissiveIntensity = max(material.emissiveColorIntensity.a, 0.0);
-    vec3 emissiveSample = useEmissiveMap ? texture(uEmissiveMap, emissiveUV).rgb : vec3(1.0);
+    vec3 emissiveSample = useEmissiveMap ? sampleMaterialTexture(uEmissiveMap, material.arrayRefs1.x, emissiveUV).rgb : vec3(1.0);
     vec3 emissive = emissiveColor * emissiveSample * emissiveIntensity;
 
     if (!materialUsePBR) {
@@ -541,26 +634,32 @@ void main()
 
     float aoSample = 1.0;
     float occlFromMR = 1.0;
+    bool authoredAO = false;
     if (useMetallicRoughnessMap) {
-        vec3 mr = texture(uMetallicRoughnessMap, metallicRoughnessUV).rgb;
+        vec3 mr = sampleMaterialTexture(uMetallicRoughnessMap, material.arrayRefs0.y, metallicRoughnessUV).rgb;
         metallic = clamp(mr.b, 0.0, 1.0);
         roughness = clamp(mr.g, 0.04, 1.0);
         if (occlusionFromMR)
             occlFromMR = clamp(mr.r, 0.0, 1.0);
     }
 
-    if (useAOMap)
-        aoSample = clamp(texture(uAOMap, aoUV).r, 0.0, 1.0);
-    else if (occlusionFromMR && useMetallicRoughnessMap)
+    if (useAOMap) {
+        aoSample = clamp(sampleMaterialTexture(uAOMap, material.arrayRefs0.w, aoUV).r, 0.0, 1.0);
+        authoredAO = true;
+    } else if (occlusionFromMR && useMetallicRoughnessMap) {
         aoSample = occlFromMR;
+        authoredAO = true;
+    }
 
-    float ao = clamp(aoBase * aoSample * aoIntensity, 0.0, 1.0);
+    // Baked vertex AO only stands in for a missing occlusion texture; applying both darkens twice.
+    float vertexAO = authoredAO ? 1.0 : VertexOcclusion.w;
+    float ao = clamp(aoBase * aoSample * aoIntensity * vertexAO, 0.0, 1.0);
 
     float normalScale = max(material.extraParams.x, 0.0);
     float normalStrength = max(material.extraParams.y, 0.0);
     float normalCombinedStrength = normalScale * normalStrength;
 
-    vec3 N = computeNormal(normalUV, useNormalMap, normalCombinedStrength, hasTangents);
+    vec3 N = computeNormal(normalUV, useNormalMap, normalCombinedStrength, hasTangents, material.arrayRefs0.z);
     float NdotV = max(dot(N, V), 0.0);
 
     if (unlit) {
@@ -576,6 +675,8 @@ void main()
     int lightCount = max(uFrame.frameFlags.x, 0);
     if (lightCount > 0) {
         for (int i = 0; i < lightCount; ++i) {
+            if (uLights[i].extra.y < 0.5) // disabled slot
+                continue;
             directLighting += evaluateGpuLight(uLights[i], FragPos, N, V, NdotV, F0, albedo, metallic, roughness);
         }
     } else {
@@ -593,9 +694,18 @@ void main()
     float envIntensity = uFrame.envParams.x;
     vec3 iblDiffuse = vec3(0.0);
     vec3 iblSpecular = vec3(0.0);
+
+    // Diffuse indirect light is looked up along the baked bent normal (carrying the normal map's
+    // perturbation) when the mesh has one; the probe grid replaces the environment's irradiance.
+    vec3 irradianceDir = N;
+    if (dot(VertexOcclusion.xyz, VertexOcclusion.xyz) > 1e-4)
+        irradianceDir = normalize(normalize(VertexOcclusion.xyz) + N - normalize(Normal));
+    vec3 probeIrradiance;
+    bool hasProbeIrradiance = sampleProbeIrradiance(FragPos, normalize(Normal), irradianceDir, probeIrradiance);
+
     if (useIBL) {
         // 1) diffuse IBL
-        vec3 irradiance = texture(uIrradianceMap, N).rgb;
+        vec3 irradiance = hasProbeIrradiance ? probeIrradiance : texture(uIrradianceMap, irradianceDir).rgb;
 
         // for IBL diffuse we only remove the metallic part,
         // NOT the view-dependent Fresnel
@@ -612,7 +722,11 @@ void main()
             maxPrefilterMip = max(uFrame.envParams.y, 0.0);
 
         float mip = roughness * maxPrefilterMip;
-        vec3 prefiltered = textureLod(uPreFilterMap, R, mip).rgb;
+        vec3 prefiltered = textureLod(uPreFilterMap, R, mip).rgb * envIntensity;
+        // Probe captures hold scene radiance already, so they blend in after the env intensity.
+        vec3 probeRadiance;
+        float probeWeight = sampleReflectionProbes(FragPos, R, roughness, probeRadiance);
+        prefiltered = prefiltered * (1.0 - probeWeight) + probeRadiance;
         vec2 brdf = texture(uBRDFLut, vec2(NdotV, roughness)).rg;
 
         vec3 F = fresnelSchlickRoughness(max(dot(N, V), 0.0), F0, roughness);
@@ -620,7 +734,7 @@ void main()
 
         // 3) apply AO + env intensity
         iblDiffuse  = diffuseIbl * ao * envIntensity;
-        iblSpecular = specularIbl * envIntensity;
+        iblSpecular = specularIbl;
     }
 
 
@@ -629,6 +743,8 @@ void main()
         vec3 ambientColor = uFrame.ambientColorStrength.rgb;
         float ambientStrength = uFrame.ambientColorStrength.a;
         ambient = ambientColor * ambientStrength * albedo * ao;
+        if (hasProbeIrradiance)
+            ambient = probeIrradiance * (1.0 - metallic) * albedo * ao;
     }
 
     vec3 color = ambient + directLighting + iblDiffuse + iblSpecular + emissive;
@@ -646,7 +762,7 @@ void main()
             // Visualize height (prefer dedicated height map) using the normal UV domain
             vec2 debugUV = transformedUV(uObject.uvSets0.z, material.uvTransformNormal, material.uvRotations.z);
             debugUV = clamp(debugUV, 0.0, 1.0);
-            float h = sampleHeightValue(debugUV, uParallaxUseNormalAlpha);
+            float h = sampleHeightValue(debugUV, uParallaxUseNormalAlpha, material.arrayRefs0.z);
             color = vec3(h);
         }
     }
@@ -5,11 +5,15 @@ layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 layout (location = 3) in vec4 aTangent;
 layout (location = 4) in vec2 aTexCoords1;
+// Baked per-vertex occlusion: bent normal in xyz, visibility in w. Meshes without the stream read
+// the default generic attribute (0, 0, 0, 1).
+layout (location = 5) in vec4 aOcclusion;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord0;
 out vec2 TexCoord1;
+out vec4 VertexOcclusion;
 out vec3 Tangent;
 out vec3 Bitangent;
 // Tangent-space vectors for parallax mapping (LearnOpenGL tutorial)
@@ -28,6 +32,9 @@ layout(std140, binding = 3) uniform PerFrameDataBlock {
     vec4 ambientColorStrength;
     ivec4 frameFlags;
     vec4 envParams;
+    vec4 probeGridOrigin;
+    vec4 probeGridInvSpacing;
+    ivec4 probeGridResolution;
 } uFrame;
 
 uniform bool uWorldCurvatureEnabled;
@@ -57,6 +64,8 @@ void main()
     Bitangent = B;
     TexCoord0 = aTexCoords;
     TexCoord1 = aTexCoords1;
+    vec3 bentNormal = dot(aOcclusion.xyz, aOcclusion.xyz) > 1e-6 ? normalize(normalMatrix3 * aOcclusion.xyz) : vec3(0.0);
+    VertexOcclusion = vec4(bentNormal, aOcclusion.w);
 
     // Construct TBN matrix for tangent-space transformation (LearnOpenGL tutorial)
     mat3 TBN = transpose(mat3(T, B, Normal));
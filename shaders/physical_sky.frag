@@ -0,0 +1,93 @@
+#version 430 core
+
+// Draws PhysicalSky from its sky-view LUT at full resolution, plus the sun disk and the lit ground.
+// The LUT mappings mirror physical_sky.comp.
+in vec2 vNdc;
+out vec4 FragColor;
+
+layout(binding = 0) uniform sampler2D uTransmittanceLut;
+layout(binding = 2) uniform sampler2D uSkyViewLut;
+
+uniform mat4 uInverseViewProjection; // rotation-only view
+uniform vec3 uSunDirection;
+uniform float uBottomRadius;
+uniform float uTopRadius;
+uniform float uObserverAltitude;
+uniform vec3 uGroundAlbedo;
+uniform vec3 uGroundExtinction;
+uniform float uIntensity;
+uniform float uSunDiskLuminance;
+uniform float uSunCosAngularRadius;
+
+const float PI = 3.14159265359;
+
+float raySphere(vec3 origin, vec3 direction, float radius)
+{
+    float b = dot(origin, direction);
+    float c = dot(origin, origin) - radius * radius;
+    float discriminant = b * b - c;
+    if (discriminant < 0.0)
+        return -1.0;
+    float s = sqrt(discriminant);
+    if (-b - s >= 0.0)
+        return -b - s;
+    if (-b + s >= 0.0)
+        return -b + s;
+    return -1.0;
+}
+
+vec3 transmittanceToTop(vec3 position, vec3 direction)
+{
+    float r = length(position);
+    float mu = dot(position / r, direction);
+    float H = sqrt(uTopRadius * uTopRadius - uBottomRadius * uBottomRadius);
+    float rho = sqrt(max(0.0, r * r - uBottomRadius * uBottomRadius));
+    float discriminant = r * r * (mu * mu - 1.0) + uTopRadius * uTopRadius;
+    float d = max(0.0, -r * mu + sqrt(max(discriminant, 0.0)));
+    float dMin = uTopRadius - r;
+    float dMax = rho + H;
+    return texture(uTransmittanceLut, vec2((d - dMin) / (dMax - dMin), rho / H)).rgb;
+}
+
+vec2 skyViewUv(vec3 direction, float observerRadius)
+{
+    float horizonDistance = sqrt(max(observerRadius * observerRadius - uBottomRadius * uBottomRadius, 0.0));
+    float beta = acos(clamp(horizonDistance / observerRadius, -1.0, 1.0));
+    float zenithHorizonAngle = PI - beta;
+    float viewZenithAngle = acos(clamp(direction.y, -1.0, 1.0));
+
+    vec2 uv;
+    if (viewZenithAngle < zenithHorizonAngle)
+        uv.y = (1.0 - sqrt(max(1.0 - viewZenithAngle / zenithHorizonAngle, 0.0))) * 0.5;
+    else
+        uv.y = sqrt(clamp((viewZenithAngle - zenithHorizonAngle) / beta, 0.0, 1.0)) * 0.5 + 0.5;
+    float lightViewCos = 1.0;
+    if (dot(direction.xz, direction.xz) > 1e-8 && dot(uSunDirection.xz, uSunDirection.xz) > 1e-8)
+        lightViewCos = dot(normalize(direction.xz), normalize(uSunDirection.xz));
+    uv.x = sqrt(clamp(-lightViewCos * 0.5 + 0.5, 0.0, 1.0));
+    return uv;
+}
+
+vec3 toneMap(vec3 color)
+{
+    return color / (color + vec3(1.0));
+}
+
+void main()
+{
+    vec4 world = uInverseViewProjection * vec4(vNdc, 1.0, 1.0);
+    vec3 direction = normalize(world.xyz / world.w);
+    vec3 origin = vec3(0.0, uBottomRadius + uObserverAltitude, 0.0);
+
+    vec3 luminance = texture(uSkyViewLut, skyViewUv(direction, origin.y)).rgb;
+    float groundDistance = raySphere(origin, direction, uBottomRadius);
+    if (groundDistance >= 0.0) {
+        vec3 position = origin + direction * groundDistance;
+        float sunCos = max(dot(normalize(position), uSunDirection), 0.0);
+        luminance += exp(-uGroundExtinction * groundDistance) * transmittanceToTop(position, uSunDirection) * sunCos * uGroundAlbedo / PI;
+    } else if (dot(direction, uSunDirection) > uSunCosAngularRadius) {
+        luminance += transmittanceToTop(origin, uSunDirection) * uSunDiskLuminance;
+    }
+
+    FragColor = vec4(toneMap(luminance * uIntensity), 1.0);
+}
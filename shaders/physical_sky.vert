@@ -0,0 +1,11 @@
+#version 430 core
+
+// Fullscreen triangle on the far plane; the fragment shader rebuilds the view direction.
+out vec2 vNdc;
+
+void main()
+{
+    vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2)) * 2.0 - 1.0;
+    vNdc = position;
+    gl_Position = vec4(position, 1.0, 1.0);
+}
@@ -0,0 +1,35 @@
+#version 450 core
+
+// Colours each visible fragment by how many lanes of its 2x2 quad cover the triangle. Helper lanes
+// (outside the triangle, run only for derivatives) contribute 0; fine derivatives gather the other
+// three lanes' values.
+out vec4 FragColor;
+
+uniform sampler2D uSceneDepth;
+uniform vec2 uPixelToTexel;
+uniform float uOpacity;
+
+void main()
+{
+    float covered = gl_HelperInvocation ? 0.0 : 1.0;
+    // Quads start at even pixels; dFdxFine is odd minus even column, dFdyFine odd minus even row.
+    vec2 parity = mod(floor(gl_FragCoord.xy), 2.0);
+    float rowSum = covered + (covered + dFdxFine(covered) * (1.0 - 2.0 * parity.x));
+    float quadSum = rowSum + (rowSum + dFdyFine(rowSum) * (1.0 - 2.0 * parity.y));
+    float depthSlope = fwidth(gl_FragCoord.z);
+
+    // Only the surface the scene kept, compared by hand so no lane is lost before counting.
+    ivec2 size = textureSize(uSceneDepth, 0);
+    ivec2 texel = clamp(ivec2(gl_FragCoord.xy * uPixelToTexel), ivec2(0), size - 1);
+    float sceneDepth = texelFetch(uSceneDepth, texel, 0).r;
+    if (gl_FragCoord.z > sceneDepth + 1e-5 + 2.0 * depthSlope)
+        discard;
+
+    const vec3 palette[4] = vec3[4](
+        vec3(1.0, 0.0, 0.0), // 1 of 4 lanes useful
+        vec3(1.0, 0.55, 0.0),
+        vec3(1.0, 1.0, 0.0),
+        vec3(0.0, 0.9, 0.1)); // full quad
+    int lanes = clamp(int(round(quadSum)), 1, 4);
+    FragColor = vec4(palette[lanes - 1], uOpacity);
+}
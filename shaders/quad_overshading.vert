@@ -0,0 +1,11 @@
+#version 450 core
+
+layout(location = 0) in vec3 aPos;
+
+uniform mat4 uModel;
+uniform mat4 uViewProjection;
+
+void main()
+{
+    gl_Position = uViewProjection * (uModel * vec4(aPos, 1.0));
+}
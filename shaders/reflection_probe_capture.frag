@@ -0,0 +1,109 @@
+#version 450 core
+
+// Simplified shading for reflection probe captures: constant material colours, diffuse light from
+// every point and spot light without shadows, environment irradiance as ambient, and the
+// environment's sharpest prefiltered mip as the background.
+
+in vec3 vWorldPos;
+in vec3 vNormal;
+in vec3 vSkyDirection;
+
+out vec4 FragColor;
+
+struct GpuLight {
+    vec4 positionType;
+    vec4 directionRange;
+    vec4 colorIntensity;
+    vec4 spotShadow;
+    vec4 shadowParams;
+    vec4 attenuation;
+    vec4 extra; // x: range, y: enabled
+};
+
+layout(std430, binding = 0) readonly buffer LightBuffer { GpuLight uLights[]; };
+
+layout(binding = 0) uniform samplerCube uSkyMap;
+layout(binding = 1) uniform samplerCube uIrradianceMap;
+
+uniform int uSkyPass;
+uniform int uLightCount;
+uniform int uUseEnvironment;
+uniform float uEnvironmentIntensity;
+uniform vec3 uAmbient; // used without an environment
+uniform vec3 uCapturePosition;
+uniform vec3 uAlbedo;
+uniform vec3 uEmissive;
+
+const int LIGHT_TYPE_SPOT = 1;
+
+float distanceAttenuation(GpuLight light, float dist)
+{
+    if (light.attenuation.w <= 0.5)
+        return 1.0;
+
+    float denom = light.attenuation.x + light.attenuation.y * dist + light.attenuation.z * dist * dist;
+    float attenuation = 1.0 / max(denom, 1e-6);
+
+    float range = max(light.extra.x, 0.0);
+    if (range <= 0.0)
+        range = light.directionRange.w;
+    if (range > 0.0) {
+        float n = clamp(dist / range, 0.0, 1.0);
+        attenuation *= (1.0 - n * n * n * n) * smoothstep(0.0, 1.0, 1.0 - n);
+    }
+    return attenuation;
+}
+
+vec3 diffuseLight(GpuLight light, vec3 position, vec3 N)
+{
+    vec3 toLight = light.positionType.xyz - position;
+    float dist = length(toLight);
+    if (dist <= 0.0)
+        return vec3(0.0);
+    vec3 L = toLight / dist;
+
+    float spot = 1.0;
+    if (int(light.positionType.w + 0.5) == LIGHT_TYPE_SPOT) {
+        float innerCos = light.spotShadow.x;
+        float outerCos = light.spotShadow.y;
+        if (innerCos > 1.0 || outerCos > 1.0) {
+            innerCos = cos(radians(innerCos));
+            outerCos = cos(radians(outerCos));
+        }
+        if (innerCos < outerCos) {
+            float t = innerCos;
+            innerCos = outerCos;
+            outerCos = t;
+        }
+        float c = dot(normalize(light.directionRange.xyz), -L);
+        float w = clamp((c - outerCos) / max(innerCos - outerCos, 1e-4), 0.0, 1.0);
+        spot = w * w * (3.0 - 2.0 * w);
+    }
+
+    vec3 radiance = max(light.colorIntensity.rgb, vec3(0.0)) * max(light.colorIntensity.a, 0.0);
+    return radiance * max(dot(N, L), 0.0) * distanceAttenuation(light, dist) * spot;
+}
+
+void main()
+{
+    if (uSkyPass != 0) {
+        vec3 sky = uUseEnvironment != 0 ? textureLod(uSkyMap, normalize(vSkyDirection), 0.0).rgb * uEnvironmentIntensity : uAmbient;
+        FragColor = vec4(sky, 1.0);
+        return;
+    }
+
+    // Culling is off (the cube-face views flip winding), so face the normal towards the probe.
+    vec3 N = normalize(vNormal);
+    if (dot(N, uCapturePosition - vWorldPos) < 0.0)
+        N = -N;
+
+    vec3 irradiance = uUseEnvironment != 0 ? texture(uIrradianceMap, N).rgb * uEnvironmentIntensity : uAmbient;
+    vec3 direct = vec3(0.0);
+    for (int i = 0; i < uLightCount; ++i) {
+        if (uLights[i].extra.y < 0.5) // disabled slot
+            continue;
+        direct += diffuseLight(uLights[i], vWorldPos, N);
+    }
+    vec3 color = uAlbedo * (irradiance + direct / 3.14159265359) + uEmissive;
+    FragColor = vec4(color, 1.0);
+}
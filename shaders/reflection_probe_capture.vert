@@ -0,0 +1,34 @@
+#version 450 core
+
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec3 aNormal;
+
+// uSkyPass draws a fullscreen triangle for the background; otherwise scene geometry.
+uniform int uSkyPass;
+uniform mat4 uModel;
+uniform mat3 uNormalMatrix;
+uniform mat4 uViewProjection;
+uniform mat4 uInverseViewProjection; // sky pass: rotation-only view
+
+out vec3 vWorldPos;
+out vec3 vNormal;
+out vec3 vSkyDirection;
+
+void main()
+{
+    if (uSkyPass != 0) {
+        vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2)) * 2.0 - 1.0;
+        vec4 farPoint = uInverseViewProjection * vec4(position, 1.0, 1.0);
+        vWorldPos = vec3(0.0);
+        vNormal = vec3(0.0, 1.0, 0.0);
+        vSkyDirection = farPoint.xyz / farPoint.w;
+        gl_Position = vec4(position, 1.0, 1.0);
+        return;
+    }
+
+    vec4 world = uModel * vec4(aPos, 1.0);
+    vWorldPos = world.xyz;
+    vNormal = uNormalMatrix * aNormal;
+    vSkyDirection = vec3(0.0);
+    gl_Position = uViewProjection * world;
+}
@@ -0,0 +1,36 @@
+#version 450 core
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+
+// Single-pass layered shadows without a geometry shader: every caster is drawn once, instanced over
+// the views its bounds reach, and each instance picks its layer (spot array layer or cube face).
+
+layout(location = 0) in vec3 aPos;
+
+const int MAX_SHADOW_VIEWS = 8;
+
+layout(std140, binding = 4) uniform ShadowViews {
+    mat4 uViewProj[MAX_SHADOW_VIEWS];
+};
+
+uniform mat4 uModel;
+// Bit v set: the caster intersects view v. Instance i renders the i-th set bit.
+uniform uint uViewMask;
+
+out vec3 vWorldPos;
+
+int nthSetBit(uint mask, int n)
+{
+    for (int i = 0; i < n; ++i)
+        mask &= mask - 1u;
+    return findLSB(mask);
+}
+
+void main()
+{
+    const int view = nthSetBit(uViewMask, gl_InstanceID);
+    vec4 world = uModel * vec4(aPos, 1.0);
+    vWorldPos = world.xyz;
+    gl_Position = uViewProj[view] * world;
+    gl_Layer = view;
+}
@@ -0,0 +1,49 @@
+#version 430 core
+
+in VS_OUT {
+    vec3 worldPos;
+    vec3 normal;
+    float heightFraction;
+    float tint;
+} fs_in;
+
+out vec4 FragColor;
+
+uniform vec3 lightPos;
+uniform vec3 lightColor;
+uniform vec3 ambientColor;
+uniform float ambientStrength;
+uniform vec3 cameraPos;
+
+uniform bool uFogEnabled;
+uniform vec3 uFogColor;
+uniform float uFogDensity;
+uniform float uFogGradient;
+
+const vec3 kRootColor = vec3(0.12, 0.35, 0.12);
+const vec3 kTipColor = vec3(0.45, 0.85, 0.35);
+const vec3 kDryTipColor = vec3(0.75, 0.8, 0.4);
+
+void main()
+{
+    // Blades are two-sided: light the side facing the viewer.
+    vec3 N = normalize(fs_in.normal);
+    if (!gl_FrontFacing)
+        N = -N;
+    vec3 L = normalize(lightPos - fs_in.worldPos);
+
+    // Wrapped diffuse keeps thin blades from going black when lit edge-on.
+    float diff = clamp((dot(N, L) + 0.5) / 1.5, 0.0, 1.0);
+    vec3 tip = mix(kTipColor, kDryTipColor, fs_in.tint * fs_in.tint);
+    vec3 albedo = mix(kRootColor, tip, fs_in.heightFraction);
+    float occlusion = mix(0.5, 1.0, fs_in.heightFraction);
+
+    vec3 color = albedo * (ambientStrength * ambientColor * occlusion + diff * lightColor);
+    vec4 outCol = vec4(color, 1.0);
+    if (uFogEnabled) {
+        float dist = length(cameraPos - fs_in.worldPos);
+        float vis = clamp(exp(-pow(dist * uFogDensity, uFogGradient)), 0.0, 1.0);
+        outCol.rgb = mix(uFogColor, outCol.rgb, vis);
+    }
+    FragColor = outCol;
+}
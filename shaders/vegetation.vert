@@ -0,0 +1,58 @@
+#version 430 core
+
+layout(location = 0) in vec3 aPosition; // blade space, y in [0,1]
+layout(location = 1) in vec3 aNormal;
+
+struct Instance {
+    vec4 positionScale;
+    vec4 params;
+};
+
+layout(std430, binding = 1) readonly buffer InstanceBuffer { Instance uInstances[]; };
+layout(std430, binding = 4) readonly buffer VisibleBuffer { uint uVisible[]; };
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform uint uLodOffset;
+uniform float uBladeHeight;
+uniform float uTime;
+uniform float uWindStrength;
+uniform bool uWorldCurvatureEnabled;
+uniform float uWorldCurvatureStrength;
+
+out VS_OUT {
+    vec3 worldPos;
+    vec3 normal;
+    float heightFraction;
+    float tint;
+} vs_out;
+
+void main()
+{
+    Instance instance = uInstances[uVisible[uLodOffset + uint(gl_InstanceID)]];
+    float scale = instance.positionScale.w;
+    float angle = instance.params.x;
+    float c = cos(angle);
+    float s = sin(angle);
+    mat3 rotation = mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c);
+
+    vec3 local = aPosition * vec3(scale, uBladeHeight * scale, scale);
+    vec3 worldPos = instance.positionScale.xyz + rotation * local;
+
+    // Sway grows with height so the base stays planted.
+    float phase = instance.params.w + dot(instance.positionScale.xz, vec2(0.35, 0.22));
+    vec2 wind = vec2(sin(uTime * 1.7 + phase), cos(uTime * 1.3 + phase * 0.7)) * uWindStrength;
+    worldPos.xz += wind * aPosition.y * aPosition.y * uBladeHeight * scale;
+
+    vs_out.worldPos = worldPos;
+    vs_out.normal = normalize(rotation * aNormal);
+    vs_out.heightFraction = aPosition.y;
+    vs_out.tint = instance.params.z;
+
+    vec4 posView = view * vec4(worldPos, 1.0);
+    if (uWorldCurvatureEnabled) {
+        float fragmentDist = length(posView.xyz);
+        posView.y -= uWorldCurvatureStrength * fragmentDist * fragmentDist;
+    }
+    gl_Position = projection * posView;
+}
@@ -1,24 +1,43 @@
 #include "app/DebugUiManager.h"
+#include "app/FramePacer.h"
+#include "app/InputRecorder.h"
+#include "app/ScalabilityManager.h"
+#include "io/AssetDatabase.h"
+#include "io/AsyncIoService.h"
+#include "io/VirtualFileSystem.h"
 #include "camera/CameraStage.h"
 #include "camera/CameraPath.h"
 #include "camera/CameraPathPlayer.h"
 #include "rendering/ShadingStage.h"
 #include "app/SelectionManager.h"
 #include "rendering/LightManager.h"
+#include "rendering/MeshletCuller.h"
 #include "rendering/EnvironmentManager.h"
+#include "rendering/IrradianceProbeGrid.h"
+#include "rendering/PhysicalSky.h"
+#include "rendering/ReflectionProbes.h"
+#include "rendering/PassDiagnostics.h"
 #include "rendering/CameraEffectsStage.h"
+#include "rendering/CrowdRenderer.h"
 #include "rendering/SunPathController.h"
+#include "rendering/DebugDraw.h"
 #include "rendering/PathRenderer.h"
 #include "rendering/RenderStats.h"
+#include "mesh/AmbientOcclusionBaker.h"
 #include "mesh/MeshManager.h"
 #include "mesh/mesh.h"
+#include "metrics/MetricsPublisher.h"
+#include "metrics/MetricsRegistry.h"
 #include "pendulum/PendulumManager.h"
 #include "terrain/ProceduralFloor.h"
 #include "player/PlayerController.h"
+#include "physics/CollisionWorld.h"
 #include "scene/ModelLoader.h"
+#include "scene/WorldPartition.h"
 #include "particle/ParticleSystem.h"
 #include "water/Water.h"
 #include "util/BezierPath.h"
+#include "util/PathCrowd.h"
 #include "ui/Minimap.h"
 
 #include <framework/file_picker.h>
@@ -36,6 +55,7 @@ DISABLE_WARNINGS_PUSH()
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/norm.hpp>
 #include <glm/mat4x4.hpp>
+#include <framework/log.h>
 #include <framework/ray.h>
 #include <imgui/imgui.h>
 #include <optional>
@@ -53,7 +73,11 @@ DISABLE_WARNINGS_POP()
 #include <cmath>
 #include <cstdlib>
 #include <cfloat>
+#include <fstream>
 #include <limits>
+#ifdef __linux__
+#include <unistd.h>
+#endif
 
 #ifndef GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX
 #define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
@@ -96,15 +120,48 @@ void APIENTRY glDebugOutput(GLenum source,
     std::fprintf(stderr, "[GL %u] %s\n", id, message);
 }
 
+// Resident set size of this process in MB, or a negative value where it cannot be queried cheaply.
+double readProcessResidentMB()
+{
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    std::uint64_t totalPages = 0;
+    std::uint64_t residentPages = 0;
+    if (!(statm >> totalPages >> residentPages))
+        return -1.0;
+    return static_cast<double>(residentPages) * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+#else
+    return -1.0;
+#endif
+}
+
+// Bump when scene import output changes so recorded scenes read as stale.
+constexpr std::uint32_t kSceneImportVersion = 1;
+// How often loaded assets are checked for edits on disk.
+constexpr float kAssetRescanIntervalSeconds = 2.0f;
+
+AssetDatabase::ArtifactKey sceneArtifactKey(const std::filesystem::path& path)
+{
+    AssetDatabase::ArtifactKey key;
+    key.kind = "scene";
+    key.source = path;
+    return key;
+}
+
 } // namespace
 
 class Application {
 public:
-    explicit Application(std::optional<std::filesystem::path> initialScene = std::nullopt);
+    explicit Application(std::optional<std::filesystem::path> initialScene = std::nullopt,
+        InputRecorder::LaunchOptions launchOptions = {},
+        std::vector<std::filesystem::path> assetPacks = {});
     ~Application();
 
     void update();
 
+    // Enables per-pass pipeline statistics and logs them every `intervalFrames` frames.
+    void enablePipelineStatisticsLogging(int intervalFrames) { m_passDiagnostics.enableStatisticsLogging(intervalFrames); }
+
 private:
     // Render passes and helpers
     void renderShadowPasses(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
@@ -134,6 +191,7 @@ private:
     void loadSceneFromPath(const std::filesystem::path& path);
     void setModelPathBuffer(const std::filesystem::path& path);
     void loadEnvironmentFromPath(const std::filesystem::path& path);
+    void finishPendingEnvironmentLoad();
     void setEnvironmentPathBuffer(const std::filesystem::path& path);
 
     void registerDebugTabs();
@@ -148,8 +206,8 @@ private:
     void drawPerformancePanel();
     CameraKeyframe captureCurrentCameraKeyframe(float timeSeconds) const;
     void rebuildCameraPathBezier();
-    void renderCameraPathDebug(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, RenderStats& stats);
-    void drawSelectionOverlay(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+    void renderCameraPathDebug(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix);
+    void drawSelectionOverlay();
     void drawCrosshairOverlay() const;
     void gatherSelectables();
     void applySelectionDelta(const glm::vec3& delta);
@@ -160,13 +218,15 @@ private:
     void beginFrameStats(float deltaTime);
     void finalizeFrameStats();
     void updateGpuMemoryStats();
+    void registerMetrics();
+    void publishMetrics();
+    void applyScalabilityPreset(const ScalabilityManager::Preset& preset);
 
-    // --- Light cube helpers ---
-    GLuint m_lightCubeVAO {0}, m_lightCubeVBO {0}, m_lightCubeEBO {0};
-    Shader m_lightCubeShader; // simple unlit color shader
-    void initLightCube();
-    void buildLightCubeShader();
-    void renderLightCube(const glm::vec3& pos, const glm::mat4& view, const glm::mat4& proj, const glm::vec3& color);
+    // Declared first: every subsystem below loads its assets through it.
+    VirtualFileSystem m_fileSystem;
+    AsyncIoService m_asyncIo;
+    AssetDatabase m_assetDatabase;
+    float m_assetRescanTimer { 0.0f };
 
     DebugUiManager m_debugUi;
     DebugUiManager::TabHandle m_tabPerformance;
@@ -185,13 +245,24 @@ private:
     DebugUiManager::TabHandle m_tabMinimap;
 
     Window m_window;
+    FramePacer m_framePacer;
+    ScalabilityManager m_scalability;
+    InputRecorder m_inputRecorder;
+    InputRecorder::LaunchOptions m_launchOptions;
+    MetricsRegistry m_metrics;
+    MetricsPublisher m_metricsPublisher;
     CameraStage m_cameraStage;
     ShadingStage m_shadingStage;
     EnvironmentManager m_environmentManager;
+    PhysicalSky m_physicalSky;
+    ReflectionProbes m_reflectionProbes;
+    PassDiagnostics m_passDiagnostics;
     CameraEffectsStage m_cameraEffectsStage;
     CameraEffectsStage::Settings m_cameraEffectsSettings;
     LightManager m_lightManager;
+    MeshletCuller m_meshletCuller;
     SunPathController m_sunPathController;
+    DebugDraw m_debugDraw;
     PathRenderer m_pathRenderer;
     PathRenderer m_cameraPathRenderer;
 
@@ -211,10 +282,17 @@ private:
 
     MeshManager m_meshManager;
     ModelLoader m_modelLoader;
+    WorldPartition m_worldPartition;
+    glm::vec3 m_lastStreamingPosition { 0.0f };
+    AmbientOcclusionBaker m_aoBaker;
+    IrradianceProbeGrid m_probeGrid;
     PendulumManager m_pendulumManager;
     SelectionManager m_selectionManager;
     std::optional<SelectionManager::HitResult> m_hoveredSelectable;
 
+    PathCrowd m_crowd;
+    CrowdRenderer m_crowdRenderer;
+
     // Particles
     ParticleSystem m_particles;    // <<< ADDED
     FireworkParams m_fireworkParams; // <<< ADDED (if your system uses it)
@@ -226,10 +304,13 @@ private:
     std::array<char, 512> m_environmentPathBuffer { "" };
     std::string m_environmentLoadMessage;
     bool m_environmentLoadSuccess { true };
+    std::optional<std::filesystem::path> m_pendingEnvironmentPath; // waiting for its background read
     bool m_showGround { true };
 
     ProceduralFloor m_floor;
     PlayerController m_player;
+    CollisionWorld m_collisionWorld;
+    bool m_meshCollisionEnabled { true };
 
     std::string m_pendulumNodePrimitiveName { "__pendulum_node__" };
     std::string m_pendulumBarPrimitiveName { "__pendulum_bar__" };
@@ -249,6 +330,10 @@ private:
         float instantFps { 0.0f };
         float avgFps { 0.0f };
         RenderStats render;
+        // CPU time spent recording each pass (GPU work is asynchronous and not included).
+        float shadowPassMs { 0.0f };
+        float opaquePassMs { 0.0f };
+        float transparentPassMs { 0.0f };
 
         struct GpuMemory {
             bool supported { false };
@@ -263,6 +348,29 @@ private:
     enum class GpuMemoryQueryMode { Uninitialized, NVX, Unsupported };
     GpuMemoryQueryMode m_gpuMemoryQueryMode { GpuMemoryQueryMode::Uninitialized };
 
+    struct FrameMetrics {
+        MetricsRegistry::Counter frames;
+        MetricsRegistry::Histogram frameTimeMs;
+        MetricsRegistry::Gauge fps;
+        MetricsRegistry::Gauge drawCalls;
+        MetricsRegistry::Gauge triangles;
+        MetricsRegistry::Gauge shadowPassMs;
+        MetricsRegistry::Gauge opaquePassMs;
+        MetricsRegistry::Gauge transparentPassMs;
+        MetricsRegistry::Gauge particlesAlive;
+        MetricsRegistry::Gauge particlesSimulated;
+        MetricsRegistry::Gauge meshletCullMainMs;
+        MetricsRegistry::Gauge meshletCullShadowMs;
+        MetricsRegistry::Gauge collisionMs;
+        MetricsRegistry::Gauge gpuWaitMs;
+        MetricsRegistry::Gauge inputToGpuMs;
+        MetricsRegistry::Gauge gpuMemoryUsedMB;
+        MetricsRegistry::Gauge processResidentMB;
+    };
+    static constexpr std::uint64_t kResidentSampleInterval = 60; // frames between /proc reads
+    FrameMetrics m_frameMetrics;
+    std::uint64_t m_metricsFrameIndex { 0 };
+
     glm::mat4 m_projectionMatrix = glm::perspective(glm::radians(80.0f), 1.0f, 0.1f, 100.0f);
 
     bool m_showCrosshair { true };
@@ -272,6 +380,7 @@ private:
     enum class ActiveDragButton { None, Left, Right };
     ActiveDragButton m_activeDragButton { ActiveDragButton::None };
     bool m_isDraggingSelection { false };
+    bool m_showSelectableBounds { false };
     float m_maxPickDistance { 100.0f };
 
     struct PendulumDragState {
@@ -294,15 +403,26 @@ private:
 
 // ---------------- Implementation ----------------
 
-Application::Application(std::optional<std::filesystem::path> initialScene)
-    : m_window("Final Project", glm::ivec2(1920, 1080), OpenGLVersion::GL45)
+Application::Application(std::optional<std::filesystem::path> initialScene, InputRecorder::LaunchOptions launchOptions, std::vector<std::filesystem::path> assetPacks)
+    : m_fileSystem(RESOURCE_ROOT, assetPacks)
+    , m_assetDatabase(std::filesystem::path(RESOURCE_ROOT "derived_data"))
+    , m_window("Final Project", glm::ivec2(1920, 1080), OpenGLVersion::GL45)
+    , m_framePacer(m_window)
+    , m_inputRecorder(m_window)
+    , m_launchOptions(std::move(launchOptions))
     , m_cameraStage(m_window, [](const glm::vec3&) { return 0.0f; })
     , m_shadingStage(std::filesystem::path(RESOURCE_ROOT "/shaders"))
     , m_environmentManager(std::filesystem::path(RESOURCE_ROOT "/shaders"))
     , m_meshManager(std::filesystem::path(RESOURCE_ROOT "resources"))
+    , m_worldPartition(std::filesystem::path(RESOURCE_ROOT "derived_data/stream"))
     , m_pendulumManager()
     , m_minimap(512)
 {
+    m_assetDatabase.load();
+    m_assetDatabase.registerImporter("scene", kSceneImportVersion);
+    m_environmentManager.setAssetDatabase(&m_assetDatabase);
+    m_aoBaker.setAssetDatabase(&m_assetDatabase);
+    m_probeGrid.setAssetDatabase(&m_assetDatabase);
 
     if (std::getenv("APP_RUNTIME_LOAD_TEST") != nullptr)
         m_runtimeLoadAutoTest = true;
@@ -329,22 +449,48 @@ Application::Application(std::optional<std::filesystem::path> initialScene)
         m_cameraEffectsStage.resize(fbSize);
     });
 
-    initLightCube();
-    buildLightCubeShader();
+    m_inputRecorder.setSessionHooks(
+        [this]() {
+            InputRecorder::SessionState session;
+            session.scene = m_lastModelPath.string();
+            session.windowSize = m_window.getWindowSize();
+            session.cameraMode = static_cast<int>(m_cameraStage.getMode());
+            const FPSCamera& camera = m_cameraStage.getFpsCamera();
+            session.cameraPosition = camera.getPosition();
+            session.cameraYaw = camera.getYaw();
+            session.cameraPitch = camera.getPitch();
+            session.playerPosition = m_player.position();
+            return session;
+        },
+        [this](const InputRecorder::SessionState& session) {
+            const int mode = std::clamp(session.cameraMode, 0, static_cast<int>(CameraStage::Mode::FreeCam));
+            m_cameraStage.setMode(static_cast<CameraStage::Mode>(mode));
+            FPSCamera& camera = m_cameraStage.getFpsCamera();
+            camera.setPosition(session.cameraPosition);
+            camera.setYaw(session.cameraYaw);
+            camera.setPitch(session.cameraPitch);
+            m_cameraStage.resetMouseTracking();
+            m_player.setPosition(session.playerPosition);
+        });
+
+    m_debugDraw.initialize(std::filesystem::path(RESOURCE_ROOT "/shaders"));
 
     m_environmentManager.initializeGL();
+    m_physicalSky.initialize();
+    m_reflectionProbes.initialize();
+    m_passDiagnostics.initialize();
     m_cameraEffectsStage.resize(framebuffer);
     m_projectionMatrix = glm::perspective(glm::radians(m_activeCameraFov), m_window.getAspectRatio(), 0.1f, 100.0f);
 
     // Particles GL init
     m_particles.initGL(); // <<< ADDED
+    m_crowdRenderer.initialize();
 
     // Water init
     m_water.initGL(std::filesystem::path(RESOURCE_ROOT "/shaders"));
 
     m_sunPathController.setLightManager(&m_lightManager);
-    m_pathRenderer.initialize(std::filesystem::path(RESOURCE_ROOT "/shaders"));
-    m_cameraPathRenderer.initialize(std::filesystem::path(RESOURCE_ROOT "/shaders"));
+    m_lightManager.setMeshletCuller(&m_meshletCuller);
     m_cameraPathPlayer.setPath(&m_cameraPath);
     m_cameraPathPlayer.setSpeed(m_cameraPathPlaybackSpeed);
     m_activeCameraFov = m_defaultCameraFov;
@@ -352,9 +498,77 @@ Application::Application(std::optional<std::filesystem::path> initialScene)
     // Initialize player state.
     m_player.setPosition(glm::vec3(0, 10, 0));
 
+    m_fileSystem.setAsyncIo(&m_asyncIo);
+    m_asyncIo.setMetricsRegistry(&m_metrics);
+    m_worldPartition.setAsyncIo(&m_asyncIo);
+    m_worldPartition.setMetricsRegistry(&m_metrics);
+    m_aoBaker.setMetricsRegistry(&m_metrics);
+
+    // Last, so the benchmark runs against initialized systems and the tier applies to all of them.
+    m_scalability.setMetricsRegistry(&m_metrics);
+    m_scalability.setApplyCallback([this](ScalabilityManager::Tier, const ScalabilityManager::Preset& preset) {
+        applyScalabilityPreset(preset);
+    });
+    m_scalability.initialize(std::filesystem::path(RESOURCE_ROOT "/shaders"));
+
+    registerMetrics();
+    m_metricsPublisher.open(m_metrics);
+
     registerDebugTabs();
 }
 
+void Application::registerMetrics()
+{
+    FrameMetrics& metrics = m_frameMetrics;
+    metrics.frames = m_metrics.counter("daedalus_frames", "Frames rendered");
+    metrics.frameTimeMs = m_metrics.histogram("daedalus_frame_time_ms", "Measured frame time in milliseconds",
+        { 4.0, 8.0, 12.0, 16.7, 20.0, 25.0, 33.3, 50.0, 66.7, 100.0, 250.0 });
+    metrics.fps = m_metrics.gauge("daedalus_fps", "Frames per second averaged over the frame history");
+    metrics.drawCalls = m_metrics.gauge("daedalus_draw_calls", "Draw calls issued in the last frame");
+    metrics.triangles = m_metrics.gauge("daedalus_triangles", "Triangles submitted in the last frame");
+    metrics.shadowPassMs = m_metrics.gauge("daedalus_pass_shadow_cpu_ms", "CPU time recording the shadow passes");
+    metrics.opaquePassMs = m_metrics.gauge("daedalus_pass_opaque_cpu_ms", "CPU time recording the skybox and opaque pass");
+    metrics.transparentPassMs = m_metrics.gauge("daedalus_pass_transparent_cpu_ms", "CPU time recording the transparent pass");
+    metrics.particlesAlive = m_metrics.gauge("daedalus_particles_alive", "Live particles after emitter LOD");
+    metrics.particlesSimulated = m_metrics.gauge("daedalus_particles_simulated", "Particles stepped in the last frame");
+    metrics.meshletCullMainMs = m_metrics.gauge("daedalus_meshlet_cull_main_ms", "Meshlet culling time for the main view");
+    metrics.meshletCullShadowMs = m_metrics.gauge("daedalus_meshlet_cull_shadow_ms", "Meshlet culling time for shadow views");
+    metrics.collisionMs = m_metrics.gauge("daedalus_collision_move_ms", "Collision resolution time in the last frame");
+    metrics.gpuWaitMs = m_metrics.gauge("daedalus_gpu_wait_ms", "Time blocked on frame-in-flight fences");
+    metrics.inputToGpuMs = m_metrics.gauge("daedalus_input_to_gpu_ms", "Latency from input sampling to GPU completion");
+    metrics.gpuMemoryUsedMB = m_metrics.gauge("daedalus_gpu_memory_used_mb", "Dedicated video memory in use (NVX only)");
+    metrics.processResidentMB = m_metrics.gauge("daedalus_process_resident_mb", "Resident set size of the engine process");
+}
+
+void Application::publishMetrics()
+{
+    const FrameStats& stats = m_frameStats;
+    FrameMetrics& metrics = m_frameMetrics;
+    metrics.frames.add();
+    metrics.frameTimeMs.observe(stats.frameTimeMs);
+    metrics.fps.set(stats.avgFps);
+    metrics.drawCalls.set(static_cast<double>(stats.render.drawCalls));
+    metrics.triangles.set(static_cast<double>(stats.render.triangles));
+    metrics.shadowPassMs.set(stats.shadowPassMs);
+    metrics.opaquePassMs.set(stats.opaquePassMs);
+    metrics.transparentPassMs.set(stats.transparentPassMs);
+    metrics.particlesAlive.set(static_cast<double>(m_particles.lodStats().aliveParticles));
+    metrics.particlesSimulated.set(static_cast<double>(m_particles.lodStats().simulatedParticles));
+    metrics.meshletCullMainMs.set(m_meshletCuller.stats(MeshletCuller::Pass::Main).cullMs);
+    metrics.meshletCullShadowMs.set(m_meshletCuller.stats(MeshletCuller::Pass::Shadow).cullMs);
+    metrics.collisionMs.set(m_collisionWorld.stats().moveTimeThisFrameMs);
+    metrics.gpuWaitMs.set(m_framePacer.stats().gpuWaitMs);
+    metrics.inputToGpuMs.set(m_framePacer.stats().lastLatency.inputToGpuMs);
+    if (stats.gpuMemory.supported)
+        metrics.gpuMemoryUsedMB.set(stats.gpuMemory.usedMB);
+    if (m_metricsFrameIndex % kResidentSampleInterval == 0) {
+        if (const double residentMB = readProcessResidentMB(); residentMB >= 0.0)
+            metrics.processResidentMB.set(residentMB);
+    }
+
+    m_metricsPublisher.publish(m_metricsFrameIndex++);
+}
+
 void Application::registerDebugTabs()
 {
     m_tabEnvironment = m_debugUi.registerTab({
@@ -536,6 +750,28 @@ void Application::registerDebugTabs()
 
 }
 
+void Application::applyScalabilityPreset(const ScalabilityManager::Preset& preset)
+{
+    m_cameraEffectsSettings.msaaEnabled = preset.msaaEnabled;
+    GLint maxSamples = 0;
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    m_cameraEffectsSettings.msaaSamples = maxSamples > 0 ? std::min(preset.msaaSamples, maxSamples) : preset.msaaSamples;
+    m_cameraEffectsSettings.bloom.mipCount = preset.bloomMipCount;
+
+    m_lightManager.setShadowQuality(preset.shadowMapResolution, preset.shadowPcfRadius);
+
+    ProceduralFloor::Settings floor = m_floor.settings();
+    floor.radiusChunks = preset.floorRadiusChunks;
+    floor.chunkResolution = preset.floorChunkResolution;
+    m_floor.setSettings(floor);
+
+    m_water.settings().resolution = preset.waterResolution;
+    m_particles.setDensityScale(preset.particleDensity);
+    m_particles.setParticleBudget(preset.particleBudget);
+    m_environmentManager.setAdvancedSettings(preset.ibl);
+    m_minimap.resize(preset.minimapSize);
+}
+
 void Application::beginFrameStats(float deltaTime)
 {
     const float frameTimeMs = deltaTime * 1000.0f;
@@ -567,6 +803,7 @@ void Application::beginFrameStats(float deltaTime)
 void Application::finalizeFrameStats()
 {
     updateGpuMemoryStats();
+    publishMetrics();
 }
 
 void Application::updateGpuMemoryStats()
@@ -609,6 +846,10 @@ void Application::drawPerformancePanel()
     ImGui::Text("Frame Time: %.2f ms (%.1f FPS)", stats.frameTimeMs, stats.instantFps);
     ImGui::Text("Average: %.2f ms (%.1f FPS)", stats.avgFrameTimeMs, stats.avgFps);
     ImGui::Text("Min / Max: %.2f / %.2f ms", stats.minFrameTimeMs, stats.maxFrameTimeMs);
+    ImGui::Text("CPU passes: shadow %.2f ms | opaque %.2f ms | transparent %.2f ms",
+        static_cast<double>(stats.shadowPassMs),
+        static_cast<double>(stats.opaquePassMs),
+        static_cast<double>(stats.transparentPassMs));
 
     if (!m_frameTimeHistory.empty()) {
         const float maxSample = *std::max_element(m_frameTimeHistory.begin(), m_frameTimeHistory.end());
@@ -622,6 +863,37 @@ void Application::drawPerformancePanel()
             upper,
             ImVec2(ImGui::GetContentRegionAvail().x, 120.0f));
     }
+
+    if (ImGui::CollapsingHeader("Frame Pacing", ImGuiTreeNodeFlags_DefaultOpen))
+        m_framePacer.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Scalability"))
+        m_scalability.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Pass Diagnostics"))
+        m_passDiagnostics.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Meshlet Culling"))
+        m_meshletCuller.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Input Recording / Replay"))
+        m_inputRecorder.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Metrics Export"))
+        m_metricsPublisher.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Asset File System"))
+        m_fileSystem.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Async I/O"))
+        m_asyncIo.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Derived Data"))
+        m_assetDatabase.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Ambient Occlusion Bake"))
+        m_aoBaker.drawImGuiPanel(m_meshManager);
+    if (ImGui::CollapsingHeader("Irradiance Probes"))
+        m_probeGrid.drawImGuiPanel(m_meshManager, m_lightManager);
+    if (ImGui::CollapsingHeader("Path Crowd"))
+        m_crowd.drawImGuiPanel(m_player.position());
+    if (ImGui::CollapsingHeader("World Streaming"))
+        m_worldPartition.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Debug Drawing"))
+        m_debugDraw.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Logging"))
+        logging::drawImGuiPanel();
 }
 
 void Application::drawScenePanel()
@@ -659,8 +931,15 @@ void Application::drawScenePanel()
         ImGui::TextColored(color, "%s", m_modelLoadMessage.c_str());
     }
 
-    if (!m_lastModelPath.empty())
+    if (!m_lastModelPath.empty()) {
         ImGui::Text("Last loaded: %s", m_lastModelPath.filename().string().c_str());
+        if (!m_assetDatabase.isValid(sceneArtifactKey(m_lastModelPath))) {
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "Scene files changed on disk.");
+            ImGui::SameLine();
+            if (ImGui::Button("Reload Scene"))
+                loadSceneFromPath(m_lastModelPath);
+        }
+    }
 }
 
 void Application::drawEnvironmentPanel()
@@ -731,8 +1010,19 @@ void Application::drawEnvironmentPanel()
 
     if (m_environmentManager.hasEnvironment()) {
         ImGui::Text("Active Environment: %s", m_environmentManager.currentEnvironmentPath().filename().string().c_str());
+        if (m_environmentManager.environmentSourceChanged()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "HDR changed on disk.");
+            ImGui::SameLine();
+            if (ImGui::Button("Rebake"))
+                loadEnvironmentFromPath(m_environmentManager.currentEnvironmentPath());
+        }
     }
 
+    if (ImGui::CollapsingHeader("Physical Sky"))
+        m_physicalSky.drawImGuiPanel();
+    if (ImGui::CollapsingHeader("Reflection Probes"))
+        m_reflectionProbes.drawImGuiPanel(m_cameraStage.getPosition());
+
     // Visual effects: world curvature and fog (moved from Particles tab)
     if (ImGui::CollapsingHeader("Visual Effects")) {
         // World curvature toggle (applies a view-space curvature to all geometry)
@@ -781,6 +1071,19 @@ void Application::drawPlayerPanel()
         m_player.setParams(params);
     ImGui::Text("Grounded: %s", m_player.grounded() ? "Yes" : "No");
     ImGui::Text("Position: (%.2f %.2f %.2f)", static_cast<double>(m_player.position().x), static_cast<double>(m_player.position().y), static_cast<double>(m_player.position().z));
+
+    ImGui::Separator();
+    if (ImGui::Checkbox("Collide With Meshes", &m_meshCollisionEnabled) && !m_meshCollisionEnabled)
+        m_collisionWorld.clear();
+    auto collision = m_player.collisionParams();
+    bool collisionDirty = false;
+    collisionDirty |= ImGui::SliderFloat("Max Slope (deg)", &collision.maxSlopeDegrees, 10.0f, 80.0f, "%.0f");
+    collisionDirty |= ImGui::SliderFloat("Step Height", &collision.stepHeight, 0.0f, 1.0f, "%.2f");
+    collisionDirty |= ImGui::SliderFloat("Ground Snap", &collision.snapDistance, 0.0f, 1.0f, "%.2f");
+    collisionDirty |= ImGui::Checkbox("Snap To Ground", &collision.snapToGround);
+    if (collisionDirty)
+        m_player.setCollisionParams(collision);
+    m_collisionWorld.drawImGuiPanel();
 }
 
 void Application::drawPathsPanel()
@@ -1137,7 +1440,7 @@ void Application::rebuildCameraPathBezier()
     m_cameraPathBezierVersion = version;
 }
 
-void Application::renderCameraPathDebug(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, RenderStats& stats)
+void Application::renderCameraPathDebug(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
 {
     if (!m_cameraPathVisible || m_cameraPath.keyCount() < 2)
         return;
@@ -1147,27 +1450,11 @@ void Application::renderCameraPathDebug(const glm::mat4& viewMatrix, const glm::
         return;
 
     m_cameraPathRenderer.updateGeometry(m_cameraPathBezier, m_cameraPathBezierVersion);
-
-    GLboolean depthMask = GL_TRUE;
-    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
-    glDepthMask(GL_FALSE);
-
-    m_cameraPathRenderer.drawCurve(viewMatrix, projectionMatrix, glm::vec3(0.95f, 0.45f, 0.15f));
-    stats.addDraw(1, 0);
-
-    if (m_cameraPathShowTangents) {
-        m_cameraPathRenderer.drawTangents(viewMatrix, projectionMatrix, glm::vec3(0.25f, 0.8f, 1.0f));
-        stats.addDraw(1, 0);
-    }
-
-    if (m_cameraPathShowKeyframes) {
-        glEnable(GL_PROGRAM_POINT_SIZE);
-        m_cameraPathRenderer.drawControlPoints(viewMatrix, projectionMatrix, glm::vec3(1.0f, 1.0f, 0.3f), 7.0f);
-        glDisable(GL_PROGRAM_POINT_SIZE);
-        stats.addDraw(1, 0);
-    }
-
-    glDepthMask(depthMask);
+    m_cameraPathRenderer.drawCurve(m_debugDraw, glm::vec4(0.95f, 0.45f, 0.15f, 1.0f));
+    if (m_cameraPathShowTangents)
+        m_cameraPathRenderer.drawTangents(m_debugDraw, glm::vec4(0.25f, 0.8f, 1.0f, 1.0f));
+    if (m_cameraPathShowKeyframes)
+        m_cameraPathRenderer.drawControlPoints(m_debugDraw, glm::vec4(1.0f, 1.0f, 0.3f, 1.0f));
 
     if (!m_cameraPathShowKeyframes)
         return;
@@ -1423,6 +1710,7 @@ void Application::drawSelectionPanel()
 
     ImGui::Separator();
     ImGui::TextUnformatted("Selection");
+    ImGui::Checkbox("Show Selectable Bounds", &m_showSelectableBounds);
     const auto selection = m_selectionManager.selection();
     if (selection) {
         ImGui::Text("Type: %s", describeType(selection->id.type));
@@ -1506,6 +1794,11 @@ void Application::drawParticlesPanel()
     }
     
     ImGui::Separator();
+
+    if (ImGui::CollapsingHeader("Emitter LOD & Budget"))
+        m_particles.drawImGuiPanel();
+
+    ImGui::Separator();
     
     // Snow system controls
     if (ImGui::CollapsingHeader("Snow System", ImGuiTreeNodeFlags_DefaultOpen)) {
@@ -1637,26 +1930,63 @@ void Application::drawParticlesPanel()
 Application::~Application()
 {
     m_cameraEffectsStage.shutdown();
-    if (m_lightCubeEBO) glDeleteBuffers(1, &m_lightCubeEBO);
-    if (m_lightCubeVBO) glDeleteBuffers(1, &m_lightCubeVBO);
-    if (m_lightCubeVAO) glDeleteVertexArrays(1, &m_lightCubeVAO);
-    m_pathRenderer.shutdown();
-    m_cameraPathRenderer.shutdown();
+    m_debugDraw.shutdown();
+    m_probeGrid.shutdown();
+    m_crowdRenderer.release();
+    m_physicalSky.release();
+    m_reflectionProbes.release();
+    m_passDiagnostics.release();
+    m_assetDatabase.save();
 }
 
 void Application::update()
 {
+    if (m_launchOptions.replayPath) {
+        if (m_launchOptions.benchmark) {
+            // Benchmarks measure the frame itself, not the display.
+            FramePacer::Settings pacing = m_framePacer.settings();
+            pacing.vsync = FramePacer::VsyncMode::Off;
+            pacing.frameRateCapEnabled = false;
+            m_framePacer.setSettings(pacing);
+        }
+        if (!m_inputRecorder.startReplay(*m_launchOptions.replayPath, m_launchOptions.replay) && m_launchOptions.benchmark)
+            return;
+    } else if (m_launchOptions.recordPath) {
+        m_inputRecorder.startRecording(*m_launchOptions.recordPath);
+    }
+
     auto lastFrameTime = std::chrono::steady_clock::now();
 
     while (!m_window.shouldClose()) {
+        m_framePacer.beginFrame();
+
         const auto now = std::chrono::steady_clock::now();
-        const float deltaTime = std::chrono::duration<float>(now - lastFrameTime).count();
+        const float measuredDeltaTime = std::chrono::duration<float>(now - lastFrameTime).count();
         lastFrameTime = now;
+        // While recording or replaying the recorder owns the timestep and reseeds the RNG.
+        const float deltaTime = m_inputRecorder.beginFrame(measuredDeltaTime);
         m_simulationTime += deltaTime;
 
-    beginFrameStats(deltaTime);
+    beginFrameStats(measuredDeltaTime);
+        // Time spent sleeping for the frame-rate cap is not a budget miss. The tier stays fixed
+        // during a replay, since particle density changes what the recorded inputs spawn.
+        if (m_inputRecorder.mode() != InputRecorder::Mode::Replaying)
+            m_scalability.onFrame(measuredDeltaTime * 1000.0f - m_framePacer.stats().capWaitMs);
+
+        // Deliver finished background reads before anything this frame asks for them.
+        m_asyncIo.pollCompletions();
+        finishPendingEnvironmentLoad();
+
+        // Only stats the files loaded assets came from; edited ones are re-hashed and their
+        // scene / environment is flagged in the UI.
+        m_assetRescanTimer += measuredDeltaTime;
+        if (m_assetRescanTimer >= kAssetRescanIntervalSeconds) {
+            m_assetRescanTimer = 0.0f;
+            m_assetDatabase.refreshSources();
+        }
 
         m_window.updateInput();
+        m_framePacer.markInputSampled();
         m_cameraStage.update(deltaTime);
 
         m_cameraPathPlayer.update(deltaTime);
@@ -1706,7 +2036,9 @@ void Application::update()
 
         bool jumpReq = m_cameraStage.consumeJumpRequested();
         const ProceduralFloor* activeFloor = m_showGround ? &m_floor : nullptr;
-        m_player.update(deltaTime, activeFloor, jumpReq);
+        if (m_meshCollisionEnabled)
+            m_collisionWorld.sync(m_meshManager);
+        m_player.update(deltaTime, activeFloor, jumpReq, m_meshCollisionEnabled ? &m_collisionWorld : nullptr);
 
         if (m_cameraStage.getMode() == CameraStage::Mode::FirstPerson) {
             glm::vec3 camPos = m_player.eyePosition();
@@ -1714,8 +2046,14 @@ void Application::update()
         }
 
         // Particles update
-        m_particles.update(deltaTime); // <<< ADDED
+        ParticleSystem::View particleView;
+        particleView.viewProjection = m_projectionMatrix * viewMatrix;
+        particleView.cameraPosition = cameraPosition;
+        particleView.pixelsPerUnit = m_projectionMatrix[1][1] * 0.5f * static_cast<float>(m_window.getFrameBufferSize().y);
+        m_particles.update(deltaTime, particleView); // <<< ADDED
         m_particles.updateSnow(deltaTime, cameraPosition); // <<< ADDED for snow system
+        if (m_crowd.settings().enabled && m_crowd.followerCount() > 0)
+            m_crowd.update(deltaTime, m_crowdRenderer.map(m_crowd.followerCount()));
 
         if (m_runtimeLoadAutoTest && !m_runtimeLoadTriggered && m_simulationTime > 0.5f) {
             const std::filesystem::path autoLoadPath = std::filesystem::path(RESOURCE_ROOT "resources/dragon.obj");
@@ -1723,17 +2061,53 @@ void Application::update()
             m_runtimeLoadTriggered = true;
         }
 
+        // Stream scene geometry around where the camera is and is heading.
+        WorldPartition::Focus streamingFocus;
+        streamingFocus.position = cameraPosition;
+        if (deltaTime > 0.0f)
+            streamingFocus.velocity = (cameraPosition - m_lastStreamingPosition) / deltaTime;
+        m_lastStreamingPosition = cameraPosition;
+        if (m_cameraPathPlayer.playing()) {
+            const float lookahead = m_worldPartition.settings().pathLookaheadSeconds * m_cameraPathPlayer.speed();
+            streamingFocus.pathLookahead = m_cameraPath.samplePosition(m_cameraPathPlayer.playhead() + lookahead);
+        }
+        m_worldPartition.update(m_meshManager, streamingFocus);
+        m_aoBaker.update(m_meshManager);
+        m_probeGrid.update();
+        m_physicalSky.update(m_sunPathController.sunDirection());
+
     m_environmentManager.sanitizeGeneratedTextures();
 
     ShadingStage::EnvironmentState environmentState;
-        environmentState.irradianceMap = m_environmentManager.irradianceCubemap();
-        environmentState.prefilterMap = m_environmentManager.prefilterCubemap();
         environmentState.brdfLut = m_environmentManager.brdfLutTexture();
-        environmentState.intensity = m_environmentManager.environmentIntensity();
-        environmentState.prefilterMipLevels = static_cast<float>(m_environmentManager.prefilterMipLevelCount());
-        environmentState.useIBL = m_environmentManager.useIBL() && m_environmentManager.hasEnvironment();
+        if (m_physicalSky.enabled()) {
+            // The sky replaces the HDR environment; its mipmapped cubemap stands in for the prefiltered map.
+            environmentState.irradianceMap = m_physicalSky.irradianceCubemap();
+            environmentState.prefilterMap = m_physicalSky.skyCubemap();
+            environmentState.intensity = m_physicalSky.intensity();
+            environmentState.prefilterMipLevels = static_cast<float>(m_physicalSky.skyMipLevels());
+            environmentState.useIBL = m_environmentManager.useIBL() && m_physicalSky.hasLighting();
+        } else {
+            environmentState.irradianceMap = m_environmentManager.irradianceCubemap();
+            environmentState.prefilterMap = m_environmentManager.prefilterCubemap();
+            environmentState.intensity = m_environmentManager.environmentIntensity();
+            environmentState.prefilterMipLevels = static_cast<float>(m_environmentManager.prefilterMipLevelCount());
+            environmentState.useIBL = m_environmentManager.useIBL() && m_environmentManager.hasEnvironment();
+        }
         m_shadingStage.setEnvironmentState(environmentState);
 
+        ShadingStage::ProbeGridState probeGridState;
+        if (m_probeGrid.active()) {
+            const IrradianceProbeGrid::Grid& grid = m_probeGrid.grid();
+            probeGridState.atlas = m_probeGrid.atlasTexture();
+            probeGridState.origin = grid.origin;
+            probeGridState.spacing = grid.spacing;
+            probeGridState.resolution = grid.resolution;
+            probeGridState.intensity = m_probeGrid.settings().intensity;
+            probeGridState.normalBias = m_probeGrid.settings().normalBias * std::min({ grid.spacing.x, grid.spacing.y, grid.spacing.z });
+        }
+        m_shadingStage.setProbeGridState(probeGridState);
+
         m_sunPathController.update(static_cast<double>(deltaTime));
         m_pendulumManager.update(static_cast<double>(deltaTime));
 
@@ -1839,7 +2213,14 @@ void Application::update()
     RenderStats renderStats {};
     renderStats.reset();
 
+        m_meshletCuller.beginFrame();
+        const glm::ivec2 framebufferSize = m_window.getFrameBufferSize();
+        m_passDiagnostics.beginFrame(framebufferSize);
+        const auto shadowPassStart = std::chrono::steady_clock::now();
+        m_passDiagnostics.beginPass(PassDiagnostics::Pass::Shadows);
         renderShadowPasses(viewMatrix, m_projectionMatrix);
+        m_passDiagnostics.endPass(PassDiagnostics::Pass::Shadows);
+        m_frameStats.shadowPassMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - shadowPassStart).count();
 
         m_lightManager.updateGpuData();
         const LightManager::GpuBinding& lightBindingSrc = m_lightManager.gpuBinding();
@@ -1854,40 +2235,81 @@ void Application::update()
         lightBinding.lightCount = lightBindingSrc.lightCount;
         lightBinding.directionalLightCount = lightBindingSrc.directionalLightCount;
         m_shadingStage.setLightBinding(lightBinding);
+        m_shadingStage.syncMaterialTextureArrays(m_meshManager.instances());
 
         LightingSettings& legacyLighting = m_shadingStage.settings();
         glm::vec3 fallbackPos = legacyLighting.lightPos;
         glm::vec3 fallbackColor = legacyLighting.lightColor;
-        const auto& sceneLights = m_lightManager.lights();
-        for (const LightManager::Light& light : sceneLights) {
-            if (!light.enabled)
+        for (std::size_t i = 0; i < m_lightManager.lightCount(); ++i) {
+            if (!m_lightManager.isEnabled(i))
                 continue;
 
-            fallbackColor = glm::max(light.color * light.intensity, glm::vec3(0.0f));
-            fallbackPos = light.position;
+            fallbackColor = glm::max(m_lightManager.color(i) * m_lightManager.intensity(i), glm::vec3(0.0f));
+            fallbackPos = m_lightManager.position(i);
             break;
         }
         legacyLighting.lightColor = fallbackColor;
         legacyLighting.lightPos = fallbackPos;
 
+        // Reflection probe captures are lit like the frame: same lights, same environment.
+        const ShadingStage::EnvironmentState& captureEnvironment = m_shadingStage.environmentState();
+        const bool captureUsesEnvironment = captureEnvironment.useIBL && captureEnvironment.isValid();
+        ReflectionProbes::SceneLighting probeLighting;
+        probeLighting.lightBuffer = lightBinding.lightSSBO;
+        probeLighting.lightCount = lightBinding.lightCount;
+        probeLighting.skyCubemap = captureUsesEnvironment ? captureEnvironment.prefilterMap : 0;
+        probeLighting.irradianceCubemap = captureUsesEnvironment ? captureEnvironment.irradianceMap : 0;
+        probeLighting.environmentIntensity = captureEnvironment.intensity;
+        probeLighting.ambient = legacyLighting.ambientColor * legacyLighting.ambientStrength;
+        m_reflectionProbes.update(m_meshManager, cameraPosition, probeLighting);
+
+        ShadingStage::ReflectionProbeState reflectionProbeState;
+        if (m_reflectionProbes.active()) {
+            reflectionProbeState.cubemapArray = m_reflectionProbes.cubemapArray();
+            reflectionProbeState.mipLevels = ReflectionProbes::kMipLevels;
+            for (int slot = 0; slot < ReflectionProbes::kMaxProbes; ++slot) {
+                if (!m_reflectionProbes.published(slot))
+                    continue;
+                const ReflectionProbes::Probe& probe = m_reflectionProbes.probe(slot);
+                ShadingStage::ReflectionProbeState::Volume& volume = reflectionProbeState.volumes[static_cast<std::size_t>(reflectionProbeState.count++)];
+                volume.capturePosition = probe.capturePosition;
+                volume.boxMin = probe.boxMin;
+                volume.boxMax = probe.boxMax;
+                volume.blendDistance = probe.blendDistance;
+                volume.boxProjection = probe.boxProjection;
+                volume.layer = slot;
+            }
+        }
+        m_shadingStage.setReflectionProbeState(reflectionProbeState);
+
 
-        const glm::ivec2 framebufferSize = m_window.getFrameBufferSize();
         m_cameraEffectsStage.updateUniforms(m_cameraEffectsSettings, framebufferSize, deltaTime, 0.1f, 100.0f);
+        m_cameraEffectsStage.setSceneStencilEnabled(m_passDiagnostics.wantsSceneStencil());
         m_cameraEffectsStage.beginSceneCapture(framebufferSize, m_cameraEffectsSettings);
         TRACE_APP_FBO("after beginSceneCapture");
 
         glEnable(GL_DEPTH_TEST);
 
+        const auto opaquePassStart = std::chrono::steady_clock::now();
+        m_passDiagnostics.beginPass(PassDiagnostics::Pass::Opaque);
         renderSkybox(viewMatrix, m_projectionMatrix, renderStats);
         TRACE_APP_FBO("after renderSkybox");
         renderPass(viewMatrix, m_projectionMatrix, cameraPosition, renderStats);
         TRACE_APP_FBO("after renderPass");
+        m_passDiagnostics.endPass(PassDiagnostics::Pass::Opaque);
+        const auto transparentPassStart = std::chrono::steady_clock::now();
+        m_frameStats.opaquePassMs = std::chrono::duration<float, std::milli>(transparentPassStart - opaquePassStart).count();
 
         // Transparent pass (particles)
+        m_passDiagnostics.beginPass(PassDiagnostics::Pass::Transparent);
         renderTransparentPass(viewMatrix, m_projectionMatrix, cameraPosition); // <<< ADDED
+        m_passDiagnostics.endPass(PassDiagnostics::Pass::Transparent);
+        m_frameStats.transparentPassMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - transparentPassStart).count();
         // Skybox + debug primitives
+        m_passDiagnostics.beginPass(PassDiagnostics::Pass::Overlay);
         renderSkybox(viewMatrix, m_projectionMatrix, renderStats);
         renderDebugPrimitives(viewMatrix, m_projectionMatrix, renderStats);
+        m_passDiagnostics.endPass(PassDiagnostics::Pass::Overlay);
 
         TRACE_APP_FBO("after renderDebugPrimitives");
 
@@ -1903,6 +2325,7 @@ void Application::update()
             }
 #endif
         
+        m_passDiagnostics.beginPass(PassDiagnostics::Pass::PostProcess);
         m_cameraEffectsStage.drawPostProcess(framebufferSize);
         TRACE_APP_FBO("after drawPostProcess");
 
@@ -1914,8 +2337,19 @@ void Application::update()
                                                  0, // target default framebuffer
                                                  0.1f, 100.0f); // near, far planes
         }
+        m_passDiagnostics.endPass(PassDiagnostics::Pass::PostProcess);
         TRACE_APP_FBO("after outline pass");
 
+        m_passDiagnostics.drawVisualization(m_meshManager, m_projectionMatrix * viewMatrix,
+            m_cameraEffectsStage.sceneDepthTexture(),
+            m_cameraEffectsStage.sceneStencilEnabled() ? m_cameraEffectsStage.sceneDepthTexture() : 0,
+            framebufferSize, framebufferSize);
+
+        // Overlay debug geometry goes straight onto the final image.
+        drawSelectionOverlay();
+        m_debugDraw.renderOverlay(m_projectionMatrix * viewMatrix,
+                                  glm::vec2(ImGui::GetIO().DisplaySize.x, ImGui::GetIO().DisplaySize.y));
+
         // Render minimap to its texture (center on player XZ) only if enabled
         if (m_showMinimap) {
             const glm::vec3 playerPos = m_player.position();
@@ -1942,6 +2376,8 @@ void Application::update()
                     for (MeshInstance& instance : m_meshManager.instances()) {
                         const glm::mat4& instanceTransform = instance.transform();
                         for (MeshDrawItem& item : instance.drawItems()) {
+                            if (!item.geometry.resident())
+                                continue;
                             const glm::mat4 model = instanceTransform * item.nodeTransform;
                             m_shadingStage.apply(model,
                                                  view,
@@ -1957,7 +2393,6 @@ void Application::update()
                 });
         }
 
-        drawSelectionOverlay(viewMatrix, m_projectionMatrix);
         drawCrosshairOverlay();
 
         // draw ImGui minimap overlay
@@ -2037,61 +2472,11 @@ void Application::update()
 
         // Processes input and swaps the window buffer
         m_window.swapBuffers();
-    }
-}
+        m_framePacer.endFrame();
 
-// ---------------- Light cube helpers ----------------
-
-void Application::initLightCube()
-{
-    if (m_lightCubeVAO != 0) return;
-    const float vertices[] = {
-        // positions
-        -0.5f,-0.5f,-0.5f,  0.5f,-0.5f,-0.5f,  0.5f, 0.5f,-0.5f,  -0.5f, 0.5f,-0.5f,
-        -0.5f,-0.5f, 0.5f,  0.5f,-0.5f, 0.5f,  0.5f, 0.5f, 0.5f,  -0.5f, 0.5f, 0.5f
-    };
-    const unsigned indices[] = {
-        0,1,2, 2,3,0, // back
-        4,5,6, 6,7,4, // front
-        0,4,7, 7,3,0, // left
-        1,5,6, 6,2,1, // right
-        3,2,6, 6,7,3, // top
-        0,1,5, 5,4,0  // bottom
-    };
-    glGenVertexArrays(1,&m_lightCubeVAO);
-    glGenBuffers(1,&m_lightCubeVBO);
-    glGenBuffers(1,&m_lightCubeEBO);
-    glBindVertexArray(m_lightCubeVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_lightCubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_lightCubeEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,3*sizeof(float),(void*)0);
-    glBindVertexArray(0);
-}
-
-void Application::buildLightCubeShader()
-{
-    ShaderBuilder sb; sb.addStage(GL_VERTEX_SHADER, RESOURCE_ROOT "shaders/light_cube.vert");
-    sb.addStage(GL_FRAGMENT_SHADER, RESOURCE_ROOT "shaders/light_cube.frag");
-    m_lightCubeShader = sb.build();
-}
-
-void Application::renderLightCube(const glm::vec3& pos, const glm::mat4& view, const glm::mat4& proj, const glm::vec3& color)
-{
-    if (m_lightCubeVAO == 0) return;
-    m_lightCubeShader.bind();
-    glDisable(GL_CULL_FACE);
-    const glm::mat4 model = glm::translate(glm::mat4(1.0f), pos) * glm::scale(glm::mat4(1.0f), glm::vec3(0.1f));
-    auto loc = m_lightCubeShader.getUniformLocation("model"); if (loc>=0) glUniformMatrix4fv(loc,1,GL_FALSE,glm::value_ptr(model));
-    loc = m_lightCubeShader.getUniformLocation("view"); if (loc>=0) glUniformMatrix4fv(loc,1,GL_FALSE,glm::value_ptr(view));
-    loc = m_lightCubeShader.getUniformLocation("projection"); if (loc>=0) glUniformMatrix4fv(loc,1,GL_FALSE,glm::value_ptr(proj));
-    loc = m_lightCubeShader.getUniformLocation("color"); if (loc>=0) glUniform3fv(loc,1,glm::value_ptr(color));
-    glBindVertexArray(m_lightCubeVAO);
-    glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
-    glEnable(GL_CULL_FACE);
+        if (m_inputRecorder.exitRequested())
+            m_window.close();
+    }
 }
 
 // ---------------- Render passes ----------------
@@ -2121,7 +2506,7 @@ void Application::renderPass(const glm::mat4& viewMatrix,
 
     const bool skyboxAlreadyDrew =
         m_environmentManager.skyboxVisible() &&
-        m_environmentManager.hasEnvironment();
+        (m_environmentManager.hasEnvironment() || m_physicalSky.enabled());
 
     if (skyboxAlreadyDrew) {
         // skybox filled the background → only clear depth
@@ -2160,6 +2545,8 @@ void Application::renderPass(const glm::mat4& viewMatrix,
     for (MeshInstance& instance : m_meshManager.instances()) {
         const glm::mat4& instanceTransform = instance.transform();
         for (MeshDrawItem& item : instance.drawItems()) {
+            if (!item.geometry.resident())
+                continue; // streamed out by the world partition
             const glm::mat4 model = instanceTransform * item.nodeTransform;
             const glm::vec3 worldPos = glm::vec3(model[3]);
             const float distSq = glm::length2(worldPos - cameraPosition);
@@ -2178,6 +2565,8 @@ void Application::renderPass(const glm::mat4& viewMatrix,
         }
     }
 
+    m_meshletCuller.setView(MeshletCuller::Pass::Main, { projectionMatrix * viewMatrix, cameraPosition }, MeshletCuller::FaceCull::Back);
+
     // ===== OPAQUE PASS: depth test ON, depth write ON, blending OFF =====
     glDepthMask(GL_TRUE);
     glDisable(GL_BLEND);
@@ -2191,14 +2580,21 @@ void Application::renderPass(const glm::mat4& viewMatrix,
                              cmd.item->hasUVs,
                              cmd.item->hasSecondaryUVs,
                              cmd.item->hasTangents);
-        cmd.item->geometry.draw(m_shadingStage.shader());
-
-        const std::uint64_t triangleCount = static_cast<std::uint64_t>(cmd.item->geometry.indexCount()) / 3;
+        const std::uint64_t triangleCount = m_meshletCuller.draw(*cmd.item, cmd.model, cmd.item->material.doubleSided);
         stats.addDraw(1, triangleCount);
     }
 
     renderPendulums(viewMatrix, projectionMatrix, cameraPosition, stats);
 
+    CrowdRenderer::DrawParams crowdParams;
+    crowdParams.view = viewMatrix;
+    crowdParams.projection = projectionMatrix;
+    crowdParams.lightPos = m_shadingStage.settings().lightPos;
+    crowdParams.lightColor = m_shadingStage.settings().lightColor;
+    crowdParams.ambientColor = m_shadingStage.settings().ambientColor;
+    crowdParams.ambientStrength = m_shadingStage.settings().ambientStrength;
+    m_crowdRenderer.draw(crowdParams, &stats);
+
     // ===== TRANSPARENT PASS: depth test ON, depth write OFF, blending ON =====
     if (!transparentList.empty()) {
         // Sort transparent objects back-to-front
@@ -2220,9 +2616,7 @@ void Application::renderPass(const glm::mat4& viewMatrix,
                                  cmd.item->hasUVs,
                                  cmd.item->hasSecondaryUVs,
                                  cmd.item->hasTangents);
-            cmd.item->geometry.draw(m_shadingStage.shader());
-
-            const std::uint64_t triangleCount = static_cast<std::uint64_t>(cmd.item->geometry.indexCount()) / 3;
+            const std::uint64_t triangleCount = m_meshletCuller.draw(*cmd.item, cmd.model, cmd.item->material.doubleSided);
             stats.addDraw(1, triangleCount);
         }
 
@@ -2326,8 +2720,14 @@ void Application::renderPendulums(const glm::mat4& viewMatrix, const glm::mat4&
 
 void Application::renderSkybox(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, RenderStats& stats)
 {
-    const bool shouldDraw = m_environmentManager.hasEnvironment() && m_environmentManager.skyboxVisible();
-    if (!shouldDraw)
+    if (!m_environmentManager.skyboxVisible())
+        return;
+    if (m_physicalSky.enabled()) {
+        m_physicalSky.drawSky(viewMatrix, projectionMatrix);
+        stats.addDraw(1, 1);
+        return;
+    }
+    if (!m_environmentManager.hasEnvironment())
         return;
     m_environmentManager.drawSkybox(viewMatrix, projectionMatrix);
     stats.addDraw(1, 12);
@@ -2335,18 +2735,18 @@ void Application::renderSkybox(const glm::mat4& viewMatrix, const glm::mat4& pro
 
 void Application::renderDebugPrimitives(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix, RenderStats& stats)
 {
-    glEnable(GL_FRAMEBUFFER_SRGB);
-    for (const LightManager::Light& light : m_lightManager.lights()) {
-        if (!light.enabled)
-            continue;
+    for (std::size_t i = 0; i < m_lightManager.lightCount(); ++i) {
+        if (m_lightManager.isEnabled(i))
+            m_debugDraw.solidBox(m_lightManager.position(i), glm::vec3(0.05f), glm::vec4(m_lightManager.color(i), 1.0f));
+    }
 
-        glm::vec3 color = light.color;
-        switch (light.type) {
-        case LightManager::LightType::Point:
-        case LightManager::LightType::Spot:
-            renderLightCube(light.position, viewMatrix, projectionMatrix, color);
-            stats.addDraw(1, 12);
-            break;
+    if (m_showSelectableBounds) {
+        const glm::vec4 boundsColor(0.3f, 0.9f, 0.4f, 0.6f);
+        for (const SelectionManager::SelectableEntry& entry : m_selectionManager.selectables()) {
+            if (entry.shape == SelectionManager::Shape::Sphere)
+                m_debugDraw.sphere(entry.center, entry.radius, boundsColor, DebugDraw::Layer::DepthTested, 12);
+            else
+                m_debugDraw.box(entry.bounds.min, entry.bounds.max, boundsColor);
         }
     }
 
@@ -2355,48 +2755,30 @@ void Application::renderDebugPrimitives(const glm::mat4& viewMatrix, const glm::
     const bool drawTangents = m_sunPathController.showTangents();
     if (m_sunPathController.hasPath() && (drawCurve || drawControlPoints || drawTangents)) {
         m_pathRenderer.updateGeometry(m_sunPathController.path(), m_sunPathController.pathVersion());
-
-        GLboolean depthMask;
-        glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
-        glDepthMask(GL_FALSE);
-
-        if (drawCurve) {
-            m_pathRenderer.drawCurve(viewMatrix, projectionMatrix, glm::vec3(1.0f, 0.85f, 0.1f));
-            stats.addDraw(1, 0);
-        }
-
-        if (drawTangents) {
-            m_pathRenderer.drawTangents(viewMatrix, projectionMatrix, glm::vec3(0.2f, 0.8f, 1.0f));
-            stats.addDraw(1, 0);
-        }
-
-        if (drawControlPoints) {
-            glEnable(GL_PROGRAM_POINT_SIZE);
-            m_pathRenderer.drawControlPoints(viewMatrix, projectionMatrix, glm::vec3(1.0f, 0.2f, 0.2f));
-            glDisable(GL_PROGRAM_POINT_SIZE);
-            stats.addDraw(1, 0);
-        }
-
-        glDepthMask(depthMask);
+        if (drawCurve)
+            m_pathRenderer.drawCurve(m_debugDraw, glm::vec4(1.0f, 0.85f, 0.1f, 1.0f));
+        if (drawTangents)
+            m_pathRenderer.drawTangents(m_debugDraw, glm::vec4(0.2f, 0.8f, 1.0f, 1.0f));
+        if (drawControlPoints)
+            m_pathRenderer.drawControlPoints(m_debugDraw, glm::vec4(1.0f, 0.2f, 0.2f, 1.0f));
     }
 
-    renderCameraPathDebug(viewMatrix, projectionMatrix, stats);
+    renderCameraPathDebug(viewMatrix, projectionMatrix);
+
+    glEnable(GL_FRAMEBUFFER_SRGB);
+    m_debugDraw.renderDepthTested(projectionMatrix * viewMatrix, &stats);
     glDisable(GL_FRAMEBUFFER_SRGB);
 }
 
-void Application::drawSelectionOverlay(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix)
+void Application::drawSelectionOverlay()
 {
-    const ImVec2 displaySize = ImGui::GetIO().DisplaySize;
-    if (displaySize.x <= 0.0f || displaySize.y <= 0.0f)
-        return;
-
     const auto selection = m_selectionManager.selection();
 
-    std::vector<std::pair<const SelectionManager::HitResult*, ImU32>> overlays;
+    std::vector<std::pair<const SelectionManager::HitResult*, glm::vec4>> overlays;
     overlays.reserve(2);
 
-    const ImU32 hoverColor = IM_COL32(90, 200, 255, 200);
-    const ImU32 selectColor = m_isDraggingSelection ? IM_COL32(255, 210, 60, 240) : IM_COL32(255, 230, 90, 220);
+    const glm::vec4 hoverColor = glm::vec4(90.0f, 200.0f, 255.0f, 200.0f) / 255.0f;
+    const glm::vec4 selectColor = (m_isDraggingSelection ? glm::vec4(255.0f, 210.0f, 60.0f, 240.0f) : glm::vec4(255.0f, 230.0f, 90.0f, 220.0f)) / 255.0f;
 
     if (m_hoveredSelectable)
         overlays.emplace_back(&*m_hoveredSelectable, hoverColor);
@@ -2413,73 +2795,18 @@ void Application::drawSelectionOverlay(const glm::mat4& viewMatrix, const glm::m
     if (overlays.empty())
         return;
 
-    auto* drawList = ImGui::GetForegroundDrawList();
-    const glm::mat4 viewProj = projectionMatrix * viewMatrix;
-
-    static constexpr std::array<std::pair<int, int>, 12> edges { {
-        { 0, 1 }, { 1, 3 }, { 3, 2 }, { 2, 0 },
-        { 4, 5 }, { 5, 7 }, { 7, 6 }, { 6, 4 },
-        { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
-    } };
-
-    const auto projectPoint = [&](const glm::vec3& world) -> std::optional<ImVec2> {
-        const glm::vec4 clip = viewProj * glm::vec4(world, 1.0f);
-        if (clip.w <= 0.0f)
-            return std::nullopt;
-        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
-        if (ndc.z < 0.0f || ndc.z > 1.0f)
-            return std::nullopt;
-        ImVec2 screen;
-        screen.x = (ndc.x * 0.5f + 0.5f) * displaySize.x;
-        screen.y = (1.0f - (ndc.y * 0.5f + 0.5f)) * displaySize.y;
-        return screen;
-    };
-
     for (const auto& [hit, color] : overlays) {
         if (!hit)
             continue;
 
-        glm::vec3 boundsMin;
-        glm::vec3 boundsMax;
-        if (hit->shape == SelectionManager::Shape::Sphere) {
-            boundsMin = hit->center - glm::vec3(hit->radius);
-            boundsMax = hit->center + glm::vec3(hit->radius);
-        } else {
-            boundsMin = hit->bounds.min;
-            boundsMax = hit->bounds.max;
-        }
-
-        const std::array<glm::vec3, 8> corners { {
-            { boundsMin.x, boundsMin.y, boundsMin.z },
-            { boundsMax.x, boundsMin.y, boundsMin.z },
-            { boundsMin.x, boundsMax.y, boundsMin.z },
-            { boundsMax.x, boundsMax.y, boundsMin.z },
-            { boundsMin.x, boundsMin.y, boundsMax.z },
-            { boundsMax.x, boundsMin.y, boundsMax.z },
-            { boundsMin.x, boundsMax.y, boundsMax.z },
-            { boundsMax.x, boundsMax.y, boundsMax.z }
-        } };
-
-        std::array<ImVec2, 8> projected {};
-        bool valid = true;
-        for (std::size_t i = 0; i < corners.size(); ++i) {
-            const auto screen = projectPoint(corners[i]);
-            if (!screen.has_value()) {
-                valid = false;
-                break;
-            }
-            projected[i] = *screen;
-        }
-
-        if (!valid)
-            continue;
-
-        for (const auto& edge : edges)
-            drawList->AddLine(projected[edge.first], projected[edge.second], color, 1.5f);
+        if (hit->shape == SelectionManager::Shape::Sphere)
+            m_debugDraw.box(hit->center - glm::vec3(hit->radius), hit->center + glm::vec3(hit->radius), color, DebugDraw::Layer::Overlay);
+        else
+            m_debugDraw.box(hit->bounds.min, hit->bounds.max, color, DebugDraw::Layer::Overlay);
 
         if (!hit->name.empty()) {
-            const ImVec2 labelPos = projected[0];
-            drawList->AddText(labelPos, color, hit->name.c_str());
+            const glm::vec3 labelAnchor = hit->shape == SelectionManager::Shape::Sphere ? hit->center - glm::vec3(hit->radius) : hit->bounds.min;
+            m_debugDraw.text(labelAnchor, hit->name, color);
         }
     }
 }
@@ -2529,17 +2856,16 @@ void Application::gatherSelectables()
         m_selectionManager.addSelectable(entry);
     }
 
-    const auto& lights = m_lightManager.lights();
-    for (std::size_t i = 0; i < lights.size(); ++i) {
-        const auto& light = lights[i];
-        if (!light.enabled)
+    for (std::size_t i = 0; i < m_lightManager.lightCount(); ++i) {
+        if (!m_lightManager.isEnabled(i))
             continue;
 
         SelectionManager::SelectableEntry entry;
         entry.id = { SelectionManager::Type::Light, i, 0 };
-        entry.name = light.name.empty() ? "Light " + std::to_string(i) : light.name;
+        const std::string& lightName = m_lightManager.name(i);
+        entry.name = lightName.empty() ? "Light " + std::to_string(i) : lightName;
         entry.shape = SelectionManager::Shape::Sphere;
-        entry.center = light.position;
+        entry.center = m_lightManager.position(i);
         entry.radius = 0.15f;
         entry.bounds.min = entry.center - glm::vec3(entry.radius);
         entry.bounds.max = entry.center + glm::vec3(entry.radius);
@@ -2593,11 +2919,10 @@ void Application::applySelectionDelta(const glm::vec3& delta)
         break;
     }
     case SelectionManager::Type::Light: {
-        auto& lights = m_lightManager.lights();
-        if (selection->id.primary >= lights.size())
+        const std::size_t index = selection->id.primary;
+        if (index >= m_lightManager.lightCount())
             break;
-        lights[selection->id.primary].position += delta;
-        m_lightManager.markDirty();
+        m_lightManager.setPosition(index, m_lightManager.position(index) + delta);
         break;
     }
     }
@@ -2705,12 +3030,28 @@ void Application::loadSceneFromPath(const std::filesystem::path& path)
     }
 
     const std::filesystem::path absolutePath = std::filesystem::absolute(path);
-    if (!std::filesystem::exists(absolutePath)) {
+    if (!fileExists(absolutePath)) {
         m_modelLoadMessage = "File not found: " + absolutePath.string();
         m_lastModelLoadSuccess = false;
         return;
     }
 
+    // Let the disk fetch the external buffers and textures of a .gltf while Assimp parses the JSON.
+    std::vector<std::filesystem::path> visible { absolutePath };
+    std::vector<std::filesystem::path> images;
+    if (absolutePath.extension() == ".gltf") {
+        for (const std::filesystem::path& sibling : listFiles(absolutePath.parent_path())) {
+            std::string extension = sibling.extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (extension == ".bin")
+                visible.push_back(sibling);
+            else if (extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".ktx2")
+                images.push_back(sibling);
+        }
+    }
+    prefetchFiles(visible, ReadPriority::Visible);
+    prefetchFiles(images, ReadPriority::Prefetch);
+
     if (!m_modelLoader.loadModel(absolutePath.string())) {
         const std::string& error = m_modelLoader.getLastError();
         m_modelLoadMessage = error.empty() ? "Assimp failed to load the model." : error;
@@ -2724,6 +3065,8 @@ void Application::loadSceneFromPath(const std::filesystem::path& path)
         return;
     }
 
+    m_assetDatabase.recordArtifact(sceneArtifactKey(absolutePath), m_modelLoader.getSourceFiles());
+
     m_lastModelPath = absolutePath;
     setModelPathBuffer(absolutePath);
     m_modelLoadMessage = "Loaded " + absolutePath.filename().string();
@@ -2745,12 +3088,26 @@ void Application::loadEnvironmentFromPath(const std::filesystem::path& path)
     }
 
     const std::filesystem::path absolutePath = std::filesystem::absolute(path);
-    if (!std::filesystem::exists(absolutePath)) {
+    if (!fileExists(absolutePath)) {
         m_environmentLoadMessage = "File not found: " + absolutePath.string();
         m_environmentLoadSuccess = false;
         return;
     }
 
+    // The HDR is read in the background; the IBL bake starts once it is in memory.
+    prefetchFiles({ absolutePath }, ReadPriority::Visible);
+    m_pendingEnvironmentPath = absolutePath;
+    m_environmentLoadMessage = "Loading " + absolutePath.filename().string() + "...";
+    m_environmentLoadSuccess = true;
+}
+
+void Application::finishPendingEnvironmentLoad()
+{
+    if (!m_pendingEnvironmentPath || !m_fileSystem.isPrefetchReady(*m_pendingEnvironmentPath))
+        return;
+    const std::filesystem::path absolutePath = std::move(*m_pendingEnvironmentPath);
+    m_pendingEnvironmentPath.reset();
+
     try {
         if (m_environmentManager.loadEnvironment(absolutePath)) {
             setEnvironmentPathBuffer(absolutePath);
@@ -2774,12 +3131,42 @@ void Application::setEnvironmentPathBuffer(const std::filesystem::path& path)
 
 int main(int argc, char** argv)
 {
+    std::vector<std::string> positional;
+    InputRecorder::LaunchOptions launchOptions = InputRecorder::parseCommandLine(argc, argv, positional);
+
+    // --pack <file> mounts an asset archive (repeatable); otherwise a daedalus.dpak produced by the
+    // packing post-build step is picked up from the working directory.
+    // --log-level <spec> (e.g. "info,opengl=warning") and --log-file <path> configure logging.
+    // --pipeline-stats [frames] logs per-pass pipeline statistics every `frames` frames (default 60).
+    std::vector<std::filesystem::path> assetPacks;
     std::optional<std::filesystem::path> initialScene;
-    if (argc > 1)
-        initialScene = std::filesystem::path(argv[1]);
-
-    Application app(initialScene);
-    app.update();
+    int pipelineStatsInterval = 0;
+    for (std::size_t i = 0; i < positional.size(); ++i) {
+        if (positional[i] == "--pack" && i + 1 < positional.size())
+            assetPacks.emplace_back(positional[++i]);
+        else if (positional[i] == "--log-level" && i + 1 < positional.size()) {
+            if (!logging::configure(positional[++i]))
+                LOG_WARNING(logging::Category::General, "Ignoring unknown parts of --log-level \"{}\"", positional[i]);
+        } else if (positional[i] == "--log-file" && i + 1 < positional.size())
+            logging::addFileSink(positional[++i]);
+        else if (positional[i] == "--pipeline-stats") {
+            pipelineStatsInterval = 60;
+            if (i + 1 < positional.size() && !positional[i + 1].empty() && std::all_of(positional[i + 1].begin(), positional[i + 1].end(), [](char c) { return c >= '0' && c <= '9'; }))
+                pipelineStatsInterval = std::max(std::stoi(positional[++i]), 1);
+        } else if (!initialScene)
+            initialScene = std::filesystem::path(positional[i]);
+    }
+    if (assetPacks.empty() && std::filesystem::is_regular_file("daedalus.dpak"))
+        assetPacks.emplace_back("daedalus.dpak");
+
+    {
+        Application app(initialScene, std::move(launchOptions), std::move(assetPacks));
+        if (pipelineStatsInterval > 0)
+            app.enablePipelineStatisticsLogging(pipelineStatsInterval);
+        app.update();
+    }
+    // After the application has released everything, so its shutdown messages are written too.
+    logging::shutdown();
 
     return 0;
 }
\ No newline at end of file
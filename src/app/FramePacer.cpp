@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: MIT
+#include "app/FramePacer.h"
+
+#include <framework/disable_all_warnings.h>
+#include <framework/log.h>
+DISABLE_WARNINGS_PUSH()
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+#include <framework/window.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+constexpr GLuint64 kFenceTimeoutNs = 100'000'000; // 100 ms per wait, so a slow GPU frame is reported while it runs.
+
+[[nodiscard]] float millisecondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration<float, std::milli>(to - from).count();
+}
+
+[[nodiscard]] int swapIntervalFor(FramePacer::VsyncMode mode)
+{
+    switch (mode) {
+    case FramePacer::VsyncMode::Off: return 0;
+    case FramePacer::VsyncMode::On: return 1;
+    case FramePacer::VsyncMode::Adaptive: return -1;
+    }
+    return 1;
+}
+
+} // namespace
+
+FramePacer::FramePacer(Window& window)
+    : m_window(window)
+{
+    m_adaptiveSupported = m_window.supportsAdaptiveVsync();
+    m_latencyHistory.reserve(kLatencyHistorySize);
+    applyVsync();
+}
+
+FramePacer::~FramePacer()
+{
+    for (const InFlightFrame& frame : m_inFlight) {
+        glDeleteSync(frame.fence);
+        m_freeTimestampQueries.push_back(frame.timestampQuery);
+    }
+    m_inFlight.clear();
+    if (!m_freeTimestampQueries.empty())
+        glDeleteQueries(static_cast<GLsizei>(m_freeTimestampQueries.size()), m_freeTimestampQueries.data());
+}
+
+GLuint FramePacer::acquireTimestampQuery()
+{
+    if (m_freeTimestampQueries.empty()) {
+        GLuint query = 0;
+        glCreateQueries(GL_TIMESTAMP, 1, &query);
+        return query;
+    }
+    const GLuint query = m_freeTimestampQueries.back();
+    m_freeTimestampQueries.pop_back();
+    return query;
+}
+
+void FramePacer::setSettings(const Settings& settings)
+{
+    const VsyncMode previousVsync = m_settings.vsync;
+    m_settings = settings;
+    m_settings.maxFramesInFlight = std::clamp(m_settings.maxFramesInFlight, 1, kMaxFramesInFlightLimit);
+    m_settings.frameRateCap = std::clamp(m_settings.frameRateCap, 10.0f, 1000.0f);
+    m_settings.spinThresholdMs = std::clamp(m_settings.spinThresholdMs, 0.0f, 5.0f);
+    if (m_settings.vsync == VsyncMode::Adaptive && !m_adaptiveSupported)
+        m_settings.vsync = VsyncMode::On;
+    if (previousVsync != m_settings.vsync)
+        applyVsync();
+}
+
+void FramePacer::applyVsync()
+{
+    if (m_settings.vsync == VsyncMode::Adaptive && !m_adaptiveSupported)
+        m_settings.vsync = VsyncMode::On;
+    m_window.setSwapInterval(swapIntervalFor(m_settings.vsync));
+}
+
+void FramePacer::beginFrame()
+{
+    const Clock::time_point waitStart = Clock::now();
+    waitForFrameCap();
+    const Clock::time_point capDone = Clock::now();
+
+    retireCompletedFrames();
+    while (static_cast<int>(m_inFlight.size()) >= m_settings.maxFramesInFlight)
+        waitForOldestFrame();
+    const Clock::time_point gpuDone = Clock::now();
+
+    m_stats.capWaitMs = millisecondsBetween(waitStart, capDone);
+    m_stats.gpuWaitMs = millisecondsBetween(capDone, gpuDone);
+    m_stats.framesInFlight = static_cast<int>(m_inFlight.size());
+
+    m_frameStart = gpuDone;
+    m_inputSampled = gpuDone;
+    m_hasFrameStart = true;
+}
+
+void FramePacer::markInputSampled()
+{
+    m_inputSampled = Clock::now();
+}
+
+void FramePacer::endFrame()
+{
+    InFlightFrame frame;
+    frame.frameIndex = m_frameIndex++;
+    frame.inputSampled = m_inputSampled;
+    frame.submitted = Clock::now();
+    glGetInteger64v(GL_TIMESTAMP, &frame.gpuSubmittedNs);
+    frame.timestampQuery = acquireTimestampQuery();
+    glQueryCounter(frame.timestampQuery, GL_TIMESTAMP);
+    frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (frame.fence == nullptr) {
+        m_freeTimestampQueries.push_back(frame.timestampQuery);
+        return;
+    }
+
+    // Flush so the fence is guaranteed to reach the GPU even if nobody waits on it with the flush bit.
+    glFlush();
+    m_inFlight.push_back(frame);
+}
+
+void FramePacer::waitForFrameCap()
+{
+    if (!m_settings.frameRateCapEnabled || !m_hasFrameStart)
+        return;
+
+    const auto targetDuration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / static_cast<double>(m_settings.frameRateCap)));
+    const Clock::time_point target = m_frameStart + targetDuration;
+    const auto spinWindow = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(m_settings.spinThresholdMs));
+
+    Clock::time_point now = Clock::now();
+    if (now + spinWindow < target)
+        std::this_thread::sleep_until(target - spinWindow);
+
+    now = Clock::now();
+    while (now < target) {
+        std::this_thread::yield();
+        now = Clock::now();
+    }
+}
+
+void FramePacer::retireCompletedFrames()
+{
+    while (!m_inFlight.empty()) {
+        const InFlightFrame& oldest = m_inFlight.front();
+        const GLenum result = glClientWaitSync(oldest.fence, 0, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+            break;
+        retireFrame(oldest, Clock::now());
+        m_inFlight.pop_front();
+    }
+}
+
+void FramePacer::waitForOldestFrame()
+{
+    if (m_inFlight.empty())
+        return;
+
+    // The frame stays in flight until its fence signals; retiring it early would let the CPU run
+    // further ahead than maxFramesInFlight.
+    const InFlightFrame oldest = m_inFlight.front();
+    GLenum result = glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeoutNs);
+    while (result == GL_TIMEOUT_EXPIRED) {
+        LOG_WARNING(logging::Category::OpenGL, "[FramePacer] Frame {} still running on the GPU after {} ms",
+            oldest.frameIndex, kFenceTimeoutNs / 1'000'000);
+        result = glClientWaitSync(oldest.fence, 0, kFenceTimeoutNs);
+    }
+    m_inFlight.pop_front();
+
+    if (result == GL_WAIT_FAILED) {
+        // The fence is unusable, so waiting again would never end; drop the frame without a sample.
+        LOG_ERROR(logging::Category::OpenGL, "[FramePacer] glClientWaitSync failed for frame {} (GL error {:#x})",
+            oldest.frameIndex, glGetError());
+        glDeleteSync(oldest.fence);
+        m_freeTimestampQueries.push_back(oldest.timestampQuery);
+        return;
+    }
+    retireFrame(oldest, Clock::now());
+}
+
+void FramePacer::retireFrame(const InFlightFrame& frame, Clock::time_point fenceNoticed)
+{
+    glDeleteSync(frame.fence);
+
+    LatencySample sample;
+    sample.frameIndex = frame.frameIndex;
+    sample.inputToSubmitMs = millisecondsBetween(frame.inputSampled, frame.submitted);
+
+    // The fence has signalled, so the timestamp behind it is normally available. If the driver has
+    // not published it yet, fall back to the (CPU frame quantised) time the fence was noticed.
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(frame.timestampQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_TRUE) {
+        GLuint64 gpuCompletedNs = 0;
+        glGetQueryObjectui64v(frame.timestampQuery, GL_QUERY_RESULT, &gpuCompletedNs);
+        const double deltaNs = static_cast<double>(gpuCompletedNs) - static_cast<double>(frame.gpuSubmittedNs);
+        sample.submitToGpuMs = static_cast<float>(std::max(deltaNs, 0.0) * 1e-6);
+    } else {
+        sample.submitToGpuMs = millisecondsBetween(frame.submitted, fenceNoticed);
+    }
+    m_freeTimestampQueries.push_back(frame.timestampQuery);
+
+    sample.inputToGpuMs = sample.inputToSubmitMs + sample.submitToGpuMs;
+    m_stats.lastLatency = sample;
+
+    if (m_latencyHistory.size() >= kLatencyHistorySize)
+        m_latencyHistory.erase(m_latencyHistory.begin());
+    m_latencyHistory.push_back(sample.inputToGpuMs);
+
+    float total = 0.0f;
+    float maxValue = 0.0f;
+    for (float value : m_latencyHistory) {
+        total += value;
+        maxValue = std::max(maxValue, value);
+    }
+    m_stats.avgInputToGpuMs = total / static_cast<float>(m_latencyHistory.size());
+    m_stats.maxInputToGpuMs = maxValue;
+}
+
+void FramePacer::drawImGuiPanel()
+{
+    Settings settings = m_settings;
+    bool dirty = false;
+
+    int vsyncIndex = static_cast<int>(settings.vsync);
+    const char* vsyncLabels = m_adaptiveSupported ? "Off\0On\0Adaptive\0" : "Off\0On\0";
+    if (ImGui::Combo("VSync", &vsyncIndex, vsyncLabels)) {
+        settings.vsync = static_cast<VsyncMode>(vsyncIndex);
+        dirty = true;
+    }
+    if (!m_adaptiveSupported)
+        ImGui::TextDisabled("Adaptive vsync not supported by this driver.");
+
+    dirty |= ImGui::SliderInt("Max Frames In Flight", &settings.maxFramesInFlight, 1, kMaxFramesInFlightLimit);
+    dirty |= ImGui::Checkbox("Frame Rate Cap", &settings.frameRateCapEnabled);
+    if (settings.frameRateCapEnabled) {
+        dirty |= ImGui::SliderFloat("Target FPS", &settings.frameRateCap, 10.0f, 360.0f, "%.0f");
+        dirty |= ImGui::SliderFloat("Spin Threshold (ms)", &settings.spinThresholdMs, 0.0f, 5.0f, "%.2f");
+    }
+
+    if (dirty)
+        setSettings(settings);
+
+    const Stats& stats = m_stats;
+    ImGui::Text("Frames in flight: %d / %d", stats.framesInFlight, m_settings.maxFramesInFlight);
+    ImGui::Text("Cap wait: %.2f ms | GPU wait: %.2f ms", static_cast<double>(stats.capWaitMs), static_cast<double>(stats.gpuWaitMs));
+    ImGui::Text("Latency (frame %llu): input->submit %.2f ms, submit->GPU %.2f ms",
+        static_cast<unsigned long long>(stats.lastLatency.frameIndex),
+        static_cast<double>(stats.lastLatency.inputToSubmitMs),
+        static_cast<double>(stats.lastLatency.submitToGpuMs));
+    ImGui::Text("Input->GPU complete: %.2f ms (avg %.2f, max %.2f)",
+        static_cast<double>(stats.lastLatency.inputToGpuMs),
+        static_cast<double>(stats.avgInputToGpuMs),
+        static_cast<double>(stats.maxInputToGpuMs));
+
+    if (!m_latencyHistory.empty()) {
+        const float upper = std::max(stats.maxInputToGpuMs, 1.0f) * 1.2f;
+        ImGui::PlotLines("Input->GPU History (ms)",
+            m_latencyHistory.data(),
+            static_cast<int>(m_latencyHistory.size()),
+            0,
+            nullptr,
+            0.0f,
+            upper,
+            ImVec2(ImGui::GetContentRegionAvail().x, 80.0f));
+    }
+}
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <framework/opengl_includes.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+class Window;
+
+// Limits how far the CPU may run ahead of the GPU (fence based), optionally caps the frame rate
+// and records per-frame latency markers: input sampled -> submitted -> GPU complete. GPU completion
+// is a GL_TIMESTAMP query written behind the frame's commands, so it is exact rather than the time
+// the CPU happened to notice the fence.
+class FramePacer {
+public:
+    enum class VsyncMode {
+        Off,
+        On,
+        Adaptive
+    };
+
+    struct Settings {
+        int maxFramesInFlight { 2 };
+        bool frameRateCapEnabled { false };
+        float frameRateCap { 120.0f };
+        // The last part of a capped wait is spun instead of slept; OS sleeps overshoot by ~1 ms.
+        float spinThresholdMs { 1.5f };
+        VsyncMode vsync { VsyncMode::On };
+    };
+
+    struct LatencySample {
+        std::uint64_t frameIndex { 0 };
+        float inputToSubmitMs { 0.0f };
+        float submitToGpuMs { 0.0f };
+        float inputToGpuMs { 0.0f };
+    };
+
+    struct Stats {
+        float gpuWaitMs { 0.0f };
+        float capWaitMs { 0.0f };
+        int framesInFlight { 0 };
+        LatencySample lastLatency {};
+        float avgInputToGpuMs { 0.0f };
+        float maxInputToGpuMs { 0.0f };
+    };
+
+    static constexpr int kMaxFramesInFlightLimit = 4;
+
+    explicit FramePacer(Window& window);
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // Call at the top of the frame, before input is polled. Blocks for the frame cap and for the
+    // oldest in-flight frame when the render-ahead limit is reached.
+    void beginFrame();
+    void markInputSampled();
+    // Call right after the buffer swap; inserts the timestamp query and fence that mark GPU
+    // completion of this frame.
+    void endFrame();
+
+    void setSettings(const Settings& settings);
+    [[nodiscard]] const Settings& settings() const { return m_settings; }
+    [[nodiscard]] const Stats& stats() const { return m_stats; }
+    [[nodiscard]] bool adaptiveVsyncSupported() const { return m_adaptiveSupported; }
+
+    void drawImGuiPanel();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct InFlightFrame {
+        GLsync fence { nullptr };
+        GLuint timestampQuery { 0 };
+        // GL clock at submission, so the query result can be turned into a submit -> GPU delta.
+        GLint64 gpuSubmittedNs { 0 };
+        std::uint64_t frameIndex { 0 };
+        Clock::time_point inputSampled {};
+        Clock::time_point submitted {};
+    };
+
+    void applyVsync();
+    void waitForFrameCap();
+    void retireCompletedFrames();
+    void waitForOldestFrame();
+    void retireFrame(const InFlightFrame& frame, Clock::time_point fenceNoticed);
+    [[nodiscard]] GLuint acquireTimestampQuery();
+
+    static constexpr std::size_t kLatencyHistorySize = 240;
+
+    Window& m_window;
+    Settings m_settings;
+    Stats m_stats;
+    bool m_adaptiveSupported { false };
+
+    std::deque<InFlightFrame> m_inFlight;
+    std::vector<GLuint> m_freeTimestampQueries;
+    std::uint64_t m_frameIndex { 0 };
+    Clock::time_point m_frameStart {};
+    Clock::time_point m_inputSampled {};
+    bool m_hasFrameStart { false }; // the first frame has nothing to cap against
+
+    std::vector<float> m_latencyHistory;
+};
@@ -0,0 +1,643 @@
+// SPDX-License-Identifier: MIT
+#include "app/InputRecorder.h"
+
+#include <framework/disable_all_warnings.h>
+#include <framework/log.h>
+DISABLE_WARNINGS_PUSH()
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <string_view>
+#include <type_traits>
+
+// Log layout (native byte order):
+//   header: "DINP", u32 version, u32 frame count, u32 session seed, i32 window w/h, i32 camera mode,
+//           f32 camera position[3], yaw, pitch, f32 player position[3], u32+bytes scene, u32+bytes imgui.ini
+//   frame:  f32 dt, f32 cursor[2], u8 mouse buttons, u8+u16[] keys down, u16+events,
+//           f32 imgui mouse[2], u8 imgui mouse down, f32 wheel, f32 wheel h, u8 modifiers,
+//           u8+u16[] imgui keys down, u16+u32[] imgui characters
+namespace {
+
+constexpr char kMagic[4] = { 'D', 'I', 'N', 'P' };
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kFrameCountOffset = 8;
+constexpr int kImGuiMouseButtons = 5;
+constexpr int kImGuiKeys = 512;
+
+template <typename T>
+void put(std::vector<char>& out, T value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void putString(std::vector<char>& out, std::string_view text)
+{
+    put(out, static_cast<std::uint32_t>(text.size()));
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+template <typename T>
+[[nodiscard]] bool get(const std::vector<char>& in, std::size_t& offset, T& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (offset + sizeof(T) > in.size())
+        return false;
+    std::memcpy(&value, in.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+[[nodiscard]] bool getString(const std::vector<char>& in, std::size_t& offset, std::string& text)
+{
+    std::uint32_t length = 0;
+    if (!get(in, offset, length) || offset + length > in.size())
+        return false;
+    text.assign(in.data() + offset, length);
+    offset += length;
+    return true;
+}
+
+void putKeyList(std::vector<char>& out, const std::vector<std::uint16_t>& keys)
+{
+    const std::size_t count = std::min<std::size_t>(keys.size(), 255);
+    put(out, static_cast<std::uint8_t>(count));
+    for (std::size_t i = 0; i < count; ++i)
+        put(out, keys[i]);
+}
+
+[[nodiscard]] bool getKeyList(const std::vector<char>& in, std::size_t& offset, std::vector<std::uint16_t>& keys)
+{
+    std::uint8_t count = 0;
+    if (!get(in, offset, count))
+        return false;
+    keys.resize(count);
+    for (std::uint16_t& key : keys) {
+        if (!get(in, offset, key))
+            return false;
+    }
+    return true;
+}
+
+void putEvent(std::vector<char>& out, const Window::InputEvent& event)
+{
+    using Type = Window::InputEvent::Type;
+    put(out, static_cast<std::uint8_t>(event.type));
+    switch (event.type) {
+    case Type::Key:
+        put(out, static_cast<std::int16_t>(event.code));
+        put(out, static_cast<std::int16_t>(event.scancode));
+        put(out, static_cast<std::uint8_t>(event.action));
+        put(out, static_cast<std::uint8_t>(event.mods));
+        break;
+    case Type::Char:
+        put(out, static_cast<std::uint32_t>(event.code));
+        break;
+    case Type::MouseButton:
+        put(out, static_cast<std::uint8_t>(event.code));
+        put(out, static_cast<std::uint8_t>(event.action));
+        put(out, static_cast<std::uint8_t>(event.mods));
+        break;
+    case Type::MouseMove:
+    case Type::Scroll:
+        put(out, event.value.x);
+        put(out, event.value.y);
+        break;
+    }
+}
+
+[[nodiscard]] bool getEvent(const std::vector<char>& in, std::size_t& offset, Window::InputEvent& event)
+{
+    using Type = Window::InputEvent::Type;
+    std::uint8_t type = 0;
+    if (!get(in, offset, type) || type > static_cast<std::uint8_t>(Type::Scroll))
+        return false;
+    event = Window::InputEvent {};
+    event.type = static_cast<Type>(type);
+    switch (event.type) {
+    case Type::Key: {
+        std::int16_t key = 0, scancode = 0;
+        std::uint8_t action = 0, mods = 0;
+        if (!get(in, offset, key) || !get(in, offset, scancode) || !get(in, offset, action) || !get(in, offset, mods))
+            return false;
+        event.code = key;
+        event.scancode = scancode;
+        event.action = action;
+        event.mods = mods;
+        return true;
+    }
+    case Type::Char: {
+        std::uint32_t codePoint = 0;
+        if (!get(in, offset, codePoint))
+            return false;
+        event.code = static_cast<int>(codePoint);
+        return true;
+    }
+    case Type::MouseButton: {
+        std::uint8_t button = 0, action = 0, mods = 0;
+        if (!get(in, offset, button) || !get(in, offset, action) || !get(in, offset, mods))
+            return false;
+        event.code = button;
+        event.action = action;
+        event.mods = mods;
+        return true;
+    }
+    case Type::MouseMove:
+    case Type::Scroll:
+        return get(in, offset, event.value.x) && get(in, offset, event.value.y);
+    }
+    return false;
+}
+
+[[nodiscard]] float percentile(const std::vector<float>& sorted, float fraction)
+{
+    if (sorted.empty())
+        return 0.0f;
+    const auto index = static_cast<std::size_t>(fraction * static_cast<float>(sorted.size() - 1) + 0.5f);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+} // namespace
+
+InputRecorder::InputRecorder(Window& window)
+    : m_window(window)
+{
+    m_window.setInputHook([this]() { onInputHook(); });
+}
+
+InputRecorder::~InputRecorder()
+{
+    if (m_mode == Mode::Recording)
+        stopRecording();
+    detachWindow();
+    m_window.setInputHook({});
+}
+
+InputRecorder::LaunchOptions InputRecorder::parseCommandLine(int argc, char** argv, std::vector<std::string>& positional)
+{
+    LaunchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--record" && hasValue) {
+            options.recordPath = std::filesystem::path(argv[++i]);
+        } else if (arg == "--replay" && hasValue) {
+            options.replayPath = std::filesystem::path(argv[++i]);
+        } else if (arg == "--replay-fixed-dt" && hasValue) {
+            const float dt = std::strtof(argv[++i], nullptr);
+            if (dt > 0.0f) {
+                options.replay.timestep = Timestep::Fixed;
+                options.replay.fixedDeltaTime = dt;
+            }
+        } else if (arg == "--benchmark") {
+            options.benchmark = true;
+            options.replay.exitWhenFinished = true;
+        } else if (arg == "--benchmark-report" && hasValue) {
+            options.replay.reportPath = std::filesystem::path(argv[++i]);
+        } else {
+            positional.emplace_back(arg);
+        }
+    }
+    if (options.recordPath && options.replayPath) {
+        LOG_WARNING(logging::Category::General, "[InputRecorder] --record and --replay are exclusive, ignoring --record");
+        options.recordPath.reset();
+    }
+    return options;
+}
+
+void InputRecorder::setSessionHooks(CaptureSessionFn capture, RestoreSessionFn restore)
+{
+    m_captureSession = std::move(capture);
+    m_restoreSession = std::move(restore);
+}
+
+std::uint32_t InputRecorder::frameSeed(std::uint32_t sessionSeed, std::uint32_t frameIndex)
+{
+    // Reseeding every frame keeps frames independent: a frame that draws a different number of random
+    // values (e.g. after a code change) does not shift the streams of all later frames.
+    std::uint32_t h = sessionSeed ^ (frameIndex * 0x9e3779b9U);
+    h ^= h >> 16;
+    h *= 0x7feb352dU;
+    h ^= h >> 15;
+    h *= 0x846ca68bU;
+    h ^= h >> 16;
+    return h;
+}
+
+bool InputRecorder::startRecording(const std::filesystem::path& path)
+{
+    if (m_mode == Mode::Replaying)
+        stopReplay();
+    if (m_mode == Mode::Recording)
+        stopRecording();
+
+    m_out.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_out) {
+        m_statusMessage = "Cannot open " + path.string() + " for writing";
+        LOG_ERROR(logging::Category::General, "[InputRecorder] {}", m_statusMessage);
+        return false;
+    }
+
+    m_sessionSeed = std::random_device {}();
+    const SessionState session = m_captureSession ? m_captureSession() : SessionState {};
+    std::size_t iniSize = 0;
+    const char* ini = ImGui::GetCurrentContext() ? ImGui::SaveIniSettingsToMemory(&iniSize) : nullptr;
+
+    std::vector<char> header;
+    header.insert(header.end(), std::begin(kMagic), std::end(kMagic));
+    put(header, kVersion);
+    put(header, std::uint32_t { 0 }); // frame count, patched by stopRecording()
+    put(header, m_sessionSeed);
+    put(header, static_cast<std::int32_t>(session.windowSize.x));
+    put(header, static_cast<std::int32_t>(session.windowSize.y));
+    put(header, static_cast<std::int32_t>(session.cameraMode));
+    for (int i = 0; i < 3; ++i)
+        put(header, session.cameraPosition[i]);
+    put(header, session.cameraYaw);
+    put(header, session.cameraPitch);
+    for (int i = 0; i < 3; ++i)
+        put(header, session.playerPosition[i]);
+    putString(header, session.scene);
+    putString(header, ini ? std::string_view(ini, iniSize) : std::string_view {});
+    m_out.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+    m_recordPath = path;
+    m_bytesWritten = header.size();
+    m_frameIndex = 0;
+    m_recordFrame = Frame {};
+    m_window.setInputEventObserver([this](const Window::InputEvent& event) { m_recordFrame.events.push_back(event); });
+    m_mode = Mode::Recording;
+    m_statusMessage = "Recording to " + path.string();
+    LOG_INFO(logging::Category::General, "[InputRecorder] Recording to {} (seed {})", path.string(), m_sessionSeed);
+    return true;
+}
+
+void InputRecorder::stopRecording()
+{
+    if (m_mode != Mode::Recording)
+        return;
+
+    m_window.setInputEventObserver({});
+    // A log whose count was never patched (crash while recording) replays until its data runs out.
+    m_out.seekp(static_cast<std::streamoff>(kFrameCountOffset));
+    m_out.write(reinterpret_cast<const char*>(&m_frameIndex), sizeof(m_frameIndex));
+    m_out.close();
+    m_mode = Mode::Idle;
+
+    char message[256];
+    std::snprintf(message, sizeof(message), "Recorded %u frames (%.1f KiB)", m_frameIndex, static_cast<double>(m_bytesWritten) / 1024.0);
+    m_statusMessage = message;
+    LOG_INFO(logging::Category::General, "[InputRecorder] {} to {}", m_statusMessage, m_recordPath.string());
+}
+
+bool InputRecorder::startReplay(const std::filesystem::path& path, const ReplaySettings& settings)
+{
+    if (m_mode == Mode::Recording)
+        stopRecording();
+    if (m_mode == Mode::Replaying)
+        stopReplay();
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        m_statusMessage = "Cannot open " + path.string();
+        LOG_ERROR(logging::Category::General, "[InputRecorder] {}", m_statusMessage);
+        return false;
+    }
+    m_log.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    std::size_t offset = 0;
+    char magic[4] {};
+    std::uint32_t version = 0;
+    SessionState session;
+    std::int32_t windowW = 0, windowH = 0, cameraMode = 0;
+    std::string ini;
+    bool valid = m_log.size() >= sizeof(kMagic);
+    if (valid) {
+        std::memcpy(magic, m_log.data(), sizeof(magic));
+        offset = sizeof(magic);
+        valid = std::equal(std::begin(magic), std::end(magic), std::begin(kMagic))
+            && get(m_log, offset, version) && version == kVersion
+            && get(m_log, offset, m_frameCount) && get(m_log, offset, m_sessionSeed)
+            && get(m_log, offset, windowW) && get(m_log, offset, windowH) && get(m_log, offset, cameraMode);
+    }
+    for (int i = 0; valid && i < 3; ++i)
+        valid = get(m_log, offset, session.cameraPosition[i]);
+    valid = valid && get(m_log, offset, session.cameraYaw) && get(m_log, offset, session.cameraPitch);
+    for (int i = 0; valid && i < 3; ++i)
+        valid = get(m_log, offset, session.playerPosition[i]);
+    valid = valid && getString(m_log, offset, session.scene) && getString(m_log, offset, ini);
+    if (!valid) {
+        m_log.clear();
+        m_statusMessage = path.string() + " is not a valid input log";
+        LOG_ERROR(logging::Category::General, "[InputRecorder] {}", m_statusMessage);
+        return false;
+    }
+    session.windowSize = glm::ivec2(windowW, windowH);
+    session.cameraMode = cameraMode;
+
+    if (m_captureSession) {
+        const SessionState current = m_captureSession();
+        if (current.windowSize != session.windowSize)
+            LOG_WARNING(logging::Category::General, "[InputRecorder] Window size differs from the recording ({}x{}), cursor-driven input may diverge",
+                session.windowSize.x, session.windowSize.y);
+        if (current.scene != session.scene)
+            LOG_WARNING(logging::Category::General, "[InputRecorder] Recording was made with scene '{}'", session.scene);
+    }
+    if (!ini.empty() && ImGui::GetCurrentContext())
+        ImGui::LoadIniSettingsFromMemory(ini.data(), ini.size());
+    if (m_restoreSession)
+        m_restoreSession(session);
+
+    m_readOffset = offset;
+    m_replaySettings = settings;
+    m_replayFrame = Frame {};
+    m_frameIndex = 0;
+    m_frameTimesMs.clear();
+    m_frameTimesMs.reserve(m_frameCount);
+    m_mode = Mode::Replaying;
+    m_statusMessage = "Replaying " + path.string();
+    LOG_INFO(logging::Category::General, "[InputRecorder] Replaying {} frames from {}", m_frameCount, path.string());
+    return true;
+}
+
+void InputRecorder::stopReplay()
+{
+    if (m_mode != Mode::Replaying)
+        return;
+    finishReplay();
+}
+
+void InputRecorder::detachWindow()
+{
+    m_window.setInputOverride(nullptr);
+    m_window.setInputEventObserver({});
+}
+
+float InputRecorder::beginFrame(float measuredDeltaTime)
+{
+    m_frameDeltaTime = measuredDeltaTime;
+    switch (m_mode) {
+    case Mode::Idle:
+        break;
+    case Mode::Recording:
+        m_recordFrame.deltaTime = measuredDeltaTime;
+        std::srand(frameSeed(m_sessionSeed, m_frameIndex));
+        break;
+    case Mode::Replaying:
+        // The first measured delta covers the frame before the replay started.
+        if (m_frameIndex > 0)
+            m_frameTimesMs.push_back(measuredDeltaTime * 1000.0f);
+        if ((m_frameCount > 0 && m_frameIndex >= m_frameCount) || !readFrame(m_replayFrame)) {
+            finishReplay();
+            break;
+        }
+        m_window.setInputOverride(&m_replayFrame.polled);
+        std::srand(frameSeed(m_sessionSeed, m_frameIndex));
+        m_frameDeltaTime = m_replaySettings.timestep == Timestep::Fixed ? m_replaySettings.fixedDeltaTime : m_replayFrame.deltaTime;
+        break;
+    }
+    return m_frameDeltaTime;
+}
+
+void InputRecorder::onInputHook()
+{
+    if (m_mode == Mode::Recording)
+        captureFrame();
+    else if (m_mode == Mode::Replaying)
+        applyReplayFrame();
+
+    // ImGui timing (animations, double-click and CameraStage's double-tap detection) follows the
+    // simulated timestep so that recording and replay agree.
+    if (m_mode != Mode::Idle && m_frameDeltaTime > 0.0f && ImGui::GetCurrentContext())
+        ImGui::GetIO().DeltaTime = m_frameDeltaTime;
+}
+
+void InputRecorder::captureFrame()
+{
+    Frame& frame = m_recordFrame;
+    frame.polled = m_window.pollDevices();
+
+    if (ImGui::GetCurrentContext()) {
+        const ImGuiIO& io = ImGui::GetIO();
+        ImGuiInput& imgui = frame.imgui;
+        imgui.mousePos = glm::vec2(io.MousePos.x, io.MousePos.y);
+        imgui.mouseDown = 0;
+        for (int i = 0; i < kImGuiMouseButtons; ++i)
+            imgui.mouseDown |= io.MouseDown[i] ? static_cast<std::uint8_t>(1u << i) : 0u;
+        imgui.mouseWheel = io.MouseWheel;
+        imgui.mouseWheelH = io.MouseWheelH;
+        imgui.modifiers = static_cast<std::uint8_t>((io.KeyCtrl ? 1u : 0u) | (io.KeyShift ? 2u : 0u) | (io.KeyAlt ? 4u : 0u) | (io.KeySuper ? 8u : 0u));
+        imgui.keysDown.clear();
+        for (int key = 0; key < kImGuiKeys; ++key) {
+            if (io.KeysDown[key])
+                imgui.keysDown.push_back(static_cast<std::uint16_t>(key));
+        }
+        imgui.characters.assign(io.InputQueueCharacters.begin(), io.InputQueueCharacters.end());
+    }
+
+    writeFrame(frame);
+    frame.events.clear();
+    ++m_frameIndex;
+}
+
+void InputRecorder::writeFrame(const Frame& frame)
+{
+    std::vector<char>& out = m_frameBytes;
+    out.clear();
+    put(out, frame.deltaTime);
+    put(out, frame.polled.cursorPos.x);
+    put(out, frame.polled.cursorPos.y);
+    put(out, static_cast<std::uint8_t>(frame.polled.mouseButtons.to_ulong()));
+    std::vector<std::uint16_t> keys;
+    for (std::size_t key = 0; key < frame.polled.keys.size(); ++key) {
+        if (frame.polled.keys.test(key))
+            keys.push_back(static_cast<std::uint16_t>(key));
+    }
+    putKeyList(out, keys);
+
+    const std::size_t eventCount = std::min<std::size_t>(frame.events.size(), 0xffff);
+    put(out, static_cast<std::uint16_t>(eventCount));
+    for (std::size_t i = 0; i < eventCount; ++i)
+        putEvent(out, frame.events[i]);
+
+    const ImGuiInput& imgui = frame.imgui;
+    put(out, imgui.mousePos.x);
+    put(out, imgui.mousePos.y);
+    put(out, imgui.mouseDown);
+    put(out, imgui.mouseWheel);
+    put(out, imgui.mouseWheelH);
+    put(out, imgui.modifiers);
+    putKeyList(out, imgui.keysDown);
+    const std::size_t charCount = std::min<std::size_t>(imgui.characters.size(), 0xffff);
+    put(out, static_cast<std::uint16_t>(charCount));
+    for (std::size_t i = 0; i < charCount; ++i)
+        put(out, imgui.characters[i]);
+
+    m_out.write(out.data(), static_cast<std::streamsize>(out.size()));
+    m_bytesWritten += out.size();
+}
+
+bool InputRecorder::readFrame(Frame& frame)
+{
+    std::size_t& offset = m_readOffset;
+    std::uint8_t mouseButtons = 0;
+    std::vector<std::uint16_t> keys;
+    if (!get(m_log, offset, frame.deltaTime) || !get(m_log, offset, frame.polled.cursorPos.x) || !get(m_log, offset, frame.polled.cursorPos.y)
+        || !get(m_log, offset, mouseButtons) || !getKeyList(m_log, offset, keys))
+        return false;
+    frame.polled.mouseButtons = decltype(frame.polled.mouseButtons)(mouseButtons);
+    frame.polled.keys.reset();
+    for (std::uint16_t key : keys) {
+        if (key < frame.polled.keys.size())
+            frame.polled.keys.set(key);
+    }
+
+    std::uint16_t eventCount = 0;
+    if (!get(m_log, offset, eventCount))
+        return false;
+    frame.events.resize(eventCount);
+    for (Window::InputEvent& event : frame.events) {
+        if (!getEvent(m_log, offset, event))
+            return false;
+    }
+
+    ImGuiInput& imgui = frame.imgui;
+    std::uint16_t charCount = 0;
+    if (!get(m_log, offset, imgui.mousePos.x) || !get(m_log, offset, imgui.mousePos.y) || !get(m_log, offset, imgui.mouseDown)
+        || !get(m_log, offset, imgui.mouseWheel) || !get(m_log, offset, imgui.mouseWheelH) || !get(m_log, offset, imgui.modifiers)
+        || !getKeyList(m_log, offset, imgui.keysDown) || !get(m_log, offset, charCount))
+        return false;
+    imgui.characters.resize(charCount);
+    for (std::uint32_t& character : imgui.characters) {
+        if (!get(m_log, offset, character))
+            return false;
+    }
+    return true;
+}
+
+void InputRecorder::applyReplayFrame()
+{
+    if (ImGui::GetCurrentContext()) {
+        // The backend just filled ImGuiIO from the live devices; overwrite it with the recorded state.
+        ImGuiIO& io = ImGui::GetIO();
+        const ImGuiInput& imgui = m_replayFrame.imgui;
+        io.MousePos = ImVec2(imgui.mousePos.x, imgui.mousePos.y);
+        for (int i = 0; i < kImGuiMouseButtons; ++i)
+            io.MouseDown[i] = (imgui.mouseDown & (1u << i)) != 0;
+        io.MouseWheel = imgui.mouseWheel;
+        io.MouseWheelH = imgui.mouseWheelH;
+        io.KeyCtrl = (imgui.modifiers & 1u) != 0;
+        io.KeyShift = (imgui.modifiers & 2u) != 0;
+        io.KeyAlt = (imgui.modifiers & 4u) != 0;
+        io.KeySuper = (imgui.modifiers & 8u) != 0;
+        std::fill(std::begin(io.KeysDown), std::end(io.KeysDown), false);
+        for (std::uint16_t key : imgui.keysDown) {
+            if (key < kImGuiKeys)
+                io.KeysDown[key] = true;
+        }
+        io.InputQueueCharacters.resize(0);
+        for (std::uint32_t character : imgui.characters)
+            io.AddInputCharacter(character);
+    }
+
+    // Events go through the same ImGui capture filter as live ones, against the replayed ImGui state.
+    for (const Window::InputEvent& event : m_replayFrame.events)
+        m_window.dispatchInputEvent(event);
+    ++m_frameIndex;
+}
+
+void InputRecorder::finishReplay()
+{
+    detachWindow();
+    m_log.clear();
+    m_log.shrink_to_fit();
+    m_mode = Mode::Idle;
+
+    BenchmarkResult result;
+    result.frames = static_cast<std::uint32_t>(m_frameTimesMs.size());
+    if (!m_frameTimesMs.empty()) {
+        std::vector<float> sorted = m_frameTimesMs;
+        std::sort(sorted.begin(), sorted.end());
+        float totalMs = 0.0f;
+        for (float ms : sorted)
+            totalMs += ms;
+        result.totalSeconds = totalMs / 1000.0f;
+        result.avgMs = totalMs / static_cast<float>(sorted.size());
+        result.p50Ms = percentile(sorted, 0.50f);
+        result.p95Ms = percentile(sorted, 0.95f);
+        result.p99Ms = percentile(sorted, 0.99f);
+        result.maxMs = sorted.back();
+    }
+    m_lastBenchmark = result;
+
+    char message[256];
+    std::snprintf(message, sizeof(message), "Replay finished: %u frames in %.2f s, avg %.2f ms (%.1f FPS), p50 %.2f / p95 %.2f / p99 %.2f / max %.2f ms",
+        result.frames, static_cast<double>(result.totalSeconds), static_cast<double>(result.avgMs),
+        result.avgMs > 0.0f ? 1000.0 / static_cast<double>(result.avgMs) : 0.0,
+        static_cast<double>(result.p50Ms), static_cast<double>(result.p95Ms), static_cast<double>(result.p99Ms), static_cast<double>(result.maxMs));
+    m_statusMessage = message;
+    LOG_INFO(logging::Category::General, "[InputRecorder] {}", m_statusMessage);
+
+    if (!m_replaySettings.reportPath.empty()) {
+        std::ofstream report(m_replaySettings.reportPath, std::ios::trunc);
+        if (report) {
+            report << "frame,frame_ms\n";
+            for (std::size_t i = 0; i < m_frameTimesMs.size(); ++i)
+                report << i << ',' << m_frameTimesMs[i] << '\n';
+            LOG_INFO(logging::Category::General, "[InputRecorder] Wrote frame times to {}", m_replaySettings.reportPath.string());
+        } else {
+            LOG_ERROR(logging::Category::General, "[InputRecorder] Cannot write {}", m_replaySettings.reportPath.string());
+        }
+    }
+
+    if (m_replaySettings.exitWhenFinished)
+        m_exitRequested = true;
+}
+
+void InputRecorder::drawImGuiPanel()
+{
+    ImGui::InputText("Log File", m_pathBuffer.data(), m_pathBuffer.size());
+    const std::filesystem::path path(m_pathBuffer.data());
+
+    switch (m_mode) {
+    case Mode::Idle: {
+        if (ImGui::Button("Record"))
+            startRecording(path);
+        ImGui::SameLine();
+        if (ImGui::Button("Replay"))
+            startReplay(path, m_replaySettings);
+
+        bool fixed = m_replaySettings.timestep == Timestep::Fixed;
+        if (ImGui::Checkbox("Fixed Timestep", &fixed))
+            m_replaySettings.timestep = fixed ? Timestep::Fixed : Timestep::Recorded;
+        if (fixed) {
+            float hz = 1.0f / m_replaySettings.fixedDeltaTime;
+            if (ImGui::SliderFloat("Timestep (Hz)", &hz, 10.0f, 240.0f, "%.0f"))
+                m_replaySettings.fixedDeltaTime = 1.0f / hz;
+        }
+        ImGui::TextDisabled("Replays start from the recorded camera and player pose;");
+        ImGui::TextDisabled("record from launch (--record) for a fully reproducible session.");
+        break;
+    }
+    case Mode::Recording:
+        if (ImGui::Button("Stop Recording"))
+            stopRecording();
+        ImGui::Text("Frames: %u (%.1f KiB)", m_frameIndex, static_cast<double>(m_bytesWritten) / 1024.0);
+        break;
+    case Mode::Replaying:
+        // The replayed ImGui state drives this panel too, so the replay runs to the end (or the window is closed).
+        ImGui::ProgressBar(m_frameCount > 0 ? static_cast<float>(m_frameIndex) / static_cast<float>(m_frameCount) : 0.0f);
+        ImGui::Text("Frame %u / %u", m_frameIndex, m_frameCount);
+        break;
+    }
+
+    if (!m_statusMessage.empty())
+        ImGui::TextWrapped("%s", m_statusMessage.c_str());
+}
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+DISABLE_WARNINGS_POP()
+#include <framework/window.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Records everything that drives a session (polled keys/buttons/cursor, raw input events, the ImGui
+// input state, frame delta times and the per-frame RNG seed) into a compact binary log, and replays
+// such a log deterministically by standing in for the devices. Replays double as benchmarks: frame
+// times are collected while replaying and summarised (optionally as CSV) when the log ends.
+class InputRecorder {
+public:
+    enum class Mode {
+        Idle,
+        Recording,
+        Replaying
+    };
+
+    enum class Timestep {
+        Recorded, // simulate each frame with the delta time it had when recorded
+        Fixed // simulate every frame with ReplaySettings::fixedDeltaTime
+    };
+
+    struct ReplaySettings {
+        Timestep timestep { Timestep::Recorded };
+        float fixedDeltaTime { 1.0f / 60.0f };
+        bool exitWhenFinished { false };
+        std::filesystem::path reportPath; // frame-time CSV written when the replay ends (empty = none)
+    };
+
+    // Application state restored before a replay so that it starts where the recording started.
+    struct SessionState {
+        std::string scene;
+        glm::ivec2 windowSize { 0 };
+        int cameraMode { 0 };
+        glm::vec3 cameraPosition { 0.0f };
+        float cameraYaw { 0.0f };
+        float cameraPitch { 0.0f };
+        glm::vec3 playerPosition { 0.0f };
+    };
+
+    struct LaunchOptions {
+        std::optional<std::filesystem::path> recordPath;
+        std::optional<std::filesystem::path> replayPath;
+        ReplaySettings replay;
+        bool benchmark { false }; // replay with vsync and frame cap off, then exit
+    };
+
+    struct BenchmarkResult {
+        std::uint32_t frames { 0 };
+        float totalSeconds { 0.0f };
+        float avgMs { 0.0f };
+        float p50Ms { 0.0f };
+        float p95Ms { 0.0f };
+        float p99Ms { 0.0f };
+        float maxMs { 0.0f };
+    };
+
+    using CaptureSessionFn = std::function<SessionState()>;
+    using RestoreSessionFn = std::function<void(const SessionState&)>;
+
+    explicit InputRecorder(Window& window);
+    ~InputRecorder();
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    // Consumes the recorder flags (--record, --replay, --replay-fixed-dt, --benchmark, --benchmark-report)
+    // and leaves the remaining arguments in `positional`.
+    static LaunchOptions parseCommandLine(int argc, char** argv, std::vector<std::string>& positional);
+
+    void setSessionHooks(CaptureSessionFn capture, RestoreSessionFn restore);
+
+    bool startRecording(const std::filesystem::path& path);
+    void stopRecording();
+    bool startReplay(const std::filesystem::path& path, const ReplaySettings& settings);
+    void stopReplay();
+
+    // Call at the top of the frame, before Window::updateInput(). Returns the delta time to simulate:
+    // the measured one unless a replay dictates it. Reseeds std::rand while recording or replaying.
+    [[nodiscard]] float beginFrame(float measuredDeltaTime);
+
+    [[nodiscard]] Mode mode() const { return m_mode; }
+    [[nodiscard]] bool exitRequested() const { return m_exitRequested; }
+    [[nodiscard]] const std::optional<BenchmarkResult>& lastBenchmark() const { return m_lastBenchmark; }
+
+    void drawImGuiPanel();
+
+private:
+    struct ImGuiInput {
+        glm::vec2 mousePos { 0.0f };
+        std::uint8_t mouseDown { 0 };
+        float mouseWheel { 0.0f };
+        float mouseWheelH { 0.0f };
+        std::uint8_t modifiers { 0 };
+        std::vector<std::uint16_t> keysDown;
+        std::vector<std::uint32_t> characters;
+    };
+
+    struct Frame {
+        float deltaTime { 0.0f };
+        Window::PolledInput polled;
+        std::vector<Window::InputEvent> events;
+        ImGuiInput imgui;
+    };
+
+    void onInputHook();
+    void captureFrame();
+    void applyReplayFrame();
+    void writeFrame(const Frame& frame);
+    [[nodiscard]] bool readFrame(Frame& frame);
+    void finishReplay();
+    void detachWindow();
+    [[nodiscard]] static std::uint32_t frameSeed(std::uint32_t sessionSeed, std::uint32_t frameIndex);
+
+    Window& m_window;
+    Mode m_mode { Mode::Idle };
+    CaptureSessionFn m_captureSession;
+    RestoreSessionFn m_restoreSession;
+
+    std::uint32_t m_sessionSeed { 0 };
+    std::uint32_t m_frameIndex { 0 };
+    float m_frameDeltaTime { 0.0f };
+
+    // Recording
+    std::ofstream m_out;
+    std::filesystem::path m_recordPath;
+    Frame m_recordFrame;
+    std::vector<char> m_frameBytes;
+    std::uint64_t m_bytesWritten { 0 };
+
+    // Replay
+    std::vector<char> m_log;
+    std::size_t m_readOffset { 0 };
+    std::uint32_t m_frameCount { 0 };
+    ReplaySettings m_replaySettings;
+    Frame m_replayFrame;
+    std::vector<float> m_frameTimesMs;
+    bool m_exitRequested { false };
+    std::optional<BenchmarkResult> m_lastBenchmark;
+
+    std::array<char, 512> m_pathBuffer { "session.inputlog" };
+    std::string m_statusMessage;
+};
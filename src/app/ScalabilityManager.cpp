@@ -0,0 +1,503 @@
+// SPDX-License-Identifier: MIT
+#include "app/ScalabilityManager.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+using Tier = ScalabilityManager::Tier;
+using Preset = ScalabilityManager::Preset;
+
+constexpr int kBenchmarkWidth = 1920;
+constexpr int kBenchmarkHeight = 1080;
+constexpr int kBenchmarkIterations = 256;
+constexpr int kBenchmarkDispatches = 4;
+// Frames this long are loads or re-bakes (often caused by a tier change itself), not load trends.
+constexpr float kHitchFrameMs = 250.0f;
+// A calibration p90 below this fraction of the budget earns one tier above the benchmark's pick.
+constexpr float kHeadroomRatio = 0.5f;
+
+[[nodiscard]] const std::array<Preset, ScalabilityManager::kTierCount>& presetTable()
+{
+    static const std::array<Preset, ScalabilityManager::kTierCount> table = [] {
+        std::array<Preset, ScalabilityManager::kTierCount> presets {};
+
+        Preset& low = presets[static_cast<std::size_t>(Tier::Low)];
+        low.msaaEnabled = false;
+        low.msaaSamples = 2;
+        low.bloomMipCount = 3;
+        low.shadowMapResolution = 512;
+        low.shadowPcfRadius = 0;
+        low.floorRadiusChunks = 2;
+        low.floorChunkResolution = 24;
+        low.waterResolution = 64;
+        low.particleDensity = 0.35f;
+        low.particleBudget = 5000;
+        low.ibl.environmentResolution = 1024;
+        low.ibl.irradianceResolution = 32;
+        low.ibl.prefilterBaseResolution = 64;
+        low.ibl.prefilterMipLevels = 5;
+        low.minimapSize = 128;
+
+        Preset& medium = presets[static_cast<std::size_t>(Tier::Medium)];
+        medium.msaaEnabled = true;
+        medium.msaaSamples = 2;
+        medium.bloomMipCount = 4;
+        medium.shadowMapResolution = 1024;
+        medium.shadowPcfRadius = 1;
+        medium.floorRadiusChunks = 2;
+        medium.floorChunkResolution = 40;
+        medium.waterResolution = 128;
+        medium.particleDensity = 0.6f;
+        medium.particleBudget = 10000;
+        medium.ibl.environmentResolution = 2048;
+        medium.ibl.irradianceResolution = 64;
+        medium.ibl.prefilterBaseResolution = 128;
+        medium.ibl.prefilterMipLevels = 6;
+        medium.minimapSize = 256;
+
+        // High is what every system defaults to on its own.
+        presets[static_cast<std::size_t>(Tier::High)] = Preset {};
+
+        Preset& ultra = presets[static_cast<std::size_t>(Tier::Ultra)];
+        ultra.msaaEnabled = true;
+        ultra.msaaSamples = 8;
+        ultra.bloomMipCount = 7;
+        ultra.shadowMapResolution = 4096;
+        ultra.shadowPcfRadius = 2;
+        ultra.floorRadiusChunks = 4;
+        ultra.floorChunkResolution = 96;
+        ultra.waterResolution = 256;
+        ultra.particleDensity = 1.0f;
+        ultra.particleBudget = 40000;
+        ultra.ibl.prefilterBaseResolution = 256;
+        ultra.ibl.prefilterMipLevels = 9;
+        ultra.minimapSize = 1024;
+        return presets;
+    }();
+    return table;
+}
+
+[[nodiscard]] Tier stepTier(Tier tier, int steps, Tier minimum)
+{
+    const int index = std::clamp(static_cast<int>(tier) + steps, static_cast<int>(minimum), ScalabilityManager::kTierCount - 1);
+    return static_cast<Tier>(index);
+}
+
+// Value at `fraction` of the sorted samples; reorders `samples`.
+[[nodiscard]] float percentile(std::vector<float>& samples, float fraction)
+{
+    const std::size_t index = std::min(samples.size() - 1, static_cast<std::size_t>(fraction * static_cast<float>(samples.size())));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+    return samples[index];
+}
+
+} // namespace
+
+const ScalabilityManager::Preset& ScalabilityManager::preset(Tier tier)
+{
+    return presetTable()[static_cast<std::size_t>(tier)];
+}
+
+const char* ScalabilityManager::tierName(Tier tier)
+{
+    switch (tier) {
+    case Tier::Low: return "low";
+    case Tier::Medium: return "medium";
+    case Tier::High: return "high";
+    case Tier::Ultra: return "ultra";
+    }
+    return "unknown";
+}
+
+void ScalabilityManager::setMetricsRegistry(MetricsRegistry* registry)
+{
+    if (!registry) {
+        m_tierGauge = {};
+        m_stepDownCounter = {};
+        return;
+    }
+    m_tierGauge = registry->gauge("daedalus_scalability_tier", "Active scalability tier (0 = low, 3 = ultra)");
+    m_stepDownCounter = registry->counter("daedalus_scalability_step_downs", "Tiers dropped by the scalability governor");
+    m_tierGauge.set(static_cast<double>(m_tier));
+}
+
+void ScalabilityManager::setSettings(const Settings& settings)
+{
+    m_settings = settings;
+    m_settings.frameBudgetMs = std::max(m_settings.frameBudgetMs, 1.0f);
+    m_settings.calibrationSeconds = std::max(m_settings.calibrationSeconds, 0.5f);
+    m_settings.windowSeconds = std::max(m_settings.windowSeconds, 0.25f);
+    m_settings.missFraction = std::clamp(m_settings.missFraction, 0.05f, 1.0f);
+    m_settings.missTolerance = std::max(m_settings.missTolerance, 1.0f);
+}
+
+void ScalabilityManager::initialize(const std::filesystem::path& shaderDirectory)
+{
+    m_shaderDirectory = shaderDirectory;
+    if (m_settings.autoSelect) {
+        recalibrate();
+        return;
+    }
+    applyTier(m_tier, "auto-select disabled");
+    m_phase = Phase::Governing;
+}
+
+void ScalabilityManager::recalibrate()
+{
+    runBenchmark();
+
+    char gpu[32] = "n/a";
+    if (m_benchmark.gpuValid)
+        std::snprintf(gpu, sizeof(gpu), "%.2f ms", static_cast<double>(m_benchmark.gpuMs));
+    char reason[192];
+    std::snprintf(reason, sizeof(reason), "benchmark: GPU %s -> %s, CPU %.2f ms -> %s%s; sampling frame times",
+        gpu,
+        tierName(m_benchmark.gpuTier),
+        static_cast<double>(m_benchmark.cpuMs),
+        tierName(m_benchmark.cpuTier),
+#ifndef NDEBUG
+        " (debug build, CPU ignored)"
+#else
+        ""
+#endif
+    );
+    applyTier(m_benchmarkTier, reason);
+
+    m_phase = Phase::Sampling;
+    m_sampledSeconds = 0.0f;
+    m_calibrationSamples.clear();
+    m_window.clear();
+    m_windowMs = 0.0f;
+    m_windowMisses = 0;
+}
+
+void ScalabilityManager::runBenchmark()
+{
+    m_benchmark = {};
+    m_benchmark.gpuValid = runGpuBenchmark(m_benchmark.gpuMs);
+    m_benchmark.gpuTier = m_benchmark.gpuValid ? tierForTime(m_benchmark.gpuMs, m_settings.gpuBenchmarkMs) : Tier::High;
+    m_benchmark.cpuMs = runCpuBenchmark();
+#ifndef NDEBUG
+    // Unoptimised code says nothing about the machine; frame-time sampling still sees the real cost.
+    m_benchmark.cpuTier = Tier::Ultra;
+#else
+    m_benchmark.cpuTier = tierForTime(m_benchmark.cpuMs, m_settings.cpuBenchmarkMs);
+#endif
+    m_benchmarkTier = std::max(std::min(m_benchmark.gpuTier, m_benchmark.cpuTier), m_settings.minimumTier);
+}
+
+bool ScalabilityManager::runGpuBenchmark(float& outMs)
+{
+    if (m_benchmarkShaderFailed)
+        return false;
+    if (m_benchmarkShader.id() == std::numeric_limits<GLuint>::max()) {
+        try {
+            ShaderBuilder builder;
+            builder.addStage(GL_COMPUTE_SHADER, m_shaderDirectory / "scalability_benchmark.comp");
+            m_benchmarkShader = builder.build();
+        } catch (const std::exception& e) {
+            std::cerr << "[Scalability] GPU benchmark unavailable: " << e.what() << std::endl;
+            m_benchmarkShaderFailed = true;
+            return false;
+        }
+    }
+
+    GLuint target = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &target);
+    glTextureStorage2D(target, 1, GL_RGBA16F, kBenchmarkWidth, kBenchmarkHeight);
+    glBindImageTexture(0, target, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+    m_benchmarkShader.bind();
+    glUniform1i(m_benchmarkShader.getUniformLocation("uIterations"), kBenchmarkIterations);
+    const GLuint groupsX = (kBenchmarkWidth + 7) / 8;
+    const GLuint groupsY = (kBenchmarkHeight + 7) / 8;
+
+    // The first dispatch pays for clocks ramping up and lazy driver work; it is not timed.
+    glDispatchCompute(groupsX, groupsY, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    for (int i = 0; i < kBenchmarkDispatches; ++i) {
+        glDispatchCompute(groupsX, groupsY, 1);
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+    glEndQuery(GL_TIME_ELAPSED);
+
+    GLuint64 elapsedNs = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNs); // blocks; startup only
+
+    glDeleteQueries(1, &query);
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glDeleteTextures(1, &target);
+    glUseProgram(0);
+
+    outMs = static_cast<float>(static_cast<double>(elapsedNs) / 1.0e6 / kBenchmarkDispatches);
+    return elapsedNs > 0;
+}
+
+float ScalabilityManager::runCpuBenchmark()
+{
+    // Transform streaming (culling, skinning) plus a cache-unfriendly sort (draw ordering).
+    constexpr std::size_t kTransforms = 1u << 18;
+    constexpr std::size_t kSortKeys = 1u << 16;
+
+    std::vector<glm::vec4> points(kTransforms);
+    for (std::size_t i = 0; i < kTransforms; ++i)
+        points[i] = glm::vec4(static_cast<float>(i % 97), static_cast<float>(i % 89), static_cast<float>(i % 83), 1.0f);
+    std::vector<std::uint32_t> keys(kSortKeys);
+
+    volatile float sink = 0.0f;
+    float bestMs = std::numeric_limits<float>::max();
+    for (int run = 0; run < 3; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+
+        const glm::mat4 transform = glm::rotate(glm::mat4(1.0f), 0.1f * static_cast<float>(run + 1), glm::vec3(0.3f, 1.0f, 0.2f));
+        glm::vec4 accumulated { 0.0f };
+        for (const glm::vec4& point : points)
+            accumulated += transform * point;
+
+        std::uint32_t state = 0x9E3779B9u + static_cast<std::uint32_t>(run);
+        for (std::uint32_t& key : keys) {
+            state = state * 1664525u + 1013904223u;
+            key = state;
+        }
+        std::sort(keys.begin(), keys.end());
+
+        sink = sink + accumulated.x + static_cast<float>(keys[kSortKeys / 2] & 0xFFu);
+        const float elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        bestMs = std::min(bestMs, elapsed);
+    }
+    return bestMs;
+}
+
+ScalabilityManager::Tier ScalabilityManager::tierForTime(float ms, const std::array<float, 3>& limits)
+{
+    if (ms <= limits[0])
+        return Tier::Ultra;
+    if (ms <= limits[1])
+        return Tier::High;
+    if (ms <= limits[2])
+        return Tier::Medium;
+    return Tier::Low;
+}
+
+void ScalabilityManager::onFrame(float frameTimeMs)
+{
+    if (!(frameTimeMs > 0.0f))
+        return;
+
+    switch (m_phase) {
+    case Phase::Uncalibrated:
+        break;
+    case Phase::Sampling:
+        m_sampledSeconds += frameTimeMs * 0.001f;
+        if (m_sampledSeconds > m_settings.calibrationWarmupSeconds)
+            m_calibrationSamples.push_back(frameTimeMs);
+        if (m_sampledSeconds >= m_settings.calibrationWarmupSeconds + m_settings.calibrationSeconds)
+            finishCalibration();
+        break;
+    case Phase::Governing:
+        governFrame(frameTimeMs);
+        break;
+    }
+}
+
+void ScalabilityManager::finishCalibration()
+{
+    m_phase = Phase::Governing;
+    m_cooldownSeconds = m_settings.cooldownSeconds;
+    if (m_calibrationSamples.empty()) {
+        applyTier(m_tier, "benchmark only; no frames sampled");
+        return;
+    }
+
+    const std::size_t sampleCount = m_calibrationSamples.size();
+    const float p50 = percentile(m_calibrationSamples, 0.5f);
+    const float p90 = percentile(m_calibrationSamples, 0.9f);
+    m_calibrationSamples.clear();
+
+    const float budget = m_settings.frameBudgetMs;
+    const float ratio = p90 / budget;
+    Tier chosen = m_tier;
+    const char* verdict = "within";
+    if (ratio > m_settings.missTolerance) {
+        chosen = stepTier(m_tier, ratio > 2.0f ? -2 : -1, m_settings.minimumTier);
+        verdict = "over";
+    } else if (ratio < kHeadroomRatio) {
+        chosen = stepTier(m_tier, 1, m_settings.minimumTier);
+        verdict = "well under";
+    }
+
+    char reason[192];
+    std::snprintf(reason, sizeof(reason), "calibrated from %s: frame p50 %.1f ms, p90 %.1f ms over %zu frames, %s the %.1f ms budget",
+        tierName(m_tier),
+        static_cast<double>(p50),
+        static_cast<double>(p90),
+        sampleCount,
+        verdict,
+        static_cast<double>(budget));
+    applyTier(chosen, reason);
+}
+
+void ScalabilityManager::governFrame(float frameTimeMs)
+{
+    if (!m_settings.governorEnabled || frameTimeMs >= kHitchFrameMs)
+        return;
+    if (m_cooldownSeconds > 0.0f) {
+        m_cooldownSeconds -= frameTimeMs * 0.001f;
+        return;
+    }
+
+    const bool missed = frameTimeMs > m_settings.frameBudgetMs * m_settings.missTolerance;
+    m_window.push_back(WindowSample { frameTimeMs, missed });
+    m_windowMs += frameTimeMs;
+    m_windowMisses += missed ? 1 : 0;
+
+    const float windowMs = m_settings.windowSeconds * 1000.0f;
+    while (m_window.size() > 1 && m_windowMs - m_window.front().ms >= windowMs) {
+        m_windowMs -= m_window.front().ms;
+        m_windowMisses -= m_window.front().missed ? 1 : 0;
+        m_window.pop_front();
+    }
+    if (m_windowMs < windowMs || m_tier <= m_settings.minimumTier)
+        return;
+
+    const float missFraction = static_cast<float>(m_windowMisses) / static_cast<float>(m_window.size());
+    if (missFraction < m_settings.missFraction)
+        return;
+
+    char reason[192];
+    std::snprintf(reason, sizeof(reason), "governor: %.0f%% of frames missed the %.1f ms budget over %.1f s (avg %.1f ms)",
+        static_cast<double>(missFraction * 100.0f),
+        static_cast<double>(m_settings.frameBudgetMs),
+        static_cast<double>(m_settings.windowSeconds),
+        static_cast<double>(m_windowMs / static_cast<float>(m_window.size())));
+    ++m_stepDowns;
+    m_stepDownCounter.add();
+    applyTier(stepTier(m_tier, -1, m_settings.minimumTier), reason);
+    m_cooldownSeconds = m_settings.cooldownSeconds;
+}
+
+void ScalabilityManager::setTier(Tier tier, const std::string& reason)
+{
+    applyTier(tier, reason);
+    m_phase = Phase::Governing;
+    m_calibrationSamples.clear();
+    m_cooldownSeconds = m_settings.cooldownSeconds;
+}
+
+void ScalabilityManager::applyTier(Tier tier, const std::string& reason)
+{
+    const bool changed = tier != m_tier || m_phase == Phase::Uncalibrated;
+    m_tier = tier;
+    m_reason = reason;
+    m_window.clear();
+    m_windowMs = 0.0f;
+    m_windowMisses = 0;
+    m_tierGauge.set(static_cast<double>(tier));
+
+    std::cout << "[Scalability] Tier " << tierName(tier) << ": " << reason << std::endl;
+    if (changed && m_apply)
+        m_apply(tier, preset(tier));
+}
+
+void ScalabilityManager::drawImGuiPanel()
+{
+    ImGui::Text("Tier: %s", tierName(m_tier));
+    ImGui::TextWrapped("Reason: %s", m_reason.c_str());
+    switch (m_phase) {
+    case Phase::Uncalibrated:
+        ImGui::TextDisabled("Not initialized");
+        break;
+    case Phase::Sampling:
+        ImGui::Text("Calibrating: %.1f / %.1f s",
+            static_cast<double>(m_sampledSeconds),
+            static_cast<double>(m_settings.calibrationWarmupSeconds + m_settings.calibrationSeconds));
+        break;
+    case Phase::Governing:
+        if (m_settings.governorEnabled && !m_window.empty()) {
+            ImGui::Text("Governor window: %d / %zu frames missed", m_windowMisses, m_window.size());
+        } else if (m_cooldownSeconds > 0.0f) {
+            ImGui::Text("Governor cooling down: %.1f s", static_cast<double>(m_cooldownSeconds));
+        }
+        break;
+    }
+    ImGui::Text("Governor step-downs: %u", m_stepDowns);
+
+    int tierIndex = static_cast<int>(m_tier);
+    constexpr std::array<const char*, kTierCount> kTierLabels { "Low", "Medium", "High", "Ultra" };
+    if (ImGui::Combo("Tier", &tierIndex, kTierLabels.data(), kTierCount))
+        setTier(static_cast<Tier>(tierIndex), "selected manually");
+    if (ImGui::Button("Recalibrate"))
+        recalibrate();
+
+    Settings settings = m_settings;
+    bool changed = false;
+    changed |= ImGui::Checkbox("Auto-select at startup", &settings.autoSelect);
+    changed |= ImGui::Checkbox("Governor", &settings.governorEnabled);
+    changed |= ImGui::SliderFloat("Frame budget (ms)", &settings.frameBudgetMs, 4.0f, 50.0f, "%.1f");
+    changed |= ImGui::SliderFloat("Miss tolerance", &settings.missTolerance, 1.0f, 2.0f, "%.2fx");
+    changed |= ImGui::SliderFloat("Window (s)", &settings.windowSeconds, 0.5f, 10.0f, "%.1f");
+    changed |= ImGui::SliderFloat("Miss fraction", &settings.missFraction, 0.1f, 1.0f, "%.2f");
+    changed |= ImGui::SliderFloat("Cooldown (s)", &settings.cooldownSeconds, 0.0f, 30.0f, "%.1f");
+    int minimumTier = static_cast<int>(settings.minimumTier);
+    if (ImGui::Combo("Minimum tier", &minimumTier, kTierLabels.data(), kTierCount)) {
+        settings.minimumTier = static_cast<Tier>(minimumTier);
+        changed = true;
+    }
+    if (changed)
+        setSettings(settings);
+
+    if (m_benchmark.gpuValid)
+        ImGui::Text("GPU benchmark: %.3f ms (%s)", static_cast<double>(m_benchmark.gpuMs), tierName(m_benchmark.gpuTier));
+    else
+        ImGui::TextDisabled("GPU benchmark: n/a");
+    ImGui::Text("CPU benchmark: %.2f ms (%s)", static_cast<double>(m_benchmark.cpuMs), tierName(m_benchmark.cpuTier));
+
+    if (ImGui::BeginTable("ScalabilityPresets", kTierCount + 1, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Knob");
+        for (const char* label : kTierLabels)
+            ImGui::TableSetupColumn(label);
+        ImGui::TableHeadersRow();
+        const auto row = [](const char* name, auto&& value) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(name);
+            for (int i = 0; i < kTierCount; ++i) {
+                ImGui::TableNextColumn();
+                value(preset(static_cast<Tier>(i)));
+            }
+        };
+        row("MSAA", [](const Preset& p) {
+            if (p.msaaEnabled)
+                ImGui::Text("%dx", p.msaaSamples);
+            else
+                ImGui::TextUnformatted("off");
+        });
+        row("Bloom mips", [](const Preset& p) { ImGui::Text("%d", p.bloomMipCount); });
+        row("Shadow map", [](const Preset& p) { ImGui::Text("%d", p.shadowMapResolution); });
+        row("PCF radius", [](const Preset& p) { ImGui::Text("%d", p.shadowPcfRadius); });
+        row("Floor chunks", [](const Preset& p) { ImGui::Text("r%d @ %d", p.floorRadiusChunks, p.floorChunkResolution); });
+        row("Water grid", [](const Preset& p) { ImGui::Text("%d", p.waterResolution); });
+        row("Particles", [](const Preset& p) { ImGui::Text("%.0f%%, %d max", static_cast<double>(p.particleDensity * 100.0f), p.particleBudget); });
+        row("IBL env / irr", [](const Preset& p) { ImGui::Text("%d / %d", p.ibl.environmentResolution, p.ibl.irradianceResolution); });
+        row("IBL prefilter", [](const Preset& p) { ImGui::Text("%d, %d mips", p.ibl.prefilterBaseResolution, p.ibl.prefilterMipLevels); });
+        row("Minimap", [](const Preset& p) { ImGui::Text("%d", p.minimapSize); });
+        ImGui::EndTable();
+    }
+}
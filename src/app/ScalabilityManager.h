@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "metrics/MetricsRegistry.h"
+#include "rendering/EnvironmentManager.h"
+
+#include <framework/shader.h>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Named quality tiers that set every expensive knob together (MSAA, bloom, shadows, terrain, water,
+// particles, IBL, minimap). At startup a GPU/CPU micro-benchmark picks a provisional tier, which the
+// first seconds of real frame times then confirm or correct; afterwards a governor steps down one
+// tier at a time when most frames of a window miss the frame budget. The tier is applied through a
+// callback so the systems themselves stay unaware of it.
+class ScalabilityManager {
+public:
+    enum class Tier {
+        Low = 0,
+        Medium = 1,
+        High = 2,
+        Ultra = 3
+    };
+    static constexpr int kTierCount = 4;
+
+    struct Preset {
+        bool msaaEnabled { true };
+        int msaaSamples { 4 };
+        int bloomMipCount { 6 };
+        int shadowMapResolution { 2048 };
+        int shadowPcfRadius { 1 };
+        int floorRadiusChunks { 3 };
+        int floorChunkResolution { 64 };
+        int waterResolution { 200 };
+        float particleDensity { 1.0f };
+        int particleBudget { 20000 };
+        EnvironmentManager::AdvancedSettings ibl {};
+        int minimapSize { 512 };
+    };
+
+    struct Settings {
+        bool autoSelect { true }; // benchmark + frame-time calibration at startup
+        bool governorEnabled { true };
+        float frameBudgetMs { 1000.0f / 60.0f };
+        float calibrationWarmupSeconds { 1.0f }; // skipped: shader compiles and first uploads
+        float calibrationSeconds { 3.0f };
+        // A frame misses when it takes longer than budget * missTolerance.
+        float missTolerance { 1.15f };
+        // The governor steps down when `missFraction` of the frames in the last `windowSeconds` missed.
+        float windowSeconds { 2.0f };
+        float missFraction { 0.6f };
+        float cooldownSeconds { 5.0f }; // after any tier change
+        Tier minimumTier { Tier::Low };
+        // Benchmark time at or below which Ultra, High and Medium are still picked; Low otherwise.
+        std::array<float, 3> gpuBenchmarkMs { 0.6f, 1.5f, 4.0f };
+        std::array<float, 3> cpuBenchmarkMs { 4.0f, 7.0f, 12.0f };
+    };
+
+    enum class Phase {
+        Uncalibrated,
+        Sampling,
+        Governing
+    };
+
+    struct Benchmark {
+        bool gpuValid { false };
+        float gpuMs { 0.0f }; // one dispatch of the reference compute workload
+        float cpuMs { 0.0f }; // best of three runs of the reference CPU workload
+        Tier gpuTier { Tier::High };
+        Tier cpuTier { Tier::High };
+    };
+
+    using ApplyCallback = std::function<void(Tier, const Preset&)>;
+
+    ScalabilityManager() = default;
+    ~ScalabilityManager() = default;
+
+    ScalabilityManager(const ScalabilityManager&) = delete;
+    ScalabilityManager& operator=(const ScalabilityManager&) = delete;
+
+    [[nodiscard]] static const Preset& preset(Tier tier);
+    [[nodiscard]] static const char* tierName(Tier tier);
+
+    void setApplyCallback(ApplyCallback callback) { m_apply = std::move(callback); }
+    void setMetricsRegistry(MetricsRegistry* registry);
+
+    void setSettings(const Settings& settings);
+    [[nodiscard]] const Settings& settings() const { return m_settings; }
+
+    // Needs a current GL context. With autoSelect this benchmarks, applies the provisional tier and
+    // starts sampling frame times; otherwise it applies the current tier as is.
+    void initialize(const std::filesystem::path& shaderDirectory);
+    // Once per frame with the time the frame actually cost (frame-rate cap waits excluded).
+    void onFrame(float frameTimeMs);
+
+    // Applies and logs a tier. A manual choice ends calibration; the governor keeps running.
+    void setTier(Tier tier, const std::string& reason);
+    void recalibrate();
+
+    [[nodiscard]] Tier tier() const { return m_tier; }
+    [[nodiscard]] const std::string& reason() const { return m_reason; }
+    [[nodiscard]] Phase phase() const { return m_phase; }
+    [[nodiscard]] const Benchmark& benchmark() const { return m_benchmark; }
+
+    void drawImGuiPanel();
+
+private:
+    void runBenchmark();
+    [[nodiscard]] bool runGpuBenchmark(float& outMs);
+    [[nodiscard]] static float runCpuBenchmark();
+    [[nodiscard]] static Tier tierForTime(float ms, const std::array<float, 3>& limits);
+    void finishCalibration();
+    void governFrame(float frameTimeMs);
+    void applyTier(Tier tier, const std::string& reason);
+
+    Settings m_settings;
+    ApplyCallback m_apply;
+    std::filesystem::path m_shaderDirectory;
+
+    Tier m_tier { Tier::High };
+    std::string m_reason { "default" };
+    Phase m_phase { Phase::Uncalibrated };
+    Benchmark m_benchmark;
+    Tier m_benchmarkTier { Tier::High };
+
+    float m_sampledSeconds { 0.0f };
+    std::vector<float> m_calibrationSamples;
+
+    struct WindowSample {
+        float ms { 0.0f };
+        bool missed { false };
+    };
+    std::deque<WindowSample> m_window;
+    float m_windowMs { 0.0f };
+    int m_windowMisses { 0 };
+    float m_cooldownSeconds { 0.0f };
+    std::uint32_t m_stepDowns { 0 };
+
+    Shader m_benchmarkShader;
+    bool m_benchmarkShaderFailed { false };
+
+    MetricsRegistry::Gauge m_tierGauge;
+    MetricsRegistry::Counter m_stepDownCounter;
+};
@@ -62,6 +62,7 @@ public:
 
     void beginFrame();
     void addSelectable(const SelectableEntry& entry);
+    [[nodiscard]] const std::vector<SelectableEntry>& selectables() const { return m_entries; }
 
     [[nodiscard]] std::optional<HitResult> pick(const Ray& ray, float maxDistance) const;
 
@@ -0,0 +1,709 @@
+// SPDX-License-Identifier: MIT
+#include "io/AssetDatabase.h"
+
+#include "io/AssetPack.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+namespace {
+
+constexpr char kDatabaseMagic[4] = { 'D', 'A', 'D', 'B' };
+constexpr std::uint32_t kDatabaseFormat = 1u;
+constexpr const char* kDatabaseFile = "assetdb.bin";
+
+std::string toHex(std::uint64_t value)
+{
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016" PRIx64, value);
+    return buffer;
+}
+
+template <typename T>
+void writeValue(std::ostream& stream, const T& value)
+{
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeString(std::ostream& stream, const std::string& text)
+{
+    writeValue(stream, static_cast<std::uint32_t>(text.size()));
+    stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+template <typename T>
+bool readValue(std::istream& stream, T& value)
+{
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+bool readString(std::istream& stream, std::string& text)
+{
+    std::uint32_t size = 0;
+    if (!readValue(stream, size) || size > (1u << 20))
+        return false;
+    text.resize(size);
+    return static_cast<bool>(stream.read(text.data(), static_cast<std::streamsize>(size)));
+}
+
+} // namespace
+
+std::string AssetDatabase::ArtifactKey::toString() const
+{
+    return kind + "|" + normalizePath(source) + "|" + toHex(settingsHash);
+}
+
+AssetDatabase::AssetDatabase(std::filesystem::path cacheDirectory, unsigned workerThreads)
+    : m_cacheDirectory(std::filesystem::absolute(cacheDirectory).lexically_normal())
+{
+    for (unsigned i = 0; i < workerThreads; ++i)
+        m_workers.emplace_back([this]() { workerLoop(); });
+}
+
+AssetDatabase::~AssetDatabase()
+{
+    {
+        std::unique_lock lock(m_mutex);
+        m_stopping = true;
+    }
+    m_jobsCv.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+    // Jobs that never started report failure rather than leaving their futures hanging.
+    for (const std::unique_ptr<Job>& job : m_jobs)
+        job->promise.set_value(false);
+}
+
+void AssetDatabase::registerImporter(const std::string& kind, std::uint32_t version)
+{
+    std::unique_lock lock(m_mutex);
+    m_importerVersions[kind] = version;
+}
+
+std::string AssetDatabase::normalizePath(const std::filesystem::path& path)
+{
+    std::error_code error;
+    std::filesystem::path absolute = std::filesystem::absolute(path, error);
+    if (error)
+        absolute = path;
+    return absolute.lexically_normal().generic_string();
+}
+
+AssetDatabase::FileStamp AssetDatabase::stampOf(const std::filesystem::path& path)
+{
+    FileStamp stamp;
+    std::error_code error;
+    if (!std::filesystem::is_regular_file(path, error))
+        return stamp;
+    const std::uintmax_t size = std::filesystem::file_size(path, error);
+    if (error)
+        return stamp;
+    const std::filesystem::file_time_type modified = std::filesystem::last_write_time(path, error);
+    if (error)
+        return stamp;
+    stamp.size = static_cast<std::uint64_t>(size);
+    stamp.modified = modified.time_since_epoch().count();
+    stamp.onDisk = true;
+    return stamp;
+}
+
+std::optional<std::uint64_t> AssetDatabase::hashFile(const std::filesystem::path& path, std::uint64_t& bytes)
+{
+    // Through the file provider so sources that only exist inside a mounted pack hash as well.
+    const std::optional<FileData> data = readFileData(path);
+    if (!data)
+        return std::nullopt;
+    bytes = data->size();
+    return asset_pack::hashContent(data->data(), data->size());
+}
+
+AssetDatabase::NodeIndex AssetDatabase::sourceNode(const std::string& path)
+{
+    auto [it, inserted] = m_sourceIndex.try_emplace(path, static_cast<NodeIndex>(m_sources.size()));
+    if (inserted) {
+        SourceRecord& record = m_sources.emplace_back();
+        record.path = path;
+    }
+    return it->second;
+}
+
+AssetDatabase::NodeIndex AssetDatabase::artifactNode(const ArtifactKey& key, const std::string& keyString)
+{
+    auto [it, inserted] = m_artifactIndex.try_emplace(keyString, static_cast<NodeIndex>(m_artifacts.size()));
+    if (inserted) {
+        ArtifactRecord& record = m_artifacts.emplace_back();
+        record.key = keyString;
+        record.kind = key.kind;
+        record.source = normalizePath(key.source);
+    }
+    return it->second;
+}
+
+std::uint32_t AssetDatabase::importerVersion(const std::string& kind) const
+{
+    const auto it = m_importerVersions.find(kind);
+    return it != m_importerVersions.end() ? it->second : 0u;
+}
+
+bool AssetDatabase::checkArtifact(const ArtifactRecord& artifact) const
+{
+    for (const Dependency& dependency : artifact.dependencies) {
+        if (dependency.artifact) {
+            const ArtifactRecord& upstream = m_artifacts[dependency.node];
+            if (!upstream.valid || upstream.generation != dependency.hash)
+                return false;
+        } else {
+            const SourceRecord& source = m_sources[dependency.node];
+            if (!source.readable || source.hash != dependency.hash)
+                return false;
+        }
+    }
+    return true;
+}
+
+void AssetDatabase::invalidateDownstream(std::vector<NodeIndex> artifacts)
+{
+    while (!artifacts.empty()) {
+        const NodeIndex node = artifacts.back();
+        artifacts.pop_back();
+        ArtifactRecord& artifact = m_artifacts[node];
+        if (!artifact.valid)
+            continue; // Already invalid, and so is everything built from it.
+        artifact.valid = false;
+        ++m_stats.invalidations;
+        artifacts.insert(artifacts.end(), artifact.dependents.begin(), artifact.dependents.end());
+    }
+}
+
+std::optional<std::uint64_t> AssetDatabase::updateSource(const std::string& path, bool& changed, const FileData* contents)
+{
+    changed = false;
+    const FileStamp stamp = stampOf(path);
+    {
+        std::unique_lock lock(m_mutex);
+        const auto it = m_sourceIndex.find(path);
+        if (it != m_sourceIndex.end()) {
+            const SourceRecord& record = m_sources[it->second];
+            // Packs are immutable while mounted, so a pack-only file never needs re-hashing.
+            const bool unchanged = stamp.onDisk
+                ? record.modified == stamp.modified && record.size == stamp.size
+                : record.modified == 0;
+            if (record.readable && unchanged) {
+                ++m_stats.hashCacheHits;
+                return record.hash;
+            }
+        }
+    }
+
+    // Hash outside the lock: isValid() is called from the render thread and must not wait on disk.
+    std::uint64_t bytes = 0;
+    std::optional<std::uint64_t> hash;
+    if (contents) {
+        bytes = contents->size();
+        hash = asset_pack::hashContent(contents->data(), contents->size());
+    } else {
+        hash = hashFile(path, bytes);
+    }
+
+    std::unique_lock lock(m_mutex);
+    SourceRecord& record = m_sources[sourceNode(path)];
+    ++m_stats.hashesComputed;
+    m_stats.bytesHashed += bytes;
+    changed = record.readable != hash.has_value() || (hash && record.hash != *hash);
+    record.size = stamp.onDisk ? stamp.size : bytes;
+    record.modified = stamp.onDisk ? stamp.modified : 0;
+    record.readable = hash.has_value();
+    record.hash = hash.value_or(0);
+    if (changed)
+        invalidateDownstream(record.dependents);
+    return hash;
+}
+
+std::uint64_t AssetDatabase::hashSettings(std::string_view settings)
+{
+    return asset_pack::hashContent(reinterpret_cast<const std::byte*>(settings.data()), settings.size());
+}
+
+std::optional<std::uint64_t> AssetDatabase::sourceHash(const std::filesystem::path& source, const FileData* contents)
+{
+    bool changed = false;
+    return updateSource(normalizePath(source), changed, contents);
+}
+
+std::size_t AssetDatabase::refreshSources()
+{
+    std::vector<std::string> paths;
+    {
+        std::unique_lock lock(m_mutex);
+        paths.reserve(m_sources.size());
+        for (const SourceRecord& source : m_sources) {
+            if (!source.dependents.empty())
+                paths.push_back(source.path);
+        }
+    }
+
+    std::size_t changedCount = 0;
+    for (const std::string& path : paths) {
+        bool changed = false;
+        (void)updateSource(path, changed);
+        if (changed) {
+            std::cout << "[AssetDB] Source changed: " << path << std::endl;
+            ++changedCount;
+        }
+    }
+    return changedCount;
+}
+
+bool AssetDatabase::isValid(const ArtifactKey& key) const
+{
+    const std::string keyString = key.toString();
+    std::unique_lock lock(m_mutex);
+    const auto it = m_artifactIndex.find(keyString);
+    if (it == m_artifactIndex.end())
+        return false;
+    const ArtifactRecord& artifact = m_artifacts[it->second];
+    return artifact.valid && artifact.importerVersion == importerVersion(artifact.kind);
+}
+
+std::filesystem::path AssetDatabase::artifactPath(const ArtifactKey& key) const
+{
+    return m_cacheDirectory / key.kind / (toHex(hashSettings(key.toString())) + ".bin");
+}
+
+std::optional<std::string> AssetDatabase::contentKey(const ArtifactKey& key, const FileData* contents)
+{
+    const std::optional<std::uint64_t> hash = sourceHash(key.source, contents);
+    if (!hash)
+        return std::nullopt;
+    return key.kind + ":" + toHex(*hash) + ":" + toHex(key.settingsHash);
+}
+
+std::shared_future<bool> AssetDatabase::request(const ArtifactKey& key, Importer importer)
+{
+    const std::string keyString = key.toString();
+    auto job = std::make_unique<Job>();
+    std::shared_future<bool> future;
+    {
+        std::unique_lock lock(m_mutex);
+        const auto artifact = m_artifactIndex.find(keyString);
+        if (artifact != m_artifactIndex.end()) {
+            const ArtifactRecord& record = m_artifacts[artifact->second];
+            if (record.valid && record.importerVersion == importerVersion(record.kind)) {
+                std::promise<bool> ready;
+                ready.set_value(true);
+                return ready.get_future().share();
+            }
+        }
+        if (const auto running = m_inFlight.find(keyString); running != m_inFlight.end()) {
+            ++m_stats.importsShared;
+            return running->second;
+        }
+
+        job->key = key;
+        job->importer = std::move(importer);
+        future = job->promise.get_future().share();
+        m_inFlight.emplace(keyString, future);
+        if (!m_workers.empty()) {
+            m_jobs.push_back(std::move(job));
+            m_jobsCv.notify_one();
+            return future;
+        }
+    }
+
+    // No workers: import on the calling thread.
+    job->promise.set_value(runImport(job->key, job->importer));
+    return future;
+}
+
+bool AssetDatabase::importNow(const ArtifactKey& key, const Importer& importer)
+{
+    const std::string keyString = key.toString();
+    std::promise<bool> promise;
+    {
+        std::unique_lock lock(m_mutex);
+        const auto artifact = m_artifactIndex.find(keyString);
+        if (artifact != m_artifactIndex.end()) {
+            const ArtifactRecord& record = m_artifacts[artifact->second];
+            if (record.valid && record.importerVersion == importerVersion(record.kind))
+                return true;
+        }
+        if (const auto running = m_inFlight.find(keyString); running != m_inFlight.end()) {
+            ++m_stats.importsShared;
+            const std::shared_future<bool> future = running->second;
+            lock.unlock();
+            return future.get();
+        }
+        m_inFlight.emplace(keyString, promise.get_future().share());
+    }
+
+    const bool succeeded = runImport(key, importer);
+    promise.set_value(succeeded);
+    return succeeded;
+}
+
+bool AssetDatabase::runImport(const ArtifactKey& key, const Importer& importer)
+{
+    ImportContext context;
+    context.m_key = key;
+    context.m_outputPath = artifactPath(key);
+
+    std::error_code error;
+    std::filesystem::create_directories(context.m_outputPath.parent_path(), error);
+
+    bool succeeded = false;
+    try {
+        succeeded = importer(context);
+    } catch (const std::exception& exception) {
+        std::cerr << "[AssetDB] Import of " << key.toString() << " threw: " << exception.what() << std::endl;
+    }
+    if (!succeeded)
+        std::cerr << "[AssetDB] Import failed: " << key.toString() << std::endl;
+
+    {
+        std::unique_lock lock(m_mutex);
+        ++m_stats.importsRun;
+        if (!succeeded)
+            ++m_stats.importsFailed;
+    }
+    commitImport(context, succeeded);
+    return succeeded;
+}
+
+void AssetDatabase::commitImport(const ImportContext& context, bool succeeded)
+{
+    // Hash what the artifact was built from before taking the lock; the primary source is implicit.
+    std::vector<std::string> sourcePaths;
+    sourcePaths.push_back(normalizePath(context.m_key.source));
+    for (const std::filesystem::path& source : context.m_sources)
+        sourcePaths.push_back(normalizePath(source));
+    std::sort(sourcePaths.begin() + 1, sourcePaths.end());
+    sourcePaths.erase(std::unique(sourcePaths.begin() + 1, sourcePaths.end()), sourcePaths.end());
+    sourcePaths.erase(std::remove(sourcePaths.begin() + 1, sourcePaths.end(), sourcePaths.front()), sourcePaths.end());
+
+    std::vector<std::optional<std::uint64_t>> hashes;
+    hashes.reserve(sourcePaths.size());
+    for (const std::string& path : sourcePaths) {
+        bool changed = false;
+        hashes.push_back(updateSource(path, changed));
+    }
+
+    const std::string keyString = context.m_key.toString();
+    std::unique_lock lock(m_mutex);
+    const NodeIndex node = artifactNode(context.m_key, keyString);
+
+    // Unhook from the previous build's dependencies.
+    const auto unlink = [node](std::vector<NodeIndex>& dependents) {
+        dependents.erase(std::remove(dependents.begin(), dependents.end(), node), dependents.end());
+    };
+    for (const Dependency& dependency : m_artifacts[node].dependencies) {
+        if (dependency.artifact)
+            unlink(m_artifacts[dependency.node].dependents);
+        else
+            unlink(m_sources[dependency.node].dependents);
+    }
+
+    std::vector<Dependency> dependencies;
+    bool complete = succeeded;
+    for (std::size_t i = 0; i < sourcePaths.size(); ++i) {
+        Dependency dependency;
+        dependency.node = sourceNode(sourcePaths[i]);
+        dependency.hash = hashes[i].value_or(0);
+        complete = complete && hashes[i].has_value();
+        dependencies.push_back(dependency);
+    }
+    for (const ArtifactKey& upstreamKey : context.m_artifacts) {
+        Dependency dependency;
+        dependency.artifact = true;
+        dependency.node = artifactNode(upstreamKey, upstreamKey.toString());
+        if (dependency.node == node)
+            continue;
+        dependency.hash = m_artifacts[dependency.node].generation;
+        complete = complete && m_artifacts[dependency.node].valid;
+        dependencies.push_back(dependency);
+    }
+
+    // Nodes may have been appended above, so only take the reference now.
+    ArtifactRecord& artifact = m_artifacts[node];
+    artifact.dependencies = std::move(dependencies);
+    for (const Dependency& dependency : artifact.dependencies) {
+        if (dependency.artifact)
+            m_artifacts[dependency.node].dependents.push_back(node);
+        else
+            m_sources[dependency.node].dependents.push_back(node);
+    }
+
+    // Whatever was built from the previous generation is stale either way.
+    invalidateDownstream(artifact.dependents);
+
+    artifact.valid = complete;
+    if (complete) {
+        ++artifact.generation;
+        artifact.importerVersion = importerVersion(artifact.kind);
+    }
+    m_inFlight.erase(keyString);
+}
+
+void AssetDatabase::recordArtifact(const ArtifactKey& key, const std::vector<std::filesystem::path>& sources)
+{
+    ImportContext context;
+    context.m_key = key;
+    context.m_sources = sources;
+    commitImport(context, true);
+}
+
+void AssetDatabase::invalidate(const ArtifactKey& key)
+{
+    const std::string keyString = key.toString();
+    std::unique_lock lock(m_mutex);
+    const auto it = m_artifactIndex.find(keyString);
+    if (it != m_artifactIndex.end())
+        invalidateDownstream({ it->second });
+}
+
+void AssetDatabase::workerLoop()
+{
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock lock(m_mutex);
+            m_jobsCv.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+            if (m_stopping)
+                return;
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        job->promise.set_value(runImport(job->key, job->importer));
+    }
+}
+
+bool AssetDatabase::load()
+{
+    std::ifstream stream(m_cacheDirectory / kDatabaseFile, std::ios::binary);
+    if (!stream)
+        return false;
+
+    char magic[4] {};
+    std::uint32_t format = 0;
+    std::uint32_t engineVersion = 0;
+    stream.read(magic, sizeof(magic));
+    if (!stream || !std::equal(std::begin(magic), std::end(magic), std::begin(kDatabaseMagic))
+        || !readValue(stream, format) || format != kDatabaseFormat || !readValue(stream, engineVersion)) {
+        std::cerr << "[AssetDB] Ignoring unrecognised database in " << m_cacheDirectory << std::endl;
+        return false;
+    }
+    if (engineVersion != kEngineVersion) {
+        std::cout << "[AssetDB] Engine version changed, rebuilding derived data" << std::endl;
+        return false;
+    }
+
+    std::vector<SourceRecord> sources;
+    std::vector<ArtifactRecord> artifacts;
+    std::uint32_t sourceCount = 0;
+    bool ok = readValue(stream, sourceCount);
+    for (std::uint32_t i = 0; ok && i < sourceCount; ++i) {
+        SourceRecord& source = sources.emplace_back();
+        std::uint8_t readable = 0;
+        ok = readString(stream, source.path) && readValue(stream, source.size) && readValue(stream, source.modified)
+            && readValue(stream, source.hash) && readValue(stream, readable);
+        source.readable = readable != 0;
+    }
+    std::uint32_t artifactCount = 0;
+    ok = ok && readValue(stream, artifactCount);
+    for (std::uint32_t i = 0; ok && i < artifactCount; ++i) {
+        ArtifactRecord& artifact = artifacts.emplace_back();
+        std::uint8_t valid = 0;
+        std::uint32_t dependencyCount = 0;
+        ok = readString(stream, artifact.key) && readString(stream, artifact.kind) && readString(stream, artifact.source)
+            && readValue(stream, artifact.importerVersion) && readValue(stream, artifact.generation)
+            && readValue(stream, valid) && readValue(stream, dependencyCount);
+        artifact.valid = valid != 0;
+        for (std::uint32_t d = 0; ok && d < dependencyCount; ++d) {
+            Dependency& dependency = artifact.dependencies.emplace_back();
+            std::uint8_t isArtifact = 0;
+            ok = readValue(stream, isArtifact) && readValue(stream, dependency.node) && readValue(stream, dependency.hash);
+            dependency.artifact = isArtifact != 0;
+            const std::size_t limit = dependency.artifact ? artifactCount : sourceCount;
+            ok = ok && dependency.node < limit;
+        }
+    }
+    if (!ok) {
+        std::cerr << "[AssetDB] Database in " << m_cacheDirectory << " is truncated, rebuilding derived data" << std::endl;
+        return false;
+    }
+
+    {
+        std::unique_lock lock(m_mutex);
+        m_sources = std::move(sources);
+        m_artifacts = std::move(artifacts);
+        m_sourceIndex.clear();
+        m_artifactIndex.clear();
+        for (NodeIndex i = 0; i < m_sources.size(); ++i)
+            m_sourceIndex.emplace(m_sources[i].path, i);
+        for (NodeIndex i = 0; i < m_artifacts.size(); ++i) {
+            m_artifactIndex.emplace(m_artifacts[i].key, i);
+            for (const Dependency& dependency : m_artifacts[i].dependencies) {
+                if (dependency.artifact)
+                    m_artifacts[dependency.node].dependents.push_back(i);
+                else
+                    m_sources[dependency.node].dependents.push_back(i);
+            }
+        }
+    }
+
+    // Catch up with edits made while the engine was not running.
+    const std::size_t changed = refreshSources();
+
+    std::unique_lock lock(m_mutex);
+    std::vector<NodeIndex> stale;
+    for (NodeIndex i = 0; i < m_artifacts.size(); ++i) {
+        ArtifactRecord& artifact = m_artifacts[i];
+        artifact.valid = artifact.valid && checkArtifact(artifact);
+        if (!artifact.valid)
+            stale.insert(stale.end(), artifact.dependents.begin(), artifact.dependents.end());
+    }
+    invalidateDownstream(std::move(stale));
+
+    std::cout << "[AssetDB] Loaded " << m_artifacts.size() << " artifacts over " << m_sources.size() << " sources ("
+              << changed << " changed since last run)" << std::endl;
+    return true;
+}
+
+bool AssetDatabase::save() const
+{
+    std::error_code error;
+    std::filesystem::create_directories(m_cacheDirectory, error);
+    const std::filesystem::path target = m_cacheDirectory / kDatabaseFile;
+    const std::filesystem::path temporary = m_cacheDirectory / (std::string(kDatabaseFile) + ".tmp");
+
+    {
+        std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            std::cerr << "[AssetDB] Cannot write " << temporary << std::endl;
+            return false;
+        }
+
+        std::unique_lock lock(m_mutex);
+        stream.write(kDatabaseMagic, sizeof(kDatabaseMagic));
+        writeValue(stream, kDatabaseFormat);
+        writeValue(stream, kEngineVersion);
+        writeValue(stream, static_cast<std::uint32_t>(m_sources.size()));
+        for (const SourceRecord& source : m_sources) {
+            writeString(stream, source.path);
+            writeValue(stream, source.size);
+            writeValue(stream, source.modified);
+            writeValue(stream, source.hash);
+            writeValue(stream, static_cast<std::uint8_t>(source.readable));
+        }
+        writeValue(stream, static_cast<std::uint32_t>(m_artifacts.size()));
+        for (const ArtifactRecord& artifact : m_artifacts) {
+            writeString(stream, artifact.key);
+            writeString(stream, artifact.kind);
+            writeString(stream, artifact.source);
+            writeValue(stream, artifact.importerVersion);
+            writeValue(stream, artifact.generation);
+            writeValue(stream, static_cast<std::uint8_t>(artifact.valid));
+            writeValue(stream, static_cast<std::uint32_t>(artifact.dependencies.size()));
+            for (const Dependency& dependency : artifact.dependencies) {
+                writeValue(stream, static_cast<std::uint8_t>(dependency.artifact));
+                writeValue(stream, dependency.node);
+                writeValue(stream, dependency.hash);
+            }
+        }
+        if (!stream) {
+            std::cerr << "[AssetDB] Failed writing " << temporary << std::endl;
+            return false;
+        }
+    }
+
+    // Replace atomically so a crash mid-save leaves the previous database intact.
+    std::filesystem::rename(temporary, target, error);
+    if (error) {
+        std::cerr << "[AssetDB] Cannot replace " << target << ": " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+AssetDatabase::Stats AssetDatabase::stats() const
+{
+    std::unique_lock lock(m_mutex);
+    Stats current = m_stats;
+    current.sources = m_sources.size();
+    current.artifacts = m_artifacts.size();
+    current.validArtifacts = static_cast<std::size_t>(std::count_if(m_artifacts.begin(), m_artifacts.end(),
+        [this](const ArtifactRecord& artifact) {
+            return artifact.valid && artifact.importerVersion == importerVersion(artifact.kind);
+        }));
+    current.importsInFlight = m_inFlight.size();
+    return current;
+}
+
+void AssetDatabase::drawImGuiPanel()
+{
+    const Stats current = stats();
+    ImGui::Text("Cache: %s", m_cacheDirectory.string().c_str());
+    ImGui::Text("Artifacts: %zu (%zu valid) | Sources: %zu | Importing: %zu",
+        current.artifacts, current.validArtifacts, current.sources, current.importsInFlight);
+    ImGui::Text("Hashes: %llu computed (%.1f MiB), %llu cached",
+        static_cast<unsigned long long>(current.hashesComputed),
+        static_cast<double>(current.bytesHashed) / (1024.0 * 1024.0),
+        static_cast<unsigned long long>(current.hashCacheHits));
+    ImGui::Text("Imports: %llu run, %llu shared, %llu failed | Invalidations: %llu",
+        static_cast<unsigned long long>(current.importsRun),
+        static_cast<unsigned long long>(current.importsShared),
+        static_cast<unsigned long long>(current.importsFailed),
+        static_cast<unsigned long long>(current.invalidations));
+
+    if (ImGui::Button("Rescan Sources")) {
+        const std::size_t changed = refreshSources();
+        m_statusMessage = std::to_string(changed) + " source(s) changed";
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Save"))
+        m_statusMessage = save() ? "Saved" : "Save failed";
+    if (!m_statusMessage.empty()) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted(m_statusMessage.c_str());
+    }
+
+    ImGui::InputText("Filter", m_filterBuffer.data(), m_filterBuffer.size());
+    const std::string filter { m_filterBuffer.data() };
+    if (ImGui::BeginTable("AssetDatabaseArtifacts", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY, ImVec2(0.0f, 160.0f))) {
+        ImGui::TableSetupColumn("Kind");
+        ImGui::TableSetupColumn("Source");
+        ImGui::TableSetupColumn("Deps");
+        ImGui::TableSetupColumn("State");
+        ImGui::TableHeadersRow();
+
+        std::unique_lock lock(m_mutex);
+        for (const ArtifactRecord& artifact : m_artifacts) {
+            if (!filter.empty() && artifact.key.find(filter) == std::string::npos)
+                continue;
+            const bool valid = artifact.valid && artifact.importerVersion == importerVersion(artifact.kind);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(artifact.kind.c_str());
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(std::filesystem::path(artifact.source).filename().string().c_str());
+            if (ImGui::IsItemHovered())
+                ImGui::SetTooltip("%s", artifact.source.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", artifact.dependencies.size());
+            ImGui::TableNextColumn();
+            if (valid)
+                ImGui::Text("valid (gen %llu)", static_cast<unsigned long long>(artifact.generation));
+            else
+                ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "stale");
+        }
+        ImGui::EndTable();
+    }
+}
@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <framework/file_provider.h>
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Bookkeeping for derived data (baked IBL, imported meshes, compressed textures, ...). Source files
+// are identified by content hash, cached against size + mtime so unchanged files are never re-read.
+// Each artifact records the sources (and other artifacts) it was built from together with their hash
+// at build time and the version of the importer that built it. When a source changes every artifact
+// downstream of it is invalidated eagerly, so isValid() is a single lookup. Imports run on worker
+// threads and concurrent requests for the same artifact share one import. The graph persists in
+// `<cache directory>/assetdb.bin`, next to the artifact files importers write.
+class AssetDatabase {
+public:
+    // Bump to invalidate every artifact, e.g. when a shared derived-data format changes.
+    static constexpr std::uint32_t kEngineVersion = 1;
+
+    struct ArtifactKey {
+        std::string kind; // importer name, e.g. "ibl"
+        std::filesystem::path source; // primary source; always a dependency
+        std::uint64_t settingsHash { 0 }; // import settings that change the output
+
+        [[nodiscard]] std::string toString() const;
+    };
+
+    // Handed to an importer; collects what the artifact was built from.
+    class ImportContext {
+    public:
+        [[nodiscard]] const ArtifactKey& key() const { return m_key; }
+        // File the importer may write the artifact to (the directory exists).
+        [[nodiscard]] const std::filesystem::path& outputPath() const { return m_outputPath; }
+        void dependOn(const std::filesystem::path& source) { m_sources.push_back(source); }
+        void dependOnArtifact(const ArtifactKey& artifact) { m_artifacts.push_back(artifact); }
+
+    private:
+        friend class AssetDatabase;
+        ArtifactKey m_key;
+        std::filesystem::path m_outputPath;
+        std::vector<std::filesystem::path> m_sources;
+        std::vector<ArtifactKey> m_artifacts;
+    };
+    // Returns false when the import failed; the artifact then stays invalid.
+    using Importer = std::function<bool(ImportContext&)>;
+
+    struct Stats {
+        std::size_t sources { 0 };
+        std::size_t artifacts { 0 };
+        std::size_t validArtifacts { 0 };
+        std::size_t importsInFlight { 0 };
+        std::uint64_t hashesComputed { 0 };
+        std::uint64_t hashCacheHits { 0 };
+        std::uint64_t bytesHashed { 0 };
+        std::uint64_t importsRun { 0 };
+        std::uint64_t importsShared { 0 }; // requests that joined an import already in flight
+        std::uint64_t importsFailed { 0 };
+        std::uint64_t invalidations { 0 };
+    };
+
+    explicit AssetDatabase(std::filesystem::path cacheDirectory, unsigned workerThreads = 2);
+    ~AssetDatabase();
+
+    AssetDatabase(const AssetDatabase&) = delete;
+    AssetDatabase& operator=(const AssetDatabase&) = delete;
+
+    // Artifacts built by an older version of their importer are invalid.
+    void registerImporter(const std::string& kind, std::uint32_t version);
+
+    // Loads the persisted graph and re-checks it against the files on disk.
+    bool load();
+    bool save() const;
+
+    // Stable hash for import settings (ArtifactKey::settingsHash).
+    [[nodiscard]] static std::uint64_t hashSettings(std::string_view settings);
+
+    // Content hash of `source` (nullopt when it cannot be read). Re-reads the file only when its size
+    // or modification time changed since it was last hashed; callers that already hold the contents
+    // pass them in so the file is not read twice.
+    [[nodiscard]] std::optional<std::uint64_t> sourceHash(const std::filesystem::path& source, const FileData* contents = nullptr);
+    // Re-stats every known source and invalidates everything downstream of those that changed.
+    // Returns how many sources changed.
+    std::size_t refreshSources();
+
+    // O(1): valid as of the last import / refresh.
+    [[nodiscard]] bool isValid(const ArtifactKey& key) const;
+    [[nodiscard]] std::filesystem::path artifactPath(const ArtifactKey& key) const;
+    // Cache key that follows the source's content rather than its path, for in-memory caches.
+    [[nodiscard]] std::optional<std::string> contentKey(const ArtifactKey& key, const FileData* contents = nullptr);
+
+    // Runs `importer` on a worker thread unless the artifact is valid (the future is then ready) or
+    // an import of it is already running (the future is shared).
+    std::shared_future<bool> request(const ArtifactKey& key, Importer importer);
+    // Same, on the calling thread; for importers that need the GL context.
+    bool importNow(const ArtifactKey& key, const Importer& importer);
+    // Records an artifact built outside the database (e.g. a scene assembled by the loader).
+    void recordArtifact(const ArtifactKey& key, const std::vector<std::filesystem::path>& sources);
+    void invalidate(const ArtifactKey& key);
+
+    [[nodiscard]] Stats stats() const;
+    void drawImGuiPanel();
+
+private:
+    using NodeIndex = std::uint32_t;
+
+    struct SourceRecord {
+        std::string path;
+        std::uint64_t size { 0 };
+        std::int64_t modified { 0 }; // 0 for files that only exist in a mounted pack
+        std::uint64_t hash { 0 };
+        bool readable { false };
+        std::vector<NodeIndex> dependents; // artifacts
+    };
+
+    struct Dependency {
+        bool artifact { false };
+        NodeIndex node { 0 };
+        std::uint64_t hash { 0 }; // source hash, or the artifact's generation, at build time
+    };
+
+    struct ArtifactRecord {
+        std::string key;
+        std::string kind;
+        std::string source;
+        std::uint32_t importerVersion { 0 };
+        std::uint64_t generation { 0 }; // bumped on every successful import
+        std::vector<Dependency> dependencies;
+        std::vector<NodeIndex> dependents; // artifacts built from this one
+        bool valid { false };
+    };
+
+    struct Job {
+        ArtifactKey key;
+        Importer importer;
+        std::promise<bool> promise;
+    };
+
+    struct FileStamp {
+        std::uint64_t size { 0 };
+        std::int64_t modified { 0 };
+        bool onDisk { false };
+    };
+
+    [[nodiscard]] static std::string normalizePath(const std::filesystem::path& path);
+    [[nodiscard]] static FileStamp stampOf(const std::filesystem::path& path);
+    [[nodiscard]] static std::optional<std::uint64_t> hashFile(const std::filesystem::path& path, std::uint64_t& bytes);
+
+    // Re-hashes `path` if its stamp changed; `changed` reports whether the content hash moved.
+    std::optional<std::uint64_t> updateSource(const std::string& path, bool& changed, const FileData* contents = nullptr);
+    NodeIndex sourceNode(const std::string& path); // m_mutex held
+    NodeIndex artifactNode(const ArtifactKey& key, const std::string& keyString); // m_mutex held
+    void invalidateDownstream(std::vector<NodeIndex> artifacts); // m_mutex held
+    [[nodiscard]] bool checkArtifact(const ArtifactRecord& artifact) const; // m_mutex held
+    [[nodiscard]] std::uint32_t importerVersion(const std::string& kind) const; // m_mutex held
+
+    bool runImport(const ArtifactKey& key, const Importer& importer);
+    void commitImport(const ImportContext& context, bool succeeded);
+    void workerLoop();
+
+    std::filesystem::path m_cacheDirectory;
+
+    mutable std::mutex m_mutex;
+    std::vector<SourceRecord> m_sources;
+    std::unordered_map<std::string, NodeIndex> m_sourceIndex;
+    std::vector<ArtifactRecord> m_artifacts;
+    std::unordered_map<std::string, NodeIndex> m_artifactIndex;
+    std::unordered_map<std::string, std::uint32_t> m_importerVersions;
+    std::unordered_map<std::string, std::shared_future<bool>> m_inFlight;
+    Stats m_stats;
+
+    std::condition_variable m_jobsCv;
+    std::deque<std::unique_ptr<Job>> m_jobs;
+    bool m_stopping { false };
+    std::vector<std::thread> m_workers;
+
+    std::array<char, 128> m_filterBuffer { "" };
+    std::string m_statusMessage;
+};
@@ -0,0 +1,308 @@
+// SPDX-License-Identifier: MIT
+#include "io/AssetPack.h"
+
+#include "io/Lz4Block.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace asset_pack {
+
+std::uint64_t hashContent(const std::byte* data, std::size_t size)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<std::uint64_t>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace asset_pack
+
+namespace {
+
+std::uint64_t alignUp(std::uint64_t value, std::uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+bool AssetPack::open(const std::filesystem::path& file)
+{
+    using namespace asset_pack;
+
+    auto mapped = std::make_shared<MappedFile>();
+    if (!mapped->open(file)) {
+        m_lastError = mapped->lastError();
+        return false;
+    }
+
+    const std::byte* base = mapped->data();
+    const std::size_t size = mapped->size();
+    if (size < sizeof(Header)) {
+        m_lastError = "file is too small to be a pack";
+        return false;
+    }
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+        m_lastError = "not a version " + std::to_string(kVersion) + " asset pack";
+        return false;
+    }
+
+    const auto fits = [size](std::uint64_t offset, std::uint64_t bytes) { return offset <= size && bytes <= size - offset; };
+    if (!fits(header.entriesOffset, std::uint64_t { header.entryCount } * sizeof(Entry))
+        || !fits(header.blobsOffset, std::uint64_t { header.blobCount } * sizeof(Blob))
+        || !fits(header.stringsOffset, header.stringsSize)
+        || header.entriesOffset % alignof(Entry) != 0 || header.blobsOffset % alignof(Blob) != 0) {
+        m_lastError = "table of contents is out of bounds";
+        return false;
+    }
+
+    const auto* entries = reinterpret_cast<const Entry*>(base + header.entriesOffset);
+    const auto* blobs = reinterpret_cast<const Blob*>(base + header.blobsOffset);
+    // Validate once here so lookups and reads can trust the table afterwards.
+    std::uint32_t compressed = 0;
+    std::uint64_t rawBytes = 0;
+    for (std::uint32_t i = 0; i < header.blobCount; ++i) {
+        const Blob& blob = blobs[i];
+        const bool stored = blob.codec == static_cast<std::uint32_t>(Codec::Stored);
+        const bool lz4 = blob.codec == static_cast<std::uint32_t>(Codec::Lz4);
+        if ((!stored && !lz4) || !fits(blob.offset, blob.storedSize) || blob.rawSize > kMaxRawSize
+            || (stored && blob.storedSize != blob.rawSize)
+            || (lz4 && blob.rawSize > lz4_block::decompressBound(blob.storedSize))) {
+            m_lastError = "blob " + std::to_string(i) + " is corrupt";
+            return false;
+        }
+        compressed += lz4 ? 1u : 0u;
+        rawBytes += blob.rawSize;
+    }
+    for (std::uint32_t i = 0; i < header.entryCount; ++i) {
+        const Entry& entry = entries[i];
+        if (entry.blobIndex >= header.blobCount || std::uint64_t { entry.pathOffset } + entry.pathLength > header.stringsSize) {
+            m_lastError = "entry " + std::to_string(i) + " is corrupt";
+            return false;
+        }
+    }
+    // find() and range() binary search the table, so it has to be strictly sorted by path.
+    const char* strings = reinterpret_cast<const char*>(base + header.stringsOffset);
+    const auto entryPath = [strings](const Entry& entry) { return std::string_view(strings + entry.pathOffset, entry.pathLength); };
+    for (std::uint32_t i = 1; i < header.entryCount; ++i) {
+        if (!(entryPath(entries[i - 1]) < entryPath(entries[i]))) {
+            m_lastError = "entry " + std::to_string(i) + " is out of order";
+            return false;
+        }
+    }
+
+    m_entries = entries;
+    m_blobs = blobs;
+    m_strings = strings;
+    m_info.file = file;
+    m_info.fileSize = size;
+    m_info.entryCount = header.entryCount;
+    m_info.blobCount = header.blobCount;
+    m_info.compressedBlobs = compressed;
+    m_info.rawBytes = rawBytes;
+    m_file = std::move(mapped);
+    m_lastError.clear();
+    return true;
+}
+
+std::string_view AssetPack::path(const asset_pack::Entry& entry) const
+{
+    return { m_strings + entry.pathOffset, entry.pathLength };
+}
+
+const asset_pack::Blob& AssetPack::blob(const asset_pack::Entry& entry) const
+{
+    return m_blobs[entry.blobIndex];
+}
+
+const asset_pack::Entry* AssetPack::find(std::string_view key) const
+{
+    if (!m_file)
+        return nullptr;
+    const asset_pack::Entry* end = m_entries + m_info.entryCount;
+    const asset_pack::Entry* it = std::lower_bound(m_entries, end, key,
+        [this](const asset_pack::Entry& entry, std::string_view value) { return path(entry) < value; });
+    return (it != end && path(*it) == key) ? it : nullptr;
+}
+
+std::pair<const asset_pack::Entry*, const asset_pack::Entry*> AssetPack::range(std::string_view prefix) const
+{
+    if (!m_file)
+        return { nullptr, nullptr };
+    const asset_pack::Entry* end = m_entries + m_info.entryCount;
+    const asset_pack::Entry* first = std::lower_bound(m_entries, end, prefix,
+        [this](const asset_pack::Entry& entry, std::string_view value) { return path(entry) < value; });
+    const asset_pack::Entry* last = first;
+    while (last != end && path(*last).substr(0, prefix.size()) == prefix)
+        ++last;
+    return { first, last };
+}
+
+std::optional<FileData> AssetPack::read(const asset_pack::Entry& entry) const
+{
+    const asset_pack::Blob& source = blob(entry);
+    const std::byte* stored = m_file->data() + source.offset;
+    if (source.codec == static_cast<std::uint32_t>(asset_pack::Codec::Stored))
+        return FileData(stored, source.rawSize, m_file);
+
+    std::vector<std::byte> decoded(source.rawSize);
+    if (!lz4_block::decompress(stored, source.storedSize, decoded.data(), decoded.size()))
+        return std::nullopt;
+    return FileData::fromBuffer(std::move(decoded));
+}
+
+void AssetPack::prefetch(const asset_pack::Entry& entry) const
+{
+    const asset_pack::Blob& source = blob(entry);
+    m_file->willNeed(source.offset, source.storedSize);
+}
+
+void AssetPackWriter::addFile(std::string path, std::vector<std::byte> data)
+{
+    m_files.push_back({ std::move(path), std::move(data) });
+}
+
+bool AssetPackWriter::write(const std::filesystem::path& file, const Options& options, Result& result, std::string& error) const
+{
+    using namespace asset_pack;
+
+    if (options.alignment == 0 || (options.alignment & (options.alignment - 1)) != 0) {
+        error = "alignment must be a power of two";
+        return false;
+    }
+
+    // Sort by path; on duplicate paths the most recently added file wins.
+    std::vector<const PendingFile*> files;
+    files.reserve(m_files.size());
+    for (const PendingFile& pending : m_files)
+        files.push_back(&pending);
+    std::stable_sort(files.begin(), files.end(), [](const PendingFile* a, const PendingFile* b) { return a->path < b->path; });
+    std::vector<const PendingFile*> unique;
+    for (const PendingFile* pending : files) {
+        if (!unique.empty() && unique.back()->path == pending->path)
+            unique.back() = pending;
+        else
+            unique.push_back(pending);
+    }
+
+    struct PendingBlob {
+        const PendingFile* source { nullptr };
+        std::uint64_t hash { 0 };
+        std::vector<std::byte> compressed;
+        Codec codec { Codec::Stored };
+    };
+    std::vector<PendingBlob> blobs;
+    std::unordered_multimap<std::uint64_t, std::uint32_t> blobsByHash;
+    std::vector<Entry> entries;
+    std::string strings;
+    result = {};
+
+    for (const PendingFile* pending : unique) {
+        if (pending->data.size() > kMaxRawSize) {
+            error = pending->path + " is larger than a pack blob may be";
+            return false;
+        }
+        const std::uint64_t hash = hashContent(pending->data.data(), pending->data.size());
+        std::optional<std::uint32_t> blobIndex;
+        for (auto [it, end] = blobsByHash.equal_range(hash); it != end; ++it) {
+            if (blobs[it->second].source->data == pending->data) {
+                blobIndex = it->second;
+                break;
+            }
+        }
+        if (!blobIndex) {
+            PendingBlob blob;
+            blob.source = pending;
+            blob.hash = hash;
+            if (options.compress && !pending->data.empty()) {
+                lz4_block::compress(pending->data.data(), pending->data.size(), blob.compressed);
+                const auto threshold = static_cast<double>(pending->data.size()) * (1.0 - static_cast<double>(options.minCompressionSavings));
+                if (static_cast<double>(blob.compressed.size()) <= threshold)
+                    blob.codec = Codec::Lz4;
+                else
+                    blob.compressed.clear();
+            }
+            blobIndex = static_cast<std::uint32_t>(blobs.size());
+            blobsByHash.emplace(hash, *blobIndex);
+            result.uniqueBytes += pending->data.size();
+            result.compressedBlobs += blob.codec == Codec::Lz4 ? 1u : 0u;
+            blobs.push_back(std::move(blob));
+        }
+
+        Entry entry {};
+        entry.pathOffset = static_cast<std::uint32_t>(strings.size());
+        entry.pathLength = static_cast<std::uint32_t>(pending->path.size());
+        entry.blobIndex = *blobIndex;
+        entries.push_back(entry);
+        strings += pending->path;
+        result.rawBytes += pending->data.size();
+    }
+
+    Header header {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.entryCount = static_cast<std::uint32_t>(entries.size());
+    header.blobCount = static_cast<std::uint32_t>(blobs.size());
+    header.alignment = options.alignment;
+    header.entriesOffset = sizeof(Header);
+    header.blobsOffset = alignUp(header.entriesOffset + entries.size() * sizeof(Entry), alignof(Blob));
+    header.stringsOffset = header.blobsOffset + blobs.size() * sizeof(Blob);
+    header.stringsSize = strings.size();
+
+    std::vector<Blob> blobTable(blobs.size());
+    std::uint64_t cursor = header.stringsOffset + header.stringsSize;
+    for (std::size_t i = 0; i < blobs.size(); ++i) {
+        const PendingBlob& pending = blobs[i];
+        cursor = alignUp(cursor, options.alignment);
+        Blob& blob = blobTable[i];
+        blob.contentHash = pending.hash;
+        blob.offset = cursor;
+        blob.rawSize = pending.source->data.size();
+        blob.codec = static_cast<std::uint32_t>(pending.codec);
+        blob.storedSize = pending.codec == Codec::Lz4 ? pending.compressed.size() : blob.rawSize;
+        cursor += blob.storedSize;
+    }
+
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot open " + file.string() + " for writing";
+        return false;
+    }
+    std::uint64_t written = 0;
+    const auto put = [&](const void* data, std::uint64_t bytes) {
+        out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        written += bytes;
+    };
+    const auto padTo = [&](std::uint64_t offset) {
+        static constexpr char zeros[256] {};
+        while (written < offset)
+            put(zeros, std::min<std::uint64_t>(sizeof(zeros), offset - written));
+    };
+
+    put(&header, sizeof(header));
+    put(entries.data(), entries.size() * sizeof(Entry));
+    padTo(header.blobsOffset);
+    put(blobTable.data(), blobTable.size() * sizeof(Blob));
+    put(strings.data(), strings.size());
+    for (std::size_t i = 0; i < blobs.size(); ++i) {
+        padTo(blobTable[i].offset);
+        const std::vector<std::byte>& bytes = blobs[i].codec == Codec::Lz4 ? blobs[i].compressed : blobs[i].source->data;
+        put(bytes.data(), bytes.size());
+    }
+    if (!out) {
+        error = "failed writing " + file.string();
+        return false;
+    }
+
+    result.files = header.entryCount;
+    result.blobs = header.blobCount;
+    result.packBytes = written;
+    return true;
+}
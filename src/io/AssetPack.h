@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "io/MappedFile.h"
+
+#include <framework/file_provider.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// On-disk layout of a .dpak archive (little endian):
+//
+//   Header | Entry[entryCount] (sorted by path) | Blob[blobCount] | path strings | blob data
+//
+// Entries map a '/'-separated path relative to the asset root onto a blob. Blobs are content
+// addressed: identical files share one blob. Every blob starts on an `alignment` boundary and is
+// either stored as-is, so a read is a pointer into the mapping, or LZ4 block compressed.
+namespace asset_pack {
+
+inline constexpr char kMagic[4] = { 'D', 'P', 'A', 'K' };
+inline constexpr std::uint32_t kVersion = 1u;
+// Packs holding a larger blob are rejected; read() allocates rawSize bytes up front.
+inline constexpr std::uint64_t kMaxRawSize = 1ull << 30;
+
+enum class Codec : std::uint32_t {
+    Stored = 0,
+    Lz4 = 1
+};
+
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t entryCount;
+    std::uint32_t blobCount;
+    std::uint32_t alignment;
+    std::uint32_t reserved;
+    std::uint64_t entriesOffset;
+    std::uint64_t blobsOffset;
+    std::uint64_t stringsOffset;
+    std::uint64_t stringsSize;
+};
+
+struct Entry {
+    std::uint32_t pathOffset; // into the string table
+    std::uint32_t pathLength;
+    std::uint32_t blobIndex;
+    std::uint32_t reserved;
+};
+
+struct Blob {
+    std::uint64_t contentHash; // FNV-1a 64 of the raw bytes
+    std::uint64_t offset;
+    std::uint64_t storedSize;
+    std::uint64_t rawSize;
+    std::uint32_t codec;
+    std::uint32_t reserved;
+};
+
+[[nodiscard]] std::uint64_t hashContent(const std::byte* data, std::size_t size);
+
+} // namespace asset_pack
+
+// A mounted .dpak archive. Lookups are a binary search over the mapped table of contents; nothing is
+// copied at mount time.
+class AssetPack {
+public:
+    struct Info {
+        std::filesystem::path file;
+        std::size_t fileSize { 0 };
+        std::uint32_t entryCount { 0 };
+        std::uint32_t blobCount { 0 };
+        std::uint32_t compressedBlobs { 0 };
+        std::uint64_t rawBytes { 0 };
+    };
+
+    bool open(const std::filesystem::path& file);
+
+    [[nodiscard]] const asset_pack::Entry* find(std::string_view path) const;
+    [[nodiscard]] std::string_view path(const asset_pack::Entry& entry) const;
+    [[nodiscard]] const asset_pack::Blob& blob(const asset_pack::Entry& entry) const;
+    // Stored blobs are returned as views into the mapping (the FileData keeps the mapping alive);
+    // compressed ones are decoded into a new buffer.
+    [[nodiscard]] std::optional<FileData> read(const asset_pack::Entry& entry) const;
+    // Starts paging the entry's blob in from disk without blocking.
+    void prefetch(const asset_pack::Entry& entry) const;
+    // Entries whose path starts with `prefix`, in path order.
+    [[nodiscard]] std::pair<const asset_pack::Entry*, const asset_pack::Entry*> range(std::string_view prefix) const;
+
+    [[nodiscard]] const Info& info() const { return m_info; }
+    [[nodiscard]] const std::string& lastError() const { return m_lastError; }
+
+private:
+    std::shared_ptr<MappedFile> m_file;
+    const asset_pack::Entry* m_entries { nullptr };
+    const asset_pack::Blob* m_blobs { nullptr };
+    const char* m_strings { nullptr };
+    Info m_info;
+    std::string m_lastError;
+};
+
+// Builds a .dpak from in-memory files; used by the packer tool.
+class AssetPackWriter {
+public:
+    struct Options {
+        std::uint32_t alignment { 64 };
+        bool compress { true };
+        float minCompressionSavings { 0.1f }; // keep a blob stored unless LZ4 saves at least this fraction
+    };
+
+    struct Result {
+        std::uint32_t files { 0 };
+        std::uint32_t blobs { 0 };
+        std::uint32_t compressedBlobs { 0 };
+        std::uint64_t rawBytes { 0 };
+        std::uint64_t uniqueBytes { 0 };
+        std::uint64_t packBytes { 0 };
+    };
+
+    // `path` is the '/'-separated lookup key. Adding the same path twice replaces the earlier data.
+    void addFile(std::string path, std::vector<std::byte> data);
+    bool write(const std::filesystem::path& file, const Options& options, Result& result, std::string& error) const;
+
+private:
+    struct PendingFile {
+        std::string path;
+        std::vector<std::byte> data;
+    };
+    std::vector<PendingFile> m_files;
+};
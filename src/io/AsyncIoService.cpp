@@ -0,0 +1,927 @@
+// SPDX-License-Identifier: MIT
+#include "io/AsyncIoService.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+#include <framework/log.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define DAEDALUS_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ---------------- Buffer pool ----------------
+
+namespace {
+
+std::byte* alignedAllocate(std::size_t size, std::size_t alignment)
+{
+#ifdef _WIN32
+    return static_cast<std::byte*>(_aligned_malloc(size, alignment));
+#else
+    return static_cast<std::byte*>(std::aligned_alloc(alignment, size));
+#endif
+}
+
+void alignedFree(std::byte* data)
+{
+#ifdef _WIN32
+    _aligned_free(data);
+#else
+    std::free(data);
+#endif
+}
+
+} // namespace
+
+struct IoBuffer::PoolState {
+    std::mutex mutex;
+    std::unordered_map<std::size_t, std::vector<std::byte*>> freeLists; // by capacity
+    std::size_t cachedBytes { 0 };
+    std::size_t maxCachedBytes { 0 };
+
+    ~PoolState()
+    {
+        for (auto& [capacity, buffers] : freeLists) {
+            for (std::byte* buffer : buffers)
+                alignedFree(buffer);
+        }
+    }
+};
+
+IoBuffer::IoBuffer(std::byte* data, std::size_t capacity, std::shared_ptr<PoolState> pool)
+    : m_data(data)
+    , m_capacity(capacity)
+    , m_pool(std::move(pool))
+{
+}
+
+IoBuffer::~IoBuffer()
+{
+    release();
+}
+
+IoBuffer::IoBuffer(IoBuffer&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr))
+    , m_capacity(std::exchange(other.m_capacity, 0))
+    , m_pool(std::move(other.m_pool))
+{
+}
+
+IoBuffer& IoBuffer::operator=(IoBuffer&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_capacity = std::exchange(other.m_capacity, 0);
+        m_pool = std::move(other.m_pool);
+    }
+    return *this;
+}
+
+void IoBuffer::release()
+{
+    if (!m_data)
+        return;
+    bool cached = false;
+    if (m_pool) {
+        std::lock_guard lock(m_pool->mutex);
+        if (m_pool->cachedBytes + m_capacity <= m_pool->maxCachedBytes) {
+            m_pool->freeLists[m_capacity].push_back(m_data);
+            m_pool->cachedBytes += m_capacity;
+            cached = true;
+        }
+    }
+    if (!cached)
+        alignedFree(m_data);
+    m_data = nullptr;
+    m_capacity = 0;
+    m_pool.reset();
+}
+
+IoBufferPool::IoBufferPool(std::size_t maxCachedBytes)
+    : m_state(std::make_shared<IoBuffer::PoolState>())
+{
+    m_state->maxCachedBytes = maxCachedBytes;
+}
+
+IoBufferPool::~IoBufferPool() = default;
+
+IoBuffer IoBufferPool::acquire(std::size_t size)
+{
+    std::size_t capacity = kMinBufferSize;
+    while (capacity < size)
+        capacity *= 2;
+
+    {
+        std::lock_guard lock(m_state->mutex);
+        auto it = m_state->freeLists.find(capacity);
+        if (it != m_state->freeLists.end() && !it->second.empty()) {
+            std::byte* data = it->second.back();
+            it->second.pop_back();
+            m_state->cachedBytes -= capacity;
+            return IoBuffer(data, capacity, m_state);
+        }
+    }
+    std::byte* data = alignedAllocate(capacity, kAlignment);
+    if (!data)
+        return {};
+    return IoBuffer(data, capacity, m_state);
+}
+
+std::size_t IoBufferPool::cachedBytes() const
+{
+    std::lock_guard lock(m_state->mutex);
+    return m_state->cachedBytes;
+}
+
+// ---------------- io_uring ring ----------------
+
+#ifdef DAEDALUS_HAS_IO_URING
+
+namespace {
+
+constexpr std::uint64_t kWakeTag = ~0ull;
+constexpr std::uint64_t kCancelTag = ~0ull - 1;
+
+int ioUringSetup(unsigned entries, io_uring_params* params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned count)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+} // namespace
+
+// Raw io_uring (no liburing): one submission queue owned by the I/O thread.
+struct AsyncIoService::Ring {
+    int fd { -1 };
+    void* sqMapping { nullptr };
+    std::size_t sqMappingSize { 0 };
+    void* cqMapping { nullptr };
+    std::size_t cqMappingSize { 0 };
+    io_uring_sqe* sqes { nullptr };
+    std::size_t sqesSize { 0 };
+
+    unsigned* sqHead { nullptr };
+    unsigned* sqTail { nullptr };
+    unsigned sqMask { 0 };
+    unsigned* sqArray { nullptr };
+    unsigned sqEntries { 0 };
+    unsigned localTail { 0 }; // SQEs written but not yet published to the kernel
+    unsigned publishedTail { 0 };
+
+    unsigned* cqHead { nullptr };
+    unsigned* cqTail { nullptr };
+    unsigned cqMask { 0 };
+    io_uring_cqe* cqes { nullptr };
+
+    std::uint64_t wakeValue { 0 };
+
+    ~Ring()
+    {
+        if (sqes)
+            munmap(sqes, sqesSize);
+        if (cqMapping && cqMapping != sqMapping)
+            munmap(cqMapping, cqMappingSize);
+        if (sqMapping)
+            munmap(sqMapping, sqMappingSize);
+        if (fd >= 0)
+            close(fd);
+    }
+
+    bool init(unsigned entries, std::string& error)
+    {
+        io_uring_params params {};
+        fd = ioUringSetup(entries, &params);
+        if (fd < 0) {
+            error = std::string("io_uring_setup: ") + std::strerror(errno);
+            return false;
+        }
+
+        sqMappingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqMappingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMapping)
+            sqMappingSize = cqMappingSize = std::max(sqMappingSize, cqMappingSize);
+
+        sqMapping = mmap(nullptr, sqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqMapping == MAP_FAILED) {
+            sqMapping = nullptr;
+            error = "mmap of the submission ring failed";
+            return false;
+        }
+        if (singleMapping) {
+            cqMapping = sqMapping;
+        } else {
+            cqMapping = mmap(nullptr, cqMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cqMapping == MAP_FAILED) {
+                cqMapping = nullptr;
+                error = "mmap of the completion ring failed";
+                return false;
+            }
+        }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqeMapping = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqeMapping == MAP_FAILED) {
+            error = "mmap of the submission entries failed";
+            return false;
+        }
+        sqes = static_cast<io_uring_sqe*>(sqeMapping);
+
+        auto* sq = static_cast<char*>(sqMapping);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqEntries = params.sq_entries;
+        localTail = publishedTail = *sqTail;
+
+        auto* cq = static_cast<char*>(cqMapping);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // IORING_OP_READ needs Linux 5.6; older kernels get the thread pool.
+        std::vector<std::byte> probeStorage(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+        auto* probe = reinterpret_cast<io_uring_probe*>(probeStorage.data());
+        if (ioUringRegister(fd, IORING_REGISTER_PROBE, probe, 256) < 0 || probe->last_op < IORING_OP_READ
+            || (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) == 0) {
+            error = "kernel lacks IORING_OP_READ";
+            return false;
+        }
+        return true;
+    }
+
+    io_uring_sqe* nextSqe()
+    {
+        const unsigned head = std::atomic_ref<unsigned>(*sqHead).load(std::memory_order_acquire);
+        if (localTail - head >= sqEntries)
+            return nullptr;
+        const unsigned index = localTail & sqMask;
+        sqArray[index] = index;
+        ++localTail;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        return sqe;
+    }
+
+    // Publishes queued SQEs and waits for at least `minComplete` completions. Entries the kernel did
+    // not consume (EAGAIN, EBUSY) stay queued and are offered again by the next call.
+    int submitAndWait(unsigned minComplete)
+    {
+        std::atomic_ref<unsigned>(*sqTail).store(localTail, std::memory_order_release);
+        publishedTail = localTail;
+        const unsigned toSubmit = localTail - std::atomic_ref<unsigned>(*sqHead).load(std::memory_order_acquire);
+        int result = 0;
+        do {
+            result = ioUringEnter(fd, toSubmit, minComplete, minComplete > 0 ? IORING_ENTER_GETEVENTS : 0);
+        } while (result < 0 && errno == EINTR);
+        return result;
+    }
+
+    template <typename Fn>
+    void reap(Fn&& handle)
+    {
+        unsigned head = *cqHead;
+        const unsigned tail = std::atomic_ref<unsigned>(*cqTail).load(std::memory_order_acquire);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes[head & cqMask];
+            handle(cqe.user_data, cqe.res);
+            ++head;
+        }
+        std::atomic_ref<unsigned>(*cqHead).store(head, std::memory_order_release);
+    }
+};
+
+#else
+
+struct AsyncIoService::Ring {
+};
+
+#endif
+
+// ---------------- Service ----------------
+
+AsyncIoService::AsyncIoService()
+    : AsyncIoService(Settings {})
+{
+}
+
+AsyncIoService::AsyncIoService(const Settings& settings)
+    : m_settings(settings)
+{
+    m_settings.queueDepth = std::clamp(m_settings.queueDepth, 1u, 4096u);
+    m_settings.workerThreads = std::clamp(m_settings.workerThreads, 1u, 32u);
+    if (!(m_settings.preferIoUring && startIoUring()))
+        startThreadPool();
+}
+
+AsyncIoService::~AsyncIoService()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_pendingCv.notify_all();
+    wakeIoThread();
+    for (std::thread& thread : m_threads)
+        thread.join();
+#ifdef DAEDALUS_HAS_IO_URING
+    if (m_wakeFd >= 0)
+        close(m_wakeFd);
+#endif
+}
+
+bool AsyncIoService::startIoUring()
+{
+#ifdef DAEDALUS_HAS_IO_URING
+    auto ring = std::make_unique<Ring>();
+    std::string error;
+    // One extra entry for the wake-up read that is always armed.
+    if (!ring->init(m_settings.queueDepth + 1, error)) {
+        LOG_INFO(logging::Category::General, "[AsyncIO] io_uring unavailable ({}), using {} I/O threads", error, m_settings.workerThreads);
+        return false;
+    }
+    m_wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (m_wakeFd < 0) {
+        LOG_INFO(logging::Category::General, "[AsyncIO] eventfd failed, using I/O threads");
+        return false;
+    }
+    m_ring = std::move(ring);
+    m_backend = Backend::IoUring;
+    m_threads.emplace_back([this]() { ioUringLoop(); });
+    LOG_INFO(logging::Category::General, "[AsyncIO] io_uring backend, queue depth {}", m_settings.queueDepth);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AsyncIoService::startThreadPool()
+{
+    m_backend = Backend::ThreadPool;
+    for (unsigned i = 0; i < m_settings.workerThreads; ++i)
+        m_threads.emplace_back([this]() { workerLoop(); });
+}
+
+void AsyncIoService::wakeIoThread()
+{
+#ifdef DAEDALUS_HAS_IO_URING
+    if (m_wakeFd >= 0) {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const ssize_t written = ::write(m_wakeFd, &one, sizeof(one));
+    }
+#endif
+}
+
+AsyncIoService::RequestId AsyncIoService::submit(ReadRequest request)
+{
+    std::vector<ReadRequest> batch;
+    batch.push_back(std::move(request));
+    return submitBatch(std::move(batch)).front();
+}
+
+std::vector<AsyncIoService::RequestId> AsyncIoService::submitBatch(std::vector<ReadRequest> requests)
+{
+    std::vector<RequestId> ids;
+    ids.reserve(requests.size());
+    const auto now = std::chrono::steady_clock::now();
+    {
+        std::lock_guard lock(m_mutex);
+        for (ReadRequest& request : requests) {
+            auto op = std::make_unique<Operation>();
+            op->id = m_nextId++;
+            op->submitted = now;
+            op->request = std::move(request);
+            ids.push_back(op->id);
+            m_pending[static_cast<std::size_t>(op->request.priority)].push_back(std::move(op));
+        }
+        const std::size_t depth = m_pending[0].size() + m_pending[1].size() + m_inFlight.size();
+        m_peakQueueDepth = std::max(m_peakQueueDepth, depth);
+    }
+    // Both: the io_uring thread may have handed over to the thread pool since the last check.
+    wakeIoThread();
+    m_pendingCv.notify_all();
+    return ids;
+}
+
+void AsyncIoService::post(std::function<void()> callback)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        Finished finished;
+        finished.posted = std::move(callback);
+        m_finished.push_back(std::move(finished));
+    }
+    m_finishedCv.notify_all();
+}
+
+bool AsyncIoService::cancel(RequestId id)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        for (auto& queue : m_pending) {
+            auto it = std::find_if(queue.begin(), queue.end(), [id](const auto& op) { return op->id == id; });
+            if (it == queue.end())
+                continue;
+            Finished finished;
+            finished.completion.id = id;
+            finished.completion.path = (*it)->request.path;
+            finished.completion.priority = (*it)->request.priority;
+            finished.completion.status = Status::Cancelled;
+            finished.callback = std::move((*it)->request.callback);
+#ifndef _WIN32
+            if ((*it)->fd >= 0)
+                ::close((*it)->fd); // handed back by a failed io_uring
+#endif
+            m_cancelled.erase(id);
+            queue.erase(it);
+            m_finished.push_back(std::move(finished));
+            m_finishedCv.notify_all();
+            return true;
+        }
+        if (m_inFlight.count(id) == 0)
+            return false;
+        m_cancelled.insert(id);
+    }
+    wakeIoThread(); // so the read is cancelled in the kernel too
+    return true;
+}
+
+std::unique_ptr<AsyncIoService::Operation> AsyncIoService::popPending()
+{
+    std::lock_guard lock(m_mutex);
+    for (auto& queue : m_pending) {
+        if (queue.empty())
+            continue;
+        std::unique_ptr<Operation> op = std::move(queue.front());
+        queue.pop_front();
+        m_inFlight.insert(op->id);
+        return op;
+    }
+    return nullptr;
+}
+
+bool AsyncIoService::prepare(Operation& op)
+{
+    if (op.prepared)
+        return true; // handed over from io_uring with its file and destination
+    op.prepared = true;
+    std::uint64_t fileSize = 0;
+#ifdef _WIN32
+    std::error_code error;
+    fileSize = std::filesystem::file_size(op.request.path, error);
+    if (error) {
+        finish(std::unique_ptr<Operation>(&op), Status::Failed, ENOENT);
+        return false;
+    }
+#else
+    op.fd = ::open(op.request.path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat info {};
+    if (op.fd < 0 || fstat(op.fd, &info) != 0) {
+        finish(std::unique_ptr<Operation>(&op), Status::Failed, errno);
+        return false;
+    }
+    fileSize = static_cast<std::uint64_t>(info.st_size);
+#endif
+    if (op.request.offset > fileSize) {
+        finish(std::unique_ptr<Operation>(&op), Status::Failed, EINVAL);
+        return false;
+    }
+    const std::uint64_t available = fileSize - op.request.offset;
+    if (op.request.destination.empty()) {
+        op.length = static_cast<std::size_t>(available);
+        op.buffer = m_bufferPool.acquire(std::max<std::size_t>(op.length, 1));
+        if (!op.buffer) {
+            finish(std::unique_ptr<Operation>(&op), Status::Failed, ENOMEM);
+            return false;
+        }
+        op.target = { op.buffer.data(), op.length };
+    } else {
+        op.length = static_cast<std::size_t>(std::min<std::uint64_t>(op.request.destination.size(), available));
+        op.target = op.request.destination.first(op.length);
+    }
+    return true;
+}
+
+void AsyncIoService::finish(std::unique_ptr<Operation> op, Status status, int error)
+{
+#ifndef _WIN32
+    if (op->fd >= 0)
+        ::close(op->fd);
+    op->fd = -1;
+#endif
+    Finished finished;
+    Completion& completion = finished.completion;
+    completion.id = op->id;
+    completion.path = std::move(op->request.path);
+    completion.priority = op->request.priority;
+    completion.error = error;
+    completion.latencyMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - op->submitted).count();
+    finished.callback = std::move(op->request.callback);
+
+    std::lock_guard lock(m_mutex);
+    if (m_cancelled.erase(op->id) > 0)
+        status = Status::Cancelled;
+    m_inFlight.erase(op->id);
+    completion.status = status;
+    if (status == Status::Ok) {
+        completion.data = op->target.first(op->done);
+        completion.buffer = std::move(op->buffer);
+    }
+    m_finished.push_back(std::move(finished));
+    m_finishedCv.notify_all();
+}
+
+void AsyncIoService::ioUringLoop()
+{
+#ifdef DAEDALUS_HAS_IO_URING
+    Ring& ring = *m_ring;
+    std::unordered_map<RequestId, std::unique_ptr<Operation>> active;
+    // Reads and cancels that found the submission queue full even after submitting; retried next turn.
+    std::vector<Operation*> unqueuedReads;
+    std::vector<RequestId> unqueuedCancels;
+    bool wakeArmed = false;
+
+    const auto acquireSqe = [&]() {
+        io_uring_sqe* sqe = ring.nextSqe();
+        if (!sqe && ring.submitAndWait(0) >= 0)
+            sqe = ring.nextSqe();
+        return sqe;
+    };
+    const auto armWake = [&]() {
+        io_uring_sqe* sqe = acquireSqe();
+        wakeArmed = sqe != nullptr;
+        if (!sqe)
+            return;
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = m_wakeFd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(&ring.wakeValue);
+        sqe->len = sizeof(ring.wakeValue);
+        sqe->user_data = kWakeTag;
+    };
+    const auto queueRead = [&](Operation& op) {
+        io_uring_sqe* sqe = acquireSqe();
+        if (!sqe) {
+            unqueuedReads.push_back(&op);
+            return;
+        }
+        const std::size_t remaining = op.length - op.done;
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = op.fd;
+        sqe->addr = reinterpret_cast<std::uint64_t>(op.target.data() + op.done);
+        sqe->len = static_cast<unsigned>(std::min<std::size_t>(remaining, 1u << 30));
+        sqe->off = op.request.offset + op.done;
+        sqe->user_data = op.id;
+    };
+    // The read then completes with -ECANCELED, or normally if the kernel was already done with it.
+    const auto queueCancel = [&](RequestId id) {
+        io_uring_sqe* sqe = acquireSqe();
+        if (!sqe) {
+            unqueuedCancels.push_back(id);
+            return;
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = id;
+        sqe->user_data = kCancelTag;
+    };
+
+    armWake();
+    while (true) {
+        bool stopping = false;
+        std::vector<RequestId> cancels;
+        {
+            std::lock_guard lock(m_mutex);
+            stopping = m_stopping;
+            for (const RequestId id : m_cancelled) {
+                auto it = active.find(id);
+                if (it != active.end() && !it->second->cancelSubmitted) {
+                    it->second->cancelSubmitted = true;
+                    cancels.push_back(id);
+                }
+            }
+        }
+        if (stopping && active.empty())
+            break;
+
+        if (!wakeArmed)
+            armWake();
+        for (const RequestId id : std::exchange(unqueuedCancels, {}))
+            queueCancel(id);
+        for (Operation* op : std::exchange(unqueuedReads, {}))
+            queueRead(*op);
+        for (const RequestId id : cancels)
+            queueCancel(id);
+
+        while (!stopping && active.size() < m_settings.queueDepth) {
+            std::unique_ptr<Operation> op = popPending();
+            if (!op)
+                break;
+            Operation* raw = op.release();
+            if (!prepare(*raw))
+                continue; // prepare() finished (and freed) it
+            if (raw->length == 0) {
+                finish(std::unique_ptr<Operation>(raw), Status::Ok, 0);
+                continue;
+            }
+            queueRead(*raw);
+            active.emplace(raw->id, std::unique_ptr<Operation>(raw));
+        }
+
+        // With work left over for lack of SQEs, only submit; waiting could block with nothing armed.
+        const bool backlog = !wakeArmed || !unqueuedReads.empty() || !unqueuedCancels.empty();
+        if (ring.submitAndWait(backlog ? 0 : 1) < 0) {
+            const int error = errno;
+            if (error != EAGAIN && error != EBUSY) {
+                // The ring is unusable: hand everything to blocking reads so no request is lost and
+                // wait() keeps returning. The kernel may still write its in-flight reads, but only the
+                // same bytes into the same destinations.
+                LOG_ERROR(logging::Category::General, "[AsyncIO] io_uring_enter failed: {}; handing {} reads to I/O threads",
+                    std::strerror(error), active.size());
+                {
+                    std::lock_guard lock(m_mutex);
+                    for (auto& [id, op] : active) {
+                        m_inFlight.erase(id);
+                        op->done = 0;
+                        m_pending[static_cast<std::size_t>(op->request.priority)].push_front(std::move(op));
+                    }
+                    m_backend = Backend::ThreadPool;
+                }
+                active.clear();
+                runThreadPoolFallback();
+                return;
+            }
+            // Out of kernel resources or the completion queue is full: reap, then try again.
+        }
+
+        ring.reap([&](std::uint64_t userData, int result) {
+            if (userData == kWakeTag) {
+                armWake();
+                return;
+            }
+            auto it = active.find(userData);
+            if (it == active.end())
+                return; // kCancelTag, or a read that already finished
+            Operation& op = *it->second;
+            bool cancelled = false;
+            {
+                std::lock_guard lock(m_mutex);
+                cancelled = m_cancelled.count(op.id) > 0;
+            }
+            if (result == -EINTR || result == -EAGAIN) {
+                if (!cancelled) {
+                    queueRead(op);
+                    return;
+                }
+            } else if (result > 0) {
+                op.done += static_cast<std::size_t>(result);
+                if (op.done < op.length && !cancelled) {
+                    queueRead(op); // short read: continue where it stopped
+                    return;
+                }
+            }
+            std::unique_ptr<Operation> owned = std::move(it->second);
+            active.erase(it);
+            std::erase(unqueuedReads, owned.get());
+            if (result < 0 && !cancelled)
+                finish(std::move(owned), Status::Failed, -result);
+            else
+                finish(std::move(owned), Status::Ok, 0); // result == 0 is end of file
+        });
+    }
+
+    // Anything still queued is dropped on shutdown without running callbacks.
+    for (auto& [id, op] : active) {
+        if (op->fd >= 0)
+            ::close(op->fd);
+    }
+#endif
+}
+
+void AsyncIoService::runThreadPoolFallback()
+{
+    // Joined here rather than by the destructor, which may already be iterating m_threads.
+    std::vector<std::thread> helpers;
+    for (unsigned i = 1; i < m_settings.workerThreads; ++i)
+        helpers.emplace_back([this]() { workerLoop(); });
+    m_pendingCv.notify_all();
+    workerLoop();
+    for (std::thread& helper : helpers)
+        helper.join();
+}
+
+void AsyncIoService::workerLoop()
+{
+    while (true) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_pendingCv.wait(lock, [this]() { return m_stopping || !m_pending[0].empty() || !m_pending[1].empty(); });
+            if (m_stopping)
+                return;
+        }
+        std::unique_ptr<Operation> op = popPending();
+        if (!op)
+            continue;
+        Operation* raw = op.release();
+        if (!prepare(*raw))
+            continue;
+        std::unique_ptr<Operation> owned(raw);
+
+        int error = 0;
+#ifdef _WIN32
+        std::ifstream file(owned->request.path, std::ios::binary);
+        file.seekg(static_cast<std::streamoff>(owned->request.offset));
+        file.read(reinterpret_cast<char*>(owned->target.data()), static_cast<std::streamsize>(owned->length));
+        owned->done = static_cast<std::size_t>(file.gcount());
+        if (owned->done < owned->length && file.bad())
+            error = EIO;
+#else
+        while (owned->done < owned->length) {
+            {
+                std::lock_guard lock(m_mutex);
+                if (m_cancelled.count(owned->id) > 0)
+                    break;
+            }
+            const std::size_t chunk = std::min<std::size_t>(owned->length - owned->done, 8u << 20);
+            const ssize_t result = pread(owned->fd, owned->target.data() + owned->done, chunk,
+                static_cast<off_t>(owned->request.offset + owned->done));
+            if (result < 0 && errno == EINTR)
+                continue;
+            if (result < 0) {
+                error = errno;
+                break;
+            }
+            if (result == 0)
+                break;
+            owned->done += static_cast<std::size_t>(result);
+        }
+#endif
+        finish(std::move(owned), error ? Status::Failed : Status::Ok, error);
+    }
+}
+
+void AsyncIoService::runFinished(Finished& finished)
+{
+    if (finished.posted) {
+        finished.posted();
+        return;
+    }
+
+    Completion& completion = finished.completion;
+    {
+        std::lock_guard lock(m_mutex);
+        switch (completion.status) {
+        case Status::Ok:
+            ++m_completed;
+            m_bytesRead += completion.data.size();
+            m_recentBytes.emplace_back(std::chrono::steady_clock::now(), completion.data.size());
+            m_avgLatencyMs = m_completed == 1 ? completion.latencyMs : m_avgLatencyMs * 0.9f + completion.latencyMs * 0.1f;
+            break;
+        case Status::Failed:
+            ++m_failed;
+            break;
+        case Status::Cancelled:
+            ++m_cancelledCount;
+            break;
+        }
+    }
+    if (completion.status == Status::Ok) {
+        m_requestsCounter.add();
+        m_bytesCounter.add(completion.data.size());
+    }
+    if (finished.callback)
+        finished.callback(completion);
+}
+
+std::size_t AsyncIoService::pollCompletions(std::size_t maxCompletions)
+{
+    std::vector<Finished> ready;
+    {
+        std::lock_guard lock(m_mutex);
+        while (!m_finished.empty() && ready.size() < maxCompletions) {
+            ready.push_back(std::move(m_finished.front()));
+            m_finished.pop_front();
+        }
+    }
+    for (Finished& finished : ready)
+        runFinished(finished);
+
+    const Stats current = stats();
+    m_queueDepthGauge.set(static_cast<double>(current.queuedVisible + current.queuedPrefetch));
+    m_inFlightGauge.set(static_cast<double>(current.inFlight));
+    m_throughputGauge.set(current.throughputMBs);
+    return ready.size();
+}
+
+void AsyncIoService::wait(RequestId id)
+{
+    std::unique_lock lock(m_mutex);
+    while (true) {
+        auto it = std::find_if(m_finished.begin(), m_finished.end(), [id](const Finished& finished) {
+            return !finished.posted && finished.completion.id == id;
+        });
+        if (it != m_finished.end()) {
+            Finished finished = std::move(*it);
+            m_finished.erase(it);
+            lock.unlock();
+            runFinished(finished);
+            return;
+        }
+        const bool pending = std::any_of(m_pending.begin(), m_pending.end(), [id](const auto& queue) {
+            return std::any_of(queue.begin(), queue.end(), [id](const auto& op) { return op->id == id; });
+        });
+        if (!pending && m_inFlight.count(id) == 0)
+            return; // unknown or already delivered
+        m_finishedCv.wait(lock);
+    }
+}
+
+AsyncIoService::Stats AsyncIoService::stats() const
+{
+    Stats stats;
+    stats.backend = m_backend;
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard lock(m_mutex);
+    stats.queuedVisible = m_pending[static_cast<std::size_t>(Priority::Visible)].size();
+    stats.queuedPrefetch = m_pending[static_cast<std::size_t>(Priority::Prefetch)].size();
+    stats.inFlight = m_inFlight.size();
+    stats.peakQueueDepth = m_peakQueueDepth;
+    stats.completed = m_completed;
+    stats.failed = m_failed;
+    stats.cancelled = m_cancelledCount;
+    stats.bytesRead = m_bytesRead;
+    stats.avgLatencyMs = m_avgLatencyMs;
+
+    auto& recent = const_cast<std::deque<std::pair<std::chrono::steady_clock::time_point, std::size_t>>&>(m_recentBytes);
+    while (!recent.empty() && now - recent.front().first > std::chrono::seconds(1))
+        recent.pop_front();
+    std::size_t bytes = 0;
+    for (const auto& [time, size] : recent)
+        bytes += size;
+    stats.throughputMBs = static_cast<float>(static_cast<double>(bytes) / (1024.0 * 1024.0));
+    return stats;
+}
+
+void AsyncIoService::setMetricsRegistry(MetricsRegistry* registry)
+{
+    if (!registry) {
+        m_queueDepthGauge = {};
+        m_inFlightGauge = {};
+        m_throughputGauge = {};
+        m_bytesCounter = {};
+        m_requestsCounter = {};
+        return;
+    }
+    m_queueDepthGauge = registry->gauge("daedalus_io_queue_depth", "Asynchronous reads waiting to be issued");
+    m_inFlightGauge = registry->gauge("daedalus_io_in_flight", "Asynchronous reads currently issued to the OS");
+    m_throughputGauge = registry->gauge("daedalus_io_throughput_mb_s", "Bytes completed by asynchronous reads over the last second");
+    m_bytesCounter = registry->counter("daedalus_io_bytes_read", "Bytes read by asynchronous reads");
+    m_requestsCounter = registry->counter("daedalus_io_requests", "Asynchronous reads completed successfully");
+}
+
+void AsyncIoService::drawImGuiPanel()
+{
+    const Stats current = stats();
+    if (current.backend == Backend::IoUring)
+        ImGui::Text("Backend: io_uring (queue depth %u)", m_settings.queueDepth);
+    else
+        ImGui::Text("Backend: thread pool (%u threads)", m_settings.workerThreads);
+    ImGui::Text("Queued: %zu visible, %zu prefetch | In flight: %zu | Peak depth: %zu",
+        current.queuedVisible, current.queuedPrefetch, current.inFlight, current.peakQueueDepth);
+    ImGui::Text("Completed: %llu | Failed: %llu | Cancelled: %llu",
+        static_cast<unsigned long long>(current.completed),
+        static_cast<unsigned long long>(current.failed),
+        static_cast<unsigned long long>(current.cancelled));
+    ImGui::Text("Read: %.1f MiB total | %.1f MiB/s | avg latency %.2f ms",
+        static_cast<double>(current.bytesRead) / (1024.0 * 1024.0),
+        static_cast<double>(current.throughputMBs),
+        static_cast<double>(current.avgLatencyMs));
+    ImGui::Text("Pooled buffers: %.1f MiB", static_cast<double>(m_bufferPool.cachedBytes()) / (1024.0 * 1024.0));
+}
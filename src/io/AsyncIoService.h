@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "metrics/MetricsRegistry.h"
+
+#include <framework/file_provider.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Page-aligned read buffer borrowed from IoBufferPool; returns itself to the pool when destroyed.
+class IoBuffer {
+public:
+    IoBuffer() = default;
+    ~IoBuffer();
+    IoBuffer(IoBuffer&& other) noexcept;
+    IoBuffer& operator=(IoBuffer&& other) noexcept;
+    IoBuffer(const IoBuffer&) = delete;
+    IoBuffer& operator=(const IoBuffer&) = delete;
+
+    [[nodiscard]] std::byte* data() const { return m_data; }
+    [[nodiscard]] std::size_t capacity() const { return m_capacity; }
+    [[nodiscard]] explicit operator bool() const { return m_data != nullptr; }
+
+private:
+    friend class IoBufferPool;
+    struct PoolState;
+    IoBuffer(std::byte* data, std::size_t capacity, std::shared_ptr<PoolState> pool);
+    void release();
+
+    std::byte* m_data { nullptr };
+    std::size_t m_capacity { 0 };
+    std::shared_ptr<PoolState> m_pool;
+};
+
+// Power-of-two size classes of page-aligned buffers, recycled instead of freed up to a byte budget.
+class IoBufferPool {
+public:
+    static constexpr std::size_t kAlignment = 4096;
+    static constexpr std::size_t kMinBufferSize = 64 * 1024;
+
+    explicit IoBufferPool(std::size_t maxCachedBytes = 64ull * 1024 * 1024);
+    ~IoBufferPool();
+
+    IoBufferPool(const IoBufferPool&) = delete;
+    IoBufferPool& operator=(const IoBufferPool&) = delete;
+
+    [[nodiscard]] IoBuffer acquire(std::size_t size);
+    [[nodiscard]] std::size_t cachedBytes() const;
+
+private:
+    std::shared_ptr<IoBuffer::PoolState> m_state;
+};
+
+// Asynchronous file reads for asset loading. On Linux requests are executed by io_uring from a
+// single submission thread; elsewhere, or when the kernel refuses io_uring, a small pool of threads
+// runs blocking reads instead. Requests carry a priority (Visible before Prefetch), can be submitted
+// in batches, read into a caller-provided span or a pooled aligned buffer, and can be cancelled until
+// they complete. Completions are queued and their callbacks run on the thread that calls
+// pollCompletions() (the main thread, where GL uploads must happen anyway) or wait(). Should
+// io_uring fail at runtime, its queued and in-flight reads move to the thread pool.
+class AsyncIoService {
+public:
+    using RequestId = std::uint64_t;
+    using Priority = ReadPriority;
+
+    enum class Backend {
+        IoUring,
+        ThreadPool
+    };
+
+    enum class Status {
+        Ok,
+        Failed,
+        Cancelled
+    };
+
+    struct Completion {
+        RequestId id { 0 };
+        std::filesystem::path path;
+        Priority priority { Priority::Visible };
+        Status status { Status::Ok };
+        int error { 0 }; // errno for Failed
+        std::span<std::byte> data; // the bytes read (into `buffer` or the caller's destination)
+        IoBuffer buffer; // owns `data` when the request did not provide a destination
+        float latencyMs { 0.0f }; // submit -> read finished
+    };
+    using Callback = std::function<void(Completion&)>;
+
+    struct ReadRequest {
+        std::filesystem::path path;
+        Priority priority { Priority::Visible };
+        std::span<std::byte> destination; // empty: read the whole file (from `offset`) into a pooled buffer
+        std::uint64_t offset { 0 };
+        Callback callback;
+    };
+
+    struct Settings {
+        bool preferIoUring { true };
+        unsigned queueDepth { 64 }; // reads in flight at once
+        unsigned workerThreads { 3 }; // thread-pool backend only
+    };
+
+    struct Stats {
+        Backend backend { Backend::ThreadPool };
+        std::size_t queuedVisible { 0 };
+        std::size_t queuedPrefetch { 0 };
+        std::size_t inFlight { 0 };
+        std::size_t peakQueueDepth { 0 };
+        std::uint64_t completed { 0 };
+        std::uint64_t failed { 0 };
+        std::uint64_t cancelled { 0 };
+        std::uint64_t bytesRead { 0 };
+        float throughputMBs { 0.0f }; // over the last second
+        float avgLatencyMs { 0.0f };
+    };
+
+    AsyncIoService();
+    explicit AsyncIoService(const Settings& settings);
+    ~AsyncIoService();
+
+    AsyncIoService(const AsyncIoService&) = delete;
+    AsyncIoService& operator=(const AsyncIoService&) = delete;
+
+    RequestId submit(ReadRequest request);
+    std::vector<RequestId> submitBatch(std::vector<ReadRequest> requests);
+    // Queues `callback` to run from pollCompletions() like a read completion would.
+    void post(std::function<void()> callback);
+    // Returns false when the request already completed. A cancelled request still delivers its
+    // callback with Status::Cancelled.
+    bool cancel(RequestId id);
+
+    // Runs the callbacks of finished requests on the calling thread; returns how many ran.
+    std::size_t pollCompletions(std::size_t maxCompletions = SIZE_MAX);
+    // Blocks until `id` finished and runs its callback on the calling thread.
+    void wait(RequestId id);
+
+    [[nodiscard]] Backend backend() const { return m_backend.load(); }
+    [[nodiscard]] Stats stats() const;
+    [[nodiscard]] IoBufferPool& bufferPool() { return m_bufferPool; }
+
+    // Exports queue depth, in-flight count and throughput (nullptr to detach).
+    void setMetricsRegistry(MetricsRegistry* registry);
+    void drawImGuiPanel();
+
+private:
+    struct Operation {
+        RequestId id { 0 };
+        ReadRequest request;
+        std::chrono::steady_clock::time_point submitted;
+        int fd { -1 };
+        std::size_t length { 0 };
+        std::size_t done { 0 };
+        std::span<std::byte> target;
+        IoBuffer buffer;
+        bool prepared { false }; // file opened and destination chosen
+        bool cancelSubmitted { false }; // IORING_OP_ASYNC_CANCEL queued
+    };
+
+    struct Finished {
+        Completion completion;
+        Callback callback;
+        std::function<void()> posted;
+    };
+
+    struct Ring;
+
+    bool startIoUring();
+    void startThreadPool();
+    void ioUringLoop();
+    void workerLoop();
+    // Runs the thread-pool backend on the io_uring thread after the ring failed.
+    void runThreadPoolFallback();
+    void wakeIoThread();
+
+    [[nodiscard]] std::unique_ptr<Operation> popPending();
+    // Opens the file and picks the destination; finishes the operation itself on failure.
+    bool prepare(Operation& op);
+    void finish(std::unique_ptr<Operation> op, Status status, int error);
+    void runFinished(Finished& finished);
+
+    Settings m_settings;
+    std::atomic<Backend> m_backend { Backend::ThreadPool };
+    IoBufferPool m_bufferPool;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_pendingCv;
+    std::condition_variable m_finishedCv;
+    std::array<std::deque<std::unique_ptr<Operation>>, 2> m_pending; // indexed by Priority
+    std::unordered_set<RequestId> m_cancelled; // in flight, cancelled by the caller
+    std::unordered_set<RequestId> m_inFlight;
+    std::deque<Finished> m_finished;
+    RequestId m_nextId { 1 };
+    bool m_stopping { false };
+
+    std::unique_ptr<Ring> m_ring;
+    int m_wakeFd { -1 };
+    std::vector<std::thread> m_threads;
+
+    // Main-thread statistics, updated as completions are delivered.
+    std::size_t m_peakQueueDepth { 0 };
+    std::uint64_t m_completed { 0 };
+    std::uint64_t m_failed { 0 };
+    std::uint64_t m_cancelledCount { 0 };
+    std::uint64_t m_bytesRead { 0 };
+    float m_avgLatencyMs { 0.0f };
+    std::deque<std::pair<std::chrono::steady_clock::time_point, std::size_t>> m_recentBytes;
+
+    MetricsRegistry::Gauge m_queueDepthGauge;
+    MetricsRegistry::Gauge m_inFlightGauge;
+    MetricsRegistry::Gauge m_throughputGauge;
+    MetricsRegistry::Counter m_bytesCounter;
+    MetricsRegistry::Counter m_requestsCounter;
+};
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: MIT
+#include "io/Lz4Block.h"
+
+#include <cstdint>
+#include <cstring>
+
+namespace lz4_block {
+
+namespace {
+
+constexpr std::size_t kMinMatch = 4;
+constexpr std::size_t kLastLiterals = 5; // the last 5 bytes are always literals
+constexpr std::size_t kMatchFindLimit = 12; // no match may start within the last 12 bytes
+constexpr std::size_t kMaxOffset = 65535;
+constexpr int kHashBits = 14;
+
+std::uint32_t read32(const std::uint8_t* p)
+{
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+std::uint32_t hash(std::uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+void writeLength(std::vector<std::byte>& out, std::size_t length)
+{
+    while (length >= 255) {
+        out.push_back(std::byte { 255 });
+        length -= 255;
+    }
+    out.push_back(static_cast<std::byte>(length));
+}
+
+void emitSequence(std::vector<std::byte>& out, const std::uint8_t* literals, std::size_t literalLength, std::size_t offset, std::size_t matchLength)
+{
+    const std::size_t matchCode = matchLength >= kMinMatch ? matchLength - kMinMatch : 0;
+    const auto token = static_cast<std::uint8_t>(((literalLength >= 15 ? 15 : literalLength) << 4) | (matchCode >= 15 ? 15 : matchCode));
+    out.push_back(static_cast<std::byte>(token));
+    if (literalLength >= 15)
+        writeLength(out, literalLength - 15);
+    const auto* literalBytes = reinterpret_cast<const std::byte*>(literals);
+    out.insert(out.end(), literalBytes, literalBytes + literalLength);
+    if (matchLength == 0)
+        return; // final, literal-only sequence
+    out.push_back(static_cast<std::byte>(offset & 0xffu));
+    out.push_back(static_cast<std::byte>((offset >> 8) & 0xffu));
+    if (matchCode >= 15)
+        writeLength(out, matchCode - 15);
+}
+
+} // namespace
+
+std::size_t compressBound(std::size_t rawSize)
+{
+    return rawSize + rawSize / 255 + 16;
+}
+
+std::size_t decompressBound(std::size_t storedSize)
+{
+    return storedSize * 255;
+}
+
+void compress(const std::byte* srcBytes, std::size_t size, std::vector<std::byte>& out)
+{
+    out.clear();
+    out.reserve(compressBound(size));
+    const auto* src = reinterpret_cast<const std::uint8_t*>(srcBytes);
+
+    std::size_t anchor = 0;
+    if (size > kMatchFindLimit) {
+        std::vector<std::int32_t> table(std::size_t { 1 } << kHashBits, -1);
+        const std::size_t matchLimit = size - kMatchFindLimit;
+        const std::size_t matchEnd = size - kLastLiterals;
+        std::size_t ip = 0;
+        while (ip < matchLimit) {
+            const std::uint32_t sequence = read32(src + ip);
+            const std::uint32_t slot = hash(sequence);
+            const std::int32_t candidate = table[slot];
+            table[slot] = static_cast<std::int32_t>(ip);
+            if (candidate < 0 || ip - static_cast<std::size_t>(candidate) > kMaxOffset || read32(src + candidate) != sequence) {
+                ++ip;
+                continue;
+            }
+
+            const auto ref = static_cast<std::size_t>(candidate);
+            std::size_t length = kMinMatch;
+            while (ip + length < matchEnd && src[ref + length] == src[ip + length])
+                ++length;
+            emitSequence(out, src + anchor, ip - anchor, ip - ref, length);
+            ip += length;
+            anchor = ip;
+        }
+    }
+    emitSequence(out, src + anchor, size - anchor, 0, 0);
+}
+
+bool decompress(const std::byte* srcBytes, std::size_t size, std::byte* dstBytes, std::size_t rawSize)
+{
+    const auto* src = reinterpret_cast<const std::uint8_t*>(srcBytes);
+    auto* dst = reinterpret_cast<std::uint8_t*>(dstBytes);
+    std::size_t ip = 0;
+    std::size_t op = 0;
+
+    const auto readLength = [&](std::size_t& length) {
+        std::uint8_t extra = 255;
+        while (extra == 255) {
+            if (ip >= size)
+                return false;
+            extra = src[ip++];
+            length += extra;
+        }
+        return true;
+    };
+
+    while (ip < size) {
+        const std::uint8_t token = src[ip++];
+        std::size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(literalLength))
+            return false;
+        if (literalLength > size - ip || literalLength > rawSize - op)
+            return false;
+        std::memcpy(dst + op, src + ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+        if (ip == size)
+            break; // the last sequence carries literals only
+
+        if (size - ip < 2)
+            return false;
+        const std::size_t offset = static_cast<std::size_t>(src[ip]) | (static_cast<std::size_t>(src[ip + 1]) << 8);
+        ip += 2;
+        std::size_t matchLength = token & 0x0fu;
+        if (matchLength == 15 && !readLength(matchLength))
+            return false;
+        matchLength += kMinMatch;
+        if (offset == 0 || offset > op || matchLength > rawSize - op)
+            return false;
+        // Overlapping copies are how LZ4 encodes runs, so copy byte by byte when they overlap.
+        const std::uint8_t* match = dst + op - offset;
+        if (offset >= matchLength) {
+            std::memcpy(dst + op, match, matchLength);
+        } else {
+            for (std::size_t i = 0; i < matchLength; ++i)
+                dst[op + i] = match[i];
+        }
+        op += matchLength;
+    }
+    return op == rawSize;
+}
+
+} // namespace lz4_block
@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Minimal codec for the LZ4 block format (no frame header, no checksums). The compressor is a
+// single-pass greedy matcher: fast and good enough for shaders, meshes and scene text, while the
+// decoder is the part that runs at load time and is fully bounds-checked.
+namespace lz4_block {
+
+// Worst-case compressed size for `rawSize` input bytes.
+[[nodiscard]] std::size_t compressBound(std::size_t rawSize);
+
+// Largest raw size `storedSize` compressed bytes can decode to: a match length byte of 255 adds at
+// most 255 output bytes, so no valid block expands further than that.
+[[nodiscard]] std::size_t decompressBound(std::size_t storedSize);
+
+// Replaces `out` with the compressed form of [src, src + size).
+void compress(const std::byte* src, std::size_t size, std::vector<std::byte>& out);
+
+// Decodes exactly `rawSize` bytes into `dst`. Returns false on malformed input.
+[[nodiscard]] bool decompress(const std::byte* src, std::size_t size, std::byte* dst, std::size_t rawSize);
+
+} // namespace lz4_block
@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: MIT
+#include "io/MappedFile.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::filesystem::path& path)
+{
+    close();
+    HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        m_lastError = "CreateFile failed (" + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    LARGE_INTEGER size {};
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        m_lastError = "file is empty or its size is unavailable";
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        m_lastError = "CreateFileMapping failed (" + std::to_string(GetLastError()) + ")";
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        m_lastError = "MapViewOfFile failed (" + std::to_string(GetLastError()) + ")";
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_data = view;
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file)
+        CloseHandle(m_file);
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+}
+
+void MappedFile::willNeed(std::size_t offset, std::size_t size) const
+{
+    if (!m_data || offset >= m_size)
+        return;
+    WIN32_MEMORY_RANGE_ENTRY range { static_cast<char*>(m_data) + offset, std::min(size, m_size - offset) };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+bool MappedFile::open(const std::filesystem::path& path)
+{
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        m_lastError = std::string("open failed: ") + std::strerror(errno);
+        return false;
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        m_lastError = "file is empty or its size is unavailable";
+        ::close(fd);
+        return false;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file referenced; the descriptor is no longer needed.
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        m_lastError = std::string("mmap failed: ") + std::strerror(errno);
+        return false;
+    }
+    m_data = data;
+    m_size = size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data)
+        munmap(m_data, m_size);
+    m_data = nullptr;
+    m_size = 0;
+}
+
+void MappedFile::willNeed(std::size_t offset, std::size_t size) const
+{
+    if (!m_data || offset >= m_size)
+        return;
+    // madvise() wants a page-aligned start.
+    const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t begin = offset - offset % pageSize;
+    const std::size_t end = std::min(offset + size, m_size);
+    madvise(static_cast<char*>(m_data) + begin, end - begin, MADV_WILLNEED);
+}
+
+#endif
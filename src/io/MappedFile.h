@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first touch, so mapping a large
+// archive costs nothing until its entries are read.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+    // Asks the OS to start paging in [offset, offset + size) ahead of the first touch.
+    void willNeed(std::size_t offset, std::size_t size) const;
+
+    [[nodiscard]] const std::byte* data() const { return static_cast<const std::byte*>(m_data); }
+    [[nodiscard]] std::size_t size() const { return m_size; }
+    [[nodiscard]] bool valid() const { return m_data != nullptr; }
+    [[nodiscard]] const std::string& lastError() const { return m_lastError; }
+
+private:
+    void* m_data { nullptr };
+    std::size_t m_size { 0 };
+    std::string m_lastError;
+#ifdef _WIN32
+    void* m_file { nullptr };
+    void* m_mapping { nullptr };
+#endif
+};
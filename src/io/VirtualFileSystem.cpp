@@ -0,0 +1,389 @@
+// SPDX-License-Identifier: MIT
+#include "io/VirtualFileSystem.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+VirtualFileSystem::VirtualFileSystem(std::filesystem::path root, const std::vector<std::filesystem::path>& packs)
+    : m_root(std::filesystem::absolute(root).lexically_normal())
+{
+    for (const std::filesystem::path& pack : packs)
+        mountPack(pack);
+    setFileProvider(this);
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+    if (&fileProvider() == this)
+        setFileProvider(nullptr);
+}
+
+bool VirtualFileSystem::mountPack(const std::filesystem::path& file)
+{
+    auto pack = std::make_shared<AssetPack>();
+    if (!pack->open(file)) {
+        std::cerr << "[VFS] Failed to mount " << file << ": " << pack->lastError() << std::endl;
+        std::unique_lock lock(m_mountMutex);
+        m_lastMountError = file.filename().string() + ": " + pack->lastError();
+        return false;
+    }
+
+    const AssetPack::Info& info = pack->info();
+    std::cout << "[VFS] Mounted " << file << " (" << info.entryCount << " files, " << info.blobCount << " blobs, "
+              << info.compressedBlobs << " compressed)" << std::endl;
+    std::unique_lock lock(m_mountMutex);
+    m_packs.push_back(std::move(pack));
+    m_lastMountError.clear();
+    return true;
+}
+
+void VirtualFileSystem::unmountAll()
+{
+    // Data already handed out keeps its mapping alive through FileData.
+    std::unique_lock lock(m_mountMutex);
+    m_packs.clear();
+}
+
+std::vector<std::shared_ptr<const AssetPack>> VirtualFileSystem::packs() const
+{
+    std::shared_lock lock(m_mountMutex);
+    return m_packs;
+}
+
+std::optional<std::string> VirtualFileSystem::toKey(const std::filesystem::path& path) const
+{
+    std::filesystem::path normal = path.lexically_normal();
+    if (normal.is_absolute()) {
+        normal = normal.lexically_relative(m_root);
+        if (normal.empty() || *normal.begin() == "..")
+            return std::nullopt;
+    }
+    std::string key = normal.generic_string();
+    while (!key.empty() && key.back() == '/')
+        key.pop_back();
+    if (key == ".")
+        key.clear();
+    return key;
+}
+
+std::optional<FileData> VirtualFileSystem::readFromPacks(const std::filesystem::path& path)
+{
+    if (const std::optional<std::string> key = toKey(path)) {
+        const auto mounted = packs();
+        for (auto it = mounted.rbegin(); it != mounted.rend(); ++it) {
+            const asset_pack::Entry* entry = (*it)->find(*key);
+            if (!entry)
+                continue;
+            std::optional<FileData> data = (*it)->read(*entry);
+            if (!data) {
+                std::cerr << "[VFS] Corrupt pack data for " << *key << std::endl;
+                break;
+            }
+            m_packReads.fetch_add(1, std::memory_order_relaxed);
+            const bool stored = (*it)->blob(*entry).codec == static_cast<std::uint32_t>(asset_pack::Codec::Stored);
+            (stored ? m_packBytesMapped : m_packBytesDecoded).fetch_add(data->size(), std::memory_order_relaxed);
+            return data;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<FileData> VirtualFileSystem::read(const std::filesystem::path& path)
+{
+    if (std::optional<FileData> data = readFromPacks(path))
+        return data;
+
+    if (looseFallback()) {
+        if (std::optional<FileData> data = takePrefetched(path)) {
+            m_looseReads.fetch_add(1, std::memory_order_relaxed);
+            return data;
+        }
+        if (std::optional<FileData> data = m_loose.read(path)) {
+            m_looseReads.fetch_add(1, std::memory_order_relaxed);
+            return data;
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+bool VirtualFileSystem::exists(const std::filesystem::path& path)
+{
+    if (const std::optional<std::string> key = toKey(path)) {
+        for (const auto& pack : packs()) {
+            if (pack->find(*key))
+                return true;
+        }
+    }
+    return looseFallback() && m_loose.exists(path);
+}
+
+std::vector<std::filesystem::path> VirtualFileSystem::list(const std::filesystem::path& directory)
+{
+    std::vector<std::filesystem::path> files;
+    std::set<std::string> seenNames;
+
+    if (const std::optional<std::string> key = toKey(directory)) {
+        const std::string prefix = key->empty() ? std::string {} : *key + "/";
+        const bool absolute = directory.is_absolute();
+        for (const auto& pack : packs()) {
+            const auto [first, last] = pack->range(prefix);
+            for (const asset_pack::Entry* entry = first; entry != last; ++entry) {
+                const std::string_view name = pack->path(*entry).substr(prefix.size());
+                if (name.find('/') != std::string_view::npos)
+                    continue; // lives in a subdirectory
+                if (!seenNames.emplace(name).second)
+                    continue;
+                const std::filesystem::path relative { std::string(pack->path(*entry)) };
+                files.push_back(absolute ? m_root / relative : relative);
+            }
+        }
+    }
+
+    if (looseFallback()) {
+        for (std::filesystem::path& file : m_loose.list(directory)) {
+            if (seenNames.insert(file.filename().string()).second)
+                files.push_back(std::move(file));
+        }
+    }
+    return files;
+}
+
+void VirtualFileSystem::setAsyncIo(AsyncIoService* asyncIo)
+{
+    m_asyncIo = asyncIo;
+    if (!asyncIo) {
+        std::lock_guard lock(m_prefetchMutex);
+        m_prefetched.clear();
+        m_prefetchedBytes = 0;
+    }
+}
+
+FileData VirtualFileSystem::toFileData(AsyncIoService::Completion& completion)
+{
+    if (completion.data.empty())
+        return FileData::fromBuffer({});
+    // The pooled buffer goes back to the pool once the last FileData referencing it is gone.
+    auto buffer = std::make_shared<IoBuffer>(std::move(completion.buffer));
+    return FileData(completion.data.data(), completion.data.size(), std::move(buffer));
+}
+
+void VirtualFileSystem::prefetch(const std::vector<std::filesystem::path>& paths, ReadPriority priority)
+{
+    std::vector<AsyncIoService::ReadRequest> requests;
+    std::vector<std::string> names;
+    const auto mounted = packs();
+    for (const std::filesystem::path& path : paths) {
+        bool packed = false;
+        if (const std::optional<std::string> key = toKey(path)) {
+            for (auto it = mounted.rbegin(); it != mounted.rend() && !packed; ++it) {
+                if (const asset_pack::Entry* entry = (*it)->find(*key)) {
+                    (*it)->prefetch(*entry);
+                    packed = true;
+                }
+            }
+        }
+        if (packed || !m_asyncIo || !looseFallback())
+            continue;
+
+        std::error_code error;
+        const std::uintmax_t fileSize = std::filesystem::file_size(path, error);
+        if (error)
+            continue; // read() reports missing files
+        std::string name = path.lexically_normal().string();
+        {
+            std::lock_guard lock(m_prefetchMutex);
+            if (m_prefetched.count(name) > 0)
+                continue;
+            // A prefetch is only a hint: past the budget it is skipped and read() goes to disk.
+            if (fileSize > kMaxPrefetchedBytes - m_prefetchedBytes) {
+                m_prefetchesSkipped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            const auto bytes = static_cast<std::size_t>(fileSize);
+            m_prefetched.emplace(name, PrefetchSlot { .bytes = bytes });
+            m_prefetchedBytes += bytes;
+        }
+        AsyncIoService::ReadRequest request;
+        request.path = path;
+        request.priority = priority;
+        request.callback = [this, name](AsyncIoService::Completion& completion) {
+            std::lock_guard lock(m_prefetchMutex);
+            auto it = m_prefetched.find(name);
+            if (it == m_prefetched.end())
+                return;
+            m_prefetchedBytes -= it->second.bytes;
+            if (completion.status != AsyncIoService::Status::Ok) {
+                m_prefetched.erase(it); // read() falls back to a blocking read and reports the error
+                return;
+            }
+            it->second.done = true;
+            it->second.data = toFileData(completion);
+            it->second.bytes = completion.data.size();
+            m_prefetchedBytes += it->second.bytes;
+        };
+        requests.push_back(std::move(request));
+        names.push_back(std::move(name));
+    }
+    if (requests.empty())
+        return;
+
+    const std::vector<AsyncIoService::RequestId> ids = m_asyncIo->submitBatch(std::move(requests));
+    std::lock_guard lock(m_prefetchMutex);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        auto it = m_prefetched.find(names[i]);
+        if (it != m_prefetched.end() && !it->second.done)
+            it->second.request = ids[i];
+    }
+}
+
+std::optional<FileData> VirtualFileSystem::takePrefetched(const std::filesystem::path& path)
+{
+    if (!m_asyncIo)
+        return std::nullopt;
+    const std::string name = path.lexically_normal().string();
+    std::unique_lock lock(m_prefetchMutex);
+    auto it = m_prefetched.find(name);
+    if (it == m_prefetched.end())
+        return std::nullopt;
+    if (!it->second.done && it->second.request != 0) {
+        // Still in flight: waiting runs the completion callback on this thread.
+        const AsyncIoService::RequestId request = it->second.request;
+        lock.unlock();
+        m_asyncIo->wait(request);
+        m_prefetchWaits.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+        it = m_prefetched.find(name);
+    }
+    if (it == m_prefetched.end() || !it->second.done)
+        return std::nullopt;
+    std::optional<FileData> data = std::move(it->second.data);
+    m_prefetchedBytes -= it->second.bytes;
+    m_prefetched.erase(it);
+    m_prefetchHits.fetch_add(1, std::memory_order_relaxed);
+    return data;
+}
+
+bool VirtualFileSystem::isPrefetchReady(const std::filesystem::path& path) const
+{
+    std::lock_guard lock(m_prefetchMutex);
+    auto it = m_prefetched.find(path.lexically_normal().string());
+    return it == m_prefetched.end() || it->second.done;
+}
+
+void VirtualFileSystem::readAsync(const std::filesystem::path& path, ReadPriority priority, AsyncReadCallback callback)
+{
+    if (!m_asyncIo) {
+        callback(read(path));
+        return;
+    }
+    if (std::optional<FileData> data = readFromPacks(path)) {
+        m_asyncIo->post([callback = std::move(callback), data = std::move(*data)]() mutable { callback(std::move(data)); });
+        return;
+    }
+    if (!looseFallback()) {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        m_asyncIo->post([callback = std::move(callback)]() { callback(std::nullopt); });
+        return;
+    }
+    {
+        std::lock_guard lock(m_prefetchMutex);
+        if (m_prefetched.count(path.lexically_normal().string()) > 0) {
+            // Already prefetched (or being prefetched): hand over that read once it lands.
+            m_asyncIo->post([this, path, callback = std::move(callback)]() { callback(read(path)); });
+            return;
+        }
+    }
+
+    AsyncIoService::ReadRequest request;
+    request.path = path;
+    request.priority = priority;
+    request.callback = [this, callback = std::move(callback)](AsyncIoService::Completion& completion) {
+        if (completion.status != AsyncIoService::Status::Ok) {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            callback(std::nullopt);
+            return;
+        }
+        m_looseReads.fetch_add(1, std::memory_order_relaxed);
+        callback(toFileData(completion));
+    };
+    m_asyncIo->submit(std::move(request));
+}
+
+VirtualFileSystem::Stats VirtualFileSystem::stats() const
+{
+    Stats stats;
+    stats.packReads = m_packReads.load(std::memory_order_relaxed);
+    stats.packBytesMapped = m_packBytesMapped.load(std::memory_order_relaxed);
+    stats.packBytesDecoded = m_packBytesDecoded.load(std::memory_order_relaxed);
+    stats.looseReads = m_looseReads.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+    stats.prefetchHits = m_prefetchHits.load(std::memory_order_relaxed);
+    stats.prefetchWaits = m_prefetchWaits.load(std::memory_order_relaxed);
+    stats.prefetchesSkipped = m_prefetchesSkipped.load(std::memory_order_relaxed);
+    std::lock_guard lock(m_prefetchMutex);
+    stats.prefetchedBytes = m_prefetchedBytes;
+    return stats;
+}
+
+void VirtualFileSystem::drawImGuiPanel()
+{
+    ImGui::Text("Asset root: %s", m_root.string().c_str());
+
+    bool loose = looseFallback();
+    if (ImGui::Checkbox("Loose File Fallback", &loose))
+        setLooseFallback(loose);
+
+    const auto mounted = packs();
+    if (mounted.empty())
+        ImGui::TextDisabled("No packs mounted; reading loose files.");
+    for (const auto& pack : mounted) {
+        const AssetPack::Info& info = pack->info();
+        ImGui::BulletText("%s: %u files, %u blobs (%u LZ4), %.1f MiB mapped, %.1f MiB raw",
+            info.file.filename().string().c_str(),
+            info.entryCount,
+            info.blobCount,
+            info.compressedBlobs,
+            static_cast<double>(info.fileSize) / (1024.0 * 1024.0),
+            static_cast<double>(info.rawBytes) / (1024.0 * 1024.0));
+    }
+
+    ImGui::InputText("Pack", m_mountPathBuffer.data(), m_mountPathBuffer.size());
+    ImGui::SameLine();
+    if (ImGui::Button("Mount"))
+        mountPack(std::filesystem::path(m_mountPathBuffer.data()));
+    if (!mounted.empty()) {
+        ImGui::SameLine();
+        if (ImGui::Button("Unmount All"))
+            unmountAll();
+    }
+    {
+        std::shared_lock lock(m_mountMutex);
+        if (!m_lastMountError.empty())
+            ImGui::TextColored(ImVec4(0.9f, 0.3f, 0.3f, 1.0f), "%s", m_lastMountError.c_str());
+    }
+
+    const Stats current = stats();
+    ImGui::Text("Pack reads: %llu (%.1f MiB zero-copy, %.1f MiB decoded)",
+        static_cast<unsigned long long>(current.packReads),
+        static_cast<double>(current.packBytesMapped) / (1024.0 * 1024.0),
+        static_cast<double>(current.packBytesDecoded) / (1024.0 * 1024.0));
+    ImGui::Text("Loose reads: %llu | Misses: %llu",
+        static_cast<unsigned long long>(current.looseReads),
+        static_cast<unsigned long long>(current.misses));
+    if (m_asyncIo) {
+        ImGui::Text("Prefetch hits: %llu (%llu waited, %llu skipped) | Cached: %.1f / %.0f MiB",
+            static_cast<unsigned long long>(current.prefetchHits),
+            static_cast<unsigned long long>(current.prefetchWaits),
+            static_cast<unsigned long long>(current.prefetchesSkipped),
+            static_cast<double>(current.prefetchedBytes) / (1024.0 * 1024.0),
+            static_cast<double>(kMaxPrefetchedBytes) / (1024.0 * 1024.0));
+    }
+}
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "io/AssetPack.h"
+#include "io/AsyncIoService.h"
+
+#include <framework/file_provider.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// The file provider every asset loader reads through. Paths are resolved against mounted .dpak
+// archives first (most recently mounted wins), keyed by their location relative to the asset root,
+// and fall back to loose files on disk so development keeps working without a pack. While alive it
+// is installed as the framework's file provider. With an AsyncIoService attached, prefetch() reads
+// loose files in the background and read() then returns the prefetched bytes instead of hitting the
+// disk; packed entries are prefetched by asking the OS to page their blobs in.
+class VirtualFileSystem final : public FileProvider {
+public:
+    struct Stats {
+        std::uint64_t packReads { 0 };
+        std::uint64_t packBytesMapped { 0 }; // served zero-copy from a mapping
+        std::uint64_t packBytesDecoded { 0 };
+        std::uint64_t looseReads { 0 };
+        std::uint64_t misses { 0 };
+        std::uint64_t prefetchHits { 0 }; // reads served from a finished background read
+        std::uint64_t prefetchWaits { 0 }; // reads that had to wait for a background read
+        std::size_t prefetchedBytes { 0 }; // in flight or held in the prefetch cache, not yet read
+        std::uint64_t prefetchesSkipped { 0 }; // hints dropped because the budget was used up
+    };
+
+    using AsyncReadCallback = std::function<void(std::optional<FileData>)>;
+
+    // Mounts `packs` in order; missing or invalid packs are reported and skipped.
+    explicit VirtualFileSystem(std::filesystem::path root, const std::vector<std::filesystem::path>& packs = {});
+    ~VirtualFileSystem() override;
+
+    VirtualFileSystem(const VirtualFileSystem&) = delete;
+    VirtualFileSystem& operator=(const VirtualFileSystem&) = delete;
+
+    bool mountPack(const std::filesystem::path& file);
+    void unmountAll();
+
+    // When disabled, anything missing from the mounted packs is reported as missing.
+    void setLooseFallback(bool enabled) { m_looseFallback.store(enabled, std::memory_order_relaxed); }
+    [[nodiscard]] bool looseFallback() const { return m_looseFallback.load(std::memory_order_relaxed); }
+
+    std::optional<FileData> read(const std::filesystem::path& path) override;
+    bool exists(const std::filesystem::path& path) override;
+    std::vector<std::filesystem::path> list(const std::filesystem::path& directory) override;
+    void prefetch(const std::vector<std::filesystem::path>& paths, ReadPriority priority) override;
+
+    // Background reads go through `asyncIo` (nullptr: prefetch() only advises packed entries).
+    void setAsyncIo(AsyncIoService* asyncIo);
+    // Reads `path` without blocking; `callback` runs from the I/O service's pollCompletions(). Without
+    // an I/O service the read happens immediately and the callback runs before this returns.
+    void readAsync(const std::filesystem::path& path, ReadPriority priority, AsyncReadCallback callback);
+    // True once a prefetched file can be read without blocking (packed files always can).
+    [[nodiscard]] bool isPrefetchReady(const std::filesystem::path& path) const;
+
+    [[nodiscard]] Stats stats() const;
+    void drawImGuiPanel();
+
+private:
+    // Pack key for `path`: its '/'-separated location relative to the root, or nullopt when it lies
+    // outside the root.
+    [[nodiscard]] std::optional<std::string> toKey(const std::filesystem::path& path) const;
+    [[nodiscard]] std::vector<std::shared_ptr<const AssetPack>> packs() const;
+    [[nodiscard]] std::optional<FileData> readFromPacks(const std::filesystem::path& path);
+    [[nodiscard]] std::optional<FileData> takePrefetched(const std::filesystem::path& path);
+    [[nodiscard]] static FileData toFileData(AsyncIoService::Completion& completion);
+
+    struct PrefetchSlot {
+        AsyncIoService::RequestId request { 0 };
+        bool done { false };
+        std::size_t bytes { 0 }; // charged against the budget: the file size until the read lands
+        std::optional<FileData> data;
+    };
+    // In-flight and unread prefetches together; hints that would exceed it are skipped.
+    static constexpr std::size_t kMaxPrefetchedBytes = 256ull * 1024 * 1024;
+
+    std::filesystem::path m_root;
+    LooseFileProvider m_loose;
+    std::atomic<bool> m_looseFallback { true };
+
+    mutable std::shared_mutex m_mountMutex;
+    std::vector<std::shared_ptr<const AssetPack>> m_packs;
+    std::string m_lastMountError;
+
+    std::atomic<std::uint64_t> m_packReads { 0 };
+    std::atomic<std::uint64_t> m_packBytesMapped { 0 };
+    std::atomic<std::uint64_t> m_packBytesDecoded { 0 };
+    std::atomic<std::uint64_t> m_looseReads { 0 };
+    std::atomic<std::uint64_t> m_misses { 0 };
+    std::atomic<std::uint64_t> m_prefetchHits { 0 };
+    std::atomic<std::uint64_t> m_prefetchWaits { 0 };
+    std::atomic<std::uint64_t> m_prefetchesSkipped { 0 };
+
+    AsyncIoService* m_asyncIo { nullptr };
+    mutable std::mutex m_prefetchMutex;
+    std::unordered_map<std::string, PrefetchSlot> m_prefetched; // keyed by the normalised path
+    std::size_t m_prefetchedBytes { 0 };
+
+    std::array<char, 512> m_mountPathBuffer { "daedalus.dpak" };
+};
@@ -0,0 +1,440 @@
+// SPDX-License-Identifier: MIT
+#include "mesh/AmbientOcclusionBaker.h"
+
+#include "mesh/MeshInstance.h"
+#include "mesh/MeshManager.h"
+#include "mesh/RayBvh.h"
+
+#include <framework/disable_all_warnings.h>
+#include <framework/log.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/gtc/constants.hpp>
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/matrix.hpp>
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace {
+
+constexpr std::size_t kVerticesPerChunk = 256;
+constexpr char kCacheMagic[4] = { 'D', 'V', 'A', 'O' };
+
+std::uint32_t hashIndex(std::uint32_t value)
+{
+    value ^= value >> 16;
+    value *= 0x7feb352du;
+    value ^= value >> 15;
+    value *= 0x846ca68bu;
+    value ^= value >> 16;
+    return value;
+}
+
+float radicalInverse(std::uint32_t bits)
+{
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+    return static_cast<float>(bits) * 2.3283064365386963e-10f;
+}
+
+// Orthonormal basis around a unit normal (Duff et al. 2017).
+void buildBasis(const glm::vec3& normal, glm::vec3& tangent, glm::vec3& bitangent)
+{
+    const float sign = std::copysign(1.0f, normal.z);
+    const float a = -1.0f / (sign + normal.z);
+    const float b = normal.x * normal.y * a;
+    tangent = glm::vec3(1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+    bitangent = glm::vec3(b, sign + normal.y * normal.y * a, -normal.y);
+}
+
+bool writeCache(const std::filesystem::path& path, const AmbientOcclusionBaker::BakeResult& result)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+    const auto itemCount = static_cast<std::uint32_t>(result.items.size());
+    file.write(kCacheMagic, sizeof(kCacheMagic));
+    file.write(reinterpret_cast<const char*>(&AmbientOcclusionBaker::kBakeVersion), sizeof(std::uint32_t));
+    file.write(reinterpret_cast<const char*>(&itemCount), sizeof(itemCount));
+    for (const std::vector<glm::vec4>& item : result.items) {
+        const auto vertexCount = static_cast<std::uint32_t>(item.size());
+        file.write(reinterpret_cast<const char*>(&vertexCount), sizeof(vertexCount));
+        file.write(reinterpret_cast<const char*>(item.data()), static_cast<std::streamsize>(item.size() * sizeof(glm::vec4)));
+    }
+    return static_cast<bool>(file);
+}
+
+bool readCache(const std::filesystem::path& path, AmbientOcclusionBaker::BakeResult& result)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[4] {};
+    std::uint32_t version = 0;
+    std::uint32_t itemCount = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&itemCount), sizeof(itemCount));
+    if (!file || std::memcmp(magic, kCacheMagic, sizeof(magic)) != 0 || version != AmbientOcclusionBaker::kBakeVersion)
+        return false;
+
+    result.items.assign(itemCount, {});
+    for (std::vector<glm::vec4>& item : result.items) {
+        std::uint32_t vertexCount = 0;
+        file.read(reinterpret_cast<char*>(&vertexCount), sizeof(vertexCount));
+        if (!file)
+            return false;
+        item.resize(vertexCount);
+        file.read(reinterpret_cast<char*>(item.data()), static_cast<std::streamsize>(item.size() * sizeof(glm::vec4)));
+        result.vertices += vertexCount;
+    }
+    return static_cast<bool>(file);
+}
+
+bool isFile(const std::filesystem::path& path)
+{
+    std::error_code error;
+    return !path.empty() && std::filesystem::is_regular_file(path, error);
+}
+
+} // namespace
+
+AmbientOcclusionBaker::BakeResult AmbientOcclusionBaker::bake(const std::vector<BakeItem>& items, const Settings& settings)
+{
+    const auto start = std::chrono::steady_clock::now();
+    BakeResult result;
+    result.items.resize(items.size());
+
+    // One triangle soup in instance space so items occlude each other.
+    std::vector<glm::vec3> positions;
+    std::vector<glm::uvec3> triangles;
+    std::vector<glm::mat3> normalMatrices(items.size(), glm::mat3(1.0f));
+    std::vector<std::vector<glm::vec3>> localNormals(items.size());
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        if (!items[i].geometry)
+            continue;
+        const MeshGeometryData& geometry = *items[i].geometry;
+        const auto base = static_cast<std::uint32_t>(positions.size());
+        for (const glm::vec3& position : geometry.positions)
+            positions.push_back(glm::vec3(items[i].nodeTransform * glm::vec4(position, 1.0f)));
+        for (const glm::uvec3& triangle : geometry.triangles)
+            triangles.push_back(triangle + glm::uvec3(base));
+        normalMatrices[i] = glm::transpose(glm::inverse(glm::mat3(items[i].nodeTransform)));
+
+        // Area-weighted vertex normals; the shared geometry only carries positions and triangles.
+        localNormals[i].assign(geometry.positions.size(), glm::vec3(0.0f));
+        for (const glm::uvec3& triangle : geometry.triangles) {
+            const glm::vec3& p0 = geometry.positions[triangle.x];
+            const glm::vec3 faceNormal = glm::cross(geometry.positions[triangle.y] - p0, geometry.positions[triangle.z] - p0);
+            localNormals[i][triangle.x] += faceNormal;
+            localNormals[i][triangle.y] += faceNormal;
+            localNormals[i][triangle.z] += faceNormal;
+        }
+        result.items[i].assign(geometry.positions.size(), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+        result.vertices += geometry.positions.size();
+    }
+
+    RayBvh bvh;
+    bvh.build(positions, triangles);
+    const float diagonal = glm::length(bvh.boundsMax() - bvh.boundsMin());
+    if (bvh.empty() || !(diagonal > 0.0f))
+        return result;
+
+    const float maxDistance = std::max(settings.maxDistance, 1e-4f) * diagonal;
+    const float bias = std::max(settings.bias, 0.0f) * diagonal;
+    const auto rayCount = static_cast<std::uint32_t>(std::clamp(settings.raysPerVertex, 1, 4096));
+
+    struct Chunk {
+        std::size_t item;
+        std::size_t first;
+        std::size_t count;
+    };
+    std::vector<Chunk> chunks;
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        const std::size_t vertexCount = result.items[i].size();
+        for (std::size_t first = 0; first < vertexCount; first += kVerticesPerChunk)
+            chunks.push_back(Chunk { i, first, std::min(kVerticesPerChunk, vertexCount - first) });
+    }
+
+    std::atomic<std::size_t> nextChunk { 0 };
+    std::atomic<std::uint64_t> raysTraced { 0 };
+    const auto worker = [&]() {
+        std::uint64_t localRays = 0;
+        for (std::size_t c = nextChunk.fetch_add(1); c < chunks.size(); c = nextChunk.fetch_add(1)) {
+            const Chunk& chunk = chunks[c];
+            const BakeItem& item = items[chunk.item];
+            const MeshGeometryData& geometry = *item.geometry;
+            // Bent normals go back to item space with the inverse of the normal matrix.
+            const glm::mat3 toLocal = glm::transpose(glm::mat3(item.nodeTransform));
+            for (std::size_t v = chunk.first; v < chunk.first + chunk.count; ++v) {
+                const glm::vec3 worldNormal = normalMatrices[chunk.item] * localNormals[chunk.item][v];
+                const float normalLength = glm::length(worldNormal);
+                if (!(normalLength > 1e-8f))
+                    continue;
+                const glm::vec3 normal = worldNormal / normalLength;
+                glm::vec3 tangent;
+                glm::vec3 bitangent;
+                buildBasis(normal, tangent, bitangent);
+                const glm::vec3 origin = glm::vec3(item.nodeTransform * glm::vec4(geometry.positions[v], 1.0f)) + normal * bias;
+
+                // Hammersley set, rotated per vertex so neighbours do not band.
+                const std::uint32_t scramble = hashIndex(static_cast<std::uint32_t>(v * 2654435761u + chunk.item));
+                const float offsetU = static_cast<float>(scramble & 0xFFFFu) / 65536.0f;
+                const float offsetV = static_cast<float>(scramble >> 16) / 65536.0f;
+
+                glm::vec3 bent(0.0f);
+                std::uint32_t open = 0;
+                for (std::uint32_t r = 0; r < rayCount; ++r) {
+                    const float u = std::fmod((static_cast<float>(r) + 0.5f) / static_cast<float>(rayCount) + offsetU, 1.0f);
+                    const float w = std::fmod(radicalInverse(r) + offsetV, 1.0f);
+                    const float radius = std::sqrt(u);
+                    const float phi = glm::two_pi<float>() * w;
+                    const glm::vec3 direction = tangent * (radius * std::cos(phi)) + bitangent * (radius * std::sin(phi)) + normal * std::sqrt(std::max(0.0f, 1.0f - u));
+                    if (!bvh.occluded(origin, direction, 0.0f, maxDistance)) {
+                        bent += direction;
+                        ++open;
+                    }
+                }
+                localRays += rayCount;
+
+                glm::vec3 bentLocal(0.0f);
+                const glm::vec3 transformed = toLocal * bent;
+                if (glm::dot(transformed, transformed) > 1e-12f)
+                    bentLocal = glm::normalize(transformed);
+                result.items[chunk.item][v] = glm::vec4(bentLocal, static_cast<float>(open) / static_cast<float>(rayCount));
+            }
+        }
+        raysTraced.fetch_add(localRays, std::memory_order_relaxed);
+    };
+
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    const auto threadCount = static_cast<std::size_t>(std::min<std::size_t>(settings.threads > 0 ? settings.threads : hardware, chunks.size()));
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount > 0 ? threadCount - 1 : 0);
+    for (std::size_t i = 1; i < threadCount; ++i)
+        workers.emplace_back(worker);
+    worker();
+    for (std::thread& thread : workers)
+        thread.join();
+
+    result.rays = raysTraced.load();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void AmbientOcclusionBaker::setAssetDatabase(AssetDatabase* database)
+{
+    m_database = database;
+    if (m_database)
+        m_database->registerImporter("vertex_ao", kBakeVersion);
+}
+
+void AmbientOcclusionBaker::setMetricsRegistry(MetricsRegistry* registry)
+{
+    if (!registry) {
+        m_raysPerSecondGauge = {};
+        m_raysCounter = {};
+        return;
+    }
+    m_raysPerSecondGauge = registry->gauge("daedalus_ao_bake_rays_per_second", "Throughput of the last ambient occlusion bake");
+    m_raysCounter = registry->counter("daedalus_ao_bake_rays", "Occlusion rays traced by the ambient occlusion baker");
+}
+
+AssetDatabase::ArtifactKey AmbientOcclusionBaker::artifactKey(const MeshInstance& instance) const
+{
+    // The item layout is part of the key so instances of one source with different layouts never
+    // share a bake.
+    std::string settings;
+    settings += "|rays=" + std::to_string(m_settings.raysPerVertex);
+    settings += "|dist=" + std::to_string(m_settings.maxDistance);
+    settings += "|bias=" + std::to_string(m_settings.bias);
+    for (const MeshDrawItem& item : instance.drawItems())
+        settings += "|v=" + std::to_string(item.cpuGeometry ? item.cpuGeometry->positions.size() : 0);
+
+    AssetDatabase::ArtifactKey key;
+    key.kind = "vertex_ao";
+    key.source = instance.sourcePath();
+    key.settingsHash = AssetDatabase::hashSettings(settings);
+    return key;
+}
+
+void AmbientOcclusionBaker::requestBake(const MeshInstance& instance)
+{
+    m_requested.insert(instance.id());
+
+    std::vector<BakeItem> items;
+    items.reserve(instance.drawItems().size());
+    bool hasGeometry = false;
+    for (const MeshDrawItem& item : instance.drawItems()) {
+        items.push_back(BakeItem { item.cpuGeometry, item.nodeTransform });
+        hasGeometry |= item.cpuGeometry && !item.cpuGeometry->triangles.empty();
+    }
+    if (!hasGeometry)
+        return;
+
+    Job job;
+    job.instanceId = instance.id();
+    job.name = instance.name();
+    job.result = std::make_shared<BakeResult>();
+
+    const Settings settings = m_settings;
+    std::shared_ptr<BakeResult> result = job.result;
+    if (m_database && isFile(instance.sourcePath())) {
+        const AssetDatabase::ArtifactKey key = artifactKey(instance);
+        job.cachePath = m_database->artifactPath(key);
+        job.done = m_database->request(key, [items = std::move(items), settings, result](AssetDatabase::ImportContext& context) {
+            *result = bake(items, settings);
+            return writeCache(context.outputPath(), *result);
+        });
+    } else {
+        job.done = std::async(std::launch::async, [items = std::move(items), settings, result]() {
+            *result = bake(items, settings);
+            return true;
+        }).share();
+    }
+    m_jobs.push_back(std::move(job));
+}
+
+void AmbientOcclusionBaker::requestBakeAll(const MeshManager& meshManager)
+{
+    for (const MeshInstance& instance : meshManager.instances())
+        requestBake(instance);
+}
+
+void AmbientOcclusionBaker::update(MeshManager& meshManager)
+{
+    if (m_settings.bakeOnImport) {
+        for (const MeshInstance& instance : meshManager.instances()) {
+            if (!m_requested.contains(instance.id()))
+                requestBake(instance);
+        }
+    }
+
+    for (auto it = m_jobs.begin(); it != m_jobs.end();) {
+        if (it->done.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        const Job job = std::move(*it);
+        it = m_jobs.erase(it);
+
+        bool succeeded = job.done.get();
+        BakeResult& result = *job.result;
+        const bool traced = result.rays > 0;
+        // Nothing traced here: the artifact was valid already or another request baked it.
+        if (succeeded && !traced && !job.cachePath.empty())
+            succeeded = readCache(job.cachePath, result);
+
+        auto& instances = meshManager.instances();
+        const auto instance = std::find_if(instances.begin(), instances.end(), [&](const MeshInstance& candidate) {
+            return candidate.id() == job.instanceId;
+        });
+        if (instance == instances.end())
+            continue;
+        if (!succeeded || !apply(*instance, result)) {
+            ++m_failures;
+            LOG_ERROR(logging::Category::Mesh, "[AOBake] {}: bake failed", job.name);
+            continue;
+        }
+
+        ++m_bakedInstances;
+        if (!traced) {
+            ++m_cacheHits;
+            LOG_INFO(logging::Category::Mesh, "[AOBake] {}: {} vertices from cache", job.name, result.vertices);
+            continue;
+        }
+
+        ++m_bakesRun;
+        m_totalRays += result.rays;
+        m_lastVertices = result.vertices;
+        m_lastSeconds = result.seconds;
+        m_lastRaysPerSecond = result.seconds > 0.0 ? static_cast<double>(result.rays) / result.seconds : 0.0;
+        m_raysCounter.add(result.rays);
+        m_raysPerSecondGauge.set(m_lastRaysPerSecond);
+        LOG_INFO(logging::Category::Mesh, "[AOBake] {}: {} vertices, {} rays in {:.2f} s ({:.2f} Mrays/s)",
+            job.name, result.vertices, result.rays, result.seconds, m_lastRaysPerSecond / 1.0e6);
+    }
+}
+
+bool AmbientOcclusionBaker::apply(MeshInstance& instance, BakeResult& result)
+{
+    std::vector<MeshDrawItem>& drawItems = instance.drawItems();
+    if (result.items.size() != drawItems.size())
+        return false;
+    for (std::size_t i = 0; i < drawItems.size(); ++i) {
+        // A streamed-out item has no CPU geometry to check against; GPUMesh::setVertexOcclusion()
+        // checks the size again when the item is restored.
+        if (drawItems[i].cpuGeometry && result.items[i].size() != drawItems[i].cpuGeometry->positions.size())
+            return false;
+    }
+
+    for (std::size_t i = 0; i < drawItems.size(); ++i) {
+        if (result.items[i].empty())
+            continue;
+        MeshDrawItem& item = drawItems[i];
+        item.vertexOcclusion = std::make_shared<const std::vector<glm::vec4>>(std::move(result.items[i]));
+        if (item.geometry.resident())
+            item.geometry.setVertexOcclusion(*item.vertexOcclusion);
+    }
+    return true;
+}
+
+void AmbientOcclusionBaker::clearResults(MeshManager& meshManager)
+{
+    for (MeshInstance& instance : meshManager.instances()) {
+        for (MeshDrawItem& item : instance.drawItems()) {
+            item.vertexOcclusion.reset();
+            item.geometry.clearVertexOcclusion();
+        }
+    }
+    m_bakedInstances = 0;
+}
+
+AmbientOcclusionBaker::Stats AmbientOcclusionBaker::stats() const
+{
+    Stats stats;
+    stats.pending = m_jobs.size();
+    stats.bakedInstances = m_bakedInstances;
+    stats.bakesRun = m_bakesRun;
+    stats.cacheHits = m_cacheHits;
+    stats.failures = m_failures;
+    stats.totalRays = m_totalRays;
+    stats.lastVertices = m_lastVertices;
+    stats.lastSeconds = m_lastSeconds;
+    stats.lastRaysPerSecond = m_lastRaysPerSecond;
+    return stats;
+}
+
+void AmbientOcclusionBaker::drawImGuiPanel(MeshManager& meshManager)
+{
+    ImGui::Checkbox("Bake On Import", &m_settings.bakeOnImport);
+    ImGui::SliderInt("Rays Per Vertex", &m_settings.raysPerVertex, 8, 512);
+    ImGui::SliderFloat("Max Distance", &m_settings.maxDistance, 0.01f, 1.0f, "%.2f x diagonal");
+    int threads = static_cast<int>(m_settings.threads);
+    if (ImGui::SliderInt("Threads (0 = all)", &threads, 0, static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))))
+        m_settings.threads = static_cast<unsigned>(threads);
+
+    if (ImGui::Button("Bake All"))
+        requestBakeAll(meshManager);
+    ImGui::SameLine();
+    if (ImGui::Button("Clear"))
+        clearResults(meshManager);
+
+    const Stats current = stats();
+    ImGui::Text("Pending: %zu | baked instances: %zu | cache hits: %llu | failures: %llu",
+        current.pending, current.bakedInstances,
+        static_cast<unsigned long long>(current.cacheHits), static_cast<unsigned long long>(current.failures));
+    ImGui::Text("Last bake: %llu vertices in %.2f s, %.2f Mrays/s",
+        static_cast<unsigned long long>(current.lastVertices), current.lastSeconds, current.lastRaysPerSecond / 1.0e6);
+    ImGui::Text("Rays traced: %llu", static_cast<unsigned long long>(current.totalRays));
+}
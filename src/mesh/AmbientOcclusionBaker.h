@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "io/AssetDatabase.h"
+#include "metrics/MetricsRegistry.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+class MeshInstance;
+class MeshManager;
+struct MeshGeometryData;
+
+// Bakes per-vertex ambient occlusion and bent normals by tracing cosine-distributed hemisphere rays
+// from every vertex against a RayBvh over all of the instance's triangles. Node transforms are
+// applied but the instance transform is not, so results survive moving the instance. Vertices are
+// spread over all cores. Bakes of file-backed instances are "vertex_ao" artifacts in the asset
+// database, keyed by source and bake settings, so a model is traced once and later loads read the
+// cached stream. Results become GPUMesh's occlusion stream, which the lit shaders fold into their
+// ambient term (unless the material has an authored occlusion map) and diffuse IBL lookup. Bakes
+// are started from the panel unless bakeOnImport is turned on.
+class AmbientOcclusionBaker {
+public:
+    static constexpr std::uint32_t kBakeVersion = 1;
+
+    struct Settings {
+        bool bakeOnImport { false }; // off by default: a bake keeps every core busy
+        int raysPerVertex { 64 };
+        float maxDistance { 0.25f }; // fraction of the instance's bounding-box diagonal
+        float bias { 1e-4f }; // ray origin offset along the normal, fraction of the diagonal
+        unsigned threads { 0 }; // 0: one per hardware thread
+    };
+
+    // One draw item's geometry; `geometry` may be null, the item is then skipped.
+    struct BakeItem {
+        std::shared_ptr<const MeshGeometryData> geometry;
+        glm::mat4 nodeTransform { 1.0f };
+    };
+
+    struct BakeResult {
+        // Per item, per vertex: bent normal in the item's local space (zero when fully occluded) in
+        // xyz, fraction of unoccluded rays in w.
+        std::vector<std::vector<glm::vec4>> items;
+        std::uint64_t rays { 0 };
+        std::uint64_t vertices { 0 };
+        double seconds { 0.0 };
+    };
+
+    struct Stats {
+        std::size_t pending { 0 };
+        std::size_t bakedInstances { 0 };
+        std::uint64_t bakesRun { 0 };
+        std::uint64_t cacheHits { 0 };
+        std::uint64_t failures { 0 };
+        std::uint64_t totalRays { 0 };
+        std::uint64_t lastVertices { 0 };
+        double lastSeconds { 0.0 };
+        double lastRaysPerSecond { 0.0 };
+    };
+
+    AmbientOcclusionBaker() = default;
+    AmbientOcclusionBaker(const AmbientOcclusionBaker&) = delete;
+    AmbientOcclusionBaker& operator=(const AmbientOcclusionBaker&) = delete;
+
+    // Runs on the calling thread plus settings.threads - 1 workers; usable without a GL context.
+    [[nodiscard]] static BakeResult bake(const std::vector<BakeItem>& items, const Settings& settings);
+
+    void setAssetDatabase(AssetDatabase* database);
+    void setMetricsRegistry(MetricsRegistry* registry);
+
+    // Applies finished bakes and, with bakeOnImport, starts bakes for instances not seen before.
+    void update(MeshManager& meshManager);
+    void requestBake(const MeshInstance& instance);
+    void requestBakeAll(const MeshManager& meshManager);
+    // Removes the occlusion stream from every instance.
+    void clearResults(MeshManager& meshManager);
+
+    [[nodiscard]] const Settings& settings() const { return m_settings; }
+    void setSettings(const Settings& settings) { m_settings = settings; }
+    [[nodiscard]] Stats stats() const;
+    void drawImGuiPanel(MeshManager& meshManager);
+
+private:
+    struct Job {
+        std::uint64_t instanceId { 0 };
+        std::string name;
+        std::filesystem::path cachePath; // empty when the bake is not cached
+        std::shared_ptr<BakeResult> result;
+        std::shared_future<bool> done;
+    };
+
+    [[nodiscard]] AssetDatabase::ArtifactKey artifactKey(const MeshInstance& instance) const;
+    bool apply(MeshInstance& instance, BakeResult& result);
+
+    Settings m_settings;
+    AssetDatabase* m_database { nullptr };
+    std::vector<Job> m_jobs;
+    std::unordered_set<std::uint64_t> m_requested; // instance ids
+
+    std::size_t m_bakedInstances { 0 };
+    std::uint64_t m_bakesRun { 0 };
+    std::uint64_t m_cacheHits { 0 };
+    std::uint64_t m_failures { 0 };
+    std::uint64_t m_totalRays { 0 };
+    std::uint64_t m_lastVertices { 0 };
+    double m_lastSeconds { 0.0 };
+    double m_lastRaysPerSecond { 0.0 };
+
+    MetricsRegistry::Gauge m_raysPerSecondGauge;
+    MetricsRegistry::Counter m_raysCounter;
+};
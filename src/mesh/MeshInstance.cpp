@@ -6,11 +6,15 @@
 
 #include <glm/common.hpp>
 
+#include <atomic>
 #include <limits>
 #include <utility>
 
 namespace {
 
+// Instances are also created on the async loading threads.
+std::atomic<std::uint64_t> g_nextInstanceId { 1 };
+
 BoundingBox computeBounds(const Mesh& mesh)
 {
     BoundingBox bounds;
@@ -58,10 +62,21 @@ RenderMaterial makeRenderMaterialFrom(const Material& sourceMaterial)
     return material;
 }
 
+std::shared_ptr<const MeshGeometryData> makeGeometryData(const Mesh& mesh)
+{
+    auto geometry = std::make_shared<MeshGeometryData>();
+    geometry->positions.reserve(mesh.vertices.size());
+    for (const Vertex& vertex : mesh.vertices)
+        geometry->positions.push_back(vertex.position);
+    geometry->triangles = mesh.triangles;
+    return geometry;
+}
+
 }
 
 MeshInstance::MeshInstance(const std::filesystem::path& path, bool normalize)
-    : m_name(path.filename().string())
+    : m_id(g_nextInstanceId++)
+    , m_name(path.filename().string())
     , m_sourcePath(path)
 {
     std::vector<Mesh> cpuMeshes = loadMesh(path, { .normalizeVertexPositions = normalize });
@@ -69,14 +84,16 @@ MeshInstance::MeshInstance(const std::filesystem::path& path, bool normalize)
 }
 
 MeshInstance::MeshInstance(const std::filesystem::path& path, std::vector<Mesh>&& meshes)
-    : m_name(path.filename().string())
+    : m_id(g_nextInstanceId++)
+    , m_name(path.filename().string())
     , m_sourcePath(path)
 {
     initializeFromMeshes(std::move(meshes));
 }
 
 MeshInstance::MeshInstance(const std::filesystem::path& path, std::vector<MeshDrawItem>&& items)
-    : m_name(path.filename().string())
+    : m_id(g_nextInstanceId++)
+    , m_name(path.filename().string())
     , m_sourcePath(path)
 {
     initializeFromDrawItems(std::move(items));
@@ -115,6 +132,7 @@ const glm::mat4& MeshInstance::transform() const
 void MeshInstance::setTransform(const glm::mat4& transform)
 {
     m_transform = transform;
+    ++m_transformVersion;
 }
 
 const BoundingBox& MeshInstance::localBounds() const
@@ -134,12 +152,15 @@ void MeshInstance::initializeFromMeshes(std::vector<Mesh>&& meshes)
     for (Mesh& mesh : meshes) {
         BoundingBox meshBounds = computeBounds(mesh);
         expandBounds(aggregate, meshBounds);
+        std::shared_ptr<const MeshletData> meshlets = buildMeshlets(mesh);
         GPUMesh gpuMesh(mesh);
         const bool hasUVs = gpuMesh.hasTextureCoords();
         const bool hasSecondaryUVs = gpuMesh.hasSecondaryTextureCoords();
         const bool hasTangents = gpuMesh.hasTangents();
         RenderMaterial material = makeRenderMaterialFrom(mesh.material);
         items.emplace_back(std::move(gpuMesh), std::move(material), glm::mat4(1.0f), meshBounds, hasUVs, hasSecondaryUVs, hasTangents);
+        items.back().cpuGeometry = makeGeometryData(mesh);
+        items.back().meshlets = std::move(meshlets);
     }
 
     if (aggregate.min.x == std::numeric_limits<float>::max()) {
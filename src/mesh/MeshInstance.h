@@ -2,13 +2,17 @@
 
 #pragma once
 
+#include "mesh/Meshlets.h"
 #include "mesh/mesh.h"
 #include "rendering/Material.h"
 
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 
+#include <cstdint>
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -17,6 +21,13 @@ struct BoundingBox {
     glm::vec3 max { 0.0f };
 };
 
+// CPU copy of a draw item's triangles in mesh-local space (before nodeTransform), kept for
+// CPU-side queries such as collision.
+struct MeshGeometryData {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::uvec3> triangles;
+};
+
 struct MeshDrawItem {
     GPUMesh geometry;
     RenderMaterial material;
@@ -25,6 +36,11 @@ struct MeshDrawItem {
     bool hasTangents { false };
     glm::mat4 nodeTransform { 1.0f };
     BoundingBox bounds;
+    std::shared_ptr<const MeshGeometryData> cpuGeometry;
+    // Set when the index buffer was reordered into meshlets at import; null for small meshes.
+    std::shared_ptr<const MeshletData> meshlets;
+    // Baked by AmbientOcclusionBaker, one entry per vertex; kept so streaming can re-upload it.
+    std::shared_ptr<const std::vector<glm::vec4>> vertexOcclusion;
 
     MeshDrawItem(GPUMesh&& mesh,
         RenderMaterial material = {},
@@ -55,6 +71,8 @@ public:
     MeshInstance(const std::filesystem::path& path, std::vector<Mesh>&& meshes);
     MeshInstance(const std::filesystem::path& path, std::vector<MeshDrawItem>&& items);
 
+    // Unique for the lifetime of the process; stays stable when the instance is moved around in containers.
+    [[nodiscard]] std::uint64_t id() const { return m_id; }
     [[nodiscard]] const std::string& name() const;
     void setName(std::string name);
     [[nodiscard]] const std::filesystem::path& sourcePath() const;
@@ -64,18 +82,28 @@ public:
 
     [[nodiscard]] const glm::mat4& transform() const;
     void setTransform(const glm::mat4& transform);
+    // Incremented by every setTransform() so dependent caches can detect moves cheaply.
+    [[nodiscard]] std::uint64_t transformVersion() const { return m_transformVersion; }
 
     [[nodiscard]] const BoundingBox& localBounds() const;
 
+    // Whether world partition streaming may evict this instance's geometry. Off for primitives,
+    // which are small and drawn by dedicated code paths.
+    [[nodiscard]] bool streamable() const { return m_streamable; }
+    void setStreamable(bool streamable) { m_streamable = streamable; }
+
 private:
     void initializeFromMeshes(std::vector<Mesh>&& meshes);
     void initializeFromDrawItems(std::vector<MeshDrawItem>&& items);
 
 private:
+    std::uint64_t m_id { 0 };
     std::string m_name;
     std::filesystem::path m_sourcePath;
 
     std::vector<MeshDrawItem> m_drawItems;
     glm::mat4 m_transform { 1.0f };
+    std::uint64_t m_transformVersion { 0 };
     BoundingBox m_localBounds;
+    bool m_streamable { true };
 };
@@ -15,6 +15,9 @@ DISABLE_WARNINGS_POP()
 
 #include "scene/ModelLoader.h"
 
+#include <framework/file_provider.h>
+#include <framework/log.h>
+
 #include <algorithm>
 #include <exception>
 #include <memory>
@@ -22,10 +25,9 @@ DISABLE_WARNINGS_POP()
 #include <array>
 #include <limits>
 #include <system_error>
-#include <iostream>
 
 namespace {
-std::shared_ptr<Texture> loadTexture(const MaterialTextureReference& reference, bool srgb, int forceChannels = 0)
+std::shared_ptr<Texture> loadTexture(const MaterialTextureReference& reference, bool srgb, const TextureImportOptions& import = {})
 {
     if (!reference.isValid())
         return nullptr;
@@ -33,41 +35,59 @@ std::shared_ptr<Texture> loadTexture(const MaterialTextureReference& reference,
     try {
         std::shared_ptr<Texture> tex;
         if (reference.path) {
-            tex = std::make_shared<Texture>(*reference.path, srgb, reference.sampler, forceChannels);
-            std::cout << "[Texture Loaded] " << reference.path->string()
-                      << " ID=" << tex->id() << " sRGB=" << (srgb ? "yes" : "no");
-            if (forceChannels > 0) {
-                std::cout << " forceChannels=" << forceChannels;
-            }
-            std::cout << "\n";
+            tex = std::make_shared<Texture>(*reference.path, srgb, reference.sampler, import);
+            if (import.channels > 0)
+                LOG_INFO(logging::Category::Texture, "[Texture Loaded] {} ID={} sRGB={} forceChannels={}", *reference.path, tex->id(), srgb ? "yes" : "no", import.channels);
+            else
+                LOG_INFO(logging::Category::Texture, "[Texture Loaded] {} ID={} sRGB={}", *reference.path, tex->id(), srgb ? "yes" : "no");
         } else if (reference.embedded) {
-            tex = std::make_shared<Texture>(*reference.embedded, srgb, reference.sampler);
-            std::cout << "[Texture Embedded] ID=" << tex->id() << " sRGB=" << (srgb ? "yes" : "no") << "\n";
+            tex = std::make_shared<Texture>(*reference.embedded, srgb, reference.sampler, import);
+            LOG_INFO(logging::Category::Texture, "[Texture Embedded] ID={} sRGB={}", tex->id(), srgb ? "yes" : "no");
         }
         
         if (tex && tex->id() == 0) {
-            std::cerr << "[ERROR] Texture created but has invalid ID=0\n";
+            LOG_ERROR(logging::Category::Texture, "Texture created but has invalid ID=0");
             return nullptr;
         }
         
         return tex;
     } catch (const std::exception& ex) {
-        std::cerr << "[ERROR] Texture load failed: " << ex.what() << "\n";
-        if (reference.path) {
-            std::cerr << "         Path: " << reference.path->string() << "\n";
-        }
+        if (reference.path)
+            LOG_ERROR(logging::Category::Texture, "Texture load failed: {} (path: {})", ex.what(), *reference.path);
+        else
+            LOG_ERROR(logging::Category::Texture, "Texture load failed: {}", ex.what());
         return nullptr;
     }
 
     return nullptr;
 }
 
+// Starts reading every texture the meshes reference before the first one is decoded, so that the
+// disk works through the batch while earlier textures are decoded and uploaded.
+void prefetchMaterialTextures(const std::vector<MeshData>& meshes)
+{
+    std::vector<std::filesystem::path> paths;
+    for (const MeshData& data : meshes) {
+        const MaterialTextures& textures = data.textures;
+        for (const MaterialTextureReference* reference : { &textures.baseColor, &textures.metallicRoughness, &textures.normal,
+                 &textures.occlusion, &textures.emissive, &textures.height }) {
+            if (reference->path && std::find(paths.begin(), paths.end(), *reference->path) == paths.end())
+                paths.push_back(*reference->path);
+        }
+    }
+    if (!paths.empty())
+        prefetchFiles(paths, ReadPriority::Visible);
+}
+
 void applyTextureMaps(RenderMaterial& material, const MaterialTextures& textures)
 {
     material.albedoMap = loadTexture(textures.baseColor, true);
     material.metallicRoughnessMap = loadTexture(textures.metallicRoughness, false);
     // Force normal maps to load with 4 channels (RGBA) so alpha can be used for height in parallax mapping
-    material.normalMap = loadTexture(textures.normal, false, 4);
+    TextureImportOptions normalImport;
+    normalImport.channels = 4;
+    normalImport.normalMap = true;
+    material.normalMap = loadTexture(textures.normal, false, normalImport);
     material.aoMap = loadTexture(textures.occlusion, false);
     material.emissiveMap = loadTexture(textures.emissive, true);
     // Optional dedicated height map (linear)
@@ -81,13 +101,13 @@ void applyTextureMaps(RenderMaterial& material, const MaterialTextures& textures
             // Try relative to working directory
             std::filesystem::path forcedDisp = std::filesystem::path("resources/brick_wall/textures/Ground002_4K-JPG_Displacement.jpg");
             // Also try an absolute path known for this workspace
-            if (!std::filesystem::exists(forcedDisp))
+            if (!fileExists(forcedDisp))
                 forcedDisp = std::filesystem::path("/home/migster232/uni/3DCGA/assignment_2/computer-graphics-course/assignment_2/resources/brick_wall/textures/Ground002_4K-JPG_Displacement.jpg");
-            if (std::filesystem::exists(forcedDisp)) {
+            if (fileExists(forcedDisp)) {
                 TextureSamplerSettings sampler; // default
                 auto tex = std::make_shared<Texture>(forcedDisp, false, sampler);
                 if (tex && tex->id() != 0) {
-                    std::cout << "[Height] Using forced displacement: " << forcedDisp.string() << " ID=" << tex->id() << "\n";
+                    LOG_INFO(logging::Category::Mesh, "[Height] Using forced displacement: {} ID={}", forcedDisp, tex->id());
                     material.heightMap = std::move(tex);
                     // Align height UVs/transform with the normal map by default
                     material.heightUV = textures.normal.texCoord;
@@ -97,7 +117,7 @@ void applyTextureMaps(RenderMaterial& material, const MaterialTextures& textures
                 }
             }
         } catch (const std::exception& ex) {
-            std::cerr << "[Height] Forced displacement load failed: " << ex.what() << "\n";
+            LOG_ERROR(logging::Category::Mesh, "[Height] Forced displacement load failed: {}", ex.what());
         }
 
         // 2) Auto-discover sibling displacement if still not set
@@ -111,8 +131,6 @@ void applyTextureMaps(RenderMaterial& material, const MaterialTextures& textures
                 return std::nullopt;
             const std::filesystem::path& p = *ref.path;
             const std::filesystem::path dir = p.parent_path();
-            if (!std::filesystem::exists(dir))
-                return std::nullopt;
 
             // Try to infer a prefix from the reference filename (up to the last underscore),
             // so we prefer files from the same texture set.
@@ -126,10 +144,8 @@ void applyTextureMaps(RenderMaterial& material, const MaterialTextures& textures
             std::filesystem::path best;
             int bestScore = -1; // 2 = exact prefix + displacement; 1 = displacement token; 0 = any height-ish token
 
-            for (const auto& entry : std::filesystem::directory_iterator(dir)) {
-                if (!entry.is_regular_file())
-                    continue;
-                const std::string name = entry.path().filename().string();
+            for (const std::filesystem::path& entry : listFiles(dir)) {
+                const std::string name = entry.filename().string();
                 const std::string lower = toLower(name);
                 const bool tokenDisp = lower.find("displacement") != std::string::npos || lower.find("disp") != std::string::npos;
                 const bool tokenHeight = lower.find("height") != std::string::npos;
@@ -142,7 +158,7 @@ void applyTextureMaps(RenderMaterial& material, const MaterialTextures& textures
 
                 if (score > bestScore) {
                     bestScore = score;
-                    best = entry.path();
+                    best = entry;
                 }
             }
 
@@ -162,7 +178,7 @@ void applyTextureMaps(RenderMaterial& material, const MaterialTextures& textures
                 // Load linear (non-sRGB)
                 auto tex = std::make_shared<Texture>(*candidate, false, sampler);
                 if (tex && tex->id() != 0) {
-                    std::cout << "[Auto-Height] Using sibling displacement: " << candidate->string() << " ID=" << tex->id() << "\n";
+                    LOG_INFO(logging::Category::Mesh, "[Auto-Height] Using sibling displacement: {} ID={}", *candidate, tex->id());
                     material.heightMap = std::move(tex);
                     // Align height UVs/transform with the normal map by default
                     material.heightUV = textures.normal.texCoord;
@@ -171,7 +187,7 @@ void applyTextureMaps(RenderMaterial& material, const MaterialTextures& textures
                     material.heightUVTransform.rotation = textures.normal.uvRotation;
                 }
             } catch (const std::exception& ex) {
-                std::cerr << "[Auto-Height] Failed to load sibling displacement: " << ex.what() << "\n";
+                LOG_ERROR(logging::Category::Mesh, "[Auto-Height] Failed to load sibling displacement: {}", ex.what());
             }
         }
     }
@@ -477,15 +493,10 @@ MeshManager::MeshManager(const std::filesystem::path& meshDirectory, bool normal
 void MeshManager::refreshAvailableMeshes()
 {
     m_availableMeshes.clear();
-    if (!std::filesystem::exists(m_meshDirectory))
-        return;
-
-    for (const auto& entry : std::filesystem::directory_iterator(m_meshDirectory)) {
-        if (!entry.is_regular_file())
-            continue;
-        const auto ext = entry.path().extension();
+    for (const std::filesystem::path& entry : listFiles(m_meshDirectory)) {
+        const auto ext = entry.extension();
         if (ext == ".obj" || ext == ".OBJ")
-            m_availableMeshes.push_back(entry.path());
+            m_availableMeshes.push_back(entry);
     }
 
     std::sort(m_availableMeshes.begin(), m_availableMeshes.end());
@@ -505,7 +516,7 @@ bool MeshManager::loadMeshByIndex(std::size_t index)
 
 bool MeshManager::loadMeshFromPath(const std::filesystem::path& path)
 {
-    if (!std::filesystem::exists(path))
+    if (!fileExists(path))
         return false;
 
     MeshInstance instance(path, m_normalizeOnLoad);
@@ -533,10 +544,12 @@ bool MeshManager::addMeshFromData(const std::filesystem::path& sourcePath, const
 
     std::vector<MeshDrawItem> items;
     items.reserve(meshes.size());
+    prefetchMaterialTextures(meshes);
 
     for (const MeshData& data : meshes) {
         Mesh cpuMesh = meshFromData(data);
         BoundingBox bounds = boundsFromData(data);
+        std::shared_ptr<const MeshletData> meshlets = buildMeshlets(cpuMesh);
         GPUMesh gpuMesh(cpuMesh);
         RenderMaterial material = data.material;
         applyTextureMaps(material, data.textures);
@@ -545,6 +558,12 @@ bool MeshManager::addMeshFromData(const std::filesystem::path& sourcePath, const
         const bool hasSecondary = data.hasSecondaryUVs;
         const bool hasTangents = data.hasTangents;
         items.emplace_back(std::move(gpuMesh), std::move(material), data.nodeTransform, bounds, hasUVs, hasSecondary, hasTangents);
+
+        auto geometry = std::make_shared<MeshGeometryData>();
+        geometry->positions = data.positions;
+        geometry->triangles = std::move(cpuMesh.triangles);
+        items.back().cpuGeometry = std::move(geometry);
+        items.back().meshlets = std::move(meshlets);
     }
 
     MeshInstance instance(sourcePath, std::move(items));
@@ -768,6 +787,7 @@ std::optional<std::size_t> MeshManager::createSpherePrimitive(const std::string&
 
     if (m_instances.empty())
         return std::nullopt;
+    m_instances.back().setStreamable(false);
 
     const auto makeUnique = [&](const std::string& desired) {
         if (std::none_of(m_instances.begin(), m_instances.end() - 1, [&](const MeshInstance& other) { return other.name() == desired; }))
@@ -803,6 +823,7 @@ std::optional<std::size_t> MeshManager::createQuadPrimitive(const std::string& n
 
     if (m_instances.empty())
         return std::nullopt;
+    m_instances.back().setStreamable(false);
 
     const auto makeUnique = [&](const std::string& desired) {
         if (std::none_of(m_instances.begin(), m_instances.end() - 1, [&](const MeshInstance& other) { return other.name() == desired; }))
@@ -838,6 +859,7 @@ std::optional<std::size_t> MeshManager::createBoxPrimitive(const std::string& na
 
     if (m_instances.empty())
         return std::nullopt;
+    m_instances.back().setStreamable(false);
 
     const auto makeUnique = [&](const std::string& desired) {
         if (std::none_of(m_instances.begin(), m_instances.end() - 1, [&](const MeshInstance& other) { return other.name() == desired; }))
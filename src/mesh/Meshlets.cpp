@@ -0,0 +1,273 @@
+// SPDX-License-Identifier: MIT
+#include "mesh/Meshlets.h"
+
+#include <framework/disable_all_warnings.h>
+#include <framework/log.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtx/norm.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Penalty (in "new vertices") for adding a triangle whose normal disagrees with the cluster; keeps cones tight.
+constexpr float kNormalDeviationWeight = 2.0f;
+constexpr std::uint32_t kNoStamp = std::numeric_limits<std::uint32_t>::max();
+
+struct VertexAdjacency {
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> triangles;
+};
+
+[[nodiscard]] VertexAdjacency buildAdjacency(std::size_t vertexCount, const std::vector<glm::uvec3>& triangles)
+{
+    VertexAdjacency adjacency;
+    adjacency.offsets.assign(vertexCount + 1, 0);
+    for (const glm::uvec3& triangle : triangles) {
+        ++adjacency.offsets[triangle.x + 1];
+        ++adjacency.offsets[triangle.y + 1];
+        ++adjacency.offsets[triangle.z + 1];
+    }
+    for (std::size_t i = 1; i <= vertexCount; ++i)
+        adjacency.offsets[i] += adjacency.offsets[i - 1];
+
+    adjacency.triangles.resize(adjacency.offsets.back());
+    std::vector<std::uint32_t> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    for (std::uint32_t t = 0; t < triangles.size(); ++t) {
+        for (int k = 0; k < 3; ++k)
+            adjacency.triangles[cursor[triangles[t][k]]++] = t;
+    }
+    return adjacency;
+}
+
+class MeshletBuilder {
+public:
+    MeshletBuilder(const std::vector<glm::vec3>& positions, const std::vector<glm::uvec3>& triangles)
+        : m_positions(positions)
+        , m_triangles(triangles)
+        , m_adjacency(buildAdjacency(positions.size(), triangles))
+        , m_emitted(triangles.size(), 0)
+        , m_vertexStamp(positions.size(), kNoStamp)
+    {
+        m_normals.reserve(triangles.size());
+        for (const glm::uvec3& triangle : triangles) {
+            const glm::vec3 n = glm::cross(positions[triangle.y] - positions[triangle.x], positions[triangle.z] - positions[triangle.x]);
+            const float length = glm::length(n);
+            m_normals.push_back(length > 1e-12f ? n / length : glm::vec3(0.0f));
+        }
+        m_order.reserve(triangles.size());
+    }
+
+    MeshletData build()
+    {
+        MeshletData data;
+        data.triangleCount = static_cast<std::uint32_t>(m_triangles.size());
+
+        std::size_t seedCursor = 0;
+        while (m_order.size() < m_triangles.size()) {
+            // Continue next to the previous cluster when possible so neighbouring meshlets stay spatially coherent.
+            std::uint32_t seed = kNoStamp;
+            for (std::uint32_t candidate : m_candidates) {
+                if (!m_emitted[candidate]) {
+                    seed = candidate;
+                    break;
+                }
+            }
+            if (seed == kNoStamp) {
+                while (m_emitted[seedCursor])
+                    ++seedCursor;
+                seed = static_cast<std::uint32_t>(seedCursor);
+            }
+
+            const std::uint32_t first = static_cast<std::uint32_t>(m_order.size());
+            growMeshlet(data.meshletCount, seed);
+            appendBounds(data, first, static_cast<std::uint32_t>(m_order.size()) - first);
+            ++data.meshletCount;
+        }
+
+        const std::size_t padded = (data.meshletCount + MeshletData::kMeshletLaneWidth - 1) / MeshletData::kMeshletLaneWidth * MeshletData::kMeshletLaneWidth;
+        for (std::vector<float>* lane : { &data.centerX, &data.centerY, &data.centerZ, &data.radius, &data.coneAxisX, &data.coneAxisY, &data.coneAxisZ })
+            lane->resize(padded, 0.0f);
+        data.coneCutoff.resize(padded, 1.0f);
+        return data;
+    }
+
+    [[nodiscard]] const std::vector<glm::uvec3>& order() const { return m_order; }
+
+private:
+    void addTriangle(std::uint32_t meshletIndex, std::uint32_t triangleIndex)
+    {
+        m_emitted[triangleIndex] = 1;
+        m_order.push_back(m_triangles[triangleIndex]);
+        m_normalSum += m_normals[triangleIndex];
+        ++m_triangleCount;
+
+        for (int k = 0; k < 3; ++k) {
+            const std::uint32_t vertex = m_triangles[triangleIndex][k];
+            if (m_vertexStamp[vertex] == meshletIndex)
+                continue;
+            m_vertexStamp[vertex] = meshletIndex;
+            ++m_vertexCount;
+            for (std::uint32_t i = m_adjacency.offsets[vertex]; i < m_adjacency.offsets[vertex + 1]; ++i) {
+                const std::uint32_t neighbour = m_adjacency.triangles[i];
+                if (!m_emitted[neighbour])
+                    m_candidates.push_back(neighbour);
+            }
+        }
+    }
+
+    void growMeshlet(std::uint32_t meshletIndex, std::uint32_t seed)
+    {
+        m_candidates.clear();
+        m_normalSum = glm::vec3(0.0f);
+        m_vertexCount = 0;
+        m_triangleCount = 0;
+        addTriangle(meshletIndex, seed);
+
+        while (m_triangleCount < MeshletData::kMaxMeshletTriangles) {
+            const float axisLength = glm::length(m_normalSum);
+            const glm::vec3 axis = axisLength > 1e-6f ? m_normalSum / axisLength : glm::vec3(0.0f);
+
+            std::uint32_t best = kNoStamp;
+            float bestScore = std::numeric_limits<float>::max();
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < m_candidates.size(); ++i) {
+                const std::uint32_t candidate = m_candidates[i];
+                if (m_emitted[candidate])
+                    continue;
+                m_candidates[kept++] = candidate;
+
+                const glm::uvec3& triangle = m_triangles[candidate];
+                std::uint32_t newVertices = 0;
+                for (int k = 0; k < 3; ++k)
+                    newVertices += (m_vertexStamp[triangle[k]] != meshletIndex) ? 1u : 0u;
+                if (m_vertexCount + newVertices > MeshletData::kMaxMeshletVertices)
+                    continue;
+
+                const float deviation = 1.0f - glm::dot(m_normals[candidate], axis);
+                const float score = static_cast<float>(newVertices) + deviation * kNormalDeviationWeight;
+                if (score < bestScore) {
+                    bestScore = score;
+                    best = candidate;
+                }
+            }
+            m_candidates.resize(kept);
+
+            if (best == kNoStamp)
+                break;
+            addTriangle(meshletIndex, best);
+        }
+    }
+
+    void appendBounds(MeshletData& data, std::uint32_t first, std::uint32_t count) const
+    {
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+        glm::vec3 normalSum(0.0f);
+        for (std::uint32_t t = first; t < first + count; ++t) {
+            const glm::uvec3& triangle = m_order[t];
+            for (int k = 0; k < 3; ++k) {
+                boundsMin = glm::min(boundsMin, m_positions[triangle[k]]);
+                boundsMax = glm::max(boundsMax, m_positions[triangle[k]]);
+            }
+        }
+        const glm::vec3 center = 0.5f * (boundsMin + boundsMax);
+        float radiusSq = 0.0f;
+        for (std::uint32_t t = first; t < first + count; ++t) {
+            const glm::uvec3& triangle = m_order[t];
+            for (int k = 0; k < 3; ++k)
+                radiusSq = std::max(radiusSq, glm::distance2(center, m_positions[triangle[k]]));
+        }
+
+        // Normal cone over the unit face normals (degenerate triangles have a zero normal and are skipped).
+        std::vector<glm::vec3> faceNormals;
+        faceNormals.reserve(count);
+        for (std::uint32_t t = first; t < first + count; ++t) {
+            const glm::uvec3& triangle = m_order[t];
+            const glm::vec3 n = glm::cross(m_positions[triangle.y] - m_positions[triangle.x], m_positions[triangle.z] - m_positions[triangle.x]);
+            const float length = glm::length(n);
+            if (length > 1e-12f) {
+                faceNormals.push_back(n / length);
+                normalSum += faceNormals.back();
+            }
+        }
+
+        glm::vec3 axis(0.0f);
+        float cutoff = 1.0f;
+        const float axisLength = glm::length(normalSum);
+        if (axisLength > 1e-6f) {
+            axis = normalSum / axisLength;
+            float minDot = 1.0f;
+            for (const glm::vec3& n : faceNormals)
+                minDot = std::min(minDot, glm::dot(n, axis));
+            if (minDot > 0.0f)
+                cutoff = std::sqrt(std::max(0.0f, 1.0f - minDot * minDot));
+        }
+
+        data.centerX.push_back(center.x);
+        data.centerY.push_back(center.y);
+        data.centerZ.push_back(center.z);
+        data.radius.push_back(std::sqrt(radiusSq));
+        data.coneAxisX.push_back(axis.x);
+        data.coneAxisY.push_back(axis.y);
+        data.coneAxisZ.push_back(axis.z);
+        data.coneCutoff.push_back(cutoff);
+        data.firstTriangle.push_back(first);
+        data.triangleCounts.push_back(count);
+    }
+
+    const std::vector<glm::vec3>& m_positions;
+    const std::vector<glm::uvec3>& m_triangles;
+    VertexAdjacency m_adjacency;
+    std::vector<glm::vec3> m_normals;
+    std::vector<std::uint8_t> m_emitted;
+    std::vector<std::uint32_t> m_vertexStamp;
+    std::vector<std::uint32_t> m_candidates;
+    std::vector<glm::uvec3> m_order;
+
+    glm::vec3 m_normalSum { 0.0f };
+    std::uint32_t m_vertexCount { 0 };
+    std::uint32_t m_triangleCount { 0 };
+};
+
+} // namespace
+
+std::shared_ptr<const MeshletData> buildMeshlets(const std::vector<glm::vec3>& positions, std::vector<glm::uvec3>& triangles)
+{
+    if (triangles.size() < kMinTrianglesForMeshlets)
+        return nullptr;
+    for (const glm::uvec3& triangle : triangles) {
+        if (triangle.x >= positions.size() || triangle.y >= positions.size() || triangle.z >= positions.size()) {
+            LOG_WARNING(logging::Category::Mesh, "[Meshlets] Skipping mesh with out-of-range indices");
+            return nullptr;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    MeshletBuilder builder(positions, triangles);
+    auto data = std::make_shared<MeshletData>(builder.build());
+    triangles = builder.order();
+
+    const float elapsedMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG_DEBUG(logging::Category::Mesh, "[Meshlets] Split {} triangles into {} meshlets ({:.2f} ms)",
+        data->triangleCount, data->meshletCount, elapsedMs);
+    return data;
+}
+
+std::shared_ptr<const MeshletData> buildMeshlets(Mesh& mesh)
+{
+    if (mesh.triangles.size() < kMinTrianglesForMeshlets)
+        return nullptr;
+
+    std::vector<glm::vec3> positions;
+    positions.reserve(mesh.vertices.size());
+    for (const Vertex& vertex : mesh.vertices)
+        positions.push_back(vertex.position);
+    return buildMeshlets(positions, mesh.triangles);
+}
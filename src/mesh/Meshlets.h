@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <framework/mesh.h>
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Clusters of up to kMaxMeshletTriangles triangles with a bounding sphere and a normal cone, all in
+// mesh-local space (before nodeTransform). Bounds are kept as SoA so the culler can test several
+// meshlets per SIMD lane; arrays are padded to a multiple of kMeshletLaneWidth.
+struct MeshletData {
+    static constexpr std::uint32_t kMaxMeshletTriangles = 124;
+    static constexpr std::uint32_t kMaxMeshletVertices = 64;
+    static constexpr std::size_t kMeshletLaneWidth = 4;
+
+    std::uint32_t meshletCount { 0 };
+    std::uint32_t triangleCount { 0 };
+
+    std::vector<float> centerX;
+    std::vector<float> centerY;
+    std::vector<float> centerZ;
+    std::vector<float> radius;
+    // Cone cutoff is sin(half angle) of the normal spread; 1 means the cluster cannot be cone-culled.
+    std::vector<float> coneAxisX;
+    std::vector<float> coneAxisY;
+    std::vector<float> coneAxisZ;
+    std::vector<float> coneCutoff;
+
+    std::vector<std::uint32_t> firstTriangle;
+    std::vector<std::uint32_t> triangleCounts;
+};
+
+// Meshes below this size are drawn whole; splitting them costs more in draw ranges than it saves.
+constexpr std::size_t kMinTrianglesForMeshlets = 1024;
+
+// Splits the mesh into meshlets and reorders `triangles` in place so every meshlet owns a contiguous
+// index range. Returns nullptr (and leaves the triangles alone) for meshes below kMinTrianglesForMeshlets.
+[[nodiscard]] std::shared_ptr<const MeshletData> buildMeshlets(const std::vector<glm::vec3>& positions,
+    std::vector<glm::uvec3>& triangles);
+[[nodiscard]] std::shared_ptr<const MeshletData> buildMeshlets(Mesh& mesh);
@@ -0,0 +1,432 @@
+// SPDX-License-Identifier: MIT
+#include "mesh/RayBvh.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAY_BVH_SSE 1
+#include <emmintrin.h>
+#endif
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr std::uint32_t kLeafTriangles = 4;
+constexpr std::size_t kMaxStack = 128;
+constexpr float kDeterminantEpsilon = 1e-12f;
+
+float surfaceArea(const glm::vec3& min, const glm::vec3& max)
+{
+    const glm::vec3 extent = glm::max(max - min, glm::vec3(0.0f));
+    return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+}
+
+struct RayData {
+    glm::vec3 origin;
+    glm::vec3 direction;
+    glm::vec3 inverseDirection;
+    float tMin;
+    float tMax;
+};
+
+} // namespace
+
+struct RayBvh::BuildNode {
+    glm::vec3 min { std::numeric_limits<float>::max() };
+    std::uint32_t leftFirst { 0 }; // first child for interior nodes, first triangle (in `order`) for leaves
+    glm::vec3 max { std::numeric_limits<float>::lowest() };
+    std::uint32_t count { 0 }; // triangle count; 0 marks an interior node
+};
+
+namespace {
+
+// Bit i is set when the ray overlaps child i of `node` within [tMin, tMax].
+template <typename Node>
+int intersectChildren(const Node& node, const RayData& ray)
+{
+#ifdef RAY_BVH_SSE
+    const __m128 ox = _mm_set1_ps(ray.origin.x);
+    const __m128 oy = _mm_set1_ps(ray.origin.y);
+    const __m128 oz = _mm_set1_ps(ray.origin.z);
+    const __m128 ix = _mm_set1_ps(ray.inverseDirection.x);
+    const __m128 iy = _mm_set1_ps(ray.inverseDirection.y);
+    const __m128 iz = _mm_set1_ps(ray.inverseDirection.z);
+
+    const __m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), ox), ix);
+    const __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), ox), ix);
+    const __m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), oy), iy);
+    const __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), oy), iy);
+    const __m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), oz), iz);
+    const __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), oz), iz);
+
+    __m128 tNear = _mm_max_ps(_mm_min_ps(t0x, t1x), _mm_set1_ps(ray.tMin));
+    tNear = _mm_max_ps(tNear, _mm_min_ps(t0y, t1y));
+    tNear = _mm_max_ps(tNear, _mm_min_ps(t0z, t1z));
+    __m128 tFar = _mm_min_ps(_mm_max_ps(t0x, t1x), _mm_set1_ps(ray.tMax));
+    tFar = _mm_min_ps(tFar, _mm_max_ps(t0y, t1y));
+    tFar = _mm_min_ps(tFar, _mm_max_ps(t0z, t1z));
+    return _mm_movemask_ps(_mm_cmple_ps(tNear, tFar));
+#else
+    int mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        const float t0x = (node.minX[i] - ray.origin.x) * ray.inverseDirection.x;
+        const float t1x = (node.maxX[i] - ray.origin.x) * ray.inverseDirection.x;
+        const float t0y = (node.minY[i] - ray.origin.y) * ray.inverseDirection.y;
+        const float t1y = (node.maxY[i] - ray.origin.y) * ray.inverseDirection.y;
+        const float t0z = (node.minZ[i] - ray.origin.z) * ray.inverseDirection.z;
+        const float t1z = (node.maxZ[i] - ray.origin.z) * ray.inverseDirection.z;
+        const float tNear = std::max({ ray.tMin, std::min(t0x, t1x), std::min(t0y, t1y), std::min(t0z, t1z) });
+        const float tFar = std::min({ ray.tMax, std::max(t0x, t1x), std::max(t0y, t1y), std::max(t0z, t1z) });
+        if (tNear <= tFar)
+            mask |= 1 << i;
+    }
+    return mask;
+#endif
+}
+
+// Moller-Trumbore against the four triangles of `leaf`. Bit i of the result is set when triangle i
+// is hit within (tMin, tMax); its distance is then in t[i].
+template <typename Leaf>
+int intersectLeaf(const Leaf& leaf, const RayData& ray, float* t)
+{
+#ifdef RAY_BVH_SSE
+    const __m128 dx = _mm_set1_ps(ray.direction.x);
+    const __m128 dy = _mm_set1_ps(ray.direction.y);
+    const __m128 dz = _mm_set1_ps(ray.direction.z);
+    const __m128 e1x = _mm_load_ps(leaf.e1[0]);
+    const __m128 e1y = _mm_load_ps(leaf.e1[1]);
+    const __m128 e1z = _mm_load_ps(leaf.e1[2]);
+    const __m128 e2x = _mm_load_ps(leaf.e2[0]);
+    const __m128 e2y = _mm_load_ps(leaf.e2[1]);
+    const __m128 e2z = _mm_load_ps(leaf.e2[2]);
+
+    // p = d x e2, det = e1 . p
+    const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+    const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+    const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+    const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+    const __m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+    const __m128 valid = _mm_cmpgt_ps(absDet, _mm_set1_ps(kDeterminantEpsilon));
+    if (_mm_movemask_ps(valid) == 0)
+        return 0;
+    const __m128 inverseDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+    // s = o - v0, u = (s . p) / det
+    const __m128 sx = _mm_sub_ps(_mm_set1_ps(ray.origin.x), _mm_load_ps(leaf.v0[0]));
+    const __m128 sy = _mm_sub_ps(_mm_set1_ps(ray.origin.y), _mm_load_ps(leaf.v0[1]));
+    const __m128 sz = _mm_sub_ps(_mm_set1_ps(ray.origin.z), _mm_load_ps(leaf.v0[2]));
+    const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inverseDet);
+
+    // q = s x e1, v = (d . q) / det, t = (e2 . q) / det
+    const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+    const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+    const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+    const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inverseDet);
+    const __m128 distance = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inverseDet);
+
+    const __m128 zero = _mm_setzero_ps();
+    __m128 hit = _mm_and_ps(valid, _mm_cmpge_ps(u, zero));
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+    hit = _mm_and_ps(hit, _mm_cmpgt_ps(distance, _mm_set1_ps(ray.tMin)));
+    hit = _mm_and_ps(hit, _mm_cmplt_ps(distance, _mm_set1_ps(ray.tMax)));
+    _mm_storeu_ps(t, distance);
+    return _mm_movemask_ps(hit);
+#else
+    int mask = 0;
+    for (int i = 0; i < 4; ++i) {
+        const glm::vec3 e1(leaf.e1[0][i], leaf.e1[1][i], leaf.e1[2][i]);
+        const glm::vec3 e2(leaf.e2[0][i], leaf.e2[1][i], leaf.e2[2][i]);
+        const glm::vec3 p = glm::cross(ray.direction, e2);
+        const float det = glm::dot(e1, p);
+        if (std::abs(det) <= kDeterminantEpsilon)
+            continue;
+        const float inverseDet = 1.0f / det;
+        const glm::vec3 s = ray.origin - glm::vec3(leaf.v0[0][i], leaf.v0[1][i], leaf.v0[2][i]);
+        const float u = glm::dot(s, p) * inverseDet;
+        if (u < 0.0f || u > 1.0f)
+            continue;
+        const glm::vec3 q = glm::cross(s, e1);
+        const float v = glm::dot(ray.direction, q) * inverseDet;
+        if (v < 0.0f || u + v > 1.0f)
+            continue;
+        const float distance = glm::dot(e2, q) * inverseDet;
+        if (distance > ray.tMin && distance < ray.tMax) {
+            t[i] = distance;
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+} // namespace
+
+void RayBvh::clear()
+{
+    m_nodes.clear();
+    m_leaves.clear();
+    m_triangleCount = 0;
+    m_boundsMin = glm::vec3(0.0f);
+    m_boundsMax = glm::vec3(0.0f);
+}
+
+void RayBvh::build(std::span<const glm::vec3> positions, std::span<const glm::uvec3> triangles)
+{
+    clear();
+    const auto triangleCount = static_cast<std::uint32_t>(triangles.size());
+    if (triangleCount == 0)
+        return;
+    m_triangleCount = triangleCount;
+
+    std::vector<glm::vec3> centroids(triangleCount);
+    for (std::uint32_t i = 0; i < triangleCount; ++i) {
+        const glm::uvec3& tri = triangles[i];
+        centroids[i] = (positions[tri.x] + positions[tri.y] + positions[tri.z]) / 3.0f;
+    }
+
+    std::vector<std::uint32_t> order(triangleCount);
+    for (std::uint32_t i = 0; i < triangleCount; ++i)
+        order[i] = i;
+
+    // Binary median-split tree first; children always follow their parent in the array.
+    std::vector<BuildNode> buildNodes;
+    buildNodes.reserve(static_cast<std::size_t>(triangleCount / kLeafTriangles) * 2 + 1);
+    buildNodes.push_back(BuildNode { glm::vec3(0.0f), 0, glm::vec3(0.0f), triangleCount });
+
+    std::vector<std::uint32_t> stack { 0 };
+    while (!stack.empty()) {
+        const std::uint32_t nodeIndex = stack.back();
+        stack.pop_back();
+
+        const std::uint32_t first = buildNodes[nodeIndex].leftFirst;
+        const std::uint32_t count = buildNodes[nodeIndex].count;
+        if (count <= kLeafTriangles)
+            continue;
+
+        glm::vec3 centroidMin(std::numeric_limits<float>::max());
+        glm::vec3 centroidMax(std::numeric_limits<float>::lowest());
+        for (std::uint32_t i = first; i < first + count; ++i) {
+            centroidMin = glm::min(centroidMin, centroids[order[i]]);
+            centroidMax = glm::max(centroidMax, centroids[order[i]]);
+        }
+        const glm::vec3 extent = centroidMax - centroidMin;
+        int axis = 0;
+        if (extent.y > extent.x)
+            axis = 1;
+        if (extent.z > extent[axis])
+            axis = 2;
+
+        // Leaves hold at most four triangles, so coincident centroids are still split by count.
+        const std::uint32_t half = count / 2;
+        if (extent[axis] > 0.0f) {
+            const auto begin = order.begin() + first;
+            std::nth_element(begin, begin + half, begin + count, [&](std::uint32_t lhs, std::uint32_t rhs) {
+                return centroids[lhs][axis] < centroids[rhs][axis];
+            });
+        }
+
+        const auto leftIndex = static_cast<std::uint32_t>(buildNodes.size());
+        buildNodes.push_back(BuildNode { glm::vec3(0.0f), first, glm::vec3(0.0f), half });
+        buildNodes.push_back(BuildNode { glm::vec3(0.0f), first + half, glm::vec3(0.0f), count - half });
+        buildNodes[nodeIndex].leftFirst = leftIndex;
+        buildNodes[nodeIndex].count = 0;
+        stack.push_back(leftIndex);
+        stack.push_back(leftIndex + 1);
+    }
+
+    // Bounds bottom-up.
+    for (std::size_t i = buildNodes.size(); i-- > 0;) {
+        BuildNode& node = buildNodes[i];
+        node.min = glm::vec3(std::numeric_limits<float>::max());
+        node.max = glm::vec3(std::numeric_limits<float>::lowest());
+        if (node.count > 0) {
+            for (std::uint32_t t = node.leftFirst; t < node.leftFirst + node.count; ++t) {
+                const glm::uvec3& tri = triangles[order[t]];
+                for (int corner = 0; corner < 3; ++corner) {
+                    node.min = glm::min(node.min, positions[tri[corner]]);
+                    node.max = glm::max(node.max, positions[tri[corner]]);
+                }
+            }
+        } else {
+            const BuildNode& left = buildNodes[node.leftFirst];
+            const BuildNode& right = buildNodes[node.leftFirst + 1];
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+        }
+    }
+    m_boundsMin = buildNodes.front().min;
+    m_boundsMax = buildNodes.front().max;
+
+    m_nodes.reserve(buildNodes.size() / 2 + 1);
+    m_leaves.reserve(buildNodes.size() / 2 + 1);
+    collapse(buildNodes, 0, order, positions, triangles);
+}
+
+std::uint32_t RayBvh::collapse(const std::vector<BuildNode>& buildNodes, std::uint32_t index,
+    const std::vector<std::uint32_t>& order,
+    std::span<const glm::vec3> positions,
+    std::span<const glm::uvec3> triangles)
+{
+    // Pull grandchildren up into this node, always opening the largest interior child, until it has
+    // four children or only leaves are left.
+    std::array<std::uint32_t, 4> slots {};
+    std::size_t slotCount = 0;
+    if (buildNodes[index].count > 0) {
+        slots[slotCount++] = index;
+    } else {
+        slots[slotCount++] = buildNodes[index].leftFirst;
+        slots[slotCount++] = buildNodes[index].leftFirst + 1;
+    }
+    while (slotCount < 4) {
+        std::size_t best = slotCount;
+        float bestArea = -1.0f;
+        for (std::size_t i = 0; i < slotCount; ++i) {
+            const BuildNode& candidate = buildNodes[slots[i]];
+            const float area = surfaceArea(candidate.min, candidate.max);
+            if (candidate.count == 0 && area > bestArea) {
+                best = i;
+                bestArea = area;
+            }
+        }
+        if (best == slotCount)
+            break;
+        const std::uint32_t opened = slots[best];
+        slots[best] = buildNodes[opened].leftFirst;
+        slots[slotCount++] = buildNodes[opened].leftFirst + 1;
+    }
+
+    const auto nodeIndex = static_cast<std::uint32_t>(m_nodes.size());
+    m_nodes.emplace_back();
+    for (std::size_t i = 0; i < 4; ++i) {
+        Node& node = m_nodes[nodeIndex];
+        if (i >= slotCount) {
+            node.minX[i] = node.minY[i] = node.minZ[i] = std::numeric_limits<float>::infinity();
+            node.maxX[i] = node.maxY[i] = node.maxZ[i] = std::numeric_limits<float>::infinity();
+            node.child[i] = kEmptySlot;
+            continue;
+        }
+
+        const BuildNode& child = buildNodes[slots[i]];
+        node.minX[i] = child.min.x;
+        node.minY[i] = child.min.y;
+        node.minZ[i] = child.min.z;
+        node.maxX[i] = child.max.x;
+        node.maxY[i] = child.max.y;
+        node.maxZ[i] = child.max.z;
+
+        if (child.count > 0) {
+            Leaf leaf {};
+            for (std::uint32_t lane = 0; lane < child.count; ++lane) {
+                const glm::uvec3& tri = triangles[order[child.leftFirst + lane]];
+                const glm::vec3 v0 = positions[tri.x];
+                const glm::vec3 e1 = positions[tri.y] - v0;
+                const glm::vec3 e2 = positions[tri.z] - v0;
+                for (int axis = 0; axis < 3; ++axis) {
+                    leaf.v0[axis][lane] = v0[axis];
+                    leaf.e1[axis][lane] = e1[axis];
+                    leaf.e2[axis][lane] = e2[axis];
+                }
+                leaf.triangle[lane] = order[child.leftFirst + lane];
+            }
+            node.child[i] = kLeafFlag | static_cast<std::uint32_t>(m_leaves.size());
+            m_leaves.push_back(leaf);
+        } else {
+            // Recursion may grow m_nodes; write through the index afterwards.
+            const std::uint32_t childNode = collapse(buildNodes, slots[i], order, positions, triangles);
+            m_nodes[nodeIndex].child[i] = childNode;
+        }
+    }
+    return nodeIndex;
+}
+
+bool RayBvh::occluded(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax) const
+{
+    if (m_nodes.empty())
+        return false;
+
+    RayData ray;
+    ray.origin = origin;
+    ray.direction = direction;
+    ray.inverseDirection = 1.0f / direction;
+    ray.tMin = tMin;
+    ray.tMax = tMax;
+
+    std::array<std::uint32_t, kMaxStack> stack;
+    std::size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        int mask = intersectChildren(node, ray);
+        while (mask != 0) {
+            const int i = std::countr_zero(static_cast<unsigned>(mask));
+            mask &= mask - 1;
+            const std::uint32_t child = node.child[i];
+            if (child == kEmptySlot)
+                continue;
+            if (child & kLeafFlag) {
+                float t[4];
+                if (intersectLeaf(m_leaves[child & ~kLeafFlag], ray, t) != 0)
+                    return true;
+            } else if (stackSize < kMaxStack) {
+                stack[stackSize++] = child;
+            }
+        }
+    }
+    return false;
+}
+
+std::optional<RayBvh::Hit> RayBvh::intersect(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax) const
+{
+    if (m_nodes.empty())
+        return std::nullopt;
+
+    RayData ray;
+    ray.origin = origin;
+    ray.direction = direction;
+    ray.inverseDirection = 1.0f / direction;
+    ray.tMin = tMin;
+    ray.tMax = tMax;
+
+    // Every hit shortens the ray, which prunes the remaining children by their boxes.
+    std::optional<Hit> closest;
+    std::array<std::uint32_t, kMaxStack> stack;
+    std::size_t stackSize = 0;
+    stack[stackSize++] = 0;
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        int mask = intersectChildren(node, ray);
+        while (mask != 0) {
+            const int i = std::countr_zero(static_cast<unsigned>(mask));
+            mask &= mask - 1;
+            const std::uint32_t child = node.child[i];
+            if (child == kEmptySlot)
+                continue;
+            if (child & kLeafFlag) {
+                const Leaf& leaf = m_leaves[child & ~kLeafFlag];
+                float t[4];
+                int hits = intersectLeaf(leaf, ray, t);
+                while (hits != 0) {
+                    const int lane = std::countr_zero(static_cast<unsigned>(hits));
+                    hits &= hits - 1;
+                    if (t[lane] < ray.tMax) {
+                        ray.tMax = t[lane];
+                        closest = Hit { t[lane], leaf.triangle[lane] };
+                    }
+                }
+            } else if (stackSize < kMaxStack) {
+                stack[stackSize++] = child;
+            }
+        }
+    }
+    return closest;
+}
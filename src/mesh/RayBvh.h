@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/vec3.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Static triangle BVH for incoherent ray queries (AO and probe baking). Built with the same
+// median split as CollisionWorld, then collapsed into 4-wide nodes whose child boxes are stored
+// SoA so one SSE slab test covers all four children. Leaves hold up to four triangles, also SoA,
+// intersected four at a time. Queries are const and may run concurrently once built.
+class RayBvh {
+public:
+    struct Hit {
+        float t { 0.0f };
+        std::uint32_t triangle { 0 }; // index into the triangles passed to build()
+    };
+
+    void build(std::span<const glm::vec3> positions, std::span<const glm::uvec3> triangles);
+    void clear();
+
+    // True when the segment origin + t * direction, t in (tMin, tMax), hits any triangle.
+    // `direction` need not be normalised; t is in units of its length.
+    [[nodiscard]] bool occluded(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax) const;
+    // Closest hit in (tMin, tMax), if any.
+    [[nodiscard]] std::optional<Hit> intersect(const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax) const;
+
+    [[nodiscard]] bool empty() const { return m_nodes.empty(); }
+    [[nodiscard]] std::size_t nodeCount() const { return m_nodes.size(); }
+    [[nodiscard]] std::size_t triangleCount() const { return m_triangleCount; }
+    [[nodiscard]] const glm::vec3& boundsMin() const { return m_boundsMin; }
+    [[nodiscard]] const glm::vec3& boundsMax() const { return m_boundsMax; }
+
+private:
+    struct BuildNode;
+
+    static constexpr std::uint32_t kLeafFlag = 0x80000000u;
+    static constexpr std::uint32_t kEmptySlot = 0xFFFFFFFFu;
+
+    // Empty slots have a box at infinity so the slab test rejects them.
+    struct alignas(16) Node {
+        float minX[4];
+        float minY[4];
+        float minZ[4];
+        float maxX[4];
+        float maxY[4];
+        float maxZ[4];
+        std::uint32_t child[4]; // node index, or kLeafFlag | leaf index
+    };
+    static_assert(sizeof(Node) == 112, "RayBvh nodes are expected to stay at 112 bytes");
+
+    // Up to four triangles in Moller-Trumbore form (v0, e1 = v1 - v0, e2 = v2 - v0); unused lanes
+    // are degenerate and never hit.
+    struct alignas(16) Leaf {
+        float v0[3][4];
+        float e1[3][4];
+        float e2[3][4];
+        std::uint32_t triangle[4];
+    };
+
+    std::uint32_t collapse(const std::vector<BuildNode>& buildNodes, std::uint32_t index,
+        const std::vector<std::uint32_t>& order,
+        std::span<const glm::vec3> positions,
+        std::span<const glm::uvec3> triangles);
+
+    std::vector<Node> m_nodes;
+    std::vector<Leaf> m_leaves;
+    std::size_t m_triangleCount { 0 };
+    glm::vec3 m_boundsMin { 0.0f };
+    glm::vec3 m_boundsMax { 0.0f };
+};
@@ -33,6 +33,11 @@ GPUMesh::GPUMesh(const Mesh& cpuMesh)
         return glm::length2(glm::vec3(v.tangent)) > 1e-6f;
     });
 
+    createGeometryBuffers(cpuMesh.vertices, cpuMesh.triangles);
+}
+
+void GPUMesh::createGeometryBuffers(std::span<const Vertex> vertices, std::span<const glm::uvec3> triangles)
+{
     // Create VAO and bind it so subsequent creations of VBO and IBO are bound to this VAO
     glGenVertexArrays(1, &m_vao);
     glBindVertexArray(m_vao);
@@ -40,12 +45,12 @@ GPUMesh::GPUMesh(const Mesh& cpuMesh)
     // Create vertex buffer object (VBO)
     glGenBuffers(1, &m_vbo);
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(cpuMesh.vertices.size() * sizeof(decltype(cpuMesh.vertices)::value_type)), cpuMesh.vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size_bytes()), vertices.data(), GL_STATIC_DRAW);
 
     // Create index buffer object (IBO)
     glGenBuffers(1, &m_ibo);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(cpuMesh.triangles.size() * sizeof(decltype(cpuMesh.triangles)::value_type)), cpuMesh.triangles.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(triangles.size_bytes()), triangles.data(), GL_STATIC_DRAW);
 
     // Tell OpenGL that we will be using vertex attributes 0, 1, 2 and 3.
     glEnableVertexAttribArray(0);
@@ -67,7 +72,8 @@ GPUMesh::GPUMesh(const Mesh& cpuMesh)
     glVertexAttribDivisor(4, 0);
 
     // Each triangle has 3 vertices.
-    m_numIndices = static_cast<GLsizei>(3 * cpuMesh.triangles.size());
+    m_numIndices = static_cast<GLsizei>(3 * triangles.size());
+    m_numVertices = static_cast<GLsizei>(vertices.size());
 }
 
 GPUMesh::GPUMesh(GPUMesh&& other)
@@ -93,7 +99,8 @@ bool GPUMesh::hasTextureCoords() const
 
 void GPUMesh::draw(const Shader& drawingShader)
 {
-    
+    if (!resident())
+        return;
     // Draw the mesh's triangles
     glBindVertexArray(m_vao);
     glDrawElements(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr);
@@ -101,40 +108,132 @@ void GPUMesh::draw(const Shader& drawingShader)
 
 void GPUMesh::drawInstanced(GLsizei instanceCount) const
 {
+    if (!resident())
+        return;
     glBindVertexArray(m_vao);
     glDrawElementsInstanced(GL_TRIANGLES, m_numIndices, GL_UNSIGNED_INT, nullptr, instanceCount);
 }
 
+void GPUMesh::drawRanges(const GLsizei* counts, const void* const* offsets, GLsizei rangeCount) const
+{
+    if (!resident())
+        return;
+    glBindVertexArray(m_vao);
+    glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_INT, offsets, rangeCount);
+}
+
+void GPUMesh::drawRangesInstanced(const GLsizei* counts, const void* const* offsets, GLsizei rangeCount, GLsizei instanceCount) const
+{
+    if (!resident())
+        return;
+    glBindVertexArray(m_vao);
+    for (GLsizei i = 0; i < rangeCount; ++i)
+        glDrawElementsInstanced(GL_TRIANGLES, counts[i], GL_UNSIGNED_INT, offsets[i], instanceCount);
+}
+
+void GPUMesh::drawIndirect(GLuint indirectBuffer, GLsizei drawCount) const
+{
+    if (!resident())
+        return;
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, drawCount, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
 void GPUMesh::moveInto(GPUMesh&& other)
 {
     freeGpuMemory();
     m_numIndices = other.m_numIndices;
+    m_numVertices = other.m_numVertices;
     m_hasTextureCoords = other.m_hasTextureCoords;
     m_hasSecondaryTextureCoords = other.m_hasSecondaryTextureCoords;
     m_hasTangents = other.m_hasTangents;
     m_ibo = other.m_ibo;
     m_vbo = other.m_vbo;
+    m_occlusionVbo = other.m_occlusionVbo;
     m_vao = other.m_vao;
     m_uboMaterial = other.m_uboMaterial;
 
     other.m_numIndices = 0;
+    other.m_numVertices = 0;
     other.m_hasTextureCoords = false;
     other.m_hasSecondaryTextureCoords = false;
     other.m_hasTangents = false;
     other.m_ibo = INVALID;
     other.m_vbo = INVALID;
+    other.m_occlusionVbo = INVALID;
     other.m_vao = INVALID;
     other.m_uboMaterial = INVALID;
 }
 
 void GPUMesh::freeGpuMemory()
 {
+    release();
+    if (m_uboMaterial != INVALID)
+        glDeleteBuffers(1, &m_uboMaterial);
+    m_uboMaterial = INVALID;
+}
+
+void GPUMesh::release()
+{
+    clearVertexOcclusion();
     if (m_vao != INVALID)
         glDeleteVertexArrays(1, &m_vao);
     if (m_vbo != INVALID)
         glDeleteBuffers(1, &m_vbo);
     if (m_ibo != INVALID)
         glDeleteBuffers(1, &m_ibo);
-    if (m_uboMaterial != INVALID)
-        glDeleteBuffers(1, &m_uboMaterial);
+    m_vao = INVALID;
+    m_vbo = INVALID;
+    m_ibo = INVALID;
+    m_numIndices = 0;
+    m_numVertices = 0;
+}
+
+void GPUMesh::restore(std::span<const Vertex> vertices, std::span<const glm::uvec3> triangles)
+{
+    release();
+    createGeometryBuffers(vertices, triangles);
+    glBindVertexArray(0);
+}
+
+void GPUMesh::setVertexOcclusion(std::span<const glm::vec4> occlusion)
+{
+    if (!resident() || occlusion.size() != static_cast<std::size_t>(m_numVertices))
+        return;
+
+    if (m_occlusionVbo == INVALID)
+        glGenBuffers(1, &m_occlusionVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_occlusionVbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(occlusion.size_bytes()), occlusion.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(m_vao);
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), nullptr);
+    glVertexAttribDivisor(5, 0);
+    glBindVertexArray(0);
+}
+
+void GPUMesh::clearVertexOcclusion()
+{
+    if (m_occlusionVbo == INVALID)
+        return;
+    if (m_vao != INVALID) {
+        glBindVertexArray(m_vao);
+        glDisableVertexAttribArray(5);
+        glBindVertexArray(0);
+    }
+    glDeleteBuffers(1, &m_occlusionVbo);
+    m_occlusionVbo = INVALID;
+}
+
+void GPUMesh::download(std::vector<Vertex>& vertices, std::vector<glm::uvec3>& triangles) const
+{
+    vertices.resize(static_cast<std::size_t>(m_numVertices));
+    triangles.resize(static_cast<std::size_t>(m_numIndices / 3));
+    if (!resident())
+        return;
+    glGetNamedBufferSubData(m_vbo, 0, static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex)), vertices.data());
+    glGetNamedBufferSubData(m_ibo, 0, static_cast<GLsizeiptr>(triangles.size() * sizeof(glm::uvec3)), triangles.data());
 }
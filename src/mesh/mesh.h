@@ -5,10 +5,13 @@
 #include <framework/shader.h>
 DISABLE_WARNINGS_PUSH()
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 DISABLE_WARNINGS_POP()
 
 #include <exception>
 #include <filesystem>
+#include <span>
+#include <vector>
 #include <framework/opengl_includes.h>
 
 struct MeshLoadingException : public std::runtime_error {
@@ -42,10 +45,33 @@ public:
     // Bind VAO and call glDrawElements.
     void draw(const Shader& drawingShader);
     void drawInstanced(GLsizei instanceCount) const;
+    // Draw selected index ranges only (counts in indices, offsets in bytes into the index buffer).
+    void drawRanges(const GLsizei* counts, const void* const* offsets, GLsizei rangeCount) const;
+    void drawRangesInstanced(const GLsizei* counts, const void* const* offsets, GLsizei rangeCount, GLsizei instanceCount) const;
+    // Draw `drawCount` DrawElementsIndirectCommand entries from `indirectBuffer`.
+    void drawIndirect(GLuint indirectBuffer, GLsizei drawCount) const;
 
     GLsizei indexCount() const { return m_numIndices; }
+    GLsizei vertexCount() const { return m_numVertices; }
+    std::size_t geometryBytes() const { return static_cast<std::size_t>(m_numVertices) * sizeof(Vertex) + static_cast<std::size_t>(m_numIndices) * sizeof(GLuint); }
+
+    // Streaming: release() frees the vertex and index buffers but keeps the material and attribute
+    // flags, restore() uploads them again. Draw calls on a released mesh do nothing.
+    [[nodiscard]] bool resident() const { return m_vao != INVALID; }
+    void release();
+    void restore(std::span<const Vertex> vertices, std::span<const glm::uvec3> triangles);
+    // Reads the vertex and index buffers back from the GPU (stalls until they are available).
+    void download(std::vector<Vertex>& vertices, std::vector<glm::uvec3>& triangles) const;
+
+    // Optional second vertex stream on attribute 5: baked bent normal (xyz) and visibility (w), one
+    // entry per vertex. Meshes without it read the default generic attribute (0, 0, 0, 1). Dropped
+    // by release(); the caller re-applies it after restore().
+    void setVertexOcclusion(std::span<const glm::vec4> occlusion);
+    void clearVertexOcclusion();
+    [[nodiscard]] bool hasVertexOcclusion() const { return m_occlusionVbo != INVALID; }
 
 private:
+    void createGeometryBuffers(std::span<const Vertex> vertices, std::span<const glm::uvec3> triangles);
     void moveInto(GPUMesh&&);
     void freeGpuMemory();
 
@@ -53,11 +79,13 @@ private:
     static constexpr GLuint INVALID = 0xFFFFFFFF;
 
     GLsizei m_numIndices { 0 };
+    GLsizei m_numVertices { 0 };
     bool m_hasTextureCoords { false };
     bool m_hasSecondaryTextureCoords { false };
     bool m_hasTangents { false };
     GLuint m_ibo { INVALID };
     GLuint m_vbo { INVALID };
+    GLuint m_occlusionVbo { INVALID };
     GLuint m_vao { INVALID };
     GLuint m_uboMaterial { INVALID };
 };
@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: MIT
+#include "metrics/MetricsPublisher.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::uint64_t currentProcessId()
+{
+#ifdef _WIN32
+    return static_cast<std::uint64_t>(GetCurrentProcessId());
+#else
+    return static_cast<std::uint64_t>(getpid());
+#endif
+}
+
+std::uint64_t steadyNowNs()
+{
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+                                          .count());
+}
+
+void copyString(char* destination, std::size_t capacity, const std::string& source)
+{
+    const std::size_t length = std::min(source.size(), capacity - 1);
+    std::memcpy(destination, source.data(), length);
+    std::memset(destination + length, 0, capacity - length);
+}
+
+} // namespace
+
+bool MetricsPublisher::open(MetricsRegistry& registry, const std::string& name)
+{
+    close();
+    m_registry = &registry;
+    m_name = name;
+    m_publishGauge = registry.gauge("daedalus_metrics_publish_ns", "Cost of the previous metrics publish in nanoseconds");
+
+    if (!m_region.create(name, sizeof(metrics_shm::Segment))) {
+        m_lastError = m_region.lastError();
+        std::cerr << "[Metrics] Failed to create shared memory '" << name << "': " << m_lastError << std::endl;
+        return false;
+    }
+
+    // The mapping is zero-filled, which is a valid object representation for the atomics in the segment.
+    m_segment = new (m_region.data()) metrics_shm::Segment;
+    m_segment->magic = 0;
+    m_segment->version = metrics_shm::kVersion;
+    m_segment->ringSlots = metrics_shm::kRingSlots;
+    m_segment->maxValues = metrics_shm::kMaxValues;
+    m_segment->publisherPid = currentProcessId();
+    m_segment->descriptorSequence.store(0, std::memory_order_relaxed);
+    m_segment->metricCount = 0;
+    m_segment->writeIndex.store(0, std::memory_order_relaxed);
+    for (metrics_shm::RingSlot& slot : m_segment->ring)
+        slot.sequence.store(0, std::memory_order_relaxed);
+    m_writeIndex = 0;
+    m_descriptorVersion = ~0ull;
+    writeDescriptors();
+
+    // Readers treat the segment as valid only once the magic is visible.
+    std::atomic_thread_fence(std::memory_order_release);
+    m_segment->magic = metrics_shm::kMagic;
+    m_lastError.clear();
+    std::cout << "[Metrics] Publishing to shared memory '" << name << "'" << std::endl;
+    return true;
+}
+
+void MetricsPublisher::close()
+{
+    if (m_segment)
+        m_segment->magic = 0;
+    m_segment = nullptr;
+    m_region.close();
+}
+
+void MetricsPublisher::writeDescriptors()
+{
+    const std::uint64_t version = m_registry->version();
+    const std::vector<MetricsRegistry::Descriptor> descriptors = m_registry->descriptors();
+
+    std::atomic<std::uint64_t>& sequence = m_segment->descriptorSequence;
+    const std::uint64_t begin = sequence.load(std::memory_order_relaxed) + 1;
+    sequence.store(begin, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const auto count = static_cast<std::uint32_t>(std::min<std::size_t>(descriptors.size(), metrics_shm::kMaxMetrics));
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const MetricsRegistry::Descriptor& source = descriptors[i];
+        metrics_shm::MetricDescriptor& target = m_segment->descriptors[i];
+        copyString(target.name, sizeof(target.name), source.name);
+        copyString(target.help, sizeof(target.help), source.help);
+        target.type = static_cast<std::uint8_t>(source.type);
+        target.bucketCount = static_cast<std::uint8_t>(source.bucketBounds.size());
+        target.reserved = 0;
+        target.valueOffset = source.valueOffset;
+        std::fill(std::begin(target.bucketBounds), std::end(target.bucketBounds), 0.0);
+        std::copy(source.bucketBounds.begin(), source.bucketBounds.end(), target.bucketBounds);
+    }
+    m_segment->metricCount = count;
+
+    sequence.store(begin + 1, std::memory_order_release);
+    m_descriptorVersion = version;
+}
+
+void MetricsPublisher::publish(std::uint64_t frameIndex)
+{
+    if (!m_segment || !m_enabled)
+        return;
+
+    const auto start = std::chrono::steady_clock::now();
+    // Registrations are rare; refreshing descriptors is the only non-trivial path and it stays off
+    // the steady state.
+    if (m_registry->version() != m_descriptorVersion)
+        writeDescriptors();
+
+    metrics_shm::RingSlot& slot = m_segment->ring[m_writeIndex % metrics_shm::kRingSlots];
+    const std::uint64_t sequence = 2 * m_writeIndex + 1;
+    slot.sequence.store(sequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const std::uint32_t valueCount = m_registry->usedValues();
+    slot.frameIndex = frameIndex;
+    slot.timestampNs = steadyNowNs();
+    slot.valueCount = valueCount;
+    m_registry->snapshot(slot.values, valueCount);
+
+    slot.sequence.store(sequence + 1, std::memory_order_release);
+    ++m_writeIndex;
+    m_segment->writeIndex.store(m_writeIndex, std::memory_order_release);
+
+    const double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    m_publishGauge.set(elapsedNs);
+    m_stats.lastPublishNs = elapsedNs;
+    m_stats.maxPublishNs = std::max(m_stats.maxPublishNs, elapsedNs);
+    m_stats.avgPublishNs = m_stats.framesPublished == 0 ? elapsedNs : m_stats.avgPublishNs * 0.95 + elapsedNs * 0.05;
+    ++m_stats.framesPublished;
+}
+
+void MetricsPublisher::drawImGuiPanel()
+{
+    if (!m_registry) {
+        ImGui::TextDisabled("Metrics registry not attached.");
+        return;
+    }
+
+    if (isOpen()) {
+        ImGui::Checkbox("Publish", &m_enabled);
+        ImGui::Text("Shared memory: %s (%zu KiB)", m_name.c_str(), sizeof(metrics_shm::Segment) / 1024);
+    } else {
+        ImGui::TextDisabled("Shared memory unavailable: %s", m_lastError.c_str());
+        if (ImGui::Button("Retry"))
+            open(*m_registry, m_name);
+        return;
+    }
+
+    ImGui::Text("Publish: %.0f ns (avg %.0f, max %.0f) | %llu frames",
+        m_stats.lastPublishNs,
+        m_stats.avgPublishNs,
+        m_stats.maxPublishNs,
+        static_cast<unsigned long long>(m_stats.framesPublished));
+    if (ImGui::SmallButton("Reset Max"))
+        m_stats.maxPublishNs = 0.0;
+
+    const std::vector<MetricsRegistry::Descriptor> descriptors = m_registry->descriptors();
+    ImGui::Text("%zu metrics, %u / %u value slots", descriptors.size(), m_registry->usedValues(), metrics_shm::kMaxValues);
+    ImGui::TextDisabled("Scrape with: daedalus_metrics_exporter --name %s", m_name.c_str());
+
+    if (!ImGui::TreeNode("Current Values"))
+        return;
+    std::uint64_t values[metrics_shm::kMaxValues];
+    const std::uint32_t used = m_registry->usedValues();
+    m_registry->snapshot(values, used);
+    for (const MetricsRegistry::Descriptor& descriptor : descriptors) {
+        const std::uint64_t first = values[descriptor.valueOffset];
+        switch (descriptor.type) {
+        case MetricsRegistry::MetricType::Counter:
+            ImGui::Text("%s: %llu", descriptor.name.c_str(), static_cast<unsigned long long>(first));
+            break;
+        case MetricsRegistry::MetricType::Gauge:
+            ImGui::Text("%s: %.3f", descriptor.name.c_str(), MetricsRegistry::bitsToDouble(first));
+            break;
+        case MetricsRegistry::MetricType::Histogram: {
+            const double sum = MetricsRegistry::bitsToDouble(values[descriptor.valueOffset + 1]);
+            ImGui::Text("%s: count %llu, mean %.3f", descriptor.name.c_str(), static_cast<unsigned long long>(first),
+                first > 0 ? sum / static_cast<double>(first) : 0.0);
+            break;
+        }
+        }
+    }
+    ImGui::TreePop();
+}
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "metrics/MetricsRegistry.h"
+#include "metrics/SharedMemory.h"
+
+#include <cstdint>
+#include <string>
+
+// Publishes a MetricsRegistry into a shared-memory ring once per frame so an external process (see
+// tools/metrics_exporter) can scrape live values without touching the engine. Publishing is a relaxed
+// copy of the used value slots into the next ring slot under a seqlock: no locks, no allocation and no
+// syscalls on the frame path. Its own cost is exported as daedalus_metrics_publish_ns.
+class MetricsPublisher {
+public:
+    struct Stats {
+        double lastPublishNs { 0.0 };
+        double avgPublishNs { 0.0 };
+        double maxPublishNs { 0.0 };
+        std::uint64_t framesPublished { 0 };
+    };
+
+    MetricsPublisher() = default;
+    ~MetricsPublisher() = default;
+
+    MetricsPublisher(const MetricsPublisher&) = delete;
+    MetricsPublisher& operator=(const MetricsPublisher&) = delete;
+
+    bool open(MetricsRegistry& registry, const std::string& name = metrics_shm::kDefaultName);
+    void close();
+
+    void publish(std::uint64_t frameIndex);
+
+    [[nodiscard]] bool isOpen() const { return m_segment != nullptr; }
+    [[nodiscard]] const Stats& stats() const { return m_stats; }
+    void drawImGuiPanel();
+
+private:
+    void writeDescriptors();
+
+    MetricsRegistry* m_registry { nullptr };
+    SharedMemoryRegion m_region;
+    metrics_shm::Segment* m_segment { nullptr };
+    std::string m_name;
+    std::string m_lastError;
+    bool m_enabled { true };
+    std::uint64_t m_descriptorVersion { ~0ull };
+    std::uint64_t m_writeIndex { 0 };
+
+    MetricsRegistry::Gauge m_publishGauge;
+    Stats m_stats;
+};
@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: MIT
+#include "metrics/MetricsRegistry.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+bool isValidMetricName(const std::string& name)
+{
+    if (name.empty() || name.size() >= metrics_shm::kNameLength)
+        return false;
+    for (std::size_t i = 0; i < name.size(); ++i) {
+        const char c = name[i];
+        const bool alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':';
+        const bool digit = c >= '0' && c <= '9';
+        if (!alpha && !(digit && i > 0))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+MetricsRegistry::MetricsRegistry()
+{
+    m_entries.reserve(metrics_shm::kMaxMetrics);
+}
+
+double MetricsRegistry::bitsToDouble(std::uint64_t bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::uint64_t MetricsRegistry::doubleToBits(double value)
+{
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+void MetricsRegistry::Gauge::set(double value) const
+{
+    if (m_value)
+        m_value->store(doubleToBits(value), std::memory_order_relaxed);
+}
+
+void MetricsRegistry::Histogram::observe(double value) const
+{
+    if (!m_values)
+        return;
+    m_values[0].fetch_add(1, std::memory_order_relaxed);
+
+    std::atomic<std::uint64_t>& sum = m_values[1];
+    std::uint64_t expected = sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(expected, doubleToBits(bitsToDouble(expected) + value), std::memory_order_relaxed)) {
+    }
+
+    // Buckets are stored non-cumulatively; values above the last bound only count towards +Inf.
+    const double* end = m_bounds + m_bucketCount;
+    const double* bucket = std::lower_bound(m_bounds, end, value);
+    if (bucket != end)
+        m_values[2 + (bucket - m_bounds)].fetch_add(1, std::memory_order_relaxed);
+}
+
+const MetricsRegistry::Entry* MetricsRegistry::find(const std::string& name) const
+{
+    for (const Entry& entry : m_entries) {
+        if (entry.descriptor.name == name)
+            return &entry;
+    }
+    return nullptr;
+}
+
+MetricsRegistry::Entry* MetricsRegistry::add(const std::string& name, const std::string& help, MetricType type, std::uint32_t valueCount)
+{
+    if (!isValidMetricName(name)) {
+        std::cerr << "[Metrics] Invalid metric name '" << name << "'" << std::endl;
+        return nullptr;
+    }
+    const std::uint32_t offset = m_usedValues.load(std::memory_order_relaxed);
+    if (m_entries.size() >= metrics_shm::kMaxMetrics || offset + valueCount > metrics_shm::kMaxValues) {
+        std::cerr << "[Metrics] Registry full, dropping metric '" << name << "'" << std::endl;
+        return nullptr;
+    }
+
+    Entry& entry = m_entries.emplace_back();
+    entry.descriptor.name = name;
+    entry.descriptor.help = help.substr(0, metrics_shm::kHelpLength - 1);
+    entry.descriptor.type = type;
+    entry.descriptor.valueOffset = offset;
+    m_usedValues.store(offset + valueCount, std::memory_order_release);
+    return &entry;
+}
+
+MetricsRegistry::Counter MetricsRegistry::counter(const std::string& name, const std::string& help)
+{
+    std::lock_guard lock(m_registrationMutex);
+    if (const Entry* existing = find(name))
+        return existing->descriptor.type == MetricType::Counter ? Counter(&m_values[existing->descriptor.valueOffset]) : Counter();
+    Entry* entry = add(name, help, MetricType::Counter, 1);
+    if (!entry)
+        return {};
+    m_version.fetch_add(1, std::memory_order_release);
+    return Counter(&m_values[entry->descriptor.valueOffset]);
+}
+
+MetricsRegistry::Gauge MetricsRegistry::gauge(const std::string& name, const std::string& help)
+{
+    std::lock_guard lock(m_registrationMutex);
+    if (const Entry* existing = find(name))
+        return existing->descriptor.type == MetricType::Gauge ? Gauge(&m_values[existing->descriptor.valueOffset]) : Gauge();
+    Entry* entry = add(name, help, MetricType::Gauge, 1);
+    if (!entry)
+        return {};
+    m_version.fetch_add(1, std::memory_order_release);
+    return Gauge(&m_values[entry->descriptor.valueOffset]);
+}
+
+MetricsRegistry::Histogram MetricsRegistry::histogram(const std::string& name, const std::string& help, std::initializer_list<double> bucketBounds)
+{
+    std::lock_guard lock(m_registrationMutex);
+    if (const Entry* existing = find(name)) {
+        if (existing->descriptor.type != MetricType::Histogram)
+            return {};
+        const auto count = static_cast<std::uint32_t>(existing->descriptor.bucketBounds.size());
+        return Histogram(&m_values[existing->descriptor.valueOffset], existing->bounds.data(), count);
+    }
+
+    std::vector<double> bounds(bucketBounds);
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    if (bounds.size() > metrics_shm::kMaxBuckets) {
+        std::cerr << "[Metrics] Histogram '" << name << "' has more than " << metrics_shm::kMaxBuckets << " buckets, truncating" << std::endl;
+        bounds.resize(metrics_shm::kMaxBuckets);
+    }
+
+    const auto bucketCount = static_cast<std::uint32_t>(bounds.size());
+    Entry* entry = add(name, help, MetricType::Histogram, 2 + bucketCount);
+    if (!entry)
+        return {};
+    std::copy(bounds.begin(), bounds.end(), entry->bounds.begin());
+    entry->descriptor.bucketBounds = std::move(bounds);
+    m_values[entry->descriptor.valueOffset + 1].store(doubleToBits(0.0), std::memory_order_relaxed);
+    m_version.fetch_add(1, std::memory_order_release);
+    return Histogram(&m_values[entry->descriptor.valueOffset], entry->bounds.data(), bucketCount);
+}
+
+std::vector<MetricsRegistry::Descriptor> MetricsRegistry::descriptors() const
+{
+    std::lock_guard lock(m_registrationMutex);
+    std::vector<Descriptor> result;
+    result.reserve(m_entries.size());
+    for (const Entry& entry : m_entries)
+        result.push_back(entry.descriptor);
+    return result;
+}
+
+void MetricsRegistry::snapshot(std::uint64_t* out, std::uint32_t count) const
+{
+    count = std::min(count, metrics_shm::kMaxValues);
+    for (std::uint32_t i = 0; i < count; ++i)
+        out[i] = m_values[i].load(std::memory_order_relaxed);
+}
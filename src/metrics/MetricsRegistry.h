@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "metrics/MetricsShmLayout.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Process-wide metric storage for counters, gauges and histograms. Registration takes a lock and is
+// meant for start-up; the handles it returns update fixed slots with relaxed atomics, so recording is
+// wait-free (a histogram's sum is a short CAS loop) and safe from any thread. Default-constructed
+// handles are no-ops, which lets subsystems record unconditionally whether or not a registry is wired.
+class MetricsRegistry {
+public:
+    using MetricType = metrics_shm::MetricType;
+
+    class Counter {
+    public:
+        Counter() = default;
+        void add(std::uint64_t amount = 1) const
+        {
+            if (m_value)
+                m_value->fetch_add(amount, std::memory_order_relaxed);
+        }
+
+    private:
+        friend class MetricsRegistry;
+        explicit Counter(std::atomic<std::uint64_t>* value)
+            : m_value(value)
+        {
+        }
+        std::atomic<std::uint64_t>* m_value { nullptr };
+    };
+
+    class Gauge {
+    public:
+        Gauge() = default;
+        void set(double value) const;
+
+    private:
+        friend class MetricsRegistry;
+        explicit Gauge(std::atomic<std::uint64_t>* value)
+            : m_value(value)
+        {
+        }
+        std::atomic<std::uint64_t>* m_value { nullptr };
+    };
+
+    class Histogram {
+    public:
+        Histogram() = default;
+        void observe(double value) const;
+
+    private:
+        friend class MetricsRegistry;
+        Histogram(std::atomic<std::uint64_t>* values, const double* bounds, std::uint32_t bucketCount)
+            : m_values(values)
+            , m_bounds(bounds)
+            , m_bucketCount(bucketCount)
+        {
+        }
+        std::atomic<std::uint64_t>* m_values { nullptr }; // [count, sum bits, bucket 0..n-1]
+        const double* m_bounds { nullptr };
+        std::uint32_t m_bucketCount { 0 };
+    };
+
+    struct Descriptor {
+        std::string name;
+        std::string help;
+        MetricType type { MetricType::Gauge };
+        std::uint32_t valueOffset { 0 };
+        std::vector<double> bucketBounds;
+    };
+
+    MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // Registering an existing name returns the existing metric when the type matches, a no-op handle
+    // otherwise (as it does once the registry is full). Names follow OpenMetrics: [a-zA-Z_:][a-zA-Z0-9_:]*.
+    Counter counter(const std::string& name, const std::string& help);
+    Gauge gauge(const std::string& name, const std::string& help);
+    Histogram histogram(const std::string& name, const std::string& help, std::initializer_list<double> bucketBounds);
+
+    // Bumped by every successful registration so consumers know when to refresh their descriptors.
+    [[nodiscard]] std::uint64_t version() const { return m_version.load(std::memory_order_acquire); }
+    // Copies the descriptors (cold path, takes the registration lock).
+    [[nodiscard]] std::vector<Descriptor> descriptors() const;
+    // Number of value slots in use; slots [0, usedValues) are the ones worth copying.
+    [[nodiscard]] std::uint32_t usedValues() const { return m_usedValues.load(std::memory_order_acquire); }
+    // Relaxed snapshot of the first `count` values into `out`.
+    void snapshot(std::uint64_t* out, std::uint32_t count) const;
+
+    [[nodiscard]] static double bitsToDouble(std::uint64_t bits);
+    [[nodiscard]] static std::uint64_t doubleToBits(double value);
+
+private:
+    struct Entry {
+        Descriptor descriptor;
+        std::array<double, metrics_shm::kMaxBuckets> bounds {};
+    };
+
+    [[nodiscard]] const Entry* find(const std::string& name) const;
+    [[nodiscard]] Entry* add(const std::string& name, const std::string& help, MetricType type, std::uint32_t valueCount);
+
+    mutable std::mutex m_registrationMutex;
+    std::vector<Entry> m_entries; // reserved up front so handle pointers into `bounds` stay valid
+    std::array<std::atomic<std::uint64_t>, metrics_shm::kMaxValues> m_values {};
+    std::atomic<std::uint32_t> m_usedValues { 0 };
+    std::atomic<std::uint64_t> m_version { 0 };
+};
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Layout of the shared-memory segment that MetricsPublisher writes and external readers (see
+// tools/metrics_exporter) map read-only. Plain data only, so it must stay identical on both sides:
+// bump kVersion whenever it changes.
+//
+// The publisher writes one ring slot per frame. Every slot is a seqlock: `sequence` is odd while the
+// slot is being written and even once it is complete, so a reader copies the slot and accepts the copy
+// only if it saw the same even sequence before and after. Descriptors change rarely and use the same
+// scheme through `descriptorSequence`.
+namespace metrics_shm {
+
+inline constexpr std::uint32_t kMagic = 0x4d455444u; // "METD"
+inline constexpr std::uint32_t kVersion = 1u;
+inline constexpr std::uint32_t kMaxMetrics = 64u;
+inline constexpr std::uint32_t kMaxValues = 512u;
+inline constexpr std::uint32_t kMaxBuckets = 16u;
+inline constexpr std::uint32_t kRingSlots = 64u;
+inline constexpr std::uint32_t kNameLength = 64u;
+inline constexpr std::uint32_t kHelpLength = 96u;
+
+#ifdef _WIN32
+inline constexpr const char* kDefaultName = "Local\\daedalus_metrics";
+#else
+inline constexpr const char* kDefaultName = "/daedalus_metrics";
+#endif
+
+enum class MetricType : std::uint8_t {
+    Counter = 0, // value: u64 total
+    Gauge = 1, // value: bit pattern of a double
+    Histogram = 2 // values: u64 count, double sum, then one u64 per finite bucket (non-cumulative)
+};
+
+struct MetricDescriptor {
+    char name[kNameLength];
+    char help[kHelpLength];
+    std::uint8_t type;
+    std::uint8_t bucketCount;
+    std::uint16_t reserved;
+    std::uint32_t valueOffset; // index of the metric's first value in RingSlot::values
+    double bucketBounds[kMaxBuckets]; // upper bounds, ascending; +Inf is implied by the count
+};
+
+struct RingSlot {
+    std::atomic<std::uint64_t> sequence;
+    std::uint64_t frameIndex;
+    std::uint64_t timestampNs; // steady clock of the publisher
+    std::uint32_t valueCount;
+    std::uint32_t reserved;
+    std::uint64_t values[kMaxValues];
+};
+
+struct Segment {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t ringSlots;
+    std::uint32_t maxValues;
+    std::uint64_t publisherPid;
+    std::atomic<std::uint64_t> descriptorSequence;
+    std::uint32_t metricCount;
+    std::uint32_t reserved;
+    std::atomic<std::uint64_t> writeIndex; // number of slots published so far; latest is (writeIndex - 1)
+    MetricDescriptor descriptors[kMaxMetrics];
+    RingSlot ring[kRingSlots];
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "metrics segment requires lock-free 64-bit atomics");
+
+} // namespace metrics_shm
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: MIT
+#include "metrics/SharedMemory.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SharedMemoryRegion::~SharedMemoryRegion()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool SharedMemoryRegion::create(const std::string& name, std::size_t size)
+{
+    close();
+    const auto high = static_cast<DWORD>((static_cast<unsigned long long>(size) >> 32) & 0xffffffffu);
+    const auto low = static_cast<DWORD>(static_cast<unsigned long long>(size) & 0xffffffffu);
+    HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, high, low, name.c_str());
+    if (handle == nullptr) {
+        m_lastError = "CreateFileMapping failed (" + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    void* view = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (view == nullptr) {
+        m_lastError = "MapViewOfFile failed (" + std::to_string(GetLastError()) + ")";
+        CloseHandle(handle);
+        return false;
+    }
+    m_handle = handle;
+    m_data = view;
+    m_size = size;
+    m_name = name;
+    m_owner = true;
+    return true;
+}
+
+bool SharedMemoryRegion::openReadOnly(const std::string& name, std::size_t size)
+{
+    close();
+    HANDLE handle = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+    if (handle == nullptr) {
+        m_lastError = "OpenFileMapping failed (" + std::to_string(GetLastError()) + ")";
+        return false;
+    }
+    void* view = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, size);
+    if (view == nullptr) {
+        m_lastError = "MapViewOfFile failed (" + std::to_string(GetLastError()) + ")";
+        CloseHandle(handle);
+        return false;
+    }
+    m_handle = handle;
+    m_data = view;
+    m_size = size;
+    m_name = name;
+    m_owner = false;
+    return true;
+}
+
+void SharedMemoryRegion::close()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_handle)
+        CloseHandle(m_handle);
+    m_data = nullptr;
+    m_handle = nullptr;
+    m_size = 0;
+    m_owner = false;
+}
+
+#else
+
+bool SharedMemoryRegion::create(const std::string& name, std::size_t size)
+{
+    close();
+    const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        m_lastError = std::string("shm_open failed: ") + std::strerror(errno);
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        m_lastError = std::string("ftruncate failed: ") + std::strerror(errno);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        m_lastError = std::string("mmap failed: ") + std::strerror(errno);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    m_fd = fd;
+    m_data = data;
+    m_size = size;
+    m_name = name;
+    m_owner = true;
+    return true;
+}
+
+bool SharedMemoryRegion::openReadOnly(const std::string& name, std::size_t size)
+{
+    close();
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        m_lastError = std::string("shm_open failed: ") + std::strerror(errno);
+        return false;
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < size) {
+        m_lastError = "shared memory region is smaller than expected";
+        ::close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        m_lastError = std::string("mmap failed: ") + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    m_fd = fd;
+    m_data = data;
+    m_size = size;
+    m_name = name;
+    m_owner = false;
+    return true;
+}
+
+void SharedMemoryRegion::close()
+{
+    if (m_data)
+        munmap(m_data, m_size);
+    if (m_fd >= 0)
+        ::close(m_fd);
+    if (m_owner && !m_name.empty())
+        shm_unlink(m_name.c_str());
+    m_data = nullptr;
+    m_fd = -1;
+    m_size = 0;
+    m_owner = false;
+}
+
+#endif
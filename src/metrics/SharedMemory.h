@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// A named shared-memory mapping (POSIX shm_open / Win32 file mapping). The creator owns the name and
+// removes it on destruction; readers map an existing region read-only.
+class SharedMemoryRegion {
+public:
+    SharedMemoryRegion() = default;
+    ~SharedMemoryRegion();
+
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    bool create(const std::string& name, std::size_t size);
+    bool openReadOnly(const std::string& name, std::size_t size);
+    void close();
+
+    [[nodiscard]] void* data() const { return m_data; }
+    [[nodiscard]] std::size_t size() const { return m_size; }
+    [[nodiscard]] bool valid() const { return m_data != nullptr; }
+    [[nodiscard]] const std::string& lastError() const { return m_lastError; }
+
+private:
+    void* m_data { nullptr };
+    std::size_t m_size { 0 };
+    std::string m_name;
+    bool m_owner { false };
+    std::string m_lastError;
+#ifdef _WIN32
+    void* m_handle { nullptr };
+#else
+    int m_fd { -1 };
+#endif
+};
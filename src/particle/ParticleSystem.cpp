@@ -1,18 +1,56 @@
 #include "particle/ParticleSystem.h"
+#include "rendering/texture.h"
+#include <framework/disable_all_warnings.h>
+#include <framework/file_provider.h>
+DISABLE_WARNINGS_PUSH()
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/constants.hpp>
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+#include <array>
+#include <chrono>
 #include <cstdlib>
+#include <limits>
+#include <string>
 #include <vector>
 #include <cstdio>
 #include <cmath>
 #include <algorithm>
 #include <filesystem>
 #include <iostream>
-#include <stb/stb_image.h>
 
 // add randf helper before it's used
 static inline float randf() { return static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX); }
 
+// Emitter LOD constants.
+static constexpr int kSnowEmitterId = 0;
+static constexpr int kMaxMergeLevels = 2; // each level halves an emitter's particles
+static constexpr float kMaxSubstep = 0.1f; // seconds; longer catch-up steps are split...
+static constexpr int kMaxSubsteps = 4;     // ...into at most this many
+static constexpr float kMergedSizeScale = 1.41421356f; // a survivor covers the area of two
+
+using FrustumPlanes = std::array<glm::vec4, 6>;
+
+static FrustumPlanes frustumPlanes(const glm::mat4& viewProjection)
+{
+    const glm::mat4 m = glm::transpose(viewProjection);
+    FrustumPlanes planes { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+    for (glm::vec4& plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+    return planes;
+}
+
+// Conservative: false only when the box lies fully outside one plane.
+static bool boxIntersectsFrustum(const FrustumPlanes& planes, const glm::vec3& center, const glm::vec3& extent)
+{
+    for (const glm::vec4& plane : planes) {
+        const glm::vec3 normal(plane);
+        if (glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), extent) < 0.0f)
+            return false;
+    }
+    return true;
+}
+
 // Simple helpers to compile shaders (minimal)
 static GLuint compileShader(GLenum type, const char* src) {
     GLuint s = glCreateShader(type);
@@ -149,11 +187,84 @@ void ParticleSystem::uploadBuffers() {
     glBufferData(GL_ARRAY_BUFFER, buf.size()*sizeof(float), buf.data(), GL_DYNAMIC_DRAW);
 }
 
+int ParticleSystem::scaledCount(int count) const
+{
+    if (count <= 0)
+        return 0;
+    return std::max(1, static_cast<int>(std::lround(static_cast<float>(count) * m_densityScale)));
+}
+
+ParticleSystem::SpawnGrant ParticleSystem::openEmitter(const glm::vec3& center, float radius, int requested)
+{
+    SpawnGrant grant;
+    const int scaled = scaledCount(requested);
+    grant.count = scaled;
+    // Single-particle emitters (rockets) are never thinned.
+    if (m_lodSettings.enabled && scaled > 1) {
+        // Fewer particles for emitters that cover little of the screen...
+        float fraction = m_lodSettings.minSpawnFraction;
+        const float distance = std::max(glm::length(center - m_view.cameraPosition), 0.1f);
+        if (boxIntersectsFrustum(frustumPlanes(m_view.viewProjection), center, glm::vec3(radius))) {
+            const float coverage = 2.0f * radius * m_view.pixelsPerUnit / distance;
+            fraction = glm::clamp(coverage / std::max(m_lodSettings.fullDetailPixels, 1.0f), m_lodSettings.minSpawnFraction, 1.0f);
+        }
+        // ...tapering over the last quarter of the budget and never past it.
+        const float budget = static_cast<float>(m_lodSettings.particleBudget);
+        const float headroom = budget - static_cast<float>(m_particles.size());
+        fraction *= glm::clamp(headroom / std::max(0.25f * budget, 1.0f), 0.0f, 1.0f);
+        grant.count = std::min(static_cast<int>(std::lround(static_cast<float>(scaled) * fraction)), std::max(static_cast<int>(headroom), 0));
+        if (grant.count > 0 && grant.count < scaled)
+            grant.sizeScale = std::min(std::sqrt(static_cast<float>(scaled) / static_cast<float>(grant.count)), 2.0f);
+    }
+    m_lodStats.requestedSpawns += static_cast<std::uint64_t>(scaled);
+    if (grant.count <= 0) {
+        grant.count = 0;
+        return grant;
+    }
+    m_lodStats.spawnedParticles += static_cast<std::uint64_t>(grant.count);
+
+    Emitter emitter;
+    emitter.id = m_nextEmitterId++;
+    emitter.boundsMin = center - glm::vec3(radius);
+    emitter.boundsMax = center + glm::vec3(radius);
+    emitter.particleCount = static_cast<std::size_t>(grant.count);
+    emitter.maxLife = std::numeric_limits<float>::max(); // known after its first update
+    m_emitterIndex[emitter.id] = m_emitters.size();
+    m_emitters.push_back(emitter);
+    grant.emitterId = emitter.id;
+    return grant;
+}
+
+ParticleSystem::Emitter& ParticleSystem::snowEmitter()
+{
+    if (const auto found = m_emitterIndex.find(kSnowEmitterId); found != m_emitterIndex.end())
+        return m_emitters[found->second];
+    Emitter emitter;
+    emitter.id = kSnowEmitterId;
+    emitter.cameraAttached = true;
+    emitter.boundsMin = m_lastSnowCameraPos;
+    emitter.boundsMax = m_lastSnowCameraPos;
+    emitter.maxLife = std::numeric_limits<float>::max();
+    m_emitterIndex[emitter.id] = m_emitters.size();
+    m_emitters.push_back(emitter);
+    return m_emitters.back();
+}
+
+void ParticleSystem::rebuildEmitterIndex()
+{
+    m_emitterIndex.clear();
+    for (std::size_t i = 0; i < m_emitters.size(); ++i)
+        m_emitterIndex[m_emitters[i].id] = i;
+}
+
 void ParticleSystem::spawnExplosion(const glm::vec3& center, int count)
 {
+    const SpawnGrant grant = openEmitter(center, 8.0f, count);
+    count = grant.count;
     m_particles.reserve(m_particles.size() + static_cast<size_t>(count));
     for (int i=0;i<count;++i) {
         Particle p;
+        p.ownerId = grant.emitterId;
         // random direction
         float phi = randf() * glm::two_pi<float>();
         float costheta = randf()*2.0f - 1.0f;
@@ -163,7 +274,7 @@ void ParticleSystem::spawnExplosion(const glm::vec3& center, int count)
         p.pos = center;
         p.vel = dir * speed;
         p.life = 1.0f + randf()*1.2f;
-        p.size = 20.0f + randf()*40.0f;
+        p.size = (20.0f + randf()*40.0f) * grant.sizeScale;
         p.color = glm::vec4(1.0f, 0.5f + randf()*0.5f, 0.1f*randf(), 1.0f);
         m_particles.push_back(p);
     }
@@ -171,13 +282,16 @@ void ParticleSystem::spawnExplosion(const glm::vec3& center, int count)
 
 void ParticleSystem::spawnFire(const glm::vec3& center, int count)
 {
+    const SpawnGrant grant = openEmitter(center, 1.5f, count);
+    count = grant.count;
     m_particles.reserve(m_particles.size() + static_cast<size_t>(count));
     for (int i=0;i<count;++i) {
         Particle p;
+        p.ownerId = grant.emitterId;
         p.pos = center + glm::vec3((randf()-0.5f)*0.3f, 0.0f, (randf()-0.5f)*0.3f);
         p.vel = glm::vec3((randf()-0.5f)*0.5f, 1.0f + randf()*1.0f, (randf()-0.5f)*0.5f);
         p.life = 0.8f + randf()*1.5f;
-        p.size = 10.0f + randf()*20.0f;
+        p.size = (10.0f + randf()*20.0f) * grant.sizeScale;
         p.color = glm::vec4(1.0f, 0.6f + randf()*0.4f, 0.1f*randf(), 1.0f);
         m_particles.push_back(p);
     }
@@ -185,15 +299,18 @@ void ParticleSystem::spawnFire(const glm::vec3& center, int count)
 
 void ParticleSystem::spawnMagic(const glm::vec3& center, int count)
 {
+    const SpawnGrant grant = openEmitter(center, 1.0f, count);
+    count = grant.count;
     m_particles.reserve(m_particles.size() + static_cast<size_t>(count));
     for (int i=0;i<count;++i) {
         Particle p;
+        p.ownerId = grant.emitterId;
         float a = randf() * glm::two_pi<float>();
         float r = 0.1f + randf()*0.6f;
         p.pos = center + glm::vec3(cos(a)*r, randf()*0.6f, sin(a)*r);
         p.vel = glm::vec3((randf()-0.5f)*0.5f, randf()*1.0f, (randf()-0.5f)*0.5f);
         p.life = 0.6f + randf()*1.2f;
-        p.size = 8.0f + randf()*24.0f;
+        p.size = (8.0f + randf()*24.0f) * grant.sizeScale;
         p.color = glm::vec4(0.4f + randf()*0.6f, 0.2f + randf()*0.8f, 1.0f, 1.0f);
         m_particles.push_back(p);
     }
@@ -201,6 +318,8 @@ void ParticleSystem::spawnMagic(const glm::vec3& center, int count)
 
 void ParticleSystem::spawnMagicAura(const glm::vec3& center, int count, float duration, int rings, MagicAuraShape shape, float riseSpeed)
 {
+    const SpawnGrant grant = openEmitter(center, 1.0f, count);
+    count = grant.count;
     if (count <= 0) return;
     if (rings <= 0) rings = 1;
     // Create multiple concentric rings to avoid gaps. Particles are distributed equally
@@ -291,11 +410,12 @@ void ParticleSystem::spawnMagicAura(const glm::vec3& center, int count, float du
             }
 
             p.life = duration + (randf() - 0.5f) * 0.8f;
-            p.size = 10.0f + randf() * 12.0f;
+            p.size = (10.0f + randf() * 12.0f) * grant.sizeScale;
             glm::vec3 col = glm::vec3(0.15f + randf() * 0.4f, 0.3f + randf() * 0.5f, 0.55f + randf() * 0.45f);
             col = glm::clamp(col, glm::vec3(0.0f), glm::vec3(1.0f));
             p.color = glm::vec4(col, 1.0f);
             p.type = 2;
+            p.ownerId = grant.emitterId;
 
             m_particles.push_back(p);
         }
@@ -306,8 +426,10 @@ void ParticleSystem::spawnMagicAura(const glm::vec3& center, int count, float du
 
 void ParticleSystem::spawnFirework(const glm::vec3& origin, const glm::vec3& dir, const FireworkParams& params)
 {
-    // create a single "rocket" particle that will explode when life <= 0
+    // create a single "rocket" particle that will explode when life <= 0; the burst opens its own emitter
+    const SpawnGrant grant = openEmitter(origin, 1.0f, 1);
     Particle p;
+    p.ownerId = grant.emitterId;
     p.pos = origin;
     p.vel = glm::normalize(dir) * params.speed;
     p.life = params.fuse; // time until explosion
@@ -344,18 +466,20 @@ bool ParticleSystem::loadSnowTexture(const std::string& filename) {
 
     std::string fullPath = std::string(RESOURCE_ROOT) + "/resources/particles/" + filename;
     
-    int width, height, channels;
-    unsigned char* data = stbi_load(fullPath.c_str(), &width, &height, &channels, 4); // Force 4 channels (RGBA)
-    
-    if (!data) {
-        std::cerr << "Failed to load snow texture: " << fullPath << std::endl;
+    TextureImportOptions import;
+    import.channels = 4; // RGBA
+    TextureData image;
+    try {
+        image = loadTextureData(fullPath, import);
+    } catch (const ImageLoadingException& ex) {
+        std::cerr << "Failed to load snow texture: " << ex.what() << std::endl;
         m_snowTextureName = "";
         return false;
     }
 
     glGenTextures(1, &m_snowTexture);
     glBindTexture(GL_TEXTURE_2D, m_snowTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.bytes.data());
     glGenerateMipmap(GL_TEXTURE_2D);
     
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -363,10 +487,8 @@ bool ParticleSystem::loadSnowTexture(const std::string& filename) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
-    stbi_image_free(data);
-    
     m_snowTextureName = filename;
-    std::printf("Loaded snow texture: %s (%dx%d, %d channels)\n", filename.c_str(), width, height, channels);
+    std::printf("Loaded snow texture: %s (%dx%d, %d channels)\n", filename.c_str(), image.width, image.height, image.channels);
     
     return true;
 }
@@ -376,16 +498,12 @@ std::vector<std::string> ParticleSystem::getAvailableParticleTextures() const {
     std::string particleDir = std::string(RESOURCE_ROOT) + "/resources/particles";
     
     try {
-        if (std::filesystem::exists(particleDir) && std::filesystem::is_directory(particleDir)) {
-            for (const auto& entry : std::filesystem::directory_iterator(particleDir)) {
-                if (entry.is_regular_file()) {
-                    std::string ext = entry.path().extension().string();
-                    // Convert extension to lowercase for comparison
-                    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-                    if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".tga") {
-                        textures.push_back(entry.path().filename().string());
-                    }
-                }
+        for (const std::filesystem::path& entry : listFiles(particleDir)) {
+            std::string ext = entry.extension().string();
+            // Convert extension to lowercase for comparison
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".tga") {
+                textures.push_back(entry.filename().string());
             }
         }
     } catch (const std::exception& e) {
@@ -413,11 +531,13 @@ bool ParticleSystem::loadParticleTexture(const std::string& filename) {
 
     std::string fullPath = std::string(RESOURCE_ROOT) + "/resources/particles/" + filename;
     
-    int width, height, channels;
-    unsigned char* data = stbi_load(fullPath.c_str(), &width, &height, &channels, 4); // Force 4 channels (RGBA)
-    
-    if (!data) {
-        std::cerr << "Failed to load particle texture: " << fullPath << std::endl;
+    TextureImportOptions import;
+    import.channels = 4; // RGBA
+    TextureData image;
+    try {
+        image = loadTextureData(fullPath, import);
+    } catch (const ImageLoadingException& ex) {
+        std::cerr << "Failed to load particle texture: " << ex.what() << std::endl;
         m_particleTextureName = "";
         m_useParticleTexture = false;
         return false;
@@ -425,7 +545,7 @@ bool ParticleSystem::loadParticleTexture(const std::string& filename) {
 
     glGenTextures(1, &m_particleTexture);
     glBindTexture(GL_TEXTURE_2D, m_particleTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.bytes.data());
     glGenerateMipmap(GL_TEXTURE_2D);
     
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -433,10 +553,8 @@ bool ParticleSystem::loadParticleTexture(const std::string& filename) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
-    stbi_image_free(data);
-    
     m_particleTextureName = filename;
-    std::printf("Loaded particle texture: %s (%dx%d, %d channels)\n", filename.c_str(), width, height, channels);
+    std::printf("Loaded particle texture: %s (%dx%d, %d channels)\n", filename.c_str(), image.width, image.height, image.channels);
     
     return true;
 }
@@ -447,10 +565,21 @@ void ParticleSystem::updateSnow(float dt, const glm::vec3& cameraPosition) {
     m_lastSnowCameraPos = cameraPosition;
     
     // Spawn new snowflakes based on intensity
-    m_snowSpawnAccumulator += dt * m_snowIntensity;
+    m_snowSpawnAccumulator += dt * m_snowIntensity * m_densityScale;
     int spawnCount = static_cast<int>(m_snowSpawnAccumulator);
     m_snowSpawnAccumulator -= static_cast<float>(spawnCount);
 
+    // Snow surrounds the camera, so it is never thinned for coverage; only the budget caps it.
+    m_lodStats.requestedSpawns += static_cast<std::uint64_t>(spawnCount);
+    if (m_lodSettings.enabled) {
+        const std::size_t budget = static_cast<std::size_t>(m_lodSettings.particleBudget);
+        const std::size_t headroom = budget > m_particles.size() ? budget - m_particles.size() : 0;
+        spawnCount = static_cast<int>(std::min(headroom, static_cast<std::size_t>(spawnCount)));
+    }
+    if (spawnCount <= 0) return;
+    m_lodStats.spawnedParticles += static_cast<std::uint64_t>(spawnCount);
+    const int emitterId = snowEmitter().id;
+
     for (int i = 0; i < spawnCount; ++i) {
         Particle p;
         // Random position in area around camera
@@ -472,85 +601,256 @@ void ParticleSystem::updateSnow(float dt, const glm::vec3& cameraPosition) {
         // Blue-ish transparent color
         p.color = glm::vec4(0.6f, 0.7f, 0.9f, 0.4f + randf() * 0.3f);
         p.type = 4; // snow type
+        p.ownerId = emitterId;
         
         m_particles.push_back(p);
     }
 }
 
-void ParticleSystem::update(float dt) {
-    // collect explosion events (pos + params) so we can add explosion particles without corrupting iteration
-    std::vector<std::pair<glm::vec3, FireworkParams>> explodeEvents;
+void ParticleSystem::classifyEmitters(float dt)
+{
+    const FrustumPlanes planes = frustumPlanes(m_view.viewProjection);
+    for (Emitter& emitter : m_emitters) {
+        emitter.stepDt = 0.0f;
+        emitter.merge = false;
+        emitter.unmerge = false;
+        emitter.dropCount = 0;
+        emitter.mergeParity = 0;
+        emitter.pendingDt += dt;
+
+        const glm::vec3 center = 0.5f * (emitter.boundsMin + emitter.boundsMax);
+        const glm::vec3 extent = 0.5f * (emitter.boundsMax - emitter.boundsMin);
+        const float centerDistance = std::max(glm::length(center - m_view.cameraPosition), 0.1f);
+        const float distance = std::max(centerDistance - glm::length(extent), 0.0f);
+        const bool visible = boxIntersectsFrustum(planes, center, extent);
+        emitter.coveragePixels = visible ? 2.0f * glm::length(extent) * m_view.pixelsPerUnit / centerDistance : 0.0f;
+
+        if (!m_lodSettings.enabled || emitter.cameraAttached)
+            emitter.lod = EmitterLod::Full;
+        else if (distance > m_lodSettings.freezeDistance || (!visible && m_lodSettings.freezeOffscreen))
+            emitter.lod = EmitterLod::Frozen;
+        else if (!visible || distance > m_lodSettings.reducedDistance)
+            emitter.lod = EmitterLod::Reduced;
+        else
+            emitter.lod = EmitterLod::Full;
+
+        switch (emitter.lod) {
+        case EmitterLod::Full:
+            emitter.stepDt = emitter.pendingDt;
+            break;
+        case EmitterLod::Reduced:
+            if (++emitter.framesSinceStep >= std::max(m_lodSettings.reducedInterval, 1))
+                emitter.stepDt = emitter.pendingDt;
+            break;
+        case EmitterLod::Frozen:
+            // Nobody saw it in the meantime: once every particle would have expired, drop them all.
+            if (emitter.pendingDt >= emitter.maxLife)
+                emitter.dropCount = emitter.particleCount;
+            break;
+        }
+        if (emitter.stepDt > 0.0f) {
+            emitter.pendingDt = 0.0f;
+            emitter.framesSinceStep = 0;
+        }
+
+        // Points are drawn inSize / w pixels wide. The merge level is re-derived every frame from the
+        // unmerged size, so an emitter that comes closer gets its survivors shrunk back one level per
+        // frame. Merging stops at the level that keeps minSpawnFraction of the particles: a distant
+        // emitter stays visible at that rate instead of vanishing.
+        if (emitter.dropCount == 0) {
+            int wantedLevel = 0;
+            if (m_lodSettings.enabled && !emitter.cameraAttached && emitter.meanSize > 0.0f) {
+                const int maxLevel = std::min(kMaxMergeLevels,
+                    static_cast<int>(-std::log2(std::clamp(m_lodSettings.minSpawnFraction, 0.01f, 1.0f))));
+                float pixelSize = emitter.meanSize / centerDistance;
+                for (int level = 0; level < emitter.mergeLevel; ++level)
+                    pixelSize /= kMergedSizeScale;
+                while (wantedLevel < maxLevel && pixelSize < m_lodSettings.minPixelSize) {
+                    pixelSize *= kMergedSizeScale;
+                    ++wantedLevel;
+                }
+            }
+            if (wantedLevel > emitter.mergeLevel && emitter.particleCount > 1) {
+                emitter.merge = true;
+                ++emitter.mergeLevel;
+            } else if (wantedLevel < emitter.mergeLevel) {
+                emitter.unmerge = true;
+                --emitter.mergeLevel;
+            }
+        }
+    }
+}
+
+void ParticleSystem::trimToBudget()
+{
+    if (!m_lodSettings.enabled)
+        return;
+    std::size_t alive = m_particles.size();
+    for (const Emitter& emitter : m_emitters)
+        alive -= std::min(emitter.dropCount, alive);
+    const std::size_t budget = static_cast<std::size_t>(m_lodSettings.particleBudget);
+    if (alive <= budget)
+        return;
 
-    for (auto it = m_particles.begin(); it != m_particles.end();) {
-        it->life -= dt;
-        if (it->life <= 0.0f) {
-            if (it->type == 1) {
+    // The oldest particles of the emitters covering the least of the screen go first.
+    std::vector<std::size_t> order(m_emitters.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+        return m_emitters[a].coveragePixels < m_emitters[b].coveragePixels;
+    });
+    std::size_t overflow = alive - budget;
+    for (const std::size_t index : order) {
+        Emitter& emitter = m_emitters[index];
+        const std::size_t available = emitter.particleCount - std::min(emitter.dropCount, emitter.particleCount);
+        const std::size_t take = std::min(available, overflow);
+        emitter.dropCount += take;
+        overflow -= take;
+        if (overflow == 0)
+            break;
+    }
+}
+
+bool ParticleSystem::stepParticle(Particle& p, float dt, std::vector<std::pair<glm::vec3, FireworkParams>>& explodeEvents) const
+{
+    // Catch-up steps of reduced or thawed emitters take a few large substeps at most.
+    const int substeps = std::clamp(static_cast<int>(std::ceil(dt / kMaxSubstep)), 1, kMaxSubsteps);
+    const float h = dt / static_cast<float>(substeps);
+    for (int step = 0; step < substeps; ++step) {
+        p.life -= h;
+        if (p.life <= 0.0f) {
+            if (p.type == 1) {
                 // rocket expired -> schedule explosion at this pos with its params
-                explodeEvents.emplace_back(it->pos, it->firework);
+                explodeEvents.emplace_back(p.pos, p.firework);
             }
-            it = m_particles.erase(it);
-            continue;
+            return false;
         }
         // physics
-        if (it->type == 1) {
-            // rocket: mild drag so it slows slightly, and slight upward curve optional
-            it->vel *= 0.995f;
-            it->vel += glm::vec3(0.0f, 0.5f, 0.0f) * dt; // slight rise
-            it->pos += it->vel * dt;
-        } else if (it->type == 2) {
+        if (p.type == 1) {
+            // rocket: mild drag (0.5% per 60 Hz frame) so it slows slightly, and slight upward curve
+            p.vel *= std::pow(0.995f, h * 60.0f);
+            p.vel += glm::vec3(0.0f, 0.5f, 0.0f) * h; // slight rise
+            p.pos += p.vel * h;
+        } else if (p.type == 2) {
             // magic orbital particles: create tangential motion around anchor
             // compute radial vector from anchor to particle
-            glm::vec3 radial = it->pos - it->anchor;
+            glm::vec3 radial = p.pos - p.anchor;
             float rlen = glm::length(radial);
             glm::vec3 radialDir = rlen > 1e-6f ? radial / rlen : glm::vec3(1.0f, 0.0f, 0.0f);
             // tangent (around Y axis)
             glm::vec3 tangent = glm::normalize(glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), radialDir));
 
             // desired tangential velocity
-            glm::vec3 vTang = tangent * it->orbitSpeed;
-            // small radial correction to keep particles near orbitRadius
-            float radialError = it->orbitRadius - rlen;
-            glm::vec3 vRadial = radialDir * (radialError * 4.0f);
+            glm::vec3 vTang = tangent * p.orbitSpeed;
+            // small radial correction to keep particles near orbitRadius; the gain is capped so a
+            // large step lands on the orbit instead of overshooting it
+            float radialError = p.orbitRadius - rlen;
+            glm::vec3 vRadial = radialDir * (radialError * std::min(4.0f, 1.0f / h));
             // gentle upward drift
             glm::vec3 vUp = glm::vec3(0.0f, 0.35f, 0.0f);
 
             // combine (no heavy gravity)
-            it->vel = vTang + vRadial + vUp;
-            it->pos += it->vel * dt;
-        } else if (it->type == 4) {
+            p.vel = vTang + vRadial + vUp;
+            p.pos += p.vel * h;
+        } else if (p.type == 4) {
             // Snow particle: simple falling with gravity
-            it->pos += it->vel * dt;
+            p.pos += p.vel * h;
             // Remove snow particles that fall below a certain threshold or move too far from camera
-            if (it->pos.y < m_lastSnowCameraPos.y - 10.0f) {
-                it->life = 0.0f; // mark for removal
-            }
-            float distFromCamera = glm::length(glm::vec2(it->pos.x - m_lastSnowCameraPos.x, 
-                                                         it->pos.z - m_lastSnowCameraPos.z));
-            if (distFromCamera > m_snowArea * 0.7f) {
-                it->life = 0.0f; // mark for removal if too far from camera
-            }
+            if (p.pos.y < m_lastSnowCameraPos.y - 10.0f)
+                return false;
+            float distFromCamera = glm::length(glm::vec2(p.pos.x - m_lastSnowCameraPos.x,
+                                                         p.pos.z - m_lastSnowCameraPos.z));
+            if (distFromCamera > m_snowArea * 0.7f)
+                return false;
         } else {
             // generic particles: gravity
-            it->vel += glm::vec3(0.0f, -9.8f, 0.0f) * dt * 0.25f;
-            it->pos += it->vel * dt;
+            p.vel += glm::vec3(0.0f, -9.8f, 0.0f) * h * 0.25f;
+            p.pos += p.vel * h;
         }
+    }
 
-        // fade alpha relative to remaining life (we assume initial life <= 2s)
-        // For longer-lived magic particles we scale alpha differently
-        float alpha = glm::clamp(it->life, 0.0f, 1.0f);
-        if (it->type == 2) {
-            // magic aura uses slower fade
-            alpha = glm::clamp(it->life / 6.0f, 0.0f, 1.0f);
+    // fade alpha relative to remaining life (we assume initial life <= 2s)
+    // For longer-lived magic particles we scale alpha differently
+    float alpha = glm::clamp(p.life, 0.0f, 1.0f);
+    if (p.type == 2) {
+        // magic aura uses slower fade
+        alpha = glm::clamp(p.life / 6.0f, 0.0f, 1.0f);
+    }
+    p.color.a = alpha;
+    return true;
+}
+
+void ParticleSystem::update(float dt, const View& view) {
+    const auto updateStart = std::chrono::steady_clock::now();
+    m_view = view;
+    classifyEmitters(dt);
+    trimToBudget();
+    for (Emitter& emitter : m_emitters) {
+        emitter.particleCount = 0;
+        emitter.meanSize = 0.0f; // summed below
+        emitter.maxLife = 0.0f;
+        emitter.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+        emitter.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+    }
+
+    // collect explosion events (pos + params) so we can add explosion particles without corrupting iteration
+    std::vector<std::pair<glm::vec3, FireworkParams>> explodeEvents;
+
+    // One pass steps, merges and drops, compacting the survivors in place.
+    std::size_t simulated = 0;
+    std::size_t write = 0;
+    for (std::size_t read = 0; read < m_particles.size(); ++read) {
+        Particle& p = m_particles[read];
+        const auto found = m_emitterIndex.find(p.ownerId);
+        Emitter* emitter = found != m_emitterIndex.end() ? &m_emitters[found->second] : nullptr;
+        float stepDt = dt;
+        if (emitter) {
+            if (emitter->dropCount > 0) {
+                --emitter->dropCount;
+                ++m_lodStats.droppedParticles;
+                continue;
+            }
+            if (emitter->merge) {
+                if ((emitter->mergeParity++ & 1u) != 0) {
+                    ++m_lodStats.mergedParticles;
+                    continue;
+                }
+                p.size *= kMergedSizeScale;
+            } else if (emitter->unmerge) {
+                p.size /= kMergedSizeScale;
+            }
+            stepDt = emitter->stepDt;
+        }
+        if (stepDt > 0.0f) {
+            ++simulated;
+            if (!stepParticle(p, stepDt, explodeEvents))
+                continue;
         }
-        it->color.a = alpha;
-        ++it;
+        if (emitter) {
+            ++emitter->particleCount;
+            emitter->meanSize += p.size;
+            emitter->maxLife = std::max(emitter->maxLife, p.life);
+            emitter->boundsMin = glm::min(emitter->boundsMin, p.pos);
+            emitter->boundsMax = glm::max(emitter->boundsMax, p.pos);
+        }
+        if (write != read)
+            m_particles[write] = p;
+        ++write;
     }
+    m_particles.erase(m_particles.begin() + static_cast<std::ptrdiff_t>(write), m_particles.end());
+
+    m_emitters.erase(std::remove_if(m_emitters.begin(), m_emitters.end(),
+        [](const Emitter& emitter) { return emitter.particleCount == 0; }), m_emitters.end());
+    for (Emitter& emitter : m_emitters)
+        emitter.meanSize /= static_cast<float>(emitter.particleCount);
+    rebuildEmitterIndex();
 
     // spawn explosions for each rocket that expired
     for (const auto& ev : explodeEvents) {
         const glm::vec3& pos = ev.first;
         const FireworkParams& params = ev.second;
-        int burstCount = params.burstCount;
+        const SpawnGrant grant = openEmitter(pos, 10.0f, params.burstCount);
+        int burstCount = grant.count;
         m_particles.reserve(m_particles.size() + static_cast<size_t>(burstCount));
         for (int i = 0; i < burstCount; ++i) {
             Particle q;
@@ -563,20 +863,74 @@ void ParticleSystem::update(float dt) {
             q.pos = pos;
             q.vel = dir * speed;
             q.life = 0.8f + randf() * 1.6f;
-            q.size = params.minSize + randf() * (params.maxSize - params.minSize);
+            q.size = (params.minSize + randf() * (params.maxSize - params.minSize)) * grant.sizeScale;
             // colorful palette around baseColor
             glm::vec3 base = params.baseColor;
             glm::vec3 col = base + glm::vec3((randf()-0.5f)*params.colorSpread, (randf()-0.5f)*params.colorSpread, (randf()-0.5f)*params.colorSpread);
             col = glm::clamp(col, glm::vec3(0.0f), glm::vec3(1.0f));
             q.color = glm::vec4(col, 1.0f);
             q.type = 0;
+            q.ownerId = grant.emitterId;
             m_particles.push_back(q);
         }
     }
 
+    m_lodStats.emitters = m_emitters.size();
+    m_lodStats.fullRateEmitters = 0;
+    m_lodStats.reducedEmitters = 0;
+    m_lodStats.frozenEmitters = 0;
+    for (const Emitter& emitter : m_emitters) {
+        if (emitter.lod == EmitterLod::Full)
+            ++m_lodStats.fullRateEmitters;
+        else if (emitter.lod == EmitterLod::Reduced)
+            ++m_lodStats.reducedEmitters;
+        else
+            ++m_lodStats.frozenEmitters;
+    }
+    m_lodStats.aliveParticles = m_particles.size();
+    m_lodStats.simulatedParticles = simulated;
+    m_lodStats.updateMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - updateStart).count();
+
     uploadBuffers();
 }
 
+void ParticleSystem::drawImGuiPanel()
+{
+    LodSettings& settings = m_lodSettings;
+    ImGui::Checkbox("Emitter LOD", &settings.enabled);
+    ImGui::BeginDisabled(!settings.enabled);
+    ImGui::SliderInt("Particle Budget", &settings.particleBudget, 500, 100000);
+    ImGui::SliderFloat("Reduced Rate Beyond", &settings.reducedDistance, 5.0f, 200.0f, "%.0f m");
+    ImGui::SliderFloat("Freeze Beyond", &settings.freezeDistance, settings.reducedDistance, 500.0f, "%.0f m");
+    ImGui::SliderInt("Reduced Step Interval", &settings.reducedInterval, 1, 16, "%d frames");
+    ImGui::Checkbox("Freeze Off-Screen Emitters", &settings.freezeOffscreen);
+    ImGui::SliderFloat("Full Detail Coverage", &settings.fullDetailPixels, 20.0f, 1000.0f, "%.0f px");
+    ImGui::SliderFloat("Min Spawn Fraction", &settings.minSpawnFraction, 0.01f, 1.0f, "%.2f");
+    ImGui::SliderFloat("Min Particle Size", &settings.minPixelSize, 0.0f, 4.0f, "%.1f px");
+    ImGui::EndDisabled();
+
+    const LodStats& stats = m_lodStats;
+    ImGui::Separator();
+    ImGui::Text("Emitters: %zu (full %zu | reduced %zu | frozen %zu)",
+        stats.emitters, stats.fullRateEmitters, stats.reducedEmitters, stats.frozenEmitters);
+    ImGui::Text("Particles: %zu alive, %zu simulated last frame", stats.aliveParticles, stats.simulatedParticles);
+    if (settings.enabled && settings.particleBudget > 0) {
+        const float used = static_cast<float>(stats.aliveParticles) / static_cast<float>(settings.particleBudget);
+        ImGui::ProgressBar(std::min(used, 1.0f), ImVec2(-1.0f, 0.0f), (std::to_string(stats.aliveParticles) + " / " + std::to_string(settings.particleBudget)).c_str());
+    }
+    ImGui::Text("Spawned %llu of %llu requested", static_cast<unsigned long long>(stats.spawnedParticles),
+        static_cast<unsigned long long>(stats.requestedSpawns));
+    ImGui::Text("Merged %llu, dropped %llu", static_cast<unsigned long long>(stats.mergedParticles),
+        static_cast<unsigned long long>(stats.droppedParticles));
+    ImGui::Text("Update: %.3f ms", static_cast<double>(stats.updateMs));
+    if (ImGui::Button("Reset Counters")) {
+        m_lodStats.requestedSpawns = 0;
+        m_lodStats.spawnedParticles = 0;
+        m_lodStats.mergedParticles = 0;
+        m_lodStats.droppedParticles = 0;
+    }
+}
+
 void ParticleSystem::draw(const glm::mat4& view, const glm::mat4& proj) {
     if (m_particles.empty()) return;
     
@@ -1,5 +1,8 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <glad/glad.h>
@@ -26,19 +29,60 @@ struct Particle {
     glm::vec3 anchor;     // center point to orbit around
     float orbitRadius = 0.0f; // desired orbit radius
     float orbitSpeed = 0.0f;  // tangential speed
-    int ownerId = -1; // id of owning system if applicable
+    int ownerId = -1; // id of the emitter that spawned it
     float phase = 0.0f; // angular phase for structured spirals
 };
 
+// Every spawn call (and every firework burst, plus the snow around the camera) opens an emitter that
+// owns its particles. Each frame emitters are classified from their particles' bounds: visible and
+// near ones step every frame; off-screen or distant ones step every few frames with the accumulated
+// time; far ones (optionally also off-screen ones) are frozen until they come back or would have
+// expired. Spawn counts shrink with the emitter's screen coverage and as the particle budget fills,
+// emitters whose particles are drawn below a pixel merge pairs of them, and the lowest-coverage
+// emitters are trimmed first when the budget is exceeded, so the simulated count never exceeds it.
 class ParticleSystem {
 public:
+    // Camera the LOD decisions are made against.
+    struct View {
+        glm::mat4 viewProjection { 1.0f };
+        glm::vec3 cameraPosition { 0.0f };
+        float pixelsPerUnit { 540.0f }; // projection[1][1] * viewport height / 2: pixels per metre at 1 m
+    };
+
+    struct LodSettings {
+        bool enabled { true };
+        int particleBudget { 20000 }; // simulated particles across all emitters
+        float reducedDistance { 30.0f }; // metres beyond which emitters step at a reduced rate
+        float freezeDistance { 120.0f };
+        int reducedInterval { 4 }; // frames between steps of reduced emitters
+        bool freezeOffscreen { false }; // off-screen emitters freeze instead of stepping reduced
+        float fullDetailPixels { 200.0f }; // screen diameter at which an emitter spawns everything
+        float minSpawnFraction { 0.15f };
+        float minPixelSize { 1.0f }; // particles drawn smaller than this get merged into fewer, larger ones
+    };
+
+    // "Requested" is what would be spawned and simulated without LOD; the rest is what actually was.
+    struct LodStats {
+        std::size_t emitters { 0 };
+        std::size_t fullRateEmitters { 0 };
+        std::size_t reducedEmitters { 0 };
+        std::size_t frozenEmitters { 0 };
+        std::size_t aliveParticles { 0 };
+        std::size_t simulatedParticles { 0 }; // particles stepped last frame
+        std::uint64_t requestedSpawns { 0 };
+        std::uint64_t spawnedParticles { 0 };
+        std::uint64_t mergedParticles { 0 };
+        std::uint64_t droppedParticles { 0 }; // budget trims and expired frozen emitters
+        float updateMs { 0.0f };
+    };
+
     ParticleSystem();
     ~ParticleSystem();
 
     void initGL();
     void shutdownGL();
 
-    void update(float dt);
+    void update(float dt, const View& view);
     void spawnExplosion(const glm::vec3& center, int count = 200);
     void spawnFire(const glm::vec3& center, int count = 100);
     void spawnMagic(const glm::vec3& center, int count = 150);
@@ -61,6 +105,15 @@ public:
     // new signature: supply params for the rocket
     void spawnFirework(const glm::vec3& origin, const glm::vec3& dir, const FireworkParams& params);
 
+    // Multiplies every spawn count and the snow rate; scalability tiers lower it on slow machines.
+    void setDensityScale(float scale) { m_densityScale = std::max(scale, 0.0f); }
+    float getDensityScale() const { return m_densityScale; }
+    void setParticleBudget(int budget) { m_lodSettings.particleBudget = std::max(budget, 0); }
+
+    LodSettings& lodSettings() { return m_lodSettings; }
+    const LodStats& lodStats() const { return m_lodStats; }
+    void drawImGuiPanel();
+
     // Snow system
     void enableSnow(bool enable);
     bool isSnowEnabled() const { return m_snowEnabled; }
@@ -86,9 +139,57 @@ public:
     void draw(const glm::mat4& view, const glm::mat4& proj);
 
 private:
-    std::vector<Particle> m_particles;
+    enum class EmitterLod {
+        Full = 0,
+        Reduced,
+        Frozen
+    };
+
+    struct Emitter {
+        int id { 0 };
+        bool cameraAttached { false }; // snow: always full rate, never merged
+        EmitterLod lod { EmitterLod::Full };
+        // Of its particles after the last update.
+        glm::vec3 boundsMin { 0.0f };
+        glm::vec3 boundsMax { 0.0f };
+        std::size_t particleCount { 0 };
+        float meanSize { 0.0f };
+        float maxLife { 0.0f };
+        float coveragePixels { 0.0f };
+        float pendingDt { 0.0f }; // simulation time owed while reduced or frozen
+        int framesSinceStep { 0 };
+        int mergeLevel { 0 }; // merges its survivors are scaled for
+        // This frame's decisions.
+        float stepDt { 0.0f };
+        bool merge { false };
+        bool unmerge { false }; // back near the camera: shrink the survivors one level
+        std::size_t dropCount { 0 };
+        std::size_t mergeParity { 0 };
+    };
 
+    struct SpawnGrant {
+        int emitterId { -1 };
+        int count { 0 };
+        float sizeScale { 1.0f }; // fewer particles are drawn larger to cover the same area
+    };
+
+    std::vector<Particle> m_particles;
+    std::vector<Emitter> m_emitters;
+    std::unordered_map<int, std::size_t> m_emitterIndex;
+    int m_nextEmitterId { 1 };
+    View m_view;
+    LodSettings m_lodSettings;
+    LodStats m_lodStats;
 
+    float m_densityScale { 1.0f };
+    int scaledCount(int count) const;
+    // Opens an emitter around `center` and decides how many of `requested` particles it gets.
+    SpawnGrant openEmitter(const glm::vec3& center, float radius, int requested);
+    Emitter& snowEmitter();
+    void classifyEmitters(float dt);
+    void trimToBudget();
+    bool stepParticle(Particle& p, float dt, std::vector<std::pair<glm::vec3, FireworkParams>>& explodeEvents) const;
+    void rebuildEmitterIndex();
 
     // Snow system state
     bool m_snowEnabled { false };
@@ -0,0 +1,752 @@
+// SPDX-License-Identifier: MIT
+#include "physics/CollisionWorld.h"
+
+#include "mesh/MeshManager.h"
+
+#include <framework/disable_all_warnings.h>
+#include <framework/log.h>
+DISABLE_WARNINGS_PUSH()
+#include <imgui/imgui.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/gtx/norm.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr std::uint32_t kLeafTriangles = 4;
+constexpr std::uint32_t kLeafInstances = 2;
+constexpr std::size_t kMaxBuildJobs = 2;
+constexpr int kMaxSubsteps = 32;
+constexpr float kCeilingNormalY = -0.7f;
+constexpr float kContactEpsilon = 1e-5f;
+constexpr std::uint64_t kStatsWindowFrames = 240;
+
+using Clock = std::chrono::steady_clock;
+
+[[nodiscard]] float millisecondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+}
+
+[[nodiscard]] bool overlaps(const glm::vec3& aMin, const glm::vec3& aMax, const glm::vec3& bMin, const glm::vec3& bMax)
+{
+    return aMin.x <= bMax.x && aMax.x >= bMin.x
+        && aMin.y <= bMax.y && aMax.y >= bMin.y
+        && aMin.z <= bMax.z && aMax.z >= bMin.z;
+}
+
+// Real-Time Collision Detection (Ericson), 5.1.5.
+[[nodiscard]] glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    const glm::vec3 ab = b - a;
+    const glm::vec3 ac = c - a;
+    const glm::vec3 ap = p - a;
+    const float d1 = glm::dot(ab, ap);
+    const float d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return a;
+
+    const glm::vec3 bp = p - b;
+    const float d3 = glm::dot(ab, bp);
+    const float d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+        return b;
+
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return a + ab * (d1 / (d1 - d3));
+
+    const glm::vec3 cp = p - c;
+    const float d5 = glm::dot(ab, cp);
+    const float d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+        return c;
+
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return a + ac * (d2 / (d2 - d6));
+
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    const float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+// Real-Time Collision Detection (Ericson), 5.1.9. Returns squared distance between the closest points.
+float closestPointsSegmentSegment(const glm::vec3& p1, const glm::vec3& q1, const glm::vec3& p2, const glm::vec3& q2, glm::vec3& c1, glm::vec3& c2)
+{
+    const glm::vec3 d1 = q1 - p1;
+    const glm::vec3 d2 = q2 - p2;
+    const glm::vec3 r = p1 - p2;
+    const float a = glm::dot(d1, d1);
+    const float e = glm::dot(d2, d2);
+    const float f = glm::dot(d2, r);
+
+    float s = 0.0f;
+    float t = 0.0f;
+    if (a <= kContactEpsilon && e <= kContactEpsilon) {
+        c1 = p1;
+        c2 = p2;
+        return glm::length2(c1 - c2);
+    }
+    if (a <= kContactEpsilon) {
+        t = glm::clamp(f / e, 0.0f, 1.0f);
+    } else {
+        const float c = glm::dot(d1, r);
+        if (e <= kContactEpsilon) {
+            s = glm::clamp(-c / a, 0.0f, 1.0f);
+        } else {
+            const float b = glm::dot(d1, d2);
+            const float denom = a * e - b * b;
+            s = denom != 0.0f ? glm::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+            t = (b * s + f) / e;
+            if (t < 0.0f) {
+                t = 0.0f;
+                s = glm::clamp(-c / a, 0.0f, 1.0f);
+            } else if (t > 1.0f) {
+                t = 1.0f;
+                s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+            }
+        }
+    }
+
+    c1 = p1 + d1 * s;
+    c2 = p2 + d2 * t;
+    return glm::length2(c1 - c2);
+}
+
+// Penetration of a capsule (segment a-b, radius r) into a triangle. Returns false when separated.
+bool capsuleTriangleContact(const glm::vec3& a, const glm::vec3& b, float radius,
+    const glm::vec3& t0, const glm::vec3& t1, const glm::vec3& t2,
+    glm::vec3& outNormal, glm::vec3& outFaceNormal, float& outDepth)
+{
+    const glm::vec3 faceCross = glm::cross(t1 - t0, t2 - t0);
+    const float faceLength2 = glm::length2(faceCross);
+    if (faceLength2 <= 1e-12f)
+        return false;
+    const glm::vec3 faceNormal = faceCross / std::sqrt(faceLength2);
+    outFaceNormal = faceNormal.y >= 0.0f ? faceNormal : -faceNormal;
+
+    // Core segment pierces the triangle: push out of the plane towards the side holding most of the segment.
+    const float da = glm::dot(a - t0, faceNormal);
+    const float db = glm::dot(b - t0, faceNormal);
+    if (da * db < 0.0f) {
+        const glm::vec3 hit = a + (b - a) * (da / (da - db));
+        if (glm::length2(closestPointOnTriangle(hit, t0, t1, t2) - hit) <= kContactEpsilon) {
+            const bool aIsShallow = std::abs(da) < std::abs(db);
+            const float shallow = aIsShallow ? std::abs(da) : std::abs(db);
+            const float deepSide = aIsShallow ? db : da;
+            outNormal = deepSide >= 0.0f ? faceNormal : -faceNormal;
+            outDepth = shallow + radius;
+            return true;
+        }
+    }
+
+    glm::vec3 bestSegment = a;
+    glm::vec3 bestTriangle = closestPointOnTriangle(a, t0, t1, t2);
+    float bestDist2 = glm::length2(bestSegment - bestTriangle);
+
+    const glm::vec3 onTriangleB = closestPointOnTriangle(b, t0, t1, t2);
+    const float distB = glm::length2(b - onTriangleB);
+    if (distB < bestDist2) {
+        bestDist2 = distB;
+        bestSegment = b;
+        bestTriangle = onTriangleB;
+    }
+
+    const glm::vec3 edges[3][2] = { { t0, t1 }, { t1, t2 }, { t2, t0 } };
+    for (const auto& edge : edges) {
+        glm::vec3 onSegment;
+        glm::vec3 onEdge;
+        const float dist2 = closestPointsSegmentSegment(a, b, edge[0], edge[1], onSegment, onEdge);
+        if (dist2 < bestDist2) {
+            bestDist2 = dist2;
+            bestSegment = onSegment;
+            bestTriangle = onEdge;
+        }
+    }
+
+    if (bestDist2 >= radius * radius)
+        return false;
+
+    const float dist = std::sqrt(bestDist2);
+    if (dist > kContactEpsilon) {
+        outNormal = (bestSegment - bestTriangle) / dist;
+    } else {
+        const float side = glm::dot((a + b) * 0.5f - t0, faceNormal);
+        outNormal = side >= 0.0f ? faceNormal : -faceNormal;
+    }
+    outDepth = radius - dist;
+    return true;
+}
+
+} // namespace
+
+void CollisionWorld::clear()
+{
+    // Unfinished jobs are left to complete (their futures would block here) and dropped when adopted.
+    ++m_generation;
+    m_building.clear();
+    m_instances.clear();
+    m_topNodes.clear();
+    m_topInstances.clear();
+    m_topDirty = false;
+    m_candidates.clear();
+    m_stats = {};
+    m_framesMeasured = 0;
+    m_moveTimeAccumMs = 0.0f;
+}
+
+void CollisionWorld::sync(const MeshManager& meshManager)
+{
+    // Close out the previous frame's query statistics.
+    if (m_stats.queriesThisFrame > 0) {
+        if (m_framesMeasured >= kStatsWindowFrames) {
+            m_framesMeasured = 0;
+            m_moveTimeAccumMs = 0.0f;
+            m_stats.maxMoveTimeMs = 0.0f;
+        }
+        ++m_framesMeasured;
+        m_moveTimeAccumMs += m_stats.moveTimeThisFrameMs;
+        m_stats.avgMoveTimeMs = m_moveTimeAccumMs / static_cast<float>(m_framesMeasured);
+        m_stats.maxMoveTimeMs = std::max(m_stats.maxMoveTimeMs, m_stats.moveTimeThisFrameMs);
+    }
+    m_stats.queriesThisFrame = 0;
+    m_stats.instancesVisitedThisFrame = 0;
+    m_stats.trianglesTestedThisFrame = 0;
+    m_stats.moveTimeThisFrameMs = 0.0f;
+
+    adoptFinishedBuilds(meshManager);
+
+    for (auto& [id, bvh] : m_instances)
+        bvh.seen = false;
+
+    std::vector<BuildInput> newInstances;
+    for (const MeshInstance& instance : meshManager.instances()) {
+        auto it = m_instances.find(instance.id());
+        if (it == m_instances.end()) {
+            if (!m_building.contains(instance.id()))
+                newInstances.push_back(makeBuildInput(instance));
+            continue;
+        }
+
+        InstanceBvh& bvh = it->second;
+        bvh.seen = true;
+        if (bvh.transformVersion != instance.transformVersion()) {
+            transformInstance(instance.transform(), bvh);
+            refitNodes(bvh);
+            bvh.transformVersion = instance.transformVersion();
+            ++m_stats.refits;
+            m_topDirty = true;
+        }
+    }
+
+    // New instances are batched into one job; past the job limit they wait for a later sync.
+    if (!newInstances.empty() && m_jobs.size() < kMaxBuildJobs)
+        startBuildJob(std::move(newInstances));
+
+    if (std::erase_if(m_instances, [](const auto& entry) { return !entry.second.seen; }) > 0)
+        m_topDirty = true;
+    if (m_topDirty)
+        buildTopLevel();
+
+    m_stats.instanceCount = m_instances.size();
+    m_stats.pendingBuilds = m_building.size();
+    m_stats.triangleCount = 0;
+    m_stats.nodeCount = 0;
+    for (const auto& [id, bvh] : m_instances) {
+        m_stats.triangleCount += bvh.triangles.size();
+        m_stats.nodeCount += bvh.nodes.size();
+    }
+}
+
+CollisionWorld::BuildInput CollisionWorld::makeBuildInput(const MeshInstance& instance)
+{
+    BuildInput input { instance.id(), instance.transformVersion(), instance.transform(), {} };
+    for (const MeshDrawItem& item : instance.drawItems()) {
+        if (item.cpuGeometry)
+            input.items.push_back(BuildItem { item.cpuGeometry, item.nodeTransform });
+    }
+    return input;
+}
+
+void CollisionWorld::startBuildJob(std::vector<BuildInput> inputs)
+{
+    BuildJob& job = m_jobs.emplace_back();
+    job.generation = m_generation;
+    for (const BuildInput& input : inputs) {
+        job.ids.push_back(input.id);
+        m_building.insert(input.id);
+    }
+    job.done = std::async(std::launch::async, [inputs = std::move(inputs)]() {
+        const auto start = Clock::now();
+        std::vector<InstanceBvh> bvhs;
+        bvhs.reserve(inputs.size());
+        for (const BuildInput& input : inputs) {
+            InstanceBvh& bvh = bvhs.emplace_back(buildInstance(input.items, input.transform));
+            bvh.transformVersion = input.transformVersion;
+        }
+        return std::make_pair(std::move(bvhs), millisecondsSince(start));
+    });
+}
+
+void CollisionWorld::adoptFinishedBuilds(const MeshManager& meshManager)
+{
+    std::unordered_map<std::uint64_t, const MeshInstance*> live;
+    for (auto job = m_jobs.begin(); job != m_jobs.end();) {
+        if (job->done.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            ++job;
+            continue;
+        }
+        auto [bvhs, buildMs] = job->done.get();
+        if (job->generation != m_generation) {
+            job = m_jobs.erase(job);
+            continue;
+        }
+
+        if (live.empty()) {
+            for (const MeshInstance& instance : meshManager.instances())
+                live.emplace(instance.id(), &instance);
+        }
+        std::size_t triangles = 0;
+        for (std::size_t i = 0; i < job->ids.size(); ++i) {
+            const std::uint64_t id = job->ids[i];
+            m_building.erase(id);
+            const auto instance = live.find(id);
+            if (instance == live.end())
+                continue; // removed while building
+
+            InstanceBvh& bvh = bvhs[i];
+            // Moved while the worker was busy.
+            if (bvh.transformVersion != instance->second->transformVersion()) {
+                transformInstance(instance->second->transform(), bvh);
+                refitNodes(bvh);
+                bvh.transformVersion = instance->second->transformVersion();
+            }
+            triangles += bvh.triangles.size();
+            m_instances[id] = std::move(bvh);
+            ++m_stats.rebuilds;
+        }
+
+        m_stats.lastBuildMs = buildMs;
+        m_topDirty = true;
+        LOG_DEBUG(logging::Category::General, "[CollisionWorld] Built BVHs for {} instances ({} triangles) in {:.2f} ms",
+            job->ids.size(), triangles, buildMs);
+        job = m_jobs.erase(job);
+    }
+}
+
+CollisionWorld::InstanceBvh CollisionWorld::buildInstance(const std::vector<BuildItem>& items, const glm::mat4& transform)
+{
+    InstanceBvh bvh;
+    for (const BuildItem& item : items) {
+        const MeshGeometryData& geometry = *item.geometry;
+        const auto base = static_cast<std::uint32_t>(bvh.localPositions.size());
+        for (const glm::vec3& position : geometry.positions)
+            bvh.localPositions.push_back(glm::vec3(item.nodeTransform * glm::vec4(position, 1.0f)));
+        for (const glm::uvec3& triangle : geometry.triangles)
+            bvh.triangles.push_back(triangle + glm::uvec3(base));
+    }
+
+    transformInstance(transform, bvh);
+    buildNodes(bvh);
+    return bvh;
+}
+
+void CollisionWorld::transformInstance(const glm::mat4& transform, InstanceBvh& bvh)
+{
+    bvh.worldPositions.resize(bvh.localPositions.size());
+    for (std::size_t i = 0; i < bvh.localPositions.size(); ++i)
+        bvh.worldPositions[i] = glm::vec3(transform * glm::vec4(bvh.localPositions[i], 1.0f));
+}
+
+void CollisionWorld::buildNodes(InstanceBvh& bvh)
+{
+    bvh.nodes.clear();
+    const auto triangleCount = static_cast<std::uint32_t>(bvh.triangles.size());
+    if (triangleCount == 0) {
+        bvh.worldBounds = {};
+        return;
+    }
+
+    std::vector<glm::vec3> centroids(triangleCount);
+    for (std::uint32_t i = 0; i < triangleCount; ++i) {
+        const glm::uvec3& tri = bvh.triangles[i];
+        centroids[i] = (bvh.worldPositions[tri.x] + bvh.worldPositions[tri.y] + bvh.worldPositions[tri.z]) / 3.0f;
+    }
+
+    // Sort an index permutation, then apply it once so triangles and centroids stay in sync.
+    std::vector<std::uint32_t> order(triangleCount);
+    for (std::uint32_t i = 0; i < triangleCount; ++i)
+        order[i] = i;
+
+    bvh.nodes.reserve(static_cast<std::size_t>(triangleCount / kLeafTriangles) * 2 + 1);
+    bvh.nodes.push_back(Node { glm::vec3(0.0f), 0, glm::vec3(0.0f), triangleCount });
+
+    std::vector<std::uint32_t> stack { 0 };
+    while (!stack.empty()) {
+        const std::uint32_t nodeIndex = stack.back();
+        stack.pop_back();
+
+        const std::uint32_t first = bvh.nodes[nodeIndex].leftFirst;
+        const std::uint32_t count = bvh.nodes[nodeIndex].count;
+        if (count <= kLeafTriangles)
+            continue;
+
+        glm::vec3 centroidMin(std::numeric_limits<float>::max());
+        glm::vec3 centroidMax(std::numeric_limits<float>::lowest());
+        for (std::uint32_t i = first; i < first + count; ++i) {
+            centroidMin = glm::min(centroidMin, centroids[order[i]]);
+            centroidMax = glm::max(centroidMax, centroids[order[i]]);
+        }
+        const glm::vec3 extent = centroidMax - centroidMin;
+        int axis = 0;
+        if (extent.y > extent.x)
+            axis = 1;
+        if (extent.z > extent[axis])
+            axis = 2;
+        if (extent[axis] <= 0.0f)
+            continue; // all centroids coincide; keep as an oversized leaf
+
+        const std::uint32_t half = count / 2;
+        const auto begin = order.begin() + first;
+        std::nth_element(begin, begin + half, begin + count, [&](std::uint32_t lhs, std::uint32_t rhs) {
+            return centroids[lhs][axis] < centroids[rhs][axis];
+        });
+
+        const auto leftIndex = static_cast<std::uint32_t>(bvh.nodes.size());
+        bvh.nodes.push_back(Node { glm::vec3(0.0f), first, glm::vec3(0.0f), half });
+        bvh.nodes.push_back(Node { glm::vec3(0.0f), first + half, glm::vec3(0.0f), count - half });
+        bvh.nodes[nodeIndex].leftFirst = leftIndex;
+        bvh.nodes[nodeIndex].count = 0;
+        stack.push_back(leftIndex);
+        stack.push_back(leftIndex + 1);
+    }
+
+    std::vector<glm::uvec3> reordered(triangleCount);
+    for (std::uint32_t i = 0; i < triangleCount; ++i)
+        reordered[i] = bvh.triangles[order[i]];
+    bvh.triangles = std::move(reordered);
+
+    refitNodes(bvh);
+}
+
+void CollisionWorld::refitNodes(InstanceBvh& bvh)
+{
+    if (bvh.nodes.empty()) {
+        bvh.worldBounds = {};
+        return;
+    }
+
+    // Children are always allocated after their parent, so a reverse sweep visits children first.
+    for (std::size_t n = bvh.nodes.size(); n-- > 0;) {
+        Node& node = bvh.nodes[n];
+        if (node.count > 0) {
+            glm::vec3 nodeMin(std::numeric_limits<float>::max());
+            glm::vec3 nodeMax(std::numeric_limits<float>::lowest());
+            for (std::uint32_t i = node.leftFirst; i < node.leftFirst + node.count; ++i) {
+                const glm::uvec3& tri = bvh.triangles[i];
+                for (int v = 0; v < 3; ++v) {
+                    const glm::vec3& p = bvh.worldPositions[tri[v]];
+                    nodeMin = glm::min(nodeMin, p);
+                    nodeMax = glm::max(nodeMax, p);
+                }
+            }
+            node.min = nodeMin;
+            node.max = nodeMax;
+        } else {
+            const Node& left = bvh.nodes[node.leftFirst];
+            const Node& right = bvh.nodes[node.leftFirst + 1];
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+        }
+    }
+
+    bvh.worldBounds.min = bvh.nodes.front().min;
+    bvh.worldBounds.max = bvh.nodes.front().max;
+}
+
+// Same median split as buildNodes, over instance bounds; rebuilt whenever an instance is added,
+// removed or moved, which is cheap next to the per-instance BVHs.
+void CollisionWorld::buildTopLevel()
+{
+    m_topDirty = false;
+    m_topNodes.clear();
+    m_topInstances.clear();
+    for (const auto& [id, bvh] : m_instances) {
+        if (!bvh.nodes.empty())
+            m_topInstances.push_back(&bvh);
+    }
+    const auto instanceCount = static_cast<std::uint32_t>(m_topInstances.size());
+    if (instanceCount == 0)
+        return;
+
+    const auto centroid = [](const InstanceBvh* bvh) { return (bvh->worldBounds.min + bvh->worldBounds.max) * 0.5f; };
+    m_topNodes.reserve(static_cast<std::size_t>(instanceCount) * 2);
+    m_topNodes.push_back(Node { glm::vec3(0.0f), 0, glm::vec3(0.0f), instanceCount });
+
+    std::vector<std::uint32_t> stack { 0 };
+    while (!stack.empty()) {
+        const std::uint32_t nodeIndex = stack.back();
+        stack.pop_back();
+
+        const std::uint32_t first = m_topNodes[nodeIndex].leftFirst;
+        const std::uint32_t count = m_topNodes[nodeIndex].count;
+        if (count <= kLeafInstances)
+            continue;
+
+        glm::vec3 centroidMin(std::numeric_limits<float>::max());
+        glm::vec3 centroidMax(std::numeric_limits<float>::lowest());
+        for (std::uint32_t i = first; i < first + count; ++i) {
+            centroidMin = glm::min(centroidMin, centroid(m_topInstances[i]));
+            centroidMax = glm::max(centroidMax, centroid(m_topInstances[i]));
+        }
+        const glm::vec3 extent = centroidMax - centroidMin;
+        int axis = 0;
+        if (extent.y > extent.x)
+            axis = 1;
+        if (extent.z > extent[axis])
+            axis = 2;
+        if (extent[axis] <= 0.0f)
+            continue;
+
+        const std::uint32_t half = count / 2;
+        const auto begin = m_topInstances.begin() + first;
+        std::nth_element(begin, begin + half, begin + count, [&](const InstanceBvh* lhs, const InstanceBvh* rhs) {
+            return centroid(lhs)[axis] < centroid(rhs)[axis];
+        });
+
+        const auto leftIndex = static_cast<std::uint32_t>(m_topNodes.size());
+        m_topNodes.push_back(Node { glm::vec3(0.0f), first, glm::vec3(0.0f), half });
+        m_topNodes.push_back(Node { glm::vec3(0.0f), first + half, glm::vec3(0.0f), count - half });
+        m_topNodes[nodeIndex].leftFirst = leftIndex;
+        m_topNodes[nodeIndex].count = 0;
+        stack.push_back(leftIndex);
+        stack.push_back(leftIndex + 1);
+    }
+
+    for (std::size_t n = m_topNodes.size(); n-- > 0;) {
+        Node& node = m_topNodes[n];
+        if (node.count > 0) {
+            node.min = glm::vec3(std::numeric_limits<float>::max());
+            node.max = glm::vec3(std::numeric_limits<float>::lowest());
+            for (std::uint32_t i = node.leftFirst; i < node.leftFirst + node.count; ++i) {
+                node.min = glm::min(node.min, m_topInstances[i]->worldBounds.min);
+                node.max = glm::max(node.max, m_topInstances[i]->worldBounds.max);
+            }
+        } else {
+            const Node& left = m_topNodes[node.leftFirst];
+            const Node& right = m_topNodes[node.leftFirst + 1];
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+        }
+    }
+}
+
+void CollisionWorld::gatherTriangles(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+    m_candidates.clear();
+    ++m_stats.queriesThisFrame;
+    if (m_topNodes.empty())
+        return;
+
+    m_topStack.clear();
+    m_topStack.push_back(0);
+    while (!m_topStack.empty()) {
+        const Node& top = m_topNodes[m_topStack.back()];
+        m_topStack.pop_back();
+        if (!overlaps(boundsMin, boundsMax, top.min, top.max))
+            continue;
+        if (top.count == 0) {
+            m_topStack.push_back(top.leftFirst);
+            m_topStack.push_back(top.leftFirst + 1);
+            continue;
+        }
+
+        for (std::uint32_t instance = top.leftFirst; instance < top.leftFirst + top.count; ++instance) {
+            const InstanceBvh& bvh = *m_topInstances[instance];
+            if (!overlaps(boundsMin, boundsMax, bvh.worldBounds.min, bvh.worldBounds.max))
+                continue;
+            ++m_stats.instancesVisitedThisFrame;
+
+            m_traversalStack.clear();
+            m_traversalStack.push_back(0);
+            while (!m_traversalStack.empty()) {
+                const Node& node = bvh.nodes[m_traversalStack.back()];
+                m_traversalStack.pop_back();
+                if (!overlaps(boundsMin, boundsMax, node.min, node.max))
+                    continue;
+
+                if (node.count == 0) {
+                    m_traversalStack.push_back(node.leftFirst);
+                    m_traversalStack.push_back(node.leftFirst + 1);
+                    continue;
+                }
+
+                for (std::uint32_t i = node.leftFirst; i < node.leftFirst + node.count; ++i) {
+                    const glm::uvec3& tri = bvh.triangles[i];
+                    m_candidates.push_back(bvh.worldPositions[tri.x]);
+                    m_candidates.push_back(bvh.worldPositions[tri.y]);
+                    m_candidates.push_back(bvh.worldPositions[tri.z]);
+                }
+            }
+        }
+    }
+}
+
+void CollisionWorld::resolvePenetration(glm::vec3& feetPosition, float radius, float height, const MoveParams& params, SlideResult& result, glm::vec3& velocityDir)
+{
+    const float cosMaxSlope = std::cos(glm::radians(params.maxSlopeDegrees));
+    const float segmentTop = std::max(height - radius, radius);
+
+    for (int iteration = 0; iteration < params.maxResolveIterations; ++iteration) {
+        bool anyContact = false;
+        for (std::size_t i = 0; i + 2 < m_candidates.size(); i += 3) {
+            const glm::vec3 a = feetPosition + glm::vec3(0.0f, radius, 0.0f);
+            const glm::vec3 b = feetPosition + glm::vec3(0.0f, segmentTop, 0.0f);
+            glm::vec3 normal;
+            glm::vec3 faceNormal;
+            float depth = 0.0f;
+            ++m_stats.trianglesTestedThisFrame;
+            if (!capsuleTriangleContact(a, b, radius, m_candidates[i], m_candidates[i + 1], m_candidates[i + 2], normal, faceNormal, depth))
+                continue;
+            if (depth <= kContactEpsilon)
+                continue;
+
+            anyContact = true;
+            // The rounded bottom resting on the edge of a walkable face (a ledge or stair nosing) counts as
+            // ground too, otherwise the edge normal reads as a wall and the capsule slides back off.
+            const bool walkableEdge = normal.y > 0.0f && faceNormal.y >= cosMaxSlope;
+            if (normal.y >= cosMaxSlope || walkableEdge) {
+                // Walkable: lift straight up so standing on a slope does not slide the player downhill.
+                feetPosition.y += std::min(depth / normal.y, depth * 2.0f);
+                result.grounded = true;
+                result.groundNormal = walkableEdge ? faceNormal : normal;
+            } else {
+                feetPosition += normal * depth;
+                if (normal.y <= kCeilingNormalY)
+                    result.hitCeiling = true;
+                else
+                    result.hitWall = true;
+            }
+
+            const float into = glm::dot(velocityDir, normal);
+            if (into < 0.0f)
+                velocityDir -= normal * into;
+        }
+        if (!anyContact)
+            break;
+    }
+}
+
+CollisionWorld::SlideResult CollisionWorld::slide(const glm::vec3& feetPosition, float radius, float height, const glm::vec3& displacement, const MoveParams& params)
+{
+    SlideResult result;
+    result.position = feetPosition;
+
+    const float segmentTop = std::max(height - radius, radius);
+    const glm::vec3 start = feetPosition;
+    const glm::vec3 end = feetPosition + displacement;
+    const glm::vec3 sweepMin = glm::min(start, end) - glm::vec3(radius + kContactEpsilon);
+    const glm::vec3 sweepMax = glm::max(start, end) + glm::vec3(radius + kContactEpsilon) + glm::vec3(0.0f, segmentTop, 0.0f);
+    gatherTriangles(sweepMin, sweepMax);
+
+    if (m_candidates.empty()) {
+        result.position = end;
+        return result;
+    }
+
+    // Substep so a single step never moves further than half the radius (no tunnelling through thin walls).
+    const float length = glm::length(displacement);
+    const float maxStep = std::max(radius * 0.5f, 1e-3f);
+    const int steps = std::clamp(static_cast<int>(std::ceil(length / maxStep)), 1, kMaxSubsteps);
+    glm::vec3 step = displacement / static_cast<float>(steps);
+
+    glm::vec3 position = feetPosition;
+    resolvePenetration(position, radius, height, params, result, step);
+    for (int i = 0; i < steps; ++i) {
+        position += step;
+        resolvePenetration(position, radius, height, params, result, step);
+        if (glm::length2(step) <= 1e-12f)
+            break;
+    }
+
+    result.position = position;
+    return result;
+}
+
+CollisionWorld::MoveResult CollisionWorld::moveCapsule(const glm::vec3& feetPosition,
+    float radius,
+    float height,
+    const glm::vec3& displacement,
+    const MoveParams& params)
+{
+    const auto start = Clock::now();
+    MoveResult result;
+    result.position = feetPosition + displacement;
+    if (m_instances.empty())
+        return result;
+
+    const float cosMaxSlope = std::cos(glm::radians(params.maxSlopeDegrees));
+    SlideResult primary = slide(feetPosition, radius, height, displacement, params);
+
+    const glm::vec3 horizontal(displacement.x, 0.0f, displacement.z);
+    if (primary.hitWall && params.stepHeight > 0.0f && glm::length2(horizontal) > 1e-10f) {
+        const SlideResult up = slide(feetPosition, radius, height, glm::vec3(0.0f, params.stepHeight, 0.0f), params);
+        const SlideResult across = slide(up.position, radius, height, horizontal, params);
+        const float drop = params.stepHeight + std::max(0.0f, -displacement.y);
+        const SlideResult down = slide(across.position, radius, height, glm::vec3(0.0f, -drop, 0.0f), params);
+
+        const auto progress = [&](const glm::vec3& p) {
+            return glm::length(glm::vec2(p.x - feetPosition.x, p.z - feetPosition.z));
+        };
+        if (down.grounded && down.groundNormal.y >= cosMaxSlope && progress(down.position) > progress(primary.position) + 1e-4f) {
+            primary = down;
+            result.stepped = true;
+        }
+    }
+
+    if (params.snapToGround && !primary.grounded && displacement.y <= 0.0f && params.snapDistance > 0.0f) {
+        const SlideResult probe = slide(primary.position, radius, height, glm::vec3(0.0f, -params.snapDistance, 0.0f), params);
+        if (probe.grounded) {
+            primary.position = probe.position;
+            primary.grounded = true;
+            primary.groundNormal = probe.groundNormal;
+            result.snapped = true;
+        }
+    }
+
+    result.position = primary.position;
+    result.groundNormal = primary.groundNormal;
+    result.grounded = primary.grounded;
+    result.hitWall = primary.hitWall;
+    result.hitCeiling = primary.hitCeiling;
+
+    m_stats.moveTimeThisFrameMs += millisecondsSince(start);
+    return result;
+}
+
+void CollisionWorld::drawImGuiPanel()
+{
+    const Stats& stats = m_stats;
+    ImGui::Text("Collision instances: %zu (%zu building) | triangles: %zu | BVH nodes: %zu",
+        stats.instanceCount, stats.pendingBuilds, stats.triangleCount, stats.nodeCount);
+    ImGui::Text("Builds: %u (last %.2f ms) | Refits: %u", stats.rebuilds, static_cast<double>(stats.lastBuildMs), stats.refits);
+    ImGui::Text("Queries this frame: %u | instances visited: %llu | triangles tested: %llu",
+        stats.queriesThisFrame,
+        static_cast<unsigned long long>(stats.instancesVisitedThisFrame),
+        static_cast<unsigned long long>(stats.trianglesTestedThisFrame));
+    ImGui::Text("Player update: %.4f ms (avg %.4f, max %.4f)",
+        static_cast<double>(stats.moveTimeThisFrameMs),
+        static_cast<double>(stats.avgMoveTimeMs),
+        static_cast<double>(stats.maxMoveTimeMs));
+}
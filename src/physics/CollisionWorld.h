@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "mesh/MeshInstance.h"
+
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class MeshManager;
+
+// Static triangle collision for the player. Every mesh instance gets a world-space BVH over the
+// triangles of all its draw items, built on a worker thread; moving an instance refits the BVH
+// instead of rebuilding it. A top-level BVH over the instance bounds limits a query to the
+// instances it overlaps.
+class CollisionWorld {
+public:
+    struct MoveParams {
+        float maxSlopeDegrees { 50.0f };
+        float stepHeight { 0.35f };
+        float snapDistance { 0.3f };
+        int maxResolveIterations { 4 };
+        bool snapToGround { true };
+    };
+
+    struct MoveResult {
+        glm::vec3 position { 0.0f }; // feet position
+        glm::vec3 groundNormal { 0.0f, 1.0f, 0.0f };
+        bool grounded { false };
+        bool hitWall { false };
+        bool hitCeiling { false };
+        bool stepped { false };
+        bool snapped { false };
+    };
+
+    struct Stats {
+        std::size_t instanceCount { 0 };
+        std::size_t pendingBuilds { 0 }; // instances without collision until their worker finishes
+        std::size_t triangleCount { 0 };
+        std::size_t nodeCount { 0 };
+        std::uint32_t rebuilds { 0 };
+        std::uint32_t refits { 0 };
+        float lastBuildMs { 0.0f };
+
+        std::uint32_t queriesThisFrame { 0 };
+        std::uint64_t instancesVisitedThisFrame { 0 };
+        std::uint64_t trianglesTestedThisFrame { 0 };
+        float moveTimeThisFrameMs { 0.0f };
+        float avgMoveTimeMs { 0.0f };
+        float maxMoveTimeMs { 0.0f };
+    };
+
+    // Brings the per-instance BVHs in line with the mesh manager: queues builds for new instances,
+    // adopts finished ones, refits moved ones and drops removed ones. Also resets the per-frame
+    // query counters.
+    void sync(const MeshManager& meshManager);
+    void clear();
+
+    [[nodiscard]] bool empty() const { return m_instances.empty(); }
+
+    // Moves an upright capsule (feet at `feetPosition`) by `displacement` with substepped sweeps,
+    // sliding along walls, stepping over small ledges and snapping down onto walkable ground.
+    [[nodiscard]] MoveResult moveCapsule(const glm::vec3& feetPosition,
+        float radius,
+        float height,
+        const glm::vec3& displacement,
+        const MoveParams& params);
+
+    [[nodiscard]] const Stats& stats() const { return m_stats; }
+    void drawImGuiPanel();
+
+private:
+    struct Node {
+        glm::vec3 min { 0.0f };
+        std::uint32_t leftFirst { 0 }; // first child for interior nodes, first triangle for leaves
+        glm::vec3 max { 0.0f };
+        std::uint32_t count { 0 }; // triangle count; 0 marks an interior node
+    };
+    static_assert(sizeof(Node) == 32, "BVH nodes are expected to stay at 32 bytes");
+
+    struct InstanceBvh {
+        std::uint64_t transformVersion { 0 };
+        std::vector<glm::vec3> localPositions; // nodeTransform already applied
+        std::vector<glm::vec3> worldPositions;
+        std::vector<glm::uvec3> triangles; // reordered so each leaf owns a contiguous range
+        std::vector<Node> nodes;
+        BoundingBox worldBounds;
+        bool seen { false };
+    };
+
+    struct Contact {
+        glm::vec3 normal { 0.0f };
+        float depth { 0.0f };
+    };
+
+    struct SlideResult {
+        glm::vec3 position { 0.0f };
+        glm::vec3 groundNormal { 0.0f, 1.0f, 0.0f };
+        bool grounded { false };
+        bool hitWall { false };
+        bool hitCeiling { false };
+    };
+
+    struct BuildItem {
+        std::shared_ptr<const MeshGeometryData> geometry;
+        glm::mat4 nodeTransform { 1.0f };
+    };
+
+    // Copied out of a MeshInstance so the worker never touches the mesh manager.
+    struct BuildInput {
+        std::uint64_t id { 0 };
+        std::uint64_t transformVersion { 0 };
+        glm::mat4 transform { 1.0f };
+        std::vector<BuildItem> items;
+    };
+
+    struct BuildJob {
+        std::vector<std::uint64_t> ids;
+        std::uint64_t generation { 0 };
+        std::future<std::pair<std::vector<InstanceBvh>, float>> done; // BVHs in `ids` order and build time in ms
+    };
+
+    static BuildInput makeBuildInput(const MeshInstance& instance);
+    void startBuildJob(std::vector<BuildInput> inputs);
+    void adoptFinishedBuilds(const MeshManager& meshManager);
+    static InstanceBvh buildInstance(const std::vector<BuildItem>& items, const glm::mat4& transform);
+    static void transformInstance(const glm::mat4& transform, InstanceBvh& bvh);
+    static void buildNodes(InstanceBvh& bvh);
+    static void refitNodes(InstanceBvh& bvh);
+    void buildTopLevel();
+
+    void gatherTriangles(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+    SlideResult slide(const glm::vec3& feetPosition, float radius, float height, const glm::vec3& displacement, const MoveParams& params);
+    void resolvePenetration(glm::vec3& feetPosition, float radius, float height, const MoveParams& params, SlideResult& result, glm::vec3& velocityDir);
+
+    std::unordered_map<std::uint64_t, InstanceBvh> m_instances;
+    std::vector<BuildJob> m_jobs;
+    std::unordered_set<std::uint64_t> m_building;
+    std::uint64_t m_generation { 0 }; // bumped by clear() so in-flight results are dropped
+
+    // Top-level BVH; leaves index ranges of m_topInstances.
+    std::vector<Node> m_topNodes;
+    std::vector<const InstanceBvh*> m_topInstances;
+    bool m_topDirty { false };
+
+    // Candidate triangles gathered for the current sweep: (instance, triangle) pairs flattened to positions.
+    std::vector<glm::vec3> m_candidates;
+    std::vector<std::uint32_t> m_traversalStack;
+    std::vector<std::uint32_t> m_topStack;
+
+    Stats m_stats;
+    std::uint64_t m_framesMeasured { 0 };
+    float m_moveTimeAccumMs { 0.0f };
+};
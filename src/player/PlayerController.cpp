@@ -10,15 +10,9 @@ void PlayerController::applyMoveInput(const glm::vec3& camForward, const glm::ve
     m_pendingDisplacement += wish * moveSpeed * dt;
 }
 
-void PlayerController::update(float dt, const ProceduralFloor* floor, bool jumpRequest) {
+void PlayerController::update(float dt, const ProceduralFloor* floor, bool jumpRequest, CollisionWorld* world) {
     if (dt <= 0) return;
-    // Apply accumulated horizontal displacement first
-    if (glm::length(m_pendingDisplacement) > 0.0f) {
-        m_position += m_pendingDisplacement;
-        m_pendingDisplacement = glm::vec3(0.0f);
-    }
 
-    // Gravity
     // Gravity
     // If levitating, apply upward acceleration instead of letting gravity fully dominate.
     if (m_levitationTimeRemaining > 0.0f) {
@@ -28,25 +22,36 @@ void PlayerController::update(float dt, const ProceduralFloor* floor, bool jumpR
         m_velocity.y += m_params.gravity * dt;
     }
 
-    // Integrate vertical only (horizontal done by pending displacement)
-    m_position.y += m_velocity.y * dt;
+    // Horizontal motion comes from the accumulated displacement, vertical from the integrated velocity.
+    const glm::vec3 displacement = m_pendingDisplacement + glm::vec3(0.0f, m_velocity.y * dt, 0.0f);
+    m_pendingDisplacement = glm::vec3(0.0f);
 
+    bool meshGrounded = false;
+    if (world && !world->empty()) {
+        CollisionWorld::MoveParams moveParams = m_collisionParams;
+        // Only stick to the ground when we were standing on it and are not moving upwards.
+        moveParams.snapToGround = m_collisionParams.snapToGround && m_grounded && m_velocity.y <= 0.0f;
+        const CollisionWorld::MoveResult result = world->moveCapsule(m_position, m_params.radius, m_params.height, displacement, moveParams);
+        m_position = result.position;
+        meshGrounded = result.grounded;
+        if (meshGrounded && m_velocity.y < 0.0f)
+            m_velocity.y = 0.0f;
+        if (result.hitCeiling && m_velocity.y > 0.0f)
+            m_velocity.y = 0.0f;
+    } else {
+        m_position += displacement;
+    }
+
+    bool floorGrounded = false;
     if (floor) {
         // Collision (bottom sphere centered at feet + radius)
         glm::vec3 bottomCenter = m_position + glm::vec3(0, m_params.radius, 0);
         float pen; glm::vec3 n;
         if (floor->testSphereCollision(bottomCenter, m_params.radius, pen, n)) {
-            // adjust position upward
             // Move feet up by penetration
             m_position.y += pen;
             m_velocity.y = 0.0f;
-            m_grounded = true;
-            if (jumpRequest) {
-                m_velocity.y = m_params.jumpImpulse;
-                m_grounded = false;
-            }
-        } else {
-            m_grounded = false;
+            floorGrounded = true;
         }
 
         // Ensure feet never below sampled terrain height (robustness)
@@ -54,7 +59,7 @@ void PlayerController::update(float dt, const ProceduralFloor* floor, bool jumpR
         if (m_position.y < groundH) {
             m_position.y = groundH;
             if (m_velocity.y < 0) m_velocity.y = 0;
-            m_grounded = true;
+            floorGrounded = true;
         }
     } else {
         constexpr float kGroundHeight = 0.0f;
@@ -62,15 +67,15 @@ void PlayerController::update(float dt, const ProceduralFloor* floor, bool jumpR
             m_position.y = kGroundHeight;
             if (m_velocity.y < 0.0f)
                 m_velocity.y = 0.0f;
-            m_grounded = true;
-            if (jumpRequest) {
-                m_velocity.y = m_params.jumpImpulse;
-                m_grounded = false;
-            }
-        } else {
-            m_grounded = false;
+            floorGrounded = true;
         }
     }
+
+    m_grounded = meshGrounded || floorGrounded;
+    if (m_grounded && jumpRequest) {
+        m_velocity.y = m_params.jumpImpulse;
+        m_grounded = false;
+    }
 }
 
 void PlayerController::applyVerticalImpulse(float v) {
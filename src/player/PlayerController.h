@@ -1,6 +1,7 @@
 #pragma once
 #include <glm/vec3.hpp>
 #include "terrain/ProceduralFloor.h"
+#include "physics/CollisionWorld.h"
 
 class PlayerController {
 public:
@@ -20,7 +21,8 @@ public:
     // Returns eye position (feet + height)
     glm::vec3 eyePosition() const { return m_position + glm::vec3(0,m_params.height,0); }
 
-    void update(float dt, const ProceduralFloor* floor, bool jumpRequest);
+    // `world` is optional; when given the player collides with loaded meshes as well as the floor.
+    void update(float dt, const ProceduralFloor* floor, bool jumpRequest, CollisionWorld* world = nullptr);
     // Accumulate horizontal movement input (camera-relative) before update.
     void applyMoveInput(const glm::vec3& camForward, const glm::vec3& camRight, const glm::vec3& moveInput, float moveSpeed, float dt);
 
@@ -32,8 +34,12 @@ public:
     // Start a sustained levitation effect: apply upward acceleration for `duration` seconds
     void startLevitation(float duration, float upwardAccel);
 
+    void setCollisionParams(const CollisionWorld::MoveParams& p) { m_collisionParams = p; }
+    const CollisionWorld::MoveParams& collisionParams() const { return m_collisionParams; }
+
 private:
     Params m_params;
+    CollisionWorld::MoveParams m_collisionParams;
     // Feet position (not eye)
     glm::vec3 m_position {0,3,0};
     glm::vec3 m_velocity {0,0,0};
@@ -10,10 +10,16 @@ DISABLE_WARNINGS_POP()
 #include <glad/glad.h>
 
 #include <glm/common.hpp>
+#include <glm/exponential.hpp>
+#include <glm/geometric.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/vec4.hpp>
 
 #include <array>
 #include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
 #include <limits>
 #include <stdexcept>
 #include <cstdio>
@@ -40,6 +46,25 @@ constexpr float kLensDirtWhite[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
     return size.x > 0 && size.y > 0;
 }
 
+// CPU mirror of applyColorGrading() followed by applyExposure() in camera_effects.frag; keep in sync.
+[[nodiscard]] glm::vec3 gradeSceneColor(const glm::vec3& color, const CameraEffectsStage::Settings& settings)
+{
+    glm::vec3 result = color;
+    if (settings.colorGradingEnabled) {
+        const CameraEffectsStage::Settings::ColorGrade& grade = settings.colorGrade;
+        const glm::vec3 lifted = result + grade.lift;
+        glm::vec3 graded = glm::pow(glm::max(lifted, glm::vec3(0.0f)), glm::max(grade.gamma, glm::vec3(0.001f)));
+        graded *= grade.gain;
+        const glm::vec3 contrasted = glm::mix(glm::vec3(0.5f), graded, settings.contrast);
+        const float luminance = glm::dot(contrasted, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+        result = glm::clamp(glm::mix(glm::vec3(luminance), contrasted, settings.saturation), 0.0f, 1.0f);
+    }
+
+    const float gamma = std::max(settings.gamma, 0.001f);
+    const glm::vec3 mapped = glm::max(result * std::exp2(settings.exposure), glm::vec3(0.0f));
+    return glm::pow(mapped, glm::vec3(1.0f / gamma));
+}
+
 #ifndef NDEBUG
 void debugTraceFramebuffer(const char* label)
 {
@@ -80,6 +105,7 @@ void CameraEffectsStage::shutdown()
     if (m_framebuffer) glDeleteFramebuffers(1, &m_framebuffer);
     if (m_bloomFramebuffer) glDeleteFramebuffers(1, &m_bloomFramebuffer);
     if (m_settingsUbo) glDeleteBuffers(1, &m_settingsUbo);
+    if (m_gradingLut) glDeleteTextures(1, &m_gradingLut);
     
     // Clean up MSAA resources
     if (m_msaaFramebuffer) glDeleteFramebuffers(1, &m_msaaFramebuffer);
@@ -95,6 +121,10 @@ void CameraEffectsStage::shutdown()
     m_framebuffer = 0;
     m_bloomFramebuffer = 0;
     m_settingsUbo = 0;
+    m_gradingLut = 0;
+    m_gradingLutSize = 0;
+    m_gradingLutDirty = true;
+    m_bakedGradingKey.reset();
     m_msaaFramebuffer = 0;
     m_msaaColorRBO = 0;
     m_msaaDepthRBO = 0;
@@ -152,7 +182,13 @@ void CameraEffectsStage::beginSceneCapture(glm::ivec2 framebufferSize, const Set
     glViewport(0, 0, framebufferSize.x, framebufferSize.y);
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (m_sceneStencilAllocated) {
+        glStencilMask(0xFF);
+        glClearStencil(0);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+    } else {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
 
     TRACE_FBO("beginSceneCapture bound capture FBO");
 
@@ -172,7 +208,7 @@ void CameraEffectsStage::endSceneCapture()
         glBlitFramebuffer(
             0, 0, m_framebufferSize.x, m_framebufferSize.y,  // src
             0, 0, m_framebufferSize.x, m_framebufferSize.y,  // dst
-            GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT,        // mask
+            GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | (m_sceneStencilAllocated ? GL_STENCIL_BUFFER_BIT : 0u), // mask
             GL_NEAREST                                         // filter
         );
         
@@ -238,6 +274,10 @@ void CameraEffectsStage::updateUniforms(const Settings& settings,
     sanitized.bloom.threshold = glm::max(sanitized.bloom.threshold, 0.0f);
     sanitized.bloom.mipCount = std::clamp(sanitized.bloom.mipCount, 1, 8);
     sanitized.bloom.dirtIntensity = glm::max(sanitized.bloom.dirtIntensity, 0.0f);
+    sanitized.gradingLut.size = sanitized.gradingLut.size > 32 ? 64 : 32;
+    // A .cube file can only be applied through the baked LUT, so setting one turns the bake on.
+    if (!sanitized.gradingLut.cubePath.empty())
+        sanitized.gradingLut.enabled = true;
 
     if (!isValidSize(framebufferSize))
         framebufferSize = m_framebufferSize;
@@ -299,6 +339,14 @@ void CameraEffectsStage::updateUniforms(const Settings& settings,
     const float height = static_cast<float>(std::max(framebufferSize.y, 1));
     m_gpuSettings.resolutionParams = glm::vec4(width, height, 1.0f / width, 1.0f / height);
 
+    m_gpuSettings.lutParams = glm::vec4(
+        sanitized.gradingLut.enabled ? 1.0f : 0.0f,
+        kGradingLutMinLog2,
+        1.0f / (kGradingLutMaxLog2 - kGradingLutMinLog2),
+        static_cast<float>(sanitized.gradingLut.size));
+    if (sanitized.gradingLut.enabled && (!m_bakedGradingKey || *m_bakedGradingKey != gradingKey(sanitized)))
+        m_gradingLutDirty = true;
+
     m_settingsDirty = true;
     m_cachedSettings = sanitized;
     m_cachedSettingsValid = true;
@@ -312,6 +360,7 @@ void CameraEffectsStage::drawPostProcess(glm::ivec2 framebufferSize, GLuint targ
     if (!isValidSize(framebufferSize))
         framebufferSize = m_framebufferSize;
 
+    bakeGradingLutIfNeeded();
     uploadSettingsIfNeeded();
 
     glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
@@ -366,11 +415,13 @@ void CameraEffectsStage::drawPostProcess(glm::ivec2 framebufferSize, GLuint targ
     TextureUnits::assertNotEnvUnit(2);
     TextureUnits::assertNotEnvUnit(3);
     TextureUnits::assertNotEnvUnit(4);
+    TextureUnits::assertNotEnvUnit(kGradingLutUnit);
     glBindTextureUnit(0, m_sceneColor);
     glBindTextureUnit(1, m_sceneDepth);
     glBindTextureUnit(2, bloomTexture);
     glBindTextureUnit(3, m_lensDirtTexture);
     glBindTextureUnit(4, m_velocityTexture);
+    glBindTextureUnit(kGradingLutUnit, m_gradingLut);
 
     drawFullscreenQuad();
     TRACE_FBO("drawPostProcess after quad");
@@ -480,6 +531,38 @@ void CameraEffectsStage::drawImGuiPanel(Settings& settings)
     ImGui::SliderFloat("Contrast", &settings.contrast, 0.0f, 2.5f);
     ImGui::SliderFloat("Saturation", &settings.saturation, 0.0f, 2.5f);
 
+    ImGui::Checkbox("Bake Grading LUT", &settings.gradingLut.enabled);
+    if (ImGui::IsItemHovered())
+        ImGui::SetTooltip("Bake tone mapping and grading into a 3D LUT when they change\ninstead of evaluating them per pixel");
+    const bool cubeForcesLut = !settings.gradingLut.enabled && !settings.gradingLut.cubePath.empty();
+    if (cubeForcesLut)
+        ImGui::TextDisabled("A .cube LUT is set, so the LUT is baked regardless of this toggle.");
+    ImGui::BeginDisabled(!settings.gradingLut.enabled && !cubeForcesLut);
+    int lutSizeIndex = settings.gradingLut.size > 32 ? 1 : 0;
+    const char* lutSizes[] = { "32^3", "64^3" };
+    if (ImGui::Combo("LUT Size", &lutSizeIndex, lutSizes, 2))
+        settings.gradingLut.size = lutSizeIndex == 0 ? 32 : 64;
+    ImGui::EndDisabled();
+    if (m_cubePathBuffer[0] == '\0' && !settings.gradingLut.cubePath.empty())
+        std::strncpy(m_cubePathBuffer.data(), settings.gradingLut.cubePath.string().c_str(), m_cubePathBuffer.size() - 1);
+    ImGui::InputText(".cube LUT", m_cubePathBuffer.data(), m_cubePathBuffer.size());
+    if (ImGui::Button("Load .cube")) {
+        settings.gradingLut.cubePath = m_cubePathBuffer.data();
+        m_cubeLutPath.clear(); // reload even if the path is unchanged
+        m_gradingLutDirty = true;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear .cube")) {
+        settings.gradingLut.cubePath.clear();
+        m_cubePathBuffer[0] = '\0';
+    }
+    if (!m_cubeLutError.empty())
+        ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "%s", m_cubeLutError.c_str());
+    else if (!m_cubeLut.empty())
+        ImGui::Text("Cube: %s (%d^3)", m_cubeLut.title.empty() ? m_cubeLutPath.filename().string().c_str() : m_cubeLut.title.c_str(), m_cubeLut.size);
+    if (m_gradingLutSize > 0)
+        ImGui::Text("LUT %d^3 | last bake %.2f ms | %u bakes", m_gradingLutSize, static_cast<double>(m_lastLutBakeMs), m_lutBakes);
+
     ImGui::Separator();
     ImGui::TextUnformatted("Effect Toggles");
     ImGui::Checkbox("Bloom", &settings.bloomEnabled);
@@ -576,7 +659,7 @@ void CameraEffectsStage::ensureFramebuffer(glm::ivec2 size)
         glGenTextures(1, &m_sceneDepth);
     if (m_velocityTexture == 0)
         glGenTextures(1, &m_velocityTexture);
-    if (m_framebufferSize != size) {
+    if (m_framebufferSize != size || m_sceneStencilAllocated != m_sceneStencil) {
         destroyBloomMipChain();
         m_framebufferSize = size;
         m_bloomBaseSize = glm::ivec2(0);
@@ -590,7 +673,11 @@ void CameraEffectsStage::ensureFramebuffer(glm::ivec2 size)
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
         glBindTexture(GL_TEXTURE_2D, m_sceneDepth);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, size.x, size.y, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        if (m_sceneStencil)
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH32F_STENCIL8, size.x, size.y, 0, GL_DEPTH_STENCIL, GL_FLOAT_32_UNSIGNED_INT_24_8_REV, nullptr);
+        else
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, size.x, size.y, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        m_sceneStencilAllocated = m_sceneStencil;
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -608,6 +695,7 @@ void CameraEffectsStage::ensureFramebuffer(glm::ivec2 size)
     glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
     glFramebufferTexture2D(GL_FRAMEBUFFER, kColorAttachment, GL_TEXTURE_2D, m_sceneColor, 0);
     glFramebufferTexture2D(GL_FRAMEBUFFER, kDepthAttachment, GL_TEXTURE_2D, m_sceneDepth, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_sceneStencilAllocated ? m_sceneDepth : 0, 0);
 
     GLenum buffers[] = { kColorAttachment };
     glDrawBuffers(1, buffers);
@@ -657,7 +745,8 @@ void CameraEffectsStage::ensureMSAAFramebuffer(glm::ivec2 size, int samples)
     // Check if we need to recreate MSAA resources
     bool needsRecreate = (m_msaaFramebuffer == 0 || 
                           m_currentMsaaSamples != samples || 
-                          m_framebufferSize != size);
+                          m_framebufferSize != size ||
+                          m_msaaStencilAllocated != m_sceneStencilAllocated);
 
     if (!needsRecreate)
         return;
@@ -695,8 +784,9 @@ void CameraEffectsStage::ensureMSAAFramebuffer(glm::ivec2 size, int samples)
     // Create multisampled depth renderbuffer
     glGenRenderbuffers(1, &m_msaaDepthRBO);
     glBindRenderbuffer(GL_RENDERBUFFER, m_msaaDepthRBO);
-    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT32F, size.x, size.y);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_msaaDepthRBO);
+    m_msaaStencilAllocated = m_sceneStencilAllocated;
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, m_msaaStencilAllocated ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F, size.x, size.y);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, m_msaaStencilAllocated ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_msaaDepthRBO);
 
     // Check framebuffer completeness
     GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
@@ -957,6 +1047,7 @@ void CameraEffectsStage::ensureShader()
         if (const GLint loc = m_shader.getUniformLocation("uBloomTexture"); loc >= 0) glUniform1i(loc, 2);
         if (const GLint loc = m_shader.getUniformLocation("uLensDirtTexture"); loc >= 0) glUniform1i(loc, 3);
         if (const GLint loc = m_shader.getUniformLocation("uVelocityTexture"); loc >= 0) glUniform1i(loc, 4);
+        if (const GLint loc = m_shader.getUniformLocation("uGradingLut"); loc >= 0) glUniform1i(loc, static_cast<GLint>(kGradingLutUnit));
         glUseProgram(0);
     }
 
@@ -1051,6 +1142,85 @@ void CameraEffectsStage::ensureFallbackTextures()
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+CameraEffectsStage::GradingKey CameraEffectsStage::gradingKey(const Settings& settings)
+{
+    GradingKey key;
+    key.colorGradingEnabled = settings.colorGradingEnabled;
+    key.exposure = settings.exposure;
+    key.gamma = settings.gamma;
+    key.contrast = settings.contrast;
+    key.saturation = settings.saturation;
+    key.lift = settings.colorGrade.lift;
+    key.gradeGamma = settings.colorGrade.gamma;
+    key.gain = settings.colorGrade.gain;
+    key.size = settings.gradingLut.size;
+    key.cubePath = settings.gradingLut.cubePath;
+    return key;
+}
+
+void CameraEffectsStage::bakeGradingLutIfNeeded()
+{
+    if (!m_gradingLutDirty || !m_cachedSettingsValid || !m_cachedSettings.gradingLut.enabled)
+        return;
+    m_gradingLutDirty = false;
+
+    const auto start = std::chrono::steady_clock::now();
+    const Settings& settings = m_cachedSettings;
+    const GradingKey key = gradingKey(settings);
+
+    if (key.cubePath != m_cubeLutPath) {
+        m_cubeLutPath = key.cubePath;
+        m_cubeLut = {};
+        m_cubeLutError.clear();
+        if (!key.cubePath.empty()) {
+            if (std::optional<ColorLut3D> lut = loadCubeLut(key.cubePath, m_cubeLutError))
+                m_cubeLut = std::move(*lut);
+        }
+    }
+
+    const int size = key.size;
+    if (m_gradingLut == 0 || m_gradingLutSize != size) {
+        if (m_gradingLut != 0)
+            glDeleteTextures(1, &m_gradingLut);
+        glCreateTextures(GL_TEXTURE_3D, 1, &m_gradingLut);
+        glTextureStorage3D(m_gradingLut, 1, GL_RGBA16F, size, size, size);
+        glTextureParameteri(m_gradingLut, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(m_gradingLut, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(m_gradingLut, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_gradingLut, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_gradingLut, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        m_gradingLutSize = size;
+    }
+
+    // Texel i of each axis holds the graded value of 2^(min + i / (size - 1) * range), matching the
+    // log2 encoding and half-texel offset applied by applyGradingLut().
+    std::vector<float> axis(static_cast<std::size_t>(size));
+    const float step = (kGradingLutMaxLog2 - kGradingLutMinLog2) / static_cast<float>(size - 1);
+    for (int i = 0; i < size; ++i)
+        axis[static_cast<std::size_t>(i)] = std::exp2(kGradingLutMinLog2 + step * static_cast<float>(i));
+
+    const bool applyCube = !m_cubeLut.empty();
+    const auto texelsPerAxis = static_cast<std::size_t>(size);
+    std::vector<glm::vec4> texels(texelsPerAxis * texelsPerAxis * texelsPerAxis);
+    std::size_t index = 0;
+    for (int b = 0; b < size; ++b) {
+        for (int g = 0; g < size; ++g) {
+            for (int r = 0; r < size; ++r) {
+                const glm::vec3 input(axis[static_cast<std::size_t>(r)], axis[static_cast<std::size_t>(g)], axis[static_cast<std::size_t>(b)]);
+                glm::vec3 output = glm::clamp(gradeSceneColor(input, settings), 0.0f, 1.0f);
+                if (applyCube)
+                    output = glm::clamp(m_cubeLut.sample(output), 0.0f, 1.0f);
+                texels[index++] = glm::vec4(output, 1.0f);
+            }
+        }
+    }
+    glTextureSubImage3D(m_gradingLut, 0, 0, 0, 0, size, size, size, GL_RGBA, GL_FLOAT, texels.data());
+
+    m_bakedGradingKey = key;
+    ++m_lutBakes;
+    m_lastLutBakeMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
 void CameraEffectsStage::uploadSettingsIfNeeded()
 {
     if (!m_settingsDirty || m_settingsUbo == 0)
@@ -8,7 +8,13 @@
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
+#include "rendering/ColorLut.h"
+
+#include <array>
+#include <cstdint>
 #include <filesystem>
+#include <optional>
+#include <string>
 #include <vector>
 
 class CameraEffectsStage {
@@ -95,6 +101,14 @@ public:
             float seed { 19.0f };
         } filmGrain;
 
+        // Exposure, gamma, contrast, saturation and lift/gamma/gain are baked into a 3D LUT whenever
+        // they change; the post pass then does a single fetch instead of evaluating the chain.
+        struct GradingLut {
+            bool enabled { true };
+            int size { 32 }; // texels per axis: 32 or 64
+            std::filesystem::path cubePath; // optional colourist .cube, applied after grading in the same bake
+        } gradingLut;
+
         struct Outline {
             bool enabled { false };
             float strength { 1.0f };
@@ -125,6 +139,11 @@ public:
     [[nodiscard]] GLuint velocityTexture() const { return m_velocityTexture; }
     [[nodiscard]] GLuint sceneFramebuffer() const { return m_framebuffer; }
 
+    // Gives the scene depth target a stencil buffer (DEPTH32F_STENCIL8), cleared with the scene, for
+    // diagnostics that count fragments in it. Takes effect at the next beginSceneCapture().
+    void setSceneStencilEnabled(bool enabled) { m_sceneStencil = enabled; }
+    [[nodiscard]] bool sceneStencilEnabled() const { return m_sceneStencilAllocated; }
+
 private:
     static constexpr GLuint kSettingsBinding = 5;
 
@@ -146,6 +165,28 @@ private:
         glm::vec4 grainParams { 0.0f };
         glm::vec4 depthParams { 0.0f };
         glm::vec4 resolutionParams { 0.0f };
+        glm::vec4 lutParams { 0.0f };
+    };
+
+    static constexpr GLuint kGradingLutUnit = 5;
+    // Scene-linear colour is log2-encoded over this range of stops before the LUT fetch.
+    static constexpr float kGradingLutMinLog2 = -12.0f;
+    static constexpr float kGradingLutMaxLog2 = 8.0f;
+
+    // Everything the baked LUT depends on.
+    struct GradingKey {
+        bool colorGradingEnabled { true };
+        float exposure { 0.0f };
+        float gamma { 1.0f };
+        float contrast { 1.0f };
+        float saturation { 1.0f };
+        glm::vec3 lift { 0.0f };
+        glm::vec3 gradeGamma { 1.0f };
+        glm::vec3 gain { 1.0f };
+        int size { 0 };
+        std::filesystem::path cubePath;
+
+        [[nodiscard]] bool operator==(const GradingKey&) const = default;
     };
 
 
@@ -162,6 +203,8 @@ private:
     void ensureUniformBuffer();
     void ensureFallbackTextures();
     void uploadSettingsIfNeeded();
+    [[nodiscard]] static GradingKey gradingKey(const Settings& settings);
+    void bakeGradingLutIfNeeded();
     void drawFullscreenQuad();
 
     std::filesystem::path m_shaderDirectory;
@@ -176,12 +219,15 @@ private:
     GLuint m_framebuffer { 0 };
     GLuint m_sceneColor { 0 };
     GLuint m_sceneDepth { 0 };
+    bool m_sceneStencil { false };
+    bool m_sceneStencilAllocated { false };
     
     // MSAA resources
     GLuint m_msaaFramebuffer { 0 };
     GLuint m_msaaColorRBO { 0 };
     GLuint m_msaaDepthRBO { 0 };
     int m_currentMsaaSamples { 0 };
+    bool m_msaaStencilAllocated { false };
     bool m_msaaEnabled { false };
     GLuint m_velocityTexture { 0 };
     GLuint m_lensDirtTexture { 0 };
@@ -214,4 +260,15 @@ private:
     GpuSettings m_gpuSettings {};
     float m_time { 0.0f };
     Settings m_cachedSettings {};
+
+    GLuint m_gradingLut { 0 };
+    int m_gradingLutSize { 0 };
+    bool m_gradingLutDirty { true };
+    std::optional<GradingKey> m_bakedGradingKey;
+    std::filesystem::path m_cubeLutPath; // last path loaded into m_cubeLut, successfully or not
+    ColorLut3D m_cubeLut;
+    std::string m_cubeLutError;
+    std::array<char, 260> m_cubePathBuffer {};
+    float m_lastLutBakeMs { 0.0f };
+    std::uint32_t m_lutBakes { 0 };
 };
@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: MIT
+#include "rendering/ColorLut.h"
+
+#include <framework/file_provider.h>
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/common.hpp>
+#include <glm/vector_relational.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+constexpr int kMaxCubeSize = 256;
+
+[[nodiscard]] std::string_view trim(std::string_view text)
+{
+    const std::size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos)
+        return {};
+    const std::size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+// Splits on whitespace into at most `count` floats; false unless exactly `count` were read.
+[[nodiscard]] bool parseFloats(std::string_view text, float* values, int count)
+{
+    int parsed = 0;
+    while (!text.empty()) {
+        text = trim(text);
+        if (text.empty())
+            break;
+        if (parsed == count)
+            return false;
+        const std::size_t end = std::min(text.find_first_of(" \t"), text.size());
+        const std::string_view token = text.substr(0, end);
+        const auto result = std::from_chars(token.data(), token.data() + token.size(), values[parsed]);
+        if (result.ec != std::errc() || result.ptr != token.data() + token.size())
+            return false;
+        ++parsed;
+        text.remove_prefix(end);
+    }
+    return parsed == count;
+}
+
+} // namespace
+
+glm::vec3 ColorLut3D::sample(const glm::vec3& color) const
+{
+    const glm::vec3 range = glm::max(domainMax - domainMin, glm::vec3(1e-6f));
+    const glm::vec3 position = glm::clamp((color - domainMin) / range, 0.0f, 1.0f) * static_cast<float>(size - 1);
+    const glm::ivec3 base = glm::min(glm::ivec3(position), glm::ivec3(size - 2));
+    const glm::vec3 t = position - glm::vec3(base);
+
+    const auto texel = [&](int r, int g, int b) -> const glm::vec3& {
+        return texels[static_cast<std::size_t>((b * size + g) * size + r)];
+    };
+    const glm::vec3 c00 = glm::mix(texel(base.x, base.y, base.z), texel(base.x + 1, base.y, base.z), t.x);
+    const glm::vec3 c10 = glm::mix(texel(base.x, base.y + 1, base.z), texel(base.x + 1, base.y + 1, base.z), t.x);
+    const glm::vec3 c01 = glm::mix(texel(base.x, base.y, base.z + 1), texel(base.x + 1, base.y, base.z + 1), t.x);
+    const glm::vec3 c11 = glm::mix(texel(base.x, base.y + 1, base.z + 1), texel(base.x + 1, base.y + 1, base.z + 1), t.x);
+    return glm::mix(glm::mix(c00, c10, t.y), glm::mix(c01, c11, t.y), t.z);
+}
+
+std::optional<ColorLut3D> parseCubeLut(std::string_view text, std::string& error)
+{
+    ColorLut3D lut;
+    std::size_t expected = 0;
+    int lineNumber = 0;
+
+    while (!text.empty()) {
+        const std::size_t newline = std::min(text.find('\n'), text.size());
+        const std::string_view line = trim(text.substr(0, newline));
+        text.remove_prefix(std::min(newline + 1, text.size()));
+        ++lineNumber;
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        const auto fail = [&](const std::string& message) {
+            error = "line " + std::to_string(lineNumber) + ": " + message;
+            return std::nullopt;
+        };
+
+        if (line.starts_with("TITLE")) {
+            std::string_view title = trim(line.substr(5));
+            if (title.size() >= 2 && title.front() == '"' && title.back() == '"')
+                title = title.substr(1, title.size() - 2);
+            lut.title = std::string(title);
+        } else if (line.starts_with("LUT_1D_SIZE")) {
+            return fail("1D LUTs are not supported");
+        } else if (line.starts_with("LUT_3D_SIZE")) {
+            float size = 0.0f;
+            if (!parseFloats(line.substr(11), &size, 1) || size < 2.0f || size > static_cast<float>(kMaxCubeSize) || size != std::floor(size))
+                return fail("invalid LUT_3D_SIZE");
+            lut.size = static_cast<int>(size);
+            const auto texelsPerAxis = static_cast<std::size_t>(lut.size);
+            expected = texelsPerAxis * texelsPerAxis * texelsPerAxis;
+            lut.texels.reserve(expected);
+        } else if (line.starts_with("DOMAIN_MIN")) {
+            if (!parseFloats(line.substr(10), &lut.domainMin.x, 3))
+                return fail("invalid DOMAIN_MIN");
+        } else if (line.starts_with("DOMAIN_MAX")) {
+            if (!parseFloats(line.substr(10), &lut.domainMax.x, 3))
+                return fail("invalid DOMAIN_MAX");
+        } else if (line.starts_with("LUT_3D_INPUT_RANGE")) {
+            float range[2] {};
+            if (!parseFloats(line.substr(18), range, 2))
+                return fail("invalid LUT_3D_INPUT_RANGE");
+            lut.domainMin = glm::vec3(range[0]);
+            lut.domainMax = glm::vec3(range[1]);
+        } else if ((line.front() >= '0' && line.front() <= '9') || line.front() == '-' || line.front() == '.' || line.front() == '+') {
+            if (expected == 0)
+                return fail("table data before LUT_3D_SIZE");
+            glm::vec3 value;
+            if (!parseFloats(line, &value.x, 3))
+                return fail("expected three values");
+            if (lut.texels.size() == expected)
+                return fail("more entries than LUT_3D_SIZE^3");
+            lut.texels.push_back(value);
+        }
+        // Other keywords (e.g. vendor extensions) are ignored, as the format allows.
+    }
+
+    if (expected == 0) {
+        error = "missing LUT_3D_SIZE";
+        return std::nullopt;
+    }
+    if (lut.texels.size() != expected) {
+        error = "expected " + std::to_string(expected) + " entries, found " + std::to_string(lut.texels.size());
+        return std::nullopt;
+    }
+    if (glm::any(glm::lessThanEqual(lut.domainMax, lut.domainMin))) {
+        error = "DOMAIN_MAX must exceed DOMAIN_MIN";
+        return std::nullopt;
+    }
+    return lut;
+}
+
+std::optional<ColorLut3D> loadCubeLut(const std::filesystem::path& path, std::string& error)
+{
+    const std::optional<FileData> file = readFileData(path);
+    if (!file) {
+        error = "cannot read " + path.string();
+        std::cerr << "[ColorLut] " << error << std::endl;
+        return std::nullopt;
+    }
+    std::optional<ColorLut3D> lut = parseCubeLut(file->text(), error);
+    if (!lut) {
+        error = path.filename().string() + ": " + error;
+        std::cerr << "[ColorLut] " << error << std::endl;
+    }
+    return lut;
+}
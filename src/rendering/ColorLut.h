@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/vec3.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A 3D colour lookup table as exchanged with grading tools (Adobe/Resolve .cube). Texels are stored
+// in file order: red varies fastest, then green, then blue.
+struct ColorLut3D {
+    std::string title;
+    int size { 0 };
+    glm::vec3 domainMin { 0.0f };
+    glm::vec3 domainMax { 1.0f };
+    std::vector<glm::vec3> texels;
+
+    [[nodiscard]] bool empty() const { return size < 2 || texels.size() != static_cast<std::size_t>(size) * static_cast<std::size_t>(size) * static_cast<std::size_t>(size); }
+    // Trilinear lookup; inputs outside the domain are clamped to it.
+    [[nodiscard]] glm::vec3 sample(const glm::vec3& color) const;
+};
+
+// Parses a .cube file. Only 3D tables are supported; `error` describes why parsing failed.
+[[nodiscard]] std::optional<ColorLut3D> parseCubeLut(std::string_view text, std::string& error);
+[[nodiscard]] std::optional<ColorLut3D> loadCubeLut(const std::filesystem::path& path, std::string& error);
@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: MIT
+#include "rendering/CrowdRenderer.h"
+
+#include "rendering/RenderStats.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <GLFW/glfw3.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec2.hpp>
+#include <glm/gtc/type_ptr.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+constexpr GLuint kInstanceBinding = 1;
+constexpr GLuint64 kFenceTimeoutNs = 100'000'000;
+
+static_assert(sizeof(PathCrowd::InstanceTransform) == 48, "must match Instance in crowd.vert");
+
+struct AgentVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+// Axis-aligned box with per-face normals; the agent is built from a few of these.
+void appendBox(const glm::vec3& minCorner, const glm::vec3& maxCorner, std::vector<AgentVertex>& vertices, std::vector<std::uint32_t>& indices)
+{
+    const glm::vec3 normals[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+    for (const glm::vec3& n : normals) {
+        // Two axes spanning the face, ordered so the winding is counter-clockwise seen from outside.
+        const glm::vec3 u = glm::abs(n.x) > 0.5f ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0);
+        const glm::vec3 v = glm::cross(n, u);
+        const auto base = static_cast<std::uint32_t>(vertices.size());
+        const glm::vec3 center = (minCorner + maxCorner) * 0.5f;
+        const glm::vec3 half = (maxCorner - minCorner) * 0.5f;
+        for (const glm::vec2 corner : { glm::vec2(-1, -1), glm::vec2(1, -1), glm::vec2(1, 1), glm::vec2(-1, 1) })
+            vertices.push_back({ center + half * (n + u * corner.x + v * corner.y), n });
+        indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+    }
+}
+
+void setUniform(const Shader& shader, const char* name, float value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform1f(loc, value);
+}
+
+void setUniform(const Shader& shader, const char* name, const glm::vec3& value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform3fv(loc, 1, glm::value_ptr(value));
+}
+
+void setUniform(const Shader& shader, const char* name, const glm::mat4& value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+} // namespace
+
+CrowdRenderer::~CrowdRenderer()
+{
+    release();
+}
+
+void CrowdRenderer::initialize()
+{
+    release();
+    try {
+        ShaderBuilder builder;
+        builder.addStage(GL_VERTEX_SHADER, RESOURCE_ROOT "shaders/crowd.vert");
+        builder.addStage(GL_FRAGMENT_SHADER, RESOURCE_ROOT "shaders/crowd.frag");
+        m_shader = builder.build();
+    } catch (const std::exception& e) {
+        std::cerr << "[Crowd] Disabled, shaders failed to build: " << e.what() << std::endl;
+        return;
+    }
+    createAgentMesh();
+    m_ready = true;
+}
+
+void CrowdRenderer::release()
+{
+    if (glfwGetCurrentContext() != nullptr) {
+        destroyInstanceBuffer();
+        if (m_ebo != 0)
+            glDeleteBuffers(1, &m_ebo);
+        if (m_vbo != 0)
+            glDeleteBuffers(1, &m_vbo);
+        if (m_vao != 0)
+            glDeleteVertexArrays(1, &m_vao);
+    }
+    m_ebo = 0;
+    m_vbo = 0;
+    m_vao = 0;
+    m_indexCount = 0;
+    m_instanceBuffer = 0;
+    m_mapped = nullptr;
+    m_capacity = 0;
+    m_fences = {};
+    m_ready = false;
+}
+
+void CrowdRenderer::createAgentMesh()
+{
+    // Body, head and a nose on the +z side so the heading reads from a distance.
+    std::vector<AgentVertex> vertices;
+    std::vector<std::uint32_t> indices;
+    appendBox({ -0.22f, 0.0f, -0.14f }, { 0.22f, 1.35f, 0.14f }, vertices, indices);
+    appendBox({ -0.13f, 1.4f, -0.12f }, { 0.13f, 1.7f, 0.14f }, vertices, indices);
+    appendBox({ -0.05f, 1.5f, 0.14f }, { 0.05f, 1.58f, 0.24f }, vertices, indices);
+    m_indexCount = static_cast<GLsizei>(indices.size());
+
+    glCreateBuffers(1, &m_vbo);
+    glNamedBufferStorage(m_vbo, static_cast<GLsizeiptr>(vertices.size() * sizeof(AgentVertex)), vertices.data(), 0);
+    glCreateBuffers(1, &m_ebo);
+    glNamedBufferStorage(m_ebo, static_cast<GLsizeiptr>(indices.size() * sizeof(std::uint32_t)), indices.data(), 0);
+
+    glCreateVertexArrays(1, &m_vao);
+    glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, sizeof(AgentVertex));
+    glVertexArrayElementBuffer(m_vao, m_ebo);
+    glEnableVertexArrayAttrib(m_vao, 0);
+    glVertexArrayAttribFormat(m_vao, 0, 3, GL_FLOAT, GL_FALSE, offsetof(AgentVertex, position));
+    glVertexArrayAttribBinding(m_vao, 0, 0);
+    glEnableVertexArrayAttrib(m_vao, 1);
+    glVertexArrayAttribFormat(m_vao, 1, 3, GL_FLOAT, GL_FALSE, offsetof(AgentVertex, normal));
+    glVertexArrayAttribBinding(m_vao, 1, 0);
+}
+
+void CrowdRenderer::ensureCapacity(std::size_t count)
+{
+    if (count <= m_capacity && m_instanceBuffer != 0)
+        return;
+
+    destroyInstanceBuffer();
+
+    GLint alignment = 256;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    const auto align = static_cast<std::size_t>(std::max(alignment, 16));
+    const std::size_t capacity = std::max<std::size_t>(count + count / 4, 1024);
+    m_segmentStride = (capacity * sizeof(PathCrowd::InstanceTransform) + align - 1) / align * align;
+
+    const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const auto size = static_cast<GLsizeiptr>(m_segmentStride * kSegments);
+    glCreateBuffers(1, &m_instanceBuffer);
+    glNamedBufferStorage(m_instanceBuffer, size, nullptr, mapFlags);
+    m_mapped = static_cast<PathCrowd::InstanceTransform*>(glMapNamedBufferRange(m_instanceBuffer, 0, size, mapFlags));
+    if (m_mapped == nullptr) {
+        std::cerr << "[Crowd] Failed to map the instance buffer (" << capacity << " agents)" << std::endl;
+        destroyInstanceBuffer();
+        return;
+    }
+    m_capacity = capacity;
+    m_segment = 0;
+}
+
+void CrowdRenderer::destroyInstanceBuffer()
+{
+    for (GLsync& fence : m_fences) {
+        if (fence != nullptr) {
+            glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeoutNs);
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (m_instanceBuffer != 0) {
+        if (m_mapped != nullptr)
+            glUnmapNamedBuffer(m_instanceBuffer);
+        glDeleteBuffers(1, &m_instanceBuffer);
+    }
+    m_instanceBuffer = 0;
+    m_mapped = nullptr;
+    m_capacity = 0;
+}
+
+PathCrowd::InstanceTransform* CrowdRenderer::map(std::size_t count)
+{
+    m_mappedCount = 0;
+    if (!m_ready || count == 0)
+        return nullptr;
+    ensureCapacity(count);
+    if (m_mapped == nullptr)
+        return nullptr;
+
+    // The segment written now may still be read by a frame the GPU has not finished.
+    GLsync& fence = m_fences[m_segment];
+    if (fence != nullptr) {
+        if (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeoutNs) == GL_WAIT_FAILED)
+            std::cerr << "[Crowd] Waiting on instance segment fence failed" << std::endl;
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    m_mappedCount = count;
+    return reinterpret_cast<PathCrowd::InstanceTransform*>(reinterpret_cast<std::byte*>(m_mapped) + m_segment * m_segmentStride);
+}
+
+void CrowdRenderer::draw(const DrawParams& params, RenderStats* stats)
+{
+    if (m_mappedCount == 0)
+        return;
+
+    m_shader.bind();
+    setUniform(m_shader, "view", params.view);
+    setUniform(m_shader, "projection", params.projection);
+    setUniform(m_shader, "lightPos", params.lightPos);
+    setUniform(m_shader, "lightColor", params.lightColor);
+    setUniform(m_shader, "ambientColor", params.ambientColor);
+    setUniform(m_shader, "ambientStrength", params.ambientStrength);
+
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, kInstanceBinding, m_instanceBuffer,
+        static_cast<GLintptr>(m_segment * m_segmentStride),
+        static_cast<GLsizeiptr>(m_mappedCount * sizeof(PathCrowd::InstanceTransform)));
+    glBindVertexArray(m_vao);
+    glDrawElementsInstanced(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(m_mappedCount));
+    glBindVertexArray(0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kInstanceBinding, 0);
+
+    m_fences[m_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_segment = (m_segment + 1) % kSegments;
+
+    if (stats)
+        stats->addDraw(1, m_mappedCount * static_cast<std::uint64_t>(m_indexCount / 3));
+    m_mappedCount = 0;
+}
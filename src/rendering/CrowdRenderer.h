@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "util/PathCrowd.h"
+
+#include <framework/opengl_includes.h>
+#include <framework/shader.h>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <cstddef>
+
+struct RenderStats;
+
+// Draws a PathCrowd as one instanced draw of a low-poly agent. Instance transforms live in a
+// persistently mapped shader storage buffer split into kSegments segments: each frame PathCrowd
+// writes straight into the next segment (after its fence says the GPU is done with it) and the
+// vertex shader reads that range, so there is no staging copy or glBufferSubData.
+class CrowdRenderer {
+public:
+    static constexpr std::size_t kSegments = 3;
+
+    struct DrawParams {
+        glm::mat4 view { 1.0f };
+        glm::mat4 projection { 1.0f };
+        glm::vec3 lightPos { 0.0f };
+        glm::vec3 lightColor { 1.0f };
+        glm::vec3 ambientColor { 1.0f };
+        float ambientStrength { 0.1f };
+    };
+
+    CrowdRenderer() = default;
+    ~CrowdRenderer();
+    CrowdRenderer(const CrowdRenderer&) = delete;
+    CrowdRenderer& operator=(const CrowdRenderer&) = delete;
+
+    void initialize();
+    void release();
+
+    // Storage for `count` transforms in the next segment, valid until draw(); null when unavailable.
+    [[nodiscard]] PathCrowd::InstanceTransform* map(std::size_t count);
+    // Draws the transforms written since map().
+    void draw(const DrawParams& params, RenderStats* stats = nullptr);
+
+private:
+    void createAgentMesh();
+    void ensureCapacity(std::size_t count);
+    void destroyInstanceBuffer();
+
+    bool m_ready { false };
+    Shader m_shader;
+
+    GLuint m_vao { 0 };
+    GLuint m_vbo { 0 };
+    GLuint m_ebo { 0 };
+    GLsizei m_indexCount { 0 };
+
+    GLuint m_instanceBuffer { 0 };
+    PathCrowd::InstanceTransform* m_mapped { nullptr };
+    std::size_t m_capacity { 0 }; // transforms per segment
+    std::size_t m_segmentStride { 0 }; // bytes, padded to the SSBO offset alignment
+    std::array<GLsync, kSegments> m_fences {};
+    std::size_t m_segment { 0 };
+    std::size_t m_mappedCount { 0 };
+};
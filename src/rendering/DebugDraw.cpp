@@ -0,0 +1,411 @@
+// SPDX-License-Identifier: MIT
+#include "rendering/DebugDraw.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glad/glad.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/matrix.hpp>
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+constexpr std::size_t kMinInstanceCapacity = 4096;
+
+// Corner i has x from bit 0, y from bit 1 and z from bit 2 (0 = min, 1 = max).
+constexpr std::array<std::pair<int, int>, 12> kBoxEdges { {
+    { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+    { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+    { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+} };
+
+constexpr std::array<float, 24> kCubeVertices {
+    -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f,
+    -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f
+};
+
+// Drawn without face culling, so winding does not matter.
+constexpr std::array<GLuint, 36> kCubeIndices {
+    0, 2, 1, 1, 2, 3, // -z
+    4, 5, 6, 5, 7, 6, // +z
+    0, 4, 2, 2, 4, 6, // -x
+    1, 3, 5, 3, 7, 5, // +x
+    0, 1, 4, 1, 5, 4, // -y
+    2, 6, 3, 3, 6, 7 // +y
+};
+
+[[nodiscard]] glm::vec3 corner(const glm::vec3& boundsMin, const glm::vec3& boundsMax, int index)
+{
+    return glm::vec3((index & 1) ? boundsMax.x : boundsMin.x,
+        (index & 2) ? boundsMax.y : boundsMin.y,
+        (index & 4) ? boundsMax.z : boundsMin.z);
+}
+
+class ScopedCapability {
+public:
+    ScopedCapability(GLenum capability, bool enable)
+        : m_capability(capability)
+        , m_wasEnabled(glIsEnabled(capability) == GL_TRUE)
+    {
+        if (enable)
+            glEnable(capability);
+        else
+            glDisable(capability);
+    }
+    ~ScopedCapability()
+    {
+        if (m_wasEnabled)
+            glEnable(m_capability);
+        else
+            glDisable(m_capability);
+    }
+
+private:
+    GLenum m_capability;
+    bool m_wasEnabled;
+};
+
+} // namespace
+
+DebugDraw::~DebugDraw()
+{
+    shutdown();
+}
+
+void DebugDraw::initialize(const std::filesystem::path& shaderDirectory)
+{
+    m_shaderDirectory = shaderDirectory;
+    ensureResources();
+}
+
+void DebugDraw::shutdown()
+{
+    if (m_vao != 0)
+        glDeleteVertexArrays(1, &m_vao);
+    if (m_cubeVertexBuffer != 0)
+        glDeleteBuffers(1, &m_cubeVertexBuffer);
+    if (m_cubeIndexBuffer != 0)
+        glDeleteBuffers(1, &m_cubeIndexBuffer);
+    if (m_instanceBuffer != 0)
+        glDeleteBuffers(1, &m_instanceBuffer);
+    m_vao = m_cubeVertexBuffer = m_cubeIndexBuffer = m_instanceBuffer = 0;
+    m_instanceCapacity = 0;
+    m_shader = Shader();
+}
+
+void DebugDraw::ensureResources()
+{
+    if (m_shader.id() == std::numeric_limits<GLuint>::max()) {
+        ShaderBuilder builder;
+        builder.addStage(GL_VERTEX_SHADER, m_shaderDirectory / "debug_draw.vert");
+        builder.addStage(GL_FRAGMENT_SHADER, m_shaderDirectory / "debug_draw.frag");
+        m_shader = builder.build();
+        m_viewProjectionLocation = m_shader.getUniformLocation("uViewProjection");
+        m_solidLocation = m_shader.getUniformLocation("uSolid");
+    }
+    if (m_vao != 0)
+        return;
+
+    glCreateBuffers(1, &m_cubeVertexBuffer);
+    glNamedBufferStorage(m_cubeVertexBuffer, sizeof(kCubeVertices), kCubeVertices.data(), 0);
+    glCreateBuffers(1, &m_cubeIndexBuffer);
+    glNamedBufferStorage(m_cubeIndexBuffer, sizeof(kCubeIndices), kCubeIndices.data(), 0);
+    glCreateBuffers(1, &m_instanceBuffer);
+
+    glCreateVertexArrays(1, &m_vao);
+    glVertexArrayVertexBuffer(m_vao, 0, m_cubeVertexBuffer, 0, sizeof(float) * 3);
+    glVertexArrayElementBuffer(m_vao, m_cubeIndexBuffer);
+    glEnableVertexArrayAttrib(m_vao, 0);
+    glVertexArrayAttribFormat(m_vao, 0, 3, GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribBinding(m_vao, 0, 0);
+
+    // The instance buffer is attached on first upload; binding 1 advances once per instance.
+    glVertexArrayBindingDivisor(m_vao, 1, 1);
+    const auto instanceAttribute = [&](GLuint location, GLint size, GLenum type, GLboolean normalized, GLuint offset) {
+        glEnableVertexArrayAttrib(m_vao, location);
+        glVertexArrayAttribFormat(m_vao, location, size, type, normalized, offset);
+        glVertexArrayAttribBinding(m_vao, location, 1);
+    };
+    instanceAttribute(1, 3, GL_FLOAT, GL_FALSE, offsetof(Instance, a));
+    instanceAttribute(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Instance, colorA));
+    instanceAttribute(3, 3, GL_FLOAT, GL_FALSE, offsetof(Instance, b));
+    instanceAttribute(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(Instance, colorB));
+}
+
+std::uint32_t DebugDraw::packColor(const glm::vec4& color)
+{
+    const glm::vec4 clamped = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+    return static_cast<std::uint32_t>(clamped.r)
+        | (static_cast<std::uint32_t>(clamped.g) << 8)
+        | (static_cast<std::uint32_t>(clamped.b) << 16)
+        | (static_cast<std::uint32_t>(clamped.a) << 24);
+}
+
+// Caller holds m_mutex.
+void DebugDraw::pushLine(const glm::vec3& from, const glm::vec3& to, std::uint32_t color, Layer layer)
+{
+    Instance instance;
+    instance.a = from;
+    instance.colorA = color;
+    instance.b = to;
+    instance.colorB = color;
+    m_streams.lines[static_cast<std::size_t>(layer)].push_back(instance);
+}
+
+void DebugDraw::line(const glm::vec3& from, const glm::vec3& to, const glm::vec4& color, Layer layer)
+{
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return;
+    const std::uint32_t packed = packColor(color);
+    std::lock_guard lock(m_mutex);
+    pushLine(from, to, packed, layer);
+}
+
+void DebugDraw::polyline(const std::vector<glm::vec3>& points, const glm::vec4& color, Layer layer)
+{
+    if (!m_enabled.load(std::memory_order_relaxed) || points.size() < 2)
+        return;
+    const std::uint32_t packed = packColor(color);
+    std::lock_guard lock(m_mutex);
+    for (std::size_t i = 1; i < points.size(); ++i)
+        pushLine(points[i - 1], points[i], packed, layer);
+}
+
+void DebugDraw::lineList(const std::vector<glm::vec3>& endpoints, const glm::vec4& color, Layer layer)
+{
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return;
+    const std::uint32_t packed = packColor(color);
+    std::lock_guard lock(m_mutex);
+    for (std::size_t i = 0; i + 1 < endpoints.size(); i += 2)
+        pushLine(endpoints[i], endpoints[i + 1], packed, layer);
+}
+
+void DebugDraw::box(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::vec4& color, Layer layer)
+{
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return;
+    const std::uint32_t packed = packColor(color);
+    std::lock_guard lock(m_mutex);
+    for (const auto& [from, to] : kBoxEdges)
+        pushLine(corner(boundsMin, boundsMax, from), corner(boundsMin, boundsMax, to), packed, layer);
+}
+
+void DebugDraw::box(const glm::mat4& transform, const glm::vec4& color, Layer layer)
+{
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return;
+    std::array<glm::vec3, 8> corners;
+    for (int i = 0; i < 8; ++i)
+        corners[static_cast<std::size_t>(i)] = glm::vec3(transform * glm::vec4(corner(glm::vec3(-1.0f), glm::vec3(1.0f), i), 1.0f));
+    const std::uint32_t packed = packColor(color);
+    std::lock_guard lock(m_mutex);
+    for (const auto& [from, to] : kBoxEdges)
+        pushLine(corners[static_cast<std::size_t>(from)], corners[static_cast<std::size_t>(to)], packed, layer);
+}
+
+void DebugDraw::solidBox(const glm::vec3& center, const glm::vec3& halfExtent, const glm::vec4& color, Layer layer)
+{
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return;
+    Instance instance;
+    instance.a = center;
+    instance.b = halfExtent;
+    instance.colorA = packColor(color);
+    instance.colorB = instance.colorA;
+    std::lock_guard lock(m_mutex);
+    m_streams.solids[static_cast<std::size_t>(layer)].push_back(instance);
+}
+
+void DebugDraw::sphere(const glm::vec3& center, float radius, const glm::vec4& color, Layer layer, int segments)
+{
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return;
+    segments = std::clamp(segments, 4, 128);
+    std::array<glm::vec2, 129> circle;
+    for (int i = 0; i <= segments; ++i) {
+        const float angle = glm::two_pi<float>() * static_cast<float>(i) / static_cast<float>(segments);
+        circle[static_cast<std::size_t>(i)] = glm::vec2(std::cos(angle), std::sin(angle)) * radius;
+    }
+
+    const std::uint32_t packed = packColor(color);
+    std::lock_guard lock(m_mutex);
+    for (std::size_t i = 1; i <= static_cast<std::size_t>(segments); ++i) {
+        const glm::vec2 p = circle[i - 1];
+        const glm::vec2 q = circle[i];
+        pushLine(center + glm::vec3(p.x, p.y, 0.0f), center + glm::vec3(q.x, q.y, 0.0f), packed, layer);
+        pushLine(center + glm::vec3(p.x, 0.0f, p.y), center + glm::vec3(q.x, 0.0f, q.y), packed, layer);
+        pushLine(center + glm::vec3(0.0f, p.x, p.y), center + glm::vec3(0.0f, q.x, q.y), packed, layer);
+    }
+}
+
+void DebugDraw::frustum(const glm::mat4& viewProjection, const glm::vec4& color, Layer layer)
+{
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return;
+    const glm::mat4 inverse = glm::inverse(viewProjection);
+    std::array<glm::vec3, 8> corners;
+    for (int i = 0; i < 8; ++i) {
+        const glm::vec4 world = inverse * glm::vec4(corner(glm::vec3(-1.0f), glm::vec3(1.0f), i), 1.0f);
+        corners[static_cast<std::size_t>(i)] = glm::vec3(world) / world.w;
+    }
+    const std::uint32_t packed = packColor(color);
+    std::lock_guard lock(m_mutex);
+    for (const auto& [from, to] : kBoxEdges)
+        pushLine(corners[static_cast<std::size_t>(from)], corners[static_cast<std::size_t>(to)], packed, layer);
+}
+
+void DebugDraw::arrow(const glm::vec3& from, const glm::vec3& to, const glm::vec4& color, float headSize, Layer layer)
+{
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return;
+    const glm::vec3 shaft = to - from;
+    const float length = glm::length(shaft);
+    if (length <= 1e-6f)
+        return;
+
+    const glm::vec3 direction = shaft / length;
+    const glm::vec3 helper = std::abs(direction.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+    const glm::vec3 side = glm::normalize(glm::cross(direction, helper));
+    const glm::vec3 up = glm::cross(side, direction);
+    const float head = std::min(headSize, length * 0.5f);
+    const glm::vec3 base = to - direction * head;
+
+    const std::uint32_t packed = packColor(color);
+    std::lock_guard lock(m_mutex);
+    pushLine(from, to, packed, layer);
+    pushLine(to, base + side * head * 0.5f, packed, layer);
+    pushLine(to, base - side * head * 0.5f, packed, layer);
+    pushLine(to, base + up * head * 0.5f, packed, layer);
+    pushLine(to, base - up * head * 0.5f, packed, layer);
+}
+
+void DebugDraw::text(const glm::vec3& anchor, std::string label, const glm::vec4& color)
+{
+    if (!m_enabled.load(std::memory_order_relaxed) || label.empty())
+        return;
+    Text entry;
+    entry.anchor = anchor;
+    entry.color = packColor(color);
+    entry.label = std::move(label);
+    std::lock_guard lock(m_mutex);
+    m_texts.push_back(std::move(entry));
+}
+
+void DebugDraw::renderDepthTested(const glm::mat4& viewProjection, RenderStats* stats)
+{
+    renderLayer(Layer::DepthTested, viewProjection, stats);
+}
+
+void DebugDraw::renderOverlay(const glm::mat4& viewProjection, const glm::vec2& displaySize)
+{
+    renderLayer(Layer::Overlay, viewProjection, nullptr);
+
+    std::vector<Text> texts;
+    {
+        std::lock_guard lock(m_mutex);
+        texts.swap(m_texts);
+    }
+    m_frameStats.texts = texts.size();
+    if (!texts.empty() && displaySize.x > 0.0f && displaySize.y > 0.0f) {
+        ImDrawList* drawList = ImGui::GetForegroundDrawList();
+        for (const Text& entry : texts) {
+            const glm::vec4 clip = viewProjection * glm::vec4(entry.anchor, 1.0f);
+            if (clip.w <= 0.0f)
+                continue;
+            const glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            const ImVec2 screen((ndc.x * 0.5f + 0.5f) * displaySize.x, (0.5f - ndc.y * 0.5f) * displaySize.y);
+            drawList->AddText(screen, static_cast<ImU32>(entry.color), entry.label.c_str());
+        }
+    }
+
+    m_lastStats = m_frameStats;
+    m_frameStats = {};
+}
+
+void DebugDraw::renderLayer(Layer layer, const glm::mat4& viewProjection, RenderStats* stats)
+{
+    const auto index = static_cast<std::size_t>(layer);
+    std::size_t lineCount = 0;
+    std::size_t solidCount = 0;
+    {
+        std::lock_guard lock(m_mutex);
+        std::vector<Instance>& lines = m_streams.lines[index];
+        std::vector<Instance>& solids = m_streams.solids[index];
+        lineCount = lines.size();
+        solidCount = solids.size();
+        m_upload.assign(lines.begin(), lines.end());
+        m_upload.insert(m_upload.end(), solids.begin(), solids.end());
+        lines.clear();
+        solids.clear();
+    }
+    m_frameStats.lines += lineCount;
+    m_frameStats.solids += solidCount;
+    if (m_upload.empty() || m_vao == 0)
+        return;
+
+    // Orphan and refill: the previous layer's draws may still be reading the old storage.
+    const std::size_t bytes = m_upload.size() * sizeof(Instance);
+    if (m_upload.size() > m_instanceCapacity)
+        m_instanceCapacity = std::max(kMinInstanceCapacity, m_upload.size() + m_upload.size() / 2);
+    glNamedBufferData(m_instanceBuffer, static_cast<GLsizeiptr>(m_instanceCapacity * sizeof(Instance)), nullptr, GL_STREAM_DRAW);
+    glNamedBufferSubData(m_instanceBuffer, 0, static_cast<GLsizeiptr>(bytes), m_upload.data());
+    glVertexArrayVertexBuffer(m_vao, 1, m_instanceBuffer, 0, sizeof(Instance));
+    m_frameStats.uploadedBytes += bytes;
+
+    const bool overlay = layer == Layer::Overlay;
+    const ScopedCapability depthTest(GL_DEPTH_TEST, !overlay);
+    const ScopedCapability blend(GL_BLEND, true);
+    const ScopedCapability cull(GL_CULL_FACE, false);
+    GLboolean depthMask = GL_TRUE;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_shader.bind();
+    glUniformMatrix4fv(m_viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+    glBindVertexArray(m_vao);
+
+    std::size_t drawCalls = 0;
+    if (lineCount > 0) {
+        glDepthMask(GL_FALSE);
+        glUniform1i(m_solidLocation, 0);
+        glDrawArraysInstancedBaseInstance(GL_LINES, 0, 2, static_cast<GLsizei>(lineCount), 0);
+        ++drawCalls;
+    }
+    if (solidCount > 0) {
+        glDepthMask(overlay ? GL_FALSE : GL_TRUE);
+        glUniform1i(m_solidLocation, 1);
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, static_cast<GLsizei>(kCubeIndices.size()), GL_UNSIGNED_INT, nullptr,
+            static_cast<GLsizei>(solidCount), static_cast<GLuint>(lineCount));
+        ++drawCalls;
+    }
+
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glDepthMask(depthMask);
+
+    m_frameStats.drawCalls += drawCalls;
+    if (stats)
+        stats->addDraw(drawCalls, solidCount * 12);
+}
+
+void DebugDraw::drawImGuiPanel()
+{
+    bool enabled = m_enabled.load(std::memory_order_relaxed);
+    if (ImGui::Checkbox("Enable debug drawing", &enabled))
+        m_enabled.store(enabled, std::memory_order_relaxed);
+    const Stats& stats = m_lastStats;
+    ImGui::Text("Last frame: %zu lines, %zu boxes, %zu labels", stats.lines, stats.solids, stats.texts);
+    ImGui::Text("Draw calls: %zu | uploaded %.1f KB", stats.drawCalls, static_cast<double>(stats.uploadedBytes) / 1024.0);
+}
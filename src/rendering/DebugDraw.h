@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "rendering/RenderStats.h"
+
+#include <framework/shader.h>
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Immediate-mode debug drawing. Lines, boxes, spheres, frustums and arrows may be submitted from any
+// thread during the frame; they are expanded into per-frame instance streams (one instance per line
+// segment or solid box) and drawn with one instanced line draw and one instanced box draw per layer.
+// The depth-tested layer is drawn into the scene and its colours are linear; the overlay layer is
+// drawn on top of the final image and its colours are display-referred, like ImGui's. Text anchors
+// are projected into ImGui's foreground draw list. Everything submitted is cleared after the overlay
+// has been rendered.
+class DebugDraw {
+public:
+    enum class Layer {
+        DepthTested = 0,
+        Overlay = 1
+    };
+
+    struct Stats {
+        std::size_t lines { 0 };
+        std::size_t solids { 0 };
+        std::size_t texts { 0 };
+        std::size_t drawCalls { 0 };
+        std::size_t uploadedBytes { 0 };
+    };
+
+    DebugDraw() = default;
+    ~DebugDraw();
+
+    DebugDraw(const DebugDraw&) = delete;
+    DebugDraw& operator=(const DebugDraw&) = delete;
+
+    void initialize(const std::filesystem::path& shaderDirectory);
+    void shutdown();
+
+    // Submission; thread safe. Colours are RGBA.
+    void line(const glm::vec3& from, const glm::vec3& to, const glm::vec4& color, Layer layer = Layer::DepthTested);
+    void polyline(const std::vector<glm::vec3>& points, const glm::vec4& color, Layer layer = Layer::DepthTested);
+    // Independent segments: points [0,1], [2,3], ...
+    void lineList(const std::vector<glm::vec3>& endpoints, const glm::vec4& color, Layer layer = Layer::DepthTested);
+    void box(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::vec4& color, Layer layer = Layer::DepthTested);
+    // Oriented box: the unit cube [-1, 1]^3 transformed by `transform`.
+    void box(const glm::mat4& transform, const glm::vec4& color, Layer layer = Layer::DepthTested);
+    void solidBox(const glm::vec3& center, const glm::vec3& halfExtent, const glm::vec4& color, Layer layer = Layer::DepthTested);
+    // Three great circles.
+    void sphere(const glm::vec3& center, float radius, const glm::vec4& color, Layer layer = Layer::DepthTested, int segments = 24);
+    // Edges of the view volume of `viewProjection` (OpenGL clip space).
+    void frustum(const glm::mat4& viewProjection, const glm::vec4& color, Layer layer = Layer::DepthTested);
+    void arrow(const glm::vec3& from, const glm::vec3& to, const glm::vec4& color, float headSize = 0.1f, Layer layer = Layer::DepthTested);
+    // Drawn over everything regardless of layer; anchors behind the camera are skipped.
+    void text(const glm::vec3& anchor, std::string label, const glm::vec4& color);
+
+    // Renders the depth-tested layer into the currently bound scene framebuffer.
+    void renderDepthTested(const glm::mat4& viewProjection, RenderStats* stats = nullptr);
+    // Renders the overlay layer and the text anchors, then clears everything submitted this frame.
+    void renderOverlay(const glm::mat4& viewProjection, const glm::vec2& displaySize);
+
+    [[nodiscard]] const Stats& stats() const { return m_lastStats; }
+    void drawImGuiPanel();
+
+private:
+    // Lines store both endpoints; solid boxes store centre and half extent in `a` / `b`.
+    struct Instance {
+        glm::vec3 a { 0.0f };
+        std::uint32_t colorA { 0 };
+        glm::vec3 b { 0.0f };
+        std::uint32_t colorB { 0 };
+    };
+    static_assert(sizeof(Instance) == 32);
+
+    struct Text {
+        glm::vec3 anchor { 0.0f };
+        std::uint32_t color { 0 };
+        std::string label;
+    };
+
+    struct Streams {
+        std::vector<Instance> lines[2];
+        std::vector<Instance> solids[2];
+    };
+
+    [[nodiscard]] static std::uint32_t packColor(const glm::vec4& color);
+    void pushLine(const glm::vec3& from, const glm::vec3& to, std::uint32_t color, Layer layer);
+    void ensureResources();
+    void renderLayer(Layer layer, const glm::mat4& viewProjection, RenderStats* stats);
+
+    std::filesystem::path m_shaderDirectory;
+    Shader m_shader;
+    GLint m_viewProjectionLocation { -1 };
+    GLint m_solidLocation { -1 };
+    GLuint m_vao { 0 };
+    GLuint m_cubeVertexBuffer { 0 };
+    GLuint m_cubeIndexBuffer { 0 };
+    GLuint m_instanceBuffer { 0 };
+    std::size_t m_instanceCapacity { 0 };
+
+    std::mutex m_mutex;
+    Streams m_streams;
+    std::vector<Text> m_texts;
+    std::vector<Instance> m_upload; // scratch, reused across frames
+
+    std::atomic<bool> m_enabled { true };
+    Stats m_frameStats;
+    Stats m_lastStats;
+};
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: MIT
 
 #include "rendering/EnvironmentManager.h"
+#include "io/AssetDatabase.h"
+#include "rendering/PixelOps.h"
 #include "rendering/TextureUnits.h"
 
 #include <framework/disable_all_warnings.h>
@@ -10,12 +12,14 @@ DISABLE_WARNINGS_PUSH()
 #include <stb/stb_image.h>
 DISABLE_WARNINGS_POP()
 
+#include <framework/file_provider.h>
 #include <framework/opengl_includes.h>
 
 #include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
+#include <cstdint>
 #include <initializer_list>
 #include <stdexcept>
 #include <iostream>
@@ -140,9 +144,12 @@ const std::array<glm::mat4, 6> kCaptureViews {
 
 const glm::mat4 kCaptureProjection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
 
-std::string buildCacheKey(const std::filesystem::path& path, const EnvironmentManager::AdvancedSettings& settings)
+// Bump when the bake output changes so recorded "ibl" artifacts are treated as stale.
+constexpr std::uint32_t kIblBakeVersion = 1;
+
+std::string buildSettingsKey(const EnvironmentManager::AdvancedSettings& settings)
 {
-    std::string key = path.string();
+    std::string key;
     key += "|env=" + std::to_string(settings.environmentResolution);
     key += "|irr=" + std::to_string(settings.irradianceResolution);
     key += "|pref=" + std::to_string(settings.prefilterBaseResolution);
@@ -150,6 +157,20 @@ std::string buildCacheKey(const std::filesystem::path& path, const EnvironmentMa
     return key;
 }
 
+std::string buildCacheKey(const std::filesystem::path& path, const EnvironmentManager::AdvancedSettings& settings)
+{
+    return path.string() + buildSettingsKey(settings);
+}
+
+AssetDatabase::ArtifactKey iblArtifactKey(const std::filesystem::path& path, const EnvironmentManager::AdvancedSettings& settings)
+{
+    AssetDatabase::ArtifactKey key;
+    key.kind = "ibl";
+    key.source = path;
+    key.settingsHash = AssetDatabase::hashSettings(buildSettingsKey(settings));
+    return key;
+}
+
 Shader compileShader(const std::filesystem::path& vertexPath, const std::filesystem::path& fragmentPath)
 {
     ShaderBuilder builder;
@@ -301,15 +322,44 @@ bool EnvironmentManager::loadEnvironment(const std::filesystem::path& path)
     if (!m_isInitialized)
         initializeGL();
 
-    auto baked = bakeEnvironment(path);
-    if (!baked)
+    const std::optional<FileData> file = readFileData(path);
+    if (!file) {
+        std::cerr << "[EnvManager] Failed to read HDR environment: " << path << "\n";
         return false;
+    }
+
+    // A bake that is still alive under the same key (same content and settings) is reused as is.
+    const std::string cacheKey = createCacheKey(path, *file);
+    std::shared_ptr<EnvironmentTextures> baked;
+    if (const auto cached = m_cache.find(cacheKey); cached != m_cache.end())
+        baked = cached->second.lock();
+    if (!baked) {
+        baked = bakeEnvironment(path, *file);
+        if (!baked)
+            return false;
+        std::erase_if(m_cache, [](const auto& entry) { return entry.second.expired(); });
+        m_cache[cacheKey] = baked;
+    }
+    if (m_assetDatabase)
+        m_assetDatabase->recordArtifact(iblArtifactKey(path, m_settings), {});
 
     m_currentEnvironment = std::move(baked);
     m_currentPath = path;
     return true;
 }
 
+void EnvironmentManager::setAssetDatabase(AssetDatabase* database)
+{
+    m_assetDatabase = database;
+    if (m_assetDatabase)
+        m_assetDatabase->registerImporter("ibl", kIblBakeVersion);
+}
+
+bool EnvironmentManager::environmentSourceChanged() const
+{
+    return m_assetDatabase && m_currentEnvironment && !m_assetDatabase->isValid(iblArtifactKey(m_currentPath, m_settings));
+}
+
 
 void EnvironmentManager::unload()
 {
@@ -494,8 +544,13 @@ void EnvironmentManager::bindForPbr(const Shader& shader, int /*firstTextureUnit
     }
 }
 
-std::string EnvironmentManager::createCacheKey(const std::filesystem::path& path) const
+std::string EnvironmentManager::createCacheKey(const std::filesystem::path& path, const FileData& file) const
 {
+    // Content keyed when possible: an edited HDR under the same path must not hit the old bake.
+    if (m_assetDatabase) {
+        if (std::optional<std::string> key = m_assetDatabase->contentKey(iblArtifactKey(path, m_settings), &file))
+            return *key;
+    }
     return buildCacheKey(path, m_settings);
 }
 
@@ -611,9 +666,9 @@ void EnvironmentManager::renderFullscreenQuad() const
     glBindVertexArray(0);
 }
 
-std::shared_ptr<EnvironmentManager::EnvironmentTextures> EnvironmentManager::bakeEnvironment(const std::filesystem::path& path)
+std::shared_ptr<EnvironmentManager::EnvironmentTextures> EnvironmentManager::bakeEnvironment(const std::filesystem::path& path, const FileData& file)
 {
-    GLuint hdrTexture = loadHdrTexture(path);
+    GLuint hdrTexture = loadHdrTexture(path, file);
     if (hdrTexture == 0)
         return nullptr;
 
@@ -634,12 +689,12 @@ std::shared_ptr<EnvironmentManager::EnvironmentTextures> EnvironmentManager::bak
     return textures;
 }
 
-GLuint EnvironmentManager::loadHdrTexture(const std::filesystem::path& path)
+GLuint EnvironmentManager::loadHdrTexture(const std::filesystem::path& path, const FileData& file)
 {
     stbi_set_flip_vertically_on_load(true);
 
     int width=0, height=0, components=0;
-    float* data = stbi_loadf(path.string().c_str(), &width, &height, &components, 3);
+    float* data = stbi_loadf_from_memory(file.bytes(), static_cast<int>(file.size()), &width, &height, &components, 3);
     if (!data) {
         std::cerr << "[EnvManager] Failed to load HDR environment: " << path << "\n";
         stbi_set_flip_vertically_on_load(false);
@@ -652,7 +707,15 @@ GLuint EnvironmentManager::loadHdrTexture(const std::filesystem::path& path)
     GLint prevUnpack = 0; glGetIntegerv(GL_UNPACK_ALIGNMENT, &prevUnpack);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data);
+    // The texture is RGB16F anyway: converting here halves the upload and skips the driver's conversion.
+    std::vector<std::uint16_t> halfPixels(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 3);
+    const std::size_t rowFloats = static_cast<std::size_t>(width) * 3;
+    pixel_ops::forEachRowBlock(height, rowFloats * sizeof(float), [&](int firstRow, int lastRow) {
+        const std::size_t offset = static_cast<std::size_t>(firstRow) * rowFloats;
+        pixel_ops::floatToHalf(data + offset, halfPixels.data() + offset, static_cast<std::size_t>(lastRow - firstRow) * rowFloats);
+    });
+    stbi_image_free(data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_HALF_FLOAT, halfPixels.data());
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -661,7 +724,6 @@ GLuint EnvironmentManager::loadHdrTexture(const std::filesystem::path& path)
     glPixelStorei(GL_UNPACK_ALIGNMENT, prevUnpack);
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    stbi_image_free(data);
     stbi_set_flip_vertically_on_load(false);
     return texture;
 }
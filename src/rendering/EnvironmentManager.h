@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MIT
 #pragma once
 
+#include <framework/file_provider.h>
 #include <framework/shader.h>
 #include <framework/opengl_includes.h>
 
@@ -13,6 +14,8 @@
 #include <string>
 #include <unordered_map>
 
+class AssetDatabase;
+
 class EnvironmentManager {
 public:
     struct AdvancedSettings {
@@ -29,6 +32,8 @@ public:
     EnvironmentManager& operator=(const EnvironmentManager&) = delete;
 
     void initializeGL();
+    // Keys the bake cache on the HDR's content and tracks the bake as an "ibl" artifact.
+    void setAssetDatabase(AssetDatabase* database);
 
     bool loadEnvironment(const std::filesystem::path& path);
     void unload();
@@ -64,6 +69,8 @@ public:
 
     [[nodiscard]] bool hasEnvironment() const { return static_cast<bool>(m_currentEnvironment); }
     [[nodiscard]] const std::filesystem::path& currentEnvironmentPath() const { return m_currentPath; }
+    // The HDR behind the current environment changed since it was baked.
+    [[nodiscard]] bool environmentSourceChanged() const;
 
 private:
     struct EnvironmentTextures {
@@ -87,7 +94,7 @@ private:
         std::size_t operator()(const std::string& value) const noexcept { return std::hash<std::string> {}(value); }
     };
 
-    [[nodiscard]] std::shared_ptr<EnvironmentTextures> bakeEnvironment(const std::filesystem::path& path);
+    [[nodiscard]] std::shared_ptr<EnvironmentTextures> bakeEnvironment(const std::filesystem::path& path, const FileData& file);
     void ensureBrdfLut();
     void ensureCaptureResources();
     void ensureCubeGeometry();
@@ -100,7 +107,7 @@ private:
     void prefilterSpecular(EnvironmentTextures& textures, int baseSize, int mipLevels);
     void generateBrdfLutTexture();
 
-    [[nodiscard]] GLuint loadHdrTexture(const std::filesystem::path& path);
+    [[nodiscard]] GLuint loadHdrTexture(const std::filesystem::path& path, const FileData& file);
 
 private:
     std::filesystem::path m_shaderDirectory;
@@ -108,6 +115,7 @@ private:
     std::unordered_map<std::string, std::weak_ptr<EnvironmentTextures>, CacheKeyHash> m_cache;
     std::shared_ptr<EnvironmentTextures> m_currentEnvironment;
     std::filesystem::path m_currentPath;
+    AssetDatabase* m_assetDatabase { nullptr };
 
     AdvancedSettings m_settings;
 
@@ -137,7 +145,7 @@ private:
     bool m_isInitialized { false };
     GLint m_bakeTextureUnit { -1 };
 
-    [[nodiscard]] std::string createCacheKey(const std::filesystem::path& path) const;
+    [[nodiscard]] std::string createCacheKey(const std::filesystem::path& path, const FileData& file) const;
 
     void destroyShaders();
 };
@@ -0,0 +1,577 @@
+// SPDX-License-Identifier: MIT
+#include "rendering/IrradianceProbeGrid.h"
+
+#include "mesh/MeshManager.h"
+#include "mesh/RayBvh.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/trigonometric.hpp>
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+namespace {
+
+constexpr char kCacheMagic[4] = { 'D', 'P', 'R', 'B' };
+constexpr std::size_t kProbesPerChunk = 4;
+
+// Real L2 spherical harmonics basis, in the order (0,0), (1,-1), (1,0), (1,1), (2,-2) ... (2,2).
+void shBasis(const glm::vec3& d, float* y)
+{
+    y[0] = 0.282095f;
+    y[1] = 0.488603f * d.y;
+    y[2] = 0.488603f * d.z;
+    y[3] = 0.488603f * d.x;
+    y[4] = 1.092548f * d.x * d.y;
+    y[5] = 1.092548f * d.y * d.z;
+    y[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+    y[7] = 1.092548f * d.x * d.z;
+    y[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+}
+
+// Cosine-lobe convolution per band (Ramamoorthi and Hanrahan), divided by pi.
+constexpr float kBandScale[3] = { 1.0f, 2.0f / 3.0f, 0.25f };
+
+std::size_t bandOf(std::size_t coefficient)
+{
+    return coefficient == 0 ? 0 : (coefficient < 4 ? 1 : 2);
+}
+
+std::uint32_t hashIndex(std::uint32_t value)
+{
+    value ^= value >> 16;
+    value *= 0x7feb352du;
+    value ^= value >> 15;
+    value *= 0x846ca68bu;
+    value ^= value >> 16;
+    return value;
+}
+
+bool isFile(const std::filesystem::path& path)
+{
+    std::error_code error;
+    return !path.empty() && std::filesystem::is_regular_file(path, error);
+}
+
+std::string describe(const glm::vec3& v)
+{
+    return std::to_string(v.x) + "," + std::to_string(v.y) + "," + std::to_string(v.z);
+}
+
+std::string settingsKey(const IrradianceProbeGrid::Settings& settings)
+{
+    std::string key;
+    key += "|spacing=" + std::to_string(settings.spacing);
+    key += "|max=" + std::to_string(settings.maxProbesPerAxis);
+    key += "|pad=" + std::to_string(settings.padding);
+    key += "|rays=" + std::to_string(settings.raysPerProbe);
+    key += "|bounces=" + std::to_string(settings.bounces);
+    key += "|sky=" + describe(settings.skyColor * settings.skyIntensity);
+    key += "|invalid=" + std::to_string(settings.invalidBackfaceFraction);
+    return key;
+}
+
+// Mirrors evaluateGpuLight() in pbr.frag, including its colour * intensity^2 radiance.
+glm::vec3 lightIrradiance(const LightManager::Light& light, const glm::vec3& position, const glm::vec3& normal,
+    const RayBvh& bvh, float rayOffset)
+{
+    const glm::vec3 toLight = light.position - position;
+    const float distance = glm::length(toLight);
+    if (distance <= 1e-4f)
+        return glm::vec3(0.0f);
+    const glm::vec3 direction = toLight / distance;
+    const float cosine = glm::dot(normal, direction);
+    if (cosine <= 0.0f)
+        return glm::vec3(0.0f);
+
+    float attenuation = 1.0f;
+    if (light.useAttenuation) {
+        const float denominator = light.attenuationConstant + light.attenuationLinear * distance + light.attenuationQuadratic * distance * distance;
+        attenuation = 1.0f / std::max(denominator, 1e-4f);
+        const float range = std::max(light.range, 0.1f);
+        const float n = std::clamp(distance / range, 0.0f, 1.0f);
+        const float soft = glm::smoothstep(0.0f, 1.0f, 1.0f - n);
+        attenuation *= (1.0f - n * n * n * n) * soft;
+    }
+
+    float spot = 1.0f;
+    if (light.type == LightManager::LightType::Spot) {
+        const float directionLength = glm::length(light.direction);
+        const glm::vec3 spotDirection = directionLength > 1e-6f ? light.direction / directionLength : glm::vec3(0.0f, -1.0f, 0.0f);
+        float innerCos = glm::cos(glm::radians(std::clamp(std::min(light.innerConeDegrees, light.outerConeDegrees - 0.1f), 0.1f, 89.0f)));
+        float outerCos = glm::cos(glm::radians(std::clamp(light.outerConeDegrees, 0.1f, 89.0f)));
+        if (innerCos < outerCos)
+            std::swap(innerCos, outerCos);
+        const float w = std::clamp((glm::dot(spotDirection, -direction) - outerCos) / std::max(innerCos - outerCos, 1e-4f), 0.0f, 1.0f);
+        spot = w * w * (3.0f - 2.0f * w);
+    }
+
+    const float scale = attenuation * spot * cosine;
+    if (scale <= 0.0f)
+        return glm::vec3(0.0f);
+    if (bvh.occluded(position + normal * rayOffset, direction, 0.0f, distance - rayOffset))
+        return glm::vec3(0.0f);
+    return light.color * light.intensity * light.intensity * scale;
+}
+
+bool writeCache(const std::filesystem::path& path, const IrradianceProbeGrid::Grid& grid)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+    file.write(kCacheMagic, sizeof(kCacheMagic));
+    file.write(reinterpret_cast<const char*>(&IrradianceProbeGrid::kBakeVersion), sizeof(std::uint32_t));
+    file.write(reinterpret_cast<const char*>(&grid.origin), sizeof(grid.origin));
+    file.write(reinterpret_cast<const char*>(&grid.spacing), sizeof(grid.spacing));
+    file.write(reinterpret_cast<const char*>(&grid.resolution), sizeof(grid.resolution));
+    file.write(reinterpret_cast<const char*>(grid.irradiance.data()), static_cast<std::streamsize>(grid.irradiance.size() * sizeof(grid.irradiance[0])));
+    file.write(reinterpret_cast<const char*>(grid.validity.data()), static_cast<std::streamsize>(grid.validity.size() * sizeof(float)));
+    return static_cast<bool>(file);
+}
+
+bool readCache(const std::filesystem::path& path, IrradianceProbeGrid::Grid& grid)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[4] {};
+    std::uint32_t version = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&grid.origin), sizeof(grid.origin));
+    file.read(reinterpret_cast<char*>(&grid.spacing), sizeof(grid.spacing));
+    file.read(reinterpret_cast<char*>(&grid.resolution), sizeof(grid.resolution));
+    if (!file || std::memcmp(magic, kCacheMagic, sizeof(magic)) != 0 || version != IrradianceProbeGrid::kBakeVersion)
+        return false;
+    if (glm::any(glm::lessThan(grid.resolution, glm::ivec3(1))) || glm::any(glm::greaterThan(grid.resolution, glm::ivec3(256))))
+        return false;
+
+    const auto count = static_cast<std::size_t>(grid.resolution.x) * static_cast<std::size_t>(grid.resolution.y) * static_cast<std::size_t>(grid.resolution.z);
+    grid.irradiance.resize(count);
+    grid.validity.resize(count);
+    file.read(reinterpret_cast<char*>(grid.irradiance.data()), static_cast<std::streamsize>(count * sizeof(grid.irradiance[0])));
+    file.read(reinterpret_cast<char*>(grid.validity.data()), static_cast<std::streamsize>(count * sizeof(float)));
+    return static_cast<bool>(file);
+}
+
+} // namespace
+
+glm::vec3 IrradianceProbeGrid::Grid::probePosition(std::size_t index) const
+{
+    const auto x = static_cast<int>(index % static_cast<std::size_t>(resolution.x));
+    const auto y = static_cast<int>((index / static_cast<std::size_t>(resolution.x)) % static_cast<std::size_t>(resolution.y));
+    const auto z = static_cast<int>(index / (static_cast<std::size_t>(resolution.x) * static_cast<std::size_t>(resolution.y)));
+    return origin + spacing * glm::vec3(x, y, z);
+}
+
+glm::vec3 IrradianceProbeGrid::Grid::sample(const glm::vec3& position, const glm::vec3& normal) const
+{
+    if (irradiance.empty())
+        return glm::vec3(0.0f);
+
+    const glm::vec3 g = glm::clamp((position - origin) / spacing, glm::vec3(0.0f), glm::vec3(resolution - 1));
+    const glm::ivec3 base = glm::min(glm::ivec3(g), glm::max(resolution - 2, glm::ivec3(0)));
+    const glm::vec3 f = g - glm::vec3(base);
+
+    float y[kShCoefficients];
+    shBasis(normal, y);
+
+    glm::vec3 sum(0.0f);
+    float weightSum = 0.0f;
+    for (int corner = 0; corner < 8; ++corner) {
+        const glm::ivec3 offset(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1);
+        const glm::ivec3 cell = glm::min(base + offset, resolution - 1);
+        const std::size_t index = static_cast<std::size_t>(cell.x)
+            + static_cast<std::size_t>(resolution.x) * (static_cast<std::size_t>(cell.y) + static_cast<std::size_t>(resolution.y) * static_cast<std::size_t>(cell.z));
+        const glm::vec3 w3 = glm::mix(glm::vec3(1.0f) - f, f, glm::vec3(offset));
+        const float weight = w3.x * w3.y * w3.z * validity[index];
+        if (weight <= 0.0f)
+            continue;
+        glm::vec3 value(0.0f);
+        for (std::size_t k = 0; k < kShCoefficients; ++k)
+            value += irradiance[index][k] * y[k];
+        sum += weight * value;
+        weightSum += weight;
+    }
+    return weightSum > 1e-4f ? glm::max(sum / weightSum, glm::vec3(0.0f)) : glm::vec3(0.0f);
+}
+
+IrradianceProbeGrid::~IrradianceProbeGrid()
+{
+    shutdown();
+}
+
+void IrradianceProbeGrid::shutdown()
+{
+    if (m_pending && m_pending->done.valid())
+        m_pending->done.wait();
+    m_pending.reset();
+    if (m_atlas != 0)
+        glDeleteTextures(1, &m_atlas);
+    m_atlas = 0;
+}
+
+void IrradianceProbeGrid::setAssetDatabase(AssetDatabase* database)
+{
+    m_database = database;
+    if (m_database)
+        m_database->registerImporter("probe_grid", kBakeVersion);
+}
+
+IrradianceProbeGrid::BakeInput IrradianceProbeGrid::gatherScene(const MeshManager& meshManager, const LightManager& lightManager)
+{
+    BakeInput input;
+    input.bounds.min = glm::vec3(std::numeric_limits<float>::max());
+    input.bounds.max = glm::vec3(std::numeric_limits<float>::lowest());
+
+    for (const MeshInstance& instance : meshManager.instances()) {
+        const glm::mat4& transform = instance.transform();
+        input.fingerprint += "|" + instance.sourcePath().string();
+        for (int column = 0; column < 4; ++column)
+            input.fingerprint += ";" + describe(glm::vec3(transform[column]));
+        if (isFile(instance.sourcePath()))
+            input.sources.push_back(instance.sourcePath());
+
+        for (const MeshDrawItem& item : instance.drawItems()) {
+            if (!item.cpuGeometry || item.material.isTransparent)
+                continue;
+            const MeshGeometryData& geometry = *item.cpuGeometry;
+            const glm::mat4 model = transform * item.nodeTransform;
+            const auto base = static_cast<std::uint32_t>(input.positions.size());
+            for (const glm::vec3& position : geometry.positions) {
+                const glm::vec3 world(model * glm::vec4(position, 1.0f));
+                input.positions.push_back(world);
+                input.bounds.min = glm::min(input.bounds.min, world);
+                input.bounds.max = glm::max(input.bounds.max, world);
+            }
+
+            // Textures are not sampled; a textured surface is taken as mid-grey times its tint.
+            const RenderMaterial& material = item.material;
+            glm::vec3 albedo = material.usePBR ? material.baseColor * (1.0f - material.metallic) : material.diffuseColor;
+            if (material.hasAlbedoTexture)
+                albedo *= 0.5f;
+            const auto materialIndex = static_cast<std::uint32_t>(input.albedo.size());
+            input.albedo.emplace_back(glm::min(albedo, glm::vec3(0.9f)), material.doubleSided ? 1.0f : 0.0f);
+            input.emission.push_back(material.emissive * material.emissiveIntensity);
+
+            for (const glm::uvec3& triangle : geometry.triangles) {
+                input.triangles.push_back(triangle + glm::uvec3(base));
+                input.triangleMaterials.push_back(materialIndex);
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < lightManager.lightCount(); ++i) {
+        if (!lightManager.isEnabled(i))
+            continue;
+        LightManager::Light light = lightManager.light(i);
+        input.fingerprint += "|light=" + describe(light.position) + ";" + describe(light.direction) + ";" + describe(light.color)
+            + ";" + std::to_string(light.intensity) + ";" + std::to_string(light.range)
+            + ";" + std::to_string(light.innerConeDegrees) + ";" + std::to_string(light.outerConeDegrees)
+            + ";" + std::to_string(static_cast<int>(light.type)) + ";" + std::to_string(light.useAttenuation)
+            + ";" + std::to_string(light.attenuationConstant) + ";" + std::to_string(light.attenuationLinear)
+            + ";" + std::to_string(light.attenuationQuadratic);
+        input.lights.push_back(std::move(light));
+    }
+
+    std::sort(input.sources.begin(), input.sources.end());
+    input.sources.erase(std::unique(input.sources.begin(), input.sources.end()), input.sources.end());
+    return input;
+}
+
+IrradianceProbeGrid::Grid IrradianceProbeGrid::bake(const BakeInput& input, const Settings& settings, std::uint64_t* raysTraced)
+{
+    Grid grid;
+    if (input.triangles.empty())
+        return grid;
+
+    // Grid over the padded bounds; spacing grows rather than exceeding maxProbesPerAxis.
+    const int maxPerAxis = std::max(settings.maxProbesPerAxis, 2);
+    const glm::vec3 boundsMin = input.bounds.min - glm::vec3(settings.padding);
+    const glm::vec3 extent = glm::max(input.bounds.max - input.bounds.min + glm::vec3(2.0f * settings.padding), glm::vec3(1e-3f));
+    const float maxExtent = std::max({ extent.x, extent.y, extent.z });
+    const float spacing = std::max(settings.spacing, maxExtent / static_cast<float>(maxPerAxis - 1));
+    for (int axis = 0; axis < 3; ++axis) {
+        grid.resolution[axis] = std::clamp(static_cast<int>(std::ceil(extent[axis] / spacing)) + 1, 2, maxPerAxis);
+        grid.spacing[axis] = extent[axis] / static_cast<float>(grid.resolution[axis] - 1);
+    }
+    grid.origin = boundsMin;
+    const std::size_t probeCount = static_cast<std::size_t>(grid.resolution.x) * static_cast<std::size_t>(grid.resolution.y) * static_cast<std::size_t>(grid.resolution.z);
+    grid.irradiance.assign(probeCount, {});
+    grid.validity.assign(probeCount, 1.0f);
+
+    RayBvh bvh;
+    bvh.build(input.positions, input.triangles);
+    const float rayOffset = 1e-4f * glm::length(bvh.boundsMax() - bvh.boundsMin());
+
+    std::vector<glm::vec3> faceNormals(input.triangles.size());
+    for (std::size_t i = 0; i < input.triangles.size(); ++i) {
+        const glm::uvec3& tri = input.triangles[i];
+        const glm::vec3 n = glm::cross(input.positions[tri.y] - input.positions[tri.x], input.positions[tri.z] - input.positions[tri.x]);
+        const float length = glm::length(n);
+        faceNormals[i] = length > 0.0f ? n / length : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+
+    const int rayCount = std::clamp(settings.raysPerProbe, 16, 8192);
+    const glm::vec3 sky = settings.skyColor * settings.skyIntensity;
+    const std::size_t chunkCount = (probeCount + kProbesPerChunk - 1) / kProbesPerChunk;
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    const auto threadCount = static_cast<std::size_t>(std::min<std::size_t>(settings.threads > 0 ? settings.threads : hardware, chunkCount));
+
+    std::atomic<std::uint64_t> totalRays { 0 };
+    Grid previous;
+    const int bounces = std::clamp(settings.bounces, 1, 4);
+    for (int bounce = 0; bounce < bounces; ++bounce) {
+        const Grid* indirect = bounce > 0 ? &previous : nullptr;
+        std::atomic<std::size_t> nextChunk { 0 };
+        const auto worker = [&]() {
+            std::uint64_t localRays = 0;
+            for (std::size_t c = nextChunk.fetch_add(1); c < chunkCount; c = nextChunk.fetch_add(1)) {
+                for (std::size_t probe = c * kProbesPerChunk; probe < std::min(probeCount, (c + 1) * kProbesPerChunk); ++probe) {
+                    const glm::vec3 origin = grid.probePosition(probe);
+                    std::array<glm::vec3, kShCoefficients> radianceSh {};
+                    int backfaces = 0;
+                    // Spherical Fibonacci directions, rotated about z per probe.
+                    const float rotation = static_cast<float>(hashIndex(static_cast<std::uint32_t>(probe)) & 0xFFFFu) / 65536.0f;
+                    for (int r = 0; r < rayCount; ++r) {
+                        const float z = 1.0f - (2.0f * static_cast<float>(r) + 1.0f) / static_cast<float>(rayCount);
+                        const float radius = std::sqrt(std::max(0.0f, 1.0f - z * z));
+                        const float phi = glm::two_pi<float>() * (static_cast<float>(r) * 0.618034f + rotation);
+                        const glm::vec3 direction(radius * std::cos(phi), radius * std::sin(phi), z);
+
+                        glm::vec3 radiance = sky;
+                        if (const std::optional<RayBvh::Hit> hit = bvh.intersect(origin, direction, 0.0f, std::numeric_limits<float>::max())) {
+                            const std::uint32_t material = input.triangleMaterials[hit->triangle];
+                            glm::vec3 normal = faceNormals[hit->triangle];
+                            if (glm::dot(normal, direction) > 0.0f) {
+                                if (input.albedo[material].a < 0.5f) {
+                                    ++backfaces;
+                                    continue; // contributes black
+                                }
+                                normal = -normal;
+                            }
+                            const glm::vec3 position = origin + direction * hit->t;
+                            const glm::vec3 albedo(input.albedo[material]);
+                            glm::vec3 direct(0.0f);
+                            for (const LightManager::Light& light : input.lights)
+                                direct += lightIrradiance(light, position, normal, bvh, rayOffset);
+                            radiance = input.emission[material] + albedo * direct / glm::pi<float>();
+                            if (indirect)
+                                radiance += albedo * indirect->sample(position + normal * rayOffset, normal);
+                        }
+
+                        float y[kShCoefficients];
+                        shBasis(direction, y);
+                        for (std::size_t k = 0; k < kShCoefficients; ++k)
+                            radianceSh[k] += radiance * y[k];
+                    }
+                    localRays += static_cast<std::uint64_t>(rayCount);
+
+                    const float weight = 4.0f * glm::pi<float>() / static_cast<float>(rayCount);
+                    for (std::size_t k = 0; k < kShCoefficients; ++k)
+                        grid.irradiance[probe][k] = radianceSh[k] * weight * kBandScale[bandOf(k)];
+                    grid.validity[probe] = static_cast<float>(backfaces) / static_cast<float>(rayCount) > settings.invalidBackfaceFraction ? 0.0f : 1.0f;
+                }
+            }
+            totalRays.fetch_add(localRays, std::memory_order_relaxed);
+        };
+
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < threadCount; ++i)
+            workers.emplace_back(worker);
+        worker();
+        for (std::thread& thread : workers)
+            thread.join();
+
+        if (bounce + 1 < bounces)
+            previous = grid;
+    }
+
+    if (raysTraced)
+        *raysTraced = totalRays.load();
+    return grid;
+}
+
+void IrradianceProbeGrid::requestBake(const MeshManager& meshManager, const LightManager& lightManager)
+{
+    if (m_pending)
+        return;
+
+    auto input = std::make_shared<BakeInput>(gatherScene(meshManager, lightManager));
+    if (input->triangles.empty()) {
+        std::cout << "[ProbeGrid] Nothing to bake: the scene has no geometry" << std::endl;
+        return;
+    }
+
+    auto pending = std::make_unique<PendingBake>();
+    pending->outcome = std::make_shared<BakeOutcome>();
+    const Settings settings = m_settings;
+    std::shared_ptr<BakeOutcome> outcome = pending->outcome;
+    const auto run = [input, settings, outcome]() {
+        const auto start = std::chrono::steady_clock::now();
+        outcome->grid = bake(*input, settings, &outcome->rays);
+        outcome->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    if (m_database && !input->sources.empty()) {
+        AssetDatabase::ArtifactKey key;
+        key.kind = "probe_grid";
+        key.source = input->sources.front();
+        key.settingsHash = AssetDatabase::hashSettings(input->fingerprint + settingsKey(settings));
+        pending->cachePath = m_database->artifactPath(key);
+        pending->done = m_database->request(key, [input, run, outcome](AssetDatabase::ImportContext& context) {
+            for (const std::filesystem::path& source : input->sources)
+                context.dependOn(source);
+            run();
+            return writeCache(context.outputPath(), outcome->grid);
+        });
+    } else {
+        pending->done = std::async(std::launch::async, [run]() {
+            run();
+            return true;
+        }).share();
+    }
+    m_pending = std::move(pending);
+    m_stats.pending = true;
+}
+
+void IrradianceProbeGrid::update()
+{
+    if (!m_pending || m_pending->done.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+
+    const std::unique_ptr<PendingBake> pending = std::move(m_pending);
+    m_stats.pending = false;
+    BakeOutcome& outcome = *pending->outcome;
+    bool succeeded = pending->done.get();
+    const bool traced = outcome.rays > 0;
+    if (succeeded && !traced && !pending->cachePath.empty())
+        succeeded = readCache(pending->cachePath, outcome.grid);
+    if (!succeeded || outcome.grid.irradiance.empty()) {
+        std::cerr << "[ProbeGrid] Bake failed" << std::endl;
+        return;
+    }
+
+    m_grid = std::move(outcome.grid);
+    upload(m_grid);
+
+    m_stats.probes = m_grid.probeCount();
+    m_stats.invalidProbes = static_cast<std::size_t>(std::count(m_grid.validity.begin(), m_grid.validity.end(), 0.0f));
+    m_stats.fromCache = !traced;
+    if (traced) {
+        m_stats.rays = outcome.rays;
+        m_stats.seconds = outcome.seconds;
+        m_stats.raysPerSecond = outcome.seconds > 0.0 ? static_cast<double>(outcome.rays) / outcome.seconds : 0.0;
+        std::cout << "[ProbeGrid] Baked " << m_grid.resolution.x << "x" << m_grid.resolution.y << "x" << m_grid.resolution.z
+                  << " probes (" << m_stats.invalidProbes << " invalid), " << outcome.rays << " rays in " << outcome.seconds
+                  << " s (" << m_stats.raysPerSecond / 1.0e6 << " Mrays/s)" << std::endl;
+    } else {
+        std::cout << "[ProbeGrid] Loaded " << m_grid.resolution.x << "x" << m_grid.resolution.y << "x" << m_grid.resolution.z
+                  << " probes from cache" << std::endl;
+    }
+}
+
+void IrradianceProbeGrid::upload(const Grid& grid)
+{
+    const glm::ivec3 resolution = grid.resolution;
+    const int depth = resolution.z * kAtlasSlabs;
+
+    GLint width = 0;
+    GLint height = 0;
+    GLint currentDepth = 0;
+    if (m_atlas != 0) {
+        glGetTextureLevelParameteriv(m_atlas, 0, GL_TEXTURE_WIDTH, &width);
+        glGetTextureLevelParameteriv(m_atlas, 0, GL_TEXTURE_HEIGHT, &height);
+        glGetTextureLevelParameteriv(m_atlas, 0, GL_TEXTURE_DEPTH, &currentDepth);
+    }
+    if (m_atlas == 0 || width != resolution.x || height != resolution.y || currentDepth != depth) {
+        if (m_atlas != 0)
+            glDeleteTextures(1, &m_atlas);
+        glCreateTextures(GL_TEXTURE_3D, 1, &m_atlas);
+        glTextureStorage3D(m_atlas, 1, GL_RGBA16F, resolution.x, resolution.y, depth);
+        glTextureParameteri(m_atlas, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(m_atlas, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(m_atlas, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_atlas, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_atlas, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    }
+
+    // Texel k of a probe holds floats 4k..4k+3 of: L00.rgb, validity, then the other eight
+    // coefficients' rgb. Everything but validity is premultiplied by validity.
+    const std::size_t slabSize = grid.probeCount();
+    std::vector<glm::vec4> texels(slabSize * kAtlasSlabs);
+    for (std::size_t probe = 0; probe < slabSize; ++probe) {
+        const float validity = grid.validity[probe];
+        float packed[kAtlasSlabs * 4] {};
+        packed[0] = grid.irradiance[probe][0].r * validity;
+        packed[1] = grid.irradiance[probe][0].g * validity;
+        packed[2] = grid.irradiance[probe][0].b * validity;
+        packed[3] = validity;
+        for (std::size_t k = 1; k < kShCoefficients; ++k) {
+            for (int channel = 0; channel < 3; ++channel)
+                packed[4 + (k - 1) * 3 + static_cast<std::size_t>(channel)] = grid.irradiance[probe][k][channel] * validity;
+        }
+        for (int slab = 0; slab < kAtlasSlabs; ++slab)
+            texels[probe + slabSize * static_cast<std::size_t>(slab)] = glm::vec4(packed[slab * 4], packed[slab * 4 + 1], packed[slab * 4 + 2], packed[slab * 4 + 3]);
+    }
+    glTextureSubImage3D(m_atlas, 0, 0, 0, 0, resolution.x, resolution.y, depth, GL_RGBA, GL_FLOAT, texels.data());
+}
+
+void IrradianceProbeGrid::clear()
+{
+    if (m_atlas != 0)
+        glDeleteTextures(1, &m_atlas);
+    m_atlas = 0;
+    m_grid = {};
+    m_stats.probes = 0;
+    m_stats.invalidProbes = 0;
+}
+
+void IrradianceProbeGrid::drawImGuiPanel(const MeshManager& meshManager, const LightManager& lightManager)
+{
+    ImGui::Checkbox("Use Probes", &m_settings.enabled);
+    ImGui::SliderFloat("Indirect Intensity", &m_settings.intensity, 0.0f, 4.0f, "%.2f");
+    ImGui::SliderFloat("Normal Bias", &m_settings.normalBias, 0.0f, 1.0f, "%.2f spacing");
+
+    ImGui::Separator();
+    ImGui::TextUnformatted("Bake");
+    ImGui::SliderFloat("Spacing (m)", &m_settings.spacing, 0.25f, 8.0f, "%.2f");
+    ImGui::SliderInt("Max Probes Per Axis", &m_settings.maxProbesPerAxis, 2, 64);
+    ImGui::SliderInt("Rays Per Probe", &m_settings.raysPerProbe, 32, 2048);
+    ImGui::SliderInt("Bounces", &m_settings.bounces, 1, 4);
+    ImGui::ColorEdit3("Sky Colour", &m_settings.skyColor.x);
+    ImGui::SliderFloat("Sky Intensity", &m_settings.skyIntensity, 0.0f, 4.0f, "%.2f");
+    ImGui::SliderFloat("Invalid Backface Fraction", &m_settings.invalidBackfaceFraction, 0.05f, 1.0f, "%.2f");
+
+    ImGui::BeginDisabled(m_stats.pending);
+    if (ImGui::Button(m_stats.pending ? "Baking..." : "Bake Probes"))
+        requestBake(meshManager, lightManager);
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    if (ImGui::Button("Clear"))
+        clear();
+
+    if (m_atlas != 0) {
+        ImGui::Text("Grid: %d x %d x %d (%zu probes, %zu invalid)", m_grid.resolution.x, m_grid.resolution.y, m_grid.resolution.z,
+            m_stats.probes, m_stats.invalidProbes);
+        ImGui::Text("Spacing: %.2f x %.2f x %.2f m",
+            static_cast<double>(m_grid.spacing.x),
+            static_cast<double>(m_grid.spacing.y),
+            static_cast<double>(m_grid.spacing.z));
+    }
+    if (m_stats.fromCache)
+        ImGui::TextUnformatted("Last bake: loaded from cache");
+    else if (m_stats.rays > 0)
+        ImGui::Text("Last bake: %llu rays in %.2f s, %.2f Mrays/s", static_cast<unsigned long long>(m_stats.rays), m_stats.seconds, m_stats.raysPerSecond / 1.0e6);
+}
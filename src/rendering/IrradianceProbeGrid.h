@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "io/AssetDatabase.h"
+#include "mesh/MeshInstance.h"
+#include "rendering/LightManager.h"
+
+#include <framework/disable_all_warnings.h>
+#include <framework/opengl_includes.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+class MeshManager;
+
+// Static diffuse indirect lighting from a regular grid of irradiance probes over the scene bounds.
+// Each probe traces rays against a RayBvh of every mesh instance on all cores. Hit surfaces
+// contribute their emission plus albedo times the direct light they receive (point and spot lights
+// with shadow rays) and, from the second bounce on, the previous bounce's grid. Misses see a
+// constant sky. Radiance is projected into L2 spherical harmonics and convolved to irradiance.
+// Probes that mostly see back faces are inside geometry and marked invalid.
+//
+// On the GPU the grid is one RGBA16F 3D texture atlas: kAtlasSlabs slabs stacked along z carry the 27
+// coefficients plus validity, premultiplied by validity. One hardware-trilinear fetch per slab,
+// divided by the filtered validity, blends valid probes only. Bakes of scenes loaded from files are
+// "probe_grid" artifacts in the asset database, keyed by sources, instance placement, lights and
+// settings.
+class IrradianceProbeGrid {
+public:
+    static constexpr std::uint32_t kBakeVersion = 1;
+    static constexpr std::size_t kShCoefficients = 9;
+    static constexpr int kAtlasSlabs = 7; // ceil((9 * 3 + 1) / 4)
+
+    struct Settings {
+        bool enabled { true };
+        float spacing { 1.0f }; // metres; grown when the bounds need more than maxProbesPerAxis
+        int maxProbesPerAxis { 24 };
+        float padding { 0.5f }; // metres added around the scene bounds
+        int raysPerProbe { 256 };
+        int bounces { 2 };
+        glm::vec3 skyColor { 0.35f, 0.45f, 0.6f };
+        float skyIntensity { 1.0f };
+        float invalidBackfaceFraction { 0.25f };
+        float intensity { 1.0f };
+        float normalBias { 0.25f }; // shading lookup offset along the normal, in probe spacings
+        unsigned threads { 0 }; // 0: one per hardware thread
+    };
+
+    // Scene snapshot taken on the main thread; baking only reads it.
+    struct BakeInput {
+        std::vector<glm::vec3> positions; // world space
+        std::vector<glm::uvec3> triangles;
+        std::vector<std::uint32_t> triangleMaterials;
+        // rgb: diffuse albedo, a: 1 for double-sided materials.
+        std::vector<glm::vec4> albedo;
+        std::vector<glm::vec3> emission;
+        std::vector<LightManager::Light> lights; // enabled only
+        BoundingBox bounds;
+        // Source files of the instances, and everything else the bake depends on as text.
+        std::vector<std::filesystem::path> sources;
+        std::string fingerprint;
+    };
+
+    // Irradiance divided by pi, so shading multiplies by albedo directly like the IBL irradiance map.
+    struct Grid {
+        glm::vec3 origin { 0.0f }; // first probe
+        glm::vec3 spacing { 1.0f };
+        glm::ivec3 resolution { 0 };
+        std::vector<std::array<glm::vec3, kShCoefficients>> irradiance;
+        std::vector<float> validity;
+
+        [[nodiscard]] std::size_t probeCount() const { return irradiance.size(); }
+        [[nodiscard]] glm::vec3 probePosition(std::size_t index) const;
+        // Validity-weighted trilinear lookup, as the shader does it.
+        [[nodiscard]] glm::vec3 sample(const glm::vec3& position, const glm::vec3& normal) const;
+    };
+
+    struct Stats {
+        std::size_t probes { 0 };
+        std::size_t invalidProbes { 0 };
+        std::uint64_t rays { 0 };
+        double seconds { 0.0 };
+        double raysPerSecond { 0.0 };
+        bool fromCache { false };
+        bool pending { false };
+    };
+
+    IrradianceProbeGrid() = default;
+    ~IrradianceProbeGrid();
+    IrradianceProbeGrid(const IrradianceProbeGrid&) = delete;
+    IrradianceProbeGrid& operator=(const IrradianceProbeGrid&) = delete;
+
+    [[nodiscard]] static BakeInput gatherScene(const MeshManager& meshManager, const LightManager& lightManager);
+    [[nodiscard]] static Grid bake(const BakeInput& input, const Settings& settings, std::uint64_t* raysTraced = nullptr);
+
+    void setAssetDatabase(AssetDatabase* database);
+    void shutdown();
+
+    // Snapshots the scene and bakes it in the background (or loads the cached bake).
+    void requestBake(const MeshManager& meshManager, const LightManager& lightManager);
+    // Uploads a finished bake; call once per frame on the GL thread.
+    void update();
+    void clear();
+
+    [[nodiscard]] bool active() const { return m_settings.enabled && m_atlas != 0; }
+    [[nodiscard]] GLuint atlasTexture() const { return m_atlas; }
+    [[nodiscard]] const Grid& grid() const { return m_grid; }
+    [[nodiscard]] const Settings& settings() const { return m_settings; }
+    void setSettings(const Settings& settings) { m_settings = settings; }
+    [[nodiscard]] const Stats& stats() const { return m_stats; }
+
+    void drawImGuiPanel(const MeshManager& meshManager, const LightManager& lightManager);
+
+private:
+    struct BakeOutcome {
+        Grid grid;
+        std::uint64_t rays { 0 }; // 0 when nothing was traced for this request
+        double seconds { 0.0 };
+    };
+
+    struct PendingBake {
+        std::shared_future<bool> done;
+        std::shared_ptr<BakeOutcome> outcome;
+        std::filesystem::path cachePath; // empty when the bake is not cached
+    };
+
+    void upload(const Grid& grid);
+
+    Settings m_settings;
+    AssetDatabase* m_database { nullptr };
+    std::unique_ptr<PendingBake> m_pending;
+
+    Grid m_grid;
+    GLuint m_atlas { 0 };
+    Stats m_stats;
+};
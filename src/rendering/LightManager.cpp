@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MIT
 
 #include "rendering/LightManager.h"
+#include "rendering/MeshletCuller.h"
 
 #include "rendering/TextureUnits.h"
 
@@ -9,6 +10,7 @@
 #include "terrain/ProceduralFloor.h"
 
 #include <framework/disable_all_warnings.h>
+#include <framework/log.h>
 DISABLE_WARNINGS_PUSH()
 #include <imgui/imgui.h>
 DISABLE_WARNINGS_POP()
@@ -22,9 +24,11 @@ DISABLE_WARNINGS_POP()
 #include <glm/gtc/type_ptr.hpp>
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
 #include <cstdio>
 #include <cassert>
+#include <string_view>
 
 #ifdef NDEBUG
 #define GLCHK() ((void)0)
@@ -33,7 +37,7 @@ DISABLE_WARNINGS_POP()
     do {                                                                        \
         GLenum e;                                                               \
         while ((e = glGetError()) != GL_NO_ERROR)                               \
-            std::fprintf(stderr, "GLERR 0x%X %s:%d\n", e, __FILE__, __LINE__); \
+            LOG_ERROR(logging::Category::OpenGL, "GLERR 0x{:X} {}:{}", e, __FILE__, __LINE__); \
     } while (0)
 #endif
 
@@ -68,9 +72,51 @@ constexpr std::array<glm::vec3, 6> kPointShadowUps = {
 
 struct ShadowUniform {
     glm::mat4 matrix { 1.0f };
-    glm::vec4 params { 0.0f };
+    glm::vec4 params { 0.0f }; // near, far, 1 / resolution, PCF radius
 };
 
+constexpr GLuint kShadowViewsBinding = 4; // ShadowViews block in shadow_multiview.vert
+constexpr float kShadowTimingSmoothing = 0.1f;
+
+using FrustumPlanes = std::array<glm::vec4, 6>;
+
+[[nodiscard]] FrustumPlanes frustumPlanes(const glm::mat4& viewProjection)
+{
+    const glm::mat4 m = glm::transpose(viewProjection);
+    FrustumPlanes planes { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+    for (glm::vec4& plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+    return planes;
+}
+
+// Conservative: false only when the box lies fully outside one plane.
+[[nodiscard]] bool boxIntersectsFrustum(const FrustumPlanes& planes, const glm::vec3& center, const glm::vec3& extent)
+{
+    for (const glm::vec4& plane : planes) {
+        const glm::vec3 normal(plane);
+        if (glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), extent) < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+[[nodiscard]] bool hasGlExtension(std::string_view name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const auto* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension && name == extension)
+            return true;
+    }
+    return false;
+}
+
+[[nodiscard]] float smoothMs(float previous, float sample)
+{
+    return previous <= 0.0f ? sample : previous + (sample - previous) * kShadowTimingSmoothing;
+}
+
 [[nodiscard]] std::string defaultLabel(LightManager::LightType type)
 {
     switch (type) {
@@ -125,6 +171,7 @@ LightManager::~LightManager()
     destroyGpuBuffer();
     destroyShadowResources();
     destroyPointShadowResources();
+    destroyShadowTimingResources();
 }
 
 void LightManager::drawImGui()
@@ -148,11 +195,12 @@ void LightManager::drawImGuiPanel()
 
     // Show lights list like MeshManager
     if (ImGui::BeginListBox("Lights")) {
-        for (int i = 0; i < static_cast<int>(m_lights.size()); ++i) {
-            const Light& light = m_lights[static_cast<std::size_t>(i)];
-            std::string label = light.name.empty()
-                ? defaultLabel(light.type) + "##" + std::to_string(i)
-                : light.name + "##" + std::to_string(i);
+        for (int i = 0; i < static_cast<int>(lightCount()); ++i) {
+            const std::size_t index = static_cast<std::size_t>(i);
+            const std::string& lightName = m_lights.names[index];
+            std::string label = lightName.empty()
+                ? defaultLabel(m_lights.types[index]) + "##" + std::to_string(i)
+                : lightName + "##" + std::to_string(i);
             const bool selected = (i == m_selectedIndex);
             if (ImGui::Selectable(label.c_str(), selected))
                 setSelectedIndex(i);
@@ -163,118 +211,161 @@ void LightManager::drawImGuiPanel()
     }
 
     // Show light details (like "Selected: <name>" section)
-    if (Light* light = selectedLight()) {
+    if (m_selectedIndex >= 0 && m_selectedIndex < static_cast<int>(lightCount())) {
+        const std::size_t index = static_cast<std::size_t>(m_selectedIndex);
+        Light light = this->light(index);
+
         ImGui::Separator();
-        ImGui::Text("Selected: %s", light->name.c_str());
+        ImGui::Text("Selected: %s", light.name.c_str());
         ImGui::SameLine();
-        if (ImGui::Button("Remove Light"))
+        if (ImGui::Button("Remove Light")) {
             removeLight(m_selectedIndex);
+        } else {
+            ImGui::Separator();
 
-        ImGui::Separator();
-
-        ImGui::Checkbox("Enabled", &light->enabled);
-        ImGui::SameLine();
-        ImGui::Checkbox("Cast Shadows", &light->castsShadows);
-        markDirty();
+            bool changed = ImGui::Checkbox("Enabled", &light.enabled);
+            ImGui::SameLine();
+            changed |= ImGui::Checkbox("Cast Shadows", &light.castsShadows);
 
-        ImGui::Separator();
-        ImGui::Text("Light Properties:");
-        drawLightItem(m_selectedIndex, *light);;
+            ImGui::Separator();
+            ImGui::Text("Light Properties:");
+            changed |= drawLightItem(m_selectedIndex, light);
+            if (changed)
+                setLight(index, light);
+        }
     } else {
         ImGui::TextDisabled("No light selected.");
     }
+
+    ImGui::Separator();
+    const UploadStats& upload = m_uploadStats;
+    ImGui::Text("GPU upload: %zu B this frame (%zu lights, %zu ranges)", upload.bytesThisFrame, upload.lightsThisFrame, upload.rangesThisFrame);
+    ImGui::Text("Avg upload: %.0f B/frame | capacity %zu lights | reallocations %u",
+        static_cast<double>(upload.avgBytesPerFrame),
+        upload.capacity,
+        upload.reallocations);
+
+    ImGui::Separator();
+    ImGui::Text("Shadow Rendering:");
+    const bool vertexLayerSupported = m_vertexLayerSupported.value_or(true);
+    int path = static_cast<int>(m_shadowPath);
+    ImGui::RadioButton("Vertex shader layer", &path, static_cast<int>(ShadowPath::VertexLayer));
+    ImGui::SameLine();
+    ImGui::RadioButton("Geometry shader", &path, static_cast<int>(ShadowPath::GeometryShader));
+    m_shadowPath = static_cast<ShadowPath>(path);
+    if (!vertexLayerSupported)
+        ImGui::TextDisabled("gl_Layer from the vertex shader is unsupported; the geometry shader path is used.");
+    constexpr std::array<int, 5> kResolutions { 256, 512, 1024, 2048, 4096 };
+    int resolution = m_shadowResolution;
+    int pcfRadius = m_shadowPcfRadius;
+    bool qualityChanged = false;
+    if (ImGui::BeginCombo("Shadow map resolution", std::to_string(resolution).c_str())) {
+        for (int option : kResolutions) {
+            if (ImGui::Selectable(std::to_string(option).c_str(), option == resolution)) {
+                resolution = option;
+                qualityChanged = true;
+            }
+        }
+        ImGui::EndCombo();
+    }
+    qualityChanged |= ImGui::SliderInt("PCF radius", &pcfRadius, 0, kMaxShadowPcfRadius);
+    if (qualityChanged)
+        setShadowQuality(resolution, pcfRadius);
+    if (ImGui::BeginTable("ShadowPathTimings", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Path");
+        ImGui::TableSetupColumn("GPU ms");
+        ImGui::TableSetupColumn("CPU ms");
+        ImGui::TableSetupColumn("Draws");
+        ImGui::TableSetupColumn("Views");
+        ImGui::TableSetupColumn("Culled");
+        ImGui::TableHeadersRow();
+        constexpr std::array<const char*, 2> kPathNames { "Vertex layer", "Geometry shader" };
+        for (std::size_t i = 0; i < m_shadowPassStats.size(); ++i) {
+            const ShadowPassStats& stats = m_shadowPassStats[i];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(kPathNames[i]);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", static_cast<double>(stats.gpuMs));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", static_cast<double>(stats.cpuMs));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.casterDraws));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.viewInstances));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.viewsCulled));
+        }
+        ImGui::EndTable();
+    }
 }
 
 
-void LightManager::drawLightItem(int index, Light& light)
+bool LightManager::drawLightItem(int index, Light& light)
 {
     ImGui::PushID(index);
+    bool changed = false;
 
     char nameBuffer[64] = {};
     if (!light.name.empty())
         std::snprintf(nameBuffer, sizeof(nameBuffer), "%s", light.name.c_str());
     if (ImGui::InputText("Name", nameBuffer, sizeof(nameBuffer))) {
-        if (ImGui::BeginListBox("Lights")) {
-            for (int i = 0; i < static_cast<int>(m_lights.size());) {
-                Light& light = m_lights[static_cast<std::size_t>(i)];
-                ImGui::PushID(i);
-                std::string label = light.name.empty() ? defaultLabel(light.type) + "##" + std::to_string(i) : light.name + "##" + std::to_string(i);
-                const bool isSelected = (i == m_selectedIndex);
-                if (ImGui::Selectable(label.c_str(), isSelected)) { m_selectedIndex = i; }
-                if (isSelected)
-                    ImGui::SetItemDefaultFocus();
-                ImGui::PopID();
-                ++i;
-            }
-            ImGui::EndListBox();
-        }
-
-        // Per-light quick toggles and actions under the list, for the selected light
-        if (m_selectedIndex >= 0 && m_selectedIndex < static_cast<int>(m_lights.size())) {
-            Light& light = m_lights[static_cast<std::size_t>(m_selectedIndex)];
-            bool enabled = light.enabled;
-            if (ImGui::Checkbox("Enabled", &enabled)) { light.enabled = enabled; markDirty(); }
-            ImGui::SameLine();
-            if (ImGui::SmallButton("Remove")) {
-                removeLight(m_selectedIndex);
-                if (m_selectedIndex >= static_cast<int>(m_lights.size()))
-                    m_selectedIndex = static_cast<int>(m_lights.size()) - 1;
-            }
-        }
+        light.name = nameBuffer;
+        changed = true;
     }
 
     if (ImGui::ColorEdit3("Color", glm::value_ptr(light.color))) {
         light.color = glm::clamp(light.color, glm::vec3(0.0f), glm::vec3(10.0f));
-        markDirty();
+        changed = true;
     }
     if (ImGui::SliderFloat("Intensity", &light.intensity, 0.0f, 10.0f)) {
         light.intensity = std::max(light.intensity, 0.0f);
-        markDirty();
+        changed = true;
     }
 
     bool useAttenuation = light.useAttenuation;
     if (ImGui::Checkbox("Use attenuation", &useAttenuation)) {
         light.useAttenuation = useAttenuation;
-        markDirty();
+        changed = true;
     }
 
     switch (light.type) {
     case LightType::Point: {
         if (ImGui::DragFloat3("Position", glm::value_ptr(light.position), 0.05f)) {
-            markDirty();
+            changed = true;
         }
         ImGui::BeginDisabled(!light.useAttenuation);
         if (ImGui::DragFloat("Range", &light.range, 0.1f, kMinRange, 200.0f)) {
             light.range = std::max(light.range, kMinRange);
-            markDirty();
+            changed = true;
         }
         ImGui::EndDisabled();
         break;
     }
     case LightType::Spot: {
         if (ImGui::DragFloat3("Position", glm::value_ptr(light.position), 0.05f)) {
-            markDirty();
+            changed = true;
         }
         glm::vec3 dir = light.direction;
         if (ImGui::DragFloat3("Direction", glm::value_ptr(dir), 0.01f, -1.0f, 1.0f)) {
             light.direction = sanitizeDirection(dir);
-            markDirty();
+            changed = true;
         }
         ImGui::BeginDisabled(!light.useAttenuation);
         if (ImGui::DragFloat("Range", &light.range, 0.1f, kMinRange, 200.0f)) {
             light.range = std::max(light.range, kMinRange);
-            markDirty();
+            changed = true;
         }
         ImGui::EndDisabled();
         float inner = light.innerConeDegrees;
         float outer = light.outerConeDegrees;
         if (ImGui::SliderFloat("Inner Cone", &inner, 0.0f, outer - 0.1f)) {
             light.innerConeDegrees = std::clamp(inner, 0.0f, outer - 0.1f);
-            markDirty();
+            changed = true;
         }
         if (ImGui::SliderFloat("Outer Cone", &outer, std::max(light.innerConeDegrees + 0.1f, kMinOuterCone), kMaxOuterCone)) {
             light.outerConeDegrees = std::clamp(outer, light.innerConeDegrees + 0.1f, kMaxOuterCone);
-            markDirty();
+            changed = true;
         }
         break;
     }
@@ -290,113 +381,392 @@ void LightManager::drawLightItem(int index, Light& light)
         light.attenuationConstant = std::max(attenuationValues[0], 0.0f);
         light.attenuationLinear = std::max(attenuationValues[1], 0.0f);
         light.attenuationQuadratic = std::max(attenuationValues[2], 0.0f);
-        markDirty();
+        changed = true;
     }
     ImGui::EndDisabled();
 
     if (ImGui::DragFloat("Shadow Bias", &light.shadowBias, 0.0001f, 0.0f, 0.05f)) {
-        markDirty();
+        changed = true;
     }
     if (ImGui::DragFloat("Shadow Near", &light.shadowNearPlane, 0.01f, 0.01f, light.shadowFarPlane - 0.1f)) {
         light.shadowNearPlane = std::max(light.shadowNearPlane, 0.01f);
-        markDirty();
+        changed = true;
     }
     if (ImGui::DragFloat("Shadow Far", &light.shadowFarPlane, 0.1f, light.shadowNearPlane + 0.1f, 300.0f)) {
         light.shadowFarPlane = std::max(light.shadowFarPlane, light.shadowNearPlane + 0.1f);
-        markDirty();
+        changed = true;
     }
 
     ImGui::PopID();
+    return changed;
 }
 
-void LightManager::updateGpuData()
+void LightManager::LightStorage::push(const Light& light)
 {
-    if (m_gpuDirty)
-        rebuildGpuBuffer();
+    positions.push_back(light.position);
+    directions.push_back(light.direction);
+    colors.push_back(light.color);
+    intensities.push_back(light.intensity);
+    enabled.push_back(light.enabled ? 1 : 0);
+    types.push_back(light.type);
+    ranges.push_back(light.range);
+    cones.emplace_back(light.innerConeDegrees, light.outerConeDegrees);
+    attenuation.emplace_back(light.attenuationConstant, light.attenuationLinear, light.attenuationQuadratic, light.useAttenuation ? 1.0f : 0.0f);
+    shadowParams.emplace_back(light.shadowBias, light.shadowNearPlane, light.shadowFarPlane);
+    castsShadows.push_back(light.castsShadows ? 1 : 0);
+    names.push_back(light.name);
 }
 
-void LightManager::rebuildGpuBuffer()
+void LightManager::LightStorage::erase(std::size_t index)
 {
-    std::vector<GpuLight> gpuLights;
-    gpuLights.reserve(m_lights.size());
+    const auto offset = static_cast<std::ptrdiff_t>(index);
+    positions.erase(positions.begin() + offset);
+    directions.erase(directions.begin() + offset);
+    colors.erase(colors.begin() + offset);
+    intensities.erase(intensities.begin() + offset);
+    enabled.erase(enabled.begin() + offset);
+    types.erase(types.begin() + offset);
+    ranges.erase(ranges.begin() + offset);
+    cones.erase(cones.begin() + offset);
+    attenuation.erase(attenuation.begin() + offset);
+    shadowParams.erase(shadowParams.begin() + offset);
+    castsShadows.erase(castsShadows.begin() + offset);
+    names.erase(names.begin() + offset);
+}
 
-    for (std::size_t i = 0; i < m_lights.size(); ++i) {
-        const Light& light = m_lights[i];
-        if (!light.enabled)
-            continue;
+LightManager::Light LightManager::light(std::size_t index) const
+{
+    Light light;
+    light.type = m_lights.types[index];
+    light.name = m_lights.names[index];
+    light.enabled = m_lights.enabled[index] != 0;
+    light.castsShadows = m_lights.castsShadows[index] != 0;
+    light.color = m_lights.colors[index];
+    light.intensity = m_lights.intensities[index];
+    const glm::vec4& attenuation = m_lights.attenuation[index];
+    light.useAttenuation = attenuation.w > 0.5f;
+    light.attenuationConstant = attenuation.x;
+    light.attenuationLinear = attenuation.y;
+    light.attenuationQuadratic = attenuation.z;
+    light.position = m_lights.positions[index];
+    light.direction = m_lights.directions[index];
+    light.range = m_lights.ranges[index];
+    light.innerConeDegrees = m_lights.cones[index].x;
+    light.outerConeDegrees = m_lights.cones[index].y;
+    light.shadowBias = m_lights.shadowParams[index].x;
+    light.shadowNearPlane = m_lights.shadowParams[index].y;
+    light.shadowFarPlane = m_lights.shadowParams[index].z;
+    return light;
+}
 
-        GpuLight gpu;
-        gpu.positionType = glm::vec4(light.position, typeValue(light.type));
-        glm::vec3 dir = sanitizeDirection(light.direction);
-        const float range = std::max(light.range, kMinRange);
-        switch (light.type) {
-        case LightType::Point:
-            gpu.directionRange = glm::vec4(0.0f, 0.0f, 0.0f, range);
-            break;
-        case LightType::Spot:
-            gpu.directionRange = glm::vec4(dir, range);
-            break;
-        }
-        gpu.colorIntensity = glm::vec4(light.color * light.intensity, light.intensity);
+void LightManager::setLight(std::size_t index, const Light& light)
+{
+    if (index >= lightCount())
+        return;
+
+    // Same invalidation as setEnabled: enabling or disabling a light changes the shadow layer set.
+    if (m_lights.castsShadows[index] != (light.castsShadows ? 1 : 0) || m_lights.types[index] != light.type
+        || m_lights.enabled[index] != (light.enabled ? 1 : 0))
+        m_shadowResourcesDirty = true;
+
+    m_lights.types[index] = light.type;
+    m_lights.names[index] = light.name;
+    m_lights.enabled[index] = light.enabled ? 1 : 0;
+    m_lights.castsShadows[index] = light.castsShadows ? 1 : 0;
+    m_lights.colors[index] = light.color;
+    m_lights.intensities[index] = light.intensity;
+    m_lights.attenuation[index] = glm::vec4(light.attenuationConstant, light.attenuationLinear, light.attenuationQuadratic, light.useAttenuation ? 1.0f : 0.0f);
+    m_lights.positions[index] = light.position;
+    m_lights.directions[index] = light.direction;
+    m_lights.ranges[index] = light.range;
+    m_lights.cones[index] = glm::vec2(light.innerConeDegrees, light.outerConeDegrees);
+    m_lights.shadowParams[index] = glm::vec3(light.shadowBias, light.shadowNearPlane, light.shadowFarPlane);
+    markLightDirty(index);
+}
+
+void LightManager::setEnabled(std::size_t index, bool enabled)
+{
+    const std::uint8_t value = enabled ? 1 : 0;
+    if (index >= lightCount() || m_lights.enabled[index] == value)
+        return;
+    m_lights.enabled[index] = value;
+    m_shadowResourcesDirty = true;
+    markLightDirty(index);
+}
+
+void LightManager::setPosition(std::size_t index, const glm::vec3& position)
+{
+    if (index >= lightCount())
+        return;
+    m_lights.positions[index] = position;
+    markLightDirty(index);
+}
 
-        float innerCos = radiansClamp(std::min(light.innerConeDegrees, light.outerConeDegrees - 0.1f));
-        float outerCos = radiansClamp(light.outerConeDegrees);
-        int shadowLayer = (i < m_shadowLayerForLight.size()) ? m_shadowLayerForLight[i] : -1;
-        if (shadowLayer < 0)
-            shadowLayer = -1;
-        gpu.spotShadow = glm::vec4(innerCos, outerCos, static_cast<float>(shadowLayer), light.castsShadows ? 1.0f : 0.0f);
-        gpu.shadowParams = glm::vec4(light.shadowBias, light.shadowNearPlane, light.shadowFarPlane, shadowLayer >= 0 ? 1.0f : 0.0f);
-        gpu.attenuation = glm::vec4(
-            std::max(light.attenuationConstant, 0.0f),
-            std::max(light.attenuationLinear, 0.0f),
-            std::max(light.attenuationQuadratic, 0.0f),
-            light.useAttenuation ? 1.0f : 0.0f);
-        gpu.extra = glm::vec4(range, 0.0f, 0.0f, 0.0f);
+void LightManager::setDirection(std::size_t index, const glm::vec3& direction)
+{
+    if (index >= lightCount())
+        return;
+    m_lights.directions[index] = sanitizeDirection(direction);
+    markLightDirty(index);
+}
+
+void LightManager::setColor(std::size_t index, const glm::vec3& color, float intensity)
+{
+    if (index >= lightCount())
+        return;
+    m_lights.colors[index] = color;
+    m_lights.intensities[index] = std::max(intensity, 0.0f);
+    markLightDirty(index);
+}
+
+void LightManager::setPositions(std::span<const std::uint32_t> indices, std::span<const glm::vec3> positions)
+{
+    assert(indices.size() == positions.size());
+    const std::size_t count = std::min(indices.size(), positions.size());
+    for (std::size_t i = 0; i < count; ++i)
+        setPosition(indices[i], positions[i]);
+}
+
+void LightManager::setDirections(std::span<const std::uint32_t> indices, std::span<const glm::vec3> directions)
+{
+    assert(indices.size() == directions.size());
+    const std::size_t count = std::min(indices.size(), directions.size());
+    for (std::size_t i = 0; i < count; ++i)
+        setDirection(indices[i], directions[i]);
+}
 
-        gpuLights.push_back(gpu);
+void LightManager::setColors(std::span<const std::uint32_t> indices, std::span<const glm::vec3> colors, std::span<const float> intensities)
+{
+    assert(indices.size() == colors.size() && indices.size() == intensities.size());
+    const std::size_t count = std::min({ indices.size(), colors.size(), intensities.size() });
+    for (std::size_t i = 0; i < count; ++i)
+        setColor(indices[i], colors[i], intensities[i]);
+}
+
+void LightManager::updateGpuData()
+{
+    m_uploadStats.bytesThisFrame = 0;
+    m_uploadStats.rangesThisFrame = 0;
+    m_uploadStats.lightsThisFrame = 0;
+
+    const std::size_t count = lightCount();
+    m_lightDirty.resize(count, 1);
+
+    // Shadow layers are reassigned every shadow pass; only lights whose layer moved need a re-upload.
+    m_uploadedShadowLayers.resize(count, -1);
+    for (std::size_t i = 0; i < count; ++i) {
+        const int layer = i < m_shadowLayerForLight.size() ? m_shadowLayerForLight[i] : -1;
+        if (layer != m_uploadedShadowLayers[i]) {
+            m_uploadedShadowLayers[i] = layer;
+            m_lightDirty[i] = 1;
+        }
     }
 
-    if (m_lightBuffer == 0)
-        glGenBuffers(1, &m_lightBuffer);
+    if (count > 0) {
+        ensureGpuCapacity(count);
+        if (m_gpuDirty)
+            std::fill(m_lightDirty.begin(), m_lightDirty.end(), 1);
+        uploadDirtyLights();
+    }
+    m_gpuDirty = false;
+
+    // An all-disabled scene reports zero lights so the shaders keep using their fallback light.
+    const bool anyEnabled = std::any_of(m_lights.enabled.begin(), m_lights.enabled.end(), [](std::uint8_t value) { return value != 0; });
+    m_gpuBinding.lightSSBO = anyEnabled ? m_lightBuffer : 0;
+    m_gpuBinding.lightCount = anyEnabled ? static_cast<int>(count) : 0;
+
+    constexpr float kAverageWeight = 1.0f / 60.0f;
+    m_uploadStats.avgBytesPerFrame += (static_cast<float>(m_uploadStats.bytesThisFrame) - m_uploadStats.avgBytesPerFrame) * kAverageWeight;
+    m_uploadStats.capacity = m_gpuCapacity;
+}
+
+void LightManager::ensureGpuCapacity(std::size_t requiredLights)
+{
+    if (requiredLights <= m_gpuCapacity && m_lightBuffer != 0)
+        return;
+
+    constexpr std::size_t kMinCapacity = 64;
+    const std::size_t capacity = std::max({ requiredLights, m_gpuCapacity * 2, kMinCapacity });
+    const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    destroyGpuBuffer();
 
+    glGenBuffers(1, &m_lightBuffer);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_lightBuffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER,
-        static_cast<GLsizeiptr>(gpuLights.size() * sizeof(GpuLight)),
-        gpuLights.empty() ? nullptr : gpuLights.data(),
-        GL_DYNAMIC_DRAW);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(capacity * sizeof(GpuLight)), nullptr, 0);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
-    m_gpuBinding.lightSSBO = gpuLights.empty() ? 0 : m_lightBuffer;
-    m_gpuBinding.lightCount = static_cast<int>(gpuLights.size());
+    glGenBuffers(1, &m_stagingBuffer);
+    glBindBuffer(GL_COPY_READ_BUFFER, m_stagingBuffer);
+    const auto stagingSize = static_cast<GLsizeiptr>(kStagingSegments * capacity * sizeof(GpuLight));
+    glBufferStorage(GL_COPY_READ_BUFFER, stagingSize, nullptr, mapFlags);
+    m_stagingMapped = static_cast<GpuLight*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, stagingSize, mapFlags));
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    if (m_stagingMapped == nullptr)
+        LOG_ERROR(logging::Category::OpenGL, "[LightManager] Failed to map light staging buffer ({} lights)", capacity);
 
-    m_gpuDirty = false;
+    m_gpuCapacity = capacity;
+    m_gpuDirty = true;
+    ++m_uploadStats.reallocations;
+}
+
+void LightManager::uploadDirtyLights()
+{
+    if (m_stagingMapped == nullptr)
+        return;
+
+    // Dirty runs separated by a small gap are merged; a few extra lights are cheaper than another copy.
+    constexpr std::size_t kMergeGap = 4;
+    struct Range {
+        std::size_t begin;
+        std::size_t end;
+    };
+    std::vector<Range> ranges;
+    const std::size_t count = lightCount();
+    for (std::size_t i = 0; i < count; ++i) {
+        if (m_lightDirty[i] == 0)
+            continue;
+        if (!ranges.empty() && i - ranges.back().end <= kMergeGap)
+            ranges.back().end = i + 1;
+        else
+            ranges.push_back({ i, i + 1 });
+        m_lightDirty[i] = 0;
+    }
+    if (ranges.empty())
+        return;
+
+    // The segment written now may still be the copy source of a frame the GPU has not finished:
+    // block until its fence signals, however long that takes.
+    GLsync& fence = m_stagingFences[m_stagingSegment];
+    if (fence != nullptr) {
+        constexpr GLuint64 kFenceTimeoutNs = 100'000'000;
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeoutNs);
+        while (status == GL_TIMEOUT_EXPIRED) {
+            LOG_WARNING(logging::Category::OpenGL, "[LightManager] Light staging segment {} still in use after {} ms, waiting",
+                m_stagingSegment, kFenceTimeoutNs / 1'000'000);
+            status = glClientWaitSync(fence, 0, kFenceTimeoutNs);
+        }
+        if (status == GL_WAIT_FAILED) {
+            // The segment's state is unknown: leave it alone and retry these lights next frame.
+            LOG_ERROR(logging::Category::OpenGL, "[LightManager] Waiting on light staging fence failed, deferring the upload");
+            for (const Range& range : ranges)
+                std::fill(m_lightDirty.begin() + static_cast<std::ptrdiff_t>(range.begin), m_lightDirty.begin() + static_cast<std::ptrdiff_t>(range.end), std::uint8_t { 1 });
+            return;
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    const std::size_t segmentBase = m_stagingSegment * m_gpuCapacity;
+    GpuLight* segment = m_stagingMapped + segmentBase;
+
+    glBindBuffer(GL_COPY_READ_BUFFER, m_stagingBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_lightBuffer);
+    for (const Range& range : ranges) {
+        for (std::size_t i = range.begin; i < range.end; ++i)
+            segment[i] = packGpuLight(i);
+
+        const std::size_t bytes = (range.end - range.begin) * sizeof(GpuLight);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER,
+            GL_COPY_WRITE_BUFFER,
+            static_cast<GLintptr>((segmentBase + range.begin) * sizeof(GpuLight)),
+            static_cast<GLintptr>(range.begin * sizeof(GpuLight)),
+            static_cast<GLsizeiptr>(bytes));
+        m_uploadStats.bytesThisFrame += bytes;
+        m_uploadStats.lightsThisFrame += range.end - range.begin;
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    m_uploadStats.rangesThisFrame = ranges.size();
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_stagingSegment = (m_stagingSegment + 1) % kStagingSegments;
+}
+
+LightManager::GpuLight LightManager::packGpuLight(std::size_t index) const
+{
+    const LightType type = m_lights.types[index];
+    const float range = std::max(m_lights.ranges[index], kMinRange);
+    const glm::vec2 cones = m_lights.cones[index];
+    const glm::vec3 shadow = m_lights.shadowParams[index];
+    const glm::vec4 attenuation = m_lights.attenuation[index];
+    const bool castsShadows = m_lights.castsShadows[index] != 0;
+
+    GpuLight gpu;
+    gpu.positionType = glm::vec4(m_lights.positions[index], typeValue(type));
+    switch (type) {
+    case LightType::Point:
+        gpu.directionRange = glm::vec4(0.0f, 0.0f, 0.0f, range);
+        break;
+    case LightType::Spot:
+        gpu.directionRange = glm::vec4(sanitizeDirection(m_lights.directions[index]), range);
+        break;
+    }
+    const float intensity = m_lights.intensities[index];
+    gpu.colorIntensity = glm::vec4(m_lights.colors[index] * intensity, intensity);
+
+    float innerCos = radiansClamp(std::min(cones.x, cones.y - 0.1f));
+    float outerCos = radiansClamp(cones.y);
+    int shadowLayer = (index < m_shadowLayerForLight.size()) ? m_shadowLayerForLight[index] : -1;
+    if (shadowLayer < 0)
+        shadowLayer = -1;
+    gpu.spotShadow = glm::vec4(innerCos, outerCos, static_cast<float>(shadowLayer), castsShadows ? 1.0f : 0.0f);
+    gpu.shadowParams = glm::vec4(shadow.x, shadow.y, shadow.z, shadowLayer >= 0 ? 1.0f : 0.0f);
+    gpu.attenuation = glm::vec4(
+        std::max(attenuation.x, 0.0f),
+        std::max(attenuation.y, 0.0f),
+        std::max(attenuation.z, 0.0f),
+        attenuation.w);
+    // GPU slots mirror light indices, so disabled lights stay in the buffer and are skipped via extra.y.
+    gpu.extra = glm::vec4(range, m_lights.enabled[index] != 0 ? 1.0f : 0.0f, 0.0f, 0.0f);
+    return gpu;
 }
 
 void LightManager::destroyGpuBuffer()
 {
+    for (GLsync& fence : m_stagingFences) {
+        if (fence != nullptr) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (m_stagingBuffer != 0) {
+        if (m_stagingMapped != nullptr) {
+            glBindBuffer(GL_COPY_READ_BUFFER, m_stagingBuffer);
+            glUnmapBuffer(GL_COPY_READ_BUFFER);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+        glDeleteBuffers(1, &m_stagingBuffer);
+        m_stagingBuffer = 0;
+    }
+    m_stagingMapped = nullptr;
+    m_stagingSegment = 0;
     if (m_lightBuffer != 0) {
         glDeleteBuffers(1, &m_lightBuffer);
         m_lightBuffer = 0;
     }
-    m_gpuBinding = {};
+    m_gpuCapacity = 0;
+    m_gpuBinding.lightSSBO = 0;
+    m_gpuBinding.lightCount = 0;
     m_gpuDirty = true;
 }
 
 void LightManager::ensureDefaultLight()
 {
-    if (!m_lights.empty())
+    if (lightCount() != 0)
         return;
 
-    Light& light = addLight(LightType::Point);
+    const std::size_t index = addLight(LightType::Point);
+    Light light = this->light(index);
     light.position = glm::vec3(0.0f, 4.0f, 0.0f);
     light.range = 12.0f;
     light.intensity = 1.0f;
     light.castsShadows = false;
-    markDirty();
+    setLight(index, light);
     ensureShadowLayerMapping();
 }
 
-LightManager::Light& LightManager::addLight(LightType type)
+std::size_t LightManager::addLight(LightType type)
 {
     Light light;
     light.type = type;
@@ -419,27 +789,33 @@ LightManager::Light& LightManager::addLight(LightType type)
         break;
     }
 
-    m_lights.push_back(light);
+    m_lights.push(light);
+    m_lightDirty.push_back(1);
     m_shadowLayerForLight.push_back(-1);
-    m_selectedIndex = static_cast<int>(m_lights.size()) - 1;
-    markDirty();
-    return m_lights.back();
+    m_selectedIndex = static_cast<int>(lightCount()) - 1;
+    m_shadowResourcesDirty = true;
+    return lightCount() - 1;
 }
 
 void LightManager::removeLight(int index)
 {
-    if (index < 0 || index >= static_cast<int>(m_lights.size()))
+    if (index < 0 || index >= static_cast<int>(lightCount()))
         return;
 
-    m_lights.erase(m_lights.begin() + index);
-    if (index >= 0 && index < static_cast<int>(m_shadowLayerForLight.size()))
+    m_lights.erase(static_cast<std::size_t>(index));
+    // Per-light bookkeeping is indexed like the SoA arrays and must shift along with them.
+    if (index < static_cast<int>(m_shadowLayerForLight.size()))
         m_shadowLayerForLight.erase(m_shadowLayerForLight.begin() + index);
+    if (index < static_cast<int>(m_lightDirty.size()))
+        m_lightDirty.erase(m_lightDirty.begin() + index);
+    if (index < static_cast<int>(m_uploadedShadowLayers.size()))
+        m_uploadedShadowLayers.erase(m_uploadedShadowLayers.begin() + index);
 
-    if (m_selectedIndex >= static_cast<int>(m_lights.size()))
-        m_selectedIndex = static_cast<int>(m_lights.size()) - 1;
+    if (m_selectedIndex >= static_cast<int>(lightCount()))
+        m_selectedIndex = static_cast<int>(lightCount()) - 1;
 
     // Allow exactly 0 lights in the system
-    if (m_lights.empty())
+    if (lightCount() == 0)
         m_selectedIndex = -1;
 
     markDirty();
@@ -449,56 +825,36 @@ void LightManager::removeLight(int index)
 
 void LightManager::setSelectedIndex(int index)
 {
-    if (index < 0 || index >= static_cast<int>(m_lights.size())) {
+    if (index < 0 || index >= static_cast<int>(lightCount())) {
         m_selectedIndex = -1;
         return;
     }
     m_selectedIndex = index;
 }
 
-LightManager::Light* LightManager::selectedLight()
+int LightManager::findLightIndex(const std::string& name) const
 {
-    if (m_selectedIndex < 0 || m_selectedIndex >= static_cast<int>(m_lights.size()))
-        return nullptr;
-    return &m_lights[static_cast<std::size_t>(m_selectedIndex)];
+    auto it = std::find(m_lights.names.begin(), m_lights.names.end(), name);
+    if (it == m_lights.names.end())
+        return -1;
+    return static_cast<int>(std::distance(m_lights.names.begin(), it));
 }
 
-LightManager::Light* LightManager::findLightByName(const std::string& name)
+std::size_t LightManager::ensureLight(const std::string& name, LightType type)
 {
-    auto it = std::find_if(m_lights.begin(), m_lights.end(), [&name](const Light& light) {
-        return light.name == name;
-    });
-    if (it == m_lights.end())
-        return nullptr;
-    return &(*it);
-}
+    const int existing = findLightIndex(name);
+    if (existing >= 0)
+        return static_cast<std::size_t>(existing);
 
-const LightManager::Light* LightManager::findLightByName(const std::string& name) const
-{
-    auto it = std::find_if(m_lights.begin(), m_lights.end(), [&name](const Light& light) {
-        return light.name == name;
-    });
-    if (it == m_lights.end())
-        return nullptr;
-    return &(*it);
+    const std::size_t index = addLight(type);
+    m_lights.names[index] = name;
+    return index;
 }
 
-LightManager::Light& LightManager::ensureLight(const std::string& name, LightType type)
+void LightManager::markLightDirty(std::size_t index)
 {
-    if (Light* existing = findLightByName(name))
-        return *existing;
-
-    Light& light = addLight(type);
-    light.name = name;
-    markDirty();
-    return light;
-}
-
-const LightManager::Light* LightManager::selectedLight() const
-{
-    if (m_selectedIndex < 0 || m_selectedIndex >= static_cast<int>(m_lights.size()))
-        return nullptr;
-    return &m_lights[static_cast<std::size_t>(m_selectedIndex)];
+    if (index < m_lightDirty.size())
+        m_lightDirty[index] = 1;
 }
 
 void LightManager::markDirty()
@@ -517,9 +873,9 @@ glm::vec3 LightManager::sanitizeDirection(const glm::vec3& dir)
 
 void LightManager::ensureShadowLayerMapping()
 {
-    if (m_shadowLayerForLight.size() != m_lights.size()) {
+    if (m_shadowLayerForLight.size() != lightCount()) {
         std::size_t previousSize = m_shadowLayerForLight.size();
-        m_shadowLayerForLight.resize(m_lights.size(), -1);
+        m_shadowLayerForLight.resize(lightCount(), -1);
         if (m_shadowLayerForLight.size() != previousSize)
             m_shadowResourcesDirty = true;
     }
@@ -538,21 +894,34 @@ void LightManager::ensureShadowShader()
     m_shadowShaderReady = true;
 }
 
-void LightManager::ensurePointShadowInstancedShader()
+void LightManager::ensureMultiViewShadowShader()
 {
-    if (m_pointShadowInstancedShaderReady)
+    if (m_multiViewShadowShaderReady)
         return;
 
     ShaderBuilder builder;
-    builder.addStage(GL_VERTEX_SHADER, RESOURCE_ROOT "shaders/shadow_point_instanced.vert");
-    builder.addStage(GL_GEOMETRY_SHADER, RESOURCE_ROOT "shaders/shadow_point_instanced.geom");
-    m_pointShadowInstancedShader = builder.build();
-    m_pointShadowModelLocation = m_pointShadowInstancedShader.getUniformLocation("uModel");
+    builder.addStage(GL_VERTEX_SHADER, RESOURCE_ROOT "shaders/shadow_multiview.vert");
+    builder.addStage(GL_FRAGMENT_SHADER, RESOURCE_ROOT "shaders/shadow_frag.glsl");
+    m_multiViewShadowShader = builder.build();
+    m_multiViewModelLocation = m_multiViewShadowShader.getUniformLocation("uModel");
+    m_multiViewMaskLocation = m_multiViewShadowShader.getUniformLocation("uViewMask");
 
-    if (m_pointShadowViewProjUBO == 0)
-        glGenBuffers(1, &m_pointShadowViewProjUBO);
+    if (m_shadowViewsUBO == 0) {
+        glCreateBuffers(1, &m_shadowViewsUBO);
+        glNamedBufferStorage(m_shadowViewsUBO, static_cast<GLsizeiptr>(kMaxShadowLights * sizeof(glm::mat4)), nullptr, GL_DYNAMIC_STORAGE_BIT);
+    }
 
-    m_pointShadowInstancedShaderReady = true;
+    m_multiViewShadowShaderReady = true;
+}
+
+bool LightManager::vertexLayerShadowsSupported()
+{
+    if (!m_vertexLayerSupported) {
+        m_vertexLayerSupported = hasGlExtension("GL_ARB_shader_viewport_layer_array") || hasGlExtension("GL_AMD_vertex_shader_layer");
+        if (!*m_vertexLayerSupported)
+            LOG_INFO(logging::Category::General, "[Shadows] gl_Layer is not writable from vertex shaders; using the geometry shader path");
+    }
+    return *m_vertexLayerSupported;
 }
 
 bool LightManager::isShadowCasterSupported(const Light& light) const
@@ -615,8 +984,8 @@ void LightManager::ensureShadowResources(std::size_t casterCount)
         glTexImage3D(GL_TEXTURE_2D_ARRAY,
             0,
             GL_DEPTH_COMPONENT24,
-            kShadowMapResolution,
-            kShadowMapResolution,
+            m_shadowResolution,
+            m_shadowResolution,
             static_cast<GLsizei>(casterCount),
             0,
             GL_DEPTH_COMPONENT,
@@ -663,8 +1032,8 @@ void LightManager::ensurePointShadowResources(std::size_t casterCount)
                 glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face,
                     0,
                     GL_DEPTH_COMPONENT32F,
-                    kShadowMapResolution,
-                    kShadowMapResolution,
+                    m_shadowResolution,
+                    m_shadowResolution,
                     0,
                     GL_DEPTH_COMPONENT,
                     GL_FLOAT,
@@ -755,6 +1124,31 @@ void LightManager::ensurePointShadowFallbackTexture()
     glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 }
 
+void LightManager::setShadowQuality(int resolution, int pcfRadius)
+{
+    m_shadowPcfRadius = std::clamp(pcfRadius, 0, kMaxShadowPcfRadius);
+    resolution = std::clamp(resolution, kMinShadowMapResolution, kMaxShadowMapResolution);
+    if (resolution == m_shadowResolution)
+        return;
+
+    m_shadowResolution = resolution;
+    if (m_shadowMapArray != 0) {
+        glDeleteTextures(1, &m_shadowMapArray);
+        m_shadowMapArray = 0;
+    }
+    m_shadowArrayLayers = 0;
+    if (!m_pointShadowCubemaps.empty()) {
+        glDeleteTextures(static_cast<GLsizei>(m_pointShadowCubemaps.size()), m_pointShadowCubemaps.data());
+        m_pointShadowCubemaps.clear();
+    }
+    m_gpuBinding.directionalShadowTexture = 0;
+    m_gpuBinding.pointShadowTextures.fill(0);
+    m_shadowResourcesDirty = true;
+    m_pointShadowResourcesDirty = true;
+    m_shadowDebugDirty = true;
+    destroyShadowDebugResources();
+}
+
 void LightManager::destroyShadowResources()
 {
     if (m_shadowFramebuffer != 0) {
@@ -796,13 +1190,14 @@ void LightManager::destroyPointShadowResources()
         glDeleteTextures(1, &m_pointShadowDummyTexture);
         m_pointShadowDummyTexture = 0;
     }
-    if (m_pointShadowViewProjUBO != 0) {
-        glDeleteBuffers(1, &m_pointShadowViewProjUBO);
-        m_pointShadowViewProjUBO = 0;
+    if (m_shadowViewsUBO != 0) {
+        glDeleteBuffers(1, &m_shadowViewsUBO);
+        m_shadowViewsUBO = 0;
     }
-    m_pointShadowInstancedShader = Shader();
-    m_pointShadowInstancedShaderReady = false;
-    m_pointShadowModelLocation = -1;
+    m_multiViewShadowShader = Shader();
+    m_multiViewShadowShaderReady = false;
+    m_multiViewModelLocation = -1;
+    m_multiViewMaskLocation = -1;
     m_pointShadowEntries.clear();
     m_pointShadowResourcesDirty = true;
     m_gpuBinding.pointShadowCount = 0;
@@ -1004,9 +1399,9 @@ void LightManager::drawShadowDebugPanel()
     labels.reserve(m_shadowDebugLayers.size());
     for (const ShadowDebugLayer& layer : m_shadowDebugLayers) {
         std::string name;
-        if (layer.lightIndex >= 0 && layer.lightIndex < static_cast<int>(m_lights.size())) {
-            const Light& light = m_lights[static_cast<std::size_t>(layer.lightIndex)];
-            name = light.name.empty() ? defaultLabel(light.type) : light.name;
+        if (layer.lightIndex >= 0 && layer.lightIndex < static_cast<int>(lightCount())) {
+            const std::size_t lightIndex = static_cast<std::size_t>(layer.lightIndex);
+            name = m_lights.names[lightIndex].empty() ? defaultLabel(m_lights.types[lightIndex]) : m_lights.names[lightIndex];
         } else {
             name = "Layer " + std::to_string(layer.layerIndex);
         }
@@ -1031,12 +1426,12 @@ void LightManager::drawShadowDebugPanel()
     }
 
     const ShadowDebugLayer& layer = m_shadowDebugLayers[static_cast<std::size_t>(m_shadowDebugSelectedLayer)];
-    const Light* light = (layer.lightIndex >= 0 && layer.lightIndex < static_cast<int>(m_lights.size()))
-        ? &m_lights[static_cast<std::size_t>(layer.lightIndex)]
+    const std::string* lightName = (layer.lightIndex >= 0 && layer.lightIndex < static_cast<int>(lightCount()))
+        ? &m_lights.names[static_cast<std::size_t>(layer.lightIndex)]
         : nullptr;
 
     ImGui::Separator();
-    ImGui::Text("Light: %s", light ? light->name.c_str() : "Unassigned");
+    ImGui::Text("Light: %s", lightName ? lightName->c_str() : "Unassigned");
     ImGui::Text("Type: %s", layer.type == LightType::Spot ? "Spot" : "Point");
     ImGui::Text("Near/Far: %.2f / %.2f", static_cast<double>(layer.nearPlane), static_cast<double>(layer.farPlane));
     ImGui::Text("Bias: %.5f", static_cast<double>(layer.bias));
@@ -1136,10 +1531,18 @@ void LightManager::renderShadowGeometry(bool layeredPass,
     for (MeshInstance& instance : instances) {
         const glm::mat4& instanceTransform = instance.transform();
         for (MeshDrawItem& item : instance.drawItems()) {
+            if (!item.geometry.resident())
+                continue;
             const glm::mat4 model = instanceTransform * item.nodeTransform;
             if (locModel >= 0)
                 glUniformMatrix4fv(locModel, 1, GL_FALSE, glm::value_ptr(model));
-            item.geometry.draw(m_shadowShader);
+            if (m_meshletCuller)
+                m_meshletCuller->draw(item, model);
+            else
+                item.geometry.draw(m_shadowShader);
+            // The geometry shader emits every triangle into every layer.
+            ++m_currentShadowPass.casterDraws;
+            m_currentShadowPass.viewInstances += static_cast<std::uint64_t>(pointPass ? 1 : std::max(shadowLayerCount, 1));
         }
     }
 
@@ -1159,9 +1562,8 @@ void LightManager::uploadShadowMatrices(const ShadowEntry* entries, int layerCou
     for (int i = 0; i < count; ++i) {
         const ShadowEntry& entry = entries[i];
         uniformData[static_cast<std::size_t>(i)].matrix = entry.projectionMatrix * entry.viewMatrix;
-        const float invResolution = 1.0f / static_cast<float>(kShadowMapResolution);
-        const float typeValue = (entry.type == LightType::Spot) ? 1.0f : 0.0f;
-        uniformData[static_cast<std::size_t>(i)].params = glm::vec4(entry.nearPlane, entry.farPlane, invResolution, typeValue);
+        const float invResolution = 1.0f / static_cast<float>(m_shadowResolution);
+        uniformData[static_cast<std::size_t>(i)].params = glm::vec4(entry.nearPlane, entry.farPlane, invResolution, static_cast<float>(m_shadowPcfRadius));
     }
 
     glBindBuffer(GL_UNIFORM_BUFFER, m_shadowMatricesBuffer);
@@ -1172,62 +1574,156 @@ void LightManager::uploadShadowMatrices(const ShadowEntry* entries, int layerCou
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
-void LightManager::renderPointShadowInstanced(const PointShadowEntry& entry,
+void LightManager::renderShadowGeometryMultiView(std::span<const glm::mat4> viewProjections,
     MeshManager& meshManager,
-    ProceduralFloor* floorPtr)
+    const PointShadowEntry* pointEntry)
 {
-    (void)floorPtr;
+    ensureMultiViewShadowShader();
+    m_multiViewShadowShader.bind();
 
-    ensurePointShadowInstancedShader();
-    m_pointShadowInstancedShader.bind();
+    const std::size_t viewCount = std::min(viewProjections.size(), static_cast<std::size_t>(kMaxShadowLights));
+    if (viewCount == 0)
+        return;
+    glNamedBufferSubData(m_shadowViewsUBO, 0, static_cast<GLsizeiptr>(viewCount * sizeof(glm::mat4)), viewProjections.data());
+    glBindBufferBase(GL_UNIFORM_BUFFER, kShadowViewsBinding, m_shadowViewsUBO);
 
-    const float nearPlane = entry.nearPlane;
-    const float farPlane = entry.farPlane;
-    const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
+    const GLint locIsPoint = m_multiViewShadowShader.getUniformLocation("uIsPointLight");
+    if (locIsPoint >= 0)
+        glUniform1i(locIsPoint, pointEntry ? 1 : 0);
+    if (pointEntry) {
+        glUniform3fv(m_multiViewShadowShader.getUniformLocation("uPointLightPosition"), 1, glm::value_ptr(pointEntry->lightPosition));
+        glUniform1f(m_multiViewShadowShader.getUniformLocation("uPointLightNear"), pointEntry->nearPlane);
+        glUniform1f(m_multiViewShadowShader.getUniformLocation("uPointLightFar"), pointEntry->farPlane);
+    }
 
-    std::array<glm::mat4, 6> vpMatrices {};
-    for (int face = 0; face < 6; ++face) {
-        const glm::mat4 view = glm::lookAt(entry.lightPosition,
-            entry.lightPosition + kPointShadowDirections[static_cast<std::size_t>(face)],
-            kPointShadowUps[static_cast<std::size_t>(face)]);
-        vpMatrices[static_cast<std::size_t>(face)] = projection * view;
+    std::array<FrustumPlanes, kMaxShadowLights> planes;
+    for (std::size_t view = 0; view < viewCount; ++view)
+        planes[view] = frustumPlanes(viewProjections[view]);
+
+    for (MeshInstance& instance : meshManager.instances()) {
+        const glm::mat4& instanceTransform = instance.transform();
+        for (MeshDrawItem& item : instance.drawItems()) {
+            if (!item.geometry.resident())
+                continue;
+            const glm::mat4 model = instanceTransform * item.nodeTransform;
+
+            // World-space box of the item, then the views it reaches.
+            const glm::vec3 localCenter = 0.5f * (item.bounds.min + item.bounds.max);
+            const glm::vec3 localExtent = 0.5f * (item.bounds.max - item.bounds.min);
+            const glm::mat3 linear(model);
+            const glm::vec3 center = glm::vec3(model * glm::vec4(localCenter, 1.0f));
+            const glm::vec3 extent = glm::abs(linear[0]) * localExtent.x + glm::abs(linear[1]) * localExtent.y + glm::abs(linear[2]) * localExtent.z;
+
+            std::uint32_t mask = 0;
+            const bool inRange = !pointEntry
+                || glm::length(glm::max(glm::abs(pointEntry->lightPosition - center) - extent, glm::vec3(0.0f))) <= pointEntry->farPlane;
+            if (inRange) {
+                for (std::size_t view = 0; view < viewCount; ++view) {
+                    if (boxIntersectsFrustum(planes[view], center, extent))
+                        mask |= 1u << view;
+                }
+            }
+            const int instances = std::popcount(mask);
+            m_currentShadowPass.viewsCulled += viewCount - static_cast<std::size_t>(instances);
+            if (instances == 0)
+                continue;
+
+            if (m_multiViewModelLocation >= 0)
+                glUniformMatrix4fv(m_multiViewModelLocation, 1, GL_FALSE, glm::value_ptr(model));
+            if (m_multiViewMaskLocation >= 0)
+                glUniform1ui(m_multiViewMaskLocation, mask);
+            if (m_meshletCuller)
+                m_meshletCuller->draw(item, model, false, instances);
+            else
+                item.geometry.drawInstanced(instances);
+            ++m_currentShadowPass.casterDraws;
+            m_currentShadowPass.viewInstances += static_cast<std::uint64_t>(instances);
+        }
     }
 
+    glBindBufferBase(GL_UNIFORM_BUFFER, kShadowViewsBinding, 0);
+    GLCHK();
+}
+
+void LightManager::renderPointShadowMultiView(const PointShadowEntry& entry, MeshManager& meshManager)
+{
+    const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, entry.nearPlane, entry.farPlane);
+    std::array<glm::mat4, 6> faceViewProjections {};
+    for (std::size_t face = 0; face < faceViewProjections.size(); ++face) {
+        const glm::mat4 view = glm::lookAt(entry.lightPosition, entry.lightPosition + kPointShadowDirections[face], kPointShadowUps[face]);
+        faceViewProjections[face] = projection * view;
+    }
+
+    // Attaching the whole cubemap makes the framebuffer layered, one layer per face.
     glBindFramebuffer(GL_FRAMEBUFFER, m_shadowFramebuffer);
     glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, entry.cubemap, 0);
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
-
     glViewport(0, 0, entry.resolution, entry.resolution);
     glClear(GL_DEPTH_BUFFER_BIT);
 
-    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
-
-    if (m_pointShadowViewProjUBO == 0)
-        glGenBuffers(1, &m_pointShadowViewProjUBO);
+    if (m_meshletCuller) {
+        // One draw feeds every face, so a meshlet stays when any face sees it.
+        std::array<MeshletCuller::View, 6> views;
+        for (std::size_t face = 0; face < views.size(); ++face) {
+            views[face].viewProjection = faceViewProjections[face];
+            views[face].eye = entry.lightPosition;
+            views[face].maxDistance = entry.farPlane;
+        }
+        m_meshletCuller->setViews(MeshletCuller::Pass::Shadow, views, MeshletCuller::FaceCull::Front);
+    }
 
-    glBindBuffer(GL_UNIFORM_BUFFER, m_pointShadowViewProjUBO);
-    glBufferData(GL_UNIFORM_BUFFER,
-        static_cast<GLsizeiptr>(vpMatrices.size() * sizeof(glm::mat4)),
-        vpMatrices.data(),
-        GL_DYNAMIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
-    glBindBufferBase(GL_UNIFORM_BUFFER, 4, m_pointShadowViewProjUBO);
+    renderShadowGeometryMultiView(faceViewProjections, meshManager, &entry);
+}
 
-    auto& instances = meshManager.instances();
-    for (MeshInstance& instance : instances) {
-        const glm::mat4& instanceTransform = instance.transform();
-        for (MeshDrawItem& item : instance.drawItems()) {
-            const glm::mat4 model = instanceTransform * item.nodeTransform;
-            if (m_pointShadowModelLocation >= 0)
-                glUniformMatrix4fv(m_pointShadowModelLocation, 1, GL_FALSE, glm::value_ptr(model));
-            item.geometry.drawInstanced(6);
+void LightManager::beginShadowTiming(ShadowPath path)
+{
+    if (m_shadowTimerQueries.front() == 0)
+        glCreateQueries(GL_TIME_ELAPSED, static_cast<GLsizei>(m_shadowTimerQueries.size()), m_shadowTimerQueries.data());
+
+    // Collect what this query measured kShadowTimerQueries frames ago; drop it rather than stall.
+    const std::size_t slot = m_shadowTimerIndex;
+    const GLuint query = m_shadowTimerQueries[slot];
+    if (m_shadowTimerPending[slot]) {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsedNs);
+            ShadowPassStats& stats = m_shadowPassStats[static_cast<std::size_t>(m_shadowTimerPaths[slot])];
+            stats.gpuMs = smoothMs(stats.gpuMs, static_cast<float>(static_cast<double>(elapsedNs) * 1e-6));
         }
+        m_shadowTimerPending[slot] = false;
     }
 
-    glBindBufferBase(GL_UNIFORM_BUFFER, 4, 0);
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    m_shadowTimerPaths[slot] = path;
+    m_currentShadowPass = {};
+    m_shadowPassStart = std::chrono::steady_clock::now();
+}
 
-    GLCHK();
+void LightManager::endShadowTiming()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    const std::size_t slot = m_shadowTimerIndex;
+    m_shadowTimerPending[slot] = true;
+    m_shadowTimerIndex = (slot + 1) % m_shadowTimerQueries.size();
+
+    ShadowPassStats& stats = m_shadowPassStats[static_cast<std::size_t>(m_shadowTimerPaths[slot])];
+    const float cpuMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_shadowPassStart).count();
+    stats.cpuMs = smoothMs(stats.cpuMs, cpuMs);
+    stats.casterDraws = m_currentShadowPass.casterDraws;
+    stats.viewInstances = m_currentShadowPass.viewInstances;
+    stats.viewsCulled = m_currentShadowPass.viewsCulled;
+}
+
+void LightManager::destroyShadowTimingResources()
+{
+    if (m_shadowTimerQueries.front() != 0) {
+        glDeleteQueries(static_cast<GLsizei>(m_shadowTimerQueries.size()), m_shadowTimerQueries.data());
+        m_shadowTimerQueries.fill(0);
+    }
+    m_shadowTimerPending.fill(false);
 }
 
 void LightManager::renderPointShadowFaces(GLuint cubemap,
@@ -1258,6 +1754,8 @@ void LightManager::renderPointShadowFaces(GLuint cubemap,
             lightPos + kPointShadowDirections[static_cast<std::size_t>(face)],
             kPointShadowUps[static_cast<std::size_t>(face)]);
         const glm::mat4 lightViewProj = projection * view;
+        if (m_meshletCuller)
+            m_meshletCuller->setView(MeshletCuller::Pass::Shadow, { lightViewProj, lightPos }, MeshletCuller::FaceCull::Front);
         renderShadowGeometry(false,
             meshManager,
             floorPtr,
@@ -1314,12 +1812,11 @@ void LightManager::renderShadowMaps(const glm::mat4& /*cameraView*/,
     spotIndices.reserve(kMaxShadowLights);
     pointIndices.reserve(kMaxShadowLights);
 
-    for (std::size_t i = 0; i < m_lights.size(); ++i) {
-        const Light& light = m_lights[i];
-        if (!light.enabled || !light.castsShadows)
+    for (std::size_t i = 0; i < lightCount(); ++i) {
+        if (m_lights.enabled[i] == 0 || m_lights.castsShadows[i] == 0)
             continue;
 
-        switch (light.type) {
+        switch (m_lights.types[i]) {
         case LightType::Spot:
             if (spotIndices.size() < kMaxShadowLights)
                 spotIndices.push_back(static_cast<int>(i));
@@ -1334,7 +1831,7 @@ void LightManager::renderShadowMaps(const glm::mat4& /*cameraView*/,
     std::vector<ShadowEntry> entries;
     entries.reserve(spotIndices.size());
     for (int index : spotIndices) {
-        entries.push_back(buildShadowEntry(index, m_lights[static_cast<std::size_t>(index)], cameraPosition));
+        entries.push_back(buildShadowEntry(index, light(static_cast<std::size_t>(index)), cameraPosition));
     }
 
     ensureShadowResources(entries.size());
@@ -1344,12 +1841,12 @@ void LightManager::renderShadowMaps(const glm::mat4& /*cameraView*/,
     m_pointShadowEntries.reserve(pointIndices.size());
     for (std::size_t i = 0; i < pointIndices.size(); ++i) {
         const int lightIndex = pointIndices[i];
-        const Light& light = m_lights[static_cast<std::size_t>(lightIndex)];
+        const Light light = this->light(static_cast<std::size_t>(lightIndex));
 
         PointShadowEntry entry;
         entry.lightIndex = lightIndex;
         entry.cubemap = m_pointShadowCubemaps[i];
-        entry.resolution = kShadowMapResolution;
+        entry.resolution = m_shadowResolution;
         entry.lightPosition = light.position;
         entry.nearPlane = std::max(light.shadowNearPlane, 0.01f);
         entry.farPlane = std::max(light.shadowFarPlane, entry.nearPlane + 0.1f);
@@ -1389,6 +1886,8 @@ void LightManager::renderShadowMaps(const glm::mat4& /*cameraView*/,
     glPolygonOffset(2.0f, 4.0f);
 
     const int shadowLayerCount = static_cast<int>(entries.size());
+    const bool vertexLayer = m_shadowPath == ShadowPath::VertexLayer && vertexLayerShadowsSupported();
+    beginShadowTiming(vertexLayer ? ShadowPath::VertexLayer : ShadowPath::GeometryShader);
 
     if (!entries.empty()) {
         for (std::size_t layer = 0; layer < entries.size(); ++layer) {
@@ -1408,26 +1907,39 @@ void LightManager::renderShadowMaps(const glm::mat4& /*cameraView*/,
             bindLayeredShadowFramebuffer();
             GLenum fbStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
             if (fbStatus != GL_FRAMEBUFFER_COMPLETE) {
-                std::fprintf(stderr,
-                    "Shadow FBO incomplete: 0x%X (layers=%d)\n",
-                    fbStatus,
-                    shadowLayerCount);
+                LOG_ERROR(logging::Category::OpenGL, "Shadow FBO incomplete: 0x{:X} (layers={})", fbStatus, shadowLayerCount);
                 glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(prevDrawFbo));
                 glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(prevReadFbo));
             } else {
                 layeredReady = true;
-                glViewport(0, 0, kShadowMapResolution, kShadowMapResolution);
+                glViewport(0, 0, m_shadowResolution, m_shadowResolution);
                 glClear(GL_DEPTH_BUFFER_BIT);
                 GLCHK();
-                renderShadowGeometry(true,
-                    meshManager,
-                    floorPtr,
-                    false,
-                    nullptr,
-                    glm::vec3(0.0f),
-                    0.1f,
-                    100.0f,
-                    shadowLayerCount);
+                if (m_meshletCuller) {
+                    // One draw feeds every layer, so a meshlet stays when any of the lights sees it.
+                    std::vector<MeshletCuller::View> views;
+                    views.reserve(entries.size());
+                    for (const ShadowEntry& entry : entries)
+                        views.push_back({ entry.projectionMatrix * entry.viewMatrix, entry.lightPosition });
+                    m_meshletCuller->setViews(MeshletCuller::Pass::Shadow, views, MeshletCuller::FaceCull::Front);
+                }
+                if (vertexLayer) {
+                    std::vector<glm::mat4> viewProjections;
+                    viewProjections.reserve(entries.size());
+                    for (const ShadowEntry& entry : entries)
+                        viewProjections.push_back(entry.projectionMatrix * entry.viewMatrix);
+                    renderShadowGeometryMultiView(viewProjections, meshManager, nullptr);
+                } else {
+                    renderShadowGeometry(true,
+                        meshManager,
+                        floorPtr,
+                        false,
+                        nullptr,
+                        glm::vec3(0.0f),
+                        0.1f,
+                        100.0f,
+                        shadowLayerCount);
+                }
                 GLCHK();
             }
         }
@@ -1437,9 +1949,11 @@ void LightManager::renderShadowMaps(const glm::mat4& /*cameraView*/,
                 ShadowEntry& entry = entries[layer];
                 uploadShadowMatrices(&entry, 1);
                 bindShadowFramebuffer(entry);
-                glViewport(0, 0, kShadowMapResolution, kShadowMapResolution);
+                glViewport(0, 0, m_shadowResolution, m_shadowResolution);
                 glClear(GL_DEPTH_BUFFER_BIT);
                 GLCHK();
+                if (m_meshletCuller)
+                    m_meshletCuller->setView(MeshletCuller::Pass::Shadow, { entry.projectionMatrix * entry.viewMatrix, entry.lightPosition }, MeshletCuller::FaceCull::Front);
                 renderShadowGeometry(false,
                     meshManager,
                     floorPtr,
@@ -1455,8 +1969,8 @@ void LightManager::renderShadowMaps(const glm::mat4& /*cameraView*/,
     }
 
     for (const PointShadowEntry& entry : m_pointShadowEntries) {
-        if (m_usePointInstancedShadows) {
-            renderPointShadowInstanced(entry, meshManager, floorPtr);
+        if (vertexLayer) {
+            renderPointShadowMultiView(entry, meshManager);
         } else {
             renderPointShadowFaces(entry.cubemap,
                 entry.resolution,
@@ -1469,6 +1983,7 @@ void LightManager::renderShadowMaps(const glm::mat4& /*cameraView*/,
                 floorPtr);
         }
     }
+    endShadowTiming();
 
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(prevDrawFbo));
     glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(prevReadFbo));
@@ -1497,11 +2012,9 @@ void LightManager::renderShadowMaps(const glm::mat4& /*cameraView*/,
         layerInfo.type = entry.type;
         layerInfo.nearPlane = entry.nearPlane;
         layerInfo.farPlane = entry.farPlane;
-        layerInfo.resolution = kShadowMapResolution;
-        if (entry.lightIndex >= 0 && entry.lightIndex < static_cast<int>(m_lights.size())) {
-            const Light& srcLight = m_lights[static_cast<std::size_t>(entry.lightIndex)];
-            layerInfo.bias = srcLight.shadowBias;
-        }
+        layerInfo.resolution = m_shadowResolution;
+        if (entry.lightIndex >= 0 && entry.lightIndex < static_cast<int>(lightCount()))
+            layerInfo.bias = m_lights.shadowParams[static_cast<std::size_t>(entry.lightIndex)].x;
         m_shadowDebugLayers.push_back(layerInfo);
     }
 
@@ -1510,5 +2023,4 @@ void LightManager::renderShadowMaps(const glm::mat4& /*cameraView*/,
     if (m_shadowDebugSelectedLayer < 0 && !m_shadowDebugLayers.empty())
         m_shadowDebugSelectedLayer = 0;
     m_shadowDebugDirty = true;
-    m_gpuDirty = true;
 }
@@ -10,23 +10,32 @@
 #include <glm/vec4.hpp>
 
 #include <array>
+#include <chrono>
 #include <cstdint>
+#include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
 class MeshManager;
+class MeshletCuller;
 class ProceduralFloor;
 
 class LightManager {
 public:
     static constexpr int kMaxShadowLights = 8;
-    static constexpr int kShadowMapResolution = 2048;
+    static constexpr int kShadowMapResolution = 2048; // default; see setShadowQuality()
+    static constexpr int kMinShadowMapResolution = 256;
+    static constexpr int kMaxShadowMapResolution = 4096;
+    static constexpr int kMaxShadowPcfRadius = 3;
 
     enum class LightType {
         Point = 0,
         Spot = 1
     };
 
+    // Value snapshot of a single light. Storage is SoA internally; use light()/setLight() for whole-light
+    // edits and the per-field setters or bulk API for anything updated every frame.
     struct Light {
         LightType type { LightType::Point };
         std::string name;
@@ -60,6 +69,33 @@ public:
         int directionalLightCount { 0 };
     };
 
+    struct UploadStats {
+        std::size_t bytesThisFrame { 0 };
+        std::size_t rangesThisFrame { 0 };
+        std::size_t lightsThisFrame { 0 };
+        std::size_t capacity { 0 };
+        std::uint32_t reallocations { 0 };
+        float avgBytesPerFrame { 0.0f };
+    };
+
+    // How casters reach the layers of the spot shadow array and the faces of point cubemaps.
+    // VertexLayer draws each caster once, instanced over the views its bounds intersect, and writes
+    // gl_Layer from the vertex shader (ARB_shader_viewport_layer_array / AMD_vertex_shader_layer).
+    // GeometryShader replicates triangles in shadow_geom.glsl and renders cube faces one by one; it is
+    // also used when the driver lacks the extensions.
+    enum class ShadowPath {
+        VertexLayer = 0,
+        GeometryShader = 1
+    };
+
+    struct ShadowPassStats {
+        float gpuMs { 0.0f }; // GL_TIME_ELAPSED of every shadow pass in a frame, smoothed
+        float cpuMs { 0.0f };
+        std::uint64_t casterDraws { 0 }; // last frame
+        std::uint64_t viewInstances { 0 }; // caster x view pairs rendered
+        std::uint64_t viewsCulled { 0 }; // caster x view pairs skipped by the per-view masks
+    };
+
     enum class GizmoMode {
         None,
         Translate,
@@ -79,21 +115,56 @@ public:
         MeshManager& meshManager,
         ProceduralFloor* floor);
     void updateGpuData();
+    // Shadow passes cull meshlets against each light's view when a culler is set.
+    void setMeshletCuller(MeshletCuller* culler) { m_meshletCuller = culler; }
 
     [[nodiscard]] const GpuBinding& gpuBinding() const { return m_gpuBinding; }
 
-    [[nodiscard]] const std::vector<Light>& lights() const { return m_lights; }
-    [[nodiscard]] std::vector<Light>& lights() { return m_lights; }
+    [[nodiscard]] const UploadStats& uploadStats() const { return m_uploadStats; }
+
+    void setShadowPath(ShadowPath path) { m_shadowPath = path; }
+    [[nodiscard]] ShadowPath shadowPath() const { return m_shadowPath; }
+    // Needs a current GL context; the answer is cached.
+    [[nodiscard]] bool vertexLayerShadowsSupported();
+    [[nodiscard]] const ShadowPassStats& shadowPassStats(ShadowPath path) const { return m_shadowPassStats[static_cast<std::size_t>(path)]; }
+
+    // Per-side resolution of spot layers and point cubemap faces, and the half-width of the spot PCF
+    // kernel ((2r+1)^2 taps). A resolution change frees the maps; they are reallocated on the next
+    // renderShadowMaps().
+    void setShadowQuality(int resolution, int pcfRadius);
+    [[nodiscard]] int shadowMapResolution() const { return m_shadowResolution; }
+    [[nodiscard]] int shadowPcfRadius() const { return m_shadowPcfRadius; }
+
+    [[nodiscard]] std::size_t lightCount() const { return m_lights.types.size(); }
+    [[nodiscard]] Light light(std::size_t index) const;
+    void setLight(std::size_t index, const Light& light);
 
-    [[nodiscard]] Light* findLightByName(const std::string& name);
-    [[nodiscard]] const Light* findLightByName(const std::string& name) const;
-    [[nodiscard]] Light& ensureLight(const std::string& name, LightType type);
+    // Hot per-field access; setters only flag the touched light for upload.
+    [[nodiscard]] LightType type(std::size_t index) const { return m_lights.types[index]; }
+    [[nodiscard]] bool isEnabled(std::size_t index) const { return m_lights.enabled[index] != 0; }
+    [[nodiscard]] const std::string& name(std::size_t index) const { return m_lights.names[index]; }
+    [[nodiscard]] const glm::vec3& position(std::size_t index) const { return m_lights.positions[index]; }
+    [[nodiscard]] const glm::vec3& direction(std::size_t index) const { return m_lights.directions[index]; }
+    [[nodiscard]] const glm::vec3& color(std::size_t index) const { return m_lights.colors[index]; }
+    [[nodiscard]] float intensity(std::size_t index) const { return m_lights.intensities[index]; }
+    void setEnabled(std::size_t index, bool enabled);
+    void setPosition(std::size_t index, const glm::vec3& position);
+    void setDirection(std::size_t index, const glm::vec3& direction);
+    void setColor(std::size_t index, const glm::vec3& color, float intensity);
+
+    // Bulk updates for scripted/animated lights: `indices[i]` receives `values[i]`.
+    void setPositions(std::span<const std::uint32_t> indices, std::span<const glm::vec3> positions);
+    void setDirections(std::span<const std::uint32_t> indices, std::span<const glm::vec3> directions);
+    void setColors(std::span<const std::uint32_t> indices, std::span<const glm::vec3> colors, std::span<const float> intensities);
+
+    [[nodiscard]] int findLightIndex(const std::string& name) const;
+    std::size_t ensureLight(const std::string& name, LightType type);
 
     void setSelectedIndex(int index);
     [[nodiscard]] int selectedIndex() const { return m_selectedIndex; }
-    [[nodiscard]] Light* selectedLight();
-    [[nodiscard]] const Light* selectedLight() const;
-    
+
+    void markLightDirty(std::size_t index);
+    // Re-uploads every light; needed after structural changes (removal reorders GPU slots).
     void markDirty();
 
 private:
@@ -107,6 +178,27 @@ private:
         glm::vec4 extra { 0.0f };
     };
 
+    // Hot fields first; names are only touched by the UI and name lookups.
+    struct LightStorage {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> directions;
+        std::vector<glm::vec3> colors;
+        std::vector<float> intensities;
+        std::vector<std::uint8_t> enabled;
+        std::vector<LightType> types;
+        std::vector<float> ranges;
+        std::vector<glm::vec2> cones; // inner, outer (degrees)
+        std::vector<glm::vec4> attenuation; // constant, linear, quadratic, enabled
+        std::vector<glm::vec3> shadowParams; // bias, near, far
+        std::vector<std::uint8_t> castsShadows;
+        std::vector<std::string> names;
+
+        void push(const Light& light);
+        void erase(std::size_t index);
+    };
+
+    static constexpr std::size_t kStagingSegments = 3;
+
     struct ShadowEntry {
         int lightIndex { -1 };
         int layerIndex { -1 };
@@ -129,12 +221,14 @@ private:
         float constantBias { 0.0f };
     };
 
-    Light& addLight(LightType type);
+    std::size_t addLight(LightType type);
     void removeLight(int index);
     void ensureDefaultLight();
     void destroyGpuBuffer();
-    void rebuildGpuBuffer();
-    void drawLightItem(int index, Light& light);
+    void ensureGpuCapacity(std::size_t lightCount);
+    void uploadDirtyLights();
+    [[nodiscard]] GpuLight packGpuLight(std::size_t index) const;
+    bool drawLightItem(int index, Light& light);
     static glm::vec3 sanitizeDirection(const glm::vec3& dir);
     void ensureShadowLayerMapping();
     void ensureShadowShader();
@@ -157,10 +251,15 @@ private:
         float nearPlane = 0.1f,
         float farPlane = 100.0f,
         int shadowLayerCount = 0);
-    void ensurePointShadowInstancedShader();
-    void renderPointShadowInstanced(const PointShadowEntry& entry,
+    void ensureMultiViewShadowShader();
+    // One instanced draw per caster into every view in `viewProjections` (layer = view index).
+    void renderShadowGeometryMultiView(std::span<const glm::mat4> viewProjections,
         MeshManager& meshManager,
-        ProceduralFloor* floor);
+        const PointShadowEntry* pointEntry);
+    void renderPointShadowMultiView(const PointShadowEntry& entry, MeshManager& meshManager);
+    void beginShadowTiming(ShadowPath path);
+    void endShadowTiming();
+    void destroyShadowTimingResources();
     void uploadShadowMatrices(const ShadowEntry* entries, int layerCount);
     void renderPointShadowFaces(GLuint cubemap,
         int resolution,
@@ -177,11 +276,21 @@ private:
     void updateShadowDebugPreview();
     void destroyShadowDebugResources();
 
-    std::vector<Light> m_lights;
+    LightStorage m_lights;
+    std::vector<std::uint8_t> m_lightDirty;
     int m_selectedIndex { -1 };
     bool m_editWithGizmo { false };
     bool m_gpuDirty { true };
+    // Device-local SSBO read by the shaders plus a persistently mapped staging ring; dirty ranges are
+    // written into the current segment and copied over, so untouched lights never leave the GPU.
     GLuint m_lightBuffer { 0 };
+    GLuint m_stagingBuffer { 0 };
+    GpuLight* m_stagingMapped { nullptr };
+    std::array<GLsync, kStagingSegments> m_stagingFences {};
+    std::size_t m_stagingSegment { 0 };
+    std::size_t m_gpuCapacity { 0 };
+    std::vector<int> m_uploadedShadowLayers;
+    UploadStats m_uploadStats;
     GpuBinding m_gpuBinding {};
     std::uint32_t m_nextId { 1 };
     std::vector<int> m_shadowLayerForLight;
@@ -195,15 +304,29 @@ private:
     std::vector<glm::vec4> m_shadowParams;
     bool m_shadowResourcesDirty { true };
     std::size_t m_shadowArrayLayers { 0 };
+    int m_shadowResolution { kShadowMapResolution };
+    int m_shadowPcfRadius { 1 };
     std::vector<PointShadowEntry> m_pointShadowEntries;
     bool m_pointShadowResourcesDirty { true };
     std::vector<GLuint> m_pointShadowCubemaps;
     GLuint m_pointShadowSampler { 0 };
     GLuint m_pointShadowDummyTexture { 0 };
-        Shader m_pointShadowInstancedShader;
-        bool m_pointShadowInstancedShaderReady { false };
-        GLuint m_pointShadowViewProjUBO { 0 };
-        GLint m_pointShadowModelLocation { -1 };
+    Shader m_multiViewShadowShader;
+    bool m_multiViewShadowShaderReady { false };
+    GLuint m_shadowViewsUBO { 0 };
+    GLint m_multiViewModelLocation { -1 };
+    GLint m_multiViewMaskLocation { -1 };
+    std::optional<bool> m_vertexLayerSupported;
+
+    static constexpr std::size_t kShadowTimerQueries = 4; // frames in flight before a result is read
+    ShadowPath m_shadowPath { ShadowPath::VertexLayer };
+    std::array<ShadowPassStats, 2> m_shadowPassStats {};
+    ShadowPassStats m_currentShadowPass;
+    std::chrono::steady_clock::time_point m_shadowPassStart;
+    std::array<GLuint, kShadowTimerQueries> m_shadowTimerQueries {};
+    std::array<ShadowPath, kShadowTimerQueries> m_shadowTimerPaths {};
+    std::array<bool, kShadowTimerQueries> m_shadowTimerPending {};
+    std::size_t m_shadowTimerIndex { 0 };
 
     struct ShadowDebugLayer {
         int lightIndex { -1 };
@@ -229,5 +352,5 @@ private:
     Shader m_shadowDebugShader;
     bool m_shadowDebugShaderReady { false };
     bool m_useLayeredShadows { true };
-    bool m_usePointInstancedShadows { false }; // old, can be ignored for now
+    MeshletCuller* m_meshletCuller { nullptr };
 };
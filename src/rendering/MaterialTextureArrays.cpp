@@ -0,0 +1,463 @@
+// SPDX-License-Identifier: MIT
+
+#include "rendering/MaterialTextureArrays.h"
+
+#include "mesh/MeshInstance.h"
+#include "rendering/PixelOps.h"
+
+#include <framework/disable_all_warnings.h>
+#include <framework/log.h>
+DISABLE_WARNINGS_PUSH()
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <memory>
+
+namespace {
+
+[[nodiscard]] bool isPowerOfTwo(int value)
+{
+    return value > 0 && (value & (value - 1)) == 0;
+}
+
+[[nodiscard]] int mipLevelsFor(int size)
+{
+    return static_cast<int>(std::floor(std::log2(static_cast<float>(size)))) + 1;
+}
+
+// Expands the texture's CPU pixels to RGBA floats; colour channels of sRGB textures are linearised
+// so every filter below averages in linear space.
+[[nodiscard]] std::vector<float> toLinearRgba(const Texture& texture)
+{
+    const int width = texture.cpuWidth();
+    const int height = texture.cpuHeight();
+    const int channels = texture.cpuChannels();
+    const std::vector<uint8_t>& pixels = texture.cpuPixels();
+
+    std::array<float, 256> decode {};
+    for (int i = 0; i < 256; ++i) {
+        const auto value = static_cast<uint8_t>(i);
+        decode[static_cast<std::size_t>(i)] = texture.isSrgb() ? pixel_ops::srgbToLinear(value) : static_cast<float>(i) / 255.0f;
+    }
+
+    std::vector<float> rgba(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4u);
+    for (std::size_t i = 0, count = static_cast<std::size_t>(width) * static_cast<std::size_t>(height); i < count; ++i) {
+        const uint8_t* src = pixels.data() + i * static_cast<std::size_t>(channels);
+        float* dst = rgba.data() + i * 4u;
+        // One channel is luminance, two are luminance + alpha; alpha is never colour-decoded.
+        const std::size_t alphaChannel = channels == 2 ? 1u : 3u;
+        for (std::size_t c = 0; c < 3; ++c)
+            dst[c] = decode[src[channels < 3 ? 0u : c]];
+        dst[3] = channels == 2 || channels == 4 ? static_cast<float>(src[alphaChannel]) / 255.0f : 1.0f;
+    }
+    return rgba;
+}
+
+// 2x2 box reduction, i.e. exactly one mip step.
+void halve(std::vector<float>& rgba, int& width, int& height)
+{
+    const int newWidth = std::max(width / 2, 1);
+    const int newHeight = std::max(height / 2, 1);
+    std::vector<float> result(static_cast<std::size_t>(newWidth) * static_cast<std::size_t>(newHeight) * 4u);
+    for (int y = 0; y < newHeight; ++y) {
+        const int y0 = std::min(y * 2, height - 1);
+        const int y1 = std::min(y * 2 + 1, height - 1);
+        for (int x = 0; x < newWidth; ++x) {
+            const int x0 = std::min(x * 2, width - 1);
+            const int x1 = std::min(x * 2 + 1, width - 1);
+            for (int c = 0; c < 4; ++c) {
+                const auto at = [&](int px, int py) { return rgba[(static_cast<std::size_t>(py) * static_cast<std::size_t>(width) + static_cast<std::size_t>(px)) * 4u + static_cast<std::size_t>(c)]; };
+                result[(static_cast<std::size_t>(y) * static_cast<std::size_t>(newWidth) + static_cast<std::size_t>(x)) * 4u + static_cast<std::size_t>(c)] = 0.25f * (at(x0, y0) + at(x1, y0) + at(x0, y1) + at(x1, y1));
+            }
+        }
+    }
+    rgba = std::move(result);
+    width = newWidth;
+    height = newHeight;
+}
+
+[[nodiscard]] std::vector<float> bilinearResize(const std::vector<float>& rgba, int width, int height, int targetWidth, int targetHeight)
+{
+    std::vector<float> result(static_cast<std::size_t>(targetWidth) * static_cast<std::size_t>(targetHeight) * 4u);
+    const float scaleX = static_cast<float>(width) / static_cast<float>(targetWidth);
+    const float scaleY = static_cast<float>(height) / static_cast<float>(targetHeight);
+    for (int y = 0; y < targetHeight; ++y) {
+        const float sy = std::clamp((static_cast<float>(y) + 0.5f) * scaleY - 0.5f, 0.0f, static_cast<float>(height - 1));
+        const int y0 = static_cast<int>(sy);
+        const int y1 = std::min(y0 + 1, height - 1);
+        const float fy = sy - static_cast<float>(y0);
+        for (int x = 0; x < targetWidth; ++x) {
+            const float sx = std::clamp((static_cast<float>(x) + 0.5f) * scaleX - 0.5f, 0.0f, static_cast<float>(width - 1));
+            const int x0 = static_cast<int>(sx);
+            const int x1 = std::min(x0 + 1, width - 1);
+            const float fx = sx - static_cast<float>(x0);
+            for (int c = 0; c < 4; ++c) {
+                const auto at = [&](int px, int py) { return rgba[(static_cast<std::size_t>(py) * static_cast<std::size_t>(width) + static_cast<std::size_t>(px)) * 4u + static_cast<std::size_t>(c)]; };
+                const float top = at(x0, y0) + (at(x1, y0) - at(x0, y0)) * fx;
+                const float bottom = at(x0, y1) + (at(x1, y1) - at(x0, y1)) * fx;
+                result[(static_cast<std::size_t>(y) * static_cast<std::size_t>(targetWidth) + static_cast<std::size_t>(x)) * 4u + static_cast<std::size_t>(c)] = top + (bottom - top) * fy;
+            }
+        }
+    }
+    return result;
+}
+
+// Builds the RGBA8 base level for an array layer. Downscales go through whole mip steps first so
+// the result matches what the texture's own mip chain would have shown at that size.
+[[nodiscard]] std::vector<uint8_t> buildLayerPixels(const Texture& texture, int size)
+{
+    std::vector<float> rgba = toLinearRgba(texture);
+    int width = texture.cpuWidth();
+    int height = texture.cpuHeight();
+    while (width >= size * 2 && height >= size * 2)
+        halve(rgba, width, height);
+    if (width != size || height != size)
+        rgba = bilinearResize(rgba, width, height, size, size);
+
+    std::vector<uint8_t> bytes(rgba.size());
+    for (std::size_t i = 0; i < rgba.size(); ++i) {
+        if (texture.isSrgb() && (i % 4u) != 3u)
+            bytes[i] = pixel_ops::linearToSrgb(rgba[i]);
+        else
+            bytes[i] = static_cast<uint8_t>(std::lround(std::clamp(rgba[i], 0.0f, 1.0f) * 255.0f));
+    }
+    return bytes;
+}
+
+[[nodiscard]] bool sameSampler(const TextureSamplerSettings& a, const TextureSamplerSettings& b)
+{
+    return a.wrapS == b.wrapS && a.wrapT == b.wrapT && a.minFilter == b.minFilter && a.magFilter == b.magFilter
+        && a.maxAnisotropy == b.maxAnisotropy;
+}
+
+// Every distinct material texture of the instances (height maps are never packed).
+[[nodiscard]] std::vector<std::shared_ptr<Texture>> collectTextures(const std::vector<MeshInstance>& instances)
+{
+    std::vector<std::shared_ptr<Texture>> textures;
+    for (const MeshInstance& instance : instances) {
+        for (const MeshDrawItem& item : instance.drawItems()) {
+            const RenderMaterial& material = item.material;
+            for (const std::shared_ptr<Texture>* texture : { &material.albedoMap, &material.metallicRoughnessMap,
+                     &material.normalMap, &material.aoMap, &material.emissiveMap }) {
+                if (*texture)
+                    textures.push_back(*texture);
+            }
+        }
+    }
+    std::sort(textures.begin(), textures.end());
+    textures.erase(std::unique(textures.begin(), textures.end()), textures.end());
+    return textures;
+}
+
+} // namespace
+
+bool MaterialTextureArrays::ArrayKey::operator==(const ArrayKey& other) const
+{
+    return size == other.size && srgb == other.srgb && sameSampler(sampler, other.sampler);
+}
+
+MaterialTextureArrays::~MaterialTextureArrays()
+{
+    deleteArrays(m_arrays);
+}
+
+void MaterialTextureArrays::deleteArrays(std::vector<TextureArray>& arrays)
+{
+    for (TextureArray& array : arrays) {
+        if (array.sampler != 0)
+            glDeleteSamplers(1, &array.sampler);
+        if (array.texture != 0)
+            glDeleteTextures(1, &array.texture);
+    }
+    arrays.clear();
+}
+
+void MaterialTextureArrays::setSettings(const Settings& settings)
+{
+    m_settings = settings;
+    m_settings.minSizeClass = std::clamp(m_settings.minSizeClass, 16, 4096);
+    m_settings.maxSizeClass = std::clamp(m_settings.maxSizeClass, m_settings.minSizeClass, 4096);
+    // Packed textures no longer have their source pixels; the settings apply to the ones still standalone.
+    ++m_settingsVersion;
+    m_resampleWanted = true;
+}
+
+std::uint64_t MaterialTextureArrays::signatureOf(const std::vector<MeshInstance>& instances)
+{
+    std::uint64_t signature = 1469598103934665603ull;
+    for (const MeshInstance& instance : instances) {
+        signature ^= instance.id();
+        signature *= 1099511628211ull;
+    }
+    return signature ^ instances.size();
+}
+
+void MaterialTextureArrays::sync(const std::vector<MeshInstance>& instances)
+{
+    const std::uint64_t signature = signatureOf(instances);
+    if (signature != m_signature) {
+        m_signature = signature;
+        // Closes the gaps left by removed textures now; new ones are packed once the worker is done.
+        pack(instances, {});
+        m_resampleWanted = true;
+    }
+
+    if (m_job.done.valid() && m_job.done.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        std::vector<PreparedLayer> prepared = m_job.done.get();
+        m_stats.pendingTextures = 0;
+        if (m_job.settingsVersion == m_settingsVersion)
+            pack(instances, std::move(prepared));
+    }
+    if (m_resampleWanted && !m_job.done.valid())
+        startResample(instances);
+}
+
+int MaterialTextureArrays::sizeClassFor(const Texture& texture) const
+{
+    const int width = texture.cpuWidth();
+    const int height = texture.cpuHeight();
+    if (width == height && isPowerOfTwo(width) && width >= m_settings.minSizeClass && width <= m_settings.maxSizeClass)
+        return width;
+    if (!m_settings.allowResample)
+        return 0;
+
+    // Nearest power of two (in log space) to the larger side, clamped to the allowed classes.
+    const int largest = std::max(width, height);
+    const int rounded = 1 << static_cast<int>(std::lround(std::log2(static_cast<float>(largest))));
+    return std::clamp(rounded, m_settings.minSizeClass, m_settings.maxSizeClass);
+}
+
+void MaterialTextureArrays::startResample(const std::vector<MeshInstance>& instances)
+{
+    m_resampleWanted = false;
+    if (!m_settings.enabled)
+        return;
+
+    std::vector<PreparedLayer> layers;
+    for (const std::shared_ptr<Texture>& texture : collectTextures(instances)) {
+        if (!texture->hasCpuPixels() || m_placements.contains(texture.get()))
+            continue;
+        const int size = sizeClassFor(*texture);
+        if (size == 0)
+            continue;
+        PreparedLayer layer;
+        layer.texture = texture;
+        layer.key = ArrayKey { size, texture->isSrgb(), texture->samplerSettings() };
+        layers.push_back(std::move(layer));
+    }
+    if (layers.empty())
+        return;
+
+    // The layers keep their textures alive; nothing frees the CPU pixels while the job reads them.
+    m_stats.pendingTextures = layers.size();
+    m_job.settingsVersion = m_settingsVersion;
+    m_job.done = std::async(std::launch::async, [layers = std::move(layers)]() mutable {
+        for (PreparedLayer& layer : layers) {
+            const Texture& texture = *layer.texture;
+            layer.pixels = buildLayerPixels(texture, layer.key.size);
+            layer.resampled = texture.cpuWidth() != layer.key.size || texture.cpuHeight() != layer.key.size;
+        }
+        return std::move(layers);
+    });
+}
+
+void MaterialTextureArrays::pack(const std::vector<MeshInstance>& instances, std::vector<PreparedLayer> prepared)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<std::shared_ptr<Texture>> textures = collectTextures(instances);
+
+    std::unordered_map<const Texture*, const PreparedLayer*> preparedLayers;
+    for (const PreparedLayer& layer : prepared)
+        preparedLayers.emplace(layer.texture.get(), &layer);
+
+    // Already packed textures come first in their group and always keep a layer: they have nothing
+    // else to be drawn from.
+    struct Member {
+        Texture* texture { nullptr };
+        const PreparedLayer* layer { nullptr }; // nullptr: copied from its current layer
+        Placement placement;
+    };
+    struct Group {
+        ArrayKey key;
+        std::vector<Member> members;
+        std::size_t packedMembers { 0 };
+    };
+    std::vector<Group> groups;
+    std::size_t standalone = 0;
+    std::size_t keptPlacements = 0;
+    std::size_t newMembers = 0;
+    const auto addMember = [&groups](const ArrayKey& key, const Member& member) {
+        auto it = std::find_if(groups.begin(), groups.end(), [&key](const Group& group) { return group.key == key; });
+        if (it == groups.end()) {
+            groups.push_back({ key, {}, 0 });
+            it = groups.end() - 1;
+        }
+        it->members.push_back(member);
+        it->packedMembers += member.layer ? 0 : 1;
+    };
+    for (const std::shared_ptr<Texture>& texture : textures) {
+        if (const auto placed = m_placements.find(texture.get()); placed != m_placements.end()) {
+            addMember(placed->second.key, Member { texture.get(), nullptr, placed->second });
+            ++keptPlacements;
+        } else if (const auto layer = preparedLayers.find(texture.get()); layer != preparedLayers.end() && texture->hasCpuPixels()) {
+            addMember(layer->second->key, Member { texture.get(), layer->second, {} });
+            ++newMembers;
+        } else if (texture->hasCpuPixels()) {
+            ++standalone;
+        }
+    }
+    if (newMembers == 0 && keptPlacements == m_placements.size()) {
+        m_stats.standaloneTextures = standalone;
+        return; // same layers as before
+    }
+
+    // Only kMaxArrays units exist. Groups holding packed textures came from at most that many arrays
+    // and go first; the most populated of the rest fill the remaining units.
+    for (Group& group : groups)
+        std::stable_partition(group.members.begin(), group.members.end(), [](const Member& member) { return member.layer == nullptr; });
+    std::stable_sort(groups.begin(), groups.end(), [](const Group& a, const Group& b) {
+        if ((a.packedMembers > 0) != (b.packedMembers > 0))
+            return a.packedMembers > 0;
+        return a.members.size() > b.members.size();
+    });
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+    std::vector<TextureArray> arrays;
+    std::unordered_map<const Texture*, Placement> placements;
+    std::vector<Texture*> packedNow;
+    Stats stats;
+    for (std::size_t groupIndex = 0; groupIndex < groups.size(); ++groupIndex) {
+        Group& group = groups[groupIndex];
+        if (groupIndex >= kMaxArrays || (group.packedMembers == 0 && group.members.size() < 2)) {
+            // A single texture gains nothing from an array; keep it on its own unit.
+            standalone += group.members.size() - group.packedMembers;
+            continue;
+        }
+        if (static_cast<GLint>(group.members.size()) > maxLayers) {
+            standalone += group.members.size() - static_cast<std::size_t>(maxLayers);
+            group.members.resize(static_cast<std::size_t>(maxLayers));
+        }
+
+        TextureArray array;
+        array.key = group.key;
+        array.layers = static_cast<int>(group.members.size());
+        const int size = group.key.size;
+        const int levels = mipLevelsFor(size);
+        const GLenum internalFormat = group.key.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+
+        glGenTextures(1, &array.texture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, array.texture);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, internalFormat, size, size, array.layers);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        const std::int32_t arrayIndex = static_cast<std::int32_t>(arrays.size());
+        bool uploaded = false;
+        for (int layer = 0; layer < array.layers; ++layer) {
+            const Member& member = group.members[static_cast<std::size_t>(layer)];
+            Placement placement { group.key, (arrayIndex << kLayerBits) | layer, false };
+            if (member.layer) {
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, size, size, 1, GL_RGBA, GL_UNSIGNED_BYTE, member.layer->pixels.data());
+                placement.resampled = member.layer->resampled;
+                packedNow.push_back(member.texture);
+                uploaded = true;
+            } else {
+                const GLuint source = m_arrays[static_cast<std::size_t>(member.placement.reference >> kLayerBits)].texture;
+                const int sourceLayer = member.placement.reference & kLayerMask;
+                for (int level = 0; level < levels; ++level) {
+                    const int levelSize = std::max(size >> level, 1);
+                    glCopyImageSubData(source, GL_TEXTURE_2D_ARRAY, level, 0, 0, sourceLayer,
+                        array.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, levelSize, levelSize, 1);
+                }
+                placement.resampled = member.placement.resampled;
+            }
+            stats.resampledTextures += placement.resampled ? 1 : 0;
+            placements[member.texture] = placement;
+        }
+        if (uploaded)
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        glGenSamplers(1, &array.sampler);
+        applySamplerSettings(array.sampler, group.key.sampler);
+
+        stats.packedTextures += group.members.size();
+        // Full mip chain adds roughly a third on top of the base level.
+        stats.gpuBytes += static_cast<std::size_t>(size) * static_cast<std::size_t>(size) * 4u * static_cast<std::size_t>(array.layers) * 4u / 3u;
+        arrays.push_back(array);
+    }
+
+    deleteArrays(m_arrays);
+    m_arrays = std::move(arrays);
+    m_placements = std::move(placements);
+    // The array layer is now the only copy.
+    for (Texture* texture : packedNow)
+        texture->releaseStandalone();
+
+    stats.arrayCount = m_arrays.size();
+    stats.standaloneTextures = standalone;
+    stats.pendingTextures = m_stats.pendingTextures;
+    stats.lastPackMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    m_stats = stats;
+
+    if (!packedNow.empty()) {
+        LOG_INFO(logging::Category::Texture, "[MaterialTextureArrays] Packed {} new textures ({} in total, {} resampled) into {} arrays in {:.1f} ms",
+            packedNow.size(), m_stats.packedTextures, m_stats.resampledTextures, m_stats.arrayCount, m_stats.lastPackMs);
+    }
+}
+
+std::int32_t MaterialTextureArrays::packedReference(const Texture* texture) const
+{
+    if (texture == nullptr)
+        return kNotPacked;
+    const auto it = m_placements.find(texture);
+    return it == m_placements.end() ? kNotPacked : it->second.reference;
+}
+
+void MaterialTextureArrays::bind() const
+{
+    for (std::size_t i = 0; i < kMaxArrays; ++i) {
+        const GLuint unit = TextureUnits::MaterialArray_Units[i];
+        if (i < m_arrays.size()) {
+            glBindTextureUnit(unit, m_arrays[i].texture);
+            glBindSampler(unit, m_arrays[i].sampler);
+        } else {
+            glBindTextureUnit(unit, 0);
+            glBindSampler(unit, 0);
+        }
+    }
+}
+
+void MaterialTextureArrays::drawImGuiPanel()
+{
+    Settings settings = m_settings;
+    bool dirty = ImGui::Checkbox("Pack Material Textures", &settings.enabled);
+    dirty |= ImGui::Checkbox("Allow Resample To Size Class", &settings.allowResample);
+    dirty |= ImGui::SliderInt("Min Size Class", &settings.minSizeClass, 16, 4096, "%d", ImGuiSliderFlags_Logarithmic);
+    dirty |= ImGui::SliderInt("Max Size Class", &settings.maxSizeClass, 16, 4096, "%d", ImGuiSliderFlags_Logarithmic);
+    if (dirty)
+        setSettings(settings);
+    if (!m_placements.empty())
+        ImGui::TextDisabled("Settings apply to new textures; packed ones have no standalone copy left.");
+
+    ImGui::Text("Arrays: %zu / %zu | packed %zu (%zu resampled) | standalone %zu | resampling %zu",
+        m_stats.arrayCount,
+        kMaxArrays,
+        m_stats.packedTextures,
+        m_stats.resampledTextures,
+        m_stats.standaloneTextures,
+        m_stats.pendingTextures);
+    ImGui::Text("Array memory: %.1f MB | last pack %.1f ms",
+        static_cast<double>(m_stats.gpuBytes) / (1024.0 * 1024.0),
+        static_cast<double>(m_stats.lastPackMs));
+    for (std::size_t i = 0; i < m_arrays.size(); ++i) {
+        const TextureArray& array = m_arrays[i];
+        ImGui::BulletText("#%zu: %dx%d %s, %d layers", i, array.key.size, array.key.size, array.key.srgb ? "sRGB" : "linear", array.layers);
+    }
+}
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "rendering/TextureUnits.h"
+#include "rendering/texture.h"
+
+#include <framework/opengl_includes.h>
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class MeshInstance;
+
+// Import-time packer that moves material textures into a handful of GL_TEXTURE_2D_ARRAYs, grouped by
+// size class, colour space and sampler state. Materials then address a texture as (array, layer), so
+// draws with different materials keep the same texture bindings. Layers are resampled on a worker
+// thread; once uploaded, a texture's standalone GL texture and CPU pixels are freed, so it stays in
+// its array (moved on the GPU) across later repacks and settings changes.
+class MaterialTextureArrays {
+public:
+    static constexpr std::size_t kMaxArrays = TextureUnits::MaterialArray_Count;
+    static constexpr std::int32_t kNotPacked = -1;
+    static constexpr int kLayerBits = 16;
+    static constexpr std::int32_t kLayerMask = (1 << kLayerBits) - 1;
+
+    struct Settings {
+        bool enabled { true };
+        // Non-square or off-class textures are resampled into the nearest size class; otherwise they stay standalone.
+        bool allowResample { true };
+        int minSizeClass { 256 };
+        int maxSizeClass { 2048 };
+    };
+
+    struct Stats {
+        std::size_t arrayCount { 0 };
+        std::size_t packedTextures { 0 };
+        std::size_t resampledTextures { 0 };
+        std::size_t standaloneTextures { 0 };
+        std::size_t pendingTextures { 0 }; // being resampled on the worker
+        std::size_t gpuBytes { 0 };
+        float lastPackMs { 0.0f };
+    };
+
+    MaterialTextureArrays() = default;
+    ~MaterialTextureArrays();
+
+    MaterialTextureArrays(const MaterialTextureArrays&) = delete;
+    MaterialTextureArrays& operator=(const MaterialTextureArrays&) = delete;
+
+    // Call once per frame. When the set of mesh instances changed (new imports or removals) the arrays
+    // are relaid out and new textures are queued for resampling; finished layers are uploaded here.
+    void sync(const std::vector<MeshInstance>& instances);
+
+    // Packed reference for the shaders: (array << 16) | layer, or kNotPacked.
+    [[nodiscard]] std::int32_t packedReference(const Texture* texture) const;
+    void bind() const;
+
+    void setSettings(const Settings& settings);
+    [[nodiscard]] const Settings& settings() const { return m_settings; }
+    [[nodiscard]] const Stats& stats() const { return m_stats; }
+    void drawImGuiPanel();
+
+private:
+    struct ArrayKey {
+        int size { 0 };
+        bool srgb { false };
+        TextureSamplerSettings sampler {};
+
+        [[nodiscard]] bool operator==(const ArrayKey& other) const;
+    };
+
+    struct TextureArray {
+        ArrayKey key;
+        GLuint texture { 0 };
+        GLuint sampler { 0 };
+        int layers { 0 };
+    };
+
+    struct Placement {
+        ArrayKey key;
+        std::int32_t reference { kNotPacked };
+        bool resampled { false };
+    };
+
+    // RGBA8 base level of a layer, built off the main thread.
+    struct PreparedLayer {
+        std::shared_ptr<Texture> texture;
+        ArrayKey key;
+        std::vector<uint8_t> pixels;
+        bool resampled { false };
+    };
+
+    struct ResampleJob {
+        std::uint64_t settingsVersion { 0 }; // results of older settings are discarded
+        std::future<std::vector<PreparedLayer>> done;
+    };
+
+    [[nodiscard]] int sizeClassFor(const Texture& texture) const;
+    [[nodiscard]] static std::uint64_t signatureOf(const std::vector<MeshInstance>& instances);
+    void startResample(const std::vector<MeshInstance>& instances);
+    // Rebuilds the arrays from the packed textures still in use plus `prepared`; GL calls only.
+    void pack(const std::vector<MeshInstance>& instances, std::vector<PreparedLayer> prepared);
+    void deleteArrays(std::vector<TextureArray>& arrays);
+
+    Settings m_settings;
+    Stats m_stats;
+    std::vector<TextureArray> m_arrays;
+    std::unordered_map<const Texture*, Placement> m_placements;
+    ResampleJob m_job;
+    std::uint64_t m_signature { 0 };
+    std::uint64_t m_settingsVersion { 0 };
+    bool m_resampleWanted { false };
+};
@@ -0,0 +1,518 @@
+// SPDX-License-Identifier: MIT
+#include "rendering/MeshletCuller.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <imgui/imgui.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <glm/gtc/type_ptr.hpp>
+DISABLE_WARNINGS_POP()
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESHLET_CULL_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+constexpr GLuint kMeshletBinding = 6;
+constexpr GLuint kCommandBinding = 7;
+constexpr GLuint kStatsBinding = 8;
+constexpr GLuint kCullWorkgroupSize = 64;
+
+// std430 layout of shaders/meshlet_cull.comp.
+struct GpuMeshlet {
+    glm::vec4 sphere;
+    glm::vec4 cone;
+    glm::uvec4 range;
+};
+static_assert(sizeof(GpuMeshlet) == 48, "GpuMeshlet must match the std430 layout");
+
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+[[nodiscard]] glm::vec4 matrixRow(const glm::mat4& m, int row)
+{
+    return glm::vec4(m[0][row], m[1][row], m[2][row], m[3][row]);
+}
+
+[[nodiscard]] glm::vec4 normalizePlane(const glm::vec4& plane)
+{
+    const float length = glm::length(glm::vec3(plane));
+    if (length < 1e-12f)
+        return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f); // degenerate plane: accept everything
+    return plane / length;
+}
+
+} // namespace
+
+MeshletCuller::~MeshletCuller()
+{
+    for (auto& [key, gpu] : m_gpuMeshlets)
+        releaseGpuMeshlets(gpu);
+    for (StatsReadback& readback : m_statsReadbacks) {
+        if (readback.fence != nullptr)
+            glDeleteSync(readback.fence);
+        if (readback.buffer != 0)
+            glDeleteBuffers(1, &readback.buffer);
+    }
+}
+
+void MeshletCuller::beginFrame()
+{
+    m_lastStats = m_frameStats;
+    m_frameStats = {};
+
+    collectGpuStats();
+    for (std::size_t pass = 0; pass < m_lastStats.size(); ++pass) {
+        PassStats& stats = m_lastStats[pass];
+        if (stats.computeMeshlets == 0)
+            continue;
+        // Until the first read-back lands, report the GPU-culled items as fully submitted.
+        stats.meshletsVisible += m_gpuVisibleValid ? m_gpuVisible[pass * 2] : stats.computeMeshlets;
+        stats.trianglesSubmitted += m_gpuVisibleValid ? m_gpuVisible[pass * 2 + 1] : stats.computeTriangles;
+    }
+
+    for (auto it = m_gpuMeshlets.begin(); it != m_gpuMeshlets.end();) {
+        if (it->second.source.expired()) {
+            releaseGpuMeshlets(it->second);
+            it = m_gpuMeshlets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MeshletCuller::setView(Pass pass, const View& view, FaceCull faceCull)
+{
+    setViews(pass, std::span<const View>(&view, 1), faceCull);
+}
+
+void MeshletCuller::setViews(Pass pass, std::span<const View> views, FaceCull faceCull)
+{
+    m_pass = pass;
+    m_faceCull = faceCull;
+    m_views.assign(views.begin(), views.begin() + static_cast<std::ptrdiff_t>(std::min(views.size(), kMaxViews)));
+}
+
+bool MeshletCuller::cullingActive() const
+{
+    if (!m_settings.enabled || m_views.empty())
+        return false;
+    if (m_pass == Pass::Shadow && !m_settings.shadowViews)
+        return false;
+    return m_settings.frustumCulling || m_settings.coneCulling;
+}
+
+std::uint64_t MeshletCuller::draw(const MeshDrawItem& item, const glm::mat4& model, bool twoSided, GLsizei instanceCount)
+{
+    PassStats& stats = m_frameStats[static_cast<std::size_t>(m_pass)];
+    const std::uint64_t totalTriangles = static_cast<std::uint64_t>(item.geometry.indexCount()) / 3;
+    ++stats.items;
+    stats.trianglesTotal += totalTriangles;
+
+    if (!item.meshlets || !cullingActive()) {
+        item.geometry.drawInstanced(instanceCount);
+        stats.trianglesSubmitted += totalTriangles;
+        ++stats.ranges;
+        return totalTriangles;
+    }
+
+    prepareLocalViews(model, twoSided);
+    if (m_settings.useCompute && ensureComputeProgram())
+        return drawCompute(item, instanceCount, stats);
+    return drawCpu(item, *item.meshlets, instanceCount, stats);
+}
+
+void MeshletCuller::prepareLocalViews(const glm::mat4& model, bool twoSided)
+{
+    // Culling runs in mesh-local space: the planes of (viewProjection * model) bound the same half-spaces
+    // as the world-space frustum, so the local bounding spheres can be tested without transforming them.
+    const glm::mat4 inverseModel = glm::inverse(model);
+    const glm::mat3 linear(model);
+    const float minScale = std::min({ glm::length(linear[0]), glm::length(linear[1]), glm::length(linear[2]) });
+
+    float coneSign = 0.0f;
+    if (m_settings.coneCulling && !twoSided) {
+        if (m_faceCull == FaceCull::Back)
+            coneSign = 1.0f;
+        else if (m_faceCull == FaceCull::Front)
+            coneSign = -1.0f;
+        // A mirroring transform flips the winding the rasterizer sees.
+        if (glm::determinant(linear) < 0.0f)
+            coneSign = -coneSign;
+    }
+
+    m_localViews.resize(m_views.size());
+    for (std::size_t i = 0; i < m_views.size(); ++i) {
+        const View& view = m_views[i];
+        LocalView& local = m_localViews[i];
+
+        local.hasFrustum = view.hasFrustum && m_settings.frustumCulling;
+        if (local.hasFrustum) {
+            const glm::mat4 clip = view.viewProjection * model;
+            const glm::vec4 r0 = matrixRow(clip, 0);
+            const glm::vec4 r1 = matrixRow(clip, 1);
+            const glm::vec4 r2 = matrixRow(clip, 2);
+            const glm::vec4 r3 = matrixRow(clip, 3);
+            local.planes = {
+                normalizePlane(r3 + r0),
+                normalizePlane(r3 - r0),
+                normalizePlane(r3 + r1),
+                normalizePlane(r3 - r1),
+                normalizePlane(r3 + r2),
+                normalizePlane(r3 - r2),
+            };
+        }
+
+        local.eye = glm::vec3(inverseModel * glm::vec4(view.eye, 1.0f));
+        local.maxDistance = (view.maxDistance > 0.0f && minScale > 1e-6f && m_settings.frustumCulling) ? view.maxDistance / minScale : 0.0f;
+        local.coneSign = coneSign;
+    }
+}
+
+void MeshletCuller::cullCpu(const MeshletData& meshlets)
+{
+    const std::size_t padded = meshlets.centerX.size();
+    m_visible.resize(padded);
+
+#ifdef MESHLET_CULL_SSE
+    const __m128 zero = _mm_setzero_ps();
+    for (std::size_t base = 0; base < padded; base += MeshletData::kMeshletLaneWidth) {
+        const __m128 cx = _mm_loadu_ps(meshlets.centerX.data() + base);
+        const __m128 cy = _mm_loadu_ps(meshlets.centerY.data() + base);
+        const __m128 cz = _mm_loadu_ps(meshlets.centerZ.data() + base);
+        const __m128 radius = _mm_loadu_ps(meshlets.radius.data() + base);
+        const __m128 negRadius = _mm_sub_ps(zero, radius);
+
+        __m128 anyVisible = zero;
+        for (const LocalView& view : m_localViews) {
+            __m128 keep = _mm_cmpeq_ps(zero, zero);
+            if (view.hasFrustum) {
+                for (const glm::vec4& plane : view.planes) {
+                    __m128 distance = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.x)), _mm_mul_ps(cy, _mm_set1_ps(plane.y)));
+                    distance = _mm_add_ps(distance, _mm_mul_ps(cz, _mm_set1_ps(plane.z)));
+                    distance = _mm_add_ps(distance, _mm_set1_ps(plane.w));
+                    keep = _mm_and_ps(keep, _mm_cmpge_ps(distance, negRadius));
+                }
+            }
+
+            const __m128 vx = _mm_sub_ps(cx, _mm_set1_ps(view.eye.x));
+            const __m128 vy = _mm_sub_ps(cy, _mm_set1_ps(view.eye.y));
+            const __m128 vz = _mm_sub_ps(cz, _mm_set1_ps(view.eye.z));
+            const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+
+            if (view.maxDistance > 0.0f)
+                keep = _mm_and_ps(keep, _mm_cmple_ps(_mm_sub_ps(length, radius), _mm_set1_ps(view.maxDistance)));
+
+            if (view.coneSign != 0.0f) {
+                const __m128 ax = _mm_loadu_ps(meshlets.coneAxisX.data() + base);
+                const __m128 ay = _mm_loadu_ps(meshlets.coneAxisY.data() + base);
+                const __m128 az = _mm_loadu_ps(meshlets.coneAxisZ.data() + base);
+                const __m128 cutoff = _mm_loadu_ps(meshlets.coneCutoff.data() + base);
+                __m128 facing = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, ax), _mm_mul_ps(vy, ay)), _mm_mul_ps(vz, az));
+                facing = _mm_mul_ps(facing, _mm_set1_ps(view.coneSign));
+                const __m128 culled = _mm_cmpgt_ps(facing, _mm_add_ps(_mm_mul_ps(cutoff, length), radius));
+                keep = _mm_andnot_ps(culled, keep);
+            }
+
+            anyVisible = _mm_or_ps(anyVisible, keep);
+        }
+
+        const int mask = _mm_movemask_ps(anyVisible);
+        for (std::size_t lane = 0; lane < MeshletData::kMeshletLaneWidth; ++lane)
+            m_visible[base + lane] = static_cast<std::uint8_t>((mask >> lane) & 1);
+    }
+#else
+    for (std::size_t i = 0; i < padded; ++i) {
+        const glm::vec3 center(meshlets.centerX[i], meshlets.centerY[i], meshlets.centerZ[i]);
+        const glm::vec3 axis(meshlets.coneAxisX[i], meshlets.coneAxisY[i], meshlets.coneAxisZ[i]);
+        const float radius = meshlets.radius[i];
+
+        bool anyVisible = false;
+        for (const LocalView& view : m_localViews) {
+            bool keep = true;
+            if (view.hasFrustum) {
+                for (const glm::vec4& plane : view.planes)
+                    keep = keep && (glm::dot(glm::vec3(plane), center) + plane.w >= -radius);
+            }
+            const glm::vec3 toCenter = center - view.eye;
+            const float length = glm::length(toCenter);
+            if (view.maxDistance > 0.0f)
+                keep = keep && (length - radius <= view.maxDistance);
+            if (view.coneSign != 0.0f)
+                keep = keep && !(glm::dot(toCenter, axis) * view.coneSign > meshlets.coneCutoff[i] * length + radius);
+            anyVisible = anyVisible || keep;
+        }
+        m_visible[i] = anyVisible ? 1 : 0;
+    }
+#endif
+}
+
+std::uint64_t MeshletCuller::drawCpu(const MeshDrawItem& item, const MeshletData& meshlets, GLsizei instanceCount, PassStats& stats)
+{
+    const auto start = std::chrono::steady_clock::now();
+    cullCpu(meshlets);
+
+    // Adjacent visible meshlets are contiguous in the index buffer, so they merge into one range.
+    m_rangeCounts.clear();
+    m_rangeOffsets.clear();
+    std::uint64_t submitted = 0;
+    std::uint32_t visibleCount = 0;
+    std::uint32_t rangeStart = 0;
+    std::uint32_t rangeTriangles = 0;
+    for (std::uint32_t i = 0; i < meshlets.meshletCount; ++i) {
+        if (!m_visible[i])
+            continue;
+        ++visibleCount;
+        const std::uint32_t first = meshlets.firstTriangle[i];
+        const std::uint32_t count = meshlets.triangleCounts[i];
+        if (rangeTriangles > 0 && rangeStart + rangeTriangles == first) {
+            rangeTriangles += count;
+            continue;
+        }
+        if (rangeTriangles > 0) {
+            m_rangeCounts.push_back(static_cast<GLsizei>(rangeTriangles * 3));
+            m_rangeOffsets.push_back(reinterpret_cast<const void*>(static_cast<std::uintptr_t>(rangeStart) * 3 * sizeof(GLuint)));
+            submitted += rangeTriangles;
+        }
+        rangeStart = first;
+        rangeTriangles = count;
+    }
+    if (rangeTriangles > 0) {
+        m_rangeCounts.push_back(static_cast<GLsizei>(rangeTriangles * 3));
+        m_rangeOffsets.push_back(reinterpret_cast<const void*>(static_cast<std::uintptr_t>(rangeStart) * 3 * sizeof(GLuint)));
+        submitted += rangeTriangles;
+    }
+
+    stats.cullMs += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.meshletsTested += meshlets.meshletCount;
+    stats.meshletsVisible += visibleCount;
+    stats.trianglesSubmitted += submitted;
+    stats.ranges += m_rangeCounts.size();
+
+    if (m_rangeCounts.empty())
+        return 0;
+
+    const GLsizei rangeCount = static_cast<GLsizei>(m_rangeCounts.size());
+    if (instanceCount == 1)
+        item.geometry.drawRanges(m_rangeCounts.data(), m_rangeOffsets.data(), rangeCount);
+    else
+        item.geometry.drawRangesInstanced(m_rangeCounts.data(), m_rangeOffsets.data(), rangeCount, instanceCount);
+    return submitted;
+}
+
+std::uint64_t MeshletCuller::drawCompute(const MeshDrawItem& item, GLsizei instanceCount, PassStats& stats)
+{
+    const MeshletData& meshlets = *item.meshlets;
+    GpuMeshlets& gpu = gpuMeshlets(item.meshlets);
+
+    std::array<glm::vec4, kMaxViews * 6> planes {};
+    std::array<glm::vec4, kMaxViews> eyeRange {};
+    std::array<glm::ivec2, kMaxViews> flags {};
+    for (std::size_t i = 0; i < m_localViews.size(); ++i) {
+        const LocalView& view = m_localViews[i];
+        std::copy(view.planes.begin(), view.planes.end(), planes.begin() + static_cast<std::ptrdiff_t>(i * 6));
+        eyeRange[i] = glm::vec4(view.eye, view.maxDistance);
+        flags[i] = glm::ivec2(view.hasFrustum ? 1 : 0, static_cast<int>(view.coneSign));
+    }
+
+    GLint previousProgram = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+
+    m_cullProgram.bind();
+    glUniform1ui(m_locMeshletCount, meshlets.meshletCount);
+    glUniform1i(m_locViewCount, static_cast<GLint>(m_localViews.size()));
+    glUniform1ui(m_locInstanceCount, static_cast<GLuint>(instanceCount));
+    glUniform4fv(m_locPlanes, static_cast<GLsizei>(planes.size()), glm::value_ptr(planes[0]));
+    glUniform4fv(m_locEyeRange, static_cast<GLsizei>(eyeRange.size()), glm::value_ptr(eyeRange[0]));
+    glUniform2iv(m_locViewFlags, static_cast<GLsizei>(flags.size()), glm::value_ptr(flags[0]));
+
+    glUniform1ui(m_locStatsOffset, static_cast<GLuint>(m_pass) * 2u);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kMeshletBinding, gpu.meshletBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kCommandBinding, gpu.commandBuffer);
+    bindStatsBuffer();
+    glDispatchCompute((meshlets.meshletCount + kCullWorkgroupSize - 1) / kCullWorkgroupSize, 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kMeshletBinding, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kCommandBinding, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kStatsBinding, 0);
+
+    glUseProgram(static_cast<GLuint>(previousProgram));
+    item.geometry.drawIndirect(gpu.commandBuffer, static_cast<GLsizei>(meshlets.meshletCount));
+
+    const std::uint64_t totalTriangles = meshlets.triangleCount;
+    stats.meshletsTested += meshlets.meshletCount;
+    stats.computeMeshlets += meshlets.meshletCount;
+    stats.computeTriangles += totalTriangles;
+    ++stats.ranges;
+    return totalTriangles;
+}
+
+void MeshletCuller::bindStatsBuffer()
+{
+    StatsReadback& readback = m_statsReadbacks[m_statsSlot];
+    if (!readback.used) {
+        if (readback.buffer == 0) {
+            glCreateBuffers(1, &readback.buffer);
+            glNamedBufferStorage(readback.buffer, static_cast<GLsizeiptr>(sizeof(GLuint) * m_gpuVisible.size()), nullptr, GL_DYNAMIC_STORAGE_BIT);
+        }
+        const GLuint zero = 0;
+        glClearNamedBufferData(readback.buffer, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        readback.used = true;
+    }
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kStatsBinding, readback.buffer);
+}
+
+void MeshletCuller::collectGpuStats()
+{
+    // Fence the counters last frame's dispatches wrote, then read every slot whose fence has passed,
+    // oldest first so the newest result wins. Nothing here waits on the GPU.
+    StatsReadback& current = m_statsReadbacks[m_statsSlot];
+    if (current.used) {
+        current.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        current.used = false;
+    }
+    for (std::size_t i = 1; i <= m_statsReadbacks.size(); ++i) {
+        StatsReadback& readback = m_statsReadbacks[(m_statsSlot + i) % m_statsReadbacks.size()];
+        if (readback.fence == nullptr)
+            continue;
+        const GLenum result = glClientWaitSync(readback.fence, 0, 0);
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+            continue;
+        std::array<GLuint, std::tuple_size_v<decltype(m_gpuVisible)>> counters {};
+        glGetNamedBufferSubData(readback.buffer, 0, static_cast<GLsizeiptr>(sizeof(counters)), counters.data());
+        std::copy(counters.begin(), counters.end(), m_gpuVisible.begin());
+        m_gpuVisibleValid = true;
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+    }
+
+    m_statsSlot = (m_statsSlot + 1) % m_statsReadbacks.size();
+    // A slot still unfinished after a full ring is dropped rather than waited for.
+    StatsReadback& next = m_statsReadbacks[m_statsSlot];
+    if (next.fence != nullptr) {
+        glDeleteSync(next.fence);
+        next.fence = nullptr;
+    }
+}
+
+MeshletCuller::GpuMeshlets& MeshletCuller::gpuMeshlets(const std::shared_ptr<const MeshletData>& meshlets)
+{
+    GpuMeshlets& gpu = m_gpuMeshlets[meshlets.get()];
+    // A freed MeshletData can be replaced by a new one at the same address; the weak pointer tells them apart.
+    if (gpu.meshletBuffer != 0 && gpu.source.lock() == meshlets)
+        return gpu;
+
+    releaseGpuMeshlets(gpu);
+    gpu.source = meshlets;
+
+    std::vector<GpuMeshlet> packed(meshlets->meshletCount);
+    for (std::uint32_t i = 0; i < meshlets->meshletCount; ++i) {
+        packed[i].sphere = glm::vec4(meshlets->centerX[i], meshlets->centerY[i], meshlets->centerZ[i], meshlets->radius[i]);
+        packed[i].cone = glm::vec4(meshlets->coneAxisX[i], meshlets->coneAxisY[i], meshlets->coneAxisZ[i], meshlets->coneCutoff[i]);
+        packed[i].range = glm::uvec4(meshlets->firstTriangle[i] * 3, meshlets->triangleCounts[i] * 3, 0, 0);
+    }
+
+    glGenBuffers(1, &gpu.meshletBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, gpu.meshletBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(packed.size() * sizeof(GpuMeshlet)), packed.data(), GL_STATIC_DRAW);
+
+    glGenBuffers(1, &gpu.commandBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, gpu.commandBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+        static_cast<GLsizeiptr>(meshlets->meshletCount * sizeof(DrawElementsIndirectCommand)),
+        nullptr,
+        GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return gpu;
+}
+
+void MeshletCuller::releaseGpuMeshlets(GpuMeshlets& gpu)
+{
+    if (gpu.meshletBuffer != 0)
+        glDeleteBuffers(1, &gpu.meshletBuffer);
+    if (gpu.commandBuffer != 0)
+        glDeleteBuffers(1, &gpu.commandBuffer);
+    gpu.meshletBuffer = 0;
+    gpu.commandBuffer = 0;
+}
+
+bool MeshletCuller::ensureComputeProgram()
+{
+    if (m_computeReady)
+        return true;
+    if (m_computeFailed)
+        return false;
+
+    try {
+        ShaderBuilder builder;
+        builder.addStage(GL_COMPUTE_SHADER, RESOURCE_ROOT "shaders/meshlet_cull.comp");
+        m_cullProgram = builder.build();
+    } catch (const std::exception& e) {
+        std::cerr << "[MeshletCuller] Compute path unavailable, using CPU culling: " << e.what() << std::endl;
+        m_computeFailed = true;
+        return false;
+    }
+
+    m_locMeshletCount = m_cullProgram.getUniformLocation("uMeshletCount");
+    m_locViewCount = m_cullProgram.getUniformLocation("uViewCount");
+    m_locInstanceCount = m_cullProgram.getUniformLocation("uInstanceCount");
+    m_locPlanes = m_cullProgram.getUniformLocation("uPlanes");
+    m_locEyeRange = m_cullProgram.getUniformLocation("uEyeRange");
+    m_locViewFlags = m_cullProgram.getUniformLocation("uViewFlags");
+    m_locStatsOffset = m_cullProgram.getUniformLocation("uStatsOffset");
+    m_computeReady = true;
+    return true;
+}
+
+void MeshletCuller::drawImGuiPanel()
+{
+    ImGui::Checkbox("Meshlet Culling", &m_settings.enabled);
+    ImGui::BeginDisabled(!m_settings.enabled);
+    ImGui::Checkbox("Frustum", &m_settings.frustumCulling);
+    ImGui::SameLine();
+    ImGui::Checkbox("Normal Cone", &m_settings.coneCulling);
+    ImGui::SameLine();
+    ImGui::Checkbox("Shadow Views", &m_settings.shadowViews);
+    ImGui::Checkbox("GPU Compute Path", &m_settings.useCompute);
+    if (m_computeFailed)
+        ImGui::TextDisabled("Compute shader failed to build; using the CPU path.");
+    ImGui::EndDisabled();
+
+    const char* passNames[] = { "Main", "Shadow" };
+    for (std::size_t pass = 0; pass < m_lastStats.size(); ++pass) {
+        const PassStats& stats = m_lastStats[pass];
+        ImGui::Separator();
+        ImGui::Text("%s: %llu items, %llu draw ranges", passNames[pass],
+            static_cast<unsigned long long>(stats.items),
+            static_cast<unsigned long long>(stats.ranges));
+        ImGui::Text("  Meshlets visible: %llu / %llu",
+            static_cast<unsigned long long>(stats.meshletsVisible),
+            static_cast<unsigned long long>(stats.meshletsTested));
+        if (stats.computeMeshlets > 0)
+            ImGui::TextDisabled("  %llu meshlets culled on the GPU; counts read back a few frames late.",
+                static_cast<unsigned long long>(stats.computeMeshlets));
+        const double submittedPct = stats.trianglesTotal > 0
+            ? 100.0 * static_cast<double>(stats.trianglesSubmitted) / static_cast<double>(stats.trianglesTotal)
+            : 100.0;
+        ImGui::Text("  Triangles: %llu / %llu (%.1f%%)",
+            static_cast<unsigned long long>(stats.trianglesSubmitted),
+            static_cast<unsigned long long>(stats.trianglesTotal),
+            submittedPct);
+        ImGui::Text("  CPU cull time: %.3f ms", static_cast<double>(stats.cullMs));
+    }
+}
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "mesh/MeshInstance.h"
+
+#include <framework/opengl_includes.h>
+#include <framework/shader.h>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Per-meshlet frustum and normal-cone culling for draw items that were split into meshlets at import.
+// A pass sets one or more views; a meshlet is drawn when any of them accepts it. The CPU path tests
+// four meshlets per SSE register and submits the surviving index ranges with one glMultiDrawElements;
+// the optional compute path writes one indirect command per meshlet and draws them indirectly, counting
+// the surviving meshlets into a small buffer that is read back a few frames later without stalling.
+class MeshletCuller {
+public:
+    static constexpr std::size_t kMaxViews = 8;
+
+    enum class Pass {
+        Main = 0,
+        Shadow,
+        Count
+    };
+
+    // Faces the rasterizer discards in the pass. Cone culling drops clusters made only of those faces,
+    // so shadow passes rendering with glCullFace(GL_FRONT) drop fully light-facing clusters instead.
+    enum class FaceCull {
+        None,
+        Back,
+        Front
+    };
+
+    struct View {
+        glm::mat4 viewProjection { 1.0f };
+        glm::vec3 eye { 0.0f }; // camera or light position used for the cone test
+        bool hasFrustum { true };
+        float maxDistance { 0.0f }; // > 0 limits visibility to a sphere around `eye` (point light range)
+    };
+
+    struct Settings {
+        bool enabled { true };
+        bool frustumCulling { true };
+        bool coneCulling { true };
+        bool shadowViews { true };
+        bool useCompute { false };
+    };
+
+    struct PassStats {
+        std::uint64_t items { 0 };
+        std::uint64_t meshletsTested { 0 };
+        std::uint64_t meshletsVisible { 0 };
+        std::uint64_t trianglesTotal { 0 };
+        std::uint64_t trianglesSubmitted { 0 };
+        std::uint64_t ranges { 0 };
+        float cullMs { 0.0f };
+        // Meshlets and triangles of items culled on the GPU. Their visible share is included in
+        // meshletsVisible / trianglesSubmitted from the latest finished read-back.
+        std::uint64_t computeMeshlets { 0 };
+        std::uint64_t computeTriangles { 0 };
+    };
+
+    MeshletCuller() = default;
+    ~MeshletCuller();
+
+    MeshletCuller(const MeshletCuller&) = delete;
+    MeshletCuller& operator=(const MeshletCuller&) = delete;
+
+    // Publishes last frame's statistics and releases GPU meshlet buffers of destroyed meshes.
+    void beginFrame();
+
+    void setView(Pass pass, const View& view, FaceCull faceCull);
+    void setViews(Pass pass, std::span<const View> views, FaceCull faceCull);
+
+    // Draws the item through its visible meshlets, or whole when it has none or culling is off for the
+    // pass. `twoSided` disables cone culling. Returns the number of triangles submitted per instance
+    // (for the compute path this is the item total, as the visible count is only read back later).
+    std::uint64_t draw(const MeshDrawItem& item, const glm::mat4& model, bool twoSided = false, GLsizei instanceCount = 1);
+
+    [[nodiscard]] const Settings& settings() const { return m_settings; }
+    void setSettings(const Settings& settings) { m_settings = settings; }
+    [[nodiscard]] const PassStats& stats(Pass pass) const { return m_lastStats[static_cast<std::size_t>(pass)]; }
+    void drawImGuiPanel();
+
+private:
+    struct LocalView {
+        std::array<glm::vec4, 6> planes {};
+        glm::vec3 eye { 0.0f };
+        float maxDistance { 0.0f };
+        bool hasFrustum { true };
+        float coneSign { 0.0f }; // +1 culls back-facing clusters, -1 front-facing ones, 0 disables the test
+    };
+
+    struct GpuMeshlets {
+        std::weak_ptr<const MeshletData> source;
+        GLuint meshletBuffer { 0 };
+        GLuint commandBuffer { 0 };
+    };
+
+    // One frame's GPU visibility counters: (meshlets, triangles) per pass.
+    struct StatsReadback {
+        GLuint buffer { 0 };
+        GLsync fence { nullptr };
+        bool used { false };
+    };
+    static constexpr std::size_t kStatsReadbackFrames = 4;
+
+    [[nodiscard]] bool cullingActive() const;
+    void prepareLocalViews(const glm::mat4& model, bool twoSided);
+    void cullCpu(const MeshletData& meshlets);
+    std::uint64_t drawCpu(const MeshDrawItem& item, const MeshletData& meshlets, GLsizei instanceCount, PassStats& stats);
+    std::uint64_t drawCompute(const MeshDrawItem& item, GLsizei instanceCount, PassStats& stats);
+    [[nodiscard]] GpuMeshlets& gpuMeshlets(const std::shared_ptr<const MeshletData>& meshlets);
+    [[nodiscard]] bool ensureComputeProgram();
+    void collectGpuStats();
+    void bindStatsBuffer();
+    static void releaseGpuMeshlets(GpuMeshlets& gpu);
+
+    Settings m_settings;
+    Pass m_pass { Pass::Main };
+    FaceCull m_faceCull { FaceCull::Back };
+    std::vector<View> m_views;
+    std::vector<LocalView> m_localViews;
+
+    std::vector<std::uint8_t> m_visible;
+    std::vector<GLsizei> m_rangeCounts;
+    std::vector<const void*> m_rangeOffsets;
+
+    std::array<PassStats, static_cast<std::size_t>(Pass::Count)> m_frameStats {};
+    std::array<PassStats, static_cast<std::size_t>(Pass::Count)> m_lastStats {};
+
+    std::array<StatsReadback, kStatsReadbackFrames> m_statsReadbacks {};
+    std::size_t m_statsSlot { 0 };
+    std::array<std::uint64_t, 2 * static_cast<std::size_t>(Pass::Count)> m_gpuVisible {}; // meshlets, triangles per pass
+    bool m_gpuVisibleValid { false };
+
+    std::unordered_map<const MeshletData*, GpuMeshlets> m_gpuMeshlets;
+    Shader m_cullProgram;
+    bool m_computeReady { false };
+    bool m_computeFailed { false };
+    GLint m_locMeshletCount { -1 };
+    GLint m_locViewCount { -1 };
+    GLint m_locInstanceCount { -1 };
+    GLint m_locPlanes { -1 };
+    GLint m_locEyeRange { -1 };
+    GLint m_locViewFlags { -1 };
+    GLint m_locStatsOffset { -1 };
+};
@@ -0,0 +1,453 @@
+// SPDX-License-Identifier: MIT
+#include "rendering/PassDiagnostics.h"
+
+#include "mesh/MeshManager.h"
+#include "rendering/TextureUnits.h"
+
+#include <framework/disable_all_warnings.h>
+#include <framework/log.h>
+DISABLE_WARNINGS_PUSH()
+#include <GLFW/glfw3.h>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/vec2.hpp>
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <exception>
+#include <string_view>
+
+// ARB_pipeline_statistics_query targets; the loader is generated for core 4.5, which lacks them.
+#ifndef GL_PRIMITIVES_SUBMITTED
+#define GL_PRIMITIVES_SUBMITTED 0x82EF
+#endif
+#ifndef GL_VERTEX_SHADER_INVOCATIONS
+#define GL_VERTEX_SHADER_INVOCATIONS 0x82F0
+#endif
+#ifndef GL_FRAGMENT_SHADER_INVOCATIONS
+#define GL_FRAGMENT_SHADER_INVOCATIONS 0x82F4
+#endif
+#ifndef GL_CLIPPING_OUTPUT_PRIMITIVES
+#define GL_CLIPPING_OUTPUT_PRIMITIVES 0x82F7
+#endif
+
+namespace {
+
+// The visualizations borrow the per-material units, which every draw rebinds anyway.
+constexpr GLuint kStencilUnit = TextureUnits::Material_Albedo;
+constexpr GLuint kDepthUnit = TextureUnits::Material_Albedo;
+
+constexpr std::array<GLenum, PassDiagnostics::kCounterCount> kCounterTargets {
+    GL_VERTEX_SHADER_INVOCATIONS,
+    GL_PRIMITIVES_SUBMITTED,
+    GL_CLIPPING_OUTPUT_PRIMITIVES,
+    GL_FRAGMENT_SHADER_INVOCATIONS,
+};
+
+constexpr std::array<const char*, PassDiagnostics::kPassCount> kPassNames {
+    "Shadows", "Opaque", "Transparent", "Overlay", "Post Process"
+};
+
+[[nodiscard]] bool hasGlExtension(std::string_view name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const auto* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension && name == extension)
+            return true;
+    }
+    return false;
+}
+
+void setUniform(const Shader& shader, const char* name, int value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform1i(loc, value);
+}
+
+void setUniform(const Shader& shader, const char* name, float value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform1f(loc, value);
+}
+
+void setUniform(const Shader& shader, const char* name, const glm::vec2& value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform2fv(loc, 1, glm::value_ptr(value));
+}
+
+void setUniform(const Shader& shader, const char* name, const glm::mat4& value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+[[nodiscard]] double ratio(std::uint64_t numerator, std::uint64_t denominator)
+{
+    return denominator > 0 ? static_cast<double>(numerator) / static_cast<double>(denominator) : 0.0;
+}
+
+// Leaves the blend, depth and cull state of the surrounding frame as it was found.
+class ScopedOverlayState {
+public:
+    ScopedOverlayState()
+    {
+        m_blend = glIsEnabled(GL_BLEND);
+        m_depthTest = glIsEnabled(GL_DEPTH_TEST);
+        m_cullFace = glIsEnabled(GL_CULL_FACE);
+        glGetIntegerv(GL_BLEND_SRC_RGB, &m_blendSrcRgb);
+        glGetIntegerv(GL_BLEND_DST_RGB, &m_blendDstRgb);
+        glGetIntegerv(GL_BLEND_SRC_ALPHA, &m_blendSrcAlpha);
+        glGetIntegerv(GL_BLEND_DST_ALPHA, &m_blendDstAlpha);
+        glGetIntegerv(GL_CURRENT_PROGRAM, &m_program);
+        glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &m_vertexArray);
+        glGetBooleanv(GL_DEPTH_WRITEMASK, &m_depthMask);
+    }
+
+    ~ScopedOverlayState()
+    {
+        setEnabled(GL_BLEND, m_blend);
+        setEnabled(GL_DEPTH_TEST, m_depthTest);
+        setEnabled(GL_CULL_FACE, m_cullFace);
+        glBlendFuncSeparate(static_cast<GLenum>(m_blendSrcRgb), static_cast<GLenum>(m_blendDstRgb),
+            static_cast<GLenum>(m_blendSrcAlpha), static_cast<GLenum>(m_blendDstAlpha));
+        glUseProgram(static_cast<GLuint>(m_program));
+        glBindVertexArray(static_cast<GLuint>(m_vertexArray));
+        glDepthMask(m_depthMask);
+    }
+
+    ScopedOverlayState(const ScopedOverlayState&) = delete;
+    ScopedOverlayState& operator=(const ScopedOverlayState&) = delete;
+
+private:
+    static void setEnabled(GLenum capability, GLboolean enabled)
+    {
+        if (enabled)
+            glEnable(capability);
+        else
+            glDisable(capability);
+    }
+
+    GLboolean m_blend { GL_FALSE };
+    GLboolean m_depthTest { GL_FALSE };
+    GLboolean m_cullFace { GL_FALSE };
+    GLboolean m_depthMask { GL_TRUE };
+    GLint m_blendSrcRgb { GL_ONE };
+    GLint m_blendDstRgb { GL_ZERO };
+    GLint m_blendSrcAlpha { GL_ONE };
+    GLint m_blendDstAlpha { GL_ZERO };
+    GLint m_program { 0 };
+    GLint m_vertexArray { 0 };
+};
+
+} // namespace
+
+PassDiagnostics::~PassDiagnostics()
+{
+    release();
+}
+
+void PassDiagnostics::initialize()
+{
+    release();
+    try {
+        ShaderBuilder heatmapBuilder;
+        heatmapBuilder.addStage(GL_VERTEX_SHADER, RESOURCE_ROOT "shaders/overdraw_heatmap.vert");
+        heatmapBuilder.addStage(GL_FRAGMENT_SHADER, RESOURCE_ROOT "shaders/overdraw_heatmap.frag");
+        m_heatmapShader = heatmapBuilder.build();
+        ShaderBuilder overshadingBuilder;
+        overshadingBuilder.addStage(GL_VERTEX_SHADER, RESOURCE_ROOT "shaders/quad_overshading.vert");
+        overshadingBuilder.addStage(GL_FRAGMENT_SHADER, RESOURCE_ROOT "shaders/quad_overshading.frag");
+        m_overshadingShader = overshadingBuilder.build();
+    } catch (const std::exception& e) {
+        LOG_ERROR(logging::Category::General, "[PassDiagnostics] Visualizations disabled, shaders failed to build: {}", e.what());
+        return;
+    }
+    glCreateVertexArrays(1, &m_emptyVao);
+
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    m_statisticsSupported = major > 4 || (major == 4 && minor >= 6) || hasGlExtension("GL_ARB_pipeline_statistics_query");
+    if (m_statisticsSupported) {
+        for (auto& frame : m_querySets) {
+            for (QuerySet& set : frame) {
+                for (std::size_t counter = 0; counter < kCounterCount; ++counter)
+                    glCreateQueries(kCounterTargets[counter], 1, &set.queries[counter]);
+            }
+        }
+    } else {
+        LOG_WARNING(logging::Category::General, "[PassDiagnostics] Pipeline statistics queries are not supported by this driver");
+    }
+    m_ready = true;
+}
+
+void PassDiagnostics::release()
+{
+    if (glfwGetCurrentContext() != nullptr) {
+        for (auto& frame : m_querySets) {
+            for (QuerySet& set : frame) {
+                if (set.queries.front() != 0)
+                    glDeleteQueries(static_cast<GLsizei>(set.queries.size()), set.queries.data());
+            }
+        }
+        if (m_emptyVao != 0)
+            glDeleteVertexArrays(1, &m_emptyVao);
+    }
+    m_querySets = {};
+    m_stencilCounting = {};
+    m_emptyVao = 0;
+    m_statisticsSupported = false;
+    m_ready = false;
+}
+
+void PassDiagnostics::enableStatisticsLogging(int intervalFrames)
+{
+    m_settings.pipelineStatistics = true;
+    m_settings.logIntervalFrames = std::max(intervalFrames, 1);
+    if (m_ready && !m_statisticsSupported)
+        LOG_WARNING(logging::Category::General, "[PassDiagnostics] --pipeline-stats requested but the driver has no pipeline statistics queries");
+}
+
+void PassDiagnostics::beginFrame(glm::ivec2 framebufferSize)
+{
+    m_framebufferSize = framebufferSize;
+    ++m_frame;
+    if (!m_statisticsSupported)
+        return;
+    collectStatistics();
+    m_frameSlot = (m_frameSlot + 1) % kFramesInFlight;
+    // A set still unread after a full lap is dropped rather than stalled on.
+    for (QuerySet& set : m_querySets[m_frameSlot])
+        set.pending = false;
+    logStatistics();
+}
+
+void PassDiagnostics::beginPass(Pass pass)
+{
+    const std::size_t index = static_cast<std::size_t>(pass);
+    if (m_statisticsSupported && m_settings.pipelineStatistics) {
+        const QuerySet& set = m_querySets[m_frameSlot][index];
+        for (std::size_t counter = 0; counter < kCounterCount; ++counter)
+            glBeginQuery(kCounterTargets[counter], set.queries[counter]);
+    }
+
+    // Every rasterized fragment bumps the capture's stencil; the depth test still decides colour.
+    m_stencilCounting[index] = wantsSceneStencil() && m_settings.overdrawPasses[index];
+    if (m_stencilCounting[index]) {
+        glEnable(GL_STENCIL_TEST);
+        glStencilMask(0xFF);
+        glStencilFunc(GL_ALWAYS, 0, 0xFF);
+        glStencilOp(GL_KEEP, m_settings.countDepthRejected ? GL_INCR : GL_KEEP, GL_INCR);
+    }
+}
+
+void PassDiagnostics::endPass(Pass pass)
+{
+    const std::size_t index = static_cast<std::size_t>(pass);
+    if (m_stencilCounting[index]) {
+        glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+        glDisable(GL_STENCIL_TEST);
+        m_stencilCounting[index] = false;
+    }
+
+    if (m_statisticsSupported && m_settings.pipelineStatistics) {
+        for (std::size_t counter = 0; counter < kCounterCount; ++counter)
+            glEndQuery(kCounterTargets[counter]);
+        m_querySets[m_frameSlot][index].pending = true;
+    }
+}
+
+void PassDiagnostics::collectStatistics()
+{
+    for (auto& frame : m_querySets) {
+        for (std::size_t pass = 0; pass < kPassCount; ++pass) {
+            QuerySet& set = frame[pass];
+            if (!set.pending)
+                continue;
+            bool available = true;
+            for (const GLuint query : set.queries) {
+                GLint ready = 0;
+                glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &ready);
+                available = available && ready != 0;
+            }
+            if (!available)
+                continue;
+
+            Counters& latest = m_latest[pass];
+            for (std::size_t counter = 0; counter < kCounterCount; ++counter) {
+                GLuint64 value = 0;
+                glGetQueryObjectui64v(set.queries[counter], GL_QUERY_RESULT, &value);
+                latest[counter] = value;
+                m_logSums[pass][counter] += value;
+            }
+            ++m_logSamples[pass];
+            set.pending = false;
+        }
+    }
+}
+
+void PassDiagnostics::logStatistics()
+{
+    if (m_settings.logIntervalFrames <= 0 || m_frame % static_cast<std::uint64_t>(m_settings.logIntervalFrames) != 0)
+        return;
+
+    const std::uint64_t pixels = static_cast<std::uint64_t>(std::max(m_framebufferSize.x, 0)) * static_cast<std::uint64_t>(std::max(m_framebufferSize.y, 0));
+    for (std::size_t pass = 0; pass < kPassCount; ++pass) {
+        const std::uint64_t samples = m_logSamples[pass];
+        if (samples == 0)
+            continue;
+        const Counters& sums = m_logSums[pass];
+        const auto average = [&](Counter counter) { return sums[static_cast<std::size_t>(counter)] / samples; };
+        LOG_INFO(logging::Category::General,
+            "[PassDiagnostics] {}: vs {} | primitives {} | clipped {} | fs {} ({:.2f} per pixel) over {} frames",
+            kPassNames[pass], average(Counter::VertexInvocations), average(Counter::PrimitivesSubmitted),
+            average(Counter::ClippingOutputPrimitives), average(Counter::FragmentInvocations),
+            ratio(average(Counter::FragmentInvocations), pixels), samples);
+    }
+    m_logSums = {};
+    m_logSamples = {};
+}
+
+void PassDiagnostics::drawVisualization(MeshManager& meshManager, const glm::mat4& viewProjection,
+    GLuint sceneDepth, GLuint sceneDepthStencil, glm::ivec2 sceneSize, glm::ivec2 framebufferSize)
+{
+    if (!m_ready || sceneSize.x <= 0 || sceneSize.y <= 0)
+        return;
+    if (m_settings.view == View::Overdraw && sceneDepthStencil != 0)
+        drawOverdraw(sceneDepthStencil, sceneSize, framebufferSize);
+    else if (m_settings.view == View::QuadOvershading && sceneDepth != 0)
+        drawQuadOvershading(meshManager, viewProjection, sceneDepth, sceneSize, framebufferSize);
+}
+
+void PassDiagnostics::drawOverdraw(GLuint sceneDepthStencil, glm::ivec2 sceneSize, glm::ivec2 framebufferSize)
+{
+    ScopedOverlayState restore;
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // The depth-stencil texture reads as stencil indices only while in this mode.
+    glTextureParameteri(sceneDepthStencil, GL_DEPTH_STENCIL_TEXTURE_MODE, GL_STENCIL_INDEX);
+    glBindTextureUnit(kStencilUnit, sceneDepthStencil);
+    glBindSampler(kStencilUnit, 0);
+
+    m_heatmapShader.bind();
+    setUniform(m_heatmapShader, "uStencil", static_cast<int>(kStencilUnit));
+    setUniform(m_heatmapShader, "uPixelToTexel", glm::vec2(sceneSize) / glm::vec2(glm::max(framebufferSize, glm::ivec2(1))));
+    setUniform(m_heatmapShader, "uScale", static_cast<float>(std::max(m_settings.overdrawScale, 1)));
+    setUniform(m_heatmapShader, "uOpacity", m_settings.opacity);
+    glBindVertexArray(m_emptyVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glTextureParameteri(sceneDepthStencil, GL_DEPTH_STENCIL_TEXTURE_MODE, GL_DEPTH_COMPONENT);
+}
+
+void PassDiagnostics::drawQuadOvershading(MeshManager& meshManager, const glm::mat4& viewProjection,
+    GLuint sceneDepth, glm::ivec2 sceneSize, glm::ivec2 framebufferSize)
+{
+    ScopedOverlayState restore;
+    // Depth is compared in the shader against the scene's, after the quad has been counted: a depth
+    // test could kill lanes before they are seen.
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glBindTextureUnit(kDepthUnit, sceneDepth);
+    glBindSampler(kDepthUnit, 0);
+
+    m_overshadingShader.bind();
+    setUniform(m_overshadingShader, "uSceneDepth", static_cast<int>(kDepthUnit));
+    setUniform(m_overshadingShader, "uPixelToTexel", glm::vec2(sceneSize) / glm::vec2(glm::max(framebufferSize, glm::ivec2(1))));
+    setUniform(m_overshadingShader, "uOpacity", m_settings.opacity);
+    setUniform(m_overshadingShader, "uViewProjection", viewProjection);
+    for (MeshInstance& instance : meshManager.instances()) {
+        for (MeshDrawItem& item : instance.drawItems()) {
+            if (!item.geometry.resident() || item.material.alphaMode == AlphaMode::Blend || item.material.isTransparent)
+                continue;
+            setUniform(m_overshadingShader, "uModel", instance.transform() * item.nodeTransform);
+            item.geometry.draw(m_overshadingShader);
+        }
+    }
+}
+
+void PassDiagnostics::drawImGuiPanel()
+{
+    if (!m_ready) {
+        ImGui::TextDisabled("Unavailable: shaders failed to build.");
+        return;
+    }
+
+    int view = static_cast<int>(m_settings.view);
+    ImGui::RadioButton("Off", &view, static_cast<int>(View::Off));
+    ImGui::SameLine();
+    ImGui::RadioButton("Overdraw", &view, static_cast<int>(View::Overdraw));
+    ImGui::SameLine();
+    ImGui::RadioButton("Quad Overshading", &view, static_cast<int>(View::QuadOvershading));
+    m_settings.view = static_cast<View>(view);
+
+    if (m_settings.view == View::Overdraw) {
+        ImGui::TextUnformatted("Counted passes:");
+        for (const Pass pass : { Pass::Opaque, Pass::Transparent, Pass::Overlay }) {
+            const std::size_t index = static_cast<std::size_t>(pass);
+            ImGui::SameLine();
+            bool counted = m_settings.overdrawPasses[index];
+            if (ImGui::Checkbox(kPassNames[index], &counted))
+                m_settings.overdrawPasses[index] = counted;
+        }
+        ImGui::Checkbox("Count Depth-Rejected Fragments", &m_settings.countDepthRejected);
+        ImGui::SliderInt("Ramp Maximum", &m_settings.overdrawScale, 2, 64, "%d layers");
+        ImGui::TextDisabled("blue: 1 layer ... red: ramp maximum, white: above");
+    } else if (m_settings.view == View::QuadOvershading) {
+        ImGui::TextDisabled("Opaque geometry. Lanes of each 2x2 quad covering the triangle:");
+        ImGui::TextDisabled("red 1/4, orange 2/4, yellow 3/4, green 4/4");
+    }
+    if (m_settings.view != View::Off)
+        ImGui::SliderFloat("Overlay Opacity", &m_settings.opacity, 0.1f, 1.0f, "%.2f");
+
+    ImGui::Separator();
+    if (!m_statisticsSupported) {
+        ImGui::TextDisabled("Pipeline statistics queries are not supported by this driver.");
+        return;
+    }
+    ImGui::Checkbox("Pipeline Statistics", &m_settings.pipelineStatistics);
+    if (!m_settings.pipelineStatistics)
+        return;
+    ImGui::SliderInt("Log Every", &m_settings.logIntervalFrames, 0, 600, m_settings.logIntervalFrames > 0 ? "%d frames" : "never");
+
+    const double pixels = static_cast<double>(std::max(m_framebufferSize.x, 0)) * static_cast<double>(std::max(m_framebufferSize.y, 0));
+    if (ImGui::BeginTable("PassStatistics", 7, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("VS Inv.");
+        ImGui::TableSetupColumn("Prims");
+        ImGui::TableSetupColumn("Clipped");
+        ImGui::TableSetupColumn("FS Inv.");
+        ImGui::TableSetupColumn("FS/Pixel");
+        ImGui::TableSetupColumn("FS/Prim");
+        ImGui::TableHeadersRow();
+        for (std::size_t pass = 0; pass < kPassCount; ++pass) {
+            const Counters& counters = m_latest[pass];
+            const std::uint64_t fragments = counters[static_cast<std::size_t>(Counter::FragmentInvocations)];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(kPassNames[pass]);
+            for (std::size_t counter = 0; counter < kCounterCount; ++counter) {
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", static_cast<unsigned long long>(counters[counter]));
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.2f", pixels > 0.0 ? static_cast<double>(fragments) / pixels : 0.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", ratio(fragments, counters[static_cast<std::size_t>(Counter::ClippingOutputPrimitives)]));
+        }
+        ImGui::EndTable();
+    }
+    ImGui::TextDisabled("FS/Pixel is the pass's average overdraw; a low FS/Prim means tiny triangles.");
+}
@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <framework/opengl_includes.h>
+#include <framework/shader.h>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+
+#include <array>
+#include <cstdint>
+
+class MeshManager;
+
+// Per-pass GPU workload diagnostics, going beyond RenderStats' draw and triangle counts:
+// - Pipeline statistics (ARB_pipeline_statistics_query, core since 4.6): vertex shader invocations,
+//   primitives submitted, primitives leaving clipping and fragment shader invocations of every pass,
+//   read back a few frames late so they never stall. Mesa's llvmpipe exposes them, so headless runs
+//   can log them (see enableStatisticsLogging).
+// - Overdraw: the scene capture gets a stencil buffer that every fragment of the selected passes
+//   increments; after post-processing an overlay maps the per-pixel count to a heat ramp.
+// - Quad overshading: opaque geometry is redrawn over the final image with a shader that counts, via
+//   fine derivatives of gl_HelperInvocation, how many lanes of each 2x2 quad actually cover the
+//   triangle. Small or thin triangles show up red (1 of 4 lanes useful), large ones green.
+class PassDiagnostics {
+public:
+    enum class Pass : int {
+        Shadows = 0,
+        Opaque,
+        Transparent,
+        Overlay, // second skybox and depth-tested debug primitives
+        PostProcess,
+        Count
+    };
+
+    enum class View : int {
+        Off = 0,
+        Overdraw,
+        QuadOvershading
+    };
+
+    enum class Counter : int {
+        VertexInvocations = 0,
+        PrimitivesSubmitted,
+        ClippingOutputPrimitives,
+        FragmentInvocations,
+        Count
+    };
+
+    static constexpr std::size_t kPassCount = static_cast<std::size_t>(Pass::Count);
+    static constexpr std::size_t kCounterCount = static_cast<std::size_t>(Counter::Count);
+    using Counters = std::array<std::uint64_t, kCounterCount>;
+
+    struct Settings {
+        View view { View::Off };
+        // Passes whose fragments the overdraw view counts. Only passes drawn into the scene capture
+        // can be counted; shadows and post-processing render elsewhere.
+        std::array<bool, kPassCount> overdrawPasses { false, true, true, true, false };
+        // Fragments that fail the depth test were still rasterized and tested.
+        bool countDepthRejected { true };
+        int overdrawScale { 8 }; // layer count at the hot end of the ramp
+        float opacity { 0.85f };
+        bool pipelineStatistics { false };
+        int logIntervalFrames { 0 }; // 0 = never
+    };
+
+    PassDiagnostics() = default;
+    ~PassDiagnostics();
+    PassDiagnostics(const PassDiagnostics&) = delete;
+    PassDiagnostics& operator=(const PassDiagnostics&) = delete;
+
+    void initialize();
+    void release();
+
+    // Collects finished statistics queries. Call once per frame before the first pass.
+    void beginFrame(glm::ivec2 framebufferSize);
+    void beginPass(Pass pass);
+    void endPass(Pass pass);
+
+    // The scene capture must carry a stencil buffer for the overdraw view.
+    [[nodiscard]] bool wantsSceneStencil() const { return m_ready && m_settings.view == View::Overdraw; }
+
+    // Draws the selected view over the current framebuffer. `sceneDepthStencil` is the resolved scene
+    // depth texture (DEPTH32F_STENCIL8 when the stencil was requested, else 0 disables the overdraw
+    // view for this frame).
+    void drawVisualization(MeshManager& meshManager, const glm::mat4& viewProjection,
+        GLuint sceneDepth, GLuint sceneDepthStencil, glm::ivec2 sceneSize, glm::ivec2 framebufferSize);
+
+    // Turns on pipeline statistics and logs per-pass averages every `intervalFrames` frames.
+    void enableStatisticsLogging(int intervalFrames);
+
+    [[nodiscard]] bool statisticsSupported() const { return m_statisticsSupported; }
+    // Latest read-back counters of a pass; zero until the first query completes.
+    [[nodiscard]] const Counters& counters(Pass pass) const { return m_latest[static_cast<std::size_t>(pass)]; }
+    [[nodiscard]] Settings& settings() { return m_settings; }
+
+    void drawImGuiPanel();
+
+private:
+    // Frames a query set may stay in flight before it is dropped.
+    static constexpr std::size_t kFramesInFlight = 4;
+
+    struct QuerySet {
+        std::array<GLuint, kCounterCount> queries {};
+        bool pending { false };
+    };
+
+    void collectStatistics();
+    void logStatistics();
+    void drawOverdraw(GLuint sceneDepthStencil, glm::ivec2 sceneSize, glm::ivec2 framebufferSize);
+    void drawQuadOvershading(MeshManager& meshManager, const glm::mat4& viewProjection,
+        GLuint sceneDepth, glm::ivec2 sceneSize, glm::ivec2 framebufferSize);
+
+    Settings m_settings;
+    bool m_ready { false };
+    bool m_statisticsSupported { false };
+
+    Shader m_heatmapShader;
+    Shader m_overshadingShader;
+    GLuint m_emptyVao { 0 };
+
+    std::array<std::array<QuerySet, kPassCount>, kFramesInFlight> m_querySets {};
+    std::size_t m_frameSlot { 0 };
+    std::array<bool, kPassCount> m_stencilCounting {};
+    std::array<Counters, kPassCount> m_latest {};
+    std::array<Counters, kPassCount> m_logSums {};
+    std::array<std::uint64_t, kPassCount> m_logSamples {};
+    std::uint64_t m_frame { 0 };
+    glm::ivec2 m_framebufferSize { 0 };
+};
@@ -0,0 +1,434 @@
+// SPDX-License-Identifier: MIT
+#include "rendering/PhysicalSky.h"
+
+#include "rendering/TextureUnits.h"
+
+#include <framework/disable_all_warnings.h>
+#include <framework/log.h>
+DISABLE_WARNINGS_PUSH()
+#include <GLFW/glfw3.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/trigonometric.hpp>
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+
+namespace {
+
+// The LUTs borrow the per-material units, which every draw rebinds anyway; the environment units
+// (24..27) stay untouched.
+constexpr GLuint kTransmittanceUnit = TextureUnits::Material_Albedo;
+constexpr GLuint kMultiScatteringUnit = TextureUnits::Material_Normal;
+constexpr GLuint kSkyViewUnit = TextureUnits::Material_MetallicRoughness;
+constexpr GLuint kSkyCubeUnit = TextureUnits::Material_AO;
+constexpr GLuint kTarget2DImage = 0;
+constexpr GLuint kTargetCubeImage = 1;
+constexpr GLuint kShBinding = 2;
+constexpr int kShMip = 2; // 16x16 faces are plenty for L2 SH
+constexpr GLbitfield kPassBarriers = GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT;
+
+constexpr int mipCount(int size)
+{
+    int levels = 1;
+    while (size > 1) {
+        size /= 2;
+        ++levels;
+    }
+    return levels;
+}
+
+constexpr GLuint groupCount(int size)
+{
+    return static_cast<GLuint>((size + 7) / 8);
+}
+
+GLuint createLut(int width, int height)
+{
+    GLuint texture = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+    glTextureStorage2D(texture, 1, GL_RGBA16F, width, height);
+    glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+GLuint createCube(int size, int levels)
+{
+    GLuint texture = 0;
+    glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &texture);
+    glTextureStorage2D(texture, levels, GL_RGBA16F, size, size);
+    glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(texture, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+void setUniform(const Shader& shader, const char* name, int value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform1i(loc, value);
+}
+
+void setUniform(const Shader& shader, const char* name, float value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform1f(loc, value);
+}
+
+void setUniform(const Shader& shader, const char* name, const glm::vec3& value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform3fv(loc, 1, glm::value_ptr(value));
+}
+
+void setUniform(const Shader& shader, const char* name, const glm::mat4& value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+} // namespace
+
+PhysicalSky::~PhysicalSky()
+{
+    release();
+}
+
+void PhysicalSky::initialize()
+{
+    release();
+    try {
+        ShaderBuilder computeBuilder;
+        computeBuilder.addStage(GL_COMPUTE_SHADER, RESOURCE_ROOT "shaders/physical_sky.comp");
+        m_computeShader = computeBuilder.build();
+        ShaderBuilder skyBuilder;
+        skyBuilder.addStage(GL_VERTEX_SHADER, RESOURCE_ROOT "shaders/physical_sky.vert");
+        skyBuilder.addStage(GL_FRAGMENT_SHADER, RESOURCE_ROOT "shaders/physical_sky.frag");
+        m_skyShader = skyBuilder.build();
+    } catch (const std::exception& e) {
+        LOG_ERROR(logging::Category::General, "[PhysicalSky] Disabled, shaders failed to build: {}", e.what());
+        return;
+    }
+    createTextures();
+    glCreateVertexArrays(1, &m_emptyVao);
+    m_atmosphereDirty = true;
+    m_rebuildRequested = true;
+    m_ready = true;
+}
+
+void PhysicalSky::release()
+{
+    if (glfwGetCurrentContext() != nullptr) {
+        const GLuint textures[] = { m_transmittanceLut, m_multiScatteringLut, m_skyViewLut,
+            m_targets[0].sky, m_targets[0].irradiance, m_targets[1].sky, m_targets[1].irradiance };
+        for (const GLuint texture : textures) {
+            if (texture != 0)
+                glDeleteTextures(1, &texture);
+        }
+        if (m_shBuffer != 0)
+            glDeleteBuffers(1, &m_shBuffer);
+        if (m_emptyVao != 0)
+            glDeleteVertexArrays(1, &m_emptyVao);
+        if (m_timerQueries.front() != 0)
+            glDeleteQueries(static_cast<GLsizei>(m_timerQueries.size()), m_timerQueries.data());
+    }
+    m_transmittanceLut = 0;
+    m_multiScatteringLut = 0;
+    m_skyViewLut = 0;
+    m_shBuffer = 0;
+    m_emptyVao = 0;
+    m_targets = {};
+    m_timerQueries = {};
+    m_timerPending = {};
+    m_front = -1;
+    m_stage = Stage::Idle;
+    m_ready = false;
+}
+
+void PhysicalSky::createTextures()
+{
+    m_transmittanceLut = createLut(kTransmittanceWidth, kTransmittanceHeight);
+    m_multiScatteringLut = createLut(kMultiScatteringSize, kMultiScatteringSize);
+    m_skyViewLut = createLut(kSkyViewWidth, kSkyViewHeight);
+    for (Target& target : m_targets) {
+        target.sky = createCube(kCubeSize, mipCount(kCubeSize));
+        target.irradiance = createCube(kIrradianceSize, 1);
+    }
+    glCreateBuffers(1, &m_shBuffer);
+    glNamedBufferStorage(m_shBuffer, 9 * sizeof(glm::vec4), nullptr, 0);
+}
+
+void PhysicalSky::setAtmosphere(const Atmosphere& atmosphere)
+{
+    m_atmosphere = atmosphere;
+    m_atmosphere.topRadiusKm = std::max(m_atmosphere.topRadiusKm, m_atmosphere.bottomRadiusKm + 1.0f);
+    m_atmosphereDirty = true;
+}
+
+GLuint PhysicalSky::skyCubemap() const
+{
+    return m_front >= 0 ? m_targets[static_cast<std::size_t>(m_front)].sky : 0;
+}
+
+GLuint PhysicalSky::irradianceCubemap() const
+{
+    return m_front >= 0 ? m_targets[static_cast<std::size_t>(m_front)].irradiance : 0;
+}
+
+int PhysicalSky::skyMipLevels() const
+{
+    return mipCount(kCubeSize);
+}
+
+glm::vec3 PhysicalSky::manualSunDirection() const
+{
+    const float elevation = glm::radians(m_settings.sunElevationDegrees);
+    const float azimuth = glm::radians(m_settings.sunAzimuthDegrees);
+    return { std::cos(elevation) * std::sin(azimuth), std::sin(elevation), std::cos(elevation) * std::cos(azimuth) };
+}
+
+void PhysicalSky::setAtmosphereUniforms() const
+{
+    const Shader& shader = m_computeShader;
+    setUniform(shader, "uBottomRadius", m_atmosphere.bottomRadiusKm);
+    setUniform(shader, "uTopRadius", m_atmosphere.topRadiusKm);
+    setUniform(shader, "uRayleighScattering", m_atmosphere.rayleighScattering);
+    setUniform(shader, "uRayleighScaleHeight", m_atmosphere.rayleighScaleHeightKm);
+    setUniform(shader, "uMieScattering", m_atmosphere.mieScattering);
+    setUniform(shader, "uMieExtinction", m_atmosphere.mieScattering + m_atmosphere.mieAbsorption);
+    setUniform(shader, "uMieScaleHeight", m_atmosphere.mieScaleHeightKm);
+    setUniform(shader, "uMieG", m_atmosphere.mieAnisotropy);
+    setUniform(shader, "uOzoneAbsorption", m_atmosphere.ozoneAbsorption);
+    setUniform(shader, "uGroundAlbedo", m_atmosphere.groundAlbedo);
+    setUniform(shader, "uObserverAltitude", m_settings.observerAltitudeKm);
+    setUniform(shader, "uSunDirection", m_lutSunDirection);
+}
+
+void PhysicalSky::dispatch(Pass pass, GLuint groupsX, GLuint groupsY, GLuint groupsZ)
+{
+    setUniform(m_computeShader, "uPass", static_cast<int>(pass));
+    glDispatchCompute(groupsX, groupsY, groupsZ);
+    glMemoryBarrier(kPassBarriers);
+}
+
+void PhysicalSky::bakeAtmosphereLuts()
+{
+    glBindImageTexture(kTarget2DImage, m_transmittanceLut, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    dispatch(Pass::Transmittance, groupCount(kTransmittanceWidth), groupCount(kTransmittanceHeight), 1);
+
+    glBindTextureUnit(kTransmittanceUnit, m_transmittanceLut);
+    glBindImageTexture(kTarget2DImage, m_multiScatteringLut, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    dispatch(Pass::MultiScattering, kMultiScatteringSize, kMultiScatteringSize, 1);
+}
+
+void PhysicalSky::update(const std::optional<glm::vec3>& drivenSunDirection)
+{
+    if (!enabled())
+        return;
+
+    m_sunDriven = drivenSunDirection.has_value() && glm::dot(*drivenSunDirection, *drivenSunDirection) > 1e-8f;
+    m_sunDirection = m_sunDriven ? glm::normalize(*drivenSunDirection) : manualSunDirection();
+
+    const float threshold = std::cos(glm::radians(std::max(m_settings.updateThresholdDegrees, 0.0f)));
+    if (glm::dot(m_sunDirection, m_lutSunDirection) < threshold)
+        m_rebuildRequested = true;
+    // A rebuild in flight is finished rather than restarted, so a sun that never stops moving still
+    // gets fresh lighting every few frames.
+    if (m_stage == Stage::Idle && (m_rebuildRequested || m_atmosphereDirty)) {
+        m_stage = Stage::SkyView;
+        m_rebuildRequested = false;
+        m_rebuildFrames = 0;
+    }
+    if (m_stage == Stage::Idle)
+        return;
+
+    beginTiming();
+    m_computeShader.bind();
+    if (m_atmosphereDirty) {
+        setAtmosphereUniforms();
+        bakeAtmosphereLuts();
+        m_atmosphereDirty = false;
+    }
+    glBindTextureUnit(kTransmittanceUnit, m_transmittanceLut);
+    glBindTextureUnit(kMultiScatteringUnit, m_multiScatteringLut);
+    glBindTextureUnit(kSkyViewUnit, m_skyViewLut);
+    for (GLuint unit = kTransmittanceUnit; unit <= kSkyCubeUnit; ++unit)
+        glBindSampler(unit, 0);
+    advance();
+    glBindTextures(kTransmittanceUnit, kSkyCubeUnit - kTransmittanceUnit + 1, nullptr);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kShBinding, 0);
+    endTiming();
+}
+
+void PhysicalSky::advance()
+{
+    ++m_rebuildFrames;
+    const std::size_t back = m_front == 0 ? 1 : 0;
+    const Target& target = m_targets[back];
+
+    switch (m_stage) {
+    case Stage::SkyView:
+        m_lutSunDirection = m_sunDirection;
+        setAtmosphereUniforms();
+        glBindImageTexture(kTarget2DImage, m_skyViewLut, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        dispatch(Pass::SkyView, groupCount(kSkyViewWidth), groupCount(kSkyViewHeight), 1);
+        ++m_stats.skyViewUpdates;
+        m_nextFace = 0;
+        m_stage = Stage::Faces;
+        break;
+    case Stage::Faces: {
+        const int faces = std::min(std::clamp(m_settings.facesPerFrame, 1, 6), 6 - m_nextFace);
+        setAtmosphereUniforms();
+        setUniform(m_computeShader, "uFaceOffset", m_nextFace);
+        glBindImageTexture(kTargetCubeImage, target.sky, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        dispatch(Pass::CubeFaces, groupCount(kCubeSize), groupCount(kCubeSize), static_cast<GLuint>(faces));
+        m_nextFace += faces;
+        if (m_nextFace >= 6)
+            m_stage = Stage::Finalize;
+        break;
+    }
+    case Stage::Finalize:
+        glGenerateTextureMipmap(target.sky);
+        glMemoryBarrier(kPassBarriers);
+        glBindTextureUnit(kSkyCubeUnit, target.sky);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kShBinding, m_shBuffer);
+        setUniform(m_computeShader, "uShMip", static_cast<float>(kShMip));
+        dispatch(Pass::ProjectSH, 1, 1, 1);
+        glBindImageTexture(kTargetCubeImage, target.irradiance, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+        dispatch(Pass::Irradiance, groupCount(kIrradianceSize), groupCount(kIrradianceSize), 6);
+
+        m_front = static_cast<int>(back);
+        ++m_stats.cubemapsPublished;
+        m_stats.framesPerRebuild = static_cast<float>(m_rebuildFrames);
+        m_stage = Stage::Idle;
+        break;
+    case Stage::Idle:
+        break;
+    }
+}
+
+void PhysicalSky::beginTiming()
+{
+    if (m_timerQueries.front() == 0)
+        glCreateQueries(GL_TIME_ELAPSED, static_cast<GLsizei>(m_timerQueries.size()), m_timerQueries.data());
+
+    // Collect what this query measured kTimerQueries working frames ago; drop it rather than stall.
+    const std::size_t slot = m_timerIndex;
+    if (m_timerPending[slot]) {
+        GLint available = 0;
+        glGetQueryObjectiv(m_timerQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(m_timerQueries[slot], GL_QUERY_RESULT, &elapsedNs);
+            m_stats.gpuMs = static_cast<float>(static_cast<double>(elapsedNs) * 1e-6);
+        }
+        m_timerPending[slot] = false;
+    }
+    glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[slot]);
+    m_cpuStart = std::chrono::steady_clock::now();
+}
+
+void PhysicalSky::endTiming()
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    m_timerPending[m_timerIndex] = true;
+    m_timerIndex = (m_timerIndex + 1) % m_timerQueries.size();
+    m_stats.cpuMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_cpuStart).count();
+}
+
+void PhysicalSky::drawSky(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) const
+{
+    if (!enabled() || m_stats.skyViewUpdates == 0)
+        return;
+
+    glEnable(GL_FRAMEBUFFER_SRGB);
+    glDisable(GL_CULL_FACE);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+
+    const glm::mat4 viewNoTranslation = glm::mat4(glm::mat3(viewMatrix));
+    // Ozone sits well above the ground, so the extinction there is Rayleigh plus Mie.
+    const glm::vec3 groundExtinction = m_atmosphere.rayleighScattering + glm::vec3(m_atmosphere.mieScattering + m_atmosphere.mieAbsorption);
+    m_skyShader.bind();
+    setUniform(m_skyShader, "uInverseViewProjection", glm::inverse(projectionMatrix * viewNoTranslation));
+    setUniform(m_skyShader, "uSunDirection", m_lutSunDirection);
+    setUniform(m_skyShader, "uBottomRadius", m_atmosphere.bottomRadiusKm);
+    setUniform(m_skyShader, "uTopRadius", m_atmosphere.topRadiusKm);
+    setUniform(m_skyShader, "uObserverAltitude", m_settings.observerAltitudeKm);
+    setUniform(m_skyShader, "uGroundAlbedo", m_atmosphere.groundAlbedo);
+    setUniform(m_skyShader, "uGroundExtinction", groundExtinction);
+    setUniform(m_skyShader, "uIntensity", m_settings.intensity);
+    setUniform(m_skyShader, "uSunDiskLuminance", m_settings.sunDiskLuminance);
+    setUniform(m_skyShader, "uSunCosAngularRadius", std::cos(glm::radians(m_settings.sunAngularRadiusDegrees)));
+
+    glBindTextureUnit(kTransmittanceUnit, m_transmittanceLut);
+    glBindTextureUnit(kSkyViewUnit, m_skyViewLut);
+    glBindSampler(kTransmittanceUnit, 0);
+    glBindSampler(kSkyViewUnit, 0);
+    glBindVertexArray(m_emptyVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+    glEnable(GL_CULL_FACE);
+    glDisable(GL_FRAMEBUFFER_SRGB);
+}
+
+void PhysicalSky::drawImGuiPanel()
+{
+    if (!m_ready) {
+        ImGui::TextDisabled("Unavailable: shaders failed to build.");
+        return;
+    }
+    ImGui::Checkbox("Physical Sky", &m_settings.enabled);
+    ImGui::BeginDisabled(!m_settings.enabled);
+    if (m_sunDriven) {
+        ImGui::Text("Sun follows the sun path: elevation %.1f deg", static_cast<double>(glm::degrees(std::asin(std::clamp(m_sunDirection.y, -1.0f, 1.0f)))));
+    } else {
+        ImGui::SliderFloat("Sun Elevation", &m_settings.sunElevationDegrees, -10.0f, 90.0f, "%.1f deg");
+        ImGui::SliderFloat("Sun Azimuth", &m_settings.sunAzimuthDegrees, -180.0f, 180.0f, "%.1f deg");
+    }
+    ImGui::SliderFloat("Sky Intensity", &m_settings.intensity, 0.0f, 40.0f);
+    ImGui::SliderFloat("Sun Disk Luminance", &m_settings.sunDiskLuminance, 0.0f, 200.0f);
+    ImGui::SliderFloat("Update Threshold", &m_settings.updateThresholdDegrees, 0.0f, 5.0f, "%.2f deg");
+    ImGui::SliderInt("Faces Per Frame", &m_settings.facesPerFrame, 1, 6);
+    if (ImGui::SliderFloat("Observer Altitude", &m_settings.observerAltitudeKm, 0.0f, 20.0f, "%.2f km"))
+        m_rebuildRequested = true;
+
+    if (ImGui::TreeNode("Atmosphere")) {
+        Atmosphere atmosphere = m_atmosphere;
+        bool dirty = false;
+        glm::vec3 rayleigh = atmosphere.rayleighScattering * 1000.0f;
+        if (ImGui::ColorEdit3("Rayleigh (1/Mm)", glm::value_ptr(rayleigh), ImGuiColorEditFlags_Float | ImGuiColorEditFlags_HDR)) {
+            atmosphere.rayleighScattering = rayleigh * 0.001f;
+            dirty = true;
+        }
+        dirty |= ImGui::SliderFloat("Rayleigh Scale Height", &atmosphere.rayleighScaleHeightKm, 1.0f, 20.0f, "%.1f km");
+        dirty |= ImGui::SliderFloat("Mie Scattering", &atmosphere.mieScattering, 0.0f, 0.05f, "%.4f /km");
+        dirty |= ImGui::SliderFloat("Mie Absorption", &atmosphere.mieAbsorption, 0.0f, 0.05f, "%.4f /km");
+        dirty |= ImGui::SliderFloat("Mie Scale Height", &atmosphere.mieScaleHeightKm, 0.1f, 5.0f, "%.2f km");
+        dirty |= ImGui::SliderFloat("Mie Anisotropy", &atmosphere.mieAnisotropy, 0.0f, 0.95f);
+        dirty |= ImGui::ColorEdit3("Ground Albedo", glm::value_ptr(atmosphere.groundAlbedo));
+        if (dirty)
+            setAtmosphere(atmosphere);
+        if (ImGui::Button("Reset Atmosphere"))
+            setAtmosphere(Atmosphere {});
+        ImGui::TreePop();
+    }
+    ImGui::EndDisabled();
+
+    ImGui::Text("Sky-view updates: %llu  Cubemaps published: %llu", static_cast<unsigned long long>(m_stats.skyViewUpdates),
+        static_cast<unsigned long long>(m_stats.cubemapsPublished));
+    ImGui::Text("Frames per rebuild: %.0f  (%s)", static_cast<double>(m_stats.framesPerRebuild), m_stage == Stage::Idle ? "idle" : "rebuilding");
+    ImGui::Text("Last working frame: GPU %.3f ms, CPU %.3f ms", static_cast<double>(m_stats.gpuMs), static_cast<double>(m_stats.cpuMs));
+}
@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <framework/opengl_includes.h>
+#include <framework/shader.h>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+
+// Procedural atmosphere after Hillaire, "A Scalable and Production Ready Sky and Atmosphere
+// Rendering Technique" (2020). Transmittance and multi-scattering LUTs depend only on the
+// atmosphere and are rebuilt when it is edited. The sky-view LUT depends on the sun and is rebuilt
+// when the sun has moved more than a threshold. From it a low-resolution sky cubemap (mipmapped,
+// standing in for the prefiltered specular map) and an L2 SH irradiance cubemap are rebuilt over a
+// few frames into a back buffer, then swapped in, so a moving sun costs a handful of small compute
+// dispatches per frame instead of the full HDR bake chain of EnvironmentManager.
+class PhysicalSky {
+public:
+    struct Atmosphere {
+        float bottomRadiusKm { 6360.0f };
+        float topRadiusKm { 6460.0f };
+        glm::vec3 rayleighScattering { 5.802e-3f, 13.558e-3f, 33.1e-3f }; // per km
+        float rayleighScaleHeightKm { 8.0f };
+        float mieScattering { 3.996e-3f };
+        float mieAbsorption { 4.4e-3f };
+        float mieScaleHeightKm { 1.2f };
+        float mieAnisotropy { 0.8f };
+        glm::vec3 ozoneAbsorption { 0.650e-3f, 1.881e-3f, 0.085e-3f };
+        glm::vec3 groundAlbedo { 0.3f };
+    };
+
+    struct Settings {
+        bool enabled { false };
+        // Used when no sun path drives the sun.
+        float sunElevationDegrees { 35.0f };
+        float sunAzimuthDegrees { 40.0f };
+        // Sky-view LUT and cubemaps are rebuilt once the sun moved further than this.
+        float updateThresholdDegrees { 0.5f };
+        // Cube faces rendered per frame while rebuilding (1..6).
+        int facesPerFrame { 2 };
+        float observerAltitudeKm { 0.2f };
+        float intensity { 8.0f };
+        float sunDiskLuminance { 40.0f };
+        float sunAngularRadiusDegrees { 0.27f };
+    };
+
+    struct Stats {
+        std::uint64_t skyViewUpdates { 0 };
+        std::uint64_t cubemapsPublished { 0 };
+        float gpuMs { 0.0f }; // last frame that did work
+        float cpuMs { 0.0f };
+        float framesPerRebuild { 0.0f };
+    };
+
+    static constexpr int kTransmittanceWidth = 256;
+    static constexpr int kTransmittanceHeight = 64;
+    static constexpr int kMultiScatteringSize = 32;
+    static constexpr int kSkyViewWidth = 192;
+    static constexpr int kSkyViewHeight = 108;
+    static constexpr int kCubeSize = 64;
+    static constexpr int kIrradianceSize = 16;
+
+    PhysicalSky() = default;
+    ~PhysicalSky();
+    PhysicalSky(const PhysicalSky&) = delete;
+    PhysicalSky& operator=(const PhysicalSky&) = delete;
+
+    void initialize();
+    void release();
+
+    // `drivenSunDirection` (towards the sun) overrides the manual elevation/azimuth.
+    void update(const std::optional<glm::vec3>& drivenSunDirection);
+    void drawSky(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) const;
+
+    [[nodiscard]] bool enabled() const { return m_settings.enabled && m_ready; }
+    // A complete cubemap pair has been published.
+    [[nodiscard]] bool hasLighting() const { return enabled() && m_front >= 0; }
+    [[nodiscard]] GLuint skyCubemap() const;
+    [[nodiscard]] GLuint irradianceCubemap() const;
+    [[nodiscard]] int skyMipLevels() const;
+    [[nodiscard]] float intensity() const { return m_settings.intensity; }
+    [[nodiscard]] glm::vec3 sunDirection() const { return m_sunDirection; }
+
+    [[nodiscard]] Settings& settings() { return m_settings; }
+    void setAtmosphere(const Atmosphere& atmosphere);
+    [[nodiscard]] const Atmosphere& atmosphere() const { return m_atmosphere; }
+    [[nodiscard]] const Stats& stats() const { return m_stats; }
+
+    void drawImGuiPanel();
+
+private:
+    enum class Pass : int {
+        Transmittance = 0,
+        MultiScattering,
+        SkyView,
+        CubeFaces,
+        ProjectSH,
+        Irradiance
+    };
+
+    // Rebuild state machine: SkyView, then the cube faces a few per frame, then mips, SH and swap.
+    enum class Stage {
+        Idle,
+        SkyView,
+        Faces,
+        Finalize
+    };
+
+    struct Target {
+        GLuint sky { 0 };
+        GLuint irradiance { 0 };
+    };
+
+    void createTextures();
+    void setAtmosphereUniforms() const;
+    void dispatch(Pass pass, GLuint groupsX, GLuint groupsY, GLuint groupsZ);
+    void bakeAtmosphereLuts();
+    void advance();
+    void beginTiming();
+    void endTiming();
+    [[nodiscard]] glm::vec3 manualSunDirection() const;
+
+    Settings m_settings;
+    Atmosphere m_atmosphere;
+    Stats m_stats;
+
+    bool m_ready { false };
+    bool m_atmosphereDirty { true };
+    Shader m_computeShader;
+    Shader m_skyShader;
+    GLuint m_emptyVao { 0 };
+
+    GLuint m_transmittanceLut { 0 };
+    GLuint m_multiScatteringLut { 0 };
+    GLuint m_skyViewLut { 0 };
+    GLuint m_shBuffer { 0 };
+    std::array<Target, 2> m_targets {};
+    int m_front { -1 };
+
+    Stage m_stage { Stage::Idle };
+    int m_nextFace { 0 };
+    int m_rebuildFrames { 0 };
+    bool m_rebuildRequested { true };
+    bool m_sunDriven { false };
+    glm::vec3 m_sunDirection { 0.0f, 1.0f, 0.0f }; // latest requested
+    glm::vec3 m_lutSunDirection { 0.0f, 1.0f, 0.0f }; // in the sky-view LUT
+
+    static constexpr std::size_t kTimerQueries = 4;
+    std::array<GLuint, kTimerQueries> m_timerQueries {};
+    std::array<bool, kTimerQueries> m_timerPending {};
+    std::size_t m_timerIndex { 0 };
+    std::chrono::steady_clock::time_point m_cpuStart;
+};
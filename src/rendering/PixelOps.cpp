@@ -0,0 +1,491 @@
+// SPDX-License-Identifier: MIT
+#include "rendering/PixelOps.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXEL_OPS_SSE2 1
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define PIXEL_OPS_SSSE3 1
+#include <tmmintrin.h>
+#endif
+#if defined(__F16C__)
+#define PIXEL_OPS_F16C 1
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace pixel_ops {
+
+namespace {
+
+constexpr int kMinRowsPerBlock = 16;
+constexpr std::size_t kMinBytesPerThread = 256 * 1024;
+constexpr unsigned kMaxThreads = 8;
+constexpr int kSrgbEncodeSteps = 4095;
+
+constexpr bool kLittleEndian = std::endian::native == std::endian::little;
+
+struct SrgbTables {
+    std::array<float, 256> decode {};
+    std::array<std::uint8_t, kSrgbEncodeSteps + 1> encode {};
+
+    SrgbTables()
+    {
+        for (std::size_t i = 0; i < decode.size(); ++i) {
+            const float c = static_cast<float>(i) / 255.0f;
+            decode[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (std::size_t i = 0; i < encode.size(); ++i) {
+            const float l = static_cast<float>(i) / static_cast<float>(kSrgbEncodeSteps);
+            const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            encode[i] = static_cast<std::uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+    }
+};
+
+const SrgbTables& srgbTables()
+{
+    static const SrgbTables tables;
+    return tables;
+}
+
+std::uint16_t toHalf(float value)
+{
+    const std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+    const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+    std::uint32_t magnitude = bits & 0x7FFFFFFFu;
+    if (magnitude >= 0x7F800000u) // inf / NaN (keep NaNs quiet)
+        return static_cast<std::uint16_t>(sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));
+    if (magnitude >= 0x477FF000u) // rounds past 65504
+        return static_cast<std::uint16_t>(sign | 0x7C00u);
+    if (magnitude < 0x38800000u) {
+        // Subnormal half: adding 0.5 aligns the float mantissa ulp with the half subnormal ulp (2^-24)
+        // and lets the FPU do the round-to-nearest-even.
+        const float shifted = std::bit_cast<float>(magnitude) + 0.5f;
+        return static_cast<std::uint16_t>(sign | (std::bit_cast<std::uint32_t>(shifted) - 0x3F000000u));
+    }
+    const std::uint32_t odd = (magnitude >> 13) & 1u;
+    magnitude += 0xC8000FFFu + odd; // rebias the exponent (127 -> 15) and round to nearest even
+    return static_cast<std::uint16_t>(sign | (magnitude >> 13));
+}
+
+float fromHalf(std::uint16_t value)
+{
+    const std::uint32_t sign = (value & 0x8000u) << 16;
+    const std::uint32_t exponent = (value >> 10) & 0x1Fu;
+    const std::uint32_t mantissa = value & 0x3FFu;
+    if (exponent == 0) {
+        const float magnitude = static_cast<float>(mantissa) * (1.0f / 16777216.0f);
+        return std::bit_cast<float>(std::bit_cast<std::uint32_t>(magnitude) | sign);
+    }
+    if (exponent == 31)
+        return std::bit_cast<float>(sign | 0x7F800000u | (mantissa << 13));
+    return std::bit_cast<float>(sign | ((exponent + 112u) << 23) | (mantissa << 13));
+}
+
+template <int Src, int Dst>
+void convertGeneric(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels)
+{
+    for (std::size_t i = 0; i < pixels; ++i, src += Src, dst += Dst) {
+        if constexpr (Src == 1 || Src == 2) {
+            // Grey (+ alpha)
+            const std::uint8_t alpha = Src == 2 ? src[1] : 255;
+            if constexpr (Dst == 1) {
+                dst[0] = src[0];
+            } else if constexpr (Dst == 2) {
+                dst[0] = src[0];
+                dst[1] = alpha;
+            } else {
+                dst[0] = dst[1] = dst[2] = src[0];
+                if constexpr (Dst == 4)
+                    dst[3] = alpha;
+            }
+        } else {
+            const std::uint8_t alpha = Src == 4 ? src[3] : 255;
+            if constexpr (Dst == 1) {
+                dst[0] = src[0];
+            } else if constexpr (Dst == 2) {
+                dst[0] = src[0];
+                dst[1] = alpha;
+            } else {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                if constexpr (Dst == 4)
+                    dst[3] = alpha;
+            }
+        }
+    }
+}
+
+template <int Src>
+void convertFrom(const std::uint8_t* src, std::uint8_t* dst, int dstChannels, std::size_t pixels)
+{
+    switch (dstChannels) {
+    case 1:
+        convertGeneric<Src, 1>(src, dst, pixels);
+        break;
+    case 2:
+        convertGeneric<Src, 2>(src, dst, pixels);
+        break;
+    case 3:
+        convertGeneric<Src, 3>(src, dst, pixels);
+        break;
+    case 4:
+        convertGeneric<Src, 4>(src, dst, pixels);
+        break;
+    default:
+        break;
+    }
+}
+
+void renormalizeScalar(std::uint8_t* pixel)
+{
+    float x = static_cast<float>(pixel[0]) * (2.0f / 255.0f) - 1.0f;
+    float y = static_cast<float>(pixel[1]) * (2.0f / 255.0f) - 1.0f;
+    float z = static_cast<float>(pixel[2]) * (2.0f / 255.0f) - 1.0f;
+    const float lengthSquared = x * x + y * y + z * z;
+    if (lengthSquared < 1e-8f) {
+        x = y = 0.0f;
+        z = 1.0f;
+    } else {
+        const float inverse = 1.0f / std::sqrt(lengthSquared);
+        x *= inverse;
+        y *= inverse;
+        z *= inverse;
+    }
+    pixel[0] = static_cast<std::uint8_t>(std::clamp(x * 127.5f + 128.0f, 0.0f, 255.0f));
+    pixel[1] = static_cast<std::uint8_t>(std::clamp(y * 127.5f + 128.0f, 0.0f, 255.0f));
+    pixel[2] = static_cast<std::uint8_t>(std::clamp(z * 127.5f + 128.0f, 0.0f, 255.0f));
+}
+
+// Exact round(c * a / 255) for 8-bit c and a.
+std::uint8_t multiplyUnorm8(std::uint8_t c, std::uint8_t a)
+{
+    const unsigned t = static_cast<unsigned>(c) * a + 128u;
+    return static_cast<std::uint8_t>((t + (t >> 8)) >> 8);
+}
+
+} // namespace
+
+void forEachRowBlock(int rows, std::size_t bytesPerRow, const std::function<void(int, int)>& fn)
+{
+    if (rows <= 0)
+        return;
+    const std::size_t totalBytes = static_cast<std::size_t>(rows) * bytesPerRow;
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    const auto threadCount = static_cast<int>(std::min<std::size_t>({ hardware, kMaxThreads,
+        static_cast<std::size_t>(rows / kMinRowsPerBlock), totalBytes / kMinBytesPerThread }));
+    if (threadCount <= 1) {
+        fn(0, rows);
+        return;
+    }
+
+    std::vector<std::thread> workers;
+    workers.reserve(static_cast<std::size_t>(threadCount - 1));
+    const int rowsPerBlock = (rows + threadCount - 1) / threadCount;
+    for (int first = rowsPerBlock; first < rows; first += rowsPerBlock)
+        workers.emplace_back(fn, first, std::min(rows, first + rowsPerBlock));
+    fn(0, std::min(rows, rowsPerBlock));
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+void convertChannels(const std::uint8_t* src, int srcChannels, std::uint8_t* dst, int dstChannels, std::size_t pixels)
+{
+    if (srcChannels == dstChannels) {
+        std::memcpy(dst, src, pixels * static_cast<std::size_t>(srcChannels));
+        return;
+    }
+    if (srcChannels == 3 && dstChannels == 4) {
+        expandRgbToRgba(src, dst, pixels);
+        return;
+    }
+    if (srcChannels == 4 && dstChannels == 3) {
+        shrinkRgbaToRgb(src, dst, pixels);
+        return;
+    }
+    switch (srcChannels) {
+    case 1:
+        convertFrom<1>(src, dst, dstChannels, pixels);
+        break;
+    case 2:
+        convertFrom<2>(src, dst, dstChannels, pixels);
+        break;
+    case 3:
+        convertFrom<3>(src, dst, dstChannels, pixels);
+        break;
+    case 4:
+        convertFrom<4>(src, dst, dstChannels, pixels);
+        break;
+    default:
+        break;
+    }
+}
+
+void expandRgbToRgba(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels, std::uint8_t alpha)
+{
+    std::size_t i = 0;
+#ifdef PIXEL_OPS_SSSE3
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(static_cast<std::uint32_t>(alpha) << 24));
+    // Each 16-byte load covers 4 pixels plus 4 bytes of the next; stop while that stays in bounds.
+    for (; (i + 4) * 3 + 4 <= pixels * 3; i += 4) {
+        const __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alphaMask));
+    }
+#endif
+    if constexpr (kLittleEndian) {
+        // 4-byte loads overrun by one byte, so the last pixel takes the byte path.
+        const std::uint32_t alphaBits = static_cast<std::uint32_t>(alpha) << 24;
+        for (; i + 1 < pixels; ++i) {
+            std::uint32_t value;
+            std::memcpy(&value, src + i * 3, 4);
+            value = (value & 0x00FFFFFFu) | alphaBits;
+            std::memcpy(dst + i * 4, &value, 4);
+        }
+    }
+    for (; i < pixels; ++i) {
+        dst[i * 4 + 0] = src[i * 3 + 0];
+        dst[i * 4 + 1] = src[i * 3 + 1];
+        dst[i * 4 + 2] = src[i * 3 + 2];
+        dst[i * 4 + 3] = alpha;
+    }
+}
+
+void shrinkRgbaToRgb(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels)
+{
+    std::size_t i = 0;
+#ifdef PIXEL_OPS_SSSE3
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    // The 16-byte store writes 4 bytes past the 4 pixels; the next iteration overwrites them.
+    for (; i * 3 + 16 <= pixels * 3 && i + 4 <= pixels; i += 4) {
+        const __m128i rgba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 3), _mm_shuffle_epi8(rgba, shuffle));
+    }
+#endif
+    if constexpr (kLittleEndian) {
+        for (; i + 1 < pixels; ++i) {
+            std::uint32_t value;
+            std::memcpy(&value, src + i * 4, 4);
+            std::memcpy(dst + i * 3, &value, 4); // the spare byte is overwritten by the next pixel
+        }
+    }
+    for (; i < pixels; ++i) {
+        dst[i * 3 + 0] = src[i * 4 + 0];
+        dst[i * 3 + 1] = src[i * 4 + 1];
+        dst[i * 3 + 2] = src[i * 4 + 2];
+    }
+}
+
+void swizzleBgraToRgba(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels)
+{
+    std::size_t i = 0;
+#ifdef PIXEL_OPS_SSE2
+    const __m128i greenAlpha = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+    const __m128i redBlue = _mm_set1_epi32(0x00FF00FF);
+    for (; i + 4 <= pixels; i += 4) {
+        const __m128i bgra = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        const __m128i rb = _mm_and_si128(bgra, redBlue);
+        const __m128i swapped = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_or_si128(_mm_and_si128(bgra, greenAlpha), swapped));
+    }
+#endif
+    for (; i < pixels; ++i) {
+        const std::uint8_t b = src[i * 4 + 0];
+        const std::uint8_t g = src[i * 4 + 1];
+        const std::uint8_t r = src[i * 4 + 2];
+        const std::uint8_t a = src[i * 4 + 3];
+        dst[i * 4 + 0] = r;
+        dst[i * 4 + 1] = g;
+        dst[i * 4 + 2] = b;
+        dst[i * 4 + 3] = a;
+    }
+}
+
+float srgbToLinear(std::uint8_t value)
+{
+    return srgbTables().decode[value];
+}
+
+std::uint8_t linearToSrgb(float value)
+{
+    if (!(value > 0.0f)) // also catches NaN
+        return 0;
+    const float scaled = std::min(value, 1.0f) * static_cast<float>(kSrgbEncodeSteps) + 0.5f;
+    return srgbTables().encode[static_cast<std::size_t>(scaled)];
+}
+
+void srgbToLinear(const std::uint8_t* src, float* dst, std::size_t count)
+{
+    const auto& decode = srgbTables().decode;
+    for (std::size_t i = 0; i < count; ++i)
+        dst[i] = decode[src[i]];
+}
+
+void linearToSrgb(const float* src, std::uint8_t* dst, std::size_t count)
+{
+    const auto& encode = srgbTables().encode;
+    std::size_t i = 0;
+#ifdef PIXEL_OPS_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(static_cast<float>(kSrgbEncodeSteps));
+    const __m128 half = _mm_set1_ps(0.5f);
+    alignas(16) std::int32_t indices[4];
+    for (; i + 4 <= count; i += 4) {
+        // maxps returns its second operand when either is NaN, so NaN maps to 0.
+        const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), zero), one);
+        _mm_store_si128(reinterpret_cast<__m128i*>(indices), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clamped, scale), half)));
+        dst[i + 0] = encode[static_cast<std::size_t>(indices[0])];
+        dst[i + 1] = encode[static_cast<std::size_t>(indices[1])];
+        dst[i + 2] = encode[static_cast<std::size_t>(indices[2])];
+        dst[i + 3] = encode[static_cast<std::size_t>(indices[3])];
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] = linearToSrgb(src[i]);
+}
+
+void renormalizeNormals(std::uint8_t* pixels, int channels, std::size_t count)
+{
+    if (channels < 3)
+        return;
+    std::size_t i = 0;
+#ifdef PIXEL_OPS_SSE2
+    if (channels == 4) {
+        const __m128i byteMask = _mm_set1_epi32(0xFF);
+        const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+        const __m128 decodeScale = _mm_set1_ps(2.0f / 255.0f);
+        const __m128 minusOne = _mm_set1_ps(-1.0f);
+        const __m128 encodeScale = _mm_set1_ps(127.5f);
+        const __m128 encodeBias = _mm_set1_ps(128.0f);
+        const __m128 threeHalves = _mm_set1_ps(1.5f);
+        const __m128 halfValue = _mm_set1_ps(0.5f);
+        const __m128 epsilon = _mm_set1_ps(1e-8f);
+        const __m128 unitZ = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 maxByte = _mm_set1_ps(255.0f);
+        for (; i + 4 <= count; i += 4) {
+            auto* block = reinterpret_cast<__m128i*>(pixels + i * 4);
+            const __m128i packed = _mm_loadu_si128(block);
+            __m128 x = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(packed, byteMask)), decodeScale), minusOne);
+            __m128 y = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(packed, 8), byteMask)), decodeScale), minusOne);
+            __m128 z = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(packed, 16), byteMask)), decodeScale), minusOne);
+
+            const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+            const __m128 degenerate = _mm_cmplt_ps(lengthSquared, epsilon);
+            __m128 inverse = _mm_rsqrt_ps(_mm_max_ps(lengthSquared, epsilon));
+            // One Newton step takes rsqrt from 12 to ~22 bits.
+            inverse = _mm_mul_ps(inverse, _mm_sub_ps(threeHalves, _mm_mul_ps(_mm_mul_ps(halfValue, lengthSquared), _mm_mul_ps(inverse, inverse))));
+            x = _mm_andnot_ps(degenerate, _mm_mul_ps(x, inverse));
+            y = _mm_andnot_ps(degenerate, _mm_mul_ps(y, inverse));
+            z = _mm_or_ps(_mm_andnot_ps(degenerate, _mm_mul_ps(z, inverse)), _mm_and_ps(degenerate, unitZ));
+
+            const auto encode = [&](__m128 value) {
+                const __m128 scaled = _mm_add_ps(_mm_mul_ps(value, encodeScale), encodeBias);
+                return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(scaled, zero), maxByte));
+            };
+            __m128i result = _mm_and_si128(packed, alphaMask);
+            result = _mm_or_si128(result, encode(x));
+            result = _mm_or_si128(result, _mm_slli_epi32(encode(y), 8));
+            result = _mm_or_si128(result, _mm_slli_epi32(encode(z), 16));
+            _mm_storeu_si128(block, result);
+        }
+    }
+#endif
+    for (; i < count; ++i)
+        renormalizeScalar(pixels + i * static_cast<std::size_t>(channels));
+}
+
+void premultiplyAlpha(std::uint8_t* rgba, std::size_t pixels, bool srgb)
+{
+    if (srgb) {
+        const auto& decode = srgbTables().decode;
+        for (std::size_t i = 0; i < pixels; ++i) {
+            std::uint8_t* pixel = rgba + i * 4;
+            const float alpha = static_cast<float>(pixel[3]) / 255.0f;
+            for (int c = 0; c < 3; ++c)
+                pixel[c] = linearToSrgb(decode[pixel[c]] * alpha);
+        }
+        return;
+    }
+
+    std::size_t i = 0;
+#ifdef PIXEL_OPS_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi16(128);
+    const __m128i alphaLanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+    const auto premultiplyHalf = [&](__m128i pixels16) {
+        // Broadcast each pixel's alpha across its four 16-bit lanes.
+        __m128i alpha = _mm_shufflelo_epi16(pixels16, _MM_SHUFFLE(3, 3, 3, 3));
+        alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i product = _mm_add_epi16(_mm_mullo_epi16(pixels16, alpha), rounding);
+        product = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+        return _mm_or_si128(_mm_andnot_si128(alphaLanes, product), _mm_and_si128(alphaLanes, pixels16));
+    };
+    for (; i + 4 <= pixels; i += 4) {
+        auto* block = reinterpret_cast<__m128i*>(rgba + i * 4);
+        const __m128i packed = _mm_loadu_si128(block);
+        const __m128i low = premultiplyHalf(_mm_unpacklo_epi8(packed, zero));
+        const __m128i high = premultiplyHalf(_mm_unpackhi_epi8(packed, zero));
+        _mm_storeu_si128(block, _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; i < pixels; ++i) {
+        std::uint8_t* pixel = rgba + i * 4;
+        for (int c = 0; c < 3; ++c)
+            pixel[c] = multiplyUnorm8(pixel[c], pixel[3]);
+    }
+}
+
+void packChannels(std::span<const ChannelSource> sources, std::uint8_t* dst, int dstChannels, std::size_t pixels)
+{
+    const auto stride = static_cast<std::size_t>(dstChannels);
+    for (int c = 0; c < dstChannels; ++c) {
+        std::uint8_t* out = dst + c;
+        const ChannelSource* source = static_cast<std::size_t>(c) < sources.size() ? &sources[static_cast<std::size_t>(c)] : nullptr;
+        if (!source || !source->pixels) {
+            const std::uint8_t value = source ? source->constant : 255;
+            for (std::size_t i = 0; i < pixels; ++i)
+                out[i * stride] = value;
+            continue;
+        }
+        const auto srcStride = static_cast<std::size_t>(source->channels);
+        const std::uint8_t* in = source->pixels + source->channel;
+        for (std::size_t i = 0; i < pixels; ++i)
+            out[i * stride] = in[i * srcStride];
+    }
+}
+
+void floatToHalf(const float* src, std::uint16_t* dst, std::size_t count)
+{
+    std::size_t i = 0;
+#ifdef PIXEL_OPS_F16C
+    for (; i + 4 <= count; i += 4)
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+    for (; i < count; ++i)
+        dst[i] = toHalf(src[i]);
+}
+
+void halfToFloat(const std::uint16_t* src, float* dst, std::size_t count)
+{
+    std::size_t i = 0;
+#ifdef PIXEL_OPS_F16C
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(dst + i, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i))));
+#endif
+    for (; i < count; ++i)
+        dst[i] = fromHalf(src[i]);
+}
+
+} // namespace pixel_ops
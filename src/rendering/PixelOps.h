@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+
+// Vectorised 8-bit/float pixel kernels used by texture import. Every kernel works on a flat run of
+// pixels; forEachRowBlock() splits an image into row blocks and runs them on several threads when
+// the image is large enough to pay for it. Unless noted, `src` and `dst` must not overlap.
+namespace pixel_ops {
+
+// Calls `fn(firstRow, lastRow)` for disjoint row ranges covering [0, rows). Small images run inline.
+void forEachRowBlock(int rows, std::size_t bytesPerRow, const std::function<void(int, int)>& fn);
+
+// Widens or narrows interleaved 8-bit pixels: grey replicates into RGB, missing alpha becomes 255,
+// dropped channels are discarded (RGB(A) -> grey keeps red).
+void convertChannels(const std::uint8_t* src, int srcChannels, std::uint8_t* dst, int dstChannels, std::size_t pixels);
+void expandRgbToRgba(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels, std::uint8_t alpha = 255);
+void shrinkRgbaToRgb(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels);
+// Swaps red and blue of 4-channel pixels; `src == dst` is allowed.
+void swizzleBgraToRgba(const std::uint8_t* src, std::uint8_t* dst, std::size_t pixels);
+
+// sRGB transfer function: decoding is a 256-entry table, encoding a 4096-entry table (< 1 LSB error).
+[[nodiscard]] float srgbToLinear(std::uint8_t value);
+[[nodiscard]] std::uint8_t linearToSrgb(float value);
+void srgbToLinear(const std::uint8_t* src, float* dst, std::size_t count);
+void linearToSrgb(const float* src, std::uint8_t* dst, std::size_t count);
+
+// Rescales the xyz of tangent-space normals (0..255 encoding -1..1) to unit length in place; other
+// channels are left alone.
+void renormalizeNormals(std::uint8_t* pixels, int channels, std::size_t count);
+// Multiplies RGB by alpha in place. With `srgb` the product is formed in linear space.
+void premultiplyAlpha(std::uint8_t* rgba, std::size_t pixels, bool srgb);
+
+// One channel of a source image, or a constant when `pixels` is null.
+struct ChannelSource {
+    const std::uint8_t* pixels { nullptr };
+    int channels { 1 };
+    int channel { 0 };
+    std::uint8_t constant { 255 };
+};
+// Writes source i into channel i of `dst`; channels without a source become 255. Packing AO,
+// roughness and metallic this way yields a glTF-style ORM texture.
+void packChannels(std::span<const ChannelSource> sources, std::uint8_t* dst, int dstChannels, std::size_t pixels);
+
+// IEEE half <-> float (round to nearest even, overflow saturates to infinity).
+void floatToHalf(const float* src, std::uint16_t* dst, std::size_t count);
+void halfToFloat(const std::uint16_t* src, float* dst, std::size_t count);
+
+} // namespace pixel_ops
@@ -0,0 +1,639 @@
+// SPDX-License-Identifier: MIT
+#include "rendering/ReflectionProbes.h"
+
+#include "mesh/MeshManager.h"
+#include "rendering/TextureUnits.h"
+
+#include <framework/disable_all_warnings.h>
+#include <framework/log.h>
+DISABLE_WARNINGS_PUSH()
+#include <GLFW/glfw3.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/trigonometric.hpp>
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <limits>
+
+namespace {
+
+// Captures and filtering borrow the per-material units, which every draw rebinds anyway.
+constexpr GLuint kSkyUnit = TextureUnits::Material_Albedo;
+constexpr GLuint kIrradianceUnit = TextureUnits::Material_Normal;
+constexpr GLuint kFilterSourceUnit = TextureUnits::Material_Albedo;
+constexpr GLuint kFilterTargetImage = 0;
+constexpr GLuint kLightBufferBinding = 0;
+constexpr GLbitfield kFilterBarriers = GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT;
+constexpr float kAverageWeight = 0.1f;
+
+// Face order and orientation of GL_TEXTURE_CUBE_MAP_POSITIVE_X + i.
+const std::array<glm::vec3, 6> kFaceDirections { {
+    { 1.0f, 0.0f, 0.0f },
+    { -1.0f, 0.0f, 0.0f },
+    { 0.0f, 1.0f, 0.0f },
+    { 0.0f, -1.0f, 0.0f },
+    { 0.0f, 0.0f, 1.0f },
+    { 0.0f, 0.0f, -1.0f },
+} };
+const std::array<glm::vec3, 6> kFaceUps { {
+    { 0.0f, -1.0f, 0.0f },
+    { 0.0f, -1.0f, 0.0f },
+    { 0.0f, 0.0f, 1.0f },
+    { 0.0f, 0.0f, -1.0f },
+    { 0.0f, -1.0f, 0.0f },
+    { 0.0f, -1.0f, 0.0f },
+} };
+
+constexpr GLuint groupCount(int size)
+{
+    return static_cast<GLuint>((size + 7) / 8);
+}
+
+void setUniform(const Shader& shader, const char* name, int value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform1i(loc, value);
+}
+
+void setUniform(const Shader& shader, const char* name, float value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform1f(loc, value);
+}
+
+void setUniform(const Shader& shader, const char* name, const glm::vec3& value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform3fv(loc, 1, glm::value_ptr(value));
+}
+
+void setUniform(const Shader& shader, const char* name, const glm::mat3& value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void setUniform(const Shader& shader, const char* name, const glm::mat4& value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+BoundingBox transformBounds(const BoundingBox& bounds, const glm::mat4& transform)
+{
+    // Arvo: the transformed box's extent along each axis is the sum of the absolute rotated extents.
+    const glm::vec3 center = glm::vec3(transform * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.0f));
+    const glm::vec3 halfExtent = (bounds.max - bounds.min) * 0.5f;
+    const glm::mat3 absolute { glm::abs(glm::vec3(transform[0])), glm::abs(glm::vec3(transform[1])), glm::abs(glm::vec3(transform[2])) };
+    const glm::vec3 extent = absolute * halfExtent;
+    return BoundingBox { center - extent, center + extent };
+}
+
+bool overlaps(const BoundingBox& a, const BoundingBox& b)
+{
+    return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::lessThanEqual(b.min, a.max));
+}
+
+float distanceToBox(const glm::vec3& point, const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+    return glm::length(glm::max(glm::max(boxMin - point, point - boxMax), glm::vec3(0.0f)));
+}
+
+// Whether a sphere can be seen from `eye` through the 90 degree face looking along `forward`.
+bool sphereInFace(const glm::vec3& center, float radius, const glm::vec3& eye, const glm::vec3& forward, const glm::vec3& up, float farPlane)
+{
+    const glm::vec3 toCenter = center - eye;
+    const float depth = glm::dot(toCenter, forward);
+    if (depth + radius < 0.0f || depth - radius > farPlane)
+        return false;
+    const glm::vec3 right = glm::cross(forward, up);
+    const float slack = radius * std::sqrt(2.0f);
+    return std::abs(glm::dot(toCenter, right)) <= depth + slack && std::abs(glm::dot(toCenter, up)) <= depth + slack;
+}
+
+} // namespace
+
+ReflectionProbes::~ReflectionProbes()
+{
+    release();
+}
+
+void ReflectionProbes::initialize()
+{
+    release();
+    try {
+        ShaderBuilder captureBuilder;
+        captureBuilder.addStage(GL_VERTEX_SHADER, RESOURCE_ROOT "shaders/reflection_probe_capture.vert");
+        captureBuilder.addStage(GL_FRAGMENT_SHADER, RESOURCE_ROOT "shaders/reflection_probe_capture.frag");
+        m_captureShader = captureBuilder.build();
+        ShaderBuilder filterBuilder;
+        filterBuilder.addStage(GL_COMPUTE_SHADER, RESOURCE_ROOT "shaders/reflection_probe_filter.comp");
+        m_filterShader = filterBuilder.build();
+    } catch (const std::exception& e) {
+        LOG_ERROR(logging::Category::General, "[ReflectionProbes] Disabled, shaders failed to build: {}", e.what());
+        return;
+    }
+    createResources();
+    for (Slot& slot : m_slots)
+        slot.published = false;
+    m_rebuild = {};
+    m_ready = true;
+}
+
+void ReflectionProbes::release()
+{
+    if (glfwGetCurrentContext() != nullptr) {
+        const GLuint textures[] = { m_stagingCube, m_cubemapArray };
+        for (const GLuint texture : textures) {
+            if (texture != 0)
+                glDeleteTextures(1, &texture);
+        }
+        if (m_depthBuffer != 0)
+            glDeleteRenderbuffers(1, &m_depthBuffer);
+        if (m_framebuffer != 0)
+            glDeleteFramebuffers(1, &m_framebuffer);
+        if (m_emptyVao != 0)
+            glDeleteVertexArrays(1, &m_emptyVao);
+        if (m_timerQueries.front() != 0)
+            glDeleteQueries(static_cast<GLsizei>(m_timerQueries.size()), m_timerQueries.data());
+    }
+    m_stagingCube = 0;
+    m_cubemapArray = 0;
+    m_depthBuffer = 0;
+    m_framebuffer = 0;
+    m_emptyVao = 0;
+    m_timerQueries = {};
+    m_timerPending = {};
+    m_rebuild = {};
+    m_ready = false;
+}
+
+void ReflectionProbes::createResources()
+{
+    glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_stagingCube);
+    glTextureStorage2D(m_stagingCube, kMipLevels, GL_RGBA16F, kFaceSize, kFaceSize);
+    glCreateTextures(GL_TEXTURE_CUBE_MAP_ARRAY, 1, &m_cubemapArray);
+    glTextureStorage3D(m_cubemapArray, kMipLevels, GL_RGBA16F, kFaceSize, kFaceSize, 6 * kMaxProbes);
+    for (const GLuint texture : { m_stagingCube, m_cubemapArray }) {
+        glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    }
+
+    glCreateRenderbuffers(1, &m_depthBuffer);
+    glNamedRenderbufferStorage(m_depthBuffer, GL_DEPTH_COMPONENT24, kFaceSize, kFaceSize);
+    glCreateFramebuffers(1, &m_framebuffer);
+    glNamedFramebufferRenderbuffer(m_framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthBuffer);
+    glNamedFramebufferTextureLayer(m_framebuffer, GL_COLOR_ATTACHMENT0, m_stagingCube, 0, 0);
+    glNamedFramebufferDrawBuffer(m_framebuffer, GL_COLOR_ATTACHMENT0);
+    if (glCheckNamedFramebufferStatus(m_framebuffer, GL_DRAW_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        LOG_ERROR(logging::Category::General, "[ReflectionProbes] Capture framebuffer is incomplete");
+
+    glCreateVertexArrays(1, &m_emptyVao);
+}
+
+int ReflectionProbes::addProbe(const Probe& probe)
+{
+    for (int i = 0; i < kMaxProbes; ++i) {
+        Slot& slot = m_slots[static_cast<std::size_t>(i)];
+        if (slot.used)
+            continue;
+        slot = Slot {};
+        slot.used = true;
+        setProbe(i, probe);
+        return i;
+    }
+    return -1;
+}
+
+void ReflectionProbes::removeProbe(int slot)
+{
+    if (!used(slot))
+        return;
+    m_slots[static_cast<std::size_t>(slot)] = Slot {};
+    if (m_rebuild.slot == slot)
+        m_rebuild = {};
+}
+
+void ReflectionProbes::setProbe(int slot, const Probe& probe)
+{
+    if (!used(slot))
+        return;
+    Slot& target = m_slots[static_cast<std::size_t>(slot)];
+    target.probe = probe;
+    target.probe.boxMax = glm::max(probe.boxMax, probe.boxMin + glm::vec3(0.01f));
+    target.changed = true;
+    // A rebuild in flight would publish the old placement; start over.
+    if (m_rebuild.slot == slot)
+        m_rebuild = {};
+}
+
+bool ReflectionProbes::used(int slot) const
+{
+    return slot >= 0 && slot < kMaxProbes && m_slots[static_cast<std::size_t>(slot)].used;
+}
+
+bool ReflectionProbes::published(int slot) const
+{
+    return used(slot) && m_slots[static_cast<std::size_t>(slot)].published;
+}
+
+const ReflectionProbes::Probe& ReflectionProbes::probe(int slot) const
+{
+    return m_slots[static_cast<std::size_t>(std::clamp(slot, 0, kMaxProbes - 1))].probe;
+}
+
+void ReflectionProbes::markChanged(const BoundingBox& bounds)
+{
+    const glm::vec3 margin { std::max(m_settings.changeRadius, 0.0f) };
+    for (Slot& slot : m_slots) {
+        if (slot.used && overlaps(bounds, BoundingBox { slot.probe.boxMin - margin, slot.probe.boxMax + margin }))
+            slot.changed = true;
+    }
+}
+
+void ReflectionProbes::trackSceneChanges(const MeshManager& meshManager, const SceneLighting& lighting)
+{
+    if (lighting.skyCubemap != m_trackedSky || lighting.irradianceCubemap != m_trackedIrradiance
+        || std::abs(lighting.environmentIntensity - m_trackedIntensity) > 1e-4f) {
+        for (Slot& slot : m_slots)
+            slot.changed = slot.changed || slot.used;
+        m_trackedSky = lighting.skyCubemap;
+        m_trackedIrradiance = lighting.irradianceCubemap;
+        m_trackedIntensity = lighting.environmentIntensity;
+    }
+
+    for (const MeshInstance& instance : meshManager.instances()) {
+        std::size_t residentItems = 0;
+        for (const MeshDrawItem& item : instance.drawItems()) {
+            if (item.geometry.resident())
+                ++residentItems;
+        }
+        const BoundingBox bounds = transformBounds(instance.localBounds(), instance.transform());
+
+        auto [it, inserted] = m_trackedInstances.try_emplace(instance.id());
+        TrackedInstance& tracked = it->second;
+        if (inserted) {
+            markChanged(bounds);
+        } else if (tracked.transformVersion != instance.transformVersion() || tracked.residentItems != residentItems) {
+            markChanged(tracked.bounds);
+            markChanged(bounds);
+        }
+        tracked.transformVersion = instance.transformVersion();
+        tracked.residentItems = residentItems;
+        tracked.bounds = bounds;
+        tracked.seenFrame = m_frame;
+    }
+
+    for (auto it = m_trackedInstances.begin(); it != m_trackedInstances.end();) {
+        if (it->second.seenFrame != m_frame) {
+            markChanged(it->second.bounds);
+            it = m_trackedInstances.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int ReflectionProbes::pickNextProbe(const glm::vec3& cameraPosition) const
+{
+    const float refreshFrames = static_cast<float>(std::max(m_settings.refreshFrames, 1));
+    int best = -1;
+    float bestScore = 0.0f;
+    for (int i = 0; i < kMaxProbes; ++i) {
+        const Slot& slot = m_slots[static_cast<std::size_t>(i)];
+        if (!slot.used)
+            continue;
+        const float age = static_cast<float>(m_frame - slot.capturedFrame);
+        const bool stale = m_settings.periodicRefresh && age >= refreshFrames;
+        if (slot.published && !slot.changed && !stale)
+            continue;
+
+        const float urgency = !slot.published ? 8.0f : (slot.changed ? 4.0f : 1.0f);
+        const float distance = distanceToBox(cameraPosition, slot.probe.boxMin, slot.probe.boxMax);
+        const float score = urgency * (1.0f + age / refreshFrames) / (1.0f + distance / std::max(m_settings.priorityDistance, 0.01f));
+        if (score > bestScore) {
+            bestScore = score;
+            best = i;
+        }
+    }
+    return best;
+}
+
+float ReflectionProbes::estimatedMs(StepKind kind) const
+{
+    const float gpu = kind == StepKind::Face ? m_stats.faceGpuMs : m_stats.filterGpuMs;
+    const float cpu = kind == StepKind::Face ? m_stats.faceCpuMs : m_stats.filterCpuMs;
+    // Unmeasured steps claim the whole budget, so they run alone until timings come back.
+    if (gpu <= 0.0f)
+        return std::max(m_settings.budgetMs, cpu);
+    return gpu + cpu;
+}
+
+void ReflectionProbes::update(MeshManager& meshManager, const glm::vec3& cameraPosition, const SceneLighting& lighting)
+{
+    m_stats.facesLastFrame = 0;
+    m_stats.filterStepsLastFrame = 0;
+    m_stats.estimatedMsLastFrame = 0.0f;
+    if (!active())
+        return;
+
+    ++m_frame;
+    collectTimings();
+    trackSceneChanges(meshManager, lighting);
+
+    GLint previousFramebuffer = 0;
+    GLint previousProgram = 0;
+    GLint previousViewport[4] {};
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+    glGetIntegerv(GL_VIEWPORT, previousViewport);
+    const GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    const GLboolean cullFace = glIsEnabled(GL_CULL_FACE);
+    const GLboolean blend = glIsEnabled(GL_BLEND);
+    GLboolean depthMask = GL_TRUE;
+    GLint depthFunc = GL_LESS;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depthMask);
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+    bool touchedState = false;
+
+    const int maxFaces = std::clamp(m_settings.maxFacesPerFrame, 1, 6);
+    float spentMs = 0.0f;
+    while (true) {
+        if (m_rebuild.slot < 0) {
+            const int next = pickNextProbe(cameraPosition);
+            if (next < 0)
+                break;
+            m_rebuild = Rebuild {};
+            m_rebuild.slot = next;
+            m_rebuild.startFrame = m_frame;
+            // Changes from here on are not in this capture and will schedule the probe again.
+            m_slots[static_cast<std::size_t>(next)].changed = false;
+        }
+
+        const StepKind kind = m_rebuild.nextFace < 6 ? StepKind::Face : StepKind::Filter;
+        if (kind == StepKind::Face && m_stats.facesLastFrame >= maxFaces)
+            break;
+        const float costMs = estimatedMs(kind);
+        if (spentMs > 0.0f && spentMs + costMs > m_settings.budgetMs)
+            break;
+
+        if (!touchedState) {
+            glDisable(GL_CULL_FACE);
+            glDisable(GL_BLEND);
+            touchedState = true;
+        }
+        beginStepTiming(kind);
+        if (kind == StepKind::Face) {
+            renderFace(meshManager, lighting);
+            ++m_rebuild.nextFace;
+            ++m_stats.facesLastFrame;
+        } else {
+            filterLevel();
+            ++m_rebuild.nextLevel;
+            ++m_stats.filterStepsLastFrame;
+            if (m_rebuild.nextLevel >= kMipLevels)
+                publish();
+        }
+        endStepTiming(kind);
+        spentMs += costMs;
+    }
+    m_stats.estimatedMsLastFrame = spentMs;
+
+    if (touchedState) {
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+        glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]);
+        glUseProgram(static_cast<GLuint>(previousProgram));
+        glBindVertexArray(0);
+        glBindTextures(kSkyUnit, 2, nullptr);
+        depthTest ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+        cullFace ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE);
+        blend ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+        glDepthMask(depthMask);
+        glDepthFunc(static_cast<GLenum>(depthFunc));
+    }
+}
+
+void ReflectionProbes::renderFace(MeshManager& meshManager, const SceneLighting& lighting)
+{
+    const Probe& probe = m_slots[static_cast<std::size_t>(m_rebuild.slot)].probe;
+    const std::size_t face = static_cast<std::size_t>(m_rebuild.nextFace);
+    const glm::vec3 eye = probe.capturePosition;
+    const float farPlane = std::max(m_settings.farPlane, m_settings.nearPlane + 1.0f);
+    const glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, m_settings.nearPlane, farPlane);
+    const glm::mat4 view = glm::lookAt(eye, eye + kFaceDirections[face], kFaceUps[face]);
+
+    glNamedFramebufferTextureLayer(m_framebuffer, GL_COLOR_ATTACHMENT0, m_stagingCube, 0, static_cast<GLint>(face));
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, kFaceSize, kFaceSize);
+    glDepthMask(GL_TRUE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    const bool useEnvironment = lighting.skyCubemap != 0 && lighting.irradianceCubemap != 0;
+    m_captureShader.bind();
+    setUniform(m_captureShader, "uUseEnvironment", useEnvironment ? 1 : 0);
+    setUniform(m_captureShader, "uEnvironmentIntensity", lighting.environmentIntensity);
+    setUniform(m_captureShader, "uAmbient", lighting.ambient);
+    setUniform(m_captureShader, "uCapturePosition", eye);
+    setUniform(m_captureShader, "uLightCount", lighting.lightBuffer != 0 ? lighting.lightCount : 0);
+    glBindTextureUnit(kSkyUnit, lighting.skyCubemap);
+    glBindTextureUnit(kIrradianceUnit, lighting.irradianceCubemap);
+    glBindSampler(kSkyUnit, 0);
+    glBindSampler(kIrradianceUnit, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kLightBufferBinding, lighting.lightBuffer);
+
+    // Background first, without depth, so geometry simply draws over it.
+    glDisable(GL_DEPTH_TEST);
+    setUniform(m_captureShader, "uSkyPass", 1);
+    setUniform(m_captureShader, "uInverseViewProjection", glm::inverse(projection * glm::mat4(glm::mat3(view))));
+    glBindVertexArray(m_emptyVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    setUniform(m_captureShader, "uSkyPass", 0);
+    setUniform(m_captureShader, "uViewProjection", projection * view);
+    for (MeshInstance& instance : meshManager.instances()) {
+        for (MeshDrawItem& item : instance.drawItems()) {
+            if (!item.geometry.resident() || item.material.alphaMode == AlphaMode::Blend || item.material.isTransparent)
+                continue;
+            const glm::mat4 model = instance.transform() * item.nodeTransform;
+            const BoundingBox bounds = transformBounds(item.bounds, model);
+            const glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+            const float radius = glm::length(bounds.max - center);
+            if (!sphereInFace(center, radius, eye, kFaceDirections[face], kFaceUps[face], farPlane))
+                continue;
+
+            // Textures are skipped: the constant factors are close enough at probe resolution.
+            const RenderMaterial& material = item.material;
+            setUniform(m_captureShader, "uModel", model);
+            setUniform(m_captureShader, "uNormalMatrix", glm::mat3(glm::inverseTranspose(model)));
+            setUniform(m_captureShader, "uAlbedo", material.baseColor * (1.0f - 0.75f * glm::clamp(material.metallic, 0.0f, 1.0f)));
+            setUniform(m_captureShader, "uEmissive", material.emissive * material.emissiveIntensity);
+            item.geometry.draw(m_captureShader);
+        }
+    }
+    ++m_stats.facesRendered;
+}
+
+void ReflectionProbes::filterLevel()
+{
+    const int level = m_rebuild.nextLevel;
+    const int size = std::max(kFaceSize >> level, 1);
+    m_filterShader.bind();
+    setUniform(m_filterShader, "uLevel", level);
+    setUniform(m_filterShader, "uLevelCount", kMipLevels);
+    setUniform(m_filterShader, "uSampleCount", std::clamp(m_settings.filterSamples, 1, 1024));
+    glBindTextureUnit(kFilterSourceUnit, m_stagingCube);
+    glBindSampler(kFilterSourceUnit, 0);
+    // Only levels above `level` are sampled (the shader clamps the lod), so reading and writing the
+    // same texture does not overlap.
+    glBindImageTexture(kFilterTargetImage, m_stagingCube, level, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glDispatchCompute(groupCount(size), groupCount(size), 6);
+    glMemoryBarrier(kFilterBarriers);
+}
+
+void ReflectionProbes::publish()
+{
+    Slot& slot = m_slots[static_cast<std::size_t>(m_rebuild.slot)];
+    for (int level = 0; level < kMipLevels; ++level) {
+        const int size = std::max(kFaceSize >> level, 1);
+        glCopyImageSubData(m_stagingCube, GL_TEXTURE_CUBE_MAP, level, 0, 0, 0,
+            m_cubemapArray, GL_TEXTURE_CUBE_MAP_ARRAY, level, 0, 0, m_rebuild.slot * 6,
+            size, size, 6);
+    }
+    slot.published = true;
+    slot.capturedFrame = m_rebuild.startFrame;
+    ++m_stats.probesPublished;
+    m_stats.framesPerRebuild = m_frame - m_rebuild.startFrame + 1;
+    m_rebuild = {};
+}
+
+void ReflectionProbes::beginStepTiming(StepKind kind)
+{
+    if (m_timerQueries.front() == 0)
+        glCreateQueries(GL_TIME_ELAPSED, static_cast<GLsizei>(m_timerQueries.size()), m_timerQueries.data());
+    // A slot still unread after a full lap is dropped rather than stalled on.
+    m_timerPending[m_timerIndex] = false;
+    m_timerKinds[m_timerIndex] = kind;
+    glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_timerIndex]);
+    m_stepStart = std::chrono::steady_clock::now();
+}
+
+void ReflectionProbes::endStepTiming(StepKind kind)
+{
+    glEndQuery(GL_TIME_ELAPSED);
+    m_timerPending[m_timerIndex] = true;
+    m_timerIndex = (m_timerIndex + 1) % m_timerQueries.size();
+
+    const float cpuMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_stepStart).count();
+    float& average = kind == StepKind::Face ? m_stats.faceCpuMs : m_stats.filterCpuMs;
+    average = average > 0.0f ? average + (cpuMs - average) * kAverageWeight : cpuMs;
+}
+
+void ReflectionProbes::collectTimings()
+{
+    for (std::size_t i = 0; i < m_timerQueries.size(); ++i) {
+        if (!m_timerPending[i])
+            continue;
+        GLint available = 0;
+        glGetQueryObjectiv(m_timerQueries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        GLuint64 elapsedNs = 0;
+        glGetQueryObjectui64v(m_timerQueries[i], GL_QUERY_RESULT, &elapsedNs);
+        m_timerPending[i] = false;
+
+        const float gpuMs = static_cast<float>(static_cast<double>(elapsedNs) * 1e-6);
+        float& average = m_timerKinds[i] == StepKind::Face ? m_stats.faceGpuMs : m_stats.filterGpuMs;
+        average = average > 0.0f ? average + (gpuMs - average) * kAverageWeight : gpuMs;
+    }
+}
+
+void ReflectionProbes::drawImGuiPanel(const glm::vec3& cameraPosition)
+{
+    if (!m_ready) {
+        ImGui::TextDisabled("Unavailable: shaders failed to build.");
+        return;
+    }
+    ImGui::Checkbox("Reflection Probes", &m_settings.enabled);
+    ImGui::BeginDisabled(!m_settings.enabled);
+    ImGui::SliderInt("Max Faces Per Frame", &m_settings.maxFacesPerFrame, 1, 6);
+    ImGui::SliderFloat("Budget", &m_settings.budgetMs, 0.05f, 4.0f, "%.2f ms");
+    ImGui::SliderInt("Filter Samples", &m_settings.filterSamples, 8, 256);
+    ImGui::SliderFloat("Capture Far Plane", &m_settings.farPlane, 10.0f, 1000.0f, "%.0f m");
+    ImGui::SliderFloat("Priority Distance", &m_settings.priorityDistance, 1.0f, 100.0f, "%.1f m");
+    ImGui::SliderFloat("Change Radius", &m_settings.changeRadius, 0.0f, 50.0f, "%.1f m");
+    ImGui::Checkbox("Periodic Refresh", &m_settings.periodicRefresh);
+    if (m_settings.periodicRefresh) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(120.0f);
+        ImGui::SliderInt("Frames", &m_settings.refreshFrames, 1, 1200);
+    }
+
+    if (ImGui::Button("Add Probe Here")) {
+        Probe probe;
+        probe.capturePosition = cameraPosition;
+        probe.boxMin = cameraPosition - glm::vec3(5.0f);
+        probe.boxMax = cameraPosition + glm::vec3(5.0f);
+        if (addProbe(probe) < 0)
+            LOG_WARNING(logging::Category::General, "[ReflectionProbes] All {} probe slots are in use", kMaxProbes);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Recapture All")) {
+        for (Slot& slot : m_slots)
+            slot.changed = slot.changed || slot.used;
+    }
+
+    for (int i = 0; i < kMaxProbes; ++i) {
+        Slot& slot = m_slots[static_cast<std::size_t>(i)];
+        if (!slot.used)
+            continue;
+        ImGui::PushID(i);
+        const char* status = m_rebuild.slot == i ? "capturing" : (!slot.published ? "pending" : (slot.changed ? "changed" : "current"));
+        if (ImGui::TreeNode("probe", "Probe %d (%s, %llu frames old)", i, status,
+                static_cast<unsigned long long>(slot.published ? m_frame - slot.capturedFrame : 0))) {
+            Probe probe = slot.probe;
+            bool edited = false;
+            edited |= ImGui::DragFloat3("Capture Position", glm::value_ptr(probe.capturePosition), 0.05f);
+            edited |= ImGui::DragFloat3("Box Min", glm::value_ptr(probe.boxMin), 0.05f);
+            edited |= ImGui::DragFloat3("Box Max", glm::value_ptr(probe.boxMax), 0.05f);
+            edited |= ImGui::SliderFloat("Blend Distance", &probe.blendDistance, 0.01f, 5.0f, "%.2f m");
+            edited |= ImGui::Checkbox("Box Projection", &probe.boxProjection);
+            if (ImGui::Button("Move Here")) {
+                const glm::vec3 offset = cameraPosition - probe.capturePosition;
+                probe.capturePosition += offset;
+                probe.boxMin += offset;
+                probe.boxMax += offset;
+                edited = true;
+            }
+            if (edited)
+                setProbe(i, probe);
+            ImGui::SameLine();
+            if (ImGui::Button("Remove"))
+                removeProbe(i);
+            ImGui::TreePop();
+        }
+        ImGui::PopID();
+    }
+    ImGui::EndDisabled();
+
+    ImGui::Text("Last frame: %d faces, %d filter steps, ~%.3f ms", m_stats.facesLastFrame, m_stats.filterStepsLastFrame,
+        static_cast<double>(m_stats.estimatedMsLastFrame));
+    ImGui::Text("Face: GPU %.3f ms, CPU %.3f ms  Filter: GPU %.3f ms, CPU %.3f ms", static_cast<double>(m_stats.faceGpuMs),
+        static_cast<double>(m_stats.faceCpuMs), static_cast<double>(m_stats.filterGpuMs), static_cast<double>(m_stats.filterCpuMs));
+    ImGui::Text("Faces rendered: %llu  Probes published: %llu  Frames per rebuild: %llu",
+        static_cast<unsigned long long>(m_stats.facesRendered), static_cast<unsigned long long>(m_stats.probesPublished),
+        static_cast<unsigned long long>(m_stats.framesPerRebuild));
+}
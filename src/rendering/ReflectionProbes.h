@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "mesh/MeshInstance.h"
+
+#include <framework/opengl_includes.h>
+#include <framework/shader.h>
+
+#include <glm/vec3.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+class MeshManager;
+
+// Placeable local reflection probes with box projection, kept up to date by a time-sliced scheduler.
+// A probe is rebuilt one step at a time into a staging cubemap: six face renders of the scene with
+// simplified shading (reflection_probe_capture), then one GGX convolution per prefilter mip, each
+// reading the mips above it, then a copy into the probe's layer of the shared cube-map array. So a
+// half-finished rebuild is never visible. Every frame runs steps until either the face cap or the
+// millisecond budget is reached; step costs are running averages of their CPU submission time plus
+// their GPU time from timer queries. Probes that have never been captured, whose box saw scene changes
+// (instances moved, streamed, added or removed; edited probes; a new environment) or, with periodic
+// refresh, whose capture is old, compete for the next rebuild; nearer probes and changed probes win.
+class ReflectionProbes {
+public:
+    static constexpr int kMaxProbes = 8;
+    static constexpr int kFaceSize = 128;
+    static constexpr int kMipLevels = 6; // 128 down to 4 texels, roughness 0..1
+
+    struct Probe {
+        glm::vec3 capturePosition { 0.0f };
+        // Influence and projection volume in world space.
+        glm::vec3 boxMin { -5.0f };
+        glm::vec3 boxMax { 5.0f };
+        float blendDistance { 0.5f }; // metres inside the box over which the probe fades in
+        bool boxProjection { true };
+    };
+
+    struct Settings {
+        bool enabled { true };
+        int maxFacesPerFrame { 1 };
+        // Estimated CPU + GPU cost allowed per frame. A single step costing more still runs, alone,
+        // so rebuilds never stall.
+        float budgetMs { 0.5f };
+        int filterSamples { 48 };
+        float nearPlane { 0.05f };
+        float farPlane { 200.0f };
+        // Instance changes within this distance of a probe's box mark the probe changed.
+        float changeRadius { 5.0f };
+        // Distance to the camera at which a probe's priority halves.
+        float priorityDistance { 10.0f };
+        bool periodicRefresh { true };
+        int refreshFrames { 240 };
+    };
+
+    // What the captures are lit by; environment maps are optional.
+    struct SceneLighting {
+        GLuint lightBuffer { 0 };
+        int lightCount { 0 };
+        GLuint skyCubemap { 0 }; // sampled at mip 0
+        GLuint irradianceCubemap { 0 };
+        float environmentIntensity { 1.0f };
+        glm::vec3 ambient { 0.1f };
+    };
+
+    struct Stats {
+        int facesLastFrame { 0 };
+        int filterStepsLastFrame { 0 };
+        float estimatedMsLastFrame { 0.0f };
+        float faceGpuMs { 0.0f }; // running averages
+        float faceCpuMs { 0.0f };
+        float filterGpuMs { 0.0f };
+        float filterCpuMs { 0.0f };
+        std::uint64_t facesRendered { 0 };
+        std::uint64_t probesPublished { 0 };
+        std::uint64_t framesPerRebuild { 0 }; // of the last published probe
+    };
+
+    ReflectionProbes() = default;
+    ~ReflectionProbes();
+    ReflectionProbes(const ReflectionProbes&) = delete;
+    ReflectionProbes& operator=(const ReflectionProbes&) = delete;
+
+    void initialize();
+    void release();
+
+    // Returns the slot, or -1 when all kMaxProbes slots are taken.
+    int addProbe(const Probe& probe);
+    void removeProbe(int slot);
+    void setProbe(int slot, const Probe& probe);
+    [[nodiscard]] bool used(int slot) const;
+    // The slot's layer of cubemapArray() holds a complete capture.
+    [[nodiscard]] bool published(int slot) const;
+    [[nodiscard]] const Probe& probe(int slot) const;
+
+    // Tracks scene changes and runs this frame's share of capture and filtering. Leaves the draw
+    // framebuffer, viewport and program as it found them.
+    void update(MeshManager& meshManager, const glm::vec3& cameraPosition, const SceneLighting& lighting);
+
+    [[nodiscard]] bool active() const { return m_settings.enabled && m_ready; }
+    [[nodiscard]] GLuint cubemapArray() const { return m_cubemapArray; }
+    [[nodiscard]] Settings& settings() { return m_settings; }
+    [[nodiscard]] const Stats& stats() const { return m_stats; }
+
+    // `cameraPosition` is where "Add Probe Here" places new probes.
+    void drawImGuiPanel(const glm::vec3& cameraPosition);
+
+private:
+    enum class StepKind : int {
+        Face = 0,
+        Filter = 1
+    };
+
+    struct Slot {
+        Probe probe;
+        bool used { false };
+        bool published { false };
+        bool changed { true };
+        std::uint64_t capturedFrame { 0 }; // frame the published capture started
+    };
+
+    struct TrackedInstance {
+        std::uint64_t transformVersion { 0 };
+        std::size_t residentItems { 0 };
+        BoundingBox bounds;
+        std::uint64_t seenFrame { 0 };
+    };
+
+    struct Rebuild {
+        int slot { -1 };
+        int nextFace { 0 };
+        int nextLevel { 1 };
+        std::uint64_t startFrame { 0 };
+    };
+
+    void createResources();
+    void trackSceneChanges(const MeshManager& meshManager, const SceneLighting& lighting);
+    void markChanged(const BoundingBox& bounds);
+    [[nodiscard]] int pickNextProbe(const glm::vec3& cameraPosition) const;
+    [[nodiscard]] float estimatedMs(StepKind kind) const;
+    void renderFace(MeshManager& meshManager, const SceneLighting& lighting);
+    void filterLevel();
+    void publish();
+    void beginStepTiming(StepKind kind);
+    void endStepTiming(StepKind kind);
+    void collectTimings();
+
+    Settings m_settings;
+    Stats m_stats;
+    bool m_ready { false };
+
+    Shader m_captureShader;
+    Shader m_filterShader;
+    GLuint m_emptyVao { 0 };
+    GLuint m_stagingCube { 0 };
+    GLuint m_cubemapArray { 0 };
+    GLuint m_depthBuffer { 0 };
+    GLuint m_framebuffer { 0 };
+
+    std::array<Slot, kMaxProbes> m_slots {};
+    Rebuild m_rebuild {};
+    std::uint64_t m_frame { 0 };
+    std::unordered_map<std::uint64_t, TrackedInstance> m_trackedInstances;
+    GLuint m_trackedSky { 0 };
+    GLuint m_trackedIrradiance { 0 };
+    float m_trackedIntensity { 0.0f };
+
+    // Per-step timer queries; results are folded into the running averages once available.
+    static constexpr std::size_t kTimerQueries = 32;
+    std::array<GLuint, kTimerQueries> m_timerQueries {};
+    std::array<bool, kTimerQueries> m_timerPending {};
+    std::array<StepKind, kTimerQueries> m_timerKinds {};
+    std::size_t m_timerIndex { 0 };
+    std::chrono::steady_clock::time_point m_stepStart;
+};
@@ -25,7 +25,7 @@ DISABLE_WARNINGS_POP()
 
 namespace {
 
-constexpr std::array<GLuint, ShadingStage::kMaterialTextureUnitCount + 5 + ShadingStage::kPointShadowUnitCount> kTrackedTextureUnits {
+constexpr std::array<GLuint, ShadingStage::kMaterialTextureUnitCount + 5 + ShadingStage::kPointShadowUnitCount + TextureUnits::MaterialArray_Count> kTrackedTextureUnits {
     0, 1, 2, 3, 4,
     ShadingStage::kEnvIrradianceUnit,
     ShadingStage::kEnvPrefilterUnit,
@@ -39,7 +39,15 @@ constexpr std::array<GLuint, ShadingStage::kMaterialTextureUnitCount + 5 + Shadi
     ShadingStage::kPointShadowUnitBase + 4,
     ShadingStage::kPointShadowUnitBase + 5,
     ShadingStage::kPointShadowUnitBase + 6,
-    ShadingStage::kPointShadowUnitBase + 7
+    ShadingStage::kPointShadowUnitBase + 7,
+    TextureUnits::MaterialArray_Units[0],
+    TextureUnits::MaterialArray_Units[1],
+    TextureUnits::MaterialArray_Units[2],
+    TextureUnits::MaterialArray_Units[3],
+    TextureUnits::MaterialArray_Units[4],
+    TextureUnits::MaterialArray_Units[5],
+    TextureUnits::MaterialArray_Units[6],
+    TextureUnits::MaterialArray_Units[7]
 };
 
 void resetTrackedTextureUnits()
@@ -105,11 +113,14 @@ void dumpActiveSamplers(GLuint program)
 #endif
 }
 
-void logTextureBinding(const char* label, GLuint unit, GLenum bindingTarget)
+void logTextureBinding(const char* label, GLuint unit, GLenum bindingTarget, int layer = -1)
 {
     GLint bound = 0;
     glGetIntegeri_v(bindingTarget, unit, &bound);
-    std::cout << "    unit[" << unit << "] " << label << " -> tex=" << bound << "\n";
+    std::cout << "    unit[" << unit << "] " << label << " -> tex=" << bound;
+    if (layer >= 0)
+        std::cout << " layer=" << layer;
+    std::cout << "\n";
 }
 
 #ifndef NDEBUG
@@ -209,7 +220,8 @@ void configureLightingBindings(const Shader& shader)
 
     const GLint samplerLocation = glGetUniformLocation(program, "uShadowMapArray");
     const GLint pointSamplerLocation = glGetUniformLocation(program, "uPointShadowMaps");
-    if (samplerLocation >= 0 || pointSamplerLocation >= 0) {
+    const GLint materialArraysLocation = glGetUniformLocation(program, "uMaterialArrays");
+    if (samplerLocation >= 0 || pointSamplerLocation >= 0 || materialArraysLocation >= 0) {
         GLint previousProgram = 0;
         glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
         if (static_cast<GLuint>(previousProgram) != program)
@@ -222,6 +234,12 @@ void configureLightingBindings(const Shader& shader)
                 units[i] = static_cast<GLint>(ShadingStage::kPointShadowUnitBase + static_cast<GLuint>(i));
             glUniform1iv(pointSamplerLocation, static_cast<GLsizei>(units.size()), units.data());
         }
+        if (materialArraysLocation >= 0) {
+            std::array<GLint, TextureUnits::MaterialArray_Count> units {};
+            for (std::size_t i = 0; i < units.size(); ++i)
+                units[i] = static_cast<GLint>(TextureUnits::MaterialArray_Units[i]);
+            glUniform1iv(materialArraysLocation, static_cast<GLsizei>(units.size()), units.data());
+        }
         if (static_cast<GLuint>(previousProgram) != program)
             glUseProgram(static_cast<GLuint>(previousProgram));
     }
@@ -264,6 +282,10 @@ ShadingStage::~ShadingStage()
         glDeleteBuffers(1, &m_objectUBO);
         m_objectUBO = 0;
     }
+    if (m_reflectionProbeUBO != 0) {
+        glDeleteBuffers(1, &m_reflectionProbeUBO);
+        m_reflectionProbeUBO = 0;
+    }
     if (m_envCubeSampler != 0) {
         glDeleteSamplers(1, &m_envCubeSampler);
         m_envCubeSampler = 0;
@@ -298,6 +320,13 @@ void ShadingStage::ensureBuffers()
         glBindBufferBase(GL_UNIFORM_BUFFER, kPerObjectBinding, m_objectUBO);
     }
 
+    if (m_reflectionProbeUBO == 0) {
+        glGenBuffers(1, &m_reflectionProbeUBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_reflectionProbeUBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(ReflectionProbeGPUData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, kReflectionProbeBinding, m_reflectionProbeUBO);
+    }
+
     if (m_materialSSBO == 0) {
         glGenBuffers(1, &m_materialSSBO);
         m_materialCapacity = 16;
@@ -376,6 +405,16 @@ void ShadingStage::drawImGuiPanel(std::vector<MeshInstance>& instances, int sele
     }
     ImGui::Separator();
 
+    if (ImGui::CollapsingHeader("Material Texture Arrays")) {
+        m_textureArrays.drawImGuiPanel();
+        const BatchStats& batches = m_lastBatchStats;
+        ImGui::Text("Main pass: %u draws", batches.draws);
+        ImGui::Text("Texture bind-set changes: %u per-material -> %u with arrays",
+            batches.bindSetChangesUnpacked,
+            batches.bindSetChangesPacked);
+        ImGui::Separator();
+    }
+
     if (instances.empty()) {
         ImGui::TextDisabled("No mesh instances loaded.");
         return;
@@ -563,16 +602,49 @@ void ShadingStage::beginFrame(const glm::mat4& view,
         iblReady ? m_environmentState.prefilterMipLevels : 0.0f,
         0.0f,
         0.0f);
+    const bool probesReady = m_probeGridState.atlas != 0 && glm::all(glm::greaterThan(m_probeGridState.resolution, glm::ivec3(0)));
+    m_frameData.probeGridOrigin = glm::vec4(m_probeGridState.origin, probesReady ? m_probeGridState.intensity : 0.0f);
+    m_frameData.probeGridInvSpacing = glm::vec4(1.0f / glm::max(m_probeGridState.spacing, glm::vec3(1e-4f)), m_probeGridState.normalBias);
+    m_frameData.probeGridResolution = glm::ivec4(glm::max(m_probeGridState.resolution, glm::ivec3(1)), 0);
 
     glBindBuffer(GL_UNIFORM_BUFFER, m_perFrameUBO);
     glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(PerFrameData), &m_frameData);
     glBindBufferBase(GL_UNIFORM_BUFFER, kPerFrameBinding, m_perFrameUBO);
 
+    // The shader takes the first probes until their weights add up to one, so smaller (more local)
+    // boxes go first and override the larger ones they sit in.
+    const bool reflectionProbesReady = iblReady && m_reflectionProbeState.cubemapArray != 0 && m_reflectionProbeState.count > 0;
+    const int reflectionProbeCount = reflectionProbesReady ? std::min(m_reflectionProbeState.count, static_cast<int>(kMaxReflectionProbes)) : 0;
+    std::array<const ReflectionProbeState::Volume*, kMaxReflectionProbes> probeOrder {};
+    for (int i = 0; i < reflectionProbeCount; ++i)
+        probeOrder[static_cast<std::size_t>(i)] = &m_reflectionProbeState.volumes[static_cast<std::size_t>(i)];
+    const auto boxVolume = [](const ReflectionProbeState::Volume* volume) {
+        const glm::vec3 extent = glm::max(volume->boxMax - volume->boxMin, glm::vec3(0.0f));
+        return extent.x * extent.y * extent.z;
+    };
+    std::sort(probeOrder.begin(), probeOrder.begin() + reflectionProbeCount,
+        [&](const auto* a, const auto* b) { return boxVolume(a) < boxVolume(b); });
+    m_reflectionProbeData.counts = glm::ivec4(reflectionProbeCount, m_reflectionProbeState.mipLevels, 0, 0);
+    for (int i = 0; i < reflectionProbeCount; ++i) {
+        const ReflectionProbeState::Volume& volume = *probeOrder[static_cast<std::size_t>(i)];
+        const std::size_t slot = static_cast<std::size_t>(i);
+        m_reflectionProbeData.capturePosition[slot] = glm::vec4(volume.capturePosition, static_cast<float>(volume.layer));
+        m_reflectionProbeData.boxMin[slot] = glm::vec4(volume.boxMin, std::max(volume.blendDistance, 1e-3f));
+        m_reflectionProbeData.boxMax[slot] = glm::vec4(volume.boxMax, volume.boxProjection ? 1.0f : 0.0f);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, m_reflectionProbeUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ReflectionProbeGPUData), &m_reflectionProbeData);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kReflectionProbeBinding, m_reflectionProbeUBO);
+
     for (GLuint unit = 0; unit < kMaterialTextureUnitCount; ++unit) {
         glBindTextureUnit(unit, 0);
         glBindSampler(unit, 0);
     }
+    m_textureArrays.bind();
+    glBindTextureUnit(TextureUnits::Probe_Irradiance, probesReady ? m_probeGridState.atlas : 0);
+    glBindTextureUnit(TextureUnits::Probe_Reflection, reflectionProbesReady ? m_reflectionProbeState.cubemapArray : 0);
     m_boundMaterialState.valid = false;
+    m_batchStats = {};
 
     if (m_lightBinding.lightSSBO != 0)
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kLightSsboBinding, m_lightBinding.lightSSBO);
@@ -630,6 +702,7 @@ void ShadingStage::beginFrame(const glm::mat4& view,
 
 void ShadingStage::endFrame()
 {
+    m_lastBatchStats = m_batchStats;
     m_frameActive = false;
     m_boundMaterialState.valid = false;
 }
@@ -737,6 +810,12 @@ ShadingStage::MaterialGPUData ShadingStage::buildMaterialData(const RenderMateri
         material.aoUVTransform.rotation);
     gpu.uvRotations2 = glm::vec4(material.emissiveUVTransform.rotation, 0.0f, 0.0f, 0.0f);
 
+    gpu.arrayRefs0 = glm::ivec4(m_textureArrays.packedReference(material.albedoMap.get()),
+        m_textureArrays.packedReference(material.metallicRoughnessMap.get()),
+        m_textureArrays.packedReference(material.normalMap.get()),
+        m_textureArrays.packedReference(material.aoMap.get()));
+    gpu.arrayRefs1 = glm::ivec4(m_textureArrays.packedReference(material.emissiveMap.get()), -1, -1, -1);
+
     return gpu;
 }
 
@@ -823,33 +902,65 @@ void ShadingStage::bindMaterialResources(MaterialRecord& record,
                   << "\n";
     }
 
-    const auto bindTextureIf = [](const std::shared_ptr<Texture>& texture,
-                                  GLuint unitIndex,
-                                  bool shouldBind) {
-        TextureUnits::assertNotEnvUnit(unitIndex);
-        if (shouldBind && texture) {
-            glBindTextureUnit(unitIndex, texture->id());
-            glBindSampler(unitIndex, texture->samplerHandle());
-        } else {
-            glBindTextureUnit(unitIndex, 0);
-            glBindSampler(unitIndex, 0);
-        }
+    struct TextureSlot {
+        const std::shared_ptr<Texture>& texture;
+        GLuint unit;
+        bool use;
+        const char* label;
     };
+    const std::array<TextureSlot, kBoundTextureSlots> slots { {
+        { material.albedoMap, TextureUnits::Material_Albedo, bindingInfo.useAlbedo, "albedo" },
+        { material.normalMap, TextureUnits::Material_Normal, bindingInfo.useNormal, "normal" },
+        { material.metallicRoughnessMap, TextureUnits::Material_MetallicRoughness, bindingInfo.useMetallicRoughness, "metalRough" },
+        { material.aoMap, TextureUnits::Material_AO, bindingInfo.useAO, "ao" },
+        { material.emissiveMap, TextureUnits::Material_Emissive, bindingInfo.useEmissive, "emissive" },
+        { material.heightMap, 5, bindingInfo.useHeight, "height" },
+    } };
+
+    // Textures living in a shared array are read through the material SSBO, so only the standalone
+    // ones contribute to the bind set. A draw that keeps the same bind set needs no texture binds.
+    std::array<GLuint, kBoundTextureSlots> unpacked {};
+    std::array<GLuint, kBoundTextureSlots> standalone {};
+    for (std::size_t i = 0; i < slots.size(); ++i) {
+        const TextureSlot& slot = slots[i];
+        if (!slot.use || !slot.texture)
+            continue;
+        unpacked[i] = slot.texture->id();
+        if (m_textureArrays.packedReference(slot.texture.get()) == MaterialTextureArrays::kNotPacked)
+            standalone[i] = slot.texture->id();
+    }
 
-    bindTextureIf(material.albedoMap,            TextureUnits::Material_Albedo,            bindingInfo.useAlbedo);
-    bindTextureIf(material.normalMap,            TextureUnits::Material_Normal,            bindingInfo.useNormal);
-    bindTextureIf(material.metallicRoughnessMap, TextureUnits::Material_MetallicRoughness, bindingInfo.useMetallicRoughness);
-    bindTextureIf(material.aoMap,                TextureUnits::Material_AO,                bindingInfo.useAO);
-    bindTextureIf(material.emissiveMap,          TextureUnits::Material_Emissive,          bindingInfo.useEmissive);
-    bindTextureIf(material.heightMap,            5,                                        bindingInfo.useHeight);
+    ++m_batchStats.draws;
+    if (!m_boundMaterialState.valid || unpacked != m_boundMaterialState.unpackedTextures)
+        ++m_batchStats.bindSetChangesUnpacked;
+    if (!m_boundMaterialState.valid || standalone != m_boundMaterialState.standaloneTextures) {
+        ++m_batchStats.bindSetChangesPacked;
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+            const TextureSlot& slot = slots[i];
+            TextureUnits::assertNotEnvUnit(slot.unit);
+            if (standalone[i] != 0) {
+                glBindTextureUnit(slot.unit, standalone[i]);
+                glBindSampler(slot.unit, slot.texture->samplerHandle());
+            } else {
+                glBindTextureUnit(slot.unit, 0);
+                glBindSampler(slot.unit, 0);
+            }
+        }
+    }
+    m_boundMaterialState.unpackedTextures = unpacked;
+    m_boundMaterialState.standaloneTextures = standalone;
 
     if (m_enableDebugLogging) {
-        logTextureBinding("albedo", TextureUnits::Material_Albedo, GL_TEXTURE_BINDING_2D);
-        logTextureBinding("normal", TextureUnits::Material_Normal, GL_TEXTURE_BINDING_2D);
-        logTextureBinding("metalRough", TextureUnits::Material_MetallicRoughness, GL_TEXTURE_BINDING_2D);
-        logTextureBinding("ao", TextureUnits::Material_AO, GL_TEXTURE_BINDING_2D);
-        logTextureBinding("emissive", TextureUnits::Material_Emissive, GL_TEXTURE_BINDING_2D);
-        logTextureBinding("height", 5, GL_TEXTURE_BINDING_2D);
+        // Packed slots are read from their array unit; report that binding and the layer instead.
+        for (const TextureSlot& slot : slots) {
+            const std::int32_t reference = slot.use && slot.texture ? m_textureArrays.packedReference(slot.texture.get()) : MaterialTextureArrays::kNotPacked;
+            if (reference == MaterialTextureArrays::kNotPacked) {
+                logTextureBinding(slot.label, slot.unit, GL_TEXTURE_BINDING_2D);
+                continue;
+            }
+            const auto arrayIndex = static_cast<std::size_t>(reference >> MaterialTextureArrays::kLayerBits);
+            logTextureBinding(slot.label, TextureUnits::MaterialArray_Units[arrayIndex], GL_TEXTURE_BINDING_2D_ARRAY, reference & MaterialTextureArrays::kLayerMask);
+        }
     }
 
     const bool wasValid = m_boundMaterialState.valid;
@@ -1084,6 +1195,11 @@ void ShadingStage::apply(const glm::mat4& model,
     updateObjectBuffer(model, record, bindingInfo, hasTangents, hasPrimaryUVs, hasSecondaryUVs);
 }
 
+void ShadingStage::syncMaterialTextureArrays(const std::vector<MeshInstance>& instances)
+{
+    m_textureArrays.sync(instances);
+}
+
 LightingSettings& ShadingStage::settings()
 {
     return m_settings;
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "mesh/MeshInstance.h"
+#include "rendering/MaterialTextureArrays.h"
 #include "rendering/ShaderManager.h"
 #include "rendering/TextureUnits.h"
 
@@ -58,6 +59,8 @@ public:
     static constexpr GLuint kMaterialSsboBinding = 2;
     static constexpr GLuint kPerFrameBinding = 3;
     static constexpr GLuint kPerObjectBinding = 4;
+    static constexpr GLuint kReflectionProbeBinding = 6;
+    static constexpr std::size_t kMaxReflectionProbes = 8;
 
     explicit ShadingStage(const std::filesystem::path& shaderDirectory);
     ~ShadingStage();
@@ -76,6 +79,33 @@ public:
         }
     };
 
+    // Baked IrradianceProbeGrid; atlas 0 disables probe lighting.
+    struct ProbeGridState {
+        GLuint atlas { 0 };
+        glm::vec3 origin { 0.0f };
+        glm::vec3 spacing { 1.0f };
+        glm::ivec3 resolution { 0 };
+        float intensity { 1.0f };
+        float normalBias { 0.0f }; // metres
+    };
+
+    // Published ReflectionProbes; a zero count or cubemap array disables local reflections.
+    struct ReflectionProbeState {
+        struct Volume {
+            glm::vec3 capturePosition { 0.0f };
+            glm::vec3 boxMin { 0.0f };
+            glm::vec3 boxMax { 0.0f };
+            float blendDistance { 0.5f };
+            bool boxProjection { true };
+            int layer { 0 }; // cube index in the array
+        };
+
+        GLuint cubemapArray { 0 };
+        int mipLevels { 0 };
+        std::array<Volume, kMaxReflectionProbes> volumes {};
+        int count { 0 };
+    };
+
     struct LightBufferBinding {
         GLuint lightSSBO { 0 };
         GLuint shadowMatricesUBO { 0 };
@@ -108,6 +138,8 @@ public:
 
     void setEnvironmentState(const EnvironmentState& state);
     [[nodiscard]] const EnvironmentState& environmentState() const { return m_environmentState; }
+    void setProbeGridState(const ProbeGridState& state) { m_probeGridState = state; }
+    void setReflectionProbeState(const ReflectionProbeState& state) { m_reflectionProbeState = state; }
 
     // World curvature: when enabled, geometry positions in view space are curved
     // by subtracting strength * dist^2 from the view-space Y coordinate.
@@ -125,6 +157,18 @@ public:
     void setParallaxUseNormalAlpha(bool v) { m_parallaxUseNormalAlpha = v; }
     void setParallaxHasHeightMap(bool v) { m_parallaxHasHeightMap = v; }
 
+    // Texture bind-set changes in the last main pass: what per-material binding would have needed
+    // versus what is left once packed textures come from the shared arrays.
+    struct BatchStats {
+        std::uint32_t draws { 0 };
+        std::uint32_t bindSetChangesUnpacked { 0 };
+        std::uint32_t bindSetChangesPacked { 0 };
+    };
+
+    // Packs material textures into shared arrays whenever the instance set changes (i.e. on import).
+    void syncMaterialTextureArrays(const std::vector<MeshInstance>& instances);
+    [[nodiscard]] const BatchStats& batchStats() const { return m_lastBatchStats; }
+
     void setLightBinding(const LightBufferBinding& binding);
     [[nodiscard]] const LightBufferBinding& lightBinding() const { return m_lightBinding; }
 
@@ -146,6 +190,17 @@ private:
         glm::vec4 ambientColorStrength { 1.0f, 1.0f, 1.0f, 0.1f };
         glm::ivec4 frameFlags { 0, 0, 0, 0 };
         glm::vec4 envParams { 0.0f };
+        glm::vec4 probeGridOrigin { 0.0f }; // w: intensity, 0 without a grid
+        glm::vec4 probeGridInvSpacing { 0.0f }; // w: normal bias
+        glm::ivec4 probeGridResolution { 0 };
+    };
+
+    // std140 mirror of pbr.frag's ReflectionProbeBlock.
+    struct alignas(16) ReflectionProbeGPUData {
+        glm::ivec4 counts { 0 }; // x: probes, y: mip levels
+        std::array<glm::vec4, kMaxReflectionProbes> capturePosition {}; // w: cube layer
+        std::array<glm::vec4, kMaxReflectionProbes> boxMin {}; // w: blend distance
+        std::array<glm::vec4, kMaxReflectionProbes> boxMax {}; // w: 1 for box projection
     };
 
     struct alignas(16) MaterialGPUData {
@@ -166,6 +221,9 @@ private:
         glm::vec4 uvTransformEmissive { 0.0f, 0.0f, 1.0f, 1.0f };
         glm::vec4 uvRotations { 0.0f };
         glm::vec4 uvRotations2 { 0.0f };
+        // Packed (array << 16 | layer) references, -1 when the texture is bound on its own unit.
+        glm::ivec4 arrayRefs0 { -1, -1, -1, -1 }; // albedo, metallicRoughness, normal, ao
+        glm::ivec4 arrayRefs1 { -1, -1, -1, -1 }; // emissive
     };
 
     struct alignas(16) ObjectGPUData {
@@ -207,8 +265,12 @@ private:
         bool dirty { true };
     };
 
+    static constexpr std::size_t kBoundTextureSlots = kMaterialTextureUnitCount + 1; // + height
+
     struct BoundMaterialState {
         std::uint32_t materialIndex { std::numeric_limits<std::uint32_t>::max() };
+        std::array<GLuint, kBoundTextureSlots> unpackedTextures {};
+        std::array<GLuint, kBoundTextureSlots> standaloneTextures {};
         MaterialBindingInfo bindingInfo {};
         bool valid { false };
         bool usePBR { true };
@@ -249,6 +311,8 @@ private:
 
     bool m_enableDebugLogging { false };
     EnvironmentState m_environmentState {};
+    ProbeGridState m_probeGridState {};
+    ReflectionProbeState m_reflectionProbeState {};
     LightBufferBinding m_lightBinding {};
 
     // world curvature state
@@ -270,13 +334,19 @@ private:
 
     GLuint m_perFrameUBO { 0 };
     GLuint m_objectUBO { 0 };
+    GLuint m_reflectionProbeUBO { 0 };
     GLuint m_materialSSBO { 0 };
     std::size_t m_materialCapacity { 0 };
 
     PerFrameData m_frameData {};
+    ReflectionProbeGPUData m_reflectionProbeData {};
     ObjectGPUData m_objectData {};
     bool m_frameActive { false };
 
+    MaterialTextureArrays m_textureArrays;
+    BatchStats m_batchStats {};
+    BatchStats m_lastBatchStats {};
+
     std::vector<MaterialRecord> m_materialRecords;
     std::unordered_map<const RenderMaterial*, std::uint32_t> m_materialLookup;
     BoundMaterialState m_boundMaterialState {};
@@ -268,6 +268,13 @@ void SunPathController::update(double deltaSeconds)
     applyLight(m_lastSample, deltaSeconds);
 }
 
+std::optional<glm::vec3> SunPathController::sunDirection() const
+{
+    if (!m_enabled || !m_hasSample || glm::length2(m_lastSample.position) < kDirectionEpsilon)
+        return std::nullopt;
+    return glm::normalize(m_lastSample.position);
+}
+
 void SunPathController::ensurePath()
 {
     if (!m_pathDirty)
@@ -291,11 +298,12 @@ void SunPathController::ensureSunLight()
     if (m_lightManager == nullptr)
         return;
 
-    LightManager::Light* existing = m_lightManager->findLightByName("Sun");
+    const bool existed = m_lightManager->findLightIndex("Sun") >= 0;
     LightManager::LightType desiredType = (m_lightStyle == LightStyle::Spot) ? LightManager::LightType::Spot : LightManager::LightType::Point;
-    LightManager::Light& light = m_lightManager->ensureLight("Sun", desiredType);
+    const std::size_t index = m_lightManager->ensureLight("Sun", desiredType);
+    LightManager::Light light = m_lightManager->light(index);
 
-    if (existing == nullptr) {
+    if (!existed) {
         light.enabled = true;
         light.color = glm::vec3(1.0f, 0.95f, 0.85f);
         light.intensity = 5.0f;
@@ -315,7 +323,7 @@ void SunPathController::ensureSunLight()
     }
 
     light.enabled = m_enabled;
-    m_lightManager->markDirty();
+    m_lightManager->setLight(index, light);
 }
 
 void SunPathController::applyLight(const PathAnimator::SampleResult& sample, double deltaSeconds)
@@ -323,13 +331,15 @@ void SunPathController::applyLight(const PathAnimator::SampleResult& sample, dou
     if (m_lightManager == nullptr)
         return;
 
-    LightManager::Light* light = m_lightManager->findLightByName("Sun");
-    if (!light)
+    const int index = m_lightManager->findLightIndex("Sun");
+    if (index < 0)
         return;
 
-    light->position = sample.position;
+    // Only position/direction change per frame, so only the sun's GPU slot is re-uploaded.
+    const std::size_t lightIndex = static_cast<std::size_t>(index);
+    m_lightManager->setPosition(lightIndex, sample.position);
 
-    if (light->type == LightManager::LightType::Spot) {
+    if (m_lightManager->type(lightIndex) == LightManager::LightType::Spot) {
         const glm::vec3 targetDir = glm::normalize(-sample.tangent);
         if (!m_directionValid) {
             m_smoothedDirection = targetDir;
@@ -339,10 +349,8 @@ void SunPathController::applyLight(const PathAnimator::SampleResult& sample, dou
             m_smoothedDirection = slerpDirection(m_smoothedDirection, targetDir, smoothing);
         }
         if (glm::length2(m_smoothedDirection) > kDirectionEpsilon)
-            light->direction = glm::normalize(m_smoothedDirection);
+            m_lightManager->setDirection(lightIndex, glm::normalize(m_smoothedDirection));
     }
-
-    m_lightManager->markDirty();
 }
 
 void SunPathController::refreshAnimatorParameters()
@@ -7,6 +7,7 @@
 #include <glm/vec3.hpp>
 
 #include <cstdint>
+#include <optional>
 
 class LightManager;
 
@@ -64,6 +65,8 @@ public:
     [[nodiscard]] bool hasPath() const { return m_path.segmentCount() > 0; }
     [[nodiscard]] const PathAnimator::SampleResult& lastSample() const { return m_lastSample; }
     [[nodiscard]] std::uint64_t pathVersion() const { return m_pathVersion; }
+    // From the scene origin towards the sun light; empty while the controller is off.
+    [[nodiscard]] std::optional<glm::vec3> sunDirection() const;
 
 private:
     void rebuildPath();
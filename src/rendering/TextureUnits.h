@@ -15,6 +15,18 @@ constexpr GLuint Material_AO        = 3;
 constexpr GLuint Material_Emissive  = 4;
 constexpr GLuint Material_Count     = 5;
 
+// IrradianceProbeGrid's SH atlas (sampler3D), bound once per frame by ShadingStage.
+constexpr GLuint Probe_Irradiance = 6;
+// ReflectionProbes' cubemap array (samplerCubeArray), bound once per frame by ShadingStage.
+// 16..18 are only the shader's default bindings for the environment samplers.
+constexpr GLuint Probe_Reflection = 19;
+
+// Packed material texture arrays (see MaterialTextureArrays): bound once per
+// frame and shared by every material whose textures were packed at import.
+// 24..27 are taken by the environment, hence the split range.
+constexpr GLuint MaterialArray_Count = 8;
+constexpr GLuint MaterialArray_Units[MaterialArray_Count] = { 20, 21, 22, 23, 28, 29, 30, 31 };
+
 // Reserved environment / IBL units. These must remain bound to their
 // environment textures for the duration of the frame and must NOT be
 // modified by passes other than EnvironmentManager and ShadingStage.
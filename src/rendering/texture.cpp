@@ -2,67 +2,108 @@
 
 #include "rendering/texture.h"
 
+#include "rendering/PixelOps.h"
 #include "rendering/TextureUnits.h"
 
 #include <framework/disable_all_warnings.h>
 DISABLE_WARNINGS_PUSH()
 #include <stb/stb_image.h>
 DISABLE_WARNINGS_POP()
-#include <framework/image.h>
+#include <framework/file_provider.h>
+#include <framework/log.h>
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <cassert>
-#include <iostream>
 #include <string_view>
 
 #include <stdexcept>
 #include <utility>
 
+// GL_TEXTURE_MAX_ANISOTROPY is core since 4.6 (ARB/EXT_texture_filter_anisotropic before); the
+// loader is generated for core 4.5, which lacks the enums.
+#ifndef GL_TEXTURE_MAX_ANISOTROPY
+#define GL_TEXTURE_MAX_ANISOTROPY 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY 0x84FF
+#endif
+
 namespace {
 
-struct LoadedImage {
-    std::vector<uint8_t> pixels;
-    int width { 0 };
-    int height { 0 };
-    int channels { 0 };
-};
+[[nodiscard]] bool hasGlExtension(std::string_view name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const auto* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension && name == extension)
+            return true;
+    }
+    return false;
+}
 
-LoadedImage loadImageFromFile(const std::filesystem::path& path, int forceChannels = 0)
+// 1 when anisotropic filtering is unavailable.
+[[nodiscard]] float maxSupportedAnisotropy()
 {
-    Image cpuTexture { path, forceChannels };
-    LoadedImage img;
-    img.width = cpuTexture.width;
-    img.height = cpuTexture.height;
-    img.channels = cpuTexture.channels;
-    img.pixels.assign(cpuTexture.get_data(), cpuTexture.get_data() + (img.width * img.height * img.channels));
-    return img;
+    static const float maxAnisotropy = [] {
+        GLint major = 0;
+        GLint minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        const bool supported = major > 4 || (major == 4 && minor >= 6)
+            || hasGlExtension("GL_ARB_texture_filter_anisotropic") || hasGlExtension("GL_EXT_texture_filter_anisotropic");
+        GLfloat value = 1.0f;
+        if (supported)
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &value);
+        return std::max(value, 1.0f);
+    }();
+    return maxAnisotropy;
 }
 
-LoadedImage loadImageFromData(TextureData data)
+int finalChannelCount(int fileChannels, const TextureImportOptions& options)
 {
-    LoadedImage img;
-    if (data.compressed) {
-        int width = 0;
-        int height = 0;
-        int channels = 0;
-        stbi_uc* decoded = stbi_load_from_memory(data.bytes.data(), static_cast<int>(data.bytes.size()), &width, &height, &channels, 0);
-        if (!decoded)
-            throw std::runtime_error("Failed to decode compressed embedded texture");
-        img.width = width;
-        img.height = height;
-        img.channels = channels;
-        img.pixels.assign(decoded, decoded + (width * height * channels));
-        stbi_image_free(decoded);
-    } else {
-        img.width = data.width;
-        img.height = data.height;
-        img.channels = data.channels;
-        img.pixels = std::move(data.bytes);
-    }
-    if (img.width <= 0 || img.height <= 0 || img.channels <= 0)
-        throw std::runtime_error("Invalid embedded texture dimensions");
-    return img;
+    if (options.channels > 0)
+        return options.channels;
+    // Uploads are RGB or RGBA; grey images are widened rather than rejected.
+    return fileChannels == 1 ? 3 : fileChannels == 2 ? 4 : fileChannels;
+}
+
+// Converts `pixels` (already in their final layout) in place, row blocks in parallel.
+void applyImportOptions(TextureData& data, const TextureImportOptions& options, bool srgb)
+{
+    const bool renormalize = options.normalMap && data.channels >= 3;
+    const bool premultiply = options.premultiplyAlpha && data.channels == 4;
+    if (!renormalize && !premultiply)
+        return;
+    const auto rowBytes = static_cast<std::size_t>(data.width) * static_cast<std::size_t>(data.channels);
+    pixel_ops::forEachRowBlock(data.height, rowBytes, [&](int firstRow, int lastRow) {
+        uint8_t* rows = data.bytes.data() + static_cast<std::size_t>(firstRow) * rowBytes;
+        const auto pixels = static_cast<std::size_t>(lastRow - firstRow) * static_cast<std::size_t>(data.width);
+        if (renormalize)
+            pixel_ops::renormalizeNormals(rows, data.channels, pixels);
+        if (premultiply)
+            pixel_ops::premultiplyAlpha(rows, pixels, srgb);
+    });
+}
+
+// Moves raw (already decoded) pixels into the channel layout the import asks for.
+void convertRawPixels(TextureData& data, const TextureImportOptions& options)
+{
+    const int channels = finalChannelCount(data.channels, options);
+    if (channels == data.channels)
+        return;
+    std::vector<uint8_t> converted(static_cast<std::size_t>(data.width) * static_cast<std::size_t>(data.height) * static_cast<std::size_t>(channels));
+    const auto srcRow = static_cast<std::size_t>(data.width) * static_cast<std::size_t>(data.channels);
+    const auto dstRow = static_cast<std::size_t>(data.width) * static_cast<std::size_t>(channels);
+    pixel_ops::forEachRowBlock(data.height, dstRow, [&](int firstRow, int lastRow) {
+        pixel_ops::convertChannels(data.bytes.data() + static_cast<std::size_t>(firstRow) * srcRow, data.channels,
+            converted.data() + static_cast<std::size_t>(firstRow) * dstRow, channels,
+            static_cast<std::size_t>(lastRow - firstRow) * static_cast<std::size_t>(data.width));
+    });
+    data.bytes = std::move(converted);
+    data.channels = channels;
 }
 
 GLenum pickExternalFormat(int channels)
@@ -128,14 +169,13 @@ void uploadToGPU(int width, int height, int channels, bool srgb, GLuint texture,
     const GLenum externalFormat = pickExternalFormat(channels);
     const GLint internalFormat = pickInternalFormat(channels, srgb);
 
-    std::cout << fmt::format("[Texture Upload] size={}x{} channels={} srgb={} -> internalFormat={} externalFormat={}", width, height, channels, srgb ? "true" : "false", formatToString(internalFormat), formatToString(externalFormat))
-              << std::endl;
+    LOG_DEBUG(logging::Category::Texture, "[Texture Upload] size={}x{} channels={} srgb={} -> internalFormat={} externalFormat={}", width, height, channels, srgb, formatToString(internalFormat), formatToString(externalFormat));
 
     glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, externalFormat, GL_UNSIGNED_BYTE, pixels);
     GLint checkFormat = 0;
     glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &checkFormat);
     if (checkFormat != internalFormat) {
-        std::cerr << fmt::format("[Warning] Texture internal format mismatch! expected={} got={}", formatToString(internalFormat), formatToString(checkFormat)) << std::endl;
+        LOG_WARNING(logging::Category::Texture, "[Texture Upload] Internal format mismatch! expected={} got={}", formatToString(internalFormat), formatToString(checkFormat));
     }
     glGenerateMipmap(GL_TEXTURE_2D);
     glBindTexture(GL_TEXTURE_2D, 0);
@@ -143,39 +183,94 @@ void uploadToGPU(int width, int height, int channels, bool srgb, GLuint texture,
 
 }
 
+TextureData decodeTextureData(const uint8_t* bytes, std::size_t size, const TextureImportOptions& options, bool srgb)
+{
+    int width = 0;
+    int height = 0;
+    int fileChannels = 0;
+    // Decode at the file's own channel count; widening happens below, fused with the copy out of
+    // stb's buffer, instead of in stb's scalar converter.
+    stbi_uc* decoded = stbi_load_from_memory(bytes, static_cast<int>(size), &width, &height, &fileChannels, 0);
+    if (!decoded)
+        throw ImageLoadingException(fmt::format("Failed to decode image: {}", stbi_failure_reason()));
+
+    TextureData data;
+    data.width = width;
+    data.height = height;
+    data.channels = finalChannelCount(fileChannels, options);
+    const auto srcRow = static_cast<std::size_t>(width) * static_cast<std::size_t>(fileChannels);
+    const auto dstRow = static_cast<std::size_t>(width) * static_cast<std::size_t>(data.channels);
+    data.bytes.resize(dstRow * static_cast<std::size_t>(height));
+    pixel_ops::forEachRowBlock(height, dstRow, [&](int firstRow, int lastRow) {
+        pixel_ops::convertChannels(decoded + static_cast<std::size_t>(firstRow) * srcRow, fileChannels,
+            data.bytes.data() + static_cast<std::size_t>(firstRow) * dstRow, data.channels,
+            static_cast<std::size_t>(lastRow - firstRow) * static_cast<std::size_t>(width));
+    });
+    stbi_image_free(decoded);
+
+    applyImportOptions(data, options, srgb);
+    return data;
+}
+
+TextureData loadTextureData(const std::filesystem::path& path, const TextureImportOptions& options, bool srgb)
+{
+    const std::optional<FileData> file = readFileData(path);
+    if (!file)
+        throw ImageLoadingException(fmt::format("Texture file {} does not exist", path.string()));
+    try {
+        return decodeTextureData(file->bytes(), file->size(), options, srgb);
+    } catch (const ImageLoadingException& ex) {
+        throw ImageLoadingException(fmt::format("{} ({})", ex.what(), path.string()));
+    }
+}
+
 bool Texture::s_forcePerDrawUpload = false;
 
 Texture::Texture(std::filesystem::path filePath, bool srgb, TextureSamplerSettings sampler, int forceChannels)
+    : Texture(filePath, srgb, sampler, TextureImportOptions { forceChannels })
+{
+}
+
+Texture::Texture(const std::filesystem::path& filePath, bool srgb, TextureSamplerSettings sampler, const TextureImportOptions& import)
     : m_isSrgb(srgb)
 {
-    LoadedImage img = loadImageFromFile(filePath, forceChannels);
-    m_cpuWidth = img.width;
-    m_cpuHeight = img.height;
-    m_cpuChannels = img.channels;
-    m_cpuPixels = std::move(img.pixels);
+    adoptPixels(loadTextureData(filePath, import, srgb));
     glGenTextures(1, &m_texture);
     uploadFromCpuMemory();
     createSampler(sampler);
 }
 
-Texture::Texture(TextureData data, bool srgb, TextureSamplerSettings sampler)
+Texture::Texture(TextureData data, bool srgb, TextureSamplerSettings sampler, const TextureImportOptions& import)
     : m_isSrgb(srgb)
 {
-    LoadedImage img = loadImageFromData(std::move(data));
-    m_cpuWidth = img.width;
-    m_cpuHeight = img.height;
-    m_cpuChannels = img.channels;
-    m_cpuPixels = std::move(img.pixels);
+    if (data.compressed) {
+        data = decodeTextureData(data.bytes.data(), data.bytes.size(), import, srgb);
+    } else {
+        if (data.width <= 0 || data.height <= 0 || data.channels <= 0)
+            throw ImageLoadingException("Invalid embedded texture dimensions");
+        convertRawPixels(data, import);
+        applyImportOptions(data, import, srgb);
+    }
+    adoptPixels(std::move(data));
     glGenTextures(1, &m_texture);
     uploadFromCpuMemory();
     createSampler(sampler);
 }
 
+void Texture::adoptPixels(TextureData&& data)
+{
+    m_cpuWidth = data.width;
+    m_cpuHeight = data.height;
+    m_cpuChannels = data.channels;
+    m_cpuPixels = std::move(data.bytes);
+}
+
 Texture::Texture(Texture&& other) noexcept
     : m_texture(other.m_texture)
     , m_sampler(other.m_sampler)
     , m_target(other.m_target)
     , m_isSrgb(other.m_isSrgb)
+    , m_samplerSettings(other.m_samplerSettings)
     , m_cpuWidth(other.m_cpuWidth)
     , m_cpuHeight(other.m_cpuHeight)
     , m_cpuChannels(other.m_cpuChannels)
@@ -232,6 +327,7 @@ Texture& Texture::operator=(Texture&& other) noexcept
     m_sampler = other.m_sampler;
     m_target = other.m_target;
     m_isSrgb = other.m_isSrgb;
+    m_samplerSettings = other.m_samplerSettings;
     m_cpuWidth = other.m_cpuWidth;
     m_cpuHeight = other.m_cpuHeight;
     m_cpuChannels = other.m_cpuChannels;
@@ -253,11 +349,22 @@ void Texture::createSampler(const TextureSamplerSettings& sampler)
     if (m_sampler != INVALID)
         glDeleteSamplers(1, &m_sampler);
 
+    m_samplerSettings = sampler;
     glGenSamplers(1, &m_sampler);
-    glSamplerParameteri(m_sampler, GL_TEXTURE_WRAP_S, sampler.wrapS);
-    glSamplerParameteri(m_sampler, GL_TEXTURE_WRAP_T, sampler.wrapT);
-    glSamplerParameteri(m_sampler, GL_TEXTURE_MIN_FILTER, sampler.minFilter);
-    glSamplerParameteri(m_sampler, GL_TEXTURE_MAG_FILTER, sampler.magFilter);
+    applySamplerSettings(m_sampler, sampler);
+}
+
+void applySamplerSettings(GLuint sampler, const TextureSamplerSettings& settings)
+{
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, settings.wrapS);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, settings.wrapT);
+    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, settings.minFilter);
+    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, settings.magFilter);
+    if (settings.maxAnisotropy > 1.0f) {
+        const float supported = maxSupportedAnisotropy();
+        if (supported > 1.0f)
+            glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY, std::min(settings.maxAnisotropy, supported));
+    }
 }
 
 void Texture::setForcePerDrawUpload(bool enabled)
@@ -282,6 +389,17 @@ void Texture::refreshGpuIfNeeded() const
     uploadFromCpuMemory();
 }
 
+void Texture::releaseStandalone()
+{
+    if (m_sampler != INVALID)
+        glDeleteSamplers(1, &m_sampler);
+    if (m_texture != INVALID)
+        glDeleteTextures(1, &m_texture);
+    m_sampler = INVALID;
+    m_texture = INVALID;
+    std::vector<uint8_t>().swap(m_cpuPixels);
+}
+
 void Texture::uploadFromCpuMemory() const
 {
     if (m_cpuPixels.empty() || m_cpuWidth <= 0 || m_cpuHeight <= 0 || m_cpuChannels <= 0)
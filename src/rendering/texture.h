@@ -4,9 +4,12 @@
 DISABLE_WARNINGS_PUSH()
 #include <glm/vec3.hpp>
 DISABLE_WARNINGS_POP()
+#include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <filesystem>
 #include <framework/opengl_includes.h>
+#include <stdexcept>
 #include <vector>
 
 struct TextureData {
@@ -22,16 +25,34 @@ struct TextureSamplerSettings {
     GLint wrapT { GL_REPEAT };
     GLint minFilter { GL_LINEAR_MIPMAP_LINEAR };
     GLint magFilter { GL_LINEAR };
+    float maxAnisotropy { 1.0f }; // 1 = isotropic; clamped to what the driver supports
 };
 
+// Writes the settings into a sampler object; anisotropy is skipped when the driver lacks it.
+void applySamplerSettings(GLuint sampler, const TextureSamplerSettings& settings);
+
 struct ImageLoadingException : public std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
+// Post-decode processing applied while the pixels are converted into their final layout.
+struct TextureImportOptions {
+    int channels { 0 }; // 0: keep the file's channels, widening grey to RGB and grey+alpha to RGBA
+    bool normalMap { false }; // renormalise xyz (compression and resampling shorten the vectors)
+    bool premultiplyAlpha { false };
+};
+
+// Decodes an encoded image (PNG, JPEG, ...) read through the file provider into 8-bit pixels with
+// the requested channel count; `srgb` makes premultiplication happen in linear space. Throws
+// ImageLoadingException.
+[[nodiscard]] TextureData loadTextureData(const std::filesystem::path& path, const TextureImportOptions& options = {}, bool srgb = false);
+[[nodiscard]] TextureData decodeTextureData(const uint8_t* bytes, std::size_t size, const TextureImportOptions& options = {}, bool srgb = false);
+
 class Texture {
 public:
     explicit Texture(std::filesystem::path filePath, bool srgb = false, TextureSamplerSettings sampler = {}, int forceChannels = 0);
-    Texture(TextureData data, bool srgb = false, TextureSamplerSettings sampler = {});
+    Texture(const std::filesystem::path& filePath, bool srgb, TextureSamplerSettings sampler, const TextureImportOptions& import);
+    Texture(TextureData data, bool srgb = false, TextureSamplerSettings sampler = {}, const TextureImportOptions& import = {});
     Texture(const Texture&) = delete;
     Texture(Texture&&) noexcept;
     void bind() const;
@@ -49,12 +70,22 @@ public:
     static bool forcePerDrawUpload();
 
     void refreshGpuIfNeeded() const;
+    // Frees the GL texture, its sampler and the CPU pixels once the texture lives in a material
+    // texture array; it can no longer be bound on its own afterwards.
+    void releaseStandalone();
     [[nodiscard]] bool hasCpuPixels() const { return !m_cpuPixels.empty(); }
+    [[nodiscard]] const std::vector<uint8_t>& cpuPixels() const { return m_cpuPixels; }
+    [[nodiscard]] int cpuWidth() const { return m_cpuWidth; }
+    [[nodiscard]] int cpuHeight() const { return m_cpuHeight; }
+    [[nodiscard]] int cpuChannels() const { return m_cpuChannels; }
+    [[nodiscard]] bool isSrgb() const { return m_isSrgb; }
+    [[nodiscard]] const TextureSamplerSettings& samplerSettings() const { return m_samplerSettings; }
 
 private:
     static constexpr GLuint INVALID = 0xFFFFFFFF;
     void createSampler(const TextureSamplerSettings& sampler);
     void uploadFromCpuMemory() const;
+    void adoptPixels(TextureData&& data);
 
     static bool s_forcePerDrawUpload;
 
@@ -62,6 +93,7 @@ private:
     GLuint m_sampler { INVALID };
     GLenum m_target { GL_TEXTURE_2D };
     bool m_isSrgb { false };
+    TextureSamplerSettings m_samplerSettings {};
     int m_cpuWidth { 0 };
     int m_cpuHeight { 0 };
     int m_cpuChannels { 0 };
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: MIT
+#include "scene/AssimpFileProvider.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+class FileDataStream : public Assimp::IOStream {
+public:
+    explicit FileDataStream(FileData data)
+        : m_data(std::move(data))
+    {
+    }
+
+    size_t Read(void* buffer, size_t size, size_t count) override
+    {
+        if (size == 0)
+            return 0;
+        const size_t available = (m_data.size() - m_position) / size;
+        const size_t items = std::min(count, available);
+        std::memcpy(buffer, m_data.data() + m_position, items * size);
+        m_position += items * size;
+        return items;
+    }
+
+    size_t Write(const void*, size_t, size_t) override { return 0; }
+
+    aiReturn Seek(size_t offset, aiOrigin origin) override
+    {
+        size_t target = 0;
+        switch (origin) {
+        case aiOrigin_SET:
+            target = offset;
+            break;
+        case aiOrigin_CUR:
+            target = m_position + offset;
+            break;
+        case aiOrigin_END:
+            if (offset > m_data.size())
+                return aiReturn_FAILURE;
+            target = m_data.size() - offset;
+            break;
+        default:
+            return aiReturn_FAILURE;
+        }
+        if (target > m_data.size())
+            return aiReturn_FAILURE;
+        m_position = target;
+        return aiReturn_SUCCESS;
+    }
+
+    size_t Tell() const override { return m_position; }
+    size_t FileSize() const override { return m_data.size(); }
+    void Flush() override { }
+
+private:
+    FileData m_data;
+    size_t m_position { 0 };
+};
+
+} // namespace
+
+bool AssimpFileProvider::Exists(const char* file) const
+{
+    return fileExists(file);
+}
+
+char AssimpFileProvider::getOsSeparator() const
+{
+    return '/';
+}
+
+Assimp::IOStream* AssimpFileProvider::Open(const char* file, const char* mode)
+{
+    if (std::string_view(mode).find_first_of("wa+") != std::string_view::npos)
+        return nullptr;
+    std::optional<FileData> data = readFileData(file);
+    if (!data)
+        return nullptr;
+    if (m_openedFiles) {
+        const std::filesystem::path opened = std::filesystem::path(file).lexically_normal();
+        if (std::find(m_openedFiles->begin(), m_openedFiles->end(), opened) == m_openedFiles->end())
+            m_openedFiles->push_back(opened);
+    }
+    return new FileDataStream(std::move(*data));
+}
+
+void AssimpFileProvider::Close(Assimp::IOStream* stream)
+{
+    delete stream;
+}
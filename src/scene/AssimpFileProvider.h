@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
+DISABLE_WARNINGS_POP()
+#include <framework/file_provider.h>
+
+#include <filesystem>
+#include <vector>
+
+// Routes Assimp's file access (the scene plus every buffer and image it references) through the
+// active FileProvider, so packed scenes import straight from the archive mapping. Read-only.
+// When given `openedFiles`, every file successfully opened is appended to it once.
+class AssimpFileProvider : public Assimp::IOSystem {
+public:
+    explicit AssimpFileProvider(std::vector<std::filesystem::path>* openedFiles = nullptr)
+        : m_openedFiles(openedFiles)
+    {
+    }
+
+    bool Exists(const char* file) const override;
+    char getOsSeparator() const override;
+    Assimp::IOStream* Open(const char* file, const char* mode = "rb") override;
+    void Close(Assimp::IOStream* stream) override;
+
+private:
+    std::vector<std::filesystem::path>* m_openedFiles { nullptr };
+};
@@ -2,6 +2,9 @@
 
 #include "scene/ModelLoader.h"
 
+#include "rendering/PixelOps.h"
+#include "scene/AssimpFileProvider.h"
+
 #include <framework/disable_all_warnings.h>
 DISABLE_WARNINGS_PUSH()
 #include <assimp/Importer.hpp>
@@ -53,7 +56,9 @@ glm::mat4 aiToGlm(const aiMatrix4x4& matrix)
 
 bool ModelLoader::loadModel(const std::string& path)
 {
+    m_sourceFiles.clear();
     Assimp::Importer importer;
+    importer.SetIOHandler(new AssimpFileProvider(&m_sourceFiles)); // the importer takes ownership
     m_lastError.clear();
     const aiScene* scene = importer.ReadFile(path.c_str(),
         aiProcess_Triangulate |
@@ -77,6 +82,16 @@ bool ModelLoader::loadModel(const std::string& path)
         m_lastError = "Scene contains no mesh data.";
         return false;
     }
+
+    // External textures are read later by the mesh manager, not by Assimp.
+    for (const MeshData& mesh : m_meshes) {
+        const MaterialTextures& textures = mesh.textures;
+        for (const MaterialTextureReference* reference : { &textures.baseColor, &textures.metallicRoughness, &textures.normal,
+                 &textures.occlusion, &textures.emissive, &textures.height }) {
+            if (reference->path && std::find(m_sourceFiles.begin(), m_sourceFiles.end(), *reference->path) == m_sourceFiles.end())
+                m_sourceFiles.push_back(*reference->path);
+        }
+    }
     return true;
 }
 
@@ -90,6 +105,11 @@ const std::string& ModelLoader::getLastError() const
     return m_lastError;
 }
 
+const std::vector<std::filesystem::path>& ModelLoader::getSourceFiles() const
+{
+    return m_sourceFiles;
+}
+
 void ModelLoader::processNode(aiNode* node, const aiScene* scene, const glm::mat4& parentTransform)
 {
     const glm::mat4 nodeTransform = parentTransform * aiToGlm(node->mTransformation);
@@ -117,7 +137,7 @@ std::optional<std::filesystem::path> resolveTexturePath(const aiString& aiPath,
     if (texPath.is_relative())
         texPath = directory / texPath;
 
-    if (!std::filesystem::exists(texPath))
+    if (!fileExists(texPath))
         return std::nullopt;
     return texPath;
 }
@@ -169,17 +189,15 @@ TextureData makeEmbeddedTextureData(const aiTexture* texture)
         data.width = static_cast<int>(texture->mWidth);
         data.height = static_cast<int>(texture->mHeight);
         data.channels = 4;
-        data.bytes.resize(data.width * data.height * data.channels);
-        for (int y = 0; y < data.height; ++y) {
-            for (int x = 0; x < data.width; ++x) {
-                const aiTexel& texel = texture->pcData[y * data.width + x];
-                const int idx = (y * data.width + x) * data.channels;
-                data.bytes[idx + 0] = texel.r;
-                data.bytes[idx + 1] = texel.g;
-                data.bytes[idx + 2] = texel.b;
-                data.bytes[idx + 3] = texel.a;
-            }
-        }
+        data.bytes.resize(static_cast<std::size_t>(data.width) * static_cast<std::size_t>(data.height) * static_cast<std::size_t>(data.channels));
+        // aiTexel is laid out b, g, r, a.
+        static_assert(sizeof(aiTexel) == 4);
+        const auto* texels = reinterpret_cast<const uint8_t*>(texture->pcData);
+        const std::size_t rowBytes = static_cast<std::size_t>(data.width) * 4;
+        pixel_ops::forEachRowBlock(data.height, rowBytes, [&](int firstRow, int lastRow) {
+            const std::size_t offset = static_cast<std::size_t>(firstRow) * rowBytes;
+            pixel_ops::swizzleBgraToRgba(texels + offset, data.bytes.data() + offset, static_cast<std::size_t>(lastRow - firstRow) * static_cast<std::size_t>(data.width));
+        });
     }
     return data;
 }
@@ -38,6 +38,8 @@ public:
     bool loadModel(const std::string& path);
     [[nodiscard]] const std::vector<MeshData>& getMeshes() const;
     [[nodiscard]] const std::string& getLastError() const;
+    // Every file the last successful load depends on: the scene, its buffers and its textures.
+    [[nodiscard]] const std::vector<std::filesystem::path>& getSourceFiles() const;
 
 private:
     void processNode(aiNode* node, const aiScene* scene, const glm::mat4& parentTransform);
@@ -48,4 +50,5 @@ private:
     std::vector<MeshData> m_meshes;
     std::filesystem::path m_directory;
     std::string m_lastError;
+    std::vector<std::filesystem::path> m_sourceFiles;
 };
@@ -0,0 +1,637 @@
+// SPDX-License-Identifier: MIT
+#include "scene/WorldPartition.h"
+
+#include "mesh/MeshManager.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// Spill file: header, the vertex and index buffers exactly as uploaded, then the item's CPU-side
+// data: collision positions and triangles, the meshlet arrays in MeshletData order and the baked AO.
+struct SpillHeader {
+    char magic[4] { 'D', 'S', 'P', 'L' };
+    std::uint32_t version { 2 };
+    std::uint32_t vertexCount { 0 };
+    std::uint32_t triangleCount { 0 };
+    std::uint32_t cpuPositionCount { 0 };
+    std::uint32_t cpuTriangleCount { 0 };
+    std::uint32_t meshletCount { 0 }; // 0: the item has no meshlets
+    std::uint32_t meshletTriangleCount { 0 };
+    std::uint32_t occlusionCount { 0 };
+    std::uint32_t reserved { 0 };
+};
+static_assert(sizeof(SpillHeader) == 40);
+
+constexpr std::size_t kMeshletFloatArrays = 8;
+constexpr std::size_t kMeshletBytesPerMeshlet = kMeshletFloatArrays * sizeof(float) + 2 * sizeof(std::uint32_t);
+
+constexpr double kBytesPerMB = 1024.0 * 1024.0;
+
+std::vector<std::byte> readWholeFile(const std::filesystem::path& path)
+{
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+    if (!stream)
+        return {};
+    std::vector<std::byte> data(static_cast<std::size_t>(stream.tellg()));
+    stream.seekg(0);
+    if (!stream.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())))
+        return {};
+    return data;
+}
+
+template <typename T>
+void writeArray(std::ofstream& stream, const std::vector<T>& values)
+{
+    stream.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+// Every array in a spill is a multiple of 4 bytes, so a 4-byte aligned cursor stays aligned.
+template <typename T>
+std::vector<T> readArray(const std::byte*& cursor, std::size_t count)
+{
+    const auto* first = reinterpret_cast<const T*>(cursor);
+    cursor += count * sizeof(T);
+    return std::vector<T>(first, first + count);
+}
+
+int chebyshevDistance(const glm::ivec2& a, const glm::ivec2& b)
+{
+    return std::max(std::abs(a.x - b.x), std::abs(a.y - b.y));
+}
+
+} // namespace
+
+WorldPartition::WorldPartition(std::filesystem::path spillDirectory)
+    : m_spillDirectory(std::move(spillDirectory))
+{
+    // Spills are only meaningful for the instances of this run.
+    std::error_code error;
+    std::filesystem::remove_all(m_spillDirectory, error);
+}
+
+WorldPartition::~WorldPartition()
+{
+    for (auto& [coord, cell] : m_cells)
+        cancelLoad(cell);
+    std::error_code error;
+    std::filesystem::remove_all(m_spillDirectory, error);
+}
+
+void WorldPartition::setMetricsRegistry(MetricsRegistry* registry)
+{
+    if (!registry) {
+        m_residentCellsGauge = {};
+        m_residentMBGauge = {};
+        m_loadingCellsGauge = {};
+        m_latencyHistogram = {};
+        return;
+    }
+    m_residentCellsGauge = registry->gauge("daedalus_stream_resident_cells", "World partition cells with all geometry resident");
+    m_residentMBGauge = registry->gauge("daedalus_stream_resident_mb", "Streamed vertex and index buffers resident on the GPU");
+    m_loadingCellsGauge = registry->gauge("daedalus_stream_loading_cells", "World partition cells being read back");
+    m_latencyHistogram = registry->histogram("daedalus_stream_latency_ms", "Time from requesting a cell until all its geometry is resident",
+        { 5.0, 10.0, 25.0, 50.0, 100.0, 250.0, 500.0, 1000.0 });
+}
+
+void WorldPartition::setSettings(const Settings& settings)
+{
+    if (settings.cellSize != m_settings.cellSize)
+        m_rebucket = true;
+    m_settings = settings;
+    m_settings.cellSize = std::max(m_settings.cellSize, 1.0f);
+    m_settings.loadRadiusCells = std::max(m_settings.loadRadiusCells, 0);
+    m_settings.unloadRadiusCells = std::max(m_settings.unloadRadiusCells, m_settings.loadRadiusCells);
+}
+
+glm::ivec2 WorldPartition::cellOf(const glm::vec3& position) const
+{
+    return glm::ivec2(static_cast<int>(std::floor(position.x / m_settings.cellSize)),
+        static_cast<int>(std::floor(position.z / m_settings.cellSize)));
+}
+
+MeshInstance* WorldPartition::findInstance(std::uint64_t id) const
+{
+    const auto it = m_instanceLookup.find(id);
+    return it != m_instanceLookup.end() ? it->second : nullptr;
+}
+
+void WorldPartition::rebuildLookup(MeshManager& meshes)
+{
+    m_instanceLookup.clear();
+    for (MeshInstance& instance : meshes.instances()) {
+        if (instance.streamable())
+            m_instanceLookup.emplace(instance.id(), &instance);
+    }
+}
+
+void WorldPartition::syncInstances()
+{
+    for (const auto& [id, instance] : m_instanceLookup) {
+        auto [it, inserted] = m_tracked.try_emplace(id);
+        TrackedInstance& tracked = it->second;
+        tracked.seenFrame = m_frame;
+        const std::vector<MeshDrawItem>& items = instance->drawItems();
+        if (!inserted && tracked.transformVersion == instance->transformVersion() && tracked.itemCount == items.size())
+            continue;
+
+        // New or moved: bucket every item by the centre of its world-space bounds.
+        for (std::size_t i = 0; i < tracked.itemCells.size(); ++i)
+            removeItemFromCell(tracked.itemCells[i], { id, static_cast<std::uint32_t>(i) });
+        tracked.itemCells.clear();
+
+        const glm::mat4& transform = instance->transform();
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            const MeshDrawItem& item = items[i];
+            const glm::vec3 localCenter = 0.5f * (item.bounds.min + item.bounds.max);
+            const glm::vec3 worldCenter = glm::vec3(transform * item.nodeTransform * glm::vec4(localCenter, 1.0f));
+            const glm::ivec2 coord = cellOf(worldCenter);
+
+            CellItem entry;
+            entry.key = { id, static_cast<std::uint32_t>(i) };
+            if (item.geometry.resident()) {
+                entry.bytes = item.geometry.geometryBytes();
+            } else if (const auto spill = m_spills.find(entry.key); spill != m_spills.end()) {
+                entry.bytes = spill->second.bytes;
+            }
+
+            Cell& cell = m_cells[coord];
+            cell.items.push_back(entry);
+            cell.bytes += entry.bytes;
+            if (item.geometry.resident())
+                cell.evicted = false;
+            else
+                cell.resident = false;
+            tracked.itemCells.push_back(coord);
+        }
+        tracked.transformVersion = instance->transformVersion();
+        tracked.itemCount = items.size();
+    }
+
+    // Removed instances: forget their items and spills.
+    for (auto it = m_tracked.begin(); it != m_tracked.end();) {
+        if (it->second.seenFrame == m_frame) {
+            ++it;
+            continue;
+        }
+        for (std::size_t i = 0; i < it->second.itemCells.size(); ++i) {
+            const ItemKey key { it->first, static_cast<std::uint32_t>(i) };
+            removeItemFromCell(it->second.itemCells[i], key);
+            if (const auto spill = m_spills.find(key); spill != m_spills.end()) {
+                std::error_code error;
+                std::filesystem::remove(spill->second.path, error);
+                m_spilledBytes -= spill->second.bytes;
+                m_spills.erase(spill);
+            }
+        }
+        it = m_tracked.erase(it);
+    }
+}
+
+void WorldPartition::removeItemFromCell(const glm::ivec2& coord, const ItemKey& key)
+{
+    const auto cellIt = m_cells.find(coord);
+    if (cellIt == m_cells.end())
+        return;
+    Cell& cell = cellIt->second;
+    const auto item = std::find_if(cell.items.begin(), cell.items.end(), [&](const CellItem& entry) { return entry.key == key; });
+    if (item == cell.items.end())
+        return;
+    cell.bytes -= item->bytes;
+    cell.items.erase(item);
+    // A load in flight was planned for the old item set; the next update re-requests if still wanted.
+    cancelLoad(cell);
+    if (cell.items.empty())
+        m_cells.erase(cellIt);
+}
+
+void WorldPartition::cancelLoad(Cell& cell)
+{
+    ++cell.generation;
+    if (!cell.loading)
+        return;
+    if (m_io) {
+        for (const AsyncIoService::RequestId id : cell.reads)
+            m_io->cancel(id);
+    }
+    cell.reads.clear();
+    cell.pendingItems = 0;
+    cell.loading = false;
+    ++m_stats.cancelledLoads;
+}
+
+void WorldPartition::update(MeshManager& meshes, const Focus& focus)
+{
+    if (!m_settings.enabled || m_rebucket) {
+        if (!m_cells.empty()) {
+            restoreAll(meshes);
+            m_cells.clear();
+            m_tracked.clear();
+        }
+        m_rebucket = false;
+        if (!m_settings.enabled) {
+            refreshStats();
+            return;
+        }
+    }
+
+    ++m_frame;
+    rebuildLookup(meshes);
+    syncInstances();
+    processUploads();
+
+    std::vector<glm::ivec2> focusCells { cellOf(focus.position) };
+    // A teleport shows up as a huge velocity; only follow plausible motion.
+    const glm::vec3 ahead = focus.velocity * m_settings.velocityLookaheadSeconds;
+    const float maxAhead = m_settings.cellSize * static_cast<float>(m_settings.loadRadiusCells + m_settings.unloadRadiusCells + 1);
+    if (glm::length(ahead) <= maxAhead)
+        focusCells.push_back(cellOf(focus.position + ahead));
+    if (focus.pathLookahead)
+        focusCells.push_back(cellOf(*focus.pathLookahead));
+
+    // Load ring around each focus point; the camera's own ring is needed now, lookahead rings soon.
+    const int loadRadius = m_settings.loadRadiusCells;
+    for (std::size_t f = 0; f < focusCells.size(); ++f) {
+        const ReadPriority priority = f == 0 ? ReadPriority::Visible : ReadPriority::Prefetch;
+        for (int dz = -loadRadius; dz <= loadRadius; ++dz) {
+            for (int dx = -loadRadius; dx <= loadRadius; ++dx) {
+                const glm::ivec2 coord = focusCells[f] + glm::ivec2(dx, dz);
+                const auto it = m_cells.find(coord);
+                if (it != m_cells.end() && !it->second.resident && !it->second.loading)
+                    requestCell(coord, it->second, priority);
+            }
+        }
+    }
+
+    // Evict beyond the unload ring of every focus point.
+    std::size_t budget = m_settings.evictionBudgetBytes;
+    bool evictedAny = false;
+    for (auto& [coord, cell] : m_cells) {
+        if (cell.evicted)
+            continue;
+        const bool keep = std::any_of(focusCells.begin(), focusCells.end(), [&](const glm::ivec2& focusCell) {
+            return chebyshevDistance(coord, focusCell) <= m_settings.unloadRadiusCells;
+        });
+        if (keep)
+            continue;
+        if (evictedAny && budget == 0)
+            break;
+        evictCell(cell, budget);
+        evictedAny = true;
+    }
+
+    refreshStats();
+}
+
+void WorldPartition::requestCell(const glm::ivec2& coord, Cell& cell, ReadPriority priority)
+{
+    cell.loading = true;
+    cell.evicted = false;
+    cell.requested = std::chrono::steady_clock::now();
+    cell.pendingItems = 0;
+    cell.reads.clear();
+    const std::uint64_t generation = cell.generation;
+    ++m_stats.cellLoads;
+
+    for (const CellItem& entry : cell.items) {
+        MeshInstance* instance = findInstance(entry.key.instance);
+        if (!instance || entry.key.item >= instance->drawItems().size())
+            continue;
+        if (instance->drawItems()[entry.key.item].geometry.resident())
+            continue;
+        const auto spill = m_spills.find(entry.key);
+        if (spill == m_spills.end())
+            continue;
+
+        ++cell.pendingItems;
+        if (m_io) {
+            AsyncIoService::ReadRequest request;
+            request.path = spill->second.path;
+            request.priority = priority;
+            request.callback = [this, coord, generation, key = entry.key](AsyncIoService::Completion& completion) {
+                if (completion.status != AsyncIoService::Status::Ok) {
+                    if (completion.status == AsyncIoService::Status::Failed)
+                        std::cerr << "[Streaming] Failed to read " << completion.path << " (errno " << completion.error << ")" << std::endl;
+                    finishItem(coord, generation);
+                    return;
+                }
+                PendingUpload upload;
+                upload.cell = coord;
+                upload.generation = generation;
+                upload.item = key;
+                upload.data = completion.data;
+                upload.buffer = std::move(completion.buffer);
+                m_uploads.push_back(std::move(upload));
+            };
+            cell.reads.push_back(m_io->submit(std::move(request)));
+        } else {
+            PendingUpload upload;
+            upload.cell = coord;
+            upload.generation = generation;
+            upload.item = entry.key;
+            upload.ownedData = readWholeFile(spill->second.path);
+            upload.data = upload.ownedData;
+            m_uploads.push_back(std::move(upload));
+        }
+    }
+
+    if (cell.pendingItems == 0) {
+        cell.loading = false;
+        cell.resident = true;
+    }
+}
+
+void WorldPartition::evictCell(Cell& cell, std::size_t& budget)
+{
+    cancelLoad(cell);
+    for (const CellItem& entry : cell.items) {
+        MeshInstance* instance = findInstance(entry.key.instance);
+        if (!instance || entry.key.item >= instance->drawItems().size())
+            continue;
+        MeshDrawItem& item = instance->drawItems()[entry.key.item];
+        if (!item.geometry.resident())
+            continue;
+        // Meshes are immutable once uploaded, so a spill is only rewritten when the AO changed.
+        if (!spillCurrent(entry.key, item) && !spillItem(entry.key, *instance))
+            continue;
+        item.geometry.release();
+        // Other holders (a collision build in flight, a shared source mesh) keep their copy alive.
+        item.cpuGeometry.reset();
+        item.meshlets.reset();
+        item.vertexOcclusion.reset();
+        budget -= std::min(budget, entry.bytes);
+    }
+    cell.resident = false;
+    cell.evicted = true;
+    ++m_stats.cellEvictions;
+}
+
+bool WorldPartition::spillCurrent(const ItemKey& key, const MeshDrawItem& item) const
+{
+    const auto spill = m_spills.find(key);
+    if (spill == m_spills.end())
+        return false;
+    return spill->second.hasOcclusion == (item.vertexOcclusion != nullptr)
+        && spill->second.occlusion.lock() == item.vertexOcclusion;
+}
+
+bool WorldPartition::spillItem(const ItemKey& key, const MeshInstance& instance)
+{
+    const MeshDrawItem& item = instance.drawItems()[key.item];
+    const GPUMesh& geometry = item.geometry;
+    std::vector<Vertex> vertices;
+    std::vector<glm::uvec3> triangles;
+    geometry.download(vertices, triangles);
+
+    std::error_code error;
+    std::filesystem::create_directories(m_spillDirectory, error);
+    const std::filesystem::path path = m_spillDirectory / (std::to_string(key.instance) + "_" + std::to_string(key.item) + ".bin");
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+
+    SpillHeader header;
+    header.vertexCount = static_cast<std::uint32_t>(vertices.size());
+    header.triangleCount = static_cast<std::uint32_t>(triangles.size());
+    if (item.cpuGeometry) {
+        header.cpuPositionCount = static_cast<std::uint32_t>(item.cpuGeometry->positions.size());
+        header.cpuTriangleCount = static_cast<std::uint32_t>(item.cpuGeometry->triangles.size());
+    }
+    if (item.meshlets) {
+        header.meshletCount = item.meshlets->meshletCount;
+        header.meshletTriangleCount = item.meshlets->triangleCount;
+    }
+    if (item.vertexOcclusion)
+        header.occlusionCount = static_cast<std::uint32_t>(item.vertexOcclusion->size());
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeArray(stream, vertices);
+    writeArray(stream, triangles);
+    if (item.cpuGeometry) {
+        writeArray(stream, item.cpuGeometry->positions);
+        writeArray(stream, item.cpuGeometry->triangles);
+    }
+    if (const MeshletData* meshlets = item.meshlets.get()) {
+        for (const std::vector<float>* values : { &meshlets->centerX, &meshlets->centerY, &meshlets->centerZ, &meshlets->radius,
+                 &meshlets->coneAxisX, &meshlets->coneAxisY, &meshlets->coneAxisZ, &meshlets->coneCutoff })
+            writeArray(stream, *values);
+        writeArray(stream, meshlets->firstTriangle);
+        writeArray(stream, meshlets->triangleCounts);
+    }
+    if (item.vertexOcclusion)
+        writeArray(stream, *item.vertexOcclusion);
+    if (!stream) {
+        std::cerr << "[Streaming] Cannot spill geometry to " << path << "; keeping it resident" << std::endl;
+        return false;
+    }
+
+    Spill spill;
+    spill.path = path;
+    spill.bytes = geometry.geometryBytes();
+    spill.occlusion = item.vertexOcclusion;
+    spill.hasOcclusion = item.vertexOcclusion != nullptr;
+    if (const auto previous = m_spills.find(key); previous != m_spills.end())
+        m_spilledBytes -= previous->second.bytes;
+    m_spilledBytes += spill.bytes;
+    m_spills.insert_or_assign(key, std::move(spill));
+    return true;
+}
+
+bool WorldPartition::uploadItem(MeshInstance& instance, const ItemKey& key, std::span<const std::byte> data)
+{
+    SpillHeader header;
+    if (data.size() < sizeof(header))
+        return false;
+    std::memcpy(&header, data.data(), sizeof(header));
+    const std::size_t vertexBytes = static_cast<std::size_t>(header.vertexCount) * sizeof(Vertex);
+    const std::size_t indexBytes = static_cast<std::size_t>(header.triangleCount) * sizeof(glm::uvec3);
+    const std::size_t cpuBytes = static_cast<std::size_t>(header.cpuPositionCount) * sizeof(glm::vec3)
+        + static_cast<std::size_t>(header.cpuTriangleCount) * sizeof(glm::uvec3);
+    const std::size_t meshletBytes = static_cast<std::size_t>(header.meshletCount) * kMeshletBytesPerMeshlet;
+    const std::size_t occlusionBytes = static_cast<std::size_t>(header.occlusionCount) * sizeof(glm::vec4);
+    if (std::memcmp(header.magic, "DSPL", 4) != 0 || header.version != SpillHeader {}.version
+        || data.size() < sizeof(header) + vertexBytes + indexBytes + cpuBytes + meshletBytes + occlusionBytes)
+        return false;
+
+    // The header keeps every array 4-byte aligned, which is all Vertex, uvec3 and vec4 need.
+    const std::byte* cursor = data.data() + sizeof(header);
+    const auto* vertices = reinterpret_cast<const Vertex*>(cursor);
+    const auto* triangles = reinterpret_cast<const glm::uvec3*>(cursor + vertexBytes);
+    cursor += vertexBytes + indexBytes;
+    MeshDrawItem& drawItem = instance.drawItems()[key.item];
+    drawItem.geometry.restore({ vertices, header.vertexCount }, { triangles, header.triangleCount });
+
+    if (header.cpuPositionCount > 0 || header.cpuTriangleCount > 0) {
+        auto geometry = std::make_shared<MeshGeometryData>();
+        geometry->positions = readArray<glm::vec3>(cursor, header.cpuPositionCount);
+        geometry->triangles = readArray<glm::uvec3>(cursor, header.cpuTriangleCount);
+        if (!drawItem.cpuGeometry)
+            drawItem.cpuGeometry = std::move(geometry);
+    }
+    if (header.meshletCount > 0) {
+        auto meshlets = std::make_shared<MeshletData>();
+        meshlets->meshletCount = header.meshletCount;
+        meshlets->triangleCount = header.meshletTriangleCount;
+        for (std::vector<float>* values : { &meshlets->centerX, &meshlets->centerY, &meshlets->centerZ, &meshlets->radius,
+                 &meshlets->coneAxisX, &meshlets->coneAxisY, &meshlets->coneAxisZ, &meshlets->coneCutoff })
+            *values = readArray<float>(cursor, header.meshletCount);
+        meshlets->firstTriangle = readArray<std::uint32_t>(cursor, header.meshletCount);
+        meshlets->triangleCounts = readArray<std::uint32_t>(cursor, header.meshletCount);
+        if (!drawItem.meshlets)
+            drawItem.meshlets = std::move(meshlets);
+    }
+    // AO applied while the item was out wins over the spilled copy.
+    if (header.occlusionCount > 0 && !drawItem.vertexOcclusion) {
+        auto occlusion = std::make_shared<const std::vector<glm::vec4>>(readArray<glm::vec4>(cursor, header.occlusionCount));
+        if (const auto spill = m_spills.find(key); spill != m_spills.end())
+            spill->second.occlusion = occlusion;
+        drawItem.vertexOcclusion = std::move(occlusion);
+    }
+    if (drawItem.vertexOcclusion)
+        drawItem.geometry.setVertexOcclusion(*drawItem.vertexOcclusion);
+    return true;
+}
+
+void WorldPartition::processUploads()
+{
+    std::size_t uploaded = 0;
+    while (!m_uploads.empty()) {
+        PendingUpload& upload = m_uploads.front();
+        const auto cell = m_cells.find(upload.cell);
+        if (cell != m_cells.end() && cell->second.generation == upload.generation) {
+            // At least one item per frame so a single oversized item still gets through.
+            if (uploaded > 0 && uploaded + upload.data.size() > m_settings.uploadBudgetBytes)
+                break;
+            MeshInstance* instance = findInstance(upload.item.instance);
+            if (instance && upload.item.item < instance->drawItems().size() && !instance->drawItems()[upload.item.item].geometry.resident()) {
+                if (uploadItem(*instance, upload.item, upload.data))
+                    uploaded += upload.data.size();
+                else
+                    std::cerr << "[Streaming] Corrupt spill for instance " << upload.item.instance << " item " << upload.item.item << std::endl;
+            }
+            finishItem(upload.cell, upload.generation);
+        }
+        m_uploads.pop_front();
+    }
+    m_stats.uploadedBytesLastFrame = uploaded;
+}
+
+void WorldPartition::finishItem(const glm::ivec2& coord, std::uint64_t generation)
+{
+    const auto it = m_cells.find(coord);
+    if (it == m_cells.end() || it->second.generation != generation || !it->second.loading)
+        return;
+    Cell& cell = it->second;
+    if (cell.pendingItems > 0)
+        --cell.pendingItems;
+    if (cell.pendingItems > 0)
+        return;
+
+    cell.loading = false;
+    cell.resident = true;
+    cell.reads.clear();
+    const float latencyMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - cell.requested).count();
+    m_stats.lastLatencyMs = latencyMs;
+    m_stats.maxLatencyMs = std::max(m_stats.maxLatencyMs, latencyMs);
+    m_latencyTotalMs += static_cast<double>(latencyMs);
+    ++m_latencySamples;
+    m_stats.avgLatencyMs = static_cast<float>(m_latencyTotalMs / static_cast<double>(m_latencySamples));
+    m_latencyHistogram.observe(latencyMs);
+}
+
+void WorldPartition::restoreAll(MeshManager& meshes)
+{
+    rebuildLookup(meshes);
+    m_uploads.clear();
+    for (auto& [coord, cell] : m_cells) {
+        cancelLoad(cell);
+        for (const CellItem& entry : cell.items) {
+            MeshInstance* instance = findInstance(entry.key.instance);
+            if (!instance || entry.key.item >= instance->drawItems().size() || instance->drawItems()[entry.key.item].geometry.resident())
+                continue;
+            const auto spill = m_spills.find(entry.key);
+            if (spill == m_spills.end())
+                continue;
+            const std::vector<std::byte> data = readWholeFile(spill->second.path);
+            if (!uploadItem(*instance, entry.key, data))
+                std::cerr << "[Streaming] Cannot restore " << spill->second.path << std::endl;
+        }
+        cell.resident = true;
+        cell.evicted = false;
+    }
+}
+
+void WorldPartition::refreshStats()
+{
+    // Per cell, not per item, so the cost follows the partition rather than the scene.
+    Stats& stats = m_stats;
+    stats.cells = m_cells.size();
+    stats.residentCells = 0;
+    stats.loadingCells = 0;
+    stats.items = 0;
+    stats.residentItems = 0;
+    stats.totalBytes = 0;
+    stats.residentBytes = 0;
+    for (const auto& [coord, cell] : m_cells) {
+        stats.items += cell.items.size();
+        stats.totalBytes += cell.bytes;
+        if (cell.resident) {
+            ++stats.residentCells;
+            stats.residentItems += cell.items.size();
+            stats.residentBytes += cell.bytes;
+        }
+        if (cell.loading)
+            ++stats.loadingCells;
+    }
+    stats.spilledBytes = m_spilledBytes;
+
+    m_residentCellsGauge.set(static_cast<double>(stats.residentCells));
+    m_residentMBGauge.set(static_cast<double>(stats.residentBytes) / kBytesPerMB);
+    m_loadingCellsGauge.set(static_cast<double>(stats.loadingCells));
+}
+
+void WorldPartition::drawImGuiPanel()
+{
+    Settings settings = m_settings;
+    bool changed = ImGui::Checkbox("Enable Streaming", &settings.enabled);
+    changed |= ImGui::SliderFloat("Cell Size", &settings.cellSize, 8.0f, 512.0f, "%.0f");
+    changed |= ImGui::SliderInt("Load Radius (cells)", &settings.loadRadiusCells, 0, 8);
+    changed |= ImGui::SliderInt("Unload Radius (cells)", &settings.unloadRadiusCells, 0, 10);
+    changed |= ImGui::SliderFloat("Velocity Lookahead (s)", &settings.velocityLookaheadSeconds, 0.0f, 5.0f, "%.1f");
+    changed |= ImGui::SliderFloat("Path Lookahead (s)", &settings.pathLookaheadSeconds, 0.0f, 10.0f, "%.1f");
+    int uploadBudgetMB = static_cast<int>(settings.uploadBudgetBytes >> 20);
+    if (ImGui::SliderInt("Upload Budget (MiB/frame)", &uploadBudgetMB, 1, 128)) {
+        settings.uploadBudgetBytes = static_cast<std::size_t>(uploadBudgetMB) << 20;
+        changed = true;
+    }
+    if (changed)
+        setSettings(settings);
+
+    const Stats& stats = m_stats;
+    ImGui::Text("Cells: %zu resident / %zu loading / %zu total", stats.residentCells, stats.loadingCells, stats.cells);
+    ImGui::Text("Items: %zu / %zu resident", stats.residentItems, stats.items);
+    ImGui::Text("Geometry: %.1f / %.1f MiB resident | Spilled: %.1f MiB",
+        static_cast<double>(stats.residentBytes) / kBytesPerMB,
+        static_cast<double>(stats.totalBytes) / kBytesPerMB,
+        static_cast<double>(stats.spilledBytes) / kBytesPerMB);
+    ImGui::Text("Loads: %llu | Evictions: %llu | Cancelled: %llu | Uploaded last frame: %.2f MiB",
+        static_cast<unsigned long long>(stats.cellLoads),
+        static_cast<unsigned long long>(stats.cellEvictions),
+        static_cast<unsigned long long>(stats.cancelledLoads),
+        static_cast<double>(stats.uploadedBytesLastFrame) / kBytesPerMB);
+    ImGui::Text("Latency: last %.1f ms | avg %.1f ms | max %.1f ms",
+        static_cast<double>(stats.lastLatencyMs),
+        static_cast<double>(stats.avgLatencyMs),
+        static_cast<double>(stats.maxLatencyMs));
+}
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "io/AsyncIoService.h"
+#include "metrics/MetricsRegistry.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+DISABLE_WARNINGS_POP()
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+class MeshInstance;
+class MeshManager;
+struct MeshDrawItem;
+
+// Streams the geometry of large scenes by cell, like ProceduralFloor's chunk ring. Draw items of
+// streamable instances are bucketed into square cells on the XZ plane by their world-space centre.
+// Cells within `loadRadiusCells` of the camera, of where its velocity carries it and of where a
+// playing camera path will be shortly are made resident; cells are only evicted beyond
+// `unloadRadiusCells`, so a camera hovering on a border does not thrash. An evicted item's vertex/index
+// buffers and its CPU-side data (collision geometry, meshlets, baked AO) are spilled to disk, dropped
+// from memory and read back through AsyncIoService; uploads and evictions are spread over frames by
+// byte budgets. Materials and textures stay resident.
+class WorldPartition {
+public:
+    struct Settings {
+        bool enabled { true };
+        float cellSize { 64.0f };
+        int loadRadiusCells { 2 };
+        int unloadRadiusCells { 3 }; // clamped to >= loadRadiusCells; the gap is the hysteresis band
+        float velocityLookaheadSeconds { 1.5f };
+        float pathLookaheadSeconds { 3.0f };
+        std::size_t uploadBudgetBytes { 16u << 20 }; // per frame
+        std::size_t evictionBudgetBytes { 32u << 20 }; // per frame; at least one cell is always evicted
+    };
+
+    // Where content should be resident this frame.
+    struct Focus {
+        glm::vec3 position { 0.0f };
+        glm::vec3 velocity { 0.0f }; // world units per second
+        std::optional<glm::vec3> pathLookahead; // playing camera path, `pathLookaheadSeconds` ahead
+    };
+
+    struct Stats {
+        std::size_t cells { 0 };
+        std::size_t residentCells { 0 }; // every item resident
+        std::size_t loadingCells { 0 };
+        std::size_t items { 0 };
+        std::size_t residentItems { 0 };
+        std::size_t totalBytes { 0 };
+        std::size_t residentBytes { 0 };
+        std::size_t spilledBytes { 0 };
+        std::size_t uploadedBytesLastFrame { 0 };
+        std::uint64_t cellLoads { 0 };
+        std::uint64_t cellEvictions { 0 };
+        std::uint64_t cancelledLoads { 0 };
+        float lastLatencyMs { 0.0f }; // load requested -> every item resident
+        float avgLatencyMs { 0.0f };
+        float maxLatencyMs { 0.0f };
+    };
+
+    explicit WorldPartition(std::filesystem::path spillDirectory);
+    ~WorldPartition();
+
+    WorldPartition(const WorldPartition&) = delete;
+    WorldPartition& operator=(const WorldPartition&) = delete;
+
+    // Without an I/O service spilled geometry is read back synchronously.
+    void setAsyncIo(AsyncIoService* io) { m_io = io; }
+    void setMetricsRegistry(MetricsRegistry* registry);
+
+    void setSettings(const Settings& settings);
+    [[nodiscard]] const Settings& settings() const { return m_settings; }
+
+    // Once per frame before rendering: re-buckets added, moved and removed instances, requests and
+    // evicts cells around `focus`, and uploads returning geometry within the budget.
+    void update(MeshManager& meshes, const Focus& focus);
+    // Brings every evicted item back (blocking), e.g. when streaming is switched off.
+    void restoreAll(MeshManager& meshes);
+
+    [[nodiscard]] Stats stats() const { return m_stats; }
+    void drawImGuiPanel();
+
+private:
+    struct ItemKey {
+        std::uint64_t instance { 0 };
+        std::uint32_t item { 0 };
+        [[nodiscard]] bool operator==(const ItemKey&) const = default;
+    };
+    struct ItemKeyHash {
+        std::size_t operator()(const ItemKey& key) const noexcept { return std::hash<std::uint64_t>()(key.instance * 0x9E3779B97F4A7C15ull ^ key.item); }
+    };
+    struct CellKeyHash {
+        std::size_t operator()(const glm::ivec2& key) const noexcept { return std::hash<int>()(key.x * 73856093 ^ key.y * 19349663); }
+    };
+
+    struct CellItem {
+        ItemKey key;
+        std::size_t bytes { 0 }; // vertex + index buffers
+    };
+
+    struct Cell {
+        std::vector<CellItem> items;
+        std::size_t bytes { 0 };
+        std::vector<AsyncIoService::RequestId> reads; // in flight for this cell
+        std::size_t pendingItems { 0 }; // reads or uploads outstanding
+        std::chrono::steady_clock::time_point requested;
+        std::uint64_t generation { 0 }; // bumped on eviction; completions of older loads are dropped
+        bool resident { true }; // every item's geometry is on the GPU
+        bool loading { false };
+        bool evicted { false }; // no item's geometry is on the GPU
+    };
+
+    struct TrackedInstance {
+        std::uint64_t transformVersion { 0 };
+        std::size_t itemCount { 0 };
+        std::vector<glm::ivec2> itemCells;
+        std::uint64_t seenFrame { 0 };
+    };
+
+    struct Spill {
+        std::filesystem::path path;
+        std::size_t bytes { 0 }; // vertex + index buffers
+        // The AO written with the spill; a re-bake or a clear while resident forces a rewrite.
+        std::weak_ptr<const std::vector<glm::vec4>> occlusion;
+        bool hasOcclusion { false };
+    };
+
+    struct PendingUpload {
+        glm::ivec2 cell { 0 };
+        std::uint64_t generation { 0 };
+        ItemKey item;
+        IoBuffer buffer;
+        std::vector<std::byte> ownedData; // synchronous fallback
+        std::span<const std::byte> data;
+    };
+
+    [[nodiscard]] glm::ivec2 cellOf(const glm::vec3& position) const;
+    [[nodiscard]] MeshInstance* findInstance(std::uint64_t id) const;
+
+    void rebuildLookup(MeshManager& meshes);
+    void syncInstances();
+    void removeItemFromCell(const glm::ivec2& coord, const ItemKey& key);
+    void cancelLoad(Cell& cell);
+    void requestCell(const glm::ivec2& coord, Cell& cell, ReadPriority priority);
+    void evictCell(Cell& cell, std::size_t& budget);
+    [[nodiscard]] bool spillCurrent(const ItemKey& key, const MeshDrawItem& item) const;
+    [[nodiscard]] bool spillItem(const ItemKey& key, const MeshInstance& instance);
+    void processUploads();
+    void finishItem(const glm::ivec2& coord, std::uint64_t generation);
+    [[nodiscard]] bool uploadItem(MeshInstance& instance, const ItemKey& key, std::span<const std::byte> data);
+    void refreshStats();
+
+    Settings m_settings;
+    std::filesystem::path m_spillDirectory;
+    AsyncIoService* m_io { nullptr };
+
+    std::unordered_map<glm::ivec2, Cell, CellKeyHash> m_cells;
+    std::unordered_map<std::uint64_t, TrackedInstance> m_tracked;
+    std::unordered_map<std::uint64_t, MeshInstance*> m_instanceLookup; // rebuilt every update
+    std::unordered_map<ItemKey, Spill, ItemKeyHash> m_spills;
+    std::deque<PendingUpload> m_uploads;
+    std::size_t m_spilledBytes { 0 };
+    std::uint64_t m_frame { 0 };
+    bool m_rebucket { false }; // cell size changed
+
+    std::uint64_t m_latencySamples { 0 };
+    double m_latencyTotalMs { 0.0 };
+    Stats m_stats;
+
+    MetricsRegistry::Gauge m_residentCellsGauge;
+    MetricsRegistry::Gauge m_residentMBGauge;
+    MetricsRegistry::Gauge m_loadingCellsGauge;
+    MetricsRegistry::Histogram m_latencyHistogram;
+};
@@ -3,6 +3,7 @@
 #include "rendering/TextureUnits.h"
 
 #include "rendering/RenderStats.h"
+#include <framework/file_provider.h>
 #include <framework/disable_all_warnings.h>
 DISABLE_WARNINGS_PUSH()
 #include <GLFW/glfw3.h>
@@ -35,10 +36,10 @@ inline bool hasCurrentContext()
 
 std::string readFile(const std::filesystem::path& path)
 {
-    std::ifstream file(path, std::ios::binary);
+    const std::optional<FileData> file = readFileData(path);
     if (!file)
         throw std::runtime_error("Failed to open shader file: " + path.string());
-    return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    return std::string(file->text());
 }
 
 GLuint compileComputeProgram(const std::filesystem::path& shaderPath)
@@ -256,6 +257,8 @@ void ProceduralFloor::allocateResources()
     builder.addStage(GL_FRAGMENT_SHADER, std::filesystem::path(RESOURCE_ROOT "shaders/terrain.frag"));
     m_drawShader = builder.build();
 
+    m_vegetation.initialize(m_maxActiveLayers, m_settings.chunkSize, m_settings.chunkResolution, m_settings.seed, m_heightTexture, m_heightSampler);
+
     m_freeLayers.clear();
     m_freeLayers.reserve(m_maxActiveLayers);
     for (int i = 0; i < m_maxActiveLayers; ++i)
@@ -276,6 +279,7 @@ void ProceduralFloor::destroyResources()
         m_heightTexture = 0;
         m_computeProgram = 0;
         m_drawShader = Shader();
+        m_vegetation.release();
         m_chunks.clear();
         m_freeLayers.clear();
         m_resourcesReady = false;
@@ -289,6 +293,7 @@ void ProceduralFloor::destroyResources()
     if (m_heightTexture) { glDeleteTextures(1, &m_heightTexture); m_heightTexture = 0; }
     if (m_computeProgram) { glDeleteProgram(m_computeProgram); m_computeProgram = 0; }
     if (m_heightSampler) { glDeleteSamplers(1, &m_heightSampler); m_heightSampler = 0; }
+    m_vegetation.release();
 
     m_drawShader = Shader();
     m_chunks.clear();
@@ -346,6 +351,7 @@ void ProceduralFloor::activateChunk(const glm::ivec2& coord)
             return a.second.lastTouched < b.second.lastTouched;
         });
         if (toRemove != m_chunks.end()) {
+            m_vegetation.releaseChunk(toRemove->second.textureLayer);
             m_freeLayers.push_back(toRemove->second.textureLayer);
             m_chunks.erase(toRemove);
         }
@@ -365,6 +371,7 @@ void ProceduralFloor::activateChunk(const glm::ivec2& coord)
     dispatchChunkGeneration(chunk);
     readbackChunkHeights(chunk);
     chunk.gpuReady = true;
+    m_vegetation.activateChunk(chunk.textureLayer, chunk.coord, chunk.origin);
 
     m_chunks.emplace(coord, std::move(chunk));
 }
@@ -387,6 +394,7 @@ void ProceduralFloor::recycleInactiveChunks()
         auto it = m_chunks.find(coord);
         if (it == m_chunks.end())
             continue;
+        m_vegetation.releaseChunk(it->second.textureLayer);
         m_freeLayers.push_back(it->second.textureLayer);
         m_chunks.erase(it);
     }
@@ -561,6 +569,23 @@ void ProceduralFloor::draw(const glm::mat4& view, const glm::mat4& proj, const g
         const std::uint64_t totalTriangles = trianglesPerInstance * static_cast<std::uint64_t>(instanceCount);
         stats->addDraw(1, totalTriangles);
     }
+
+    VegetationScatter::DrawParams vegetationParams;
+    vegetationParams.view = view;
+    vegetationParams.projection = proj;
+    vegetationParams.lightPos = lightPos;
+    vegetationParams.lightColor = lightColor;
+    vegetationParams.ambientColor = ambientColor;
+    vegetationParams.ambientStrength = ambientStrength;
+    vegetationParams.cameraPos = cameraPos;
+    vegetationParams.fogEnabled = m_fogEnabled;
+    vegetationParams.fogColor = m_fogColor;
+    vegetationParams.fogDensity = m_fogDensity;
+    vegetationParams.fogGradient = m_fogGradient;
+    vegetationParams.worldCurvatureEnabled = m_worldCurvatureEnabled;
+    vegetationParams.worldCurvatureStrength = m_worldCurvatureStrength;
+    vegetationParams.time = static_cast<float>(glfwGetTime());
+    m_vegetation.draw(vegetationParams, stats);
 }
 
 void ProceduralFloor::drawImGui()
@@ -592,4 +617,7 @@ void ProceduralFloor::drawImGuiPanel()
 
     ImGui::Separator();
     ImGui::Text("Active chunks: %zu / %d", m_chunks.size(), m_maxActiveLayers);
+
+    if (ImGui::CollapsingHeader("Vegetation"))
+        m_vegetation.drawImGuiPanel();
 }
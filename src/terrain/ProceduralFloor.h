@@ -10,6 +10,8 @@
 #include <framework/opengl_includes.h>
 #include <framework/shader.h>
 
+#include "terrain/VegetationScatter.h"
+
 struct RenderStats;
 
 struct ChunkKeyHash {
@@ -81,6 +83,9 @@ private:
     Shader m_drawShader;
     bool m_resourcesReady = false;
 
+    // grass scattered on the active chunks, one slot per height texture layer
+    VegetationScatter m_vegetation;
+
     // world curvature state (applied in the terrain vertex shader if enabled)
     bool m_worldCurvatureEnabled { false };
     float m_worldCurvatureStrength { 0.001f };
@@ -0,0 +1,525 @@
+// SPDX-License-Identifier: MIT
+#include "terrain/VegetationScatter.h"
+
+#include "rendering/RenderStats.h"
+#include "rendering/TextureUnits.h"
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <GLFW/glfw3.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/vec4.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+
+namespace {
+
+constexpr GLuint kInstanceBinding = 1;
+constexpr GLuint kActiveSlotBinding = 3;
+constexpr GLuint kVisibleBinding = 4;
+constexpr GLuint kCommandBinding = 5;
+constexpr GLuint kScatterGroupSize = 8;
+constexpr GLuint kCullGroupSize = 64;
+constexpr int kLodCount = 2;
+
+struct GpuInstance {
+    glm::vec4 positionScale;
+    glm::vec4 params;
+};
+static_assert(sizeof(GpuInstance) == 32, "must match Instance in the vegetation shaders");
+
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+struct BladeVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+constexpr float kBladeHalfWidth = 0.035f;
+constexpr float kBladeLean = 0.18f;
+
+// One blade in unit space (y in [0,1]): `segments` tapered quads closed by a tip triangle, leaning
+// forward along its normal so the tuft reads as curved grass rather than flat cards.
+void appendBlade(std::vector<BladeVertex>& vertices, std::vector<GLuint>& indices, float angle, int segments)
+{
+    const glm::vec3 side(std::cos(angle), 0.0f, std::sin(angle));
+    const glm::vec3 facing(-side.z, 0.0f, side.x);
+    const GLuint base = static_cast<GLuint>(vertices.size());
+
+    for (int s = 0; s < segments; ++s) {
+        const float t = static_cast<float>(s) / static_cast<float>(segments);
+        const float halfWidth = kBladeHalfWidth * (1.0f - t);
+        const glm::vec3 center = glm::vec3(0.0f, t, 0.0f) + facing * (kBladeLean * t * t);
+        const glm::vec3 normal = glm::normalize(facing - glm::vec3(0.0f, 2.0f * kBladeLean * t, 0.0f));
+        vertices.push_back({ center - side * halfWidth, normal });
+        vertices.push_back({ center + side * halfWidth, normal });
+    }
+    const glm::vec3 tipNormal = glm::normalize(facing - glm::vec3(0.0f, 2.0f * kBladeLean, 0.0f));
+    vertices.push_back({ glm::vec3(0.0f, 1.0f, 0.0f) + facing * kBladeLean, tipNormal });
+
+    for (int s = 0; s + 1 < segments; ++s) {
+        const GLuint i0 = base + static_cast<GLuint>(2 * s);
+        indices.insert(indices.end(), { i0, i0 + 1, i0 + 2, i0 + 1, i0 + 3, i0 + 2 });
+    }
+    const GLuint last = base + static_cast<GLuint>(2 * (segments - 1));
+    indices.insert(indices.end(), { last, last + 1, last + 2 });
+}
+
+[[nodiscard]] std::uint32_t chunkSeed(const glm::ivec2& coord, std::uint32_t seed)
+{
+    std::uint32_t h = seed ^ 0x9e3779b9U;
+    h ^= static_cast<std::uint32_t>(coord.x) * 0x27d4eb2dU;
+    h = (h << 16) ^ (h >> 16);
+    h ^= static_cast<std::uint32_t>(coord.y) * 0x165667b1U;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    return h;
+}
+
+void setUniform(const Shader& shader, const char* name, float value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform1f(loc, value);
+}
+
+void setUniform(const Shader& shader, const char* name, int value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform1i(loc, value);
+}
+
+void setUniform(const Shader& shader, const char* name, std::uint32_t value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform1ui(loc, value);
+}
+
+void setUniform(const Shader& shader, const char* name, const glm::vec3& value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniform3fv(loc, 1, glm::value_ptr(value));
+}
+
+void setUniform(const Shader& shader, const char* name, const glm::mat4& value)
+{
+    if (const GLint loc = shader.getUniformLocation(name); loc >= 0)
+        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+} // namespace
+
+VegetationScatter::~VegetationScatter()
+{
+    release();
+}
+
+void VegetationScatter::initialize(int slotCount, float chunkSize, int chunkResolution, std::uint32_t terrainSeed, GLuint heightTexture, GLuint heightSampler)
+{
+    release();
+    if (slotCount <= 0 || heightTexture == 0)
+        return;
+
+    m_slotCount = slotCount;
+    m_chunkSize = chunkSize;
+    m_chunkResolution = chunkResolution;
+    m_terrainSeed = terrainSeed;
+    m_heightTexture = heightTexture;
+    m_heightSampler = heightSampler;
+    m_slots.assign(static_cast<std::size_t>(slotCount), Slot {});
+    m_activeSlots.clear();
+    m_activeSlotsDirty = true;
+
+    try {
+        ShaderBuilder scatterBuilder;
+        scatterBuilder.addStage(GL_COMPUTE_SHADER, RESOURCE_ROOT "shaders/vegetation_scatter.comp");
+        m_scatterProgram = scatterBuilder.build();
+
+        ShaderBuilder cullBuilder;
+        cullBuilder.addStage(GL_COMPUTE_SHADER, RESOURCE_ROOT "shaders/vegetation_cull.comp");
+        m_cullProgram = cullBuilder.build();
+
+        ShaderBuilder drawBuilder;
+        drawBuilder.addStage(GL_VERTEX_SHADER, RESOURCE_ROOT "shaders/vegetation.vert");
+        drawBuilder.addStage(GL_FRAGMENT_SHADER, RESOURCE_ROOT "shaders/vegetation.frag");
+        m_drawShader = drawBuilder.build();
+    } catch (const std::exception& e) {
+        std::cerr << "[Vegetation] Disabled, shaders failed to build: " << e.what() << std::endl;
+        release();
+        return;
+    }
+
+    createBladeMeshes();
+    createInstanceBuffers();
+    m_ready = true;
+}
+
+void VegetationScatter::release()
+{
+    if (glfwGetCurrentContext() != nullptr) {
+        destroyInstanceBuffers();
+        if (m_ebo) { glDeleteBuffers(1, &m_ebo); }
+        if (m_vbo) { glDeleteBuffers(1, &m_vbo); }
+        if (m_vao) { glDeleteVertexArrays(1, &m_vao); }
+    }
+    m_instanceBuffer = 0;
+    m_activeSlotBuffer = 0;
+    m_visibleBuffer = 0;
+    m_commandBuffer = 0;
+    m_ebo = 0;
+    m_vbo = 0;
+    m_vao = 0;
+    m_scatterProgram = Shader();
+    m_cullProgram = Shader();
+    m_drawShader = Shader();
+    m_slots.clear();
+    m_activeSlots.clear();
+    m_heightTexture = 0;
+    m_heightSampler = 0;
+    m_slotCount = 0;
+    m_ready = false;
+}
+
+std::uint32_t VegetationScatter::cellsPerChunk() const
+{
+    return static_cast<std::uint32_t>(m_settings.cellsPerSide * m_settings.cellsPerSide);
+}
+
+void VegetationScatter::createInstanceBuffers()
+{
+    const GLsizeiptr capacity = static_cast<GLsizeiptr>(m_slotCount) * cellsPerChunk();
+
+    glGenBuffers(1, &m_instanceBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * static_cast<GLsizeiptr>(sizeof(GpuInstance)), nullptr, GL_DYNAMIC_DRAW);
+
+    glGenBuffers(1, &m_activeSlotBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_activeSlotBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(m_slotCount) * static_cast<GLsizeiptr>(sizeof(std::uint32_t)), nullptr, GL_DYNAMIC_DRAW);
+
+    // One visible list per LOD, each large enough to hold every instance.
+    glGenBuffers(1, &m_visibleBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_visibleBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, kLodCount * capacity * static_cast<GLsizeiptr>(sizeof(GLuint)), nullptr, GL_DYNAMIC_DRAW);
+
+    glGenBuffers(1, &m_commandBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, kLodCount * static_cast<GLsizeiptr>(sizeof(DrawElementsIndirectCommand)), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void VegetationScatter::destroyInstanceBuffers()
+{
+    if (m_instanceBuffer) { glDeleteBuffers(1, &m_instanceBuffer); m_instanceBuffer = 0; }
+    if (m_activeSlotBuffer) { glDeleteBuffers(1, &m_activeSlotBuffer); m_activeSlotBuffer = 0; }
+    if (m_visibleBuffer) { glDeleteBuffers(1, &m_visibleBuffer); m_visibleBuffer = 0; }
+    if (m_commandBuffer) { glDeleteBuffers(1, &m_commandBuffer); m_commandBuffer = 0; }
+}
+
+void VegetationScatter::createBladeMeshes()
+{
+    std::vector<BladeVertex> vertices;
+    std::vector<GLuint> indices;
+
+    // LOD0: three curved blades of three segments; LOD1: the same tuft as three single triangles.
+    constexpr std::array<int, kLodCount> kSegments { 3, 1 };
+    constexpr std::array<float, 3> kAngles { 0.0f, 2.1f, 4.2f };
+    for (int lod = 0; lod < kLodCount; ++lod) {
+        std::vector<BladeVertex> lodVertices;
+        std::vector<GLuint> lodIndices;
+        for (float angle : kAngles)
+            appendBlade(lodVertices, lodIndices, angle, kSegments[static_cast<std::size_t>(lod)]);
+
+        m_lods[lod].firstIndex = static_cast<GLuint>(indices.size());
+        m_lods[lod].indexCount = static_cast<GLuint>(lodIndices.size());
+        m_lods[lod].baseVertex = static_cast<GLint>(vertices.size());
+        vertices.insert(vertices.end(), lodVertices.begin(), lodVertices.end());
+        indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+    }
+
+    glGenVertexArrays(1, &m_vao);
+    glBindVertexArray(m_vao);
+
+    glGenBuffers(1, &m_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vertices.size() * sizeof(BladeVertex)), vertices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BladeVertex), reinterpret_cast<void*>(offsetof(BladeVertex, position)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BladeVertex), reinterpret_cast<void*>(offsetof(BladeVertex, normal)));
+
+    glGenBuffers(1, &m_ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint)), indices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VegetationScatter::activateChunk(int slot, const glm::ivec2& coord, const glm::vec3& origin)
+{
+    if (!m_ready || slot < 0 || slot >= m_slotCount)
+        return;
+
+    Slot& entry = m_slots[static_cast<std::size_t>(slot)];
+    entry.active = true;
+    entry.coord = coord;
+    entry.origin = origin;
+    m_activeSlotsDirty = true;
+    scatterSlot(slot);
+}
+
+void VegetationScatter::releaseChunk(int slot)
+{
+    if (slot < 0 || slot >= static_cast<int>(m_slots.size()))
+        return;
+    // The slot's instances stay in the buffer until the next chunk overwrites them; dropping it from
+    // the active list is enough to stop drawing them.
+    m_slots[static_cast<std::size_t>(slot)].active = false;
+    m_activeSlotsDirty = true;
+}
+
+void VegetationScatter::scatterSlot(int slot)
+{
+    const Slot& entry = m_slots[static_cast<std::size_t>(slot)];
+
+    m_scatterProgram.bind();
+    setUniform(m_scatterProgram, "uLayer", slot);
+    setUniform(m_scatterProgram, "uChunkOrigin", entry.origin);
+    setUniform(m_scatterProgram, "uChunkSize", m_chunkSize);
+    setUniform(m_scatterProgram, "uResolution", m_chunkResolution);
+    setUniform(m_scatterProgram, "uCellsPerSide", m_settings.cellsPerSide);
+    setUniform(m_scatterProgram, "uSlotOffset", static_cast<std::uint32_t>(slot) * cellsPerChunk());
+    setUniform(m_scatterProgram, "uChunkSeed", chunkSeed(entry.coord, m_terrainSeed ^ m_settings.seed));
+    setUniform(m_scatterProgram, "uNoiseSeed", m_terrainSeed * 0x9e3779b9U + m_settings.seed);
+    setUniform(m_scatterProgram, "uDensity", m_settings.density);
+    setUniform(m_scatterProgram, "uNoiseFrequency", m_settings.noiseFrequency);
+    setUniform(m_scatterProgram, "uMinSlopeCos", std::cos(glm::radians(m_settings.maxSlopeDegrees)));
+    setUniform(m_scatterProgram, "uMinScale", m_settings.minScale);
+    setUniform(m_scatterProgram, "uMaxScale", m_settings.maxScale);
+    setUniform(m_scatterProgram, "uHeightTex", 0);
+
+    TextureUnits::assertNotEnvUnit(0);
+    glBindTextureUnit(0, m_heightTexture);
+    glBindSampler(0, m_heightSampler);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kInstanceBinding, m_instanceBuffer);
+
+    const GLuint groups = (static_cast<GLuint>(m_settings.cellsPerSide) + kScatterGroupSize - 1) / kScatterGroupSize;
+    glDispatchCompute(groups, groups, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kInstanceBinding, 0);
+    glBindSampler(0, 0);
+    glBindTextureUnit(0, 0);
+    ++m_scatterDispatches;
+}
+
+void VegetationScatter::uploadActiveSlots()
+{
+    m_activeSlots.clear();
+    for (std::size_t i = 0; i < m_slots.size(); ++i) {
+        if (m_slots[i].active)
+            m_activeSlots.push_back(static_cast<std::uint32_t>(i));
+    }
+    if (!m_activeSlots.empty()) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_activeSlotBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(m_activeSlots.size() * sizeof(std::uint32_t)), m_activeSlots.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    m_activeSlotsDirty = false;
+}
+
+void VegetationScatter::draw(const DrawParams& params, RenderStats* stats)
+{
+    if (!m_ready || !m_settings.enabled)
+        return;
+    if (m_activeSlotsDirty)
+        uploadActiveSlots();
+    if (m_activeSlots.empty())
+        return;
+
+    const std::uint32_t cells = cellsPerChunk();
+    const std::uint32_t lodCapacity = static_cast<std::uint32_t>(m_slotCount) * cells;
+
+    // ---- Cull: reset both indirect commands, then append every surviving instance to its LOD list.
+    std::array<DrawElementsIndirectCommand, kLodCount> commands {};
+    for (int lod = 0; lod < kLodCount; ++lod)
+        commands[static_cast<std::size_t>(lod)] = { m_lods[lod].indexCount, 0u, m_lods[lod].firstIndex, m_lods[lod].baseVertex, 0u };
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(commands), commands.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    // Gribb-Hartmann planes of the main view; curvature bends distant geometry below the flat frustum,
+    // so the frustum test is skipped while it is enabled and only the distance test remains.
+    const glm::mat4 viewProjection = params.projection * params.view;
+    std::array<glm::vec4, 6> planes {};
+    for (int i = 0; i < 3; ++i) {
+        const glm::vec4 row(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+        const glm::vec4 w(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+        planes[static_cast<std::size_t>(2 * i)] = w + row;
+        planes[static_cast<std::size_t>(2 * i + 1)] = w - row;
+    }
+    for (glm::vec4& plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+
+    m_cullProgram.bind();
+    setUniform(m_cullProgram, "uActiveCount", static_cast<std::uint32_t>(m_activeSlots.size()));
+    setUniform(m_cullProgram, "uCellsPerChunk", cells);
+    setUniform(m_cullProgram, "uLodCapacity", lodCapacity);
+    setUniform(m_cullProgram, "uFrustumCulling", params.worldCurvatureEnabled ? 0 : 1);
+    if (const GLint loc = m_cullProgram.getUniformLocation("uPlanes"); loc >= 0)
+        glUniform4fv(loc, static_cast<GLsizei>(planes.size()), glm::value_ptr(planes[0]));
+    setUniform(m_cullProgram, "uCameraPos", params.cameraPos);
+    setUniform(m_cullProgram, "uBladeHeight", m_settings.bladeHeight);
+    setUniform(m_cullProgram, "uLod0Distance", m_settings.lod0Distance);
+    setUniform(m_cullProgram, "uMaxDistance", m_settings.maxDistance);
+    setUniform(m_cullProgram, "uFarThinning", m_settings.farThinning);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kInstanceBinding, m_instanceBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kActiveSlotBinding, m_activeSlotBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kVisibleBinding, m_visibleBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kCommandBinding, m_commandBuffer);
+
+    const GLuint invocations = static_cast<GLuint>(m_activeSlots.size()) * cells;
+    glDispatchCompute((invocations + kCullGroupSize - 1) / kCullGroupSize, 1, 1);
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kActiveSlotBinding, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kCommandBinding, 0);
+
+    if (m_settings.readbackStats) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBuffer);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(commands), commands.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        for (int lod = 0; lod < kLodCount; ++lod)
+            m_visibleLod[lod] = commands[static_cast<std::size_t>(lod)].instanceCount;
+    }
+
+    // ---- Draw: one indirect instanced draw per LOD; the vertex shader fetches instances through the visible list.
+    m_drawShader.bind();
+    setUniform(m_drawShader, "view", params.view);
+    setUniform(m_drawShader, "projection", params.projection);
+    setUniform(m_drawShader, "uBladeHeight", m_settings.bladeHeight);
+    setUniform(m_drawShader, "uTime", params.time);
+    setUniform(m_drawShader, "uWindStrength", m_settings.windStrength);
+    setUniform(m_drawShader, "uWorldCurvatureEnabled", params.worldCurvatureEnabled ? 1 : 0);
+    setUniform(m_drawShader, "uWorldCurvatureStrength", params.worldCurvatureStrength);
+    setUniform(m_drawShader, "lightPos", params.lightPos);
+    setUniform(m_drawShader, "lightColor", params.lightColor);
+    setUniform(m_drawShader, "ambientColor", params.ambientColor);
+    setUniform(m_drawShader, "ambientStrength", params.ambientStrength);
+    setUniform(m_drawShader, "cameraPos", params.cameraPos);
+    setUniform(m_drawShader, "uFogEnabled", params.fogEnabled ? 1 : 0);
+    setUniform(m_drawShader, "uFogColor", params.fogColor);
+    setUniform(m_drawShader, "uFogDensity", params.fogDensity);
+    setUniform(m_drawShader, "uFogGradient", params.fogGradient);
+
+    const GLboolean cullFaceEnabled = glIsEnabled(GL_CULL_FACE);
+    glDisable(GL_CULL_FACE);
+
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+    for (int lod = 0; lod < kLodCount; ++lod) {
+        setUniform(m_drawShader, "uLodOffset", static_cast<std::uint32_t>(lod) * lodCapacity);
+        const auto offset = static_cast<std::uintptr_t>(lod) * sizeof(DrawElementsIndirectCommand);
+        glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(offset));
+    }
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindVertexArray(0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kInstanceBinding, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, kVisibleBinding, 0);
+    if (cullFaceEnabled)
+        glEnable(GL_CULL_FACE);
+
+    if (stats) {
+        // Triangle counts are only known on the CPU when the visible counts are read back.
+        std::uint64_t triangles = 0;
+        if (m_settings.readbackStats) {
+            for (int lod = 0; lod < kLodCount; ++lod)
+                triangles += static_cast<std::uint64_t>(m_visibleLod[lod]) * (m_lods[lod].indexCount / 3);
+        }
+        stats->addDraw(kLodCount, triangles);
+    }
+}
+
+void VegetationScatter::setSettings(const Settings& settings)
+{
+    Settings clamped = settings;
+    clamped.cellsPerSide = std::clamp(clamped.cellsPerSide, 8, 128);
+    clamped.density = glm::clamp(clamped.density, 0.0f, 1.0f);
+    clamped.maxSlopeDegrees = glm::clamp(clamped.maxSlopeDegrees, 0.0f, 90.0f);
+    clamped.minScale = std::max(0.05f, clamped.minScale);
+    clamped.maxScale = std::max(clamped.minScale, clamped.maxScale);
+    clamped.maxDistance = std::max(1.0f, clamped.maxDistance);
+    clamped.lod0Distance = glm::clamp(clamped.lod0Distance, 0.0f, clamped.maxDistance);
+    clamped.farThinning = glm::clamp(clamped.farThinning, 0.0f, 1.0f);
+
+    const bool rescatter = clamped.cellsPerSide != m_settings.cellsPerSide
+        || clamped.density != m_settings.density
+        || clamped.noiseFrequency != m_settings.noiseFrequency
+        || clamped.maxSlopeDegrees != m_settings.maxSlopeDegrees
+        || clamped.minScale != m_settings.minScale
+        || clamped.maxScale != m_settings.maxScale
+        || clamped.seed != m_settings.seed;
+    const bool resize = clamped.cellsPerSide != m_settings.cellsPerSide;
+    m_settings = clamped;
+
+    if (!m_ready || !rescatter)
+        return;
+
+    // Placement depends only on the chunk coordinate and the settings, so active chunks are simply regenerated.
+    if (resize) {
+        destroyInstanceBuffers();
+        createInstanceBuffers();
+        m_activeSlotsDirty = true;
+    }
+    for (int slot = 0; slot < m_slotCount; ++slot) {
+        if (m_slots[static_cast<std::size_t>(slot)].active)
+            scatterSlot(slot);
+    }
+}
+
+void VegetationScatter::drawImGuiPanel()
+{
+    Settings temp = m_settings;
+    bool changed = false;
+    changed |= ImGui::Checkbox("Enabled##Vegetation", &temp.enabled);
+    changed |= ImGui::SliderInt("Cells per Side", &temp.cellsPerSide, 8, 128);
+    changed |= ImGui::SliderFloat("Density", &temp.density, 0.0f, 1.0f);
+    changed |= ImGui::SliderFloat("Noise Frequency", &temp.noiseFrequency, 0.005f, 0.3f, "%.3f");
+    changed |= ImGui::SliderFloat("Max Slope (deg)", &temp.maxSlopeDegrees, 0.0f, 90.0f);
+    changed |= ImGui::DragFloatRange2("Scale", &temp.minScale, &temp.maxScale, 0.01f, 0.05f, 4.0f);
+    changed |= ImGui::SliderFloat("Blade Height", &temp.bladeHeight, 0.1f, 2.0f);
+    changed |= ImGui::SliderFloat("LOD0 Distance", &temp.lod0Distance, 0.0f, 200.0f);
+    changed |= ImGui::SliderFloat("Max Distance", &temp.maxDistance, 1.0f, 300.0f);
+    changed |= ImGui::SliderFloat("Far Thinning", &temp.farThinning, 0.0f, 1.0f);
+    changed |= ImGui::SliderFloat("Wind", &temp.windStrength, 0.0f, 0.5f);
+    changed |= ImGui::InputScalar("Seed##Vegetation", ImGuiDataType_U32, &temp.seed);
+    changed |= ImGui::Checkbox("Read Back Visible Counts", &temp.readbackStats);
+    if (changed)
+        setSettings(temp);
+
+    const std::uint32_t active = static_cast<std::uint32_t>(std::count_if(m_slots.begin(), m_slots.end(), [](const Slot& slot) { return slot.active; }));
+    ImGui::Text("Active chunks: %u / %d (%u candidates each)", active, m_slotCount, cellsPerChunk());
+    ImGui::Text("Scatter dispatches: %u", m_scatterDispatches);
+    if (m_settings.readbackStats)
+        ImGui::Text("Visible tufts: %u (LOD0) / %u (LOD1)", m_visibleLod[0], m_visibleLod[1]);
+    else
+        ImGui::TextDisabled("Visible counts stay on the GPU");
+}
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include <framework/opengl_includes.h>
+#include <framework/shader.h>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <cstdint>
+#include <vector>
+
+struct RenderStats;
+
+// GPU-driven grass for ProceduralFloor. Every terrain layer owns a fixed slot in one instance buffer;
+// activating a chunk fills its slot in a compute pass from the chunk's heightmap layer and a density
+// noise, deterministically from the chunk coordinate and seed. Each frame a second compute pass culls
+// the active slots against the frustum, picks a LOD by distance and appends the survivors to per-LOD
+// lists that are drawn with one indirect instanced draw per LOD. The CPU never touches instances.
+class VegetationScatter {
+public:
+    struct Settings {
+        bool enabled { true };
+        int cellsPerSide { 64 }; // scatter candidates per chunk side, at most one tuft per cell
+        float density { 0.75f }; // fraction of cells kept where the density noise peaks
+        float noiseFrequency { 0.06f };
+        float maxSlopeDegrees { 35.0f };
+        float minScale { 0.6f };
+        float maxScale { 1.3f };
+        float bladeHeight { 0.6f };
+        float lod0Distance { 22.0f };
+        float maxDistance { 70.0f };
+        float farThinning { 0.6f }; // fraction of LOD1 tufts dropped towards maxDistance
+        float windStrength { 0.12f };
+        std::uint32_t seed { 7u };
+        bool readbackStats { false }; // reads visible counts back each frame (stalls the pipeline)
+    };
+
+    struct DrawParams {
+        glm::mat4 view { 1.0f };
+        glm::mat4 projection { 1.0f };
+        glm::vec3 lightPos { 0.0f };
+        glm::vec3 lightColor { 1.0f };
+        glm::vec3 ambientColor { 1.0f };
+        float ambientStrength { 0.1f };
+        glm::vec3 cameraPos { 0.0f };
+        bool fogEnabled { false };
+        glm::vec3 fogColor { 0.6f, 0.7f, 0.9f };
+        float fogDensity { 0.01f };
+        float fogGradient { 1.8f };
+        bool worldCurvatureEnabled { false };
+        float worldCurvatureStrength { 0.001f };
+        float time { 0.0f };
+    };
+
+    VegetationScatter() = default;
+    ~VegetationScatter();
+
+    VegetationScatter(const VegetationScatter&) = delete;
+    VegetationScatter& operator=(const VegetationScatter&) = delete;
+
+    // One slot per terrain texture layer; `heightTexture` is the floor's R32F layer array.
+    void initialize(int slotCount, float chunkSize, int chunkResolution, std::uint32_t terrainSeed, GLuint heightTexture, GLuint heightSampler);
+    void release();
+
+    // Called once the chunk's heightmap layer has been generated.
+    void activateChunk(int slot, const glm::ivec2& coord, const glm::vec3& origin);
+    void releaseChunk(int slot);
+
+    void draw(const DrawParams& params, RenderStats* stats = nullptr);
+
+    [[nodiscard]] const Settings& settings() const { return m_settings; }
+    void setSettings(const Settings& settings);
+    void drawImGuiPanel();
+
+private:
+    struct Slot {
+        bool active { false };
+        glm::ivec2 coord { 0 };
+        glm::vec3 origin { 0.0f };
+    };
+
+    void createInstanceBuffers();
+    void destroyInstanceBuffers();
+    void createBladeMeshes();
+    void scatterSlot(int slot);
+    void uploadActiveSlots();
+    [[nodiscard]] std::uint32_t cellsPerChunk() const;
+
+    Settings m_settings;
+    bool m_ready { false };
+
+    int m_slotCount { 0 };
+    float m_chunkSize { 32.0f };
+    int m_chunkResolution { 64 };
+    std::uint32_t m_terrainSeed { 0 };
+    GLuint m_heightTexture { 0 };
+    GLuint m_heightSampler { 0 };
+
+    std::vector<Slot> m_slots;
+    std::vector<std::uint32_t> m_activeSlots;
+    bool m_activeSlotsDirty { true };
+
+    GLuint m_instanceBuffer { 0 };
+    GLuint m_activeSlotBuffer { 0 };
+    GLuint m_visibleBuffer { 0 };
+    GLuint m_commandBuffer { 0 };
+
+    GLuint m_vao { 0 };
+    GLuint m_vbo { 0 };
+    GLuint m_ebo { 0 };
+    struct LodMesh {
+        GLuint indexCount { 0 };
+        GLuint firstIndex { 0 };
+        GLint baseVertex { 0 };
+    };
+    LodMesh m_lods[2] {};
+
+    Shader m_scatterProgram;
+    Shader m_cullProgram;
+    Shader m_drawShader;
+
+    std::uint32_t m_scatterDispatches { 0 };
+    std::uint32_t m_visibleLod[2] { 0, 0 };
+};
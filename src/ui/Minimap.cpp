@@ -50,6 +50,13 @@ void Minimap::allocate(int size)
     glBindRenderbuffer(GL_RENDERBUFFER, 0);
 }
 
+void Minimap::resize(int size)
+{
+    if (size == m_size && m_fbo)
+        return;
+    allocate(size);
+}
+
 void Minimap::destroy()
 {
     if (m_depthRbo) { glDeleteRenderbuffers(1, &m_depthRbo); m_depthRbo = 0; }
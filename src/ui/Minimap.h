@@ -10,6 +10,9 @@ public:
                          const std::function<void(const glm::mat4& view, const glm::mat4& proj)>& drawCallback);
     void drawOverlay(float posX, float posY, float width, float height);
     unsigned int textureId() const;
+    // Reallocates the render target; needs a current GL context.
+    void resize(int size);
+    int size() const { return m_size; }
 private:
     void allocate(int size);
     void destroy();
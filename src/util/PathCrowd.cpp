@@ -0,0 +1,444 @@
+// SPDX-License-Identifier: MIT
+#include "util/PathCrowd.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PATH_CROWD_SSE 1
+#include <emmintrin.h>
+#endif
+
+#include <framework/disable_all_warnings.h>
+DISABLE_WARNINGS_PUSH()
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/constants.hpp>
+#include <imgui/imgui.h>
+DISABLE_WARNINGS_POP()
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace {
+
+constexpr std::size_t kMaxTableSamples = 1 << 16;
+constexpr glm::vec3 kWorldUp { 0.0f, 1.0f, 0.0f };
+
+// Shared by the crowd and the PathAnimator benchmark so both produce identical output.
+void composeTransform(const glm::vec3& position, const glm::vec3& forward, float laneOffset, PathCrowd::InstanceTransform& out)
+{
+    glm::vec3 right = glm::cross(forward, kWorldUp);
+    const float rightLength = glm::length(right);
+    right = rightLength > 1e-5f ? right / rightLength : glm::vec3(1.0f, 0.0f, 0.0f);
+    const glm::vec3 up = glm::cross(right, forward);
+    const glm::vec3 origin = position + right * laneOffset;
+    out.rows[0] = glm::vec4(right.x, up.x, forward.x, origin.x);
+    out.rows[1] = glm::vec4(right.y, up.y, forward.y, origin.y);
+    out.rows[2] = glm::vec4(right.z, up.z, forward.z, origin.z);
+}
+
+unsigned resolveThreadCount(unsigned requested)
+{
+    return requested > 0 ? requested : std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+PathCrowd::~PathCrowd()
+{
+    stopWorkers();
+}
+
+std::uint32_t PathCrowd::addPath(const BezierPath& path, float sampleSpacing)
+{
+    PathTable table;
+    table.length = path.totalLength();
+    const float spacing = std::max(sampleSpacing, 1e-3f);
+    const std::size_t sampleCount = std::clamp<std::size_t>(static_cast<std::size_t>(std::ceil(table.length / spacing)) + 1, 2, kMaxTableSamples);
+    table.positions.resize(sampleCount);
+    table.tangents.resize(sampleCount);
+    for (std::size_t i = 0; i < sampleCount; ++i) {
+        const float normalized = static_cast<float>(i) / static_cast<float>(sampleCount - 1);
+        table.positions[i] = path.sample(normalized);
+        const glm::vec3 tangent = path.sampleTangent(normalized);
+        const float tangentLength = glm::length(tangent);
+        table.tangents[i] = tangentLength > 1e-6f ? tangent / tangentLength : glm::vec3(0.0f, 0.0f, 1.0f);
+    }
+    table.invStep = table.length > 0.0f ? static_cast<float>(sampleCount - 1) / table.length : 0.0f;
+
+    m_paths.push_back(std::move(table));
+    m_stats.paths = m_paths.size();
+    return static_cast<std::uint32_t>(m_paths.size() - 1);
+}
+
+BezierPath PathCrowd::makeLoopPath(const glm::vec3& center, float radius, int waypoints, std::uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> jitter(0.75f, 1.25f);
+    std::uniform_real_distribution<float> height(-0.15f, 0.15f);
+
+    const int count = std::max(waypoints, 3);
+    std::vector<glm::vec3> points(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        const float angle = glm::two_pi<float>() * static_cast<float>(i) / static_cast<float>(count);
+        const float r = radius * jitter(rng);
+        points[static_cast<std::size_t>(i)] = center + glm::vec3(std::cos(angle) * r, height(rng), std::sin(angle) * r);
+    }
+
+    const auto at = [&](int i) { return points[static_cast<std::size_t>((i + count) % count)]; };
+    std::vector<CubicBezier> segments;
+    segments.reserve(points.size());
+    for (int i = 0; i < count; ++i) {
+        CubicBezier segment;
+        segment.p0 = at(i);
+        segment.p1 = at(i) + (at(i + 1) - at(i - 1)) / 6.0f;
+        segment.p2 = at(i + 1) - (at(i + 2) - at(i)) / 6.0f;
+        segment.p3 = at(i + 1);
+        segments.push_back(segment);
+    }
+
+    BezierPath path;
+    path.setSegments(std::move(segments));
+    return path;
+}
+
+void PathCrowd::generateDemoPaths(const glm::vec3& center, float radius, int count, std::uint32_t seed)
+{
+    for (int i = 0; i < count; ++i) {
+        const float ringRadius = radius * (0.35f + 0.65f * static_cast<float>(i + 1) / static_cast<float>(std::max(count, 1)));
+        addPath(makeLoopPath(center, ringRadius, 8 + i % 5, seed + static_cast<std::uint32_t>(i) * 7919u));
+    }
+}
+
+void PathCrowd::clearPaths()
+{
+    m_paths.clear();
+    clearFollowers();
+    m_stats.paths = 0;
+}
+
+void PathCrowd::spawn(const SpawnParams& params)
+{
+    if (params.path >= m_paths.size() || m_paths[params.path].length <= 0.0f || params.count == 0)
+        return;
+
+    const PathTable& table = m_paths[params.path];
+    const bool pingPong = params.mode == PathPlaybackMode::PingPong;
+    const float period = pingPong ? 2.0f * table.length : table.length;
+
+    std::mt19937 rng(params.seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float minSpeed = std::max(0.0f, std::min(params.minSpeed, params.maxSpeed));
+    const float maxSpeed = std::max(minSpeed, params.maxSpeed);
+
+    const std::size_t total = m_pathIds.size() + params.count;
+    m_pathIds.reserve(total);
+    m_distances.reserve(total);
+    m_speeds.reserve(total);
+    m_directions.reserve(total);
+    m_periods.reserve(total);
+    m_invPeriods.reserve(total);
+    m_laneOffsets.reserve(total);
+    m_modes.reserve(total);
+    for (std::size_t i = 0; i < params.count; ++i) {
+        m_pathIds.push_back(params.path);
+        m_distances.push_back(unit(rng) * period);
+        m_speeds.push_back(minSpeed + (maxSpeed - minSpeed) * unit(rng));
+        m_directions.push_back(unit(rng) < params.reverseFraction ? -1.0f : 1.0f);
+        m_periods.push_back(period);
+        m_invPeriods.push_back(1.0f / period);
+        m_laneOffsets.push_back((unit(rng) - 0.5f) * params.laneWidth);
+        m_modes.push_back(params.mode);
+    }
+    m_stats.followers = m_pathIds.size();
+}
+
+void PathCrowd::clearFollowers()
+{
+    m_pathIds.clear();
+    m_distances.clear();
+    m_speeds.clear();
+    m_directions.clear();
+    m_periods.clear();
+    m_invPeriods.clear();
+    m_laneOffsets.clear();
+    m_modes.clear();
+    m_stats.followers = 0;
+}
+
+void PathCrowd::setSettings(const Settings& settings)
+{
+    m_settings = settings;
+    m_settings.timeScale = std::max(m_settings.timeScale, 0.0f);
+    m_settings.followersPerTask = std::max<std::size_t>(m_settings.followersPerTask, 64);
+}
+
+void PathCrowd::update(double deltaSeconds, InstanceTransform* out)
+{
+    const unsigned threads = resolveThreadCount(m_settings.threads);
+    if (m_workers.size() + 1 != threads)
+        startWorkers(threads - 1);
+
+    const auto start = std::chrono::steady_clock::now();
+    const float delta = m_settings.paused ? 0.0f : static_cast<float>(std::max(0.0, deltaSeconds)) * m_settings.timeScale;
+    parallelFor(m_pathIds.size(), [&](std::size_t begin, std::size_t end) {
+        if (delta > 0.0f)
+            advance(begin, end, delta);
+        if (out)
+            sample(begin, end, out);
+    });
+
+    m_stats.threads = threads;
+    m_stats.updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PathCrowd::advance(std::size_t begin, std::size_t end, float deltaSeconds)
+{
+    float* distances = m_distances.data();
+    const float* speeds = m_speeds.data();
+    const float* directions = m_directions.data();
+    const float* periods = m_periods.data();
+    const float* invPeriods = m_invPeriods.data();
+
+    std::size_t i = begin;
+#ifdef PATH_CROWD_SSE
+    const __m128 delta = _mm_set1_ps(deltaSeconds);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= end; i += 4) {
+        const __m128 period = _mm_loadu_ps(periods + i);
+        __m128 d = _mm_add_ps(_mm_loadu_ps(distances + i),
+            _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(speeds + i), _mm_loadu_ps(directions + i)), delta));
+        // d -= floor(d / period) * period; SSE2 has no floor, so truncate and step negatives down.
+        const __m128 quotient = _mm_mul_ps(d, _mm_loadu_ps(invPeriods + i));
+        __m128 whole = _mm_cvtepi32_ps(_mm_cvttps_epi32(quotient));
+        whole = _mm_sub_ps(whole, _mm_and_ps(_mm_cmplt_ps(quotient, whole), one));
+        d = _mm_sub_ps(d, _mm_mul_ps(whole, period));
+        // Rounding can land exactly on the period (or a hair below zero).
+        d = _mm_max_ps(d, zero);
+        d = _mm_and_ps(d, _mm_cmplt_ps(d, period));
+        _mm_storeu_ps(distances + i, d);
+    }
+#endif
+    for (; i < end; ++i) {
+        float d = distances[i] + speeds[i] * directions[i] * deltaSeconds;
+        d -= std::floor(d * invPeriods[i]) * periods[i];
+        distances[i] = (d >= 0.0f && d < periods[i]) ? d : 0.0f;
+    }
+}
+
+void PathCrowd::sample(std::size_t begin, std::size_t end, InstanceTransform* out) const
+{
+    for (std::size_t i = begin; i < end; ++i) {
+        const PathTable& table = m_paths[m_pathIds[i]];
+        const float d = m_distances[i];
+        // Ping-pong: the second half of the period walks the path back. Loops never reach it.
+        const float s = table.length - std::abs(d - table.length);
+        const float heading = d > table.length ? -m_directions[i] : m_directions[i];
+
+        const std::size_t last = table.positions.size() - 1;
+        const float f = std::max(s, 0.0f) * table.invStep;
+        const std::size_t k = std::min(static_cast<std::size_t>(f), last - 1);
+        const float t = std::min(f - static_cast<float>(k), 1.0f);
+        const glm::vec3 position = table.positions[k] + (table.positions[k + 1] - table.positions[k]) * t;
+        glm::vec3 tangent = table.tangents[k] + (table.tangents[k + 1] - table.tangents[k]) * t;
+        const float tangentLength = glm::length(tangent);
+        tangent = tangentLength > 1e-6f ? tangent * (heading / tangentLength) : glm::vec3(0.0f, 0.0f, heading);
+        composeTransform(position, tangent, m_laneOffsets[i], out[i]);
+    }
+}
+
+void PathCrowd::parallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)>& task)
+{
+    const std::size_t chunk = std::max<std::size_t>(m_settings.followersPerTask, 64);
+    if (m_workers.empty() || count <= chunk) {
+        for (std::size_t begin = 0; begin < count; begin += chunk)
+            task(begin, std::min(count, begin + chunk));
+        return;
+    }
+
+    {
+        std::unique_lock lock(m_poolMutex);
+        // A worker woken by the previous call may still be looking for chunks.
+        m_finished.wait(lock, [this]() { return m_busyWorkers == 0; });
+        m_task = &task;
+        m_taskCount = count;
+        m_taskChunk = chunk;
+        m_nextChunk.store(0);
+        ++m_generation;
+    }
+    m_wake.notify_all();
+    runChunks();
+
+    std::unique_lock lock(m_poolMutex);
+    m_finished.wait(lock, [this]() { return m_busyWorkers == 0; });
+}
+
+void PathCrowd::runChunks()
+{
+    const std::size_t chunks = (m_taskCount + m_taskChunk - 1) / m_taskChunk;
+    for (std::size_t c = m_nextChunk.fetch_add(1); c < chunks; c = m_nextChunk.fetch_add(1)) {
+        const std::size_t begin = c * m_taskChunk;
+        (*m_task)(begin, std::min(m_taskCount, begin + m_taskChunk));
+    }
+}
+
+void PathCrowd::startWorkers(unsigned count)
+{
+    stopWorkers();
+    m_stopping = false;
+    m_workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+        m_workers.emplace_back(&PathCrowd::workerLoop, this);
+}
+
+void PathCrowd::stopWorkers()
+{
+    {
+        std::lock_guard lock(m_poolMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+    m_workers.clear();
+}
+
+void PathCrowd::workerLoop()
+{
+    std::unique_lock lock(m_poolMutex);
+    std::uint64_t seen = m_generation;
+    while (true) {
+        m_wake.wait(lock, [&]() { return m_stopping || m_generation != seen; });
+        if (m_stopping)
+            return;
+        seen = m_generation;
+        ++m_busyWorkers;
+        lock.unlock();
+        runChunks();
+        lock.lock();
+        if (--m_busyWorkers == 0)
+            m_finished.notify_all();
+    }
+}
+
+PathCrowd::BenchmarkResult PathCrowd::benchmark(std::size_t followers, int frames, unsigned threads)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr double kFrameSeconds = 1.0 / 60.0;
+
+    BenchmarkResult result;
+    result.followers = followers;
+    result.frames = std::max(frames, 1);
+    result.threads = resolveThreadCount(threads);
+
+    const BezierPath path = makeLoopPath(glm::vec3(0.0f), 40.0f, 12, 1234u);
+    std::vector<InstanceTransform> transforms(followers);
+
+    // The same followers as PathCrowd::spawn produces, one PathAnimator each.
+    SpawnParams spawnParams;
+    spawnParams.count = followers;
+    spawnParams.minSpeed = 1.0f;
+    spawnParams.maxSpeed = 2.5f;
+    spawnParams.laneWidth = 3.0f;
+    std::mt19937 rng(spawnParams.seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<PathAnimator> animators(followers);
+    std::vector<float> laneOffsets(followers);
+    for (std::size_t i = 0; i < followers; ++i) {
+        animators[i].setPath(&path);
+        animators[i].reset(unit(rng));
+        animators[i].setSpeed(spawnParams.minSpeed + (spawnParams.maxSpeed - spawnParams.minSpeed) * unit(rng));
+        (void)unit(rng); // direction
+        laneOffsets[i] = (unit(rng) - 0.5f) * spawnParams.laneWidth;
+    }
+
+    auto start = Clock::now();
+    for (int frame = 0; frame < result.frames; ++frame) {
+        for (std::size_t i = 0; i < followers; ++i) {
+            animators[i].update(kFrameSeconds);
+            const PathAnimator::SampleResult sampled = animators[i].sample();
+            const float tangentLength = glm::length(sampled.tangent);
+            const glm::vec3 forward = tangentLength > 1e-6f ? sampled.tangent / tangentLength : glm::vec3(0.0f, 0.0f, 1.0f);
+            composeTransform(sampled.position, forward, laneOffsets[i], transforms[i]);
+        }
+    }
+    result.animatorMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / static_cast<double>(result.frames);
+
+    const auto timeCrowd = [&](unsigned crowdThreads) {
+        PathCrowd crowd;
+        Settings settings;
+        settings.threads = crowdThreads;
+        crowd.setSettings(settings);
+        crowd.addPath(path);
+        crowd.spawn(spawnParams);
+        crowd.update(0.0, transforms.data()); // starts the workers outside the timed frames
+        const auto crowdStart = Clock::now();
+        for (int frame = 0; frame < result.frames; ++frame)
+            crowd.update(kFrameSeconds, transforms.data());
+        return std::chrono::duration<double, std::milli>(Clock::now() - crowdStart).count() / static_cast<double>(result.frames);
+    };
+    result.crowdSingleThreadMs = timeCrowd(1);
+    result.crowdMs = timeCrowd(result.threads);
+    return result;
+}
+
+void PathCrowd::drawImGuiPanel(const glm::vec3& demoCenter)
+{
+    Settings settings = m_settings;
+    bool changed = false;
+    changed |= ImGui::Checkbox("Enabled", &settings.enabled);
+    ImGui::SameLine();
+    changed |= ImGui::Checkbox("Paused", &settings.paused);
+    changed |= ImGui::SliderFloat("Time Scale", &settings.timeScale, 0.0f, 4.0f, "%.2f");
+    int threads = static_cast<int>(settings.threads);
+    if (ImGui::SliderInt("Threads (0 = auto)", &threads, 0, 32)) {
+        settings.threads = static_cast<unsigned>(threads);
+        changed = true;
+    }
+    int perTask = static_cast<int>(settings.followersPerTask);
+    if (ImGui::SliderInt("Followers Per Task", &perTask, 64, 16384)) {
+        settings.followersPerTask = static_cast<std::size_t>(perTask);
+        changed = true;
+    }
+    if (changed)
+        setSettings(settings);
+
+    ImGui::Text("Followers: %zu on %zu paths", m_stats.followers, m_stats.paths);
+    ImGui::Text("Update: %.3f ms on %u threads", m_stats.updateMs, m_stats.threads);
+
+    ImGui::SliderInt("Spawn Count", &m_spawnCount, 1, 100000);
+    if (ImGui::Button("Spawn Demo Crowd")) {
+        if (m_paths.empty())
+            generateDemoPaths(demoCenter, 30.0f, 6, 42u);
+        const std::size_t perPath = static_cast<std::size_t>(m_spawnCount) / m_paths.size();
+        for (std::uint32_t path = 0; path < m_paths.size(); ++path) {
+            SpawnParams params;
+            params.path = path;
+            params.count = path == 0 ? static_cast<std::size_t>(m_spawnCount) - perPath * (m_paths.size() - 1) : perPath;
+            params.mode = path % 3 == 2 ? PathPlaybackMode::PingPong : PathPlaybackMode::Loop;
+            params.reverseFraction = 0.3f;
+            params.seed = static_cast<std::uint32_t>(m_pathIds.size()) + path;
+            spawn(params);
+        }
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear Crowd"))
+        clearPaths();
+
+    ImGui::Separator();
+    ImGui::SliderInt("Benchmark Followers", &m_benchmarkFollowers, 1000, 100000);
+    if (ImGui::Button("Benchmark vs PathAnimator")) {
+        m_lastBenchmark = benchmark(static_cast<std::size_t>(m_benchmarkFollowers), 120, m_settings.threads);
+        std::cout << "[Crowd] " << m_lastBenchmark.followers << " followers: PathAnimator " << m_lastBenchmark.animatorMs
+                  << " ms, crowd " << m_lastBenchmark.crowdSingleThreadMs << " ms on 1 thread, " << m_lastBenchmark.crowdMs
+                  << " ms on " << m_lastBenchmark.threads << " threads" << std::endl;
+    }
+    if (m_lastBenchmark.frames > 0) {
+        const BenchmarkResult& b = m_lastBenchmark;
+        ImGui::Text("PathAnimator: %.3f ms/frame", b.animatorMs);
+        ImGui::Text("Crowd, 1 thread: %.3f ms/frame (%.1fx)", b.crowdSingleThreadMs, b.crowdSingleThreadMs > 0.0 ? b.animatorMs / b.crowdSingleThreadMs : 0.0);
+        ImGui::Text("Crowd, %u threads: %.3f ms/frame (%.1fx)", b.threads, b.crowdMs, b.crowdMs > 0.0 ? b.animatorMs / b.crowdMs : 0.0);
+    }
+}
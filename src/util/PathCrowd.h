@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: MIT
+#pragma once
+
+#include "util/BezierPath.h"
+#include "util/PathAnimator.h"
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Moves thousands of agents along BezierPaths, the batch counterpart of PathAnimator. Followers live
+// in SoA arrays (path id, arc distance, speed, direction, mode, lane offset). Each path is baked once
+// into a uniform arc-length table, so sampling is one lerp instead of a LUT search and a Bezier
+// evaluation. update() splits the followers into chunks for a small persistent worker pool; every
+// chunk advances its distances four at a time with SSE, then samples the tables and writes each
+// follower's transform straight into the caller's instance buffer (usually persistently mapped GPU
+// memory, see CrowdRenderer).
+//
+// Distances run over [0, period): the path length for loops and twice the length for ping-pong, so
+// wrapping and bouncing are both one floor-modulo and folding d into length - |d - length| turns the
+// second half of a ping-pong period into the way back.
+class PathCrowd {
+public:
+    // Row-major 3x4 affine transform; the std430 instance layout of crowd.vert. Columns are the
+    // follower's right, up and forward axes and its position.
+    struct InstanceTransform {
+        glm::vec4 rows[3];
+    };
+
+    struct Settings {
+        bool enabled { true };
+        bool paused { false };
+        float timeScale { 1.0f };
+        unsigned threads { 0 }; // 0: one per hardware thread; applied on the next update()
+        std::size_t followersPerTask { 2048 };
+    };
+
+    struct SpawnParams {
+        std::uint32_t path { 0 };
+        std::size_t count { 1 };
+        float minSpeed { 1.0f }; // metres per second
+        float maxSpeed { 2.0f };
+        PathPlaybackMode mode { PathPlaybackMode::Loop };
+        float laneWidth { 2.0f }; // followers are spread across this width, centred on the path
+        float reverseFraction { 0.0f }; // fraction of followers heading the other way
+        std::uint32_t seed { 1u };
+    };
+
+    struct BenchmarkResult {
+        std::size_t followers { 0 };
+        int frames { 0 };
+        unsigned threads { 0 };
+        // Milliseconds per frame to advance, sample and write a transform for every follower.
+        double animatorMs { 0.0 };
+        double crowdSingleThreadMs { 0.0 };
+        double crowdMs { 0.0 };
+    };
+
+    struct Stats {
+        std::size_t followers { 0 };
+        std::size_t paths { 0 };
+        unsigned threads { 0 };
+        double updateMs { 0.0 };
+    };
+
+    PathCrowd() = default;
+    ~PathCrowd();
+    PathCrowd(const PathCrowd&) = delete;
+    PathCrowd& operator=(const PathCrowd&) = delete;
+
+    // Bakes `path` into a table with samples `sampleSpacing` metres apart. Returns the path id.
+    std::uint32_t addPath(const BezierPath& path, float sampleSpacing = 0.25f);
+    // Adds `count` closed loops of jittered waypoints around `center`.
+    void generateDemoPaths(const glm::vec3& center, float radius, int count, std::uint32_t seed);
+    // Removes all paths and followers.
+    void clearPaths();
+
+    // Followers on zero-length or unknown paths are not added.
+    void spawn(const SpawnParams& params);
+    void clearFollowers();
+
+    // Advances every follower by deltaSeconds and writes followerCount() transforms to `out`
+    // (null: advance only).
+    void update(double deltaSeconds, InstanceTransform* out);
+
+    [[nodiscard]] std::size_t followerCount() const { return m_pathIds.size(); }
+    [[nodiscard]] std::size_t pathCount() const { return m_paths.size(); }
+    [[nodiscard]] const Settings& settings() const { return m_settings; }
+    void setSettings(const Settings& settings);
+    [[nodiscard]] const Stats& stats() const { return m_stats; }
+
+    // A closed Catmull-Rom loop through `waypoints` jittered points on a circle, as Bezier segments.
+    [[nodiscard]] static BezierPath makeLoopPath(const glm::vec3& center, float radius, int waypoints, std::uint32_t seed);
+    // Times `followers` PathAnimators against a crowd of the same followers on one demo path.
+    [[nodiscard]] static BenchmarkResult benchmark(std::size_t followers, int frames, unsigned threads = 0);
+
+    // `demoCenter`: where "Spawn Demo Crowd" places its paths.
+    void drawImGuiPanel(const glm::vec3& demoCenter);
+
+private:
+    struct PathTable {
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec3> tangents;
+        float length { 0.0f };
+        float invStep { 0.0f }; // table samples per metre
+    };
+
+    void advance(std::size_t begin, std::size_t end, float deltaSeconds);
+    void sample(std::size_t begin, std::size_t end, InstanceTransform* out) const;
+
+    // Runs task(begin, end) over [0, count) in followersPerTask chunks on the pool and this thread.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)>& task);
+    void startWorkers(unsigned count);
+    void stopWorkers();
+    void workerLoop();
+    void runChunks();
+
+    Settings m_settings;
+    std::vector<PathTable> m_paths;
+
+    // Followers, SoA.
+    std::vector<std::uint32_t> m_pathIds;
+    std::vector<float> m_distances; // metres into the period
+    std::vector<float> m_speeds; // metres per second, >= 0
+    std::vector<float> m_directions; // +1 or -1
+    std::vector<float> m_periods;
+    std::vector<float> m_invPeriods;
+    std::vector<float> m_laneOffsets; // metres along the follower's right axis
+    std::vector<PathPlaybackMode> m_modes;
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_poolMutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_finished;
+    const std::function<void(std::size_t, std::size_t)>* m_task { nullptr };
+    std::size_t m_taskCount { 0 };
+    std::size_t m_taskChunk { 1 };
+    std::atomic<std::size_t> m_nextChunk { 0 };
+    std::uint64_t m_generation { 0 };
+    unsigned m_busyWorkers { 0 };
+    bool m_stopping { false };
+
+    Stats m_stats;
+
+    // Panel state.
+    int m_spawnCount { 10000 };
+    int m_benchmarkFollowers { 10000 };
+    BenchmarkResult m_lastBenchmark;
+};
@@ -1,14 +1,17 @@
 #include "water/Water.h"
 
+#include "rendering/texture.h"
+
 #include <framework/disable_all_warnings.h>
 DISABLE_WARNINGS_PUSH()
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <imgui/imgui.h>
-#include <stb/stb_image.h>
 DISABLE_WARNINGS_POP()
 
+#include <framework/file_provider.h>
+
 #include <vector>
 #include <iostream>
 #include <cmath>
@@ -61,17 +64,23 @@ void WaterRenderer::initGL(const std::filesystem::path& shaderDir)
 
     // Load detail normal maps
     auto loadNormalMap = [](const std::string& path) -> GLuint {
-        int width, height, channels;
-        unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 3);
-        if (!data) {
-            std::cerr << "Failed to load texture: " << path << std::endl;
+        TextureImportOptions import;
+        import.channels = 3;
+        import.normalMap = true;
+        TextureData image;
+        try {
+            image = loadTextureData(path, import);
+        } catch (const ImageLoadingException& ex) {
+            std::cerr << "Failed to load texture: " << ex.what() << std::endl;
             return 0;
         }
 
         GLuint texture;
         glGenTextures(1, &texture);
         glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_BYTE, image.bytes.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
         glGenerateMipmap(GL_TEXTURE_2D);
         
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -79,7 +88,6 @@ void WaterRenderer::initGL(const std::filesystem::path& shaderDir)
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         
-        stbi_image_free(data);
         return texture;
     };
 
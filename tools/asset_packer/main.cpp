@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: MIT
+// Builds a .dpak archive from asset directories. Every file is stored under its path relative to
+// --root, which is also the root the engine's VirtualFileSystem resolves against, so a pack built
+// from the source tree serves exactly the paths the loaders ask for.
+#include "io/AssetPack.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::filesystem::path root { "." };
+    std::filesystem::path output { "daedalus.dpak" };
+    std::vector<std::filesystem::path> inputs;
+    AssetPackWriter::Options pack;
+};
+
+void printUsage()
+{
+    std::cout << "Usage: daedalus_asset_packer [--root <dir>] [--out <file>] [--align <bytes>] [--no-compress]\n"
+              << "                             [--min-savings <fraction>] [input dirs...]\n"
+              << "  Inputs are relative to --root and default to 'resources' and 'shaders'.\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--root" && hasValue) {
+            options.root = argv[++i];
+        } else if (arg == "--out" && hasValue) {
+            options.output = argv[++i];
+        } else if (arg == "--align" && hasValue) {
+            options.pack.alignment = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--min-savings" && hasValue) {
+            options.pack.minCompressionSavings = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--no-compress") {
+            options.pack.compress = false;
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return false;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown argument '" << arg << "'" << std::endl;
+            printUsage();
+            return false;
+        } else {
+            options.inputs.emplace_back(arg);
+        }
+    }
+    if (options.inputs.empty())
+        options.inputs = { "resources", "shaders" };
+    return true;
+}
+
+bool readWholeFile(const std::filesystem::path& path, std::vector<std::byte>& bytes)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    bytes.resize(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    return bytes.empty() || static_cast<bool>(file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size())));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::filesystem::path root = std::filesystem::absolute(options.root).lexically_normal();
+    AssetPackWriter writer;
+
+    for (const std::filesystem::path& input : options.inputs) {
+        const std::filesystem::path directory = root / input;
+        std::error_code error;
+        if (!std::filesystem::is_directory(directory, error)) {
+            std::cerr << "[Packer] Skipping missing input " << directory << std::endl;
+            continue;
+        }
+        for (std::filesystem::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+            if (!it->is_regular_file(error))
+                continue;
+            const std::filesystem::path relative = it->path().lexically_normal().lexically_relative(root);
+            const std::string name = relative.filename().string();
+            if (name.empty() || name[0] == '.')
+                continue;
+
+            std::vector<std::byte> bytes;
+            if (!readWholeFile(it->path(), bytes)) {
+                std::cerr << "[Packer] Failed to read " << it->path() << std::endl;
+                return 1;
+            }
+            writer.addFile(relative.generic_string(), std::move(bytes));
+        }
+        if (error) {
+            std::cerr << "[Packer] Failed to scan " << directory << ": " << error.message() << std::endl;
+            return 1;
+        }
+    }
+
+    AssetPackWriter::Result result;
+    std::string error;
+    if (!writer.write(options.output, options.pack, result, error)) {
+        std::cerr << "[Packer] " << error << std::endl;
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto mib = [](std::uint64_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+    std::cout << "[Packer] Wrote " << options.output.string() << ": " << result.files << " files -> " << result.blobs << " blobs ("
+              << result.compressedBlobs << " LZ4), " << mib(result.rawBytes) << " MiB raw, " << mib(result.uniqueBytes)
+              << " MiB unique, " << mib(result.packBytes) << " MiB packed in " << seconds << " s" << std::endl;
+    return 0;
+}
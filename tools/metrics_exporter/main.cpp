@@ -0,0 +1,205 @@
+// SPDX-License-Identifier: MIT
+// Maps the engine's metrics segment read-only and prints the latest published frame in the
+// OpenMetrics text format, once or every --watch milliseconds. Pipe it into a textfile collector or
+// serve the output from any tiny HTTP wrapper to feed Prometheus.
+#include "metrics/MetricsShmLayout.h"
+#include "metrics/SharedMemory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string name { metrics_shm::kDefaultName };
+    int watchMs { 0 };
+};
+
+struct Snapshot {
+    std::vector<metrics_shm::MetricDescriptor> descriptors;
+    std::uint64_t frameIndex { 0 };
+    std::uint64_t timestampNs { 0 };
+    std::uint32_t valueCount { 0 };
+    std::vector<std::uint64_t> values;
+};
+
+void printUsage()
+{
+    std::cout << "Usage: daedalus_metrics_exporter [--name <shm name>] [--watch <ms>]\n"
+              << "  --name   shared memory segment (default " << metrics_shm::kDefaultName << ")\n"
+              << "  --watch  re-export every <ms> milliseconds instead of once\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--name" && i + 1 < argc) {
+            options.name = argv[++i];
+        } else if (arg == "--watch" && i + 1 < argc) {
+            options.watchMs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return false;
+        } else {
+            std::cerr << "Unknown argument '" << arg << "'" << std::endl;
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+double toDouble(std::uint64_t bits)
+{
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string formatNumber(double value)
+{
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+    return buffer;
+}
+
+std::string escapeHelp(const char* text)
+{
+    std::string escaped;
+    for (const char* c = text; *c; ++c) {
+        if (*c == '\\')
+            escaped += "\\\\";
+        else if (*c == '\n')
+            escaped += "\\n";
+        else
+            escaped += *c;
+    }
+    return escaped;
+}
+
+// Copies descriptors and the newest complete ring slot; both are seqlocked, so retry while the
+// publisher is mid-write.
+bool readSnapshot(const metrics_shm::Segment& segment, Snapshot& snapshot)
+{
+    constexpr int kMaxAttempts = 64;
+    for (int attempt = 0; attempt < kMaxAttempts; ++attempt) {
+        const std::uint64_t descriptorBegin = segment.descriptorSequence.load(std::memory_order_acquire);
+        if (descriptorBegin & 1u) {
+            std::this_thread::yield();
+            continue;
+        }
+        const std::uint32_t metricCount = std::min(segment.metricCount, metrics_shm::kMaxMetrics);
+        snapshot.descriptors.assign(segment.descriptors, segment.descriptors + metricCount);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment.descriptorSequence.load(std::memory_order_relaxed) != descriptorBegin)
+            continue;
+
+        const std::uint64_t written = segment.writeIndex.load(std::memory_order_acquire);
+        if (written == 0)
+            return false;
+        const std::uint64_t index = written - 1;
+        const metrics_shm::RingSlot& slot = segment.ring[index % metrics_shm::kRingSlots];
+        const std::uint64_t slotBegin = slot.sequence.load(std::memory_order_acquire);
+        if (slotBegin != 2 * index + 2)
+            continue;
+        snapshot.frameIndex = slot.frameIndex;
+        snapshot.timestampNs = slot.timestampNs;
+        snapshot.valueCount = std::min(slot.valueCount, metrics_shm::kMaxValues);
+        snapshot.values.assign(slot.values, slot.values + snapshot.valueCount);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == slotBegin)
+            return true;
+    }
+    return false;
+}
+
+std::string toOpenMetrics(const Snapshot& snapshot)
+{
+    std::ostringstream out;
+    for (const metrics_shm::MetricDescriptor& descriptor : snapshot.descriptors) {
+        const std::string name(descriptor.name, strnlen(descriptor.name, sizeof(descriptor.name)));
+        const auto type = static_cast<metrics_shm::MetricType>(descriptor.type);
+        const std::uint32_t valueCount = type == metrics_shm::MetricType::Histogram ? 2u + descriptor.bucketCount : 1u;
+        if (descriptor.valueOffset + valueCount > snapshot.valueCount)
+            continue; // registered after this frame was published
+        const std::uint64_t* values = snapshot.values.data() + descriptor.valueOffset;
+
+        switch (type) {
+        case metrics_shm::MetricType::Counter:
+            out << "# TYPE " << name << " counter\n";
+            out << "# HELP " << name << ' ' << escapeHelp(descriptor.help) << '\n';
+            out << name << "_total " << values[0] << '\n';
+            break;
+        case metrics_shm::MetricType::Gauge:
+            out << "# TYPE " << name << " gauge\n";
+            out << "# HELP " << name << ' ' << escapeHelp(descriptor.help) << '\n';
+            out << name << ' ' << formatNumber(toDouble(values[0])) << '\n';
+            break;
+        case metrics_shm::MetricType::Histogram: {
+            out << "# TYPE " << name << " histogram\n";
+            out << "# HELP " << name << ' ' << escapeHelp(descriptor.help) << '\n';
+            std::uint64_t cumulative = 0;
+            for (std::uint32_t bucket = 0; bucket < descriptor.bucketCount; ++bucket) {
+                cumulative += values[2 + bucket];
+                out << name << "_bucket{le=\"" << formatNumber(descriptor.bucketBounds[bucket]) << "\"} " << cumulative << '\n';
+            }
+            out << name << "_bucket{le=\"+Inf\"} " << values[0] << '\n';
+            out << name << "_count " << values[0] << '\n';
+            out << name << "_sum " << formatNumber(toDouble(values[1])) << '\n';
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    out << "# TYPE daedalus_metrics_frame gauge\n";
+    out << "# HELP daedalus_metrics_frame Index of the frame these values were published for\n";
+    out << "daedalus_metrics_frame " << snapshot.frameIndex << '\n';
+    out << "# EOF\n";
+    return out.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    SharedMemoryRegion region;
+    if (!region.openReadOnly(options.name, sizeof(metrics_shm::Segment))) {
+        std::cerr << "[Metrics] Cannot open '" << options.name << "': " << region.lastError() << std::endl;
+        return 1;
+    }
+    const auto& segment = *static_cast<const metrics_shm::Segment*>(region.data());
+    if (segment.magic != metrics_shm::kMagic || segment.version != metrics_shm::kVersion) {
+        std::cerr << "[Metrics] '" << options.name << "' is not a compatible metrics segment (version "
+                  << segment.version << ", expected " << metrics_shm::kVersion << ")" << std::endl;
+        return 1;
+    }
+
+    Snapshot snapshot;
+    do {
+        if (readSnapshot(segment, snapshot)) {
+            std::cout << toOpenMetrics(snapshot) << std::flush;
+        } else if (options.watchMs == 0) {
+            std::cerr << "[Metrics] No complete frame published yet" << std::endl;
+            return 1;
+        }
+        if (options.watchMs > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(options.watchMs));
+    } while (options.watchMs > 0);
+    return 0;
+}